@@ -0,0 +1,118 @@
+// ----------------------------------------------------------------------
+// File: DumpMd.hh
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/**
+ * @file   DumpMd.hh
+ *
+ * @brief  Framing of the binary filesystem metadata dump sent to the FSTs.
+ *
+ */
+
+#ifndef __EOSCOMMON_DUMPMD__HH__
+#define __EOSCOMMON_DUMPMD__HH__
+
+/*----------------------------------------------------------------------------*/
+#include "common/Namespace.hh"
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string>
+/*----------------------------------------------------------------------------*/
+
+EOSCOMMONNAMESPACE_BEGIN
+
+/*----------------------------------------------------------------------------*/
+//! Binary 'fs dumpmd' reply.
+//!
+//! The reply starts with the text header "dumpmd_proto: retc=<retc> ",
+//! followed for retc=0 by one record per file and an empty end record:
+//!
+//!   u32 record length | serialized eos::fst::FmdBase
+//!
+//! The length is little endian. A reply without end record is truncated.
+/*----------------------------------------------------------------------------*/
+class DumpMd
+{
+public:
+  //! Size of the length prefix of a record
+  static const size_t kHeaderSize = 4;
+
+  //! Tag of the reply
+  static const char* Tag()
+  {
+    return "dumpmd_proto:";
+  }
+
+  //----------------------------------------------------------------------------
+  //! Append a record to a reply
+  //!
+  //! @param out reply
+  //! @param record serialized record, empty for the end record
+  //----------------------------------------------------------------------------
+  static void Append(std::string& out, const std::string& record)
+  {
+    char header[kHeaderSize];
+    uint32_t len = record.length();
+
+    for (size_t i = 0; i < kHeaderSize; i++) {
+      header[i] = (char)(len >> (8 * i));
+    }
+
+    out.append(header, kHeaderSize);
+    out.append(record);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Decode a record
+  //!
+  //! @param ptr start of the record
+  //! @param len bytes available from ptr
+  //! @param record set to the start of the serialized record
+  //! @param reclen set to the length of the serialized record, 0 for the end
+  //!        record
+  //!
+  //! @return size of the record, 0 if it is not complete within len bytes
+  //----------------------------------------------------------------------------
+  static size_t Parse(const char* ptr, size_t len, const char*& record,
+                      uint32_t& reclen)
+  {
+    if (len < kHeaderSize) {
+      return 0;
+    }
+
+    reclen = 0;
+
+    for (size_t i = 0; i < kHeaderSize; i++) {
+      reclen |= ((uint32_t)(unsigned char) ptr[i]) << (8 * i);
+    }
+
+    if (len < kHeaderSize + reclen) {
+      return 0;
+    }
+
+    record = ptr + kHeaderSize;
+    return kHeaderSize + reclen;
+  }
+};
+
+EOSCOMMONNAMESPACE_END
+
+#endif
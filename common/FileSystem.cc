@@ -57,6 +57,7 @@ FileSystem::FileSystem(const char* queuepath, const char* queue,
   mSom = som;
   mInternalBootStatus = kDown;
   PreBookedSpace = 0;
+  mSnapshotVersion = 0;
   cActive = 0;
   cStatus = 0;
   cConfigStatus = 0;
@@ -571,6 +572,20 @@ FileSystem::SnapShotFileSystem(FileSystem::fs_snapshot_t& fs, bool dolock)
   }
 
   if ((mHash = mSom->GetObject(mQueuePath.c_str(), "hash"))) {
+    unsigned long long version = mHash->GetVersion();
+    {
+      XrdSysMutexHelper lock(mSnapshotMutex);
+
+      if (version == mSnapshotVersion) {
+        fs = mSnapshot;
+
+        if (dolock) {
+          mSom->HashMutex.UnLockRead();
+        }
+
+        return true;
+      }
+    }
     fs.mId = (fsid_t) mHash->GetUInt("id");
     fs.mQueue = mQueue;
     fs.mQueuePath = mQueuePath;
@@ -652,6 +667,13 @@ FileSystem::SnapShotFileSystem(FileSystem::fs_snapshot_t& fs, bool dolock)
     fs.mDrainPeriod = (time_t) mHash->GetLongLong("drainperiod");
     fs.mDrainerOn   = (mHash->Get("stat.drainer") == "on");
     fs.mBalThresh   = mHash->GetDouble("stat.balance.threshold");
+    {
+      // The contents may have changed meanwhile, then the snapshot is newer
+      // than the version and simply rebuilt again next time
+      XrdSysMutexHelper lock(mSnapshotMutex);
+      mSnapshot = fs;
+      mSnapshotVersion = version;
+    }
 
     if (dolock) {
       mSom->HashMutex.UnLockRead();
@@ -794,7 +794,8 @@ public:
   }
 
   //------------------------------------------------------------------------
-  //! Snapshot filesystem.
+  //! Snapshot filesystem. The snapshot is cached and only rebuilt once the
+  //! shared hash has changed.
   //------------------------------------------------------------------------
   bool SnapShotFileSystem(FileSystem::fs_snapshot_t& fs, bool dolock = true);
 
@@ -824,7 +825,15 @@ public:
   //------------------------------------------------------------------------
   void CreateConfig(std::string& key, std::string& val);
 
+private:
+  //! Last snapshot built from the shared hash
+  fs_snapshot_t mSnapshot;
 
+  //! Version of the shared hash the snapshot was built from, 0 if none
+  unsigned long long mSnapshotVersion;
+
+  //! Mutex protecting the cached snapshot
+  XrdSysMutex mSnapshotMutex;
 };
 
 /*----------------------------------------------------------------------------*/
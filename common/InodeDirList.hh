@@ -0,0 +1,172 @@
+// ----------------------------------------------------------------------
+// File: InodeDirList.hh
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/**
+ * @file   InodeDirList.hh
+ *
+ * @brief  Binary encoding of the directory listings sent to the FUSE client.
+ *
+ */
+
+#ifndef __EOSCOMMON_INODEDIRLIST__HH__
+#define __EOSCOMMON_INODEDIRLIST__HH__
+
+/*----------------------------------------------------------------------------*/
+#include "common/Namespace.hh"
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string>
+/*----------------------------------------------------------------------------*/
+
+EOSCOMMONNAMESPACE_BEGIN
+
+/*----------------------------------------------------------------------------*/
+//! Binary directory listing with inline stat information (readdirplus).
+//!
+//! The reply starts with the text header "inodirlist_binary: retc=<retc> ",
+//! followed for retc=0 by one record per entry, '.' and '..' first:
+//!
+//!   u32 name length | u64 inode | u8 flags | name | kStatFields x u64
+//!
+//! The stat fields are only present if the kHasStat flag is set, all integers
+//! are little endian. Names are sent as they are, the length prefix makes any
+//! escaping unnecessary.
+/*----------------------------------------------------------------------------*/
+class InodeDirList
+{
+public:
+  //! Flags of a record
+  enum {
+    kHasStat = 0x1
+  };
+
+  //! Stat fields in the order of the text listing: atime nsec, atime sec,
+  //! blksize, blocks, ctime nsec, ctime sec, dev, gid, ino, mode, mtime nsec,
+  //! mtime sec, nlink, rdev, size, uid
+  static const size_t kStatFields = 16;
+
+  //! Size of a record without the name
+  static const size_t kHeaderSize = 4 + 8 + 1;
+
+  //! Tag of the reply
+  static const char* Tag()
+  {
+    return "inodirlist_binary:";
+  }
+
+  //----------------------------------------------------------------------------
+  //! Append a record to a reply
+  //!
+  //! @param out reply
+  //! @param name entry name
+  //! @param len length of the name
+  //! @param inode inode of the entry
+  //! @param stat kStatFields stat fields or 0
+  //----------------------------------------------------------------------------
+  static void Append(std::string& out, const char* name, uint32_t len,
+                     uint64_t inode, const uint64_t* stat)
+  {
+    char header[kHeaderSize];
+    PutUInt(header, len, 4);
+    PutUInt(header + 4, inode, 8);
+    header[12] = stat ? kHasStat : 0;
+    out.append(header, kHeaderSize);
+    out.append(name, len);
+
+    if (stat) {
+      char fields[kStatFields * 8];
+
+      for (size_t i = 0; i < kStatFields; i++) {
+        PutUInt(fields + i * 8, stat[i], 8);
+      }
+
+      out.append(fields, sizeof(fields));
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Decode a record
+  //!
+  //! @param ptr start of the record
+  //! @param len bytes available from ptr
+  //! @param name set to the start of the name
+  //! @param namelen set to the length of the name
+  //! @param inode set to the inode
+  //! @param stat filled with the stat fields if the record has them
+  //! @param hasstat set if the record has stat fields
+  //!
+  //! @return size of the record, 0 if it is not complete within len bytes
+  //----------------------------------------------------------------------------
+  static size_t Parse(const char* ptr, size_t len, const char*& name,
+                      uint32_t& namelen, uint64_t& inode, uint64_t* stat,
+                      bool& hasstat)
+  {
+    if (len < kHeaderSize) {
+      return 0;
+    }
+
+    namelen = (uint32_t) GetUInt(ptr, 4);
+    inode = GetUInt(ptr + 4, 8);
+    hasstat = (ptr[12] & kHasStat);
+    size_t size = kHeaderSize + (size_t) namelen +
+                  (hasstat ? kStatFields * 8 : 0);
+
+    if (len < size) {
+      return 0;
+    }
+
+    name = ptr + kHeaderSize;
+
+    if (hasstat) {
+      const char* fields = name + namelen;
+
+      for (size_t i = 0; i < kStatFields; i++) {
+        stat[i] = GetUInt(fields + i * 8, 8);
+      }
+    }
+
+    return size;
+  }
+
+private:
+  static void PutUInt(char* ptr, uint64_t value, size_t nbytes)
+  {
+    for (size_t i = 0; i < nbytes; i++) {
+      ptr[i] = (char)(value >> (8 * i));
+    }
+  }
+
+  static uint64_t GetUInt(const char* ptr, size_t nbytes)
+  {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < nbytes; i++) {
+      value |= ((uint64_t)(unsigned char) ptr[i]) << (8 * i);
+    }
+
+    return value;
+  }
+};
+
+EOSCOMMONNAMESPACE_END
+
+#endif
@@ -27,6 +27,7 @@
 /*----------------------------------------------------------------------------*/
 /*----------------------------------------------------------------------------*/
 #include <sstream>
+#include <cstring>
 /*----------------------------------------------------------------------------*/
 
 EOSCOMMONNAMESPACE_BEGIN
@@ -38,6 +39,23 @@ HttpResponse::AddHeader (const std::string key, const std::string value)
   mResponseHeaders[key] = value;
 }
 
+/*----------------------------------------------------------------------------*/
+ssize_t
+HttpResponse::ReadBody (uint64_t pos, char *buf, size_t max)
+{
+  // the default body is the one in memory
+  if (pos >= mResponseBody.length())
+    return 0;
+
+  size_t length = mResponseBody.length() - pos;
+
+  if (length > max)
+    length = max;
+
+  memcpy(buf, mResponseBody.c_str() + pos, length);
+  return length;
+}
+
 /*----------------------------------------------------------------------------*/
 std::string
 HttpResponse::ContentType (const std::string &path)
@@ -38,6 +38,8 @@
 /*----------------------------------------------------------------------------*/
 #include <map>
 #include <string>
+#include <stdint.h>
+#include <sys/types.h>
 /*----------------------------------------------------------------------------*/
 
 EOSCOMMONNAMESPACE_BEGIN
@@ -96,6 +98,8 @@ protected:
 public:
   off_t        mResponseLength;        //!< length of the response
   bool         mUseFileReaderCallback; //!< read the file using callbacks
+  bool         mStreamBody;            //!< body produced by ReadBody while
+                                       //!< sending, of unknown length
 
 public:
 
@@ -103,7 +107,8 @@ public:
    * Constructor
    */
   HttpResponse () :
-    mResponseCode(OK), mResponseLength(0), mUseFileReaderCallback(false) {};
+    mResponseCode(OK), mResponseLength(0), mUseFileReaderCallback(false),
+    mStreamBody(false) {};
 
   /**
    * Destructor
@@ -164,6 +169,20 @@ public:
   inline size_t
   GetBodySize () { return mResponseBody.length(); }
 
+  /**
+   * Produce the next piece of a streamed body (mStreamBody). Called by the
+   * server thread sending the response, or in 'dispatch' mode by a worker
+   * while the connection is suspended, pieces are requested in order.
+   *
+   * @param pos  offset of the piece in the body
+   * @param buf  buffer to fill
+   * @param max  size of the buffer
+   *
+   * @return number of bytes filled, 0 at the end of the body, -1 on error
+   */
+  virtual ssize_t
+  ReadBody (uint64_t pos, char *buf, size_t max);
+
   /**
    * @return the server response code
    */
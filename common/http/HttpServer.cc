@@ -45,6 +45,10 @@ EOSCOMMONNAMESPACE_BEGIN
 #define MHD_USE_EPOLL_LINUX_ONLY 512
 #endif
 
+#if MHD_VERSION >= 0x00093400
+#define EOS_HTTP_DISPATCH 1
+#endif
+
 HttpServer* HttpServer::gHttp; //!< Global HTTP server
 
 /*----------------------------------------------------------------------------*/
@@ -57,6 +61,8 @@ HttpServer::HttpServer (int port)
   mPort = port;
   mThreadId = 0;
   mRunning = false;
+  mDispatchSupported = false;
+  mWorkerPool = 0;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -111,6 +117,64 @@ HttpServer::Run ()
 	nthreads = 4096;
     }
 
+    if (thread_model == "dispatch")
+    {
+#ifdef EOS_HTTP_DISPATCH
+      if (!mDispatchSupported)
+#endif
+      {
+	eos_static_notice("msg=\"http server can not dispatch requests, using "
+			  "epoll mode\"");
+	thread_model = "epoll";
+      }
+    }
+
+#ifdef EOS_HTTP_DISPATCH
+    if (thread_model == "dispatch")
+    {
+      // one event loop accepts and parses the requests, the worker pool
+      // executes them with at most nmetadata threads busy with metadata
+      int nmetadata = nthreads / 2;
+      int maxqueue = 1024;
+
+      if (getenv("EOS_HTTP_METADATA_THREADS"))
+	nmetadata = atoi(getenv("EOS_HTTP_METADATA_THREADS"));
+
+      if (nmetadata < 1)
+	nmetadata = 1;
+
+      if (getenv("EOS_HTTP_QUEUE_LIMIT"))
+	maxqueue = atoi(getenv("EOS_HTTP_QUEUE_LIMIT"));
+
+      if (maxqueue < 1)
+	maxqueue = 1024;
+
+      eos_static_notice("msg=\"starting http server\" mode=\"dispatch\" "
+			"threads=%d metadata-threads=%d queue-limit=%d",
+			nthreads, nmetadata, maxqueue);
+      mWorkerPool = new HttpWorkerPool(nthreads, nmetadata, maxqueue);
+      mDaemon = MHD_start_daemon(MHD_USE_DEBUG | MHD_USE_SELECT_INTERNALLY |
+				 MHD_USE_EPOLL_LINUX_ONLY | MHD_USE_SUSPEND_RESUME,
+				 mPort,
+				 NULL,
+				 NULL,
+				 &HttpServer::StaticHandler,
+				 (void*) 0,
+				 MHD_OPTION_NOTIFY_COMPLETED, &HttpServer::StaticCompleteHandler, NULL,
+				 MHD_OPTION_CONNECTION_MEMORY_LIMIT,
+				 getenv("EOS_HTTP_CONNECTION_MEMORY_LIMIT")?atoi(getenv("EOS_HTTP_CONNECTION_MEMORY_LIMIT")): (128*1024*1024),
+				 MHD_OPTION_CONNECTION_TIMEOUT,
+				 getenv("EOS_HTTP_CONNECTION_TIMEOUT")?atoi(getenv("EOS_HTTP_CONNECTION_TIMEOUT")):128,
+				 MHD_OPTION_END
+				 );
+
+      if (!mDaemon)
+      {
+	delete mWorkerPool;
+	mWorkerPool = 0;
+      }
+    } else
+#endif
     if (thread_model == "threads")
     {
       eos_static_notice("msg=\"starting http server\" mode=\"thread-per-connection\"");
@@ -181,7 +245,17 @@ HttpServer::Run ()
   unsigned MHD_LONG_LONG mhd_timeout;
   struct timeval tv;
 
-  if ( (thread_model == "epoll") || (thread_model == "threads") )
+  if (thread_model == "dispatch")
+  {
+    while (1)
+    {
+      // report the queues of the worker pool
+      XrdSysTimer::Snooze(60);
+      eos_static_info("msg=\"http worker pool\" %s",
+		      mWorkerPool->GetStatsString().c_str());
+    }
+  }
+  else if ( (thread_model == "epoll") || (thread_model == "threads") )
   {
     while (1)
     {
@@ -238,6 +312,36 @@ HttpServer::CleanupConnections ()
 }
 
 
+/*----------------------------------------------------------------------------*/
+bool
+HttpServer::Dispatch (struct MHD_Connection *connection,
+		      const char *method,
+		      std::function<void()> job)
+{
+#ifdef EOS_HTTP_DISPATCH
+  if (!mWorkerPool)
+    return false;
+
+  // suspend before queueing, the job may complete before we return
+  MHD_suspend_connection(connection);
+
+  if (!mWorkerPool->Submit(HttpWorkerPool::Classify(method),
+			   [connection, job] ()
+			   {
+			     job();
+			     MHD_resume_connection(connection);
+			   }))
+  {
+    MHD_resume_connection(connection);
+    return false;
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
 /*----------------------------------------------------------------------------*/
 int
 HttpServer::StaticHandler (void *cls,
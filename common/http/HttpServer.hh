@@ -34,10 +34,12 @@
 /*----------------------------------------------------------------------------*/
 #include "common/http/HttpRequest.hh"
 #include "common/http/HttpResponse.hh"
+#include "common/http/HttpWorkerPool.hh"
 #include "common/Namespace.hh"
 /*----------------------------------------------------------------------------*/
 #include "XrdSys/XrdSysPthread.hh"
 /*----------------------------------------------------------------------------*/
+#include <functional>
 #include <string>
 #include <map>
 
@@ -58,6 +60,9 @@ protected:
   int                mPort;     //!< The port this server listens on
   pthread_t          mThreadId; //!< This thread's ID
   bool               mRunning;  //!< Is this server running?
+  bool               mDispatchSupported; //!< The handler can dispatch requests
+                                         //!< to the worker pool
+  HttpWorkerPool    *mWorkerPool; //!< Workers executing dispatched requests
   static HttpServer *gHttp;     //!< This is the instance of the HTTP server
                                 //!< allowing the Handler function to call
                                 //!< class member functions
@@ -78,7 +83,7 @@ public:
   /**
    * Destructor
    */
-  virtual ~HttpServer () {};
+  virtual ~HttpServer () { delete mWorkerPool; };
 
   /**
    * Start the listening HTTP server
@@ -266,6 +271,32 @@ public:
                   const char        *key,
                   const char        *value);
 
+  /**
+   * Check if requests are executed by the worker pool ('dispatch' mode)
+   */
+  bool
+  IsDispatching () const
+  {
+    return (mWorkerPool != 0);
+  }
+
+  /**
+   * Suspend a connection and queue the execution of its request in the
+   * worker pool. The connection is resumed when the job returns, libmicrohttpd
+   * then calls the handler again for the request to queue the response.
+   *
+   * @param connection  the connection of the request
+   * @param method      the request verb, selects the request class
+   * @param job         function executing the request
+   *
+   * @return false if the queue of the request class is full, the connection
+   *         is not suspended then
+   */
+  bool
+  Dispatch (struct MHD_Connection *connection,
+            const char            *method,
+            std::function<void()>  job);
+
   /**
    * Cleans closed connections earlier than MHD_run
    */
@@ -0,0 +1,224 @@
+// ----------------------------------------------------------------------
+// File: HttpWorkerPool.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/*----------------------------------------------------------------------------*/
+#include "common/http/HttpWorkerPool.hh"
+/*----------------------------------------------------------------------------*/
+#include <cstdio>
+#include <cstring>
+/*----------------------------------------------------------------------------*/
+
+EOSCOMMONNAMESPACE_BEGIN
+
+/*----------------------------------------------------------------------------*/
+HttpWorkerPool::HttpWorkerPool (size_t nthreads, size_t nmetadata,
+                                size_t maxqueue) :
+  mMaxQueue(maxqueue ? maxqueue : 1), mStop(false)
+{
+  if (!nthreads)
+    nthreads = 1;
+
+  // data requests may use every thread, metadata requests at least one
+  mMaxRunning[kData] = nthreads;
+  mMaxRunning[kMetadata] = nmetadata ? ((nmetadata < nthreads) ? nmetadata :
+                                        nthreads) : 1;
+  memset(mStats, 0, sizeof(mStats));
+
+  for (size_t i = 0; i < nthreads; i++)
+  {
+    mThreads.push_back(std::thread(&HttpWorkerPool::Worker, this));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+HttpWorkerPool::~HttpWorkerPool ()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCond.notify_all();
+
+  for (auto& thread : mThreads)
+  {
+    thread.join();
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+bool
+HttpWorkerPool::Submit (RequestClass rclass, std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ClassStats& stats = mStats[rclass];
+
+    if (mStop || (mQueue[rclass].size() >= mMaxQueue))
+    {
+      stats.mRejected++;
+      return false;
+    }
+
+    Job entry;
+    entry.mRun = std::move(job);
+    entry.mQueued = std::chrono::steady_clock::now();
+    mQueue[rclass].push_back(std::move(entry));
+    stats.mQueued = mQueue[rclass].size();
+
+    if (stats.mQueued > stats.mMaxQueued)
+      stats.mMaxQueued = stats.mQueued;
+  }
+
+  // a thread may only be allowed to take one of the classes
+  mCond.notify_all();
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+HttpWorkerPool::RequestClass
+HttpWorkerPool::NextClass ()
+{
+  for (int rclass = kData; rclass < kNumClasses; rclass++)
+  {
+    if (!mQueue[rclass].empty() &&
+        (mStats[rclass].mRunning < mMaxRunning[rclass]))
+    {
+      return static_cast<RequestClass> (rclass);
+    }
+  }
+
+  return kNumClasses;
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpWorkerPool::Worker ()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (!mStop)
+  {
+    RequestClass rclass = NextClass();
+
+    if (rclass == kNumClasses)
+    {
+      mCond.wait(lock);
+      continue;
+    }
+
+    Job job = std::move(mQueue[rclass].front());
+    mQueue[rclass].pop_front();
+    ClassStats& stats = mStats[rclass];
+    stats.mQueued = mQueue[rclass].size();
+    stats.mRunning++;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t wait = std::chrono::duration_cast<std::chrono::microseconds>
+      (start - job.mQueued).count();
+    stats.mWaitUs += wait;
+
+    if (wait > stats.mMaxWaitUs)
+      stats.mMaxWaitUs = wait;
+
+    lock.unlock();
+    job.mRun();
+    uint64_t service = std::chrono::duration_cast<std::chrono::microseconds>
+      (std::chrono::steady_clock::now() - start).count();
+    lock.lock();
+    stats.mRunning--;
+    stats.mCompleted++;
+    stats.mServiceUs += service;
+
+    if (service > stats.mMaxServiceUs)
+      stats.mMaxServiceUs = service;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+HttpWorkerPool::RequestClass
+HttpWorkerPool::Classify (const char* method)
+{
+  static const char* metadata[] = {
+    "PROPFIND", "PROPPATCH", "MKCOL", "MOVE", "COPY", "DELETE", "LOCK",
+    "UNLOCK", 0
+  };
+
+  for (size_t i = 0; method && metadata[i]; i++)
+  {
+    if (!strcmp(method, metadata[i]))
+      return kMetadata;
+  }
+
+  return kData;
+}
+
+/*----------------------------------------------------------------------------*/
+const char*
+HttpWorkerPool::ClassName (RequestClass rclass)
+{
+  return (rclass == kMetadata) ? "metadata" : "data";
+}
+
+/*----------------------------------------------------------------------------*/
+HttpWorkerPool::ClassStats
+HttpWorkerPool::GetStats (RequestClass rclass)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStats[rclass];
+}
+
+/*----------------------------------------------------------------------------*/
+std::string
+HttpWorkerPool::GetStatsString ()
+{
+  std::string out;
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  for (int rclass = kData; rclass < kNumClasses; rclass++)
+  {
+    ClassStats& stats = mStats[rclass];
+    const char* name = ClassName(static_cast<RequestClass> (rclass));
+    char line[1024];
+    snprintf(line, sizeof (line),
+             "%s%s.queued=%llu %s.maxqueued=%llu %s.running=%llu "
+             "%s.completed=%llu %s.rejected=%llu %s.avgwait=%.03fms "
+             "%s.maxwait=%.03fms %s.avgexec=%.03fms %s.maxexec=%.03fms",
+             out.empty() ? "" : " ",
+             name, (unsigned long long) stats.mQueued,
+             name, (unsigned long long) stats.mMaxQueued,
+             name, (unsigned long long) stats.mRunning,
+             name, (unsigned long long) stats.mCompleted,
+             name, (unsigned long long) stats.mRejected,
+             name, stats.mCompleted ? stats.mWaitUs / 1000.0 / stats.mCompleted : 0,
+             name, stats.mMaxWaitUs / 1000.0,
+             name, stats.mCompleted ? stats.mServiceUs / 1000.0 / stats.mCompleted : 0,
+             name, stats.mMaxServiceUs / 1000.0);
+    out += line;
+    stats.mMaxQueued = stats.mQueued;
+    stats.mMaxWaitUs = 0;
+    stats.mMaxServiceUs = 0;
+  }
+
+  return out;
+}
+
+/*----------------------------------------------------------------------------*/
+EOSCOMMONNAMESPACE_END
@@ -0,0 +1,164 @@
+// ----------------------------------------------------------------------
+// File: HttpWorkerPool.hh
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/**
+ * @file   HttpWorkerPool.hh
+ *
+ * @brief  Bounded pool of threads executing HTTP requests dispatched by the
+ *         event loop of the HTTP server. Requests are split in classes with
+ *         their own queue: data requests (GET/PUT/HEAD redirects) are always
+ *         served first, metadata requests (PROPFIND, MKCOL, MOVE ...) can
+ *         occupy only a limited number of the threads, so slow namespace
+ *         operations can't starve the fast ones.
+ */
+
+#ifndef __EOSCOMMON_HTTP_WORKERPOOL__HH__
+#define __EOSCOMMON_HTTP_WORKERPOOL__HH__
+
+/*----------------------------------------------------------------------------*/
+#include "common/Namespace.hh"
+/*----------------------------------------------------------------------------*/
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+/*----------------------------------------------------------------------------*/
+
+EOSCOMMONNAMESPACE_BEGIN
+
+class HttpWorkerPool
+{
+public:
+  /**
+   * Request classes, in order of priority
+   */
+  enum RequestClass {
+    kData = 0,     //!< data access and redirects
+    kMetadata = 1, //!< namespace heavy requests
+    kNumClasses = 2
+  };
+
+  /**
+   * Counters of a request class
+   */
+  struct ClassStats {
+    uint64_t mQueued;       //!< requests waiting for a thread
+    uint64_t mMaxQueued;    //!< maximum queue depth seen
+    uint64_t mRunning;      //!< requests being executed
+    uint64_t mCompleted;    //!< requests executed
+    uint64_t mRejected;     //!< requests refused because the queue was full
+    uint64_t mWaitUs;       //!< sum of the queueing times
+    uint64_t mMaxWaitUs;    //!< maximum queueing time
+    uint64_t mServiceUs;    //!< sum of the execution times
+    uint64_t mMaxServiceUs; //!< maximum execution time
+  };
+
+  /**
+   * Constructor, starts the threads
+   *
+   * @param nthreads      number of threads
+   * @param nmetadata     maximum number of threads executing metadata requests
+   * @param maxqueue      maximum number of requests queued per class
+   */
+  HttpWorkerPool (size_t nthreads, size_t nmetadata, size_t maxqueue);
+
+  /**
+   * Destructor, drops the queued requests and joins the threads
+   */
+  ~HttpWorkerPool ();
+
+  /**
+   * Queue a request
+   *
+   * @param rclass  class of the request
+   * @param job     function executing the request
+   *
+   * @return false if the queue of the class is full
+   */
+  bool
+  Submit (RequestClass rclass, std::function<void()> job);
+
+  /**
+   * Get the class of a request from its HTTP method
+   */
+  static RequestClass
+  Classify (const char* method);
+
+  /**
+   * Get the name of a request class
+   */
+  static const char*
+  ClassName (RequestClass rclass);
+
+  /**
+   * Get a snapshot of the counters of a request class
+   */
+  ClassStats
+  GetStats (RequestClass rclass);
+
+  /**
+   * Get the counters of all the classes as key=value pairs for the log,
+   * the maximum values are reset afterwards
+   */
+  std::string
+  GetStatsString ();
+
+private:
+  //! Queued request
+  struct Job {
+    std::function<void()> mRun;
+    std::chrono::steady_clock::time_point mQueued;
+  };
+
+  /**
+   * Thread loop
+   */
+  void
+  Worker ();
+
+  /**
+   * Get the class of the next request to execute, mMutex has to be locked
+   *
+   * @return kNumClasses if there is nothing that can be executed
+   */
+  RequestClass
+  NextClass ();
+
+  std::mutex mMutex;                    //!< protects the queues and counters
+  std::condition_variable mCond;        //!< signaled on new requests
+  std::deque<Job> mQueue[kNumClasses];  //!< queued requests per class
+  size_t mMaxRunning[kNumClasses];      //!< thread limit per class
+  size_t mMaxQueue;                     //!< queue limit per class
+  ClassStats mStats[kNumClasses];       //!< counters per class
+  bool mStop;                           //!< set to terminate the threads
+  std::vector<std::thread> mThreads;
+};
+
+/*----------------------------------------------------------------------------*/
+EOSCOMMONNAMESPACE_END
+
+#endif
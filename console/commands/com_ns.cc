@@ -45,7 +45,7 @@ com_ns (char* arg1)
   if (wants_help(arg1))
     goto com_ns_usage;
 
-  if ((cmd != "stat") && (cmd != "") && (cmd != "compact") && (cmd != "master") && (cmd != "mutex"))
+  if ((cmd != "stat") && (cmd != "") && (cmd != "compact") && (cmd != "master") && (cmd != "mutex") && (cmd != "memory"))
   {
     goto com_ns_usage;
   }
@@ -56,6 +56,11 @@ com_ns (char* arg1)
     in += "mgm.subcmd=stat";
   }
 
+  if (cmd == "memory")
+  {
+    in += "mgm.subcmd=memory";
+  }
+
   if (cmd == "compact")
   {
     in += "mgm.subcmd=compact";
@@ -215,6 +220,8 @@ com_ns_usage:
   fprintf(stdout, "                -m                                                   -  print in <key>=<val> monitoring format\n");
   fprintf(stdout, "                -n                                                   -  print numerical uid/gids\n");
   fprintf(stdout, "                --reset                                              -  reset namespace counter\n");
+  fprintf(stdout, "       ns memory [-m]                                             :  print the memory used by the in-memory file metadata\n");
+  fprintf(stdout, "                -m                                                   -  print in <key>=<val> monitoring format\n");
 #ifdef EOS_INSTRUMENTED_RWMUTEX
   fprintf(stdout, "       ns mutex                                                   :  manage mutex monitoring\n");
   fprintf(stdout, "                --toggletiming                                       -  toggle the timing\n");
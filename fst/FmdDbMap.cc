@@ -28,19 +28,27 @@
 #include "common/FileId.hh"
 #include "common/Path.hh"
 #include "common/DbMap.hh"
+#include "common/DumpMd.hh"
 #include "fst/FmdDbMap.hh"
 #include "fst/XrdFstOfs.hh"
 #include "fst/checksum/ChecksumPlugins.hh"
 #include <fst/io/FileIoPluginCommon.hh>
 /*----------------------------------------------------------------------------*/
 #include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClFile.hh"
 /*----------------------------------------------------------------------------*/
 #include <stdio.h>
 #include <sys/mman.h>
-#include <fts.h>
+#include <dirent.h>
+#include <fcntl.h>
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <sys/xattr.h>
 /*----------------------------------------------------------------------------*/
 
 EOSFSTNAMESPACE_BEGIN
@@ -523,23 +531,8 @@ FmdDbMapHandler::UpdateFromDisk(eos::common::FileSystem::fsid_t fsid,
   if (dbmap.count(fsid)) {
     Fmd valfmd = RetrieveFmd(fid, fsid);
     // update in-memory
-    valfmd.set_disksize(disksize);
-    // fix the reference value from disk
-    valfmd.set_size(disksize);
-    valfmd.set_checksum(diskchecksum);
-    valfmd.set_fid(fid);
-    valfmd.set_fsid(fsid);
-    valfmd.set_diskchecksum(diskchecksum);
-    valfmd.set_checktime(checktime);
-    valfmd.set_filecxerror(filecxerror);
-    valfmd.set_blockcxerror(blockcxerror);
-
-    if (flaglayouterror) {
-      // if the mgm sync is run afterwards, every disk file is by construction an
-      // orphan, until it is synced from the mgm
-      valfmd.set_layouterror(eos::common::LayoutId::kOrphan);
-    }
-
+    SetDiskInfo(valfmd, fid, fsid, disksize, diskchecksum, checktime, filecxerror,
+                blockcxerror, flaglayouterror);
     return PutFmd(fid, fsid, valfmd);
   } else {
     eos_crit("no %s DB open for fsid=%llu", eos::common::DbMap::getDbType().c_str(),
@@ -548,6 +541,95 @@ FmdDbMapHandler::UpdateFromDisk(eos::common::FileSystem::fsid_t fsid,
   }
 }
 
+/*----------------------------------------------------------------------------*/
+/**
+ * Update a batch of fmd records from disk contents
+ *
+ * @param fsid file system id
+ * @param batch records carrying fid, disksize, diskchecksum, checktime,
+ *        filecxerror and blockcxerror as found on disk
+ * @param flaglayouterror flag the records as orphans until the mgm resync
+ *
+ * @return true if all records have been commited
+ */
+
+/*----------------------------------------------------------------------------*/
+bool
+FmdDbMapHandler::UpdateFromDisk(eos::common::FileSystem::fsid_t fsid,
+                                std::vector<Fmd>& batch, bool flaglayouterror)
+{
+  eos::common::RWMutexReadLock lock(Mutex);
+  FmdSqliteWriteLock vlock(fsid);
+
+  if (!dbmap.count(fsid)) {
+    eos_crit("no %s DB open for fsid=%llu", eos::common::DbMap::getDbType().c_str(),
+             (unsigned long) fsid);
+    return false;
+  }
+
+  unsigned long cpt = 0;
+  std::string sval;
+  dbmap[fsid]->beginSetSequence();
+
+  for (auto it = batch.begin(); it != batch.end(); ++it) {
+    eos::common::FileId::fileid_t fid = it->fid();
+
+    if (!fid) {
+      eos_info("skipping to insert a file with fid 0");
+      continue;
+    }
+
+    Fmd valfmd = RetrieveFmd(fid, fsid);
+    SetDiskInfo(valfmd, fid, fsid, it->disksize(), it->diskchecksum(),
+                it->checktime(), it->filecxerror(), it->blockcxerror(),
+                flaglayouterror);
+    valfmd.SerializePartialToString(&sval);
+    dbmap[fsid]->set(eos::common::Slice((const char*) &fid, sizeof(fid)), sval, "");
+    cpt++;
+  }
+
+  if (dbmap[fsid]->endSetSequence() != cpt)
+    // the setsequence makes that it's impossible to know which key is faulty
+  {
+    eos_err("unable to update fsid=%lu\n", fsid);
+    return false;
+  }
+
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Set the disk information of an fmd record
+ */
+
+/*----------------------------------------------------------------------------*/
+void
+FmdDbMapHandler::SetDiskInfo(Fmd& valfmd, eos::common::FileId::fileid_t fid,
+                             eos::common::FileSystem::fsid_t fsid,
+                             unsigned long long disksize,
+                             const std::string& diskchecksum,
+                             unsigned long checktime, bool filecxerror,
+                             bool blockcxerror, bool flaglayouterror)
+{
+  valfmd.set_disksize(disksize);
+  // fix the reference value from disk
+  valfmd.set_size(disksize);
+  valfmd.set_checksum(diskchecksum);
+  valfmd.set_fid(fid);
+  valfmd.set_fsid(fsid);
+  valfmd.set_diskchecksum(diskchecksum);
+  valfmd.set_checktime(checktime);
+  valfmd.set_filecxerror(filecxerror);
+  valfmd.set_blockcxerror(blockcxerror);
+
+  if (flaglayouterror) {
+    // if the mgm sync is run afterwards, every disk file is by construction an
+    // orphan, until it is synced from the mgm
+    valfmd.set_layouterror(eos::common::LayoutId::kOrphan);
+  }
+}
+
 /*----------------------------------------------------------------------------*/
 /**
  * Update mgm metadata
@@ -590,28 +672,8 @@ FmdDbMapHandler::UpdateFromMgm(eos::common::FileSystem::fsid_t fsid,
     }
 
     // update in-memory
-    valfmd.set_mgmsize(mgmsize);
-    valfmd.set_size(mgmsize);
-    valfmd.set_checksum(mgmchecksum);
-    valfmd.set_mgmchecksum(mgmchecksum);
-    valfmd.set_cid(cid);
-    valfmd.set_lid(lid);
-    valfmd.set_uid(uid);
-    valfmd.set_gid(gid);
-    valfmd.set_ctime(ctime);
-    valfmd.set_ctime_ns(ctime_ns);
-    valfmd.set_mtime(mtime);
-    valfmd.set_mtime_ns(mtime_ns);
-    valfmd.set_layouterror(layouterror);
-    valfmd.set_locations(locations);
-    // truncate the checksum to the right string length
-    size_t cslen = eos::common::LayoutId::GetChecksumLen(lid) * 2;
-    valfmd.set_mgmchecksum(
-      std::string(valfmd.mgmchecksum()).erase(std::min(valfmd.mgmchecksum().length(),
-          cslen)));
-    valfmd.set_checksum(
-      std::string(valfmd.checksum()).erase(std::min(valfmd.checksum().length(),
-                                           cslen)));
+    SetMgmInfo(valfmd, cid, lid, mgmsize, mgmchecksum, uid, gid, ctime, ctime_ns,
+               mtime, mtime_ns, layouterror, locations);
     return PutFmd(fid, fsid, valfmd);
   } else {
     eos_crit("no %s DB open for fsid=%llu", eos::common::DbMap::getDbType().c_str(),
@@ -620,6 +682,139 @@ FmdDbMapHandler::UpdateFromMgm(eos::common::FileSystem::fsid_t fsid,
   }
 }
 
+/*----------------------------------------------------------------------------*/
+/**
+ * Update a batch of fmd records from the mgm dump
+ *
+ * The records are applied like UpdateFromMgm does it after GetFmd created the
+ * missing ones, but under a single lock and in a single DB write batch.
+ *
+ * @param fsid file system id
+ * @param batch records as sent by the mgm, the layout error is computed here
+ *
+ * @return true if all records have been commited
+ */
+
+/*----------------------------------------------------------------------------*/
+bool
+FmdDbMapHandler::UpdateFromMgm(eos::common::FileSystem::fsid_t fsid,
+                               std::vector<Fmd>& batch)
+{
+  eos::common::RWMutexReadLock lock(Mutex);
+  FmdSqliteWriteLock wlock(fsid);
+
+  if (!dbmap.count(fsid)) {
+    eos_crit("no %s DB open for fsid=%llu", eos::common::DbMap::getDbType().c_str(),
+             (unsigned long) fsid);
+    return false;
+  }
+
+  struct timeval tv;
+  struct timezone tz;
+  gettimeofday(&tv, &tz);
+  bool retc = true;
+  unsigned long cpt = 0;
+  std::string sval;
+  dbmap[fsid]->beginSetSequence();
+
+  for (auto it = batch.begin(); it != batch.end(); ++it) {
+    Fmd& mgmfmd = *it;
+    eos::common::FileId::fileid_t fid = mgmfmd.fid();
+
+    if (!fid) {
+      eos_info("skipping to insert a file with fid 0");
+      continue;
+    }
+
+    mgmfmd.set_layouterror(FmdHelper::LayoutError(fsid, mgmfmd.lid(),
+                           mgmfmd.locations()));
+    Fmd valfmd;
+
+    if (ExistFmd(fid, fsid)) {
+      valfmd = RetrieveFmd(fid, fsid);
+
+      if ((valfmd.fid() != fid) || (valfmd.fsid() != fsid)) {
+        eos_crit("unable to update fmd for fid %llu on fs %lu - id mismatch in "
+                 "meta data block (fid=%llu fsid=%lu)", fid, (unsigned long) fsid,
+                 valfmd.fid(), (unsigned long) valfmd.fsid());
+        retc = false;
+        continue;
+      }
+
+      // check if it exists on disk
+      if (valfmd.disksize() == 0xfffffffffff1ULL) {
+        mgmfmd.set_layouterror(mgmfmd.layouterror() |
+                               eos::common::LayoutId::kMissing);
+        eos_warning("found missing replica for fid=%llu on fsid=%lu", fid,
+                    (unsigned long) fsid);
+      }
+    } else {
+      // make a new record
+      valfmd.set_fid(fid);
+      valfmd.set_fsid(fsid);
+      valfmd.set_atime(tv.tv_sec);
+      valfmd.set_atime_ns(tv.tv_usec * 1000);
+    }
+
+    SetMgmInfo(valfmd, mgmfmd.cid(), mgmfmd.lid(), mgmfmd.mgmsize(),
+               mgmfmd.mgmchecksum(), mgmfmd.uid(), mgmfmd.gid(), mgmfmd.ctime(),
+               mgmfmd.ctime_ns(), mgmfmd.mtime(), mgmfmd.mtime_ns(),
+               mgmfmd.layouterror(), mgmfmd.locations());
+    valfmd.SerializePartialToString(&sval);
+    dbmap[fsid]->set(eos::common::Slice((const char*) &fid, sizeof(fid)), sval, "");
+    cpt++;
+  }
+
+  if (dbmap[fsid]->endSetSequence() != cpt)
+    // the setsequence makes that it's impossible to know which key is faulty
+  {
+    eos_err("unable to update fsid=%lu\n", fsid);
+    return false;
+  }
+
+  return retc;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Set the mgm information of an fmd record
+ */
+
+/*----------------------------------------------------------------------------*/
+void
+FmdDbMapHandler::SetMgmInfo(Fmd& valfmd, eos::common::FileId::fileid_t cid,
+                            eos::common::LayoutId::layoutid_t lid,
+                            unsigned long long mgmsize,
+                            const std::string& mgmchecksum,
+                            uid_t uid, gid_t gid, unsigned long long ctime,
+                            unsigned long long ctime_ns, unsigned long long mtime,
+                            unsigned long long mtime_ns, int layouterror,
+                            const std::string& locations)
+{
+  valfmd.set_mgmsize(mgmsize);
+  valfmd.set_size(mgmsize);
+  valfmd.set_checksum(mgmchecksum);
+  valfmd.set_mgmchecksum(mgmchecksum);
+  valfmd.set_cid(cid);
+  valfmd.set_lid(lid);
+  valfmd.set_uid(uid);
+  valfmd.set_gid(gid);
+  valfmd.set_ctime(ctime);
+  valfmd.set_ctime_ns(ctime_ns);
+  valfmd.set_mtime(mtime);
+  valfmd.set_mtime_ns(mtime_ns);
+  valfmd.set_layouterror(layouterror);
+  valfmd.set_locations(locations);
+  // truncate the checksum to the right string length
+  size_t cslen = eos::common::LayoutId::GetChecksumLen(lid) * 2;
+  valfmd.set_mgmchecksum(
+    std::string(valfmd.mgmchecksum()).erase(std::min(valfmd.mgmchecksum().length(),
+        cslen)));
+  valfmd.set_checksum(
+    std::string(valfmd.checksum()).erase(std::min(valfmd.checksum().length(),
+                                         cslen)));
+}
+
 /*----------------------------------------------------------------------------*/
 /**
  * Reset disk information
@@ -722,6 +917,43 @@ FmdDbMapHandler::ResetMgmInformation(eos::common::FileSystem::fsid_t fsid)
 }
 
 
+/*----------------------------------------------------------------------------*/
+/**
+ * Get the hex representation of a checksum stored in the extended attributes
+ *
+ * @param value binary checksum
+ * @param len length of the binary checksum
+ * @param type checksum type
+ *
+ * @return hex checksum, empty if it could not be converted
+ */
+
+/*----------------------------------------------------------------------------*/
+static std::string
+HexDiskChecksum(const char* value, size_t len, const std::string& type)
+{
+  std::string hex;
+  // retrieve a checksum object to get the hex representation
+  XrdOucString envstring = "eos.layout.checksum=";
+  envstring += type.c_str();
+  XrdOucEnv env(envstring.c_str());
+  int checksumtype = eos::common::LayoutId::GetChecksumFromEnv(env);
+  eos::common::LayoutId::layoutid_t layoutid = eos::common::LayoutId::GetId(
+        eos::common::LayoutId::kPlain, checksumtype);
+  eos::fst::CheckSum* checksum = eos::fst::ChecksumPlugins::GetChecksumObject(
+                                   layoutid, false);
+
+  if (checksum) {
+    if (checksum->SetBinChecksum(value, len)) {
+      hex = checksum->GetHexChecksum();
+    }
+
+    delete checksum;
+  }
+
+  return hex;
+}
+
 /*----------------------------------------------------------------------------*/
 /**
  * Resync a single entry from disk
@@ -772,23 +1004,7 @@ FmdDbMapHandler::ResyncDisk(const char* path,
         checktime = (strtoull(checksumStamp.c_str(), 0, 10) / 1000000);
 
         if (checksumLen) {
-          // retrieve a checksum object to get the hex representation
-          XrdOucString envstring = "eos.layout.checksum=";
-          envstring += checksumType.c_str();
-          XrdOucEnv env(envstring.c_str());
-          int checksumtype = eos::common::LayoutId::GetChecksumFromEnv(env);
-          eos::common::LayoutId::layoutid_t layoutid = eos::common::LayoutId::GetId(
-                eos::common::LayoutId::kPlain, checksumtype);
-          eos::fst::CheckSum* checksum = eos::fst::ChecksumPlugins::GetChecksumObject(
-                                           layoutid, false);
-
-          if (checksum) {
-            if (checksum->SetBinChecksum(checksumVal, checksumLen)) {
-              diskchecksum = checksum->GetHexChecksum();
-            }
-
-            delete checksum;
-          }
+          diskchecksum = HexDiskChecksum(checksumVal, checksumLen, checksumType);
         }
 
         // now updaAte the DB
@@ -809,10 +1025,29 @@ FmdDbMapHandler::ResyncDisk(const char* path,
   return retc;
 }
 
+/*----------------------------------------------------------------------------*/
+/**
+ * Directories still to be scanned by the workers of a disk resync
+ */
+
+/*----------------------------------------------------------------------------*/
+struct FmdDbMapHandler::DiskResync {
+  eos::common::FileSystem::fsid_t mFsid; //< filesystem being resynced
+  bool mFlagLayoutError; //< flag the files as orphans until the mgm resync
+  std::mutex mMutex; //< protects the queue
+  std::condition_variable mCond; //< signaled on new directories and at the end
+  std::deque<std::string> mDirs; //< directories to scan
+  size_t mBusy; //< workers scanning a directory
+};
+
 /*----------------------------------------------------------------------------*/
 /**
  * Resync files under path into DB
  *
+ * The hashed fid directories are scanned by a pool of workers, the number of
+ * workers per filesystem (EOS_FST_RESYNC_DISK_THREADS, default 4) bounds the
+ * metadata I/O the resync puts on a disk.
+ *
  * @param path path to scan
  * @param fsid file system id
  *
@@ -825,64 +1060,292 @@ FmdDbMapHandler::ResyncAllDisk(const char* path,
                                eos::common::FileSystem::fsid_t fsid,
                                bool flaglayouterror)
 {
-  char** paths = (char**) calloc(2, sizeof(char*));
-  paths[0] = (char*) path;
-  paths[1] = 0;
-
-  if (!paths) {
-    return false;
-  }
-
   if (flaglayouterror) {
     isSyncing[fsid] = true;
   }
 
   if (!ResetDiskInformation(fsid)) {
     eos_err("failed to reset the disk information before resyncing");
-    free(paths);
     return false;
   }
 
-  // scan all the files
-  FTS* tree = fts_open(paths, FTS_NOCHDIR, 0);
-
-  if (!tree) {
-    eos_err("fts_open failed");
-    free(paths);
+  if (access(path, R_OK | X_OK)) {
+    eos_err("msg=\"cannot scan filesystem\" path=%s errno=%d", path, errno);
     return false;
   }
 
-  FTSENT* node;
-  unsigned long long cnt = 0;
+  size_t nworkers = 4;
+
+  if (getenv("EOS_FST_RESYNC_DISK_THREADS") &&
+      (atoi(getenv("EOS_FST_RESYNC_DISK_THREADS")) > 0)) {
+    nworkers = atoi(getenv("EOS_FST_RESYNC_DISK_THREADS"));
+  }
 
-  while ((node = fts_read(tree))) {
-    if (node->fts_level > 0 && node->fts_name[0] == '.') {
-      fts_set(tree, node, FTS_SKIP);
+  {
+    XrdSysMutexHelper lock(mResyncStatsMutex);
+    ResyncStats& stats = mResyncStats[fsid];
+    stats.mFiles = stats.mBytes = 0;
+    gettimeofday(&stats.mStart, 0);
+    stats.mStop.tv_sec = stats.mStop.tv_usec = 0;
+  }
+
+  DiskResync resync;
+  resync.mFsid = fsid;
+  resync.mFlagLayoutError = flaglayouterror;
+  resync.mBusy = 0;
+  resync.mDirs.push_back(path);
+  std::vector<std::thread> workers;
+
+  for (size_t i = 0; i < nworkers; i++) {
+    workers.push_back(std::thread(&FmdDbMapHandler::ResyncDiskDirs, this,
+                                  &resync));
+  }
+
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    it->join();
+  }
+
+  ResyncStats stats;
+  {
+    XrdSysMutexHelper lock(mResyncStatsMutex);
+    gettimeofday(&mResyncStats[fsid].mStop, 0);
+    stats = mResyncStats[fsid];
+  }
+  double elapsed = (stats.mStop.tv_sec - stats.mStart.tv_sec) +
+                   (stats.mStop.tv_usec - stats.mStart.tv_usec) / 1000000.0;
+  eos_info("msg=\"disk resync done\" fsid=%lu nfiles=%llu bytes=%llu "
+           "workers=%lu seconds=%.02f rate=%.02f", (unsigned long) fsid,
+           stats.mFiles, stats.mBytes, (unsigned long) nworkers, elapsed,
+           elapsed > 0 ? stats.mFiles / elapsed : 0.0);
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Worker of a disk resync
+ *
+ * The entries of a directory are read in one go and visited in inode order,
+ * which follows the on-disk layout of the inode tables. Each file is opened
+ * once and its size and extended attributes are read through the descriptor.
+ *
+ * @param resync shared state of the resync
+ */
+
+/*----------------------------------------------------------------------------*/
+void
+FmdDbMapHandler::ResyncDiskDirs(DiskResync* resync)
+{
+  const size_t batchsize = 1000;
+  std::vector<Fmd> batch;
+  std::vector< std::pair<ino_t, std::string> > entries;
+  batch.reserve(batchsize);
+
+  while (1) {
+    std::string dir;
+    {
+      std::unique_lock<std::mutex> lock(resync->mMutex);
+
+      while (resync->mDirs.empty() && resync->mBusy) {
+        resync->mCond.wait(lock);
+      }
+
+      if (resync->mDirs.empty()) {
+        break;
+      }
+
+      dir = resync->mDirs.front();
+      resync->mDirs.pop_front();
+      resync->mBusy++;
+    }
+    DIR* dirp = opendir(dir.c_str());
+
+    if (!dirp) {
+      eos_err("msg=\"failed to open directory\" path=%s errno=%d", dir.c_str(),
+              errno);
     } else {
-      if (node->fts_info == FTS_F) {
-        XrdOucString filePath = node->fts_accpath;
+      struct dirent* dent;
+      entries.clear();
+
+      while ((dent = readdir(dirp))) {
+        // skips '.', '..' and the hidden files of the filesystem
+        if (dent->d_name[0] == '.') {
+          continue;
+        }
+
+        if (dent->d_type == DT_DIR) {
+          std::unique_lock<std::mutex> lock(resync->mMutex);
+          resync->mDirs.push_back(dir + "/" + dent->d_name);
+          resync->mCond.notify_one();
+        } else if ((dent->d_type == DT_REG) || (dent->d_type == DT_UNKNOWN)) {
+          entries.push_back(std::make_pair(dent->d_ino, std::string(dent->d_name)));
+        }
+      }
+
+      std::sort(entries.begin(), entries.end());
 
-        if (!filePath.matches("*.xsmap")) {
-          cnt++;
-          eos_debug("file=%s", filePath.c_str());
-          ResyncDisk(filePath.c_str(), fsid, flaglayouterror);
+      for (auto it = entries.begin(); it != entries.end(); ++it) {
+        const std::string& name = it->second;
+        eos::common::FileId::fileid_t fid = eos::common::FileId::Hex2Fid(
+                                              name.c_str());
+
+        if ((name.length() > 6) &&
+            !name.compare(name.length() - 6, 6, ".xsmap")) {
+          continue;
+        }
 
-          if (!(cnt % 10000)) {
-            eos_info("msg=\"synced files so far\" nfiles=%llu fsid=%lu", cnt,
-                     (unsigned long) fsid);
+        if (!fid) {
+          eos_debug("would convert %s (%s/%s) to fid 0", name.c_str(), dir.c_str(),
+                    name.c_str());
+          continue;
+        }
+
+        int fd = openat(dirfd(dirp), name.c_str(),
+                        O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_NOATIME);
+
+        if ((fd < 0) && (errno == EPERM)) {
+          fd = openat(dirfd(dirp), name.c_str(), O_RDONLY | O_NOFOLLOW | O_NONBLOCK);
+        }
+
+        if (fd < 0) {
+          continue;
+        }
+
+        struct stat buf;
+
+        if (fstat(fd, &buf)) {
+          close(fd);
+          continue;
+        }
+
+        if (S_ISDIR(buf.st_mode)) {
+          std::unique_lock<std::mutex> lock(resync->mMutex);
+          resync->mDirs.push_back(dir + "/" + name);
+          resync->mCond.notify_one();
+        }
+
+        if (!S_ISREG(buf.st_mode)) {
+          close(fd);
+          continue;
+        }
+
+        char value[1024];
+        ssize_t len;
+        std::string checksumType, filecxError, blockcxError;
+        std::string diskchecksum;
+        char checksumVal[SHA_DIGEST_LENGTH];
+        ssize_t checksumLen = fgetxattr(fd, "user.eos.checksum", checksumVal,
+                                        sizeof(checksumVal));
+
+        if ((len = fgetxattr(fd, "user.eos.checksumtype", value, sizeof(value))) > 0) {
+          checksumType.assign(value, len);
+        }
+
+        if ((len = fgetxattr(fd, "user.eos.filecxerror", value, sizeof(value))) > 0) {
+          filecxError.assign(value, len);
+        }
+
+        if ((len = fgetxattr(fd, "user.eos.blockcxerror", value, sizeof(value))) > 0) {
+          blockcxError.assign(value, len);
+        }
+
+        close(fd);
+
+        if (checksumLen > 0) {
+          diskchecksum = HexDiskChecksum(checksumVal, checksumLen, checksumType);
+        }
+
+        batch.resize(batch.size() + 1);
+        Fmd& fmd = batch.back();
+        fmd.set_fid(fid);
+        fmd.set_disksize(buf.st_size);
+        fmd.set_diskchecksum(diskchecksum);
+        fmd.set_checktime(0);
+        fmd.set_filecxerror((filecxError == "1") ? 1 : 0);
+        fmd.set_blockcxerror((blockcxError == "1") ? 1 : 0);
+
+        if (batch.size() == batchsize) {
+          if (!UpdateFromDisk(resync->mFsid, batch, resync->mFlagLayoutError)) {
+            eos_err("failed to update %s DB for fsid=%lu",
+                    eos::common::DbMap::getDbType().c_str(),
+                    (unsigned long) resync->mFsid);
           }
+
+          AddDiskResyncStats(resync->mFsid, batch);
+          batch.clear();
         }
       }
+
+      closedir(dirp);
     }
+
+    std::unique_lock<std::mutex> lock(resync->mMutex);
+    resync->mBusy--;
+
+    if (resync->mDirs.empty() && !resync->mBusy) {
+      // nothing left to scan, release the waiting workers
+      resync->mCond.notify_all();
+    }
+  }
+
+  if (!batch.empty()) {
+    if (!UpdateFromDisk(resync->mFsid, batch, resync->mFlagLayoutError)) {
+      eos_err("failed to update %s DB for fsid=%lu",
+              eos::common::DbMap::getDbType().c_str(),
+              (unsigned long) resync->mFsid);
+    }
+
+    AddDiskResyncStats(resync->mFsid, batch);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Account a committed batch in the disk resync progress
+ */
+
+/*----------------------------------------------------------------------------*/
+void
+FmdDbMapHandler::AddDiskResyncStats(eos::common::FileSystem::fsid_t fsid,
+                                    const std::vector<Fmd>& batch)
+{
+  XrdSysMutexHelper lock(mResyncStatsMutex);
+  ResyncStats& stats = mResyncStats[fsid];
+  unsigned long long before = stats.mFiles;
+  stats.mFiles += batch.size();
+
+  for (auto it = batch.begin(); it != batch.end(); ++it) {
+    stats.mBytes += it->disksize();
+  }
+
+  if ((stats.mFiles / 10000) != (before / 10000)) {
+    struct timeval now;
+    gettimeofday(&now, 0);
+    double elapsed = (now.tv_sec - stats.mStart.tv_sec) +
+                     (now.tv_usec - stats.mStart.tv_usec) / 1000000.0;
+    eos_info("msg=\"synced files so far\" nfiles=%llu fsid=%lu rate=%.02f",
+             stats.mFiles, (unsigned long) fsid,
+             elapsed > 0 ? stats.mFiles / elapsed : 0.0);
   }
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Get the progress of the last disk resync of a filesystem
+ */
 
-  if (fts_close(tree)) {
-    eos_err("fts_close failed");
-    free(paths);
+/*----------------------------------------------------------------------------*/
+bool
+FmdDbMapHandler::GetDiskResyncStats(eos::common::FileSystem::fsid_t fsid,
+                                    ResyncStats& stats)
+{
+  XrdSysMutexHelper lock(mResyncStatsMutex);
+  auto it = mResyncStats.find(fsid);
+
+  if (it == mResyncStats.end()) {
     return false;
   }
 
-  free(paths);
+  stats = it->second;
   return true;
 }
 
@@ -1017,82 +1480,224 @@ FmdDbMapHandler::ResyncAllMgm(eos::common::FileSystem::fsid_t fsid,
   }
 
   XrdOucString consolestring =
-    "/proc/admin/?&mgm.format=fuse&mgm.cmd=fs&mgm.subcmd=dumpmd&mgm.dumpmd.storetime=1&mgm.dumpmd.option=m&mgm.fsid=";
+    "/proc/admin/?&mgm.format=fuse&mgm.cmd=fs&mgm.subcmd=dumpmd&mgm.dumpmd.storetime=1&mgm.dumpmd.option=m&mgm.dumpmd.format=proto&mgm.fsid=";
   consolestring += (int) fsid;
   XrdOucString url = "root://";
   url += manager;
   url += "//";
   url += consolestring;
-  // we run an external command and parse the output
-  char* tmpfile = tempnam("/tmp/", "efstd");
-  XrdOucString cmd = "env XrdSecPROTOCOL=sss xrdcp -s \"";
-  cmd += url;
-  cmd += "\" ";
-  cmd += tmpfile;
-  int rc = system(cmd.c_str());
-
-  if (WEXITSTATUS(rc)) {
-    eos_err("%s returned %d", cmd.c_str(), WEXITSTATUS(rc));
+  // the binary dump is read in-process and applied while it arrives
+  XrdCl::File file;
+  XrdCl::XRootDStatus status = file.Open(url.c_str(), XrdCl::OpenFlags::Read);
+
+  if (!status.IsOK()) {
+    eos_err("msg=\"failed to open the mgm dump\" fsid=%lu status=\"%s\"",
+            (unsigned long) fsid, status.ToString().c_str());
     return false;
-  } else {
-    eos_debug("%s executed successfully", cmd.c_str());
   }
 
-  // parse the result
-  std::ifstream inFile(tmpfile);
-  std::string dumpentry;
-  // unlink the temporary file
-  unlink(tmpfile);
+  const uint32_t blocksize = 4 * 1024 * 1024;
+  const size_t batchsize = 10000;
+  const size_t taglen = strlen(eos::common::DumpMd::Tag());
+  std::vector<char> block(blocksize);
+  std::string pending; // unparsed bytes, at most one record after a block
+  std::vector<Fmd> batch;
+  batch.reserve(batchsize);
+  bool header = false;
+  bool text = false; // an mgm without the binary dump sends the text one
+  bool complete = false;
+  bool retc = true;
+  uint64_t offset = 0;
+  uint32_t nbytes = 0;
   unsigned long long cnt = 0;
+  struct timeval start;
+  struct timeval now;
+  struct timezone tz;
+  gettimeofday(&start, &tz);
+  auto flush_batch = [&]() {
+    if (!UpdateFromMgm(fsid, batch)) {
+      eos_err("msg=\"failed to update fmd batch\" fsid=%lu", (unsigned long) fsid);
+    }
 
-  while (std::getline(inFile, dumpentry)) {
-    cnt++;
-    eos_debug("line=%s", dumpentry.c_str());
-    XrdOucEnv* env = new XrdOucEnv(dumpentry.c_str());
-
-    if (env) {
-      struct Fmd fMd;
-      FmdHelper::Reset(fMd);
-
-      if (EnvMgmToFmdSqlite(*env, fMd)) {
-        // get/create one
-        FmdHelper* fmd = GetFmd(fMd.fid(), fsid, fMd.uid(), fMd.gid(), fMd.lid(), true,
-                                true);
-        fMd.set_layouterror(FmdHelper::LayoutError(fsid, fMd.lid(), fMd.locations()));
-
-        if (fmd) {
-          // check if it exists on disk
-          if (fmd->fMd.disksize() == 0xfffffffffff1ULL) {
-            fMd.set_layouterror(fMd.layouterror() | eos::common::LayoutId::kMissing);
-            eos_warning("found missing replica for fid=%llu on fsid=%lu", fMd.fid(),
-                        (unsigned long) fsid);
-          }
+    cnt += batch.size();
+    batch.clear();
+    gettimeofday(&now, &tz);
+    double elapsed = (now.tv_sec - start.tv_sec) +
+                     (now.tv_usec - start.tv_usec) / 1000000.0;
+    eos_info("msg=\"synced files so far\" nfiles=%llu fsid=%lu rate=%.02f",
+             cnt, (unsigned long) fsid, elapsed > 0 ? cnt / elapsed : 0.0);
+  };
 
-          if (!UpdateFromMgm(fsid, fMd.fid(), fMd.cid(), fMd.lid(), fMd.mgmsize(),
-                             fMd.mgmchecksum(), fMd.uid(), fMd.gid(), fMd.ctime(), fMd.ctime_ns(),
-                             fMd.mtime(), fMd.mtime_ns(), fMd.layouterror(), fMd.locations())) {
-            eos_err("failed to update fmd %s", dumpentry.c_str());
-          }
+  do {
+    status = file.Read(offset, blocksize, block.data(), nbytes);
 
-          delete fmd;
-        } else {
-          eos_err("failed to get/create fmd %s", dumpentry.c_str());
+    if (!status.IsOK()) {
+      eos_err("msg=\"failed to read the mgm dump\" fsid=%lu status=\"%s\"",
+              (unsigned long) fsid, status.ToString().c_str());
+      retc = false;
+      break;
+    }
+
+    offset += nbytes;
+    pending.append(block.data(), nbytes);
+    size_t pos = 0;
+
+    if (!header) {
+      if ((pending.length() < taglen) && nbytes) {
+        continue;
+      }
+
+      if (pending.compare(0, taglen, eos::common::DumpMd::Tag())) {
+        eos_warning("msg=\"mgm does not support the binary dump, parsing the "
+                    "text dump\" fsid=%lu", (unsigned long) fsid);
+        header = true;
+        text = true;
+      }
+    }
+
+    if (!header) {
+      // "dumpmd_proto: retc=<retc> "
+      size_t end = pending.find(' ');
+
+      if (end != std::string::npos) {
+        end = pending.find(' ', end + 1);
+      }
+
+      if (end == std::string::npos) {
+        if (nbytes == blocksize) {
+          continue;
         }
-      } else {
-        eos_err("failed to convert %s", dumpentry.c_str());
+
+        eos_err("msg=\"illegal mgm dump header\" fsid=%lu", (unsigned long) fsid);
+        retc = false;
+        break;
       }
 
-      delete env;
+      char tag[128];
+      int mgmretc = 0;
+      int items = sscanf(pending.substr(0, end).c_str(), "%127s retc=%d", tag,
+                         &mgmretc);
+
+      if ((items != 2) || strcmp(tag, eos::common::DumpMd::Tag())) {
+        eos_err("msg=\"illegal mgm dump header\" fsid=%lu", (unsigned long) fsid);
+        retc = false;
+        break;
+      }
+
+      if (mgmretc) {
+        eos_err("msg=\"mgm failed to dump\" fsid=%lu retc=%d", (unsigned long) fsid,
+                mgmretc);
+        retc = false;
+        break;
+      }
+
+      header = true;
+      pos = end + 1;
     }
 
-    if (!(cnt % 10000)) {
-      eos_info("msg=\"synced files so far\" nfiles=%llu fsid=%lu", cnt,
-               (unsigned long) fsid);
+    if (text) {
+      // one env line per file, the dump ends with the reply
+      size_t eol;
+
+      while (pos < pending.length()) {
+        eol = pending.find('\n', pos);
+
+        if ((eol == std::string::npos) && nbytes) {
+          break;
+        }
+
+        if (eol == std::string::npos) {
+          eol = pending.length();
+        }
+
+        std::string dumpentry = pending.substr(pos, eol - pos);
+        pos = eol + 1;
+
+        if (dumpentry.empty()) {
+          continue;
+        }
+
+        XrdOucEnv env(dumpentry.c_str());
+        batch.resize(batch.size() + 1);
+        FmdHelper::Reset(batch.back());
+
+        if (!EnvMgmToFmdSqlite(env, batch.back())) {
+          eos_err("failed to convert %s", dumpentry.c_str());
+          batch.pop_back();
+          continue;
+        }
+
+        if (batch.size() == batchsize) {
+          flush_batch();
+        }
+      }
+
+      if (!nbytes) {
+        complete = true;
+      }
+
+      pending.erase(0, std::min(pos, pending.length()));
+      continue;
     }
+
+    const char* record;
+    uint32_t reclen;
+    size_t len;
+
+    while (!complete &&
+           (len = eos::common::DumpMd::Parse(pending.data() + pos,
+                  pending.length() - pos, record, reclen))) {
+      pos += len;
+
+      if (!reclen) {
+        complete = true;
+        break;
+      }
+
+      batch.resize(batch.size() + 1);
+      if (!batch.back().ParsePartialFromArray(record, reclen)) {
+        eos_err("msg=\"failed to parse mgm dump record\" fsid=%lu length=%u",
+                (unsigned long) fsid, reclen);
+        batch.pop_back();
+        continue;
+      }
+
+      if (batch.size() == batchsize) {
+        flush_batch();
+      }
+    }
+
+    pending.erase(0, pos);
+  } while (nbytes && !complete);
+
+  file.Close();
+
+  if (retc && !batch.empty()) {
+    if (!UpdateFromMgm(fsid, batch)) {
+      eos_err("msg=\"failed to update fmd batch\" fsid=%lu", (unsigned long) fsid);
+    }
+
+    cnt += batch.size();
+  }
+
+  if (retc && !complete) {
+    eos_err("msg=\"truncated mgm dump\" fsid=%lu nfiles=%llu",
+            (unsigned long) fsid, cnt);
+    retc = false;
+  }
+
+  gettimeofday(&now, &tz);
+  double elapsed = (now.tv_sec - start.tv_sec) +
+                   (now.tv_usec - start.tv_usec) / 1000000.0;
+  eos_info("msg=\"mgm resync done\" fsid=%lu nfiles=%llu bytes=%llu "
+           "seconds=%.02f rate=%.02f", (unsigned long) fsid, cnt,
+           (unsigned long long) offset, elapsed, elapsed > 0 ? cnt / elapsed : 0.0);
+
+  if (!retc) {
+    return false;
   }
 
   isSyncing[fsid] = false;
-  free(tmpfile);
   return true;
 }
 
@@ -182,6 +182,12 @@ public:
                               std::string diskchecksum, unsigned long checktime, bool filecxerror,
                               bool blockcxerror, bool flaglayouterror);
 
+  // ---------------------------------------------------------------------------
+  //! Update a batch of fmd records from disk contents in one DB write batch
+  // ---------------------------------------------------------------------------
+  bool UpdateFromDisk(eos::common::FileSystem::fsid_t fsid,
+                      std::vector<Fmd>& batch, bool flaglayouterror);
+
   // ---------------------------------------------------------------------------
   //! Update fmd from mgm contents
   // ---------------------------------------------------------------------------
@@ -192,12 +198,36 @@ public:
                              unsigned long long ctime_ns, unsigned long long mtime,
                              unsigned long long mtime_ns, int layouterror, std::string locations);
 
+  // ---------------------------------------------------------------------------
+  //! Update a batch of fmd records from mgm contents in one DB write batch
+  // ---------------------------------------------------------------------------
+  bool UpdateFromMgm(eos::common::FileSystem::fsid_t fsid,
+                     std::vector<Fmd>& batch);
+
   // ---------------------------------------------------------------------------
   //! Resync File meta data found under path
   // ---------------------------------------------------------------------------
   virtual bool ResyncAllDisk(const char* path,
                              eos::common::FileSystem::fsid_t fsid, bool flaglayouterror);
 
+  // ---------------------------------------------------------------------------
+  //! Progress of the last disk resync of a filesystem
+  // ---------------------------------------------------------------------------
+  struct ResyncStats {
+    unsigned long long mFiles; //< files resynced so far
+    unsigned long long mBytes; //< size of the files resynced so far
+    struct timeval mStart; //< start of the resync
+    struct timeval mStop; //< end of the resync, 0 while running
+  };
+
+  // ---------------------------------------------------------------------------
+  //! Get the progress of the last disk resync of a filesystem
+  //!
+  //! @return false if the filesystem was not resynced from disk
+  // ---------------------------------------------------------------------------
+  bool GetDiskResyncStats(eos::common::FileSystem::fsid_t fsid,
+                          ResyncStats& stats);
+
   // ---------------------------------------------------------------------------
   //! Resync a single entry from Disk
   // ---------------------------------------------------------------------------
@@ -212,7 +242,8 @@ public:
                          eos::common::FileId::fileid_t fid, const char* manager);
 
   // ---------------------------------------------------------------------------
-  //! Resync all entries from Mgm
+  //! Resync all entries from Mgm, from the binary dump or from the text dump
+  //! if the Mgm doesn't support it
   // ---------------------------------------------------------------------------
   virtual bool ResyncAllMgm(eos::common::FileSystem::fsid_t fsid,
                             const char* manager);
@@ -394,10 +425,47 @@ public:
 
   std::map<eos::common::FileSystem::fsid_t, eos::common::DbMap*> dbmap;
 private:
+  struct DiskResync;
+
+  // ---------------------------------------------------------------------------
+  //! Worker of a disk resync, scans directories from the shared queue and
+  //! commits what it finds in batches
+  // ---------------------------------------------------------------------------
+  void ResyncDiskDirs(DiskResync* resync);
+
+  // ---------------------------------------------------------------------------
+  //! Account a committed batch in the disk resync progress
+  // ---------------------------------------------------------------------------
+  void AddDiskResyncStats(eos::common::FileSystem::fsid_t fsid,
+                          const std::vector<Fmd>& batch);
+
+  // ---------------------------------------------------------------------------
+  //! Set the disk information of an fmd record
+  // ---------------------------------------------------------------------------
+  static void SetDiskInfo(Fmd& valfmd, eos::common::FileId::fileid_t fid,
+                          eos::common::FileSystem::fsid_t fsid,
+                          unsigned long long disksize,
+                          const std::string& diskchecksum,
+                          unsigned long checktime, bool filecxerror,
+                          bool blockcxerror, bool flaglayouterror);
+
+  // ---------------------------------------------------------------------------
+  //! Set the mgm information of an fmd record
+  // ---------------------------------------------------------------------------
+  static void SetMgmInfo(Fmd& valfmd, eos::common::FileId::fileid_t cid,
+                         eos::common::LayoutId::layoutid_t lid,
+                         unsigned long long mgmsize, const std::string& mgmchecksum,
+                         uid_t uid, gid_t gid, unsigned long long ctime,
+                         unsigned long long ctime_ns, unsigned long long mtime,
+                         unsigned long long mtime_ns, int layouterror,
+                         const std::string& locations);
+
 #ifndef EOS_SQLITE_DBMAP
   eos::common::LvDbDbMapInterface::Option lvdboption;
 #endif
   std::map<eos::common::FileSystem::fsid_t, std::string> DBfilename;
+  XrdSysMutex mResyncStatsMutex; //< protects mResyncStats
+  std::map<eos::common::FileSystem::fsid_t, ResyncStats> mResyncStats;
 };
 
 // ---------------------------------------------------------------------------
@@ -114,6 +114,8 @@ EOSFSTNAMESPACE_BEGIN
 //------------------------------------------------------------------------------
 XrdFstOfs::XrdFstOfs() :
   eos::common::LogId(),
+  mXsRescanBytes(0),
+  mXsRescanBytesSaved(0),
   mHostName(NULL)
 {
   Eroute = 0;
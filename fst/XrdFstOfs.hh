@@ -48,6 +48,7 @@
 #include "Xrd/XrdScheduler.hh"
 /*----------------------------------------------------------------------------*/
 #include <sys/mman.h>
+#include <atomic>
 #include <queue>
 /*----------------------------------------------------------------------------*/
 
@@ -396,6 +397,11 @@ public:
   static XrdSysMutex ShutdownMutex; //! protecting Shutdown variable
   static bool Shutdown; //! indicating if a shutdown procedure is running
 
+  //! Bytes re-read to complete file checksums on close
+  std::atomic<unsigned long long> mXsRescanBytes;
+  //! Bytes not re-read on close thanks to combined range checksums
+  std::atomic<unsigned long long> mXsRescanBytesSaved;
+
   HttpServer* httpd; //! embedded http server
   const char* mHostName; ///< FST hostname
 
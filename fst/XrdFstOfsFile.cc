@@ -1187,6 +1187,36 @@ XrdFstOfsFile::AddReadTime()
 }
 
 
+//------------------------------------------------------------------------------
+// Account the seek to a read offset for monitoring
+//------------------------------------------------------------------------------
+void
+XrdFstOfsFile::AddReadSeek(XrdSfsFileOffset fileOffset)
+{
+  if (rOffset != static_cast<unsigned long long>(fileOffset)) {
+    if (rOffset < static_cast<unsigned long long>(fileOffset)) {
+      nFwdSeeks++;
+      sFwdBytes += (fileOffset - rOffset);
+    } else {
+      nBwdSeeks++;
+      sBwdBytes += (rOffset - fileOffset);
+    }
+
+    if ((rOffset + (EOS_FSTOFS_LARGE_SEEKS)) < (static_cast<unsigned long long>
+        (fileOffset))) {
+      sXlFwdBytes += (fileOffset - rOffset);
+      nXlFwdSeeks++;
+    }
+
+    if ((static_cast<unsigned long long>(rOffset) > (EOS_FSTOFS_LARGE_SEEKS)) &&
+        (rOffset - (EOS_FSTOFS_LARGE_SEEKS)) > (static_cast<unsigned long long>
+            (fileOffset))) {
+      sXlBwdBytes += (rOffset - fileOffset);
+      nXlBwdSeeks++;
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 //
 //------------------------------------------------------------------------------
@@ -1432,21 +1462,25 @@ XrdFstOfsFile::verifychecksum()
     //............................................................................
     if (checkSum->NeedsRecalculation()) {
       unsigned long long scansize = 0;
+      unsigned long long savedsize = 0;
       float scantime = 0; // is ms
 
       if (!XrdOfsFile::fctl(SFS_FCTL_GETFD, 0, error)) {
         //......................................................................
-        // rescan the file
-        //......................................................................
+        // rescan the parts of the file not covered by the written ranges
         //......................................................................
         eos::fst::CheckSum::ReadCallBack::callback_data_t cbd;
         cbd.caller = (void*) layOut;
         eos::fst::CheckSum::ReadCallBack cb(LayoutReadCB, cbd);
 
-        if (checkSum->ScanFile(cb, scansize, scantime)) {
+        if (checkSum->ScanHoles(cb, scansize, savedsize, scantime)) {
           XrdOucString sizestring;
-          eos_info("info=\"rescanned checksum\" size=%s time=%.02f ms rate=%.02f MB/s %s",
+          XrdOucString savedstring;
+          gOFS.mXsRescanBytes += scansize;
+          gOFS.mXsRescanBytesSaved += savedsize;
+          eos_info("info=\"rescanned checksum\" size=%s saved=%s time=%.02f ms rate=%.02f MB/s %s",
                    eos::common::StringConversion::GetReadableSizeString(sizestring, scansize, "B"),
+                   eos::common::StringConversion::GetReadableSizeString(savedstring, savedsize, "B"),
                    scantime,
                    1.0 * scansize / 1000 / (scantime ? scantime : 99999999999999LL),
                    checkSum->GetHexChecksum()
@@ -2287,28 +2321,7 @@ XrdFstOfsFile::readofs(XrdSfsFileOffset fileOffset,
   }
 
   // Account seeks for monitoring
-  if (rOffset != static_cast<unsigned long long>(fileOffset)) {
-    if (rOffset < static_cast<unsigned long long>(fileOffset)) {
-      nFwdSeeks++;
-      sFwdBytes += (fileOffset - rOffset);
-    } else {
-      nBwdSeeks++;
-      sBwdBytes += (rOffset - fileOffset);
-    }
-
-    if ((rOffset + (EOS_FSTOFS_LARGE_SEEKS)) < (static_cast<unsigned long long>
-        (fileOffset))) {
-      sXlFwdBytes += (fileOffset - rOffset);
-      nXlFwdSeeks++;
-    }
-
-    if ((static_cast<unsigned long long>(rOffset) > (EOS_FSTOFS_LARGE_SEEKS)) &&
-        (rOffset - (EOS_FSTOFS_LARGE_SEEKS)) > (static_cast<unsigned long long>
-            (fileOffset))) {
-      sXlBwdBytes += (rOffset - fileOffset);
-      nXlBwdSeeks++;
-    }
-  }
+  AddReadSeek(fileOffset);
 
   if (rc > 0) {
     if (layOut->IsEntryServer()) {
@@ -2326,6 +2339,59 @@ XrdFstOfsFile::readofs(XrdSfsFileOffset fileOffset,
 
 
 
+//------------------------------------------------------------------------------
+// Get the file descriptor of the local replica for zero-copy reads
+//------------------------------------------------------------------------------
+int
+XrdFstOfsFile::GetZeroCopyFd()
+{
+  if (isRW || (tpcFlag != kTpcNone) || hasBlockXs || !layOut ||
+      gOFS.Simulate_IO_read_error) {
+    return -1;
+  }
+
+  // The data has to come unmodified from a single local replica
+  if ((eos::common::LayoutId::GetLayoutType(layOut->GetLayoutId()) !=
+       eos::common::LayoutId::kPlain) || !layOut->GetFileIo() ||
+      (layOut->GetFileIo()->GetIoType() != "LocalIo")) {
+    return -1;
+  }
+
+  XrdOucErrInfo fd_error;
+
+  if (XrdOfsFile::fctl(SFS_FCTL_GETFD, 0, fd_error)) {
+    return -1;
+  }
+
+  int fd = fd_error.getErrInfo();
+  return (fd >= 0) ? fd : -1;
+}
+
+//------------------------------------------------------------------------------
+// Account a read served from the descriptor returned by GetZeroCopyFd
+//------------------------------------------------------------------------------
+void
+XrdFstOfsFile::AddZeroCopyRead(XrdSfsFileOffset fileOffset,
+                               unsigned long long length,
+                               const struct timeval& start)
+{
+  cTime = start;
+  rCalls++;
+  AddReadSeek(fileOffset);
+
+  if (length) {
+    if (layOut->IsEntryServer()) {
+      XrdSysMutexHelper vecLock(vecMutex);
+      rvec.push_back(length);
+    }
+
+    rOffset = fileOffset + length;
+  }
+
+  gettimeofday(&lrTime, &tz);
+  AddReadTime();
+}
+
 //------------------------------------------------------------------------------
 //
 //------------------------------------------------------------------------------
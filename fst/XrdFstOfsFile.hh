@@ -362,6 +362,26 @@ public:
     return fMd->fMd.checksum();
   }
 
+  //--------------------------------------------------------------------------
+  //! Get the file descriptor of the local replica if a read can be served
+  //! directly from it by the kernel (sendfile) instead of the layout, this is
+  //! the case for plain layouts on a local file system opened for reading
+  //! without block checksums or third party copy
+  //!
+  //! @return file descriptor owned by this object or -1
+  //--------------------------------------------------------------------------
+  int GetZeroCopyFd();
+
+  //--------------------------------------------------------------------------
+  //! Account a read served from the descriptor returned by GetZeroCopyFd
+  //!
+  //! @param fileOffset offset of the data sent
+  //! @param length bytes sent
+  //! @param start time when sending the data started
+  //--------------------------------------------------------------------------
+  void AddZeroCopyRead(XrdSfsFileOffset fileOffset, unsigned long long length,
+                       const struct timeval& start);
+
   //--------------------------------------------------------------------------
   //! Check for chunked upload flag
   //--------------------------------------------------------------------------
@@ -518,6 +538,12 @@ private:
   void AddReadTime();
 
 
+  //--------------------------------------------------------------------------
+  //! Account the seek to a read offset for monitoring
+  //--------------------------------------------------------------------------
+  void AddReadSeek(XrdSfsFileOffset fileOffset);
+
+
   //--------------------------------------------------------------------------
   //! Compute total time to serve vector read requests
   //--------------------------------------------------------------------------
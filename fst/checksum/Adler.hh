@@ -26,129 +26,41 @@
 
 /*----------------------------------------------------------------------------*/
 #include "fst/Namespace.hh"
-#include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/CombinableCheckSum.hh"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucString.hh"
 /*----------------------------------------------------------------------------*/
 #include <zlib.h>
-#include <map>
 
 /*----------------------------------------------------------------------------*/
 
 EOSFSTNAMESPACE_BEGIN
 
-struct ltoff_t
+class Adler : public CombinableCheckSum
 {
-
-  bool operator()(off_t s1, off_t s2) const
-  {
-    return (s1 < s2);
-  }
-};
-
-typedef struct
-{
-  off_t offset;
-  size_t length;
-  unsigned int adler;
-} Chunk;
-
-typedef std::map<off_t, Chunk, ltoff_t> MapChunks;
-typedef std::map<off_t, Chunk, ltoff_t>::iterator IterMap;
-
-class Adler : public CheckSum
-{
-private:
-  off_t adleroffset;
-  off_t maxoffset;
-  unsigned int adler;
-  MapChunks map;
-
 public:
 
-  Adler () : CheckSum ("adler")
+  Adler () : CombinableCheckSum ("adler")
   {
     Reset();
   }
 
-  unsigned int GetAdler() {return adler;}
-
-  bool Add (const char* buffer, size_t length, off_t offset);
-  MapChunks& AddElementToMap (MapChunks& map, Chunk& chunk);
-
-  off_t
-  GetLastOffset ()
-  {
-    return adleroffset;
-  }
-
-  off_t
-  GetMaxOffset ()
-  {
-    return maxoffset;
-  }
-
-  int
-  GetCheckSumLen ()
-  {
-    return sizeof (unsigned int);
-  }
-  void ValidateAdlerMap ();
-
-  const char* GetHexChecksum ();
-  const char* GetBinChecksum (int &len);
-
-  void Finalize ();
-
-  void
-  Reset ()
-  {
-    map.clear();
-    adleroffset = 0;
-    adler = adler32(0L, Z_NULL, 0);
-    needsRecalculation = false;
-    maxoffset = 0;
-    finalized = false;
-  }
-
-  void
-  ResetInit (off_t offsetInit, size_t lengthInit, const char* checksumInitHex)
+  unsigned int
+  GetAdler ()
   {
-    Chunk currChunk;
-    maxoffset = 0;
-    adleroffset = offsetInit + lengthInit;
-
-    // check if this is actually a valid pointer
-    if (checksumInitHex)
-      return;
-
-    int checksumInitBin = strtol(checksumInitHex, 0, 16);
-
-    // if a file is truncated we get 0,0,<some checksum => reset to 0
-    if (lengthInit != 0)
-    {
-      adler = checksumInitBin;
-    }
-    else
-    {
-      adler = adler32(0L, Z_NULL, 0);
-    }
-
-    fprintf(stderr, "adler is %x\n", adler);
-    currChunk.offset = offsetInit;
-    currChunk.length = lengthInit;
-    currChunk.adler = adler;
-
-    map.clear();
-    map = AddElementToMap(map, currChunk);
-    maxoffset = (offsetInit + lengthInit);
-    needsRecalculation = false;
+    Finalize();
+    return mValue;
   }
 
   virtual
   ~Adler () { };
 
+protected:
+
+  uint32_t InitValue ();
+  uint32_t Update (uint32_t value, const char* buffer, size_t length);
+  uint32_t Combine (uint32_t value1, uint32_t value2, off_t length2);
 };
 
 EOSFSTNAMESPACE_END
@@ -26,7 +26,7 @@
 
 /*----------------------------------------------------------------------------*/
 #include "fst/Namespace.hh"
-#include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/CombinableCheckSum.hh"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucString.hh"
@@ -37,72 +37,37 @@
 
 EOSFSTNAMESPACE_BEGIN
 
-class CRC32 : public CheckSum
+class CRC32 : public CombinableCheckSum
 {
-private:
-  off_t crc32offset;
-  unsigned int crcsum;
-
 public:
 
-  CRC32 () : CheckSum ("crc32")
+  CRC32 () : CombinableCheckSum ("crc32")
   {
     Reset();
   }
 
-  off_t
-  GetLastOffset ()
-  {
-    return crc32offset;
-  }
-
-  bool
-  Add (const char* buffer, size_t length, off_t offset)
-  {
-    if (offset != crc32offset)
-    {
-      needsRecalculation = true;
-      return false;
-    }
-    crcsum = crc32(crcsum, (const Bytef*) buffer, length);
-    crc32offset += length;
-    return true;
-  }
+  virtual
+  ~CRC32 () { };
 
-  const char*
-  GetHexChecksum ()
-  {
-    char scrc32[1024];
-    sprintf(scrc32, "%08x", crcsum);
-    Checksum = scrc32;
-    return Checksum.c_str();
-  }
+protected:
 
-  const char*
-  GetBinChecksum (int &len)
+  uint32_t
+  InitValue ()
   {
-    len = sizeof (unsigned int);
-    return (char*) &crcsum;
+    return crc32(0L, Z_NULL, 0);
   }
 
-  int
-  GetCheckSumLen ()
+  uint32_t
+  Update (uint32_t value, const char* buffer, size_t length)
   {
-    return sizeof (unsigned int);
+    return crc32(value, (const Bytef*) buffer, length);
   }
 
-  void
-  Reset ()
+  uint32_t
+  Combine (uint32_t value1, uint32_t value2, off_t length2)
   {
-    crc32offset = 0;
-    crcsum = crc32(0L, Z_NULL, 0);
-    needsRecalculation = 0;
-    finalized = false;
+    return crc32_combine(value1, value2, length2);
   }
-
-  virtual
-  ~CRC32 () { };
-
 };
 
 EOSFSTNAMESPACE_END
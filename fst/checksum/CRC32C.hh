@@ -26,7 +26,7 @@
 
 /*----------------------------------------------------------------------------*/
 #include "fst/Namespace.hh"
-#include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/CombinableCheckSum.hh"
 #include "fst/checksum/crc32c.h"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucEnv.hh"
@@ -39,89 +39,41 @@
 
 EOSFSTNAMESPACE_BEGIN
 
-class CRC32C : public CheckSum
+class CRC32C : public CombinableCheckSum
 {
-private:
-  off_t crc32coffset;
-  uint32_t crcsum;
-  bool finalized;
-
 public:
 
-  CRC32C () : CheckSum ("crc32c")
+  CRC32C () : CombinableCheckSum ("crc32c")
   {
     Reset();
   }
 
-  off_t
-  GetLastOffset ()
-  {
-    return crc32coffset;
-  }
-
-  bool
-  Add (const char* buffer, size_t length, off_t offset)
-  {
-    if (offset != crc32coffset)
-    {
-        needsRecalculation = true;
-        return false;
-    }
-    crcsum = checksum::crc32c(crcsum, (const Bytef*) buffer, length);
-    crc32coffset += length;
-    return true;
-  }
-
-  const char*
-  GetHexChecksum ()
-  {
-    if (!finalized)
-        Finalize();
-
-    char scrc32[1024];
-    sprintf(scrc32, "%08x", crcsum);
-    Checksum = scrc32;
-    return Checksum.c_str();
-  }
-
-  const char*
-  GetBinChecksum (int &len)
-  {
-    if (!finalized)
-        Finalize();
+  virtual
+  ~CRC32C () { };
 
-    len = sizeof (unsigned int);
-    return (char*) &crcsum;
-  }
+protected:
 
-  int
-  GetCheckSumLen ()
+  //----------------------------------------------------------------------------
+  //! Values are kept in their final (inverted) form so that they can be
+  //! combined and compared with the stored checksums directly
+  //----------------------------------------------------------------------------
+  uint32_t
+  InitValue ()
   {
-    return sizeof (unsigned int);
+    return checksum::crc32cFinish(checksum::crc32cInit());
   }
 
-  void
-  Reset ()
+  uint32_t
+  Update (uint32_t value, const char* buffer, size_t length)
   {
-    crcsum = checksum::crc32cInit();
-    crc32coffset = 0;
-    needsRecalculation = 0;
-    finalized = false;
+    return checksum::crc32cFinish(checksum::crc32c(~value, buffer, length));
   }
 
-  void
-  Finalize ()
+  uint32_t
+  Combine (uint32_t value1, uint32_t value2, off_t length2)
   {
-    if (!finalized)
-    {
-        crcsum = checksum::crc32cFinish(crcsum);
-        finalized = true;
-    }
+    return checksum::crc32cCombine(value1, value2, length2);
   }
-
-  virtual
-  ~CRC32C () { };
-
 };
 
 EOSFSTNAMESPACE_END
@@ -197,6 +197,27 @@ public:
   virtual bool ScanFile(const char* path, off_t offsetInit, size_t lengthInit,
                         const char* partialChecksum,
                         unsigned long long& scansize, float& scantime, int rate = 0);
+
+  //----------------------------------------------------------------------------
+  //! Complete the checksum by reading only the parts of the file it has not
+  //! seen yet. Checksums which can't be combined rescan the whole file.
+  //!
+  //! @param rcb read callback
+  //! @param scansize number of bytes read
+  //! @param savedsize number of bytes which did not have to be read again
+  //! @param scantime scan time in ms
+  //! @param rate maximum scan rate in MB/s, 0 for no limit
+  //!
+  //! @return true if the checksum could be computed, otherwise false
+  //----------------------------------------------------------------------------
+  virtual bool
+  ScanHoles(ReadCallBack rcb, unsigned long long& scansize,
+            unsigned long long& savedsize, float& scantime, int rate = 0)
+  {
+    savedsize = 0;
+    return ScanFile(rcb, scansize, scantime, rate);
+  }
+
   virtual bool SetXSMap(off_t offset);
   virtual bool VerifyXSMap(off_t offset);
 
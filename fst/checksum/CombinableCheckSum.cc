@@ -0,0 +1,356 @@
+// ----------------------------------------------------------------------
+// File: CombinableCheckSum.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/*----------------------------------------------------------------------------*/
+#include "fst/checksum/CombinableCheckSum.hh"
+/*----------------------------------------------------------------------------*/
+#include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+CombinableCheckSum::CombinableCheckSum(const char* name):
+  CheckSum(name), mValue(0), mMaxOffset(0), mDirty(false)
+{
+  mCurrent.mOffset = 0;
+  mCurrent.mLength = 0;
+  mCurrent.mValue = 0;
+}
+
+//------------------------------------------------------------------------------
+// Add a written or read buffer
+//------------------------------------------------------------------------------
+bool
+CombinableCheckSum::Add(const char* buffer, size_t length, off_t offset)
+{
+  if (!length) {
+    return true;
+  }
+
+  off_t end = offset + length;
+  RangeMap::iterator next = mRanges.lower_bound(offset);
+  finalized = false;
+
+  if ((offset == mCurrent.mOffset + mCurrent.mLength) &&
+      ((next == mRanges.end()) || (next->first >= end))) {
+    // Sequential write not touching any other range
+    mCurrent.mValue = Update(mCurrent.mValue, buffer, length);
+    mCurrent.mLength += length;
+  } else {
+    needsRecalculation = true;
+    StoreCurrent();
+    DropOverlapping(offset, length);
+    mCurrent.mOffset = offset;
+    mCurrent.mLength = length;
+    mCurrent.mValue = Update(InitValue(), buffer, length);
+  }
+
+  if (end > mMaxOffset) {
+    mMaxOffset = end;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Move the current range into the map of ranges
+//------------------------------------------------------------------------------
+void
+CombinableCheckSum::StoreCurrent()
+{
+  if (mCurrent.mLength) {
+    mRanges[mCurrent.mOffset] = mCurrent;
+  }
+
+  mCurrent.mOffset += mCurrent.mLength;
+  mCurrent.mLength = 0;
+  mCurrent.mValue = InitValue();
+}
+
+//------------------------------------------------------------------------------
+// Remove all the ranges overlapping [offset, offset + length)
+//------------------------------------------------------------------------------
+void
+CombinableCheckSum::DropOverlapping(off_t offset, off_t length)
+{
+  RangeMap::iterator it = mRanges.lower_bound(offset);
+
+  if (it != mRanges.begin()) {
+    RangeMap::iterator prev = it;
+    --prev;
+
+    if (prev->second.mOffset + prev->second.mLength > offset) {
+      it = prev;
+    }
+  }
+
+  while ((it != mRanges.end()) && (it->first < offset + length)) {
+    mRanges.erase(it++);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Combine the ranges if they cover the file without holes
+//------------------------------------------------------------------------------
+void
+CombinableCheckSum::Finalize()
+{
+  if (finalized) {
+    return;
+  }
+
+  StoreCurrent();
+  off_t pos = 0;
+  uint32_t value = InitValue();
+  bool holes = false;
+
+  for (auto it = mRanges.begin(); it != mRanges.end(); ++it) {
+    if (it->first != pos) {
+      holes = true;
+      break;
+    }
+
+    value = (pos ? Combine(value, it->second.mValue, it->second.mLength) :
+             it->second.mValue);
+    pos += it->second.mLength;
+  }
+
+  if (!holes && !mDirty) {
+    // Keep a single range so that sequential writes can still continue
+    mRanges.clear();
+    mCurrent.mOffset = 0;
+    mCurrent.mLength = pos;
+    mCurrent.mValue = value;
+    mValue = value;
+    needsRecalculation = false;
+  } else {
+    mValue = InitValue();
+    needsRecalculation = true;
+  }
+
+  finalized = true;
+}
+
+//------------------------------------------------------------------------------
+// Reset
+//------------------------------------------------------------------------------
+void
+CombinableCheckSum::Reset()
+{
+  mRanges.clear();
+  mCurrent.mOffset = 0;
+  mCurrent.mLength = 0;
+  mCurrent.mValue = InitValue();
+  mValue = InitValue();
+  mMaxOffset = 0;
+  mDirty = false;
+  needsRecalculation = false;
+  finalized = false;
+}
+
+//------------------------------------------------------------------------------
+// Preset the checksum of an existing range of the file
+//------------------------------------------------------------------------------
+void
+CombinableCheckSum::ResetInit(off_t offsetInit, size_t lengthInit,
+                              const char* checksumInitHex)
+{
+  Reset();
+
+  if (!lengthInit) {
+    return;
+  }
+
+  char* endptr = 0;
+  unsigned long value = (checksumInitHex ?
+                         strtoul(checksumInitHex, &endptr, 16) : 0);
+
+  if (!checksumInitHex || (endptr == checksumInitHex) || *endptr) {
+    // Unknown contents, everything not written has to be rescanned
+    mDirty = true;
+    return;
+  }
+
+  mCurrent.mOffset = offsetInit;
+  mCurrent.mLength = lengthInit;
+  mCurrent.mValue = (uint32_t) value;
+  mMaxOffset = offsetInit + lengthInit;
+}
+
+//------------------------------------------------------------------------------
+// Mark the contents outside of the ranges as modified
+//------------------------------------------------------------------------------
+void
+CombinableCheckSum::SetDirty()
+{
+  mDirty = true;
+  needsRecalculation = true;
+  finalized = false;
+}
+
+//------------------------------------------------------------------------------
+// Get the checksum in hex
+//------------------------------------------------------------------------------
+const char*
+CombinableCheckSum::GetHexChecksum()
+{
+  if (!finalized) {
+    Finalize();
+  }
+
+  char shex[16];
+  snprintf(shex, sizeof(shex), "%08x", mValue);
+  Checksum = shex;
+  return Checksum.c_str();
+}
+
+//------------------------------------------------------------------------------
+// Get the binary checksum
+//------------------------------------------------------------------------------
+const char*
+CombinableCheckSum::GetBinChecksum(int& len)
+{
+  if (!finalized) {
+    Finalize();
+  }
+
+  len = sizeof(uint32_t);
+  return (char*) &mValue;
+}
+
+//------------------------------------------------------------------------------
+// Read only the parts of the file not covered by any range
+//------------------------------------------------------------------------------
+bool
+CombinableCheckSum::ScanHoles(ReadCallBack rcb, unsigned long long& scansize,
+                              unsigned long long& savedsize, float& scantime,
+                              int rate)
+{
+  static int buffersize = 1024 * 1024;
+  struct timezone tz;
+  struct timeval opentime;
+  struct timeval currenttime;
+  scansize = 0;
+  savedsize = 0;
+  scantime = 0;
+  gettimeofday(&opentime, &tz);
+  StoreCurrent();
+  // Holes as (offset, length), the end of the file is read until EOF
+  std::vector<std::pair<off_t, off_t>> holes;
+  off_t pos = 0;
+
+  for (auto it = mRanges.begin(); it != mRanges.end(); ++it) {
+    if (it->first > pos) {
+      holes.push_back(std::make_pair(pos, it->first - pos));
+    }
+
+    pos = it->first + it->second.mLength;
+    savedsize += it->second.mLength;
+  }
+
+  holes.push_back(std::make_pair(pos, (off_t) - 1));
+  char* buffer = (char*) malloc(buffersize);
+
+  if (!buffer) {
+    return false;
+  }
+
+  for (auto hole = holes.begin(); hole != holes.end(); ++hole) {
+    Range range;
+    range.mOffset = hole->first;
+    range.mLength = 0;
+    range.mValue = InitValue();
+    bool tail = (hole->second < 0);
+    int nread = 0;
+
+    do {
+      size_t toread = buffersize;
+
+      if (!tail && (hole->second - range.mLength < (off_t) toread)) {
+        toread = hole->second - range.mLength;
+      }
+
+      errno = 0;
+      rcb.data.offset = range.mOffset + range.mLength;
+      rcb.data.buffer = buffer;
+      rcb.data.size = toread;
+      nread = rcb.call(&rcb.data);
+
+      if (nread < 0) {
+        free(buffer);
+        return false;
+      }
+
+      if (!tail && ((size_t) nread < toread)) {
+        // The file is shorter than the ranges written, don't trust them
+        free(buffer);
+        return ScanFile(rcb, scansize, scantime, rate);
+      }
+
+      if (nread > 0) {
+        range.mValue = Update(range.mValue, buffer, nread);
+        range.mLength += nread;
+        scansize += nread;
+      }
+
+      if (rate) {
+        // regulate the verification rate
+        gettimeofday(&currenttime, &tz);
+        scantime = (((currenttime.tv_sec - opentime.tv_sec) * 1000.0) + ((
+                      currenttime.tv_usec - opentime.tv_usec) / 1000.0));
+        float expecttime = (1.0 * scansize / rate) / 1000.0;
+
+        if (expecttime > scantime) {
+          usleep(1000.0 * (expecttime - scantime));
+        }
+      }
+    } while (tail ? (nread == (int) buffersize) : (range.mLength < hole->second));
+
+    if (range.mLength) {
+      mRanges[range.mOffset] = range;
+
+      if (range.mOffset + range.mLength > mMaxOffset) {
+        mMaxOffset = range.mOffset + range.mLength;
+      }
+    }
+  }
+
+  free(buffer);
+  gettimeofday(&currenttime, &tz);
+  scantime = (((currenttime.tv_sec - opentime.tv_sec) * 1000.0) + ((
+                currenttime.tv_usec - opentime.tv_usec) / 1000.0));
+  mDirty = false;
+  finalized = false;
+  Finalize();
+  return !needsRecalculation;
+}
+
+EOSFSTNAMESPACE_END
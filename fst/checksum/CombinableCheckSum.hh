@@ -0,0 +1,159 @@
+// ----------------------------------------------------------------------
+// File: CombinableCheckSum.hh
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_COMBINABLECHECKSUM_HH__
+#define __EOSFST_COMBINABLECHECKSUM_HH__
+
+/*----------------------------------------------------------------------------*/
+#include "fst/Namespace.hh"
+#include "fst/checksum/CheckSum.hh"
+/*----------------------------------------------------------------------------*/
+#include <map>
+#include <stdint.h>
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Base class of the 32-bit checksums whose value over the concatenation of
+//! two ranges can be computed from the values of the ranges (Adler32, CRC32,
+//! CRC32C).
+//!
+//! Every contiguous run of written bytes is kept as a range with its own
+//! checksum value. Finalize combines the ranges when they cover the file from
+//! offset 0 without holes, so out-of-order writes don't require re-reading the
+//! file. Otherwise ScanHoles reads only the bytes not covered by any range.
+//! A write overlapping existing ranges drops them, their bytes are rescanned.
+//------------------------------------------------------------------------------
+class CombinableCheckSum : public CheckSum
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor - derived classes have to call Reset
+  //----------------------------------------------------------------------------
+  CombinableCheckSum(const char* name);
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  virtual ~CombinableCheckSum() { };
+
+  bool Add(const char* buffer, size_t length, off_t offset);
+
+  off_t
+  GetLastOffset()
+  {
+    return mCurrent.mOffset + mCurrent.mLength;
+  }
+
+  off_t
+  GetMaxOffset()
+  {
+    return mMaxOffset;
+  }
+
+  int
+  GetCheckSumLen()
+  {
+    return sizeof(uint32_t);
+  }
+
+  const char* GetHexChecksum();
+  const char* GetBinChecksum(int& len);
+
+  void Finalize();
+  void Reset();
+
+  //----------------------------------------------------------------------------
+  //! Preset the checksum of an existing range of the file
+  //!
+  //! @param offsetInit start of the range
+  //! @param lengthInit length of the range
+  //! @param checksumInitHex checksum of the range in hex, if empty the range is
+  //!        treated as unknown and will be rescanned
+  //----------------------------------------------------------------------------
+  void ResetInit(off_t offsetInit, size_t lengthInit,
+                 const char* checksumInitHex);
+
+  //----------------------------------------------------------------------------
+  //! Mark the contents outside of the tracked ranges as modified, the end of
+  //! the file will be rescanned
+  //----------------------------------------------------------------------------
+  void SetDirty();
+
+  bool ScanHoles(ReadCallBack rcb, unsigned long long& scansize,
+                 unsigned long long& savedsize, float& scantime, int rate = 0);
+
+protected:
+  //----------------------------------------------------------------------------
+  //! Checksum value of no data
+  //----------------------------------------------------------------------------
+  virtual uint32_t InitValue() = 0;
+
+  //----------------------------------------------------------------------------
+  //! Continue a checksum value with more data
+  //----------------------------------------------------------------------------
+  virtual uint32_t Update(uint32_t value, const char* buffer,
+                          size_t length) = 0;
+
+  //----------------------------------------------------------------------------
+  //! Checksum value of the concatenation of two ranges
+  //!
+  //! @param value1 value of the first range
+  //! @param value2 value of the second range
+  //! @param length2 length of the second range
+  //----------------------------------------------------------------------------
+  virtual uint32_t Combine(uint32_t value1, uint32_t value2,
+                           off_t length2) = 0;
+
+  uint32_t mValue; ///< Checksum of the file once finalized
+
+private:
+  //! Contiguous range of the file with its checksum value
+  struct Range {
+    off_t mOffset;
+    off_t mLength;
+    uint32_t mValue;
+  };
+
+  //! Ranges indexed by their start offset, never overlapping
+  typedef std::map<off_t, Range> RangeMap;
+
+  //----------------------------------------------------------------------------
+  //! Move the current range into the map of ranges
+  //----------------------------------------------------------------------------
+  void StoreCurrent();
+
+  //----------------------------------------------------------------------------
+  //! Remove all the ranges overlapping [offset, offset + length)
+  //----------------------------------------------------------------------------
+  void DropOverlapping(off_t offset, off_t length);
+
+  Range mCurrent; ///< Range extended by sequential writes, not in mRanges
+  RangeMap mRanges; ///< All the other ranges
+  off_t mMaxOffset; ///< Highest offset written
+  bool mDirty; ///< Contents outside the ranges may have changed
+};
+
+EOSFSTNAMESPACE_END
+
+#endif
@@ -0,0 +1,158 @@
+// ----------------------------------------------------------------------
+// File: adler32.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/checksum/adler32.h"
+#include <cstdio>
+#include <zlib.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace checksum {
+
+  // Largest prime smaller than 65536
+  static const uint32_t kBase = 65521;
+  // Largest n such that 255n(n+1)/2 + (n+1)(kBase-1) <= 2^32-1, rounded down
+  // to a multiple of the 32 byte vector block
+  static const size_t kNmax = 5536;
+
+  static uint32_t adler32_CPUDetection(uint32_t adler, const void* data, size_t length) {
+    // Avoid issues that could potentially be caused by multiple threads: use a local variable
+    Adler32FunctionPtr best = detectBestAdler32();
+    adler32 = best;
+    return best(adler, data, length);
+  }
+
+  Adler32FunctionPtr adler32 = adler32_CPUDetection;
+
+  bool adler32HasAvx2() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+
+  Adler32FunctionPtr detectBestAdler32() {
+    if (adler32HasAvx2()) {
+      fprintf(stderr,"------ --:--:-- ----- ADLER32 configured for machine with AVX2 extension\n");
+      return adler32Avx2;
+    }
+
+    fprintf(stderr,"------ --:--:-- ----- ADLER32 configured for machine without AVX2 extension\n");
+    return adler32Zlib;
+  }
+
+  const char* adler32Name() {
+    if (adler32 == adler32_CPUDetection) {
+      return "undetected";
+    } else if (adler32 == adler32Avx2) {
+      return "avx2";
+    } else {
+      return "zlib";
+    }
+  }
+
+  uint32_t adler32Zlib(uint32_t adler, const void* data, size_t length) {
+    // zlib takes the length as uInt, feed very large buffers in pieces
+    const Bytef* p_buf = (const Bytef*) data;
+
+    while (length) {
+      uInt len = (length > (1u << 30) ? (1u << 30) : (uInt) length);
+      adler = ::adler32(adler, p_buf, len);
+      p_buf += len;
+      length -= len;
+    }
+
+    return adler;
+  }
+
+#if defined(__x86_64__)
+  __attribute__((target("avx2")))
+  static inline uint32_t hsum256(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v),
+                                _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    return (uint32_t) _mm_cvtsi128_si32(sum);
+  }
+#endif
+
+  // Adler-32 over 32 byte blocks: for a block b[0..31] s1 grows by sum(b[i])
+  // and s2 by 32 * s1 + sum((32 - i) * b[i]). Per lane partial sums are kept
+  // in vectors and reduced modulo kBase every kNmax bytes.
+#if defined(__x86_64__)
+  __attribute__((target("avx2")))
+  uint32_t adler32Avx2(uint32_t adler, const void* data, size_t length) {
+    const unsigned char* p_buf = (const unsigned char*) data;
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+    const __m256i taps = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                          24, 23, 22, 21, 20, 19, 18, 17,
+                                          16, 15, 14, 13, 12, 11, 10, 9,
+                                          8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    while (length >= 32) {
+      size_t chunk = (length < kNmax ? length : kNmax) & ~((size_t) 31);
+      size_t blocks = chunk / 32;
+      __m256i v_s1 = zero;
+      __m256i v_s2 = zero;
+      // Sum of v_s1 before each block, multiplied by 32 at the end
+      __m256i v_ps = zero;
+      s2 += s1 * chunk;
+
+      for (size_t i = 0; i < blocks; i++) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*) p_buf);
+        v_ps = _mm256_add_epi32(v_ps, v_s1);
+        v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+        v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(
+                                  _mm256_maddubs_epi16(bytes, taps), ones));
+        p_buf += 32;
+      }
+
+      v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 5));
+      s1 += hsum256(v_s1);
+      s2 += hsum256(v_s2);
+      s1 %= kBase;
+      s2 %= kBase;
+      length -= chunk;
+    }
+
+    while (length--) {
+      s1 += *p_buf++;
+      s2 += s1;
+    }
+
+    s1 %= kBase;
+    s2 %= kBase;
+    return (s2 << 16) | s1;
+  }
+#else
+  uint32_t adler32Avx2(uint32_t adler, const void* data, size_t length) {
+    return adler32Zlib(adler, data, length);
+  }
+#endif
+
+}  // namespace checksum
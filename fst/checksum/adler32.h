@@ -0,0 +1,54 @@
+// ----------------------------------------------------------------------
+// File: adler32.h
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_CHECKSUM_ADLER32_H__
+#define __EOSFST_CHECKSUM_ADLER32_H__
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace checksum {
+
+/** Pointer to a function that computes an Adler-32 checksum, the results are
+identical to zlib's adler32.
+@arg adler Previous Adler-32 value, 1 for no data.
+@arg data Pointer to the data to be checksummed.
+@arg length length of the data in bytes.
+*/
+typedef uint32_t (*Adler32FunctionPtr)(uint32_t adler, const void* data, size_t length);
+
+/** This will map automatically to the "best" Adler-32 implementation. */
+extern Adler32FunctionPtr adler32;
+
+Adler32FunctionPtr detectBestAdler32();
+
+uint32_t adler32Zlib(uint32_t adler, const void* data, size_t length);
+uint32_t adler32Avx2(uint32_t adler, const void* data, size_t length);
+
+/** Returns true if the CPU supports adler32Avx2. */
+bool adler32HasAvx2();
+
+/** Returns the name of the implementation selected for adler32. */
+const char* adler32Name();
+
+}  // namespace checksum
+#endif
@@ -8,6 +8,10 @@
 #include <stdlib.h>
 #include "fst/checksum/crc32c.h"
 #include "fst/checksum/crc32ctables.h"
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#endif
 
 #undef __PIC__ 
 
@@ -22,6 +26,22 @@ namespace checksum {
 
   CRC32CFunctionPtr crc32c = crc32c_CPUDetection;
 
+  const char* crc32cName() {
+    if (crc32c == crc32c_CPUDetection) {
+      return "undetected";
+    } else if (crc32c == crc32cHardware64Pclmul) {
+      return "hw64-pclmul";
+    } else if (crc32c == crc32cHardware64) {
+      return "hw64";
+    } else if (crc32c == crc32cHardware32) {
+      return "hw32";
+    } else if (crc32c == crc32cSlicingBy8) {
+      return "slicing-by-8";
+    } else {
+      return "other";
+    }
+  }
+
   static uint32_t cpuid(uint32_t functionInput) {
     uint32_t ecx;
 #if __SIZEOF_POINTER__ == 8
@@ -52,8 +72,10 @@ namespace checksum {
 
   CRC32CFunctionPtr detectBestCRC32C() {
     static const int SSE42_BIT = 20;
+    static const int PCLMULQDQ_BIT = 1;
     uint32_t ecx = cpuid(1);
     bool hasSSE42 = ecx & (1 << SSE42_BIT);
+    bool hasPCLMUL = ecx & (1 << PCLMULQDQ_BIT);
 
     // test if living in a virtual machine
     int rc = system("dmidecode | egrep -i 'manufacturer|product' | grep 'Virtual Machine'");
@@ -70,7 +92,7 @@ namespace checksum {
 
     if (hasSSE42) {
 #ifdef __LP64__
-      return crc32cHardware64;
+      return (hasPCLMUL ? crc32cHardware64Pclmul : crc32cHardware64);
 #else
       return crc32cHardware32;
 #endif
@@ -264,4 +286,128 @@ namespace checksum {
 #endif
   }
 
+#if defined(__x86_64__)
+  // Shift a raw CRC-32C over len zero bytes, k = x^(8 * len - 33) mod P
+  __attribute__((target("sse4.2,pclmul")))
+  static inline uint32_t crc32cShift(uint32_t crc, uint32_t k) {
+    __m128i prod = _mm_clmulepi64_si128(_mm_cvtsi32_si128(crc),
+                                        _mm_cvtsi32_si128(k), 0);
+    return (uint32_t) _mm_crc32_u64(0, _mm_cvtsi128_si64(prod));
+  }
+
+  // Run three independent crc32 instruction streams over consecutive blocks,
+  // which hides the 3 cycle latency of the instruction, and merge them
+  __attribute__((target("sse4.2,pclmul")))
+  static uint32_t crc32cThreeWay(uint32_t crc, const char*& p_buf,
+                                 size_t& length, size_t block, uint32_t k) {
+    while (length >= 3 * block) {
+      uint64_t crc0 = crc;
+      uint64_t crc1 = 0;
+      uint64_t crc2 = 0;
+      const char* end = p_buf + block;
+
+      do {
+        crc0 = _mm_crc32_u64(crc0, *(const uint64_t*) p_buf);
+        crc1 = _mm_crc32_u64(crc1, *(const uint64_t*)(p_buf + block));
+        crc2 = _mm_crc32_u64(crc2, *(const uint64_t*)(p_buf + 2 * block));
+        p_buf += sizeof(uint64_t);
+      } while (p_buf < end);
+
+      crc = crc32cShift(crc32cShift((uint32_t) crc0, k) ^ (uint32_t) crc1, k) ^
+            (uint32_t) crc2;
+      p_buf += 2 * block;
+      length -= 3 * block;
+    }
+
+    return crc;
+  }
+#endif
+
+  // Hardware-accelerated CRC-32C (CRC32 instruction in three streams merged
+  // with PCLMULQDQ), identical results to the other implementations
+  uint32_t crc32cHardware64Pclmul(uint32_t crc, const void* data, size_t length) {
+#if defined(__x86_64__)
+    // Shift constants for 8 KB and 256 B blocks
+    static const uint32_t kLongShift = 0x54a86326;
+    static const uint32_t kShortShift = 0xb9e02b86;
+    const char* p_buf = (const char*) data;
+    crc = crc32cThreeWay(crc, p_buf, length, 8192, kLongShift);
+    crc = crc32cThreeWay(crc, p_buf, length, 256, kShortShift);
+    return crc32cHardware64(crc, p_buf, length);
+#else
+    return crc32cHardware64(crc, data, length);
+#endif
+  }
+
+  // Multiply the 32x32 GF(2) matrix mat with the vector vec
+  static uint32_t gf2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+
+    while (vec) {
+      if (vec & 1) {
+        sum ^= *mat;
+      }
+
+      vec >>= 1;
+      mat++;
+    }
+
+    return sum;
+  }
+
+  static void gf2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; n++) {
+      square[n] = gf2MatrixTimes(mat, mat[n]);
+    }
+  }
+
+  // Same method as zlib's crc32_combine: apply length2 zero bytes to crc1 by
+  // repeated squaring of the operator shifting in one zero bit
+  uint32_t crc32cCombine(uint32_t crc1, uint32_t crc2, uint64_t length2) {
+    uint32_t even[32];
+    uint32_t odd[32];
+
+    if (length2 == 0) {
+      return crc1;
+    }
+
+    // Operator for one zero bit
+    odd[0] = 0x82F63B78;
+    uint32_t row = 1;
+
+    for (int n = 1; n < 32; n++) {
+      odd[n] = row;
+      row <<= 1;
+    }
+
+    // Operators for two and four zero bits
+    gf2MatrixSquare(even, odd);
+    gf2MatrixSquare(odd, even);
+
+    do {
+      // First pass applies one zero byte
+      gf2MatrixSquare(even, odd);
+
+      if (length2 & 1) {
+        crc1 = gf2MatrixTimes(even, crc1);
+      }
+
+      length2 >>= 1;
+
+      if (length2 == 0) {
+        break;
+      }
+
+      gf2MatrixSquare(odd, even);
+
+      if (length2 & 1) {
+        crc1 = gf2MatrixTimes(odd, crc1);
+      }
+
+      length2 >>= 1;
+    } while (length2 != 0);
+
+    return crc1 ^ crc2;
+  }
+
 }  // namespace checksum
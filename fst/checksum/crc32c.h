@@ -32,11 +32,22 @@ static inline uint32_t crc32cFinish(uint32_t crc) {
     return ~crc;
 }
 
+/** Returns the final CRC32-C of the concatenation of two blocks.
+@arg crc1 final CRC32-C of the first block.
+@arg crc2 final CRC32-C of the second block.
+@arg length2 length of the second block in bytes.
+*/
+uint32_t crc32cCombine(uint32_t crc1, uint32_t crc2, uint64_t length2);
+
 uint32_t crc32cSarwate(uint32_t crc, const void* data, size_t length);
 uint32_t crc32cSlicingBy4(uint32_t crc, const void* data, size_t length);
 uint32_t crc32cSlicingBy8(uint32_t crc, const void* data, size_t length);
 uint32_t crc32cHardware32(uint32_t crc, const void* data, size_t length);
 uint32_t crc32cHardware64(uint32_t crc, const void* data, size_t length);
+uint32_t crc32cHardware64Pclmul(uint32_t crc, const void* data, size_t length);
+
+/** Returns the name of the implementation selected for crc32c. */
+const char* crc32cName();
 
 }  // namespace checksum
 #endif
@@ -311,11 +311,68 @@ HttpHandler::Get(eos::common::HttpRequest* request)
     response->AddHeader("Last-Modified", eos::common::Timing::utctime(mtime));
     // We want to use the file callbacks
     response->mUseFileReaderCallback = true;
+    // or hand the file descriptor to the server if the data allows it
+    mZeroCopy = UseZeroCopy();
   }
 
   return response;
 }
 
+/*----------------------------------------------------------------------------*/
+bool
+HttpHandler::UseZeroCopy()
+{
+  ZeroCopyMode mode = GetZeroCopyMode();
+
+  if ((mode == kZeroCopyOff) || !mFile) {
+    return false;
+  }
+
+  if (mRangeRequest) {
+    // multipart responses interleave the ranges with headers
+    if (mOffsetMap.size() != 1) {
+      return false;
+    }
+
+    mZeroCopyOffset = mOffsetMap.begin()->first;
+  } else {
+    // a full download verifies the checksum while reading through the layout
+    if (mFile->GetChecksum() && (mode != kZeroCopyNoVerify)) {
+      return false;
+    }
+
+    mZeroCopyOffset = 0;
+  }
+
+  return (mFile->GetZeroCopyFd() >= 0);
+}
+
+/*----------------------------------------------------------------------------*/
+HttpHandler::ZeroCopyMode
+HttpHandler::GetZeroCopyMode()
+{
+  static ZeroCopyMode mode = []() {
+    const char* env = getenv("EOS_FST_HTTP_SENDFILE");
+
+    if (!env) {
+      return kZeroCopyOn;
+    }
+
+    std::string value = env;
+
+    if ((value == "0") || (value == "off")) {
+      return kZeroCopyOff;
+    }
+
+    if (value == "noverify") {
+      return kZeroCopyNoVerify;
+    }
+
+    return kZeroCopyOn;
+  }();
+  return mode;
+}
+
 /*----------------------------------------------------------------------------*/
 eos::common::HttpResponse*
 HttpHandler::Head(eos::common::HttpRequest* request)
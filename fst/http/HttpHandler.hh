@@ -77,6 +77,19 @@ public:
   std::string                mLogId;              //< log id used in EOS - determined after Ofs::Open
   int                        mErrCode;            //< first seen error code
   std::string                mErrText;            //< error text
+  bool                       mZeroCopy;           //< serve the response from the file descriptor
+  off_t                      mZeroCopyOffset;     //< file offset of the response served from the descriptor
+  struct timeval             mZeroCopyStart;      //< time when the response was queued
+
+  /**
+   * Use of the zero-copy (sendfile) download path, configured by the
+   * environment variable EOS_FST_HTTP_SENDFILE
+   */
+  enum ZeroCopyMode {
+    kZeroCopyOff,      //< never, every download goes through the layout
+    kZeroCopyOn,       //< unless the download has to verify the checksum (default)
+    kZeroCopyNoVerify  //< also for full downloads, the checksum is not verified
+  };
 
   static XrdSysMutex mOpenMutexMapMutex;
   static std::map<unsigned int, XrdSysMutex*> mOpenMutexMap;
@@ -107,6 +120,10 @@ public:
     mUploadLeftSize         = 0;
     mLastChunk              = false;
     mErrCode                = 0;
+    mZeroCopy               = false;
+    mZeroCopyOffset         = 0;
+    mZeroCopyStart.tv_sec   = 0;
+    mZeroCopyStart.tv_usec  = 0;
   }
 
   /**
@@ -246,6 +263,22 @@ public:
   eos::common::HttpResponse*
   Get (eos::common::HttpRequest *request);
 
+  /**
+   * Decide if the data of a GET response can be sent by the kernel directly
+   * from the file descriptor of the replica. This is possible for plain
+   * replicas on local disks, for full downloads and single range requests.
+   *
+   * @return true if the zero-copy path can be used
+   */
+  bool
+  UseZeroCopy ();
+
+  /**
+   * Get the configured zero-copy mode
+   */
+  static ZeroCopyMode
+  GetZeroCopyMode ();
+
   /**
    * Handle an HTTP HEAD request.
    *
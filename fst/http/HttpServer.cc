@@ -23,6 +23,7 @@
 
 /*----------------------------------------------------------------------------*/
 #include "fst/http/HttpServer.hh"
+#include "fst/http/HttpHandler.hh"
 #include "fst/http/ProtocolHandlerFactory.hh"
 #include "common/http/ProtocolHandler.hh"
 #include "fst/XrdFstOfs.hh"
@@ -145,9 +146,48 @@ HttpServer::Handler(void* cls,
 
   eos_static_debug("\n\n%s", response->ToString().c_str());
   // Create the MHD response
-  struct MHD_Response* mhdResponse;
+  struct MHD_Response* mhdResponse = 0;
+  eos::fst::HttpHandler* httpHandle =
+    dynamic_cast<eos::fst::HttpHandler*>(protocolHandler);
+
+  if (response->mUseFileReaderCallback && httpHandle &&
+      httpHandle->mZeroCopy && httpHandle->mFile) {
+    // Let the kernel send the data (sendfile), the response closes its own
+    // copy of the file descriptor when it is destroyed
+    int fd = httpHandle->mFile->GetZeroCopyFd();
+    fd = (fd >= 0) ? dup(fd) : -1;
+
+    if (fd >= 0) {
+#if MHD_VERSION >= 0x00094600
+      mhdResponse = MHD_create_response_from_fd_at_offset64(
+                      response->mResponseLength, fd,
+                      httpHandle->mZeroCopyOffset);
+#else
+      mhdResponse = MHD_create_response_from_fd_at_offset(
+                      response->mResponseLength, fd,
+                      httpHandle->mZeroCopyOffset);
+#endif
+
+      if (!mhdResponse) {
+        close(fd);
+      }
+    }
 
-  if (response->mUseFileReaderCallback) {
+    if (mhdResponse) {
+      eos_static_debug("response length=%lld offset=%lld zero-copy",
+                       (long long) response->mResponseLength,
+                       (long long) httpHandle->mZeroCopyOffset);
+      gettimeofday(&httpHandle->mZeroCopyStart, 0);
+    } else {
+      eos_static_warning("msg=\"zero-copy response failed, using the layout\" "
+                         "path=\"%s\"", httpHandle->mFile->GetPath().c_str());
+      httpHandle->mZeroCopy = false;
+    }
+  }
+
+  if (mhdResponse) {
+    // zero-copy response created above
+  } else if (response->mUseFileReaderCallback) {
     eos_static_debug("response length=%d", response->mResponseLength);
     mhdResponse = MHD_create_response_from_callback(response->mResponseLength,
                   4 * 1024 * 1024, /* 4M page size */
@@ -359,6 +399,15 @@ HttpServer::CompleteHandler(void*                              cls,
       }
     }
 
+    // account the data sent by the kernel, the amount sent is only known
+    // for completed requests
+    if (httpHandle->mZeroCopy && httpHandle->mFile &&
+        (toe == MHD_REQUEST_TERMINATED_COMPLETED_OK)) {
+      httpHandle->mFile->AddZeroCopyRead(httpHandle->mZeroCopyOffset,
+                                         httpHandle->mRequestSize,
+                                         httpHandle->mZeroCopyStart);
+    }
+
     // clean-up file objects
     if (httpHandle->mFile) {
       delete(httpHandle->mFile);
@@ -23,6 +23,9 @@
 
 #include <stdint.h>
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include "fst/io/xrd/XrdIo.hh"
 #include "fst/io/ChunkHandler.hh"
 #include "fst/io/VectChunkHandler.hh"
@@ -43,6 +46,10 @@ EOSFSTNAMESPACE_BEGIN
 
 const uint64_t ReadaheadBlock::sDefaultBlocksize = 1 * 1024 * 1024;
 const uint32_t XrdIo::sNumRdAheadBlocks = 2;
+const uint32_t XrdIo::sMaxRdAheadBlocks = 16;
+const uint32_t XrdIo::sMaxRdAheadStreams = 4;
+const uint64_t XrdIo::sMaxRdAheadStride = 256 * 1024 * 1024;
+const uint64_t XrdIo::sRdAheadLateUs = 200;
 uint32_t XrdIo::sConnectionPoolMaxSize = 64;
 XrdSysMutex XrdIo::sConnectionPoolMutex;
 std::map<std::string, std::map<int, size_t> > XrdIo::sConnectionPool;
@@ -61,6 +68,12 @@ std::string getAttrUrl(std::string path)
   path += ".xattr";
   return path;
 }
+
+uint64_t steadyUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>
+         (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 }
 
 //------------------------------------------------------------------------------
@@ -97,9 +110,17 @@ AsyncIoOpenHandler::HandleResponseWithHosts(XrdCl::XRootDStatus* status,
 XrdIo::XrdIo(std::string path) :
   FileIo(path, "XrdIo"),
   mDoReadahead(false),
+  mAdaptiveReadahead(false),
   mBlocksize(ReadaheadBlock::sDefaultBlocksize),
   mXrdFile(NULL),
-  mMetaHandler(new AsyncMetaHandler())
+  mMetaHandler(new AsyncMetaHandler()),
+  mNumBlocks(0),
+  mReadSeq(0),
+  mRaHits(0),
+  mRaMisses(0),
+  mRaPrefetchedBytes(0),
+  mRaWastedBytes(0),
+  mRaWaitUs(0)
 {
   // Set the TimeoutResolution to 1
   XrdCl::Env* env = XrdCl::DefaultEnv::GetEnv();
@@ -132,6 +153,8 @@ XrdIo::~XrdIo()
   DropConnection();
 
   if (mDoReadahead) {
+    DropStreams();
+
     while (!mQueueBlocks.empty()) {
       ReadaheadBlock* ptr_readblock = mQueueBlocks.front();
       mQueueBlocks.pop();
@@ -172,24 +195,15 @@ XrdIo::fileOpen(XrdSfsFileOpenMode flags,
                 const std::string& opaque,
                 uint16_t timeout)
 {
-  const char* val = 0;
   std::string request;
-  std::string lOpaque;
-  XrdOucEnv open_opaque(mOpaque.c_str());
+  XrdOucEnv path_opaque(mOpaque.c_str());
+  ConfigureReadahead(path_opaque);
 
-  // Decide if readahead is used and the block size
-  if ((val = open_opaque.Get("fst.readahead")) &&
-      (strncmp(val, "true", 4) == 0)) {
-    eos_debug("Enabling the readahead.");
-    mDoReadahead = true;
-    val = 0;
-
-    if ((val = open_opaque.Get("fst.blocksize"))) {
-      mBlocksize = static_cast<uint64_t>(atoll(val));
-    }
+  if (!mDoReadahead && opaque.length()) {
+    XrdOucEnv open_opaque(opaque.c_str());
 
-    for (unsigned int i = 0; i < sNumRdAheadBlocks; i++) {
-      mQueueBlocks.push(new ReadaheadBlock(mBlocksize));
+    if (IsOpenReadaheadRequest(open_opaque)) {
+      ConfigureReadahead(open_opaque);
     }
   }
 
@@ -252,7 +266,6 @@ XrdIo::fileOpenAsync(void* io_handler,
                      XrdSfsFileOpenMode flags, mode_t mode,
                      const std::string& opaque, uint16_t timeout)
 {
-  const char* val = 0;
   std::string request;
   std::string lOpaque;
   size_t qpos = 0;
@@ -266,22 +279,7 @@ XrdIo::fileOpenAsync(void* io_handler,
   }
 
   XrdOucEnv open_opaque(lOpaque.c_str());
-
-  // Decide if readahead is used and the block size
-  if ((val = open_opaque.Get("fst.readahead")) &&
-      (strncmp(val, "true", 4) == 0)) {
-    eos_debug("Enabling the readahead.");
-    mDoReadahead = true;
-    val = 0;
-
-    if ((val = open_opaque.Get("fst.blocksize"))) {
-      mBlocksize = static_cast<uint64_t>(atoll(val));
-    }
-
-    for (unsigned int i = 0; i < sNumRdAheadBlocks; i++) {
-      mQueueBlocks.push(new ReadaheadBlock(mBlocksize));
-    }
-  }
+  ConfigureReadahead(open_opaque);
 
   request = mFilePath;
   request += "?";
@@ -386,6 +384,10 @@ XrdIo::fileReadAsync(XrdSfsFileOffset offset, char* buffer,
     eos_debug("Readahead is disabled");
   }
 
+  if (readahead && mAdaptiveReadahead) {
+    return AdaptiveRead(offset, buffer, length, timeout);
+  }
+
   if (!readahead) {
     handler = mMetaHandler->Register(offset, length, NULL, false);
 
@@ -420,7 +422,7 @@ XrdIo::fileReadAsync(XrdSfsFileOffset offset, char* buffer,
     mPrefetchMutex.Lock(); // -->
 
     while (length) {
-      iter = FindBlock(offset);
+      iter = FindBlock(mMapBlocks, offset);
 
       if (iter != mMapBlocks.end()) {
         // Block found in prefetched blocks
@@ -547,29 +549,30 @@ XrdIo::fileReadAsync(XrdSfsFileOffset offset, char* buffer,
 // Try to find a block in cache which contains the required offset
 //------------------------------------------------------------------------------
 PrefetchMap::iterator
-XrdIo::FindBlock(uint64_t offset)
+XrdIo::FindBlock(PrefetchMap& blocks, uint64_t offset)
 {
-  if (mMapBlocks.empty()) {
-    return mMapBlocks.end();
+  if (blocks.empty()) {
+    return blocks.end();
   }
 
-  PrefetchMap::iterator iter = mMapBlocks.lower_bound(offset);
+  PrefetchMap::iterator iter = blocks.lower_bound(offset);
 
-  if ((iter != mMapBlocks.end()) && (iter->first == offset)) {
+  if ((iter != blocks.end()) && (iter->first == offset)) {
     // Found exactly the block needed
     return iter;
   } else {
-    if (iter == mMapBlocks.begin()) {
+    if (iter == blocks.begin()) {
       // Only blocks with bigger offsets, return pointer to end of the map
-      return mMapBlocks.end();
+      return blocks.end();
     } else {
       // Check if the previous block, we know the map is not empty
       iter--;
+      uint64_t length = iter->second->handler->GetLength();
 
-      if ((iter->first <= offset) && (offset < (iter->first + mBlocksize))) {
+      if ((iter->first <= offset) && (offset < (iter->first + length))) {
         return iter;
       } else {
-        return mMapBlocks.end();
+        return blocks.end();
       }
     }
   }
@@ -723,6 +726,11 @@ XrdIo::fileWaitAsyncIO()
 {
   bool async_ok = true;
 
+  if (mAdaptiveReadahead)
+  {
+    DropStreams();
+  }
+
   if (mDoReadahead)
   {
     // Wait for any requests on the fly and then close
@@ -876,6 +884,14 @@ XrdIo::fileClose(uint16_t timeout)
   if (fileWaitAsyncIO())
     async_ok = false;
 
+  if (mAdaptiveReadahead) {
+    ReadaheadStats stats = GetReadaheadStats();
+    eos_info("msg=\"adaptive readahead\" path=%s hits=%llu misses=%llu "
+             "prefetched=%llu wasted=%llu wait_us=%llu", mFilePath.c_str(),
+             stats.mHits, stats.mMisses, stats.mPrefetchedBytes,
+             stats.mWastedBytes, stats.mWaitUs);
+  }
+
   XrdCl::XRootDStatus status = mXrdFile->Close(timeout);
 
   if (!status.IsOK()) {
@@ -1018,6 +1034,470 @@ XrdIo::PrefetchBlock(int64_t offset, bool isWrite, uint16_t timeout)
   return done;
 }
 
+//------------------------------------------------------------------------------
+// Configure the readahead from the opaque information of the open
+//------------------------------------------------------------------------------
+void
+XrdIo::ConfigureReadahead(XrdOucEnv& open_opaque)
+{
+  const char* val = 0;
+
+  // Decide if readahead is used and the block size
+  if (!(val = open_opaque.Get("fst.readahead"))) {
+    return;
+  }
+
+  if (strncmp(val, "adaptive", 8) == 0) {
+    mAdaptiveReadahead = true;
+  } else if (strncmp(val, "true", 4) == 0) {
+    // The adaptive mode can be enforced for all readers of the FST
+    const char* mode = getenv("EOS_FST_XRDIO_READAHEAD");
+    mAdaptiveReadahead = (mode && (strcmp(mode, "adaptive") == 0));
+  } else {
+    return;
+  }
+
+  eos_debug("Enabling the %s readahead.", mAdaptiveReadahead ? "adaptive" :
+            "fixed");
+  mDoReadahead = true;
+
+  if ((val = open_opaque.Get("fst.blocksize"))) {
+    mBlocksize = static_cast<uint64_t>(atoll(val));
+  }
+
+  // The adaptive readahead allocates its blocks on demand
+  if (!mAdaptiveReadahead) {
+    for (unsigned int i = 0; i < sNumRdAheadBlocks; i++) {
+      mQueueBlocks.push(new ReadaheadBlock(mBlocksize));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Check if the opaque information of the open requests the readahead
+//------------------------------------------------------------------------------
+bool
+XrdIo::IsOpenReadaheadRequest(XrdOucEnv& open_opaque)
+{
+  const char* val = open_opaque.Get("fst.readahead");
+
+  if (!val) {
+    return false;
+  }
+
+  if (strncmp(val, "adaptive", 8) == 0) {
+    return true;
+  }
+
+  // The fixed readahead is never used for the stripes of the RAIN layouts
+  const char* mode = getenv("EOS_FST_XRDIO_READAHEAD");
+  return ((strncmp(val, "true", 4) == 0) && mode &&
+          (strcmp(mode, "adaptive") == 0));
+}
+
+//------------------------------------------------------------------------------
+// Read using the adaptive readahead
+//------------------------------------------------------------------------------
+int64_t
+XrdIo::AdaptiveRead(XrdSfsFileOffset offset, char* buffer,
+                    XrdSfsXferSize length, uint16_t timeout)
+{
+  int64_t nread = 0;
+  bool done_read = false;
+  char* pBuff = buffer;
+  ReadaheadStream* stream = 0;
+  // Prediction of the next reads, taken while the pattern can't change
+  bool predict = false;
+  uint64_t next_offset = offset + length;
+  uint64_t step = mBlocksize;
+  uint32_t block_length = mBlocksize;
+  uint32_t max_window = sMaxRdAheadBlocks;
+  PrefetchMap stale;
+  {
+    XrdSysMutexHelper lock(mPrefetchMutex);
+    stream = MatchStream(mStreams, mReadSeq, offset, length, stale);
+
+    // The streams of the file share the blocks
+    if (mStreams.size() > 1) {
+      max_window = std::max(sNumRdAheadBlocks,
+                            sMaxRdAheadBlocks / (uint32_t) mStreams.size());
+    }
+
+    if (stream) {
+      predict = PredictStream(*stream, mBlocksize, next_offset, step,
+                              block_length);
+    }
+  }
+
+  // The blocks of a recycled stream may still be in flight, don't wait for
+  // them while holding the prefetch mutex
+  while (!stale.empty()) {
+    RecycleBlock(stale, stale.begin());
+  }
+
+  if (stream) {
+    stream->mMutex.Lock(); // -->
+    PrefetchMap::iterator iter;
+
+    while (length) {
+      iter = FindBlock(stream->mBlocks, offset);
+
+      if (iter == stream->mBlocks.end()) {
+        break;
+      }
+
+      ReadaheadBlock* block = iter->second;
+      SimpleHandler* sh = block->handler;
+      uint64_t wait_start = steadyUs();
+      bool ok = sh->WaitOK();
+      uint64_t wait_us = steadyUs() - wait_start;
+      mRaWaitUs += wait_us;
+
+      if (!ok) {
+        eos_warning("msg=\"prefetching failed, drop the stream blocks\" "
+                    "offset=%llu", iter->first);
+
+        while (!stream->mBlocks.empty()) {
+          RecycleBlock(stream->mBlocks, stream->mBlocks.begin());
+        }
+
+        break;
+      }
+
+      // The data arrived after the reader needed it, the window is too short
+      // to hide the latency of the server
+      if ((wait_us > sRdAheadLateUs) && (stream->mWindow < max_window)) {
+        stream->mWindow = std::min(2 * stream->mWindow, max_window);
+      }
+
+      uint64_t shift = offset - iter->first;
+
+      if (sh->GetRespLength() < sh->GetLength()) {
+        stream->mEofOffset = iter->first + sh->GetRespLength();
+      }
+
+      if (shift >= sh->GetRespLength()) {
+        // Nothing more to read in this block, we reached the end of file
+        if (sh->GetRespLength() < sh->GetLength()) {
+          done_read = true;
+        }
+
+        break;
+      }
+
+      uint64_t read_length = std::min(static_cast<uint64_t>(length),
+                                      sh->GetRespLength() - shift);
+      memcpy(pBuff, block->buffer + shift, read_length);
+      block->consumed += read_length;
+      pBuff += read_length;
+      offset += read_length;
+      length -= read_length;
+      nread += read_length;
+
+      if (shift + read_length >= sh->GetRespLength()) {
+        RecycleBlock(stream->mBlocks, iter);
+      }
+    }
+
+    // Blocks before the current offset will never be read by this stream
+    while (!stream->mBlocks.empty() &&
+           (stream->mBlocks.begin()->first +
+            stream->mBlocks.begin()->second->handler->GetLength() <=
+            static_cast<uint64_t>(offset))) {
+      if (stream->mWindow > 1) {
+        stream->mWindow--;
+      }
+
+      RecycleBlock(stream->mBlocks, stream->mBlocks.begin());
+    }
+
+    if (predict) {
+      PrefetchStream(stream, next_offset, step, block_length, timeout);
+    }
+
+    uint64_t range_start = 0;
+    uint64_t range_end = 0;
+
+    if (!stream->mBlocks.empty()) {
+      PrefetchMap::reverse_iterator last = stream->mBlocks.rbegin();
+      range_start = stream->mBlocks.begin()->first;
+      range_end = last->first + last->second->handler->GetLength();
+    }
+
+    stream->mMutex.UnLock(); // <--
+    ReleaseStream(stream, range_start, range_end);
+  }
+
+  if (!length || done_read) {
+    mRaHits++;
+    return nread;
+  }
+
+  // Whatever is not prefetched is read the classic way
+  mRaMisses++;
+  ChunkHandler* handler = mMetaHandler->Register(offset, length, NULL, false);
+
+  // If previous read requests failed then we won't get a new handler
+  // and we return directly an error
+  if (!handler) {
+    return SFS_ERROR;
+  }
+
+  XrdCl::XRootDStatus status = mXrdFile->Read(static_cast<uint64_t>(offset),
+                               static_cast<uint32_t>(length),
+                               pBuff, handler, timeout);
+
+  if (!status.IsOK()) {
+    // TODO: for the time being we call this ourselves but this should be
+    // dropped once XrdCl will call the handler for a request as it knows it
+    // has already failed
+    mMetaHandler->HandleResponse(&status, handler);
+  }
+
+  return nread + length;
+}
+
+//------------------------------------------------------------------------------
+// Find the stream a read belongs to and update its access pattern
+//------------------------------------------------------------------------------
+ReadaheadStream*
+XrdIo::MatchStream(std::vector<ReadaheadStream*>& streams, uint64_t& read_seq,
+                   uint64_t offset, uint32_t length, PrefetchMap& stale)
+{
+  ReadaheadStream* match = 0;
+  ReadaheadStream* candidate = 0;
+  ReadaheadStream* victim = 0;
+
+  for (auto it = streams.begin(); it != streams.end(); ++it) {
+    ReadaheadStream* stream = *it;
+
+    if (!stream->mStride && (stream->mRangeStart <= offset) &&
+        (offset < stream->mRangeEnd)) {
+      // Covered by the data prefetched for a sequential stream
+      match = stream;
+      break;
+    }
+
+    if (offset == stream->mLastOffset + stream->mLastLength) {
+      match = stream;
+      match->mStride = 0;
+      break;
+    }
+
+    if (stream->mStride && (offset == stream->mLastOffset + stream->mStride)) {
+      match = stream;
+      break;
+    }
+
+    // An unconfirmed stream shortly before the read could be strided
+    if (!stream->mMatches && (stream->mLastOffset < offset) &&
+        (offset - stream->mLastOffset <= sMaxRdAheadStride) &&
+        (!candidate || (candidate->mLastOffset < stream->mLastOffset))) {
+      candidate = stream;
+    }
+
+    if (!stream->mRefs && (!victim || (stream->mLastUse < victim->mLastUse))) {
+      victim = stream;
+    }
+  }
+
+  if (match) {
+    match->mMatches++;
+  } else if (candidate) {
+    // Second read of a possibly strided stream, confirmed by the next one
+    match = candidate;
+    match->mStride = offset - match->mLastOffset;
+  } else {
+    // Start a new stream, the least recently used one is recycled
+    if (streams.size() < sMaxRdAheadStreams) {
+      match = new ReadaheadStream();
+      streams.push_back(match);
+    } else if (victim) {
+      match = victim;
+      stale.insert(match->mBlocks.begin(), match->mBlocks.end());
+      match->mBlocks.clear();
+    } else {
+      return 0;
+    }
+
+    match->mStride = 0;
+    match->mMatches = 0;
+    match->mWindow = sNumRdAheadBlocks;
+    match->mNextPrefetch = 0;
+    match->mEofOffset = std::numeric_limits<uint64_t>::max();
+    match->mRangeStart = match->mRangeEnd = 0;
+  }
+
+  match->mLastOffset = offset;
+  match->mLastLength = length;
+  match->mLastUse = ++read_seq;
+  match->mRefs++;
+  return match;
+}
+
+//------------------------------------------------------------------------------
+// Predict the next reads of a stream
+//------------------------------------------------------------------------------
+bool
+XrdIo::PredictStream(const ReadaheadStream& stream, uint32_t blocksize,
+                     uint64_t& next_offset, uint64_t& step, uint32_t& length)
+{
+  if (!stream.mMatches) {
+    return false;
+  }
+
+  if (stream.mStride) {
+    // Strided: one block per predicted read, limited to the block size
+    next_offset = stream.mLastOffset + stream.mStride;
+    step = stream.mStride;
+    length = std::min(stream.mLastLength, blocksize);
+  } else {
+    next_offset = stream.mLastOffset + stream.mLastLength;
+    step = blocksize;
+    length = blocksize;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Drop the reference of a reader to a stream
+//------------------------------------------------------------------------------
+void
+XrdIo::ReleaseStream(ReadaheadStream* stream, uint64_t range_start,
+                     uint64_t range_end)
+{
+  XrdSysMutexHelper lock(mPrefetchMutex);
+  stream->mRefs--;
+  stream->mRangeStart = range_start;
+  stream->mRangeEnd = range_end;
+}
+
+//------------------------------------------------------------------------------
+// Prefetch the blocks predicted by the pattern of a stream
+//------------------------------------------------------------------------------
+void
+XrdIo::PrefetchStream(ReadaheadStream* stream, uint64_t offset, uint64_t step,
+                      uint32_t length, uint16_t timeout)
+{
+  uint64_t horizon = offset + stream->mWindow * step;
+
+  // Blocks beyond the window were predicted by a previous pattern
+  while (!stream->mBlocks.empty() &&
+         (stream->mBlocks.rbegin()->first >= horizon)) {
+    RecycleBlock(stream->mBlocks, --stream->mBlocks.end());
+  }
+
+  if (stream->mNextPrefetch < offset) {
+    stream->mNextPrefetch = offset;
+  } else if (stream->mNextPrefetch > horizon) {
+    stream->mNextPrefetch = offset;
+
+    if (!stream->mBlocks.empty()) {
+      stream->mNextPrefetch = std::max(offset,
+                                       stream->mBlocks.rbegin()->first + step);
+    }
+  }
+
+  while ((stream->mBlocks.size() < stream->mWindow) &&
+         (stream->mNextPrefetch < stream->mEofOffset)) {
+    ReadaheadBlock* block = 0;
+    {
+      XrdSysMutexHelper lock(mQueueMutex);
+
+      if (!mQueueBlocks.empty()) {
+        block = mQueueBlocks.front();
+        mQueueBlocks.pop();
+      } else if (mNumBlocks < sMaxRdAheadBlocks) {
+        block = new ReadaheadBlock(mBlocksize);
+        mNumBlocks++;
+      }
+    }
+
+    // All the blocks are in use by the streams of this file
+    if (!block) {
+      break;
+    }
+
+    uint64_t block_offset = stream->mNextPrefetch;
+    block->Update(block_offset, length, false);
+    XrdCl::XRootDStatus status = mXrdFile->Read(block_offset, length,
+                                 block->buffer, block->handler, timeout);
+
+    if (!status.IsOK()) {
+      eos_warning("msg=\"failed to send prefetch request\" offset=%llu",
+                  block_offset);
+      // Create tmp status which is deleted in the HandleResponse method
+      XrdCl::XRootDStatus* tmp_status = new XrdCl::XRootDStatus(status);
+      block->handler->HandleResponse(tmp_status, NULL);
+      block->handler->WaitOK();
+      XrdSysMutexHelper lock(mQueueMutex);
+      mQueueBlocks.push(block);
+      break;
+    }
+
+    mRaPrefetchedBytes += length;
+    stream->mBlocks.insert(std::make_pair(block_offset, block));
+    stream->mNextPrefetch += step;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Collect a block of a stream and give it back to the free queue
+//------------------------------------------------------------------------------
+void
+XrdIo::RecycleBlock(PrefetchMap& blocks, PrefetchMap::iterator iter)
+{
+  ReadaheadBlock* block = iter->second;
+  blocks.erase(iter);
+
+  // The handler can only be reused once the response arrived
+  if (block->handler->HasRequest()) {
+    block->handler->WaitOK();
+  }
+
+  if (block->handler->GetRespLength() > block->consumed) {
+    mRaWastedBytes += block->handler->GetRespLength() - block->consumed;
+  }
+
+  XrdSysMutexHelper lock(mQueueMutex);
+  mQueueBlocks.push(block);
+}
+
+//------------------------------------------------------------------------------
+// Recycle all the blocks of all streams and forget the streams
+//------------------------------------------------------------------------------
+void
+XrdIo::DropStreams()
+{
+  XrdSysMutexHelper lock(mPrefetchMutex);
+
+  for (auto it = mStreams.begin(); it != mStreams.end(); ++it) {
+    while (!(*it)->mBlocks.empty()) {
+      RecycleBlock((*it)->mBlocks, (*it)->mBlocks.begin());
+    }
+
+    delete *it;
+  }
+
+  mStreams.clear();
+}
+
+//------------------------------------------------------------------------------
+// Get the readahead counters of this file
+//------------------------------------------------------------------------------
+ReadaheadStats
+XrdIo::GetReadaheadStats() const
+{
+  ReadaheadStats stats;
+  stats.mHits = mRaHits;
+  stats.mMisses = mRaMisses;
+  stats.mPrefetchedBytes = mRaPrefetchedBytes;
+  stats.mWastedBytes = mRaWastedBytes;
+  stats.mWaitUs = mRaWaitUs;
+  return stats;
+}
+
 //------------------------------------------------------------------------------
 // Get pointer to async meta handler object
 //------------------------------------------------------------------------------
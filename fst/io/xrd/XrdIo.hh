@@ -29,6 +29,8 @@
 #include "fst/io/SimpleHandler.hh"
 #include "common/FileMap.hh"
 #include "XrdCl/XrdClFile.hh"
+#include <atomic>
+#include <limits>
 #include <queue>
 
 EOSFSTNAMESPACE_BEGIN
@@ -92,6 +94,7 @@ struct ReadaheadBlock {
   {
     buffer = new char[blocksize];
     handler = new SimpleHandler();
+    consumed = 0;
   }
 
   //----------------------------------------------------------------------------
@@ -104,6 +107,7 @@ struct ReadaheadBlock {
   void Update(uint64_t offset, uint32_t length, bool isWrite)
   {
     handler->Update(offset, length, isWrite);
+    consumed = 0;
   }
 
   //----------------------------------------------------------------------------
@@ -117,6 +121,49 @@ struct ReadaheadBlock {
 
   char* buffer; ///< pointer to where the data is read
   SimpleHandler* handler; ///< async handler for the requests
+  uint32_t consumed; ///< bytes of the block served to the reader
+};
+
+//------------------------------------------------------------------------------
+//! Stream of reads detected by the adaptive readahead. A stream is either
+//! sequential, every read starts where the previous one ended, or strided,
+//! the reads start at a constant distance from each other. Prefetching starts
+//! once the pattern is confirmed and the number of blocks kept in flight
+//! follows the usefulness of the prefetched data.
+//------------------------------------------------------------------------------
+struct ReadaheadStream {
+  ReadaheadStream():
+    mLastOffset(0), mLastLength(0), mStride(0), mMatches(0), mRangeStart(0),
+    mRangeEnd(0), mLastUse(0), mRefs(0), mWindow(0), mNextPrefetch(0),
+    mEofOffset(std::numeric_limits<uint64_t>::max()) {}
+
+  // The pattern is protected by the XrdIo prefetch mutex
+  uint64_t mLastOffset; ///< offset of the last read of the stream
+  uint32_t mLastLength; ///< length of the last read of the stream
+  uint64_t mStride; ///< distance between the reads if strided, 0 otherwise
+  uint32_t mMatches; ///< consecutive reads following the pattern
+  uint64_t mRangeStart; ///< start of the data covered by the blocks
+  uint64_t mRangeEnd; ///< end of the data covered by the blocks
+  uint64_t mLastUse; ///< read sequence number, used to recycle streams
+  uint32_t mRefs; ///< readers currently serving from this stream
+  // The prefetch state is protected by the stream mutex, a stream is only
+  // reset or recycled while no reader references it
+  XrdSysMutex mMutex; ///< serialises the readers of the stream
+  uint32_t mWindow; ///< number of blocks to keep in flight
+  uint64_t mNextPrefetch; ///< offset of the next block to prefetch
+  uint64_t mEofOffset; ///< end of file seen by a prefetch, if any
+  PrefetchMap mBlocks; ///< blocks prefetched for this stream
+};
+
+//------------------------------------------------------------------------------
+//! Counters of the readahead
+//------------------------------------------------------------------------------
+struct ReadaheadStats {
+  uint64_t mHits; ///< reads fully served from prefetched blocks
+  uint64_t mMisses; ///< reads which needed a request to the server
+  uint64_t mPrefetchedBytes; ///< bytes requested by prefetching
+  uint64_t mWastedBytes; ///< prefetched bytes never served to a reader
+  uint64_t mWaitUs; ///< time readers waited for prefetched blocks
 };
 
 
@@ -128,6 +175,10 @@ class XrdIo : public FileIo
   friend class AsyncIoOpenHandler;
 public:
   static const uint32_t sNumRdAheadBlocks; ///< no. of blocks used for readahead
+  static const uint32_t sMaxRdAheadBlocks; ///< max blocks of adaptive readahead
+  static const uint32_t sMaxRdAheadStreams; ///< max streams tracked per file
+  static const uint64_t sMaxRdAheadStride; ///< max distance of strided reads
+  static const uint64_t sRdAheadLateUs; ///< wait after which a hit was late
 
   //----------------------------------------------------------------------------
   //! Constructor
@@ -485,14 +536,84 @@ public:
   //----------------------------------------------------------------------------
   virtual int ftsClose(FileIo::FtsHandle* fts_handle);
 
+  //----------------------------------------------------------------------------
+  //! Check if the adaptive readahead is enabled for this file
+  //----------------------------------------------------------------------------
+  bool
+  IsAdaptiveReadahead() const
+  {
+    return mAdaptiveReadahead;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the readahead counters of this file
+  //----------------------------------------------------------------------------
+  ReadaheadStats GetReadaheadStats() const;
+
+  //----------------------------------------------------------------------------
+  //! Check if the opaque info given at open switches on the readahead. Only
+  //! the adaptive readahead can be requested there, fst.readahead=true as set
+  //! by the RAIN layouts for their stripes selects it when the FST enforces
+  //! it with EOS_FST_XRDIO_READAHEAD=adaptive.
+  //!
+  //! @param open_opaque opaque info given at open
+  //!
+  //! @return true if the adaptive readahead is requested, otherwise false
+  //----------------------------------------------------------------------------
+  static bool IsOpenReadaheadRequest(XrdOucEnv& open_opaque);
+
+  //----------------------------------------------------------------------------
+  //! Find the stream a read belongs to and update its access pattern, a new
+  //! stream is started if the read doesn't belong to any. The stream returned
+  //! is referenced and has to be released with ReleaseStream. Has to be
+  //! called with the prefetch mutex of the owner of the streams locked.
+  //!
+  //! @param streams streams of the file
+  //! @param read_seq sequence number of the reads of the file
+  //! @param offset offset of the read
+  //! @param length length of the read
+  //! @param stale filled with the blocks of a recycled stream, they may still
+  //!        be in flight and have to be recycled without the prefetch mutex
+  //!
+  //! @return stream or 0 if all the streams are busy
+  //----------------------------------------------------------------------------
+  static ReadaheadStream* MatchStream(std::vector<ReadaheadStream*>& streams,
+                                      uint64_t& read_seq, uint64_t offset,
+                                      uint32_t length, PrefetchMap& stale);
+
+  //----------------------------------------------------------------------------
+  //! Predict the next reads of a stream once its pattern is confirmed
+  //!
+  //! @param stream stream returned by MatchStream
+  //! @param blocksize readahead block size
+  //! @param next_offset offset of the next read predicted
+  //! @param step distance between the predicted reads
+  //! @param length length of the blocks to prefetch
+  //!
+  //! @return true if the pattern is confirmed and the outputs are set
+  //----------------------------------------------------------------------------
+  static bool PredictStream(const ReadaheadStream& stream, uint32_t blocksize,
+                            uint64_t& next_offset, uint64_t& step,
+                            uint32_t& length);
+
 private:
   bool mDoReadahead; ///< mark if readahead is enabled
+  bool mAdaptiveReadahead; ///< mark if readahead detects the access pattern
   uint32_t mBlocksize; ///< block size for rd/wr opertations
   XrdCl::File* mXrdFile; ///< handler to xrd file
   AsyncMetaHandler* mMetaHandler; ///< async requests meta handler
   PrefetchMap mMapBlocks; ///< map of block read/prefetched
   std::queue<ReadaheadBlock*> mQueueBlocks; ///< queue containing available blocks
   XrdSysMutex mPrefetchMutex; ///< mutex to serialise the prefetch step
+  XrdSysMutex mQueueMutex; ///< protects the free blocks of adaptive readahead
+  std::vector<ReadaheadStream*> mStreams; ///< streams of adaptive readahead
+  uint32_t mNumBlocks; ///< blocks allocated by the adaptive readahead
+  uint64_t mReadSeq; ///< sequence number of the adaptive reads
+  std::atomic<uint64_t> mRaHits; ///< reads served from prefetched blocks
+  std::atomic<uint64_t> mRaMisses; ///< reads sent to the server
+  std::atomic<uint64_t> mRaPrefetchedBytes; ///< bytes requested by prefetching
+  std::atomic<uint64_t> mRaWastedBytes; ///< prefetched bytes never used
+  std::atomic<uint64_t> mRaWaitUs; ///< time waited for prefetched blocks
   eos::common::FileMap mFileMap; ///< extended attribute file map
   std::string mAttrUrl; ///< extended attribute url
   std::string mOpaque; ///< opaque tags in original url
@@ -540,12 +661,73 @@ private:
   //----------------------------------------------------------------------------
   //! Try to find a block in cache with contains the provided offset
   //!
+  //! @param blocks map of blocks to search
   //! @param offset offset to be searched for
   //!
   //! @return iterator to the block containing the offset or if no such block
   //!         is found we return the iterator to the end of the map
   //----------------------------------------------------------------------------
-  PrefetchMap::iterator FindBlock(uint64_t offset);
+  static PrefetchMap::iterator FindBlock(PrefetchMap& blocks, uint64_t offset);
+
+  //----------------------------------------------------------------------------
+  //! Configure the readahead from the opaque information of the open
+  //!
+  //! @param open_opaque opaque information
+  //----------------------------------------------------------------------------
+  void ConfigureReadahead(XrdOucEnv& open_opaque);
+
+  //----------------------------------------------------------------------------
+  //! Read using the adaptive readahead
+  //!
+  //! @param offset offset in file
+  //! @param buffer where the data is read
+  //! @param length read length
+  //! @param timeout timeout value
+  //!
+  //! @return number of bytes read or -1 if error
+  //----------------------------------------------------------------------------
+  int64_t AdaptiveRead(XrdSfsFileOffset offset, char* buffer,
+                       XrdSfsXferSize length, uint16_t timeout);
+
+  //----------------------------------------------------------------------------
+  //! Drop the reference of a reader to a stream and publish the range of
+  //! data covered by its blocks
+  //!
+  //! @param stream stream to release
+  //! @param range_start start of the data covered by the blocks
+  //! @param range_end end of the data covered by the blocks
+  //----------------------------------------------------------------------------
+  void ReleaseStream(ReadaheadStream* stream, uint64_t range_start,
+                     uint64_t range_end);
+
+  //----------------------------------------------------------------------------
+  //! Prefetch the blocks predicted by the pattern of a stream until its
+  //! window is full. The stream mutex has to be locked.
+  //!
+  //! @param stream stream to prefetch for
+  //! @param offset offset of the next read predicted
+  //! @param step distance between the predicted reads
+  //! @param length length of the blocks to prefetch
+  //! @param timeout timeout value
+  //----------------------------------------------------------------------------
+  void PrefetchStream(ReadaheadStream* stream, uint64_t offset, uint64_t step,
+                      uint32_t length, uint16_t timeout);
+
+  //----------------------------------------------------------------------------
+  //! Collect a block of a stream, accounts the bytes never served and gives
+  //! the block back to the free queue. The stream mutex has to be locked or
+  //! the stream must not be referenced by any reader. Waits for the response
+  //! of the block if it is still in flight.
+  //!
+  //! @param blocks blocks of the stream owning the block
+  //! @param iter block to recycle
+  //----------------------------------------------------------------------------
+  void RecycleBlock(PrefetchMap& blocks, PrefetchMap::iterator iter);
+
+  //----------------------------------------------------------------------------
+  //! Recycle all the blocks of all streams and forget the streams
+  //----------------------------------------------------------------------------
+  void DropStreams();
 
   //----------------------------------------------------------------------------
   //! Download a remote file into a string object
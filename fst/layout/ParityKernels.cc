@@ -0,0 +1,447 @@
+//------------------------------------------------------------------------------
+// File: ParityKernels.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/*----------------------------------------------------------------------------*/
+#include "fst/layout/ParityKernels.hh"
+/*----------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define EOS_PARITY_X86 1
+#endif
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+namespace
+{
+typedef void (*XorFunc)(char*, const char* const*, unsigned int, size_t);
+
+//------------------------------------------------------------------------------
+// Portable XOR of the bytes [off, len) using 64-bit words
+//------------------------------------------------------------------------------
+void
+XorGenericFrom(char* dst, const char* const* srcs, unsigned int nsrcs,
+               size_t off, size_t len)
+{
+  for (; off + sizeof(uint64_t) <= len; off += sizeof(uint64_t)) {
+    uint64_t acc;
+    memcpy(&acc, srcs[0] + off, sizeof(acc));
+
+    for (unsigned int s = 1; s < nsrcs; ++s) {
+      uint64_t val;
+      memcpy(&val, srcs[s] + off, sizeof(val));
+      acc ^= val;
+    }
+
+    memcpy(dst + off, &acc, sizeof(acc));
+  }
+
+  for (; off < len; ++off) {
+    char acc = srcs[0][off];
+
+    for (unsigned int s = 1; s < nsrcs; ++s) {
+      acc ^= srcs[s][off];
+    }
+
+    dst[off] = acc;
+  }
+}
+
+void
+XorGeneric(char* dst, const char* const* srcs, unsigned int nsrcs, size_t len)
+{
+  XorGenericFrom(dst, srcs, nsrcs, 0, len);
+}
+
+#ifdef EOS_PARITY_X86
+//------------------------------------------------------------------------------
+// The x86 kernels XOR four vectors of every source per iteration and leave
+// the tail to the generic code
+//------------------------------------------------------------------------------
+void
+XorSse2(char* dst, const char* const* srcs, unsigned int nsrcs, size_t len)
+{
+  size_t off = 0;
+
+  for (; off + 4 * sizeof(__m128i) <= len; off += 4 * sizeof(__m128i)) {
+    const __m128i* src = (const __m128i*)(srcs[0] + off);
+    __m128i a0 = _mm_loadu_si128(src);
+    __m128i a1 = _mm_loadu_si128(src + 1);
+    __m128i a2 = _mm_loadu_si128(src + 2);
+    __m128i a3 = _mm_loadu_si128(src + 3);
+
+    for (unsigned int s = 1; s < nsrcs; ++s) {
+      src = (const __m128i*)(srcs[s] + off);
+      a0 = _mm_xor_si128(a0, _mm_loadu_si128(src));
+      a1 = _mm_xor_si128(a1, _mm_loadu_si128(src + 1));
+      a2 = _mm_xor_si128(a2, _mm_loadu_si128(src + 2));
+      a3 = _mm_xor_si128(a3, _mm_loadu_si128(src + 3));
+    }
+
+    __m128i* out = (__m128i*)(dst + off);
+    _mm_storeu_si128(out, a0);
+    _mm_storeu_si128(out + 1, a1);
+    _mm_storeu_si128(out + 2, a2);
+    _mm_storeu_si128(out + 3, a3);
+  }
+
+  XorGenericFrom(dst, srcs, nsrcs, off, len);
+}
+
+__attribute__((target("avx2"))) void
+XorAvx2(char* dst, const char* const* srcs, unsigned int nsrcs, size_t len)
+{
+  size_t off = 0;
+
+  for (; off + 4 * sizeof(__m256i) <= len; off += 4 * sizeof(__m256i)) {
+    const __m256i* src = (const __m256i*)(srcs[0] + off);
+    __m256i a0 = _mm256_loadu_si256(src);
+    __m256i a1 = _mm256_loadu_si256(src + 1);
+    __m256i a2 = _mm256_loadu_si256(src + 2);
+    __m256i a3 = _mm256_loadu_si256(src + 3);
+
+    for (unsigned int s = 1; s < nsrcs; ++s) {
+      src = (const __m256i*)(srcs[s] + off);
+      a0 = _mm256_xor_si256(a0, _mm256_loadu_si256(src));
+      a1 = _mm256_xor_si256(a1, _mm256_loadu_si256(src + 1));
+      a2 = _mm256_xor_si256(a2, _mm256_loadu_si256(src + 2));
+      a3 = _mm256_xor_si256(a3, _mm256_loadu_si256(src + 3));
+    }
+
+    __m256i* out = (__m256i*)(dst + off);
+    _mm256_storeu_si256(out, a0);
+    _mm256_storeu_si256(out + 1, a1);
+    _mm256_storeu_si256(out + 2, a2);
+    _mm256_storeu_si256(out + 3, a3);
+  }
+
+  XorGenericFrom(dst, srcs, nsrcs, off, len);
+}
+
+__attribute__((target("avx512f"))) void
+XorAvx512(char* dst, const char* const* srcs, unsigned int nsrcs, size_t len)
+{
+  size_t off = 0;
+
+  for (; off + 4 * sizeof(__m512i) <= len; off += 4 * sizeof(__m512i)) {
+    const char* src = srcs[0] + off;
+    __m512i a0 = _mm512_loadu_si512(src);
+    __m512i a1 = _mm512_loadu_si512(src + 64);
+    __m512i a2 = _mm512_loadu_si512(src + 128);
+    __m512i a3 = _mm512_loadu_si512(src + 192);
+
+    for (unsigned int s = 1; s < nsrcs; ++s) {
+      src = srcs[s] + off;
+      a0 = _mm512_xor_si512(a0, _mm512_loadu_si512(src));
+      a1 = _mm512_xor_si512(a1, _mm512_loadu_si512(src + 64));
+      a2 = _mm512_xor_si512(a2, _mm512_loadu_si512(src + 128));
+      a3 = _mm512_xor_si512(a3, _mm512_loadu_si512(src + 192));
+    }
+
+    char* out = dst + off;
+    _mm512_storeu_si512(out, a0);
+    _mm512_storeu_si512(out + 64, a1);
+    _mm512_storeu_si512(out + 128, a2);
+    _mm512_storeu_si512(out + 192, a3);
+  }
+
+  XorGenericFrom(dst, srcs, nsrcs, off, len);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Kernel table
+//------------------------------------------------------------------------------
+struct XorKernel {
+  const char* mName;
+  XorFunc mFunc;
+  bool (*mSupported)();
+};
+
+bool
+AlwaysSupported()
+{
+  return true;
+}
+
+#ifdef EOS_PARITY_X86
+bool
+Avx2Supported()
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+bool
+Avx512Supported()
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f");
+}
+#endif
+
+//! Known kernels, from the least to the most efficient one
+const XorKernel sXorKernels[] = {
+  {"generic", XorGeneric, AlwaysSupported},
+#ifdef EOS_PARITY_X86
+  {"sse2", XorSse2, AlwaysSupported},
+  {"avx2", XorAvx2, Avx2Supported},
+  {"avx512", XorAvx512, Avx512Supported},
+#endif
+};
+
+const size_t sNumXorKernels = sizeof(sXorKernels) / sizeof(sXorKernels[0]);
+
+//------------------------------------------------------------------------------
+// Kernel in use, the best one supported unless changed with SetXorKernel
+//------------------------------------------------------------------------------
+const XorKernel*&
+CurrentXorKernel()
+{
+  static const XorKernel* sCurrent = [] {
+    const XorKernel* best = &sXorKernels[0];
+
+    for (size_t i = 0; i < sNumXorKernels; ++i) {
+      if (sXorKernels[i].mSupported()) {
+        best = &sXorKernels[i];
+      }
+    }
+
+    return best;
+  }();
+  return sCurrent;
+}
+}
+
+//------------------------------------------------------------------------------
+// XOR the source blocks into the destination
+//------------------------------------------------------------------------------
+void
+XorBlocks(char* dst, const char* const* srcs, unsigned int nsrcs, size_t len)
+{
+  if (nsrcs == 0) {
+    memset(dst, 0, len);
+    return;
+  }
+
+  if (nsrcs == 1) {
+    if (dst != srcs[0]) {
+      memcpy(dst, srcs[0], len);
+    }
+
+    return;
+  }
+
+  CurrentXorKernel()->mFunc(dst, srcs, nsrcs, len);
+}
+
+//------------------------------------------------------------------------------
+// Get the name of the kernel in use
+//------------------------------------------------------------------------------
+const char*
+GetXorKernel()
+{
+  return CurrentXorKernel()->mName;
+}
+
+//------------------------------------------------------------------------------
+// Get the supported kernels
+//------------------------------------------------------------------------------
+std::vector<std::string>
+GetXorKernels()
+{
+  std::vector<std::string> names;
+
+  for (size_t i = 0; i < sNumXorKernels; ++i) {
+    if (sXorKernels[i].mSupported()) {
+      names.push_back(sXorKernels[i].mName);
+    }
+  }
+
+  return names;
+}
+
+//------------------------------------------------------------------------------
+// Select the kernel to use
+//------------------------------------------------------------------------------
+bool
+SetXorKernel(const std::string& name)
+{
+  for (size_t i = 0; i < sNumXorKernels; ++i) {
+    if ((name == sXorKernels[i].mName) && sXorKernels[i].mSupported()) {
+      CurrentXorKernel() = &sXorKernels[i];
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// XorSchedule constructor
+//------------------------------------------------------------------------------
+XorSchedule::XorSchedule(unsigned int packets_per_chunk, size_t packet_size):
+  mPacketsPerChunk(packets_per_chunk), mPacketSize(packet_size)
+{}
+
+//------------------------------------------------------------------------------
+// Append an operation
+//------------------------------------------------------------------------------
+void
+XorSchedule::Add(const Packet& dst, const std::vector<Packet>& srcs)
+{
+  Operation op;
+  op.mDst = dst;
+  op.mSrcs = srcs;
+  mOps.push_back(op);
+}
+
+//------------------------------------------------------------------------------
+// Apply the schedule tile by tile
+//------------------------------------------------------------------------------
+void
+XorSchedule::Execute(const std::vector<char*>& blocks,
+                     size_t block_size) const
+{
+  size_t chunk_size = mPacketsPerChunk * mPacketSize;
+  std::vector<const char*> srcs;
+
+  for (size_t chunk = 0; chunk + chunk_size <= block_size;
+       chunk += chunk_size) {
+    for (size_t tile = 0; tile < mPacketSize; tile += sTileSize) {
+      size_t len = std::min(sTileSize, mPacketSize - tile);
+      size_t base = chunk + tile;
+
+      for (auto op = mOps.begin(); op != mOps.end(); ++op) {
+        srcs.clear();
+
+        for (auto src = op->mSrcs.begin(); src != op->mSrcs.end(); ++src) {
+          srcs.push_back(blocks[src->first] + base + src->second * mPacketSize);
+        }
+
+        XorBlocks(blocks[op->mDst.first] + base + op->mDst.second * mPacketSize,
+                  srcs.data(), srcs.size(), len);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// RAID-DP schedule, the block order of the group is the one of RaidDpLayout
+//------------------------------------------------------------------------------
+XorSchedule
+XorSchedule::RaidDp(unsigned int nb_data_files, size_t stripe_width)
+{
+  XorSchedule schedule(1, stripe_width);
+  unsigned int nb_total_files = nb_data_files + 2;
+  unsigned int nb_total_blocks = nb_data_files * nb_total_files;
+  std::vector<Packet> srcs;
+
+  // Simple parity is the XOR of the data blocks of each line
+  for (unsigned int i = 0; i < nb_data_files; i++) {
+    unsigned int index_pblock = (i + 1) * nb_data_files + 2 * i;
+    srcs.clear();
+
+    for (unsigned int block = i * nb_total_files; block < index_pblock; block++) {
+      srcs.push_back(Packet(block, 0));
+    }
+
+    schedule.Add(Packet(index_pblock, 0), srcs);
+  }
+
+  // Double parity is the XOR of the diagonals including the simple parity
+  unsigned int aux_block;
+  unsigned int next_block;
+  unsigned int index_dpblock;
+  unsigned int jump_blocks = nb_total_files + 1;
+  std::vector<unsigned int> used_blocks;
+
+  for (unsigned int i = 0; i < nb_data_files; i++) {
+    index_dpblock = (i + 1) * (nb_data_files + 1) + i;
+    used_blocks.push_back(index_dpblock);
+  }
+
+  for (unsigned int i = 0; i < nb_data_files; i++) {
+    index_dpblock = (i + 1) * (nb_data_files + 1) + i;
+    next_block = i + jump_blocks;
+    srcs.clear();
+    srcs.push_back(Packet(i, 0));
+    srcs.push_back(Packet(next_block, 0));
+    used_blocks.push_back(i);
+    used_blocks.push_back(next_block);
+
+    for (unsigned int j = 0; j < nb_data_files - 2; j++) {
+      aux_block = next_block + jump_blocks;
+
+      if ((aux_block < nb_total_blocks) &&
+          (find(used_blocks.begin(), used_blocks.end(),
+                aux_block) == used_blocks.end())) {
+        next_block = aux_block;
+      } else {
+        next_block++;
+
+        while (find(used_blocks.begin(), used_blocks.end(),
+                    next_block) != used_blocks.end()) {
+          next_block++;
+        }
+      }
+
+      srcs.push_back(Packet(next_block, 0));
+      used_blocks.push_back(next_block);
+    }
+
+    schedule.Add(Packet(index_dpblock, 0), srcs);
+  }
+
+  return schedule;
+}
+
+//------------------------------------------------------------------------------
+// Bit-matrix schedule, coding block i follows the k data blocks
+//------------------------------------------------------------------------------
+XorSchedule
+XorSchedule::Bitmatrix(int k, int m, int w, const int* bitmatrix,
+                       size_t packet_size)
+{
+  XorSchedule schedule(w, packet_size);
+  std::vector<Packet> srcs;
+
+  for (int row = 0; row < m * w; ++row) {
+    const int* bits = bitmatrix + row * k * w;
+    srcs.clear();
+
+    for (int col = 0; col < k * w; ++col) {
+      if (bits[col]) {
+        srcs.push_back(Packet(col / w, col % w));
+      }
+    }
+
+    schedule.Add(Packet(k + row / w, row % w), srcs);
+  }
+
+  return schedule;
+}
+
+EOSFSTNAMESPACE_END
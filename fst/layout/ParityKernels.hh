@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+//! @file ParityKernels.hh
+//! @brief Vectorised XOR kernels and fused XOR schedules used to compute the
+//!        parity of the RAIN layouts
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_PARITYKERNELS_HH__
+#define __EOSFST_PARITYKERNELS_HH__
+
+/*----------------------------------------------------------------------------*/
+#include "fst/Namespace.hh"
+/*----------------------------------------------------------------------------*/
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Compute the XOR of several source blocks into the destination block. The
+//! implementation is selected once at runtime depending on the CPU
+//! (AVX-512, AVX2, SSE2 or generic). The destination may be identical to one
+//! of the sources but must not partially overlap any of them.
+//!
+//! @param dst destination block
+//! @param srcs source blocks, with no source the destination is zeroed
+//! @param nsrcs number of source blocks
+//! @param len length of the blocks in bytes
+//------------------------------------------------------------------------------
+void XorBlocks(char* dst, const char* const* srcs, unsigned int nsrcs,
+               size_t len);
+
+//------------------------------------------------------------------------------
+//! Get the name of the XOR kernel in use
+//------------------------------------------------------------------------------
+const char* GetXorKernel();
+
+//------------------------------------------------------------------------------
+//! Get the names of the XOR kernels supported by this CPU, best one last
+//------------------------------------------------------------------------------
+std::vector<std::string> GetXorKernels();
+
+//------------------------------------------------------------------------------
+//! Select the XOR kernel to use, meant for tests and benchmarks
+//!
+//! @param name kernel name as returned by GetXorKernels
+//!
+//! @return true if the kernel is supported, otherwise false
+//------------------------------------------------------------------------------
+bool SetXorKernel(const std::string& name);
+
+
+//------------------------------------------------------------------------------
+//! Sequence of XOR operations over the packets of a group of blocks.
+//!
+//! The blocks are split in chunks of mPacketsPerChunk packets of mPacketSize
+//! bytes and every operation computes one packet of each chunk as the XOR of
+//! other packets, possibly computed by previous operations. All operations
+//! are applied to a small tile of every packet before moving to the next
+//! tile, so that each block is read from memory only once and every result
+//! is written only once.
+//------------------------------------------------------------------------------
+class XorSchedule
+{
+public:
+  //! Packet identified by block index and packet index inside the chunk
+  typedef std::pair<unsigned int, unsigned int> Packet;
+
+  //! Bytes of each packet processed by all operations in one go
+  static const size_t sTileSize = 2048;
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param packets_per_chunk number of packets in a chunk of a block
+  //! @param packet_size packet size in bytes
+  //----------------------------------------------------------------------------
+  XorSchedule(unsigned int packets_per_chunk = 1, size_t packet_size = 0);
+
+  //----------------------------------------------------------------------------
+  //! Append an operation computing dst as the XOR of srcs
+  //----------------------------------------------------------------------------
+  void Add(const Packet& dst, const std::vector<Packet>& srcs);
+
+  //----------------------------------------------------------------------------
+  //! Apply the schedule to a group of blocks
+  //!
+  //! @param blocks the blocks referred to by the operations
+  //! @param block_size size of a block, multiple of the chunk size
+  //----------------------------------------------------------------------------
+  void Execute(const std::vector<char*>& blocks, size_t block_size) const;
+
+  //----------------------------------------------------------------------------
+  //! Check if the schedule has no operations
+  //----------------------------------------------------------------------------
+  bool Empty() const
+  {
+    return mOps.empty();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Schedule computing the simple and double parity blocks of a RAID-DP
+  //! group with nb_data_files data files
+  //!
+  //! @param nb_data_files number of data files
+  //! @param stripe_width size of a block
+  //----------------------------------------------------------------------------
+  static XorSchedule RaidDp(unsigned int nb_data_files, size_t stripe_width);
+
+  //----------------------------------------------------------------------------
+  //! Schedule computing the coding blocks of a bit-matrix code as encoded by
+  //! jerasure_schedule_encode, i.e. the same parity layout on disk
+  //!
+  //! @param k number of data blocks
+  //! @param m number of coding blocks
+  //! @param w word size
+  //! @param bitmatrix (m * w) x (k * w) bit-matrix
+  //! @param packet_size packet size
+  //----------------------------------------------------------------------------
+  static XorSchedule Bitmatrix(int k, int m, int w, const int* bitmatrix,
+                               size_t packet_size);
+
+private:
+  //! Single operation
+  struct Operation {
+    Packet mDst;
+    std::vector<Packet> mSrcs;
+  };
+
+  unsigned int mPacketsPerChunk; ///< Packets in a chunk of a block
+  size_t mPacketSize; ///< Size of a packet
+  std::vector<Operation> mOps; ///< Operations applied in order
+};
+
+EOSFSTNAMESPACE_END
+
+#endif  // __EOSFST_PARITYKERNELS_HH__
@@ -34,8 +34,6 @@
 
 EOSFSTNAMESPACE_BEGIN
 
-typedef long v2do __attribute__((vector_size(VECTOR_SIZE)));
-
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
@@ -55,6 +53,7 @@ RaidDpLayout::RaidDpLayout(XrdFstOfsFile* file,
   mNbTotalBlocks = mNbDataBlocks + 2 * mNbDataFiles;
   mSizeGroup = mNbDataBlocks * mStripeWidth;
   mSizeLine = mNbDataFiles * mStripeWidth;
+  mParitySchedule = XorSchedule::RaidDp(mNbDataFiles, mStripeWidth);
 }
 
 
@@ -73,118 +72,12 @@ RaidDpLayout::~RaidDpLayout()
 bool
 RaidDpLayout::ComputeParity()
 {
-  int index_pblock;
-  int current_block;
-
-  // Compute simple parity
-  for (unsigned int i = 0; i < mNbDataFiles; i++) {
-    index_pblock = (i + 1) * mNbDataFiles + 2 * i;
-    current_block = i * (mNbDataFiles + 2); //beginning of current line
-    OperationXOR(mDataBlocks[current_block],
-                 mDataBlocks[current_block + 1],
-                 mDataBlocks[index_pblock],
-                 mStripeWidth);
-    current_block += 2;
-
-    while (current_block < index_pblock) {
-      OperationXOR(mDataBlocks[index_pblock],
-                   mDataBlocks[current_block],
-                   mDataBlocks[index_pblock],
-                   mStripeWidth);
-      current_block++;
-    }
-  }
-
-  // Compute double parity
-  unsigned int aux_block;
-  unsigned int next_block;
-  unsigned int index_dpblock;
-  unsigned int jump_blocks = mNbTotalFiles + 1;
-  vector<int> used_blocks;
-
-  for (unsigned int i = 0; i < mNbDataFiles; i++) {
-    index_dpblock = (i + 1) * (mNbDataFiles + 1) + i;
-    used_blocks.push_back(index_dpblock);
-  }
-
-  for (unsigned int i = 0; i < mNbDataFiles; i++) {
-    index_dpblock = (i + 1) * (mNbDataFiles + 1) + i;
-    next_block = i + jump_blocks;
-    OperationXOR(mDataBlocks[i],
-                 mDataBlocks[next_block],
-                 mDataBlocks[index_dpblock],
-                 mStripeWidth);
-    used_blocks.push_back(i);
-    used_blocks.push_back(next_block);
-
-    for (unsigned int j = 0; j < mNbDataFiles - 2; j++) {
-      aux_block = next_block + jump_blocks;
-
-      if ((aux_block < mNbTotalBlocks) &&
-          (find(used_blocks.begin(), used_blocks.end(),
-                aux_block) == used_blocks.end())) {
-        next_block = aux_block;
-      } else {
-        next_block++;
-
-        while (find(used_blocks.begin(), used_blocks.end(),
-                    next_block) != used_blocks.end()) {
-          next_block++;
-        }
-      }
-
-      OperationXOR(mDataBlocks[index_dpblock],
-                   mDataBlocks[next_block],
-                   mDataBlocks[index_dpblock],
-                   mStripeWidth);
-      used_blocks.push_back(next_block);
-    }
-  }
-
+  // Simple and double parity are computed in one pass over the group
+  mParitySchedule.Execute(mDataBlocks, mStripeWidth);
   return true;
 }
 
 
-//------------------------------------------------------------------------------
-// XOR the two blocks using 128 bits and return the result
-//------------------------------------------------------------------------------
-void
-RaidDpLayout::OperationXOR(char* pBlock1,
-                           char* pBlock2,
-                           char* pResult,
-                           size_t totalBytes)
-{
-  v2do* xor_res;
-  v2do* idx1;
-  v2do* idx2;
-  char* byte_res;
-  char* byte_idx1;
-  char* byte_idx2;
-  long int noPices = -1;
-  idx1 = (v2do*) pBlock1;
-  idx2 = (v2do*) pBlock2;
-  xor_res = (v2do*) pResult;
-  noPices = totalBytes / sizeof(v2do);
-
-  for (unsigned int i = 0; i < noPices; idx1++, idx2++, xor_res++, i++) {
-    *xor_res = *idx1 ^ *idx2;
-  }
-
-  // If the block does not devide perfectly to 128 ...
-  if (totalBytes % sizeof(v2do) != 0) {
-    byte_res = (char*) xor_res;
-    byte_idx1 = (char*) idx1;
-    byte_idx2 = (char*) idx2;
-
-    for (unsigned int i = noPices * sizeof(v2do);
-         i < totalBytes;
-         byte_res++, byte_idx1++, byte_idx2++, i++) {
-      *byte_res = *byte_idx1 ^ *byte_idx2;
-    }
-  }
-}
-
-
 //------------------------------------------------------------------------------
 // Use simple and double parity to recover corrupted pieces in the curerent
 // group, all errors in the map belong to the same group
@@ -302,16 +195,7 @@ RaidDpLayout::RecoverPiecesInGroup(XrdCl::ChunkList& grp_errs)
 
     if (ValidHorizStripe(horizontal_stripe, status_blocks, id_corrupted)) {
       // Try to recover using simple parity
-      memset(mDataBlocks[id_corrupted], 0, mStripeWidth);
-
-      for (unsigned int ind = 0; ind < horizontal_stripe.size(); ind++) {
-        if (horizontal_stripe[ind] != id_corrupted) {
-          OperationXOR(mDataBlocks[id_corrupted],
-                       mDataBlocks[horizontal_stripe[ind]],
-                       mDataBlocks[id_corrupted],
-                       mStripeWidth);
-        }
-      }
+      RecoverBlock(id_corrupted, horizontal_stripe);
 
       // Return recovered block and also write it to the file
       stripe_id = id_corrupted % mNbTotalFiles;
@@ -361,16 +245,7 @@ RaidDpLayout::RecoverPiecesInGroup(XrdCl::ChunkList& grp_errs)
     } else {
       // Try to recover using double parity
       if (ValidDiagStripe(diagonal_stripe, status_blocks, id_corrupted)) {
-        memset(mDataBlocks[id_corrupted], 0, mStripeWidth);
-
-        for (unsigned int ind = 0; ind < diagonal_stripe.size(); ind++) {
-          if (diagonal_stripe[ind] != id_corrupted) {
-            OperationXOR(mDataBlocks[id_corrupted],
-                         mDataBlocks[diagonal_stripe[ind]],
-                         mDataBlocks[id_corrupted],
-                         mStripeWidth);
-          }
-        }
+        RecoverBlock(id_corrupted, diagonal_stripe);
 
         // Return recovered block and also write them to the files
         stripe_id = id_corrupted % mNbTotalFiles;
@@ -576,6 +451,25 @@ RaidDpLayout::WriteParityToFiles(uint64_t offGroup)
 }
 
 
+//------------------------------------------------------------------------------
+// Rebuild a block as the XOR of the other blocks of its stripe
+//------------------------------------------------------------------------------
+void
+RaidDpLayout::RecoverBlock(unsigned int blockId,
+                           const std::vector<unsigned int>& stripe)
+{
+  std::vector<const char*> srcs;
+
+  for (auto iter = stripe.begin(); iter != stripe.end(); ++iter) {
+    if (*iter != blockId) {
+      srcs.push_back(mDataBlocks[*iter]);
+    }
+  }
+
+  XorBlocks(mDataBlocks[blockId], srcs.data(), srcs.size(), mStripeWidth);
+}
+
+
 //------------------------------------------------------------------------------
 // Return the indices of the simple parity blocks from a group
 //------------------------------------------------------------------------------
@@ -27,14 +27,11 @@
 
 /*----------------------------------------------------------------------------*/
 #include "fst/layout/RaidMetaLayout.hh"
+#include "fst/layout/ParityKernels.hh"
 /*----------------------------------------------------------------------------*/
 
 EOSFSTNAMESPACE_BEGIN
 
-//! Used for computing XOR or 128 bits = 8 * 16
-#define VECTOR_SIZE 16
-
-
 //------------------------------------------------------------------------------
 //! Implementation of the RAID-double parity layout
 //------------------------------------------------------------------------------
@@ -143,18 +140,14 @@ private:
 
 
   //----------------------------------------------------------------------------
-  //! Compute XOR operation for two blocks of any size
+  //! Rebuild a block as the XOR of the other blocks of its stripe
   //!
-  //! @param pBlock1 first input block
-  //! @param pBlock2 second input block
-  //! @param pResult result of XOR operation
-  //! @param totalBytes size of input blocks
+  //! @param blockId index of the block to rebuild
+  //! @param stripe horizontal or diagonal stripe containing the block
   //!
   //----------------------------------------------------------------------------
-  void OperationXOR(char* pBlock1,
-                    char* pBlock2,
-                    char* pResult,
-                    size_t totalBytes);
+  void RecoverBlock(unsigned int blockId,
+                    const std::vector<unsigned int>& stripe);
 
 
   //----------------------------------------------------------------------------
@@ -314,6 +307,8 @@ private:
   //----------------------------------------------------------------------------
   RaidDpLayout& operator = (const RaidDpLayout&) = delete;
 
+  //! Fused computation of the simple and double parity of a group
+  XorSchedule mParitySchedule;
 };
 
 EOSFSTNAMESPACE_END
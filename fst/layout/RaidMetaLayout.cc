@@ -107,6 +107,23 @@ RaidMetaLayout::~RaidMetaLayout()
   }
 }
 
+//------------------------------------------------------------------------------
+// Build the opaque information used to open one of the stripes
+//------------------------------------------------------------------------------
+std::string
+RaidMetaLayout::GetStripeOpaque(const char* opaque, unsigned int index,
+                                uint64_t stripe_width)
+{
+  std::string stripe_opaque = (opaque ? opaque : "");
+  stripe_opaque += "&mgm.replicaindex=";
+  stripe_opaque += std::to_string(index);
+  // The stripes only get the adaptive readahead, see XrdIo::fileOpen
+  stripe_opaque += "&fst.readahead=true";
+  stripe_opaque += "&fst.blocksize=";
+  stripe_opaque += std::to_string(static_cast<int>(stripe_width));
+  return stripe_opaque;
+}
+
 //------------------------------------------------------------------------------
 // Redirect to new target
 //------------------------------------------------------------------------------
@@ -409,13 +426,8 @@ RaidMetaLayout::OpenPio(std::vector<std::string> stripeUrls,
   for (unsigned int i = 0; i < stripe_urls.size(); i++) {
     int ret = -1;
     FileIo* file = FileIoPlugin::GetIoObject(stripe_urls[i]);
-    XrdOucString openOpaque = opaque;
-    openOpaque += "&mgm.replicaindex=";
-    openOpaque += static_cast<int>(i);
-    openOpaque += "&fst.readahead=true";
-    openOpaque += "&fst.blocksize=";
-    openOpaque += static_cast<int>(mStripeWidth);
-    ret = file->fileOpen(flags, mode, openOpaque.c_str());
+    std::string openOpaque = GetStripeOpaque(opaque, i, mStripeWidth);
+    ret = file->fileOpen(flags, mode, openOpaque);
     mLastTriedUrl = file->GetLastTriedUrl();
     if (ret == SFS_ERROR) {
       eos_err("failed to open remote stripes", stripe_urls[i].c_str());
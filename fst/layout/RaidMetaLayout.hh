@@ -74,6 +74,19 @@ public:
   //----------------------------------------------------------------------------
   virtual ~RaidMetaLayout();
 
+  //----------------------------------------------------------------------------
+  //! Build the opaque information used to open one of the stripes
+  //!
+  //! @param opaque opaque information of the file
+  //! @param index index of the stripe
+  //! @param stripe_width stripe width used as readahead block size
+  //!
+  //! @return opaque information of the stripe
+  //----------------------------------------------------------------------------
+  static std::string GetStripeOpaque(const char* opaque,
+                                     unsigned int index,
+                                     uint64_t stripe_width);
+
   //--------------------------------------------------------------------------
   //! Redirect to new target
   //--------------------------------------------------------------------------
@@ -94,8 +94,8 @@ ReedSLayout::InitialiseJerasure()
   matrix = cauchy_good_general_coding_matrix(mNbDataBlocks, mNbParityFiles, w);
   bitmatrix = jerasure_matrix_to_bitmatrix(mNbDataBlocks, mNbParityFiles, w,
               matrix);
-  schedule = jerasure_smart_bitmatrix_to_schedule(mNbDataBlocks, mNbParityFiles,
-             w, bitmatrix);
+  mEncodeSchedule = XorSchedule::Bitmatrix(mNbDataBlocks, mNbParityFiles, w,
+                                           bitmatrix, mPacketSize);
   return true;
 }
 
@@ -116,21 +116,9 @@ ReedSLayout::ComputeParity()
     mDoneInitialisation = true;
   }
 
-  // Get pointers to data and parity information
-  char* coding[mNbParityFiles];
-  char* data[mNbDataFiles];
-
-  for (unsigned int i = 0; i < mNbDataFiles; i++) {
-    data[i] = (char*) mDataBlocks[i];
-  }
-
-  for (unsigned int i = 0; i < mNbParityFiles; i++) {
-    coding[i] = (char*) mDataBlocks[mNbDataFiles + i];
-  }
-
-  // Encode the blocks
-  jerasure_schedule_encode(mNbDataBlocks, mNbParityFiles, w, schedule, data,
-                           coding, mStripeWidth, mPacketSize);
+  // Encode the blocks, this produces the same coding blocks as
+  // jerasure_schedule_encode but reads each data block only once
+  mEncodeSchedule.Execute(mDataBlocks, mStripeWidth);
   return true;
 }
 
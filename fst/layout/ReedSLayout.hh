@@ -27,6 +27,7 @@
 
 /*----------------------------------------------------------------------------*/
 #include "fst/layout/RaidMetaLayout.hh"
+#include "fst/layout/ParityKernels.hh"
 /*----------------------------------------------------------------------------*/
 
 EOSFSTNAMESPACE_BEGIN
@@ -111,7 +112,7 @@ private:
   unsigned int mPacketSize; ///< packet size for Jerasure
   int* matrix;
   int* bitmatrix;
-  int** schedule;
+  XorSchedule mEncodeSchedule; ///< Fused encoding with the bit-matrix
 
 
   //----------------------------------------------------------------------------
@@ -335,6 +335,37 @@ Storage::Publish()
                        (long long)(gFmdDbMapHandler.dbmap.count(fsid) ?
                                    gFmdDbMapHandler.dbmap[fsid]->size() : 0));
 	    }
+          {
+            // progress of the disk resync of the boot
+            FmdDbMapHandler::ResyncStats rstats;
+
+            if (gFmdDbMapHandler.GetDiskResyncStats(fsid, rstats)) {
+              bool running = !rstats.mStop.tv_sec;
+              struct timeval stop = rstats.mStop;
+
+              if (running) {
+                gettimeofday(&stop, 0);
+              }
+
+              double elapsed = (stop.tv_sec - rstats.mStart.tv_sec) +
+                               (stop.tv_usec - rstats.mStart.tv_usec) / 1000000.0;
+
+              if (elapsed <= 0) {
+                elapsed = 1;
+              }
+
+              success &= fileSystemsVector[i]->SetLongLong("stat.resync.disk.files",
+                         rstats.mFiles);
+              success &= fileSystemsVector[i]->SetLongLong("stat.resync.disk.bytes",
+                         rstats.mBytes);
+              success &= fileSystemsVector[i]->SetDouble("stat.resync.disk.rate",
+                         rstats.mFiles / elapsed);
+              success &= fileSystemsVector[i]->SetDouble("stat.resync.disk.ratemb",
+                         rstats.mBytes / elapsed / 1000000.0);
+              success &= fileSystemsVector[i]->SetString("stat.resync.disk.status",
+                         running ? "running" : "done");
+            }
+          }
           success &= fileSystemsVector[i]->SetString("stat.boot",
                      fileSystemsVector[i]->GetStatusAsString(fileSystemsVector[i]->GetStatus()));
           success &= fileSystemsVector[i]->SetString("stat.geotag", lNodeGeoTag.c_str());
@@ -432,6 +463,10 @@ Storage::Publish()
             gettimeofday(&tvfs, &tz);
             size_t nowms = tvfs.tv_sec * 1000 + tvfs.tv_usec / 1000;
             hash->Set("stat.publishtimestamp", nowms);
+            hash->Set("stat.xs.rescan.bytes",
+                      (long long) gOFS.mXsRescanBytes.load());
+            hash->Set("stat.xs.rescan.savedbytes",
+                      (long long) gOFS.mXsRescanBytesSaved.load());
           }
 
           gOFS.ObjectManager.HashMutex.UnLockRead();
@@ -79,6 +79,14 @@ Storage::Storage(const char* metadirectory)
   }
 
   zombie = false;
+  // number of filesystems resyncing from the mgm at the same time during boot
+  mMgmResyncSlots = 8;
+
+  if (getenv("EOS_FST_RESYNC_MGM_PARALLEL") &&
+      (atoi(getenv("EOS_FST_RESYNC_MGM_PARALLEL")) > 0)) {
+    mMgmResyncSlots = atoi(getenv("EOS_FST_RESYNC_MGM_PARALLEL"));
+  }
+
   // start threads
   pthread_t tid;
   // we need page aligned addresses for direct IO
@@ -436,8 +444,23 @@ Storage::Boot(FileSystem* fs)
   if (resyncmgm) {
     eos_info("msg=\"start mgm synchronisation\" fsid=%lu", (unsigned long) fsid);
 
+    // wait for a free slot, the filesystems boot in parallel
+    mMgmResyncCond.Lock();
+
+    while (mMgmResyncSlots <= 0) {
+      mMgmResyncCond.Wait();
+    }
+
+    mMgmResyncSlots--;
+    mMgmResyncCond.UnLock();
     // resync the MGM meta data
-    if (!gFmdDbMapHandler.ResyncAllMgm(fsid, manager.c_str())) {
+    bool resynced = gFmdDbMapHandler.ResyncAllMgm(fsid, manager.c_str());
+    mMgmResyncCond.Lock();
+    mMgmResyncSlots++;
+    mMgmResyncCond.Signal();
+    mMgmResyncCond.UnLock();
+
+    if (!resynced) {
       fs->SetStatus(eos::common::FileSystem::kBootFailure);
       fs->SetError(EFAULT, "cannot resync the mgm meta data");
       return;
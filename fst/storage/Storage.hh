@@ -174,6 +174,9 @@ public:
 
   void Boot (FileSystem* fs);
 
+  XrdSysCondVar mMgmResyncCond; // protects the mgm resync slots, signaled when one is freed
+  int mMgmResyncSlots; // number of filesystems which may still start an mgm resync
+
   eos::fst::Verify* runningVerify;
 
   XrdSysMutex deletionsMutex;
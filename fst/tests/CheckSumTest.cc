@@ -0,0 +1,239 @@
+//------------------------------------------------------------------------------
+//! @file CheckSumTest.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "CheckSumTest.hh"
+#include "fst/checksum/Adler.hh"
+#include "fst/checksum/CRC32.hh"
+#include "fst/checksum/CRC32C.hh"
+#include "fst/checksum/adler32.h"
+#include "fst/checksum/crc32c.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CheckSumTest);
+
+using eos::fst::CheckSum;
+
+namespace
+{
+//------------------------------------------------------------------------------
+// Create the combinable checksum objects
+//------------------------------------------------------------------------------
+std::vector<std::unique_ptr<CheckSum>>
+MakeCheckSums()
+{
+  std::vector<std::unique_ptr<CheckSum>> xs;
+  xs.emplace_back(new eos::fst::Adler());
+  xs.emplace_back(new eos::fst::CRC32());
+  xs.emplace_back(new eos::fst::CRC32C());
+  return xs;
+}
+
+//------------------------------------------------------------------------------
+// Read callback serving the test data and counting the bytes read
+//------------------------------------------------------------------------------
+struct MemFile {
+  const std::vector<char>* mData;
+  size_t mRead;
+};
+
+int
+MemRead(CheckSum::ReadCallBack::callback_data_t* cbd)
+{
+  MemFile* file = static_cast<MemFile*>(cbd->caller);
+
+  if ((size_t) cbd->offset >= file->mData->size()) {
+    return 0;
+  }
+
+  size_t len = std::min(cbd->size, file->mData->size() - cbd->offset);
+  memcpy(cbd->buffer, file->mData->data() + cbd->offset, len);
+  file->mRead += len;
+  return len;
+}
+
+//------------------------------------------------------------------------------
+// Sequential checksum of the data
+//------------------------------------------------------------------------------
+std::string
+Reference(CheckSum* xs, const std::vector<char>& data)
+{
+  xs->Reset();
+  xs->Add(data.data(), data.size(), 0);
+  xs->Finalize();
+  std::string value = xs->GetHexChecksum();
+  xs->Reset();
+  return value;
+}
+}
+
+//------------------------------------------------------------------------------
+// CPPUNIT setUp method
+//------------------------------------------------------------------------------
+void CheckSumTest::setUp(void)
+{
+  std::mt19937 gen(42);
+  mData.resize(3 * 1024 * 1024 + 123);
+
+  for (auto& byte : mData) {
+    byte = (char) gen();
+  }
+}
+
+//------------------------------------------------------------------------------
+// CPPUNIT tearDown method
+//------------------------------------------------------------------------------
+void CheckSumTest::tearDown(void)
+{
+  mData.clear();
+}
+
+//------------------------------------------------------------------------------
+// Out-of-order writes
+//------------------------------------------------------------------------------
+void CheckSumTest::OutOfOrderTest()
+{
+  const size_t block = 64 * 1024;
+  std::vector<off_t> offsets;
+
+  for (size_t off = 0; off < mData.size(); off += block) {
+    offsets.push_back(off);
+  }
+
+  std::shuffle(offsets.begin(), offsets.end(), std::mt19937(7));
+
+  for (auto& xs : MakeCheckSums()) {
+    std::string ref = Reference(xs.get(), mData);
+
+    for (auto off : offsets) {
+      xs->Add(mData.data() + off, std::min(block, mData.size() - off), off);
+    }
+
+    CPPUNIT_ASSERT(xs->NeedsRecalculation());
+    xs->Finalize();
+    CPPUNIT_ASSERT(!xs->NeedsRecalculation());
+    CPPUNIT_ASSERT_EQUAL(ref, std::string(xs->GetHexChecksum()));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Holes and overwrites
+//------------------------------------------------------------------------------
+void CheckSumTest::HolesAndOverwriteTest()
+{
+  const size_t mb = 1024 * 1024;
+
+  for (auto& xs : MakeCheckSums()) {
+    std::string ref = Reference(xs.get(), mData);
+    // [0, 1M) and [2M, 3M) written, [1M, 2M) and the tail are holes
+    xs->Add(mData.data(), mb, 0);
+    xs->Add(mData.data() + 2 * mb, mb, 2 * mb);
+    // Overwriting inside [2M, 3M) invalidates that range
+    xs->Add(mData.data() + 2 * mb + 10, 10, 2 * mb + 10);
+    xs->Finalize();
+    CPPUNIT_ASSERT(xs->NeedsRecalculation());
+    MemFile file {&mData, 0};
+    CheckSum::ReadCallBack::callback_data_t cbd;
+    cbd.caller = &file;
+    CheckSum::ReadCallBack cb(MemRead, cbd);
+    unsigned long long scansize = 0;
+    unsigned long long savedsize = 0;
+    float scantime = 0;
+    CPPUNIT_ASSERT(xs->ScanHoles(cb, scansize, savedsize, scantime));
+    CPPUNIT_ASSERT_EQUAL(ref, std::string(xs->GetHexChecksum()));
+    CPPUNIT_ASSERT_EQUAL((unsigned long long)(mb + 10), savedsize);
+    CPPUNIT_ASSERT_EQUAL((unsigned long long)(mData.size() - mb - 10),
+                         scansize);
+    CPPUNIT_ASSERT_EQUAL((size_t) scansize, file.mRead);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Append to a file with a known checksum
+//------------------------------------------------------------------------------
+void CheckSumTest::PresetAppendTest()
+{
+  const size_t head = 2 * 1024 * 1024;
+  std::vector<char> head_data(mData.begin(), mData.begin() + head);
+
+  for (auto& xs : MakeCheckSums()) {
+    std::string ref = Reference(xs.get(), mData);
+    std::string head_xs = Reference(xs.get(), head_data);
+    xs->ResetInit(0, head, head_xs.c_str());
+    xs->Add(mData.data() + head, mData.size() - head, head);
+    xs->Finalize();
+    CPPUNIT_ASSERT(!xs->NeedsRecalculation());
+    CPPUNIT_ASSERT_EQUAL(ref, std::string(xs->GetHexChecksum()));
+    // Without a known checksum the head has to be read again
+    xs->ResetInit(0, head, "");
+    xs->Add(mData.data() + head, mData.size() - head, head);
+    xs->Finalize();
+    CPPUNIT_ASSERT(xs->NeedsRecalculation());
+  }
+}
+
+//------------------------------------------------------------------------------
+// CPU specific implementations
+//------------------------------------------------------------------------------
+void CheckSumTest::ImplementationsTest()
+{
+  const size_t lengths[] = {0, 1, 31, 32, 33, 767, 768, 5536, 5553, 24577,
+                            100000, 1024 * 1024 + 7
+                           };
+  // All 0xff bytes give the largest intermediate sums of adler32
+  std::vector<char> ones(mData.size(), (char) 0xff);
+  bool has_avx2 = checksum::adler32HasAvx2();
+  __builtin_cpu_init();
+  bool has_pclmul = __builtin_cpu_supports("sse4.2") &&
+                    __builtin_cpu_supports("pclmul");
+
+  for (auto data : {&mData, &ones}) {
+    for (size_t align = 0; align < 8; align++) {
+      for (auto len : lengths) {
+        const char* ptr = data->data() + align;
+        uint32_t adler = 0x12345678;
+
+        if (has_avx2) {
+          CPPUNIT_ASSERT_EQUAL((uint32_t)::adler32(adler, (const Bytef*) ptr,
+                               len), checksum::adler32Avx2(adler, ptr, len));
+        }
+
+        CPPUNIT_ASSERT_EQUAL((uint32_t)::adler32(1, (const Bytef*) ptr, len),
+                             checksum::adler32(1, ptr, len));
+        uint32_t crc = checksum::crc32cSlicingBy8(checksum::crc32cInit(),
+                       ptr, len);
+
+        if (has_pclmul) {
+          CPPUNIT_ASSERT_EQUAL(crc, checksum::crc32cHardware64Pclmul(
+                                 checksum::crc32cInit(), ptr, len));
+        }
+
+        CPPUNIT_ASSERT_EQUAL(crc, checksum::crc32c(checksum::crc32cInit(),
+                             ptr, len));
+      }
+    }
+  }
+}
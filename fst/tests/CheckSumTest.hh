@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+//! @file CheckSumTest.hh
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_TESTS_CHECKSUMTEST__HH__
+#define __EOSFST_TESTS_CHECKSUMTEST__HH__
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <vector>
+
+//------------------------------------------------------------------------------
+//! Class CheckSumTest - combination of the range checksums of out-of-order
+//! writes for adler, crc32 and crc32c and the CPU specific implementations
+//------------------------------------------------------------------------------
+class CheckSumTest : public CppUnit::TestCase
+{
+  CPPUNIT_TEST_SUITE(CheckSumTest);
+  CPPUNIT_TEST(OutOfOrderTest);
+  CPPUNIT_TEST(HolesAndOverwriteTest);
+  CPPUNIT_TEST(PresetAppendTest);
+  CPPUNIT_TEST(ImplementationsTest);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::vector<char> mData; ///< File contents used by all tests
+
+public:
+  //----------------------------------------------------------------------------
+  //! CPPUNIT required methods
+  //----------------------------------------------------------------------------
+  void setUp(void);
+  void tearDown(void);
+
+  //----------------------------------------------------------------------------
+  //! Blocks written in random order give the sequential checksum
+  //----------------------------------------------------------------------------
+  void OutOfOrderTest();
+
+  //----------------------------------------------------------------------------
+  //! Holes and overwritten ranges are the only parts rescanned
+  //----------------------------------------------------------------------------
+  void HolesAndOverwriteTest();
+
+  //----------------------------------------------------------------------------
+  //! Appending to a file with a known checksum needs no rescan
+  //----------------------------------------------------------------------------
+  void PresetAppendTest();
+
+  //----------------------------------------------------------------------------
+  //! Vectorised adler32 and crc32c give the same values as the reference ones
+  //! for any length and alignment
+  //----------------------------------------------------------------------------
+  void ImplementationsTest();
+};
+
+#endif // __EOSFST_TESTS_CHECKSUMTEST__HH__
@@ -0,0 +1,256 @@
+//------------------------------------------------------------------------------
+//! @file XrdIoReadaheadTest.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "XrdIoReadaheadTest.hh"
+#include "fst/layout/RaidMetaLayout.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include <cstdlib>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(XrdIoReadaheadTest);
+
+using eos::fst::XrdIo;
+using eos::fst::ReadaheadBlock;
+using eos::fst::ReadaheadStream;
+using eos::fst::RaidMetaLayout;
+
+//! Read size of the tests
+static const uint32_t sReadSize = 64 * 1024;
+//! Readahead block size of the tests
+static const uint32_t sBlocksize = 1024 * 1024;
+
+//------------------------------------------------------------------------------
+// CPPUNIT setUp method
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::setUp(void)
+{
+  mReadSeq = 0;
+}
+
+//------------------------------------------------------------------------------
+// CPPUNIT tearDown method
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::tearDown(void)
+{
+  for (auto stream : mStreams) {
+    for (auto& elem : stream->mBlocks) {
+      delete elem.second;
+    }
+
+    delete stream;
+  }
+
+  for (auto& elem : mStale) {
+    delete elem.second;
+  }
+
+  mStreams.clear();
+  mStale.clear();
+}
+
+//------------------------------------------------------------------------------
+// Match a read to a stream and release the stream
+//------------------------------------------------------------------------------
+ReadaheadStream*
+XrdIoReadaheadTest::Read(uint64_t offset, uint32_t length)
+{
+  ReadaheadStream* stream = XrdIo::MatchStream(mStreams, mReadSeq, offset,
+                            length, mStale);
+
+  if (stream) {
+    stream->mRefs--;
+  }
+
+  return stream;
+}
+
+//------------------------------------------------------------------------------
+// Sequential reads
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::SequentialTest()
+{
+  uint64_t next_offset = 0;
+  uint64_t step = 0;
+  uint32_t length = 0;
+  ReadaheadStream* stream = Read(0, sReadSize);
+  CPPUNIT_ASSERT(stream);
+  CPPUNIT_ASSERT(!XrdIo::PredictStream(*stream, sBlocksize, next_offset, step,
+                                       length));
+
+  for (uint64_t offset = sReadSize; offset < 16 * sReadSize;
+       offset += sReadSize) {
+    CPPUNIT_ASSERT(Read(offset, sReadSize) == stream);
+    CPPUNIT_ASSERT(XrdIo::PredictStream(*stream, sBlocksize, next_offset, step,
+                                        length));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, stream->mStride);
+    CPPUNIT_ASSERT_EQUAL(offset + sReadSize, next_offset);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) sBlocksize, step);
+    CPPUNIT_ASSERT_EQUAL(sBlocksize, length);
+  }
+
+  CPPUNIT_ASSERT_EQUAL((size_t) 1, mStreams.size());
+  // A read inside the data prefetched for the stream belongs to it
+  stream->mRangeStart = 16 * sReadSize;
+  stream->mRangeEnd = stream->mRangeStart + 2 * sBlocksize;
+  CPPUNIT_ASSERT(Read(stream->mRangeStart + sBlocksize, sReadSize) == stream);
+  CPPUNIT_ASSERT_EQUAL((size_t) 1, mStreams.size());
+}
+
+//------------------------------------------------------------------------------
+// Strided reads
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::StridedTest()
+{
+  const uint64_t stride = 10 * sBlocksize;
+  const uint32_t rlen = 4096;
+  uint64_t next_offset = 0;
+  uint64_t step = 0;
+  uint32_t length = 0;
+  ReadaheadStream* stream = Read(0, rlen);
+  CPPUNIT_ASSERT(stream);
+  // The second read only makes the stride a candidate
+  CPPUNIT_ASSERT(Read(stride, rlen) == stream);
+  CPPUNIT_ASSERT_EQUAL(stride, stream->mStride);
+  CPPUNIT_ASSERT(!XrdIo::PredictStream(*stream, sBlocksize, next_offset, step,
+                                       length));
+
+  for (uint64_t offset = 2 * stride; offset < 10 * stride; offset += stride) {
+    CPPUNIT_ASSERT(Read(offset, rlen) == stream);
+    CPPUNIT_ASSERT(XrdIo::PredictStream(*stream, sBlocksize, next_offset, step,
+                                        length));
+    CPPUNIT_ASSERT_EQUAL(offset + stride, next_offset);
+    CPPUNIT_ASSERT_EQUAL(stride, step);
+    CPPUNIT_ASSERT_EQUAL(rlen, length);
+  }
+
+  CPPUNIT_ASSERT_EQUAL((size_t) 1, mStreams.size());
+  // Strides beyond the limit are not followed
+  ReadaheadStream* other = Read(100 * stride, rlen);
+  CPPUNIT_ASSERT(other != stream);
+  CPPUNIT_ASSERT(Read(100 * stride + XrdIo::sMaxRdAheadStride + 1, rlen) !=
+                 other);
+}
+
+//------------------------------------------------------------------------------
+// Random reads
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::RandomTest()
+{
+  uint64_t next_offset = 0;
+  uint64_t step = 0;
+  uint32_t length = 0;
+  // Every read lands before all the previous ones, no stride can be guessed
+  // and no read continues another one
+  std::vector<uint64_t> offsets = {
+    900 * (uint64_t) sBlocksize, 700 * (uint64_t) sBlocksize,
+    500 * (uint64_t) sBlocksize, 300 * (uint64_t) sBlocksize,
+    100 * (uint64_t) sBlocksize, 50 * (uint64_t) sBlocksize,
+    10 * (uint64_t) sBlocksize, 5 * (uint64_t) sBlocksize
+  };
+
+  for (auto offset : offsets) {
+    ReadaheadStream* stream = Read(offset, sReadSize);
+    CPPUNIT_ASSERT(stream);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, stream->mMatches);
+    CPPUNIT_ASSERT(!XrdIo::PredictStream(*stream, sBlocksize, next_offset, step,
+                                         length));
+  }
+
+  CPPUNIT_ASSERT_EQUAL((size_t) XrdIo::sMaxRdAheadStreams, mStreams.size());
+}
+
+//------------------------------------------------------------------------------
+// Recycling of the streams
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::RecycleTest()
+{
+  std::vector<ReadaheadStream*> streams;
+
+  for (uint32_t i = 0; i < XrdIo::sMaxRdAheadStreams; ++i) {
+    streams.push_back(Read((XrdIo::sMaxRdAheadStreams - i) * 1000 *
+                           (uint64_t) sBlocksize, sReadSize));
+  }
+
+  // The oldest stream owns a prefetched block
+  ReadaheadBlock* block = new ReadaheadBlock(sBlocksize);
+  streams[0]->mBlocks[streams[0]->mLastOffset + sReadSize] = block;
+  ReadaheadStream* stream = Read(0, sReadSize);
+  CPPUNIT_ASSERT(stream == streams[0]);
+  CPPUNIT_ASSERT(stream->mBlocks.empty());
+  CPPUNIT_ASSERT_EQUAL((size_t) 1, mStale.size());
+  CPPUNIT_ASSERT(mStale.begin()->second == block);
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 0, stream->mLastOffset);
+  CPPUNIT_ASSERT_EQUAL((uint32_t) 0, stream->mMatches);
+  CPPUNIT_ASSERT_EQUAL(XrdIo::sNumRdAheadBlocks, stream->mWindow);
+
+  // Streams referenced by readers are never recycled
+  for (auto s : mStreams) {
+    s->mRefs++;
+  }
+
+  CPPUNIT_ASSERT(!XrdIo::MatchStream(mStreams, mReadSeq, 5000 *
+                                     (uint64_t) sBlocksize, sReadSize, mStale));
+  streams[2]->mRefs--;
+  stream = XrdIo::MatchStream(mStreams, mReadSeq, 5000 * (uint64_t) sBlocksize,
+                              sReadSize, mStale);
+  CPPUNIT_ASSERT(stream == streams[2]);
+  CPPUNIT_ASSERT_EQUAL((size_t) XrdIo::sMaxRdAheadStreams, mStreams.size());
+
+  for (auto s : mStreams) {
+    s->mRefs = 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Readahead of the stripes opened by the RAIN layouts
+//------------------------------------------------------------------------------
+void XrdIoReadaheadTest::RainStripeOpenTest()
+{
+  const char* prev = getenv("EOS_FST_XRDIO_READAHEAD");
+  std::string saved = (prev ? prev : "");
+  std::string opaque = RaidMetaLayout::GetStripeOpaque("mgm.path=/eos/f", 3,
+                       sBlocksize);
+  XrdOucEnv stripe_opaque(opaque.c_str());
+  CPPUNIT_ASSERT(stripe_opaque.Get("mgm.replicaindex"));
+  CPPUNIT_ASSERT_EQUAL(std::string("3"),
+                       std::string(stripe_opaque.Get("mgm.replicaindex")));
+  CPPUNIT_ASSERT(stripe_opaque.Get("fst.blocksize"));
+  CPPUNIT_ASSERT_EQUAL(std::to_string(sBlocksize),
+                       std::string(stripe_opaque.Get("fst.blocksize")));
+  // Without the adaptive mode the stripes are read without readahead
+  unsetenv("EOS_FST_XRDIO_READAHEAD");
+  CPPUNIT_ASSERT(!XrdIo::IsOpenReadaheadRequest(stripe_opaque));
+  setenv("EOS_FST_XRDIO_READAHEAD", "fixed", 1);
+  CPPUNIT_ASSERT(!XrdIo::IsOpenReadaheadRequest(stripe_opaque));
+  // The adaptive mode enforced on the FST reaches the stripes
+  setenv("EOS_FST_XRDIO_READAHEAD", "adaptive", 1);
+  CPPUNIT_ASSERT(XrdIo::IsOpenReadaheadRequest(stripe_opaque));
+  // An explicit request for the adaptive readahead is always honoured
+  unsetenv("EOS_FST_XRDIO_READAHEAD");
+  XrdOucEnv adaptive_opaque("fst.readahead=adaptive");
+  CPPUNIT_ASSERT(XrdIo::IsOpenReadaheadRequest(adaptive_opaque));
+  XrdOucEnv no_opaque("mgm.path=/eos/f");
+  CPPUNIT_ASSERT(!XrdIo::IsOpenReadaheadRequest(no_opaque));
+
+  if (prev) {
+    setenv("EOS_FST_XRDIO_READAHEAD", saved.c_str(), 1);
+  }
+}
@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+//! @file XrdIoReadaheadTest.hh
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_TESTS_XRDIOREADAHEADTEST__HH__
+#define __EOSFST_TESTS_XRDIOREADAHEADTEST__HH__
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "fst/io/xrd/XrdIo.hh"
+#include <vector>
+
+//------------------------------------------------------------------------------
+//! Class XrdIoReadaheadTest - access pattern detection of the adaptive
+//! readahead of XrdIo
+//------------------------------------------------------------------------------
+class XrdIoReadaheadTest : public CppUnit::TestCase
+{
+  CPPUNIT_TEST_SUITE(XrdIoReadaheadTest);
+  CPPUNIT_TEST(SequentialTest);
+  CPPUNIT_TEST(StridedTest);
+  CPPUNIT_TEST(RandomTest);
+  CPPUNIT_TEST(RecycleTest);
+  CPPUNIT_TEST(RainStripeOpenTest);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::vector<eos::fst::ReadaheadStream*> mStreams; ///< Streams of the file
+  uint64_t mReadSeq; ///< Sequence number of the reads
+  eos::fst::PrefetchMap mStale; ///< Blocks of the recycled streams
+
+  //----------------------------------------------------------------------------
+  //! Match a read to a stream and release the stream like a reader does
+  //----------------------------------------------------------------------------
+  eos::fst::ReadaheadStream* Read(uint64_t offset, uint32_t length);
+
+public:
+  //----------------------------------------------------------------------------
+  //! CPPUNIT required methods
+  //----------------------------------------------------------------------------
+  void setUp(void);
+  void tearDown(void);
+
+  //----------------------------------------------------------------------------
+  //! Contiguous reads form one stream, prefetched block by block once the
+  //! second read confirms the pattern
+  //----------------------------------------------------------------------------
+  void SequentialTest();
+
+  //----------------------------------------------------------------------------
+  //! Reads at a constant distance are prefetched once the third read
+  //! confirms the stride
+  //----------------------------------------------------------------------------
+  void StridedTest();
+
+  //----------------------------------------------------------------------------
+  //! Random reads never trigger any prefetch
+  //----------------------------------------------------------------------------
+  void RandomTest();
+
+  //----------------------------------------------------------------------------
+  //! The least recently used idle stream is recycled and its blocks are
+  //! handed back to the caller, busy streams are never recycled
+  //----------------------------------------------------------------------------
+  void RecycleTest();
+
+  //----------------------------------------------------------------------------
+  //! The stripes opened by the RAIN layouts get the adaptive readahead only
+  //! when the FST enforces it with EOS_FST_XRDIO_READAHEAD=adaptive
+  //----------------------------------------------------------------------------
+  void RainStripeOpenTest();
+};
+
+#endif // __EOSFST_TESTS_XRDIOREADAHEADTEST__HH__
@@ -0,0 +1,507 @@
+// ----------------------------------------------------------------------
+// File: TransferExecutor.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+/*----------------------------------------------------------------------------*/
+#include "fst/txqueue/TransferExecutor.hh"
+#include "fst/checksum/ChecksumPlugins.hh"
+#include "common/LayoutId.hh"
+#include "common/Logging.hh"
+/*----------------------------------------------------------------------------*/
+#include "XrdOuc/XrdOucEnv.hh"
+/*----------------------------------------------------------------------------*/
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <ctime>
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Milliseconds on the steady clock
+//------------------------------------------------------------------------------
+static uint64_t
+NowMs()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>
+         (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------
+// Hex checksum in lower case without leading zeros
+//------------------------------------------------------------------------------
+static std::string
+NormalizeHex(const std::string& hex)
+{
+  std::string out;
+
+  for (auto it = hex.begin(); it != hex.end(); ++it) {
+    if (out.empty() && (*it == '0')) {
+      continue;
+    }
+
+    out += (char) tolower(*it);
+  }
+
+  return out;
+}
+
+//------------------------------------------------------------------------------
+// Handle the response of a read or write of a slot
+//------------------------------------------------------------------------------
+void
+TransferExecutor::IoHandler::HandleResponse(XrdCl::XRootDStatus* status,
+    XrdCl::AnyObject* response)
+{
+  uint32_t length = 0;
+
+  if (!mWrite && status->IsOK() && response) {
+    XrdCl::ChunkInfo* chunk = 0;
+    response->Get(chunk);
+
+    if (chunk) {
+      length = chunk->length;
+    }
+  }
+
+  mExecutor->Done(mSlot, mWrite, *status, length);
+  delete status;
+  delete response;
+}
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+TransferExecutor::TransferExecutor(const std::string& source,
+                                   const std::string& target,
+                                   TransferShaper* shaper,
+                                   uint32_t nbuffers,
+                                   uint32_t buffersize):
+  mSource(source), mTarget(target), mShaper(shaper),
+  mBufferSize(buffersize ? buffersize : sDefaultBufferSize), mTimeout(0),
+  mOutstanding(0), mErrno(0), mChecksum(0), mCanceled(false), mSize(0),
+  mBytesCopied(0), mStartMs(0), mStopMs(0)
+{
+  mSlots.resize(nbuffers ? nbuffers : sDefaultBuffers);
+
+  for (size_t i = 0; i < mSlots.size(); i++) {
+    mSlots[i].mBuffer = 0;
+    mSlots[i].mOffset = 0;
+    mSlots[i].mLength = 0;
+    mSlots[i].mState = kIdle;
+    mSlots[i].mReadHandler = new IoHandler(this, i, false);
+    mSlots[i].mWriteHandler = new IoHandler(this, i, true);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+TransferExecutor::~TransferExecutor()
+{
+  for (auto it = mSlots.begin(); it != mSlots.end(); ++it) {
+    free(it->mBuffer);
+    delete it->mReadHandler;
+    delete it->mWriteHandler;
+  }
+
+  delete mChecksum;
+}
+
+//------------------------------------------------------------------------------
+// Configure the checksum computed on the fly
+//------------------------------------------------------------------------------
+bool
+TransferExecutor::SetChecksum(const std::string& type,
+                              const std::string& expected)
+{
+  std::string opaque = "eos.layout.checksum=" + type;
+  XrdOucEnv env(opaque.c_str());
+  unsigned long xs = eos::common::LayoutId::GetChecksumFromEnv(env);
+  CheckSum* checksum = 0;
+
+  if (xs != eos::common::LayoutId::kNone) {
+    checksum = ChecksumPlugins::GetChecksumObject(
+                 eos::common::LayoutId::GetId(eos::common::LayoutId::kPlain, xs));
+  }
+
+  if (!checksum) {
+    return false;
+  }
+
+  delete mChecksum;
+  mChecksum = checksum;
+  mChecksum->Reset();
+  mChecksumType = type;
+  mChecksumExpected = expected;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Get the progress in percent
+//------------------------------------------------------------------------------
+float
+TransferExecutor::GetProgress() const
+{
+  uint64_t size = mSize;
+
+  if (!size) {
+    return (mStopMs ? 100.0 : 0.0);
+  }
+
+  return (100.0 * mBytesCopied) / size;
+}
+
+//------------------------------------------------------------------------------
+// Record the first error of the copy
+//------------------------------------------------------------------------------
+void
+TransferExecutor::SetError(int errcode, const std::string& msg)
+{
+  if (!mErrno) {
+    mErrno = (errcode ? errcode : EIO);
+    mErrorMsg = msg;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Completion of a request of a slot
+//------------------------------------------------------------------------------
+void
+TransferExecutor::Done(size_t slot, bool write,
+                       const XrdCl::XRootDStatus& status, uint32_t length)
+{
+  XrdSysCondVarHelper lock(mCond);
+  Slot& s = mSlots[slot];
+  mOutstanding--;
+
+  if (!status.IsOK()) {
+    SetError(status.errNo, (write ? "write failed: " : "read failed: ") +
+             status.ToString());
+    s.mState = kIdle;
+  } else if (write) {
+    mBytesCopied += s.mLength;
+    s.mState = kIdle;
+  } else if (length != s.mLength) {
+    char msg[128];
+    snprintf(msg, sizeof(msg), "short read at offset %llu: %u instead of %u bytes",
+             (unsigned long long) s.mOffset, length, s.mLength);
+    SetError(EIO, msg);
+    s.mState = kIdle;
+  } else {
+    s.mState = kRead;
+  }
+
+  mCond.Signal();
+}
+
+//------------------------------------------------------------------------------
+// Open the source and the target and allocate the buffers
+//------------------------------------------------------------------------------
+int
+TransferExecutor::Open()
+{
+  XrdCl::XRootDStatus status = mSourceFile.Open(mSource,
+                               XrdCl::OpenFlags::Read);
+
+  if (!status.IsOK()) {
+    SetError(status.errNo, "source open failed: " + status.ToString());
+    return mErrno;
+  }
+
+  XrdCl::StatInfo* info = 0;
+  status = mSourceFile.Stat(false, info);
+
+  if (!status.IsOK() || !info) {
+    SetError(status.errNo, "source stat failed: " + status.ToString());
+    delete info;
+    return mErrno;
+  }
+
+  mSize = info->GetSize();
+  delete info;
+  status = mTargetFile.Open(mTarget, XrdCl::OpenFlags::Delete |
+                            XrdCl::OpenFlags::Update,
+                            XrdCl::Access::UR | XrdCl::Access::UW |
+                            XrdCl::Access::GR);
+
+  if (!status.IsOK()) {
+    SetError(status.errNo, "target open failed: " + status.ToString());
+    return mErrno;
+  }
+
+  for (auto it = mSlots.begin(); it != mSlots.end(); ++it) {
+    if (!it->mBuffer && posix_memalign((void**) &it->mBuffer, 4096, mBufferSize)) {
+      it->mBuffer = 0;
+      SetError(ENOMEM, "failed to allocate the transfer buffers");
+      return mErrno;
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Close the files and verify the checksum
+//------------------------------------------------------------------------------
+int
+TransferExecutor::Close()
+{
+  bool corrupted = false;
+
+  if (mChecksum && !mErrno) {
+    mChecksum->Finalize();
+    mChecksumValue = mChecksum->GetHexChecksum();
+
+    if (mChecksumExpected.length() &&
+        (NormalizeHex(mChecksumExpected) != NormalizeHex(mChecksumValue))) {
+      SetError(EIO, "checksum mismatch: expected " + mChecksumExpected +
+               " computed " + mChecksumValue);
+      corrupted = true;
+    }
+  }
+
+  // An incomplete target is discarded by the FST on close since it doesn't
+  // match the size of the capability, a corrupted one has to be flagged
+  if (mTargetFile.IsOpen()) {
+    XrdCl::XRootDStatus status;
+
+    if (corrupted) {
+      XrdCl::Buffer arg;
+      XrdCl::Buffer* response = 0;
+      arg.FromString("delete");
+      status = mTargetFile.Fcntl(arg, response);
+      delete response;
+
+      if (!status.IsOK()) {
+        eos_static_err("failed to flag the target for deletion: %s",
+                       status.ToString().c_str());
+      }
+    }
+
+    status = mTargetFile.Close();
+
+    if (!status.IsOK()) {
+      SetError(status.errNo, "target close failed: " + status.ToString());
+    }
+  }
+
+  if (mSourceFile.IsOpen()) {
+    mSourceFile.Close();
+  }
+
+  return mErrno;
+}
+
+//------------------------------------------------------------------------------
+// Run the copy
+//------------------------------------------------------------------------------
+int
+TransferExecutor::Run()
+{
+  mStartMs = NowMs();
+  uint64_t deadline = (mTimeout ? mStartMs + 1000 * mTimeout : 0);
+
+  if (Open()) {
+    Close();
+    mStopMs = NowMs();
+    return mErrno;
+  }
+
+  uint64_t size = mSize;
+  uint64_t read_offset = 0;
+  uint64_t write_offset = 0;
+  XrdCl::XRootDStatus status;
+  mCond.Lock();
+
+  while (1) {
+    if (!mErrno) {
+      if (mCanceled) {
+        SetError(ECANCELED, "transfer canceled");
+      } else if (deadline && (NowMs() > deadline)) {
+        SetError(ETIMEDOUT, "transfer timed out");
+      }
+    }
+
+    if (mErrno) {
+      // Buffers can only be released once all requests have returned
+      if (!mOutstanding) {
+        break;
+      }
+
+      mCond.WaitMS(1000);
+      continue;
+    }
+
+    if ((write_offset >= size) && !mOutstanding) {
+      break;
+    }
+
+    bool issued = false;
+
+    // Write the buffers following the data written so far, in order
+    for (size_t i = 0; i < mSlots.size(); i++) {
+      Slot& s = mSlots[i];
+
+      if ((s.mState != kRead) || (s.mOffset != write_offset) || mErrno) {
+        continue;
+      }
+
+      s.mState = kWriting;
+      mOutstanding++;
+      write_offset += s.mLength;
+      issued = true;
+      mCond.UnLock();
+
+      if (mChecksum) {
+        mChecksum->Add(s.mBuffer, s.mLength, s.mOffset);
+      }
+
+      status = mTargetFile.Write(s.mOffset, s.mLength, s.mBuffer,
+                                 s.mWriteHandler);
+      mCond.Lock();
+
+      if (!status.IsOK()) {
+        mOutstanding--;
+        s.mState = kIdle;
+        SetError(status.errNo, "write failed: " + status.ToString());
+      }
+
+      // A following buffer may be complete already
+      i = (size_t) - 1;
+    }
+
+    // Refill the idle buffers
+    for (size_t i = 0; i < mSlots.size(); i++) {
+      Slot& s = mSlots[i];
+
+      if ((s.mState != kIdle) || (read_offset >= size) || mErrno) {
+        continue;
+      }
+
+      s.mOffset = read_offset;
+      s.mLength = (uint32_t)((size - read_offset < mBufferSize) ?
+                             (size - read_offset) : mBufferSize);
+      s.mState = kReading;
+      mOutstanding++;
+      read_offset += s.mLength;
+      issued = true;
+      mCond.UnLock();
+
+      if (mShaper) {
+        mShaper->Throttle(s.mLength);
+      }
+
+      status = mSourceFile.Read(s.mOffset, s.mLength, s.mBuffer,
+                                s.mReadHandler);
+      mCond.Lock();
+
+      if (!status.IsOK()) {
+        mOutstanding--;
+        s.mState = kIdle;
+        SetError(status.errNo, "read failed: " + status.ToString());
+      }
+    }
+
+    if (!issued) {
+      mCond.WaitMS(1000);
+    }
+  }
+
+  mCond.UnLock();
+  Close();
+  mStopMs = NowMs();
+
+  if (mErrno) {
+    eos_static_err("msg=\"transfer failed\" src=%s dst=%s errno=%d error=\"%s\"",
+                   mSource.substr(0, mSource.find('?')).c_str(),
+                   mTarget.substr(0, mTarget.find('?')).c_str(),
+                   mErrno, mErrorMsg.c_str());
+  }
+
+  return mErrno;
+}
+
+//------------------------------------------------------------------------------
+// Get a summary of the copy in the format of the eoscp transfer log
+//------------------------------------------------------------------------------
+std::string
+TransferExecutor::GetSummary() const
+{
+  char line[4096];
+  std::string out;
+  time_t now = time(NULL);
+  char stime[64];
+  ctime_r(&now, stime);
+  float seconds = (mStopMs > mStartMs ? (mStopMs - mStartMs) / 1000.0 : 0.0);
+  uint64_t copied = mBytesCopied;
+  out += "[eoscp] #################################################################\n";
+  snprintf(line, sizeof(line), "[eoscp] # Date                     : ( %lu ) %s",
+           (unsigned long) now, stime);
+  out += line;
+  snprintf(line, sizeof(line), "[eoscp] # Source Name [00]         : %s\n",
+           mSource.substr(0, mSource.find('?')).c_str());
+  out += line;
+  snprintf(line, sizeof(line), "[eoscp] # Destination Name [00]    : %s\n",
+           mTarget.substr(0, mTarget.find('?')).c_str());
+  out += line;
+  snprintf(line, sizeof(line), "[eoscp] # Data Copied [bytes]      : %llu\n",
+           (unsigned long long) copied);
+  out += line;
+  snprintf(line, sizeof(line), "[eoscp] # Realtime [s]             : %f\n",
+           seconds);
+  out += line;
+
+  if (seconds > 0) {
+    snprintf(line, sizeof(line), "[eoscp] # Eff.Copy. Rate[MB/s]     : %f\n",
+             copied / seconds / 1000000.0);
+    out += line;
+  }
+
+  if (mShaper && mShaper->GetRate()) {
+    snprintf(line, sizeof(line), "[eoscp] # Queue Bandwidth[MB/s]    : %llu\n",
+             (unsigned long long)(mShaper->GetRate() / 1000000));
+    out += line;
+  }
+
+  if (mChecksumValue.length()) {
+    snprintf(line, sizeof(line), "[eoscp] # Checksum Type %s        : %s\n",
+             mChecksumType.c_str(), mChecksumValue.c_str());
+    out += line;
+  }
+
+  snprintf(line, sizeof(line), "[eoscp] # In-process Buffers       : %u x %u\n",
+           (unsigned int) mSlots.size(), mBufferSize);
+  out += line;
+
+  if (mErrno) {
+    snprintf(line, sizeof(line), "error: %s (errno=%d)\n", mErrorMsg.c_str(),
+             mErrno);
+    out += line;
+  }
+
+  return out;
+}
+
+EOSFSTNAMESPACE_END
@@ -0,0 +1,240 @@
+// ----------------------------------------------------------------------
+// File: TransferExecutor.hh
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_TRANSFEREXECUTOR_HH__
+#define __EOSFST_TRANSFEREXECUTOR_HH__
+
+/*----------------------------------------------------------------------------*/
+#include "fst/Namespace.hh"
+#include "fst/txqueue/TransferShaper.hh"
+/*----------------------------------------------------------------------------*/
+#include "XrdCl/XrdClFile.hh"
+#include "XrdSys/XrdSysPthread.hh"
+/*----------------------------------------------------------------------------*/
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+class CheckSum;
+
+//------------------------------------------------------------------------------
+//! In-process copy of a file between two XRootD urls
+//!
+//! The source is read with asynchronous requests into a ring of fixed-size
+//! buffers, every buffer is written asynchronously to the target as soon as
+//! all the data before it has been written, so reads and writes of different
+//! buffers overlap. The writes are issued in order and the checksum of the
+//! data is computed while issuing them. Reads are throttled by the shaper of
+//! the transfer queue. Progress is available in memory for the reporting
+//! thread and the copy can be canceled from any thread.
+//------------------------------------------------------------------------------
+class TransferExecutor
+{
+public:
+  static const uint32_t sDefaultBuffers = 4;
+  static const uint32_t sDefaultBufferSize = 4 * 1024 * 1024;
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param source source url including the opaque information
+  //! @param target target url including the opaque information
+  //! @param shaper bandwidth limit shared with other transfers, can be 0
+  //! @param nbuffers number of buffers in flight
+  //! @param buffersize size of each buffer
+  //----------------------------------------------------------------------------
+  TransferExecutor(const std::string& source, const std::string& target,
+                   TransferShaper* shaper = 0,
+                   uint32_t nbuffers = sDefaultBuffers,
+                   uint32_t buffersize = sDefaultBufferSize);
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~TransferExecutor();
+
+  //----------------------------------------------------------------------------
+  //! Set the maximum duration of the copy in seconds, 0 means no limit
+  //----------------------------------------------------------------------------
+  void
+  SetTimeout(time_t timeout)
+  {
+    mTimeout = timeout;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Compute a checksum of the data copied
+  //!
+  //! @param type checksum name as in eos.layout.checksum (adler, crc32, ...)
+  //! @param expected hex value to verify after the copy, empty for none. On a
+  //!        mismatch the copy fails and the target is deleted.
+  //!
+  //! @return false if the checksum type is unknown
+  //----------------------------------------------------------------------------
+  bool SetChecksum(const std::string& type, const std::string& expected = "");
+
+  //----------------------------------------------------------------------------
+  //! Run the copy, returns when it is complete, failed or canceled
+  //!
+  //! @return 0 if successful, otherwise an errno value
+  //----------------------------------------------------------------------------
+  int Run();
+
+  //----------------------------------------------------------------------------
+  //! Abort a running copy, the target is closed incomplete
+  //----------------------------------------------------------------------------
+  void
+  Cancel()
+  {
+    mCanceled = true;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the progress in percent
+  //----------------------------------------------------------------------------
+  float GetProgress() const;
+
+  uint64_t
+  GetBytesCopied() const
+  {
+    return mBytesCopied;
+  }
+
+  uint64_t
+  GetSize() const
+  {
+    return mSize;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the checksum of the data copied in hex, empty if none configured
+  //----------------------------------------------------------------------------
+  const std::string&
+  GetChecksum() const
+  {
+    return mChecksumValue;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the error message of a failed copy
+  //----------------------------------------------------------------------------
+  const std::string&
+  GetError() const
+  {
+    return mErrorMsg;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get a summary of the copy in the format of the eoscp transfer log
+  //----------------------------------------------------------------------------
+  std::string GetSummary() const;
+
+private:
+  //! State of a buffer of the ring
+  enum SlotState { kIdle, kReading, kRead, kWriting };
+
+  //----------------------------------------------------------------------------
+  //! Response handler of the requests issued for one buffer
+  //----------------------------------------------------------------------------
+  class IoHandler : public XrdCl::ResponseHandler
+  {
+  public:
+    IoHandler(TransferExecutor* executor, size_t slot, bool write):
+      mExecutor(executor), mSlot(slot), mWrite(write) { }
+
+    virtual ~IoHandler() { }
+
+    virtual void HandleResponse(XrdCl::XRootDStatus* status,
+                                XrdCl::AnyObject* response);
+
+  private:
+    TransferExecutor* mExecutor;
+    size_t mSlot;
+    bool mWrite;
+  };
+
+  //! Buffer of the ring with its request handlers
+  struct Slot {
+    char* mBuffer;
+    uint64_t mOffset;
+    uint32_t mLength;
+    SlotState mState;
+    IoHandler* mReadHandler;
+    IoHandler* mWriteHandler;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Called by the handlers when a request of a slot completes
+  //!
+  //! @param slot index of the slot
+  //! @param write request was a write
+  //! @param status status of the request
+  //! @param length bytes returned by a read
+  //----------------------------------------------------------------------------
+  void Done(size_t slot, bool write, const XrdCl::XRootDStatus& status,
+            uint32_t length);
+
+  //----------------------------------------------------------------------------
+  //! Record the first error of the copy, mCond has to be locked
+  //----------------------------------------------------------------------------
+  void SetError(int errcode, const std::string& msg);
+
+  //----------------------------------------------------------------------------
+  //! Open the source and the target and allocate the buffers
+  //----------------------------------------------------------------------------
+  int Open();
+
+  //----------------------------------------------------------------------------
+  //! Close the files and verify the checksum
+  //----------------------------------------------------------------------------
+  int Close();
+
+  std::string mSource; ///< source url
+  std::string mTarget; ///< target url
+  TransferShaper* mShaper; ///< bandwidth limit of the queue
+  uint32_t mBufferSize; ///< size of each buffer
+  time_t mTimeout; ///< maximum duration of the copy
+  XrdCl::File mSourceFile;
+  XrdCl::File mTargetFile;
+  std::vector<Slot> mSlots; ///< ring of buffers
+  XrdSysCondVar mCond; ///< protects the slots, signaled on completions
+  size_t mOutstanding; ///< requests in flight
+  int mErrno; ///< first error of the copy
+  std::string mErrorMsg; ///< message of the first error
+  CheckSum* mChecksum; ///< checksum computed on the fly
+  std::string mChecksumType; ///< name of the checksum
+  std::string mChecksumExpected; ///< value to verify
+  std::string mChecksumValue; ///< value computed
+  std::atomic<bool> mCanceled;
+  std::atomic<uint64_t> mSize; ///< size of the source
+  std::atomic<uint64_t> mBytesCopied; ///< bytes written to the target
+  uint64_t mStartMs; ///< start of Run on the steady clock
+  std::atomic<uint64_t> mStopMs; ///< end of Run on the steady clock
+};
+
+EOSFSTNAMESPACE_END
+
+#endif
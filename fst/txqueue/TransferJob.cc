@@ -55,7 +55,7 @@ ToString(const T& t)
 }
 
 TransferJob::TransferJob(TransferQueue* queue, eos::common::TransferJob* job,
-                         int bw, int timeout)
+                         int bw, int timeout, bool inprocess)
 {
   mQueue = queue;
   mBandWidth = bw;
@@ -71,6 +71,8 @@ TransferJob::TransferJob(TransferQueue* queue, eos::common::TransferJob* job,
   mDoItThread = 0;
   mCanceled = false;
   mLastState = 0;
+  mInProcess = inprocess;
+  mExecutor = 0;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -85,6 +87,10 @@ TransferJob::~TransferJob()
     XrdSysThread::Join(mProgressThread, NULL);
     mProgressThread = 0;
   }
+
+  if (mExecutor) {
+    delete mExecutor;
+  }
 }
 
 /* ------------------------------------------------------------------------- */
@@ -103,33 +109,44 @@ TransferJob::Progress()
   while (1) {
     eos_static_debug("progress loop");
     float progress = 0;
-    // try to read the progress filename
+    bool found = false;
     XrdSysThread::SetCancelOff();
-    FILE* fd = fopen(mProgressFile.c_str(), "r");
-
-    if (fd) {
-      int item = fscanf(fd, "%f\n", &progress);
-      eos_static_debug("progress=%.02f", progress);
-
-      if (item == 1) {
-        if (fabs(mLastProgress - progress) > 1) {
-          // send only if there is a significant change
-          int rc = SendState(0, 0, progress);
-
-          if (rc == -EIDRM) {
-            eos_static_warning("job %lld has been canceled", mId);
-            // cancel this job !
-            mCancelMutex.Lock();
-            mCanceled = true;
-            mCancelMutex.UnLock();
-            return 0;
-          }
 
-          mLastProgress = progress;
+    if (mExecutor) {
+      // in-process transfers keep their progress in memory
+      progress = mExecutor->GetProgress();
+      found = true;
+    } else {
+      // try to read the progress filename
+      FILE* fd = fopen(mProgressFile.c_str(), "r");
+
+      if (fd) {
+        found = (fscanf(fd, "%f\n", &progress) == 1);
+        fclose(fd);
+      }
+    }
+
+    eos_static_debug("progress=%.02f", progress);
+
+    if (found && (fabs(mLastProgress - progress) > 1)) {
+      // send only if there is a significant change
+      int rc = SendState(0, 0, progress);
+
+      if (rc == -EIDRM) {
+        eos_static_warning("job %lld has been canceled", mId);
+        // cancel this job !
+        mCancelMutex.Lock();
+        mCanceled = true;
+        mCancelMutex.UnLock();
+
+        if (mExecutor) {
+          mExecutor->Cancel();
         }
+
+        return 0;
       }
 
-      fclose(fd);
+      mLastProgress = progress;
     }
 
     XrdSysThread::SetCancelOn();
@@ -213,7 +230,8 @@ TransferJob::GetTargetUrl()
 
 /* ------------------------------------------------------------------------- */
 int
-TransferJob::SendState(int state, const char* logfile, float progress)
+TransferJob::SendState(int state, const char* logfile, float progress,
+                       const char* logtext)
 {
   XrdSysMutexHelper lock(SendMutex);
   // assemble the opaque tags to be send to the manager
@@ -237,10 +255,16 @@ TransferJob::SendState(int state, const char* logfile, float progress)
     eos_static_info("txid=%lld state=%s", mId,
                     eos::mgm::TransferEngine::GetTransferState(state));
 
-    if (logfile) {
+    if (logfile || logtext) {
       XrdOucString loginfob64 = "";
       std::string loginfo;
-      eos::common::StringConversion::LoadFileIntoString(logfile, loginfo);
+
+      if (logtext) {
+        loginfo = logtext;
+      } else {
+        eos::common::StringConversion::LoadFileIntoString(logfile, loginfo);
+      }
+
       eos::common::SymKey::Base64Encode((char*) loginfo.c_str(), loginfo.length(),
                                         loginfob64);
 
@@ -449,6 +473,17 @@ TransferJob::DoIt()
     }
   }
 
+  if (mInProcess && mSource.beginswith("root://") &&
+      mDestination.beginswith("root://") && !isReco && !iskrb5 && !isgsi &&
+      !noauth) {
+    // plain XRootD copy with the identity of the FST, no need for a script
+    RunInProcess(mSource, mDestination, eoscpLogMutex);
+    unlink(fileCredential.c_str());
+    mQueue->DecRunning();
+    delete this;
+    return;
+  }
+
   if (mDestination.beginswith("root://")  || (mDestination == "/dev/null")) {
     // RAIN reconstruction uses /dev/null as eoscp-target !
     if ((mSource.beginswith("as3://")) ||
@@ -1056,4 +1091,55 @@ cleanup:
   delete this;
 }
 
+/* ------------------------------------------------------------------------- */
+void
+TransferJob::RunInProcess(const XrdOucString& source,
+                          const XrdOucString& target, XrdSysMutex& logmutex)
+{
+  mExecutor = new TransferExecutor(source.c_str(), target.c_str(),
+                                   mQueue->GetShaper());
+  mExecutor->SetTimeout(mTimeOut);
+  // drain and balance jobs carry the checksum of the namespace, it is
+  // computed on the fly and the transfer fails on a mismatch
+  const char* xstype = mJob->GetEnv()->Get("tx.checksum");
+  const char* xsvalue = mJob->GetEnv()->Get("tx.checksum.value");
+
+  if (xstype && !mExecutor->SetChecksum(xstype, xsvalue ? xsvalue : "")) {
+    eos_static_warning("txid=%lld unknown checksum type %s", mId, xstype);
+  }
+
+  if (mId) {
+    SendState(eos::mgm::TransferEngine::kRunning);
+    // start the progress thread
+    XrdSysThread::Run(&mProgressThread, TransferJob::StaticProgress,
+                      static_cast<void*>(this), XRDSYSTHREAD_HOLD,
+                      "Progress Report Thread");
+  }
+
+  int rc = mExecutor->Run();
+  std::string summary = mExecutor->GetSummary();
+
+  if (rc) {
+    eos_static_err("txid=%lld in-process transfer failed errno=%d error=\"%s\"",
+                   mId, rc, mExecutor->GetError().c_str());
+  }
+
+  if (mId) {
+    SendState(rc ? eos::mgm::TransferEngine::kFailed :
+              eos::mgm::TransferEngine::kDone, 0, 0.0, summary.c_str());
+  }
+
+  // append the summary to the eoscp log file
+  XrdSysMutexHelper lock(logmutex);
+  FILE* fout = fopen(gOFS.eoscpTransferLog.c_str(), "a+");
+
+  if (fout) {
+    fputs(summary.c_str(), fout);
+    fclose(fout);
+  } else {
+    eos_static_err("failed to append to eoscp log file %s",
+                   gOFS.eoscpTransferLog.c_str());
+  }
+}
+
 EOSFSTNAMESPACE_END
@@ -27,6 +27,7 @@
 /* ------------------------------------------------------------------------- */
 #include "fst/Namespace.hh"
 #include "fst/txqueue/TransferQueue.hh"
+#include "fst/txqueue/TransferExecutor.hh"
 #include "common/TransferJob.hh"
 /* ------------------------------------------------------------------------ */
 #include "Xrd/XrdJob.hh"
@@ -57,10 +58,19 @@ private:
   pthread_t mDoItThread; // the id of the thread running the DoIt function
   XrdSysMutex mCancelMutex; // protects the canceled variable
   bool mCanceled; // this indicates that the thread should
-  
+  bool mInProcess; // root:// to root:// transfers don't fork eoscp
+  TransferExecutor* mExecutor; // the executor of an in-process transfer
+
+  //----------------------------------------------------------------------------
+  //! Run the transfer with a TransferExecutor inside of the FST process and
+  //! append its summary to the eoscp transfer log
+  //----------------------------------------------------------------------------
+  void RunInProcess (const XrdOucString& source, const XrdOucString& target,
+                     XrdSysMutex& logmutex);
+
 public:
 
-  TransferJob (TransferQueue* queue, eos::common::TransferJob* cjob, int bw, int timeout = 7200);
+  TransferJob (TransferQueue* queue, eos::common::TransferJob* cjob, int bw, int timeout = 7200, bool inprocess = false);
   ~TransferJob ();
 
   void DoIt ();
@@ -71,7 +81,7 @@ public:
 
   XrdSysMutex SendMutex; // protecting the send state function against paralle usage
 
-  int SendState (int state, const char* logfile = 0, float progress = 0.0);
+  int SendState (int state, const char* logfile = 0, float progress = 0.0, const char* logtext = 0);
 
   static void* StaticProgress (void*);
   void* Progress ();
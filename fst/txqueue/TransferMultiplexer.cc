@@ -25,6 +25,8 @@
 #include "fst/XrdFstOfs.hh"
 #include "common/Logging.hh"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 EOSFSTNAMESPACE_BEGIN
 
@@ -32,8 +34,14 @@ EOSFSTNAMESPACE_BEGIN
 // Constructor
 //------------------------------------------------------------------------------
 TransferMultiplexer::TransferMultiplexer():
-  mTid(0)
-{}
+  mTid(0), mInProcess(true)
+{
+  const char* ptr = getenv("EOS_FST_TX_USE_EOSCP");
+
+  if (ptr && (strcmp(ptr, "1") == 0)) {
+    mInProcess = false;
+  }
+}
 
 //------------------------------------------------------------------------------
 // Destructor
@@ -158,7 +166,8 @@ TransferMultiplexer::ThreadProc(void)
           eos_static_info("New transfer %s", out.c_str());
           //create new TransferJob and submit it to the scheduler
           TransferJob* job = new TransferJob(mQueues[i], cjob,
-                                             mQueues[i]->GetBandwidth());
+                                             mQueues[i]->GetBandwidth(), 7200,
+                                             mInProcess);
           gOFS.TransferSchedulerMutex.Lock();
           gOFS.TransferScheduler->Schedule(job);
           gOFS.TransferSchedulerMutex.UnLock();
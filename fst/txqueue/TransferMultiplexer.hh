@@ -94,6 +94,9 @@ private:
   eos::common::RWMutex mMutex;
   std::vector<TransferQueue*> mQueues;
   pthread_t mTid;
+  //! Run root:// to root:// transfers in-process instead of forking eoscp,
+  //! disabled by setting EOS_FST_TX_USE_EOSCP=1
+  bool mInProcess;
 };
 
 EOSFSTNAMESPACE_END
@@ -42,6 +42,7 @@ TransferQueue::TransferQueue (eos::common::TransferQueue** queue, const char* na
   nslots = slots;
   bandwidth = band;
   mJobEndCallback = 0;
+  UpdateShaper();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -63,8 +64,11 @@ TransferQueue::GetBandwidth ()
 void
 TransferQueue::SetBandwidth (size_t band)
 {
-  XrdSysMutexHelper(mBandwidthMutex);
-  bandwidth = band;
+  {
+    XrdSysMutexHelper(mBandwidthMutex);
+    bandwidth = band;
+  }
+  UpdateShaper();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -83,7 +87,18 @@ TransferQueue::GetSlots ()
 void
 TransferQueue::SetSlots (size_t slots)
 {
-  XrdSysMutexHelper(mSlotsMutex);
-  nslots = slots;
+  {
+    XrdSysMutexHelper(mSlotsMutex);
+    nslots = slots;
+  }
+  UpdateShaper();
+}
+
+/* ------------------------------------------------------------------------- */
+void
+TransferQueue::UpdateShaper ()
+{
+  // the bandwidth is configured in MB/s per transfer
+  mShaper.SetRate((uint64_t) GetBandwidth() * GetSlots() * 1000000);
 }
 EOSFSTNAMESPACE_END
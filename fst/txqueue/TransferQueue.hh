@@ -27,6 +27,7 @@
 /* ------------------------------------------------------------------------- */
 #include "fst/Namespace.hh"
 #include "common/TransferQueue.hh"
+#include "fst/txqueue/TransferShaper.hh"
 /* ------------------------------------------------------------------------- */
 #include "Xrd/XrdScheduler.hh"
 /* ------------------------------------------------------------------------- */
@@ -59,6 +60,11 @@ private:
   XrdSysCondVar mJobTerminateCondition;
   XrdSysCondVar* mJobEndCallback;
 
+  //! Aggregated bandwidth of the in-process transfers: bandwidth x slots
+  TransferShaper mShaper;
+
+  void UpdateShaper ();
+
 public:
 
   TransferQueue (eos::common::TransferQueue** queue, const char* name, int slots = 2, int band = 100);
@@ -82,6 +88,12 @@ public:
   size_t GetBandwidth ();
   void SetBandwidth (size_t band);
 
+  TransferShaper*
+  GetShaper ()
+  {
+    return &mShaper;
+  }
+
   void
   SetJobEndCallback (XrdSysCondVar* cvar)
   {
@@ -0,0 +1,111 @@
+// ----------------------------------------------------------------------
+// File: TransferShaper.hh
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSFST_TRANSFERSHAPER_HH__
+#define __EOSFST_TRANSFERSHAPER_HH__
+
+/*----------------------------------------------------------------------------*/
+#include "fst/Namespace.hh"
+/*----------------------------------------------------------------------------*/
+#include "XrdSys/XrdSysPthread.hh"
+/*----------------------------------------------------------------------------*/
+#include <chrono>
+#include <stdint.h>
+#include <unistd.h>
+/*----------------------------------------------------------------------------*/
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Bandwidth limit shared by all the transfers of a queue
+//!
+//! Every transfer reserves the bytes it is about to read, the reservation is
+//! scheduled after the ones of all the other transfers at the configured rate
+//! and the caller sleeps until its turn. Unused bandwidth is not accumulated,
+//! so an idle queue can't burst above the rate afterwards.
+//------------------------------------------------------------------------------
+class TransferShaper
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param rate bytes per second, 0 means unlimited
+  //----------------------------------------------------------------------------
+  TransferShaper(uint64_t rate = 0): mRate(rate), mNext(0) { }
+
+  //----------------------------------------------------------------------------
+  //! Change the rate in bytes per second, 0 means unlimited
+  //----------------------------------------------------------------------------
+  void
+  SetRate(uint64_t rate)
+  {
+    XrdSysMutexHelper lock(mMutex);
+    mRate = rate;
+  }
+
+  uint64_t
+  GetRate()
+  {
+    XrdSysMutexHelper lock(mMutex);
+    return mRate;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Reserve bytes of bandwidth, sleeps until the reservation is due
+  //----------------------------------------------------------------------------
+  void
+  Throttle(uint64_t bytes)
+  {
+    uint64_t wait = 0;
+    {
+      XrdSysMutexHelper lock(mMutex);
+
+      if (!mRate) {
+        return;
+      }
+
+      uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>
+                     (std::chrono::steady_clock::now().time_since_epoch()).count();
+
+      if (mNext < now) {
+        mNext = now;
+      }
+
+      wait = mNext - now;
+      mNext += (bytes * 1000000) / mRate;
+    }
+
+    if (wait) {
+      usleep(wait);
+    }
+  }
+
+private:
+  XrdSysMutex mMutex;
+  uint64_t mRate; ///< bytes per second
+  uint64_t mNext; ///< time in us at which the next reservation starts
+};
+
+EOSFSTNAMESPACE_END
+
+#endif
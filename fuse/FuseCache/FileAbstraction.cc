@@ -36,6 +36,7 @@
 FileAbstraction::FileAbstraction(const char* path) :
   mMutexRW(),
   mFd(-1),
+  mInode(0),
   mFileRW(NULL),
   mFileRO(NULL),
   mNoReferencesRW(0),
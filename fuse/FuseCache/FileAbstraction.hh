@@ -108,6 +108,23 @@ public:
   };
 
 
+  //--------------------------------------------------------------------------
+  //! Get inode value
+  //--------------------------------------------------------------------------
+  inline unsigned long long GetInode() const
+  {
+    return mInode;
+  };
+
+  //--------------------------------------------------------------------------
+  //! Set inode value
+  //--------------------------------------------------------------------------
+  inline void SetInode(unsigned long long inode)
+  {
+    mInode = inode;
+  };
+
+
   //--------------------------------------------------------------------------
   //! Get undelying raw file object
   //--------------------------------------------------------------------------
@@ -292,6 +309,7 @@ public:
 
 private:
   int mFd; ///< file descriptor used for the block key range
+  unsigned long long mInode; ///< inode of the file, keys the read cache
   LayoutWrapper* mFileRW; ///< raw file object for RW access
   LayoutWrapper* mFileRO; ///< raw file object for RO access
   int mNoReferencesRW; ///< number of held referencess to this file in RW
@@ -0,0 +1,395 @@
+//------------------------------------------------------------------------------
+// File: FuseReadCache.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+//------------------------------------------------------------------------------
+#include "FuseReadCache.hh"
+#include "FuseWriteCache.hh"
+//------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+FuseReadCache::FuseReadCache(size_t sizeMax,
+                             size_t pageSize,
+                             size_t maxPrefetch,
+                             FuseWriteCache* writeCache) :
+  eos::common::LogId(),
+  mCacheSizeMax(sizeMax),
+  mPageSize(pageSize ? pageSize : 128 * 1024),
+  mMaxPrefetch(maxPrefetch),
+  mWriteCache(writeCache),
+  mGeneration(0)
+{
+  memset(&mStats, 0, sizeof(mStats));
+}
+
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+FuseReadCache::~FuseReadCache()
+{
+  XrdSysMutexHelper lock(mMutex);
+
+  while (!mInodes.empty()) {
+    DropInode(mInodes.begin());
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Read through the cache
+//------------------------------------------------------------------------------
+ssize_t
+FuseReadCache::Read(unsigned long long inode,
+                    char* buf,
+                    off_t off,
+                    size_t len,
+                    const fetch_t& fetch)
+{
+  size_t done = 0;
+  bool eof = false;
+  bool failed = false;
+
+  if (!len) {
+    return 0;
+  }
+
+  {
+    // Reads continuing where the previous one ended double the prefetch
+    XrdSysMutexHelper lock(mMutex);
+    InodeEntry& entry = GetEntry(inode);
+
+    if (off == entry.mNextOffset) {
+      entry.mPrefetch = std::min(entry.mPrefetch ? 2 * entry.mPrefetch : 1,
+                                 mMaxPrefetch);
+    } else {
+      entry.mPrefetch = 0;
+    }
+
+    entry.mNextOffset = off + len;
+  }
+
+  off_t last = (off + len - 1) / mPageSize;
+
+  while ((done < len) && !eof) {
+    off_t pos = off + done;
+    off_t index = pos / mPageSize;
+    size_t pageoff = pos % mPageSize;
+    size_t npages = 1;
+    size_t nprefetch = 0;
+    uint64_t generation = 0;
+    std::shared_ptr<char> hit;
+    size_t hitsize = 0;
+    {
+      XrdSysMutexHelper lock(mMutex);
+      InodeEntry& entry = GetEntry(inode);
+      auto it = entry.mPages.find(index);
+
+      if (it != entry.mPages.end()) {
+        hit = it->second->mData;
+        hitsize = it->second->mSize;
+        mLru.splice(mLru.end(), mLru, it->second->mLru);
+        mStats.mHits++;
+      } else {
+        // Fetch all the missing pages up to the next cached one in one go
+        while ((index + (off_t) npages <= last) &&
+               !entry.mPages.count(index + npages)) {
+          npages++;
+        }
+
+        if (index + (off_t) npages > last) {
+          nprefetch = entry.mPrefetch;
+        }
+
+        generation = entry.mGeneration;
+      }
+    }
+
+    if (hit) {
+      // the page stays valid outside of the lock even if it is evicted
+      size_t avail = (hitsize > pageoff) ? hitsize - pageoff : 0;
+      size_t ncopy = std::min(avail, len - done);
+      memcpy(buf + done, hit.get() + pageoff, ncopy);
+      done += ncopy;
+      eof = (hitsize < mPageSize);
+      continue;
+    }
+
+    size_t nfetch = (npages + nprefetch) * mPageSize;
+    // the fetch buffer only lives for this read, the cache keeps copies
+    std::unique_ptr<char[]> block(new char[nfetch]);
+    ssize_t nread = fetch(block.get(), index * mPageSize, nfetch);
+
+    if (nread < 0) {
+      eos_static_err("failed read ino=%llu off=%lld len=%lu", inode,
+                     (long long) index * mPageSize, (unsigned long) nfetch);
+      failed = true;
+      break;
+    }
+
+    {
+      XrdSysMutexHelper lock(mMutex);
+      mStats.mFetches++;
+      mStats.mMisses += npages;
+      AddPages(inode, generation, index, block.get(), nread, npages);
+    }
+    size_t avail = ((size_t) nread > pageoff) ? nread - pageoff : 0;
+    size_t ncopy = std::min(avail, len - done);
+    memcpy(buf + done, block.get() + pageoff, ncopy);
+    done += ncopy;
+    eof = ((size_t) nread < nfetch);
+  }
+
+  {
+    // Don't keep entries of reads which didn't cache anything
+    XrdSysMutexHelper lock(mMutex);
+    auto it = mInodes.find(inode);
+
+    if ((it != mInodes.end()) && it->second.mPages.empty()) {
+      mInodes.erase(it);
+    }
+  }
+
+  if (failed && !done) {
+    return -1;
+  }
+
+  return done;
+}
+
+
+//------------------------------------------------------------------------------
+// Check the cached pages of an inode against a fresh stat
+//------------------------------------------------------------------------------
+void
+FuseReadCache::Validate(unsigned long long inode, off_t size,
+                        const struct timespec& mtime)
+{
+  XrdSysMutexHelper lock(mMutex);
+  auto it = mInodes.find(inode);
+
+  if (it == mInodes.end()) {
+    return;
+  }
+
+  InodeEntry& entry = it->second;
+
+  if (entry.mValid) {
+    if ((entry.mSize == size) && (entry.mMtime.tv_sec == mtime.tv_sec) &&
+        (entry.mMtime.tv_nsec == mtime.tv_nsec)) {
+      return;
+    }
+  } else if (mtime.tv_sec + 1 < entry.mCreated) {
+    // First stat since the pages were fetched, they are valid unless the file
+    // was modified after the first of them was read
+    entry.mValid = true;
+    entry.mSize = size;
+    entry.mMtime = mtime;
+    return;
+  }
+
+  eos_static_debug("ino=%llu changed size=%lld mtime=%lu.%lu", inode,
+                   (long long) size, (unsigned long) mtime.tv_sec,
+                   (unsigned long) mtime.tv_nsec);
+  DropInode(it);
+}
+
+
+//------------------------------------------------------------------------------
+// Drop the cached pages of an inode
+//------------------------------------------------------------------------------
+void
+FuseReadCache::Invalidate(unsigned long long inode)
+{
+  XrdSysMutexHelper lock(mMutex);
+  auto it = mInodes.find(inode);
+
+  if (it != mInodes.end()) {
+    DropInode(it);
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Evict pages until the cache fits in the budget
+//------------------------------------------------------------------------------
+void
+FuseReadCache::Trim()
+{
+  XrdSysMutexHelper lock(mMutex);
+  Evict(0);
+}
+
+
+//------------------------------------------------------------------------------
+// Get a snapshot of the counters
+//------------------------------------------------------------------------------
+FuseReadCache::Stats
+FuseReadCache::GetStats()
+{
+  XrdSysMutexHelper lock(mMutex);
+  Stats stats = mStats;
+  stats.mInodes = mInodes.size();
+  return stats;
+}
+
+
+//------------------------------------------------------------------------------
+// Get the entry of an inode
+//------------------------------------------------------------------------------
+FuseReadCache::InodeEntry&
+FuseReadCache::GetEntry(unsigned long long inode)
+{
+  auto it = mInodes.find(inode);
+
+  if (it == mInodes.end()) {
+    InodeEntry entry;
+    entry.mValid = false;
+    entry.mSize = 0;
+    entry.mMtime.tv_sec = entry.mMtime.tv_nsec = 0;
+    entry.mCreated = time(NULL);
+    entry.mGeneration = ++mGeneration;
+    entry.mNextOffset = -1;
+    entry.mPrefetch = 0;
+    it = mInodes.insert(std::make_pair(inode, entry)).first;
+  }
+
+  return it->second;
+}
+
+
+//------------------------------------------------------------------------------
+// Store the pages of a remote read
+//------------------------------------------------------------------------------
+void
+FuseReadCache::AddPages(unsigned long long inode, uint64_t generation,
+                        off_t index, const char* block,
+                        size_t len, size_t nrequested)
+{
+  // Make room first, the eviction can remove the entry of the inode
+  if (!Evict(len)) {
+    return;
+  }
+
+  auto it = mInodes.find(inode);
+
+  if ((it == mInodes.end()) || (it->second.mGeneration != generation)) {
+    // the pages were dropped while reading, the data may be stale
+    return;
+  }
+
+  InodeEntry& entry = it->second;
+
+  for (size_t i = 0; i * mPageSize < len; i++) {
+    if (entry.mPages.count(index + i)) {
+      continue;
+    }
+
+    Page* page = new Page();
+    page->mInode = inode;
+    page->mIndex = index + i;
+    page->mSize = std::min(mPageSize, len - i * mPageSize);
+    page->mData.reset(new char[page->mSize], std::default_delete<char[]>());
+    memcpy(page->mData.get(), block + i * mPageSize, page->mSize);
+    page->mLru = mLru.insert(mLru.end(), page);
+    entry.mPages[page->mIndex] = page;
+    mStats.mSize += page->mSize;
+    mStats.mPages++;
+
+    if (i >= nrequested) {
+      mStats.mPrefetched++;
+    }
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Remove a page
+//------------------------------------------------------------------------------
+bool
+FuseReadCache::RemovePage(Page* page)
+{
+  auto it = mInodes.find(page->mInode);
+  bool removed = false;
+
+  if (it != mInodes.end()) {
+    it->second.mPages.erase(page->mIndex);
+
+    if (it->second.mPages.empty()) {
+      mInodes.erase(it);
+      removed = true;
+    }
+  }
+
+  mLru.erase(page->mLru);
+  mStats.mSize -= page->mSize;
+  mStats.mPages--;
+  delete page;
+  return removed;
+}
+
+
+//------------------------------------------------------------------------------
+// Drop an inode with all its pages
+//------------------------------------------------------------------------------
+void
+FuseReadCache::DropInode(std::map<unsigned long long, InodeEntry>::iterator it)
+{
+  for (auto pit = it->second.mPages.begin(); pit != it->second.mPages.end();
+       ++pit) {
+    Page* page = pit->second;
+    mLru.erase(page->mLru);
+    mStats.mSize -= page->mSize;
+    mStats.mPages--;
+    mStats.mInvalidated++;
+    delete page;
+  }
+
+  mInodes.erase(it);
+}
+
+
+//------------------------------------------------------------------------------
+// Evict least recently used pages
+//------------------------------------------------------------------------------
+bool
+FuseReadCache::Evict(size_t size)
+{
+  size_t budget = mCacheSizeMax;
+
+  if (mWriteCache) {
+    size_t wsize = mWriteCache->GetAllocSize();
+    budget = (wsize < budget) ? budget - wsize : 0;
+  }
+
+  while (!mLru.empty() && (mStats.mSize + size > budget)) {
+    RemovePage(mLru.front());
+    mStats.mEvicted++;
+  }
+
+  return (mStats.mSize + size <= budget);
+}
@@ -0,0 +1,241 @@
+//------------------------------------------------------------------------------
+// File: FuseReadCache.hh
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOS_FUSE_FUSEREADCACHE_HH__
+#define __EOS_FUSE_FUSEREADCACHE_HH__
+
+//------------------------------------------------------------------------------
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+//------------------------------------------------------------------------------
+#include <XrdSys/XrdSysPthread.hh>
+#include "common/Logging.hh"
+//------------------------------------------------------------------------------
+
+//! Forward declaration
+class FuseWriteCache;
+
+//------------------------------------------------------------------------------
+//! Class implementing a cache of fixed-size pages of the files read through
+//! the mount, shared by all the processes reading the same inode.
+//!
+//! The pages of an inode are dropped when a stat reports a different size or
+//! modification time, or when the file is modified through this client. The
+//! least recently used pages are evicted once the memory budget, which is
+//! shared with the write cache, is exhausted. Misses of a sequential reader
+//! fetch a growing number of pages following the request.
+//------------------------------------------------------------------------------
+class FuseReadCache: public eos::common::LogId
+{
+public:
+
+  //! Function reading len bytes at offset off from the remote file into buf,
+  //! returns the number of bytes read or -1 on error
+  typedef std::function<ssize_t(char* buf, off_t off, size_t len)> fetch_t;
+
+  //----------------------------------------------------------------------------
+  //! Counters of the cache
+  //----------------------------------------------------------------------------
+  struct Stats {
+    uint64_t mHits; ///< pages served from the cache
+    uint64_t mMisses; ///< pages fetched for a read request
+    uint64_t mPrefetched; ///< pages fetched ahead of a sequential reader
+    uint64_t mFetches; ///< remote reads
+    uint64_t mEvicted; ///< pages evicted to make room
+    uint64_t mInvalidated; ///< pages dropped because the file changed
+    uint64_t mSize; ///< bytes in the cache
+    uint64_t mPages; ///< pages in the cache
+    uint64_t mInodes; ///< inodes with pages in the cache
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param sizeMax memory budget shared with the write cache
+  //! @param pageSize size of a page
+  //! @param maxPrefetch maximum number of pages fetched ahead
+  //! @param writeCache write cache sharing the budget, can be 0
+  //!
+  //----------------------------------------------------------------------------
+  FuseReadCache(size_t sizeMax,
+                size_t pageSize = 128 * 1024,
+                size_t maxPrefetch = 16,
+                FuseWriteCache* writeCache = 0);
+
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~FuseReadCache();
+
+
+  //----------------------------------------------------------------------------
+  //! Read through the cache
+  //!
+  //! @param inode inode of the file
+  //! @param buf buffer receiving the data
+  //! @param off offset
+  //! @param len length
+  //! @param fetch function reading the missing pages from the file
+  //!
+  //! @return number of bytes read, less than len at the end of the file, or
+  //!         -1 if nothing could be read
+  //!
+  //----------------------------------------------------------------------------
+  ssize_t Read(unsigned long long inode,
+               char* buf,
+               off_t off,
+               size_t len,
+               const fetch_t& fetch);
+
+
+  //----------------------------------------------------------------------------
+  //! Check the cached pages of an inode against a fresh stat, the pages are
+  //! dropped if size or modification time changed
+  //!
+  //! @param inode inode of the file
+  //! @param size size reported by the stat
+  //! @param mtime modification time reported by the stat
+  //!
+  //----------------------------------------------------------------------------
+  void Validate(unsigned long long inode, off_t size,
+                const struct timespec& mtime);
+
+
+  //----------------------------------------------------------------------------
+  //! Drop the cached pages of an inode
+  //----------------------------------------------------------------------------
+  void Invalidate(unsigned long long inode);
+
+
+  //----------------------------------------------------------------------------
+  //! Evict pages until the cache fits in what the write cache left of the
+  //! budget
+  //----------------------------------------------------------------------------
+  void Trim();
+
+
+  //----------------------------------------------------------------------------
+  //! Get a snapshot of the counters
+  //----------------------------------------------------------------------------
+  Stats GetStats();
+
+
+  //----------------------------------------------------------------------------
+  //! Get the page size
+  //----------------------------------------------------------------------------
+  inline size_t GetPageSize() const
+  {
+    return mPageSize;
+  }
+
+private:
+
+  struct Page;
+
+  //! Cached state of an inode
+  struct InodeEntry {
+    std::map<off_t, Page*> mPages; ///< pages by index
+    bool mValid; ///< size and mtime have been recorded
+    off_t mSize; ///< size at the last validation
+    struct timespec mMtime; ///< modification time at the last validation
+    time_t mCreated; ///< time of the first read of the entry
+    uint64_t mGeneration; ///< unique per entry, stale reads are not stored
+    off_t mNextOffset; ///< end of the last read, to detect sequential reads
+    size_t mPrefetch; ///< number of pages fetched ahead of the next miss
+  };
+
+  //! Page of an inode
+  struct Page {
+    unsigned long long mInode; ///< inode of the page
+    off_t mIndex; ///< offset of the page divided by the page size
+    //! data of the page, shared with the readers copying from it outside of
+    //! the lock so that it survives an eviction meanwhile
+    std::shared_ptr<char> mData;
+    size_t mSize; ///< size, shorter than a page at the end of the file
+    std::list<Page*>::iterator mLru; ///< position in the LRU list
+  };
+
+  //----------------------------------------------------------------------------
+  //! Get the entry of an inode, created if needed, mMutex has to be locked
+  //----------------------------------------------------------------------------
+  InodeEntry& GetEntry(unsigned long long inode);
+
+
+  //----------------------------------------------------------------------------
+  //! Store the pages of a remote read, mMutex has to be locked. Every page
+  //! is copied into its own buffer so that the memory held by the cache is
+  //! the accounted one.
+  //!
+  //! @param inode inode of the file
+  //! @param generation generation of the inode when the read was issued
+  //! @param index index of the first page
+  //! @param block data read
+  //! @param len number of bytes read
+  //! @param nrequested number of pages belonging to the read request
+  //!
+  //----------------------------------------------------------------------------
+  void AddPages(unsigned long long inode, uint64_t generation, off_t index,
+                const char* block, size_t len, size_t nrequested);
+
+
+  //----------------------------------------------------------------------------
+  //! Remove a page, mMutex has to be locked
+  //!
+  //! @return true if the inode has no more pages and was removed as well
+  //!
+  //----------------------------------------------------------------------------
+  bool RemovePage(Page* page);
+
+
+  //----------------------------------------------------------------------------
+  //! Drop an inode with all its pages, mMutex has to be locked
+  //----------------------------------------------------------------------------
+  void DropInode(std::map<unsigned long long, InodeEntry>::iterator it);
+
+
+  //----------------------------------------------------------------------------
+  //! Evict least recently used pages until size more bytes fit in the budget,
+  //! mMutex has to be locked
+  //!
+  //! @return false if size bytes don't fit even in an empty cache
+  //!
+  //----------------------------------------------------------------------------
+  bool Evict(size_t size);
+
+  size_t mCacheSizeMax; ///< budget shared with the write cache
+  size_t mPageSize; ///< size of a page
+  size_t mMaxPrefetch; ///< maximum number of pages fetched ahead
+  FuseWriteCache* mWriteCache; ///< write cache sharing the budget
+  XrdSysMutex mMutex; ///< protects the maps, the LRU list and the counters
+  std::map<unsigned long long, InodeEntry> mInodes; ///< cached inodes
+  std::list<Page*> mLru; ///< pages, least recently used first
+  uint64_t mGeneration; ///< last generation given to an entry
+  Stats mStats; ///< counters
+};
+
+#endif // __EOS_FUSE_FUSEREADCACHE_HH__
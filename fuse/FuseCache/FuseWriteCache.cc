@@ -319,3 +319,14 @@ FuseWriteCache::ForceAllWrites(FileAbstraction* fabst, bool wait)
     fabst->WaitFinishWrites();
   }
 }
+
+
+//------------------------------------------------------------------------------
+// Get the memory allocated for write blocks
+//------------------------------------------------------------------------------
+size_t
+FuseWriteCache::GetAllocSize()
+{
+  XrdSysMutexHelper lock(mMutexSize);
+  return mAllocSize;
+}
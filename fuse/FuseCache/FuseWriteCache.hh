@@ -84,6 +84,13 @@ class FuseWriteCache: public eos::common::LogId
   //----------------------------------------------------------------------------
   void ForceAllWrites(FileAbstraction* fabst, bool wait = true);
 
+
+  //----------------------------------------------------------------------------
+  //! Get the memory allocated for write blocks, it is never released and is
+  //! taken from the budget of the read cache
+  //----------------------------------------------------------------------------
+  size_t GetAllocSize();
+
  private:
 
   //----------------------------------------------------------------------------
@@ -48,6 +48,7 @@
 #include "XrdCl/XrdClXRootDResponses.hh"
 #include "MacOSXHelper.hh"
 #include "FuseCache/CacheEntry.hh"
+#include "common/InodeDirList.hh"
 #include "common/XrdErrorMap.hh"
 #include "filesystem.hh"
 #include "xrdutils.hh"
@@ -69,6 +70,7 @@ filesystem::filesystem()
   lazy_open_rw = false;
   async_open = false;
   lazy_open_disabled = false;
+  binary_dirlist = false;
   delayed_close_ms = 0;
   hide_special_files = true;
   show_eos_attributes = false;
@@ -81,6 +83,7 @@ filesystem::filesystem()
   max_wb_in_memory_size = 512 * 1024 * 1024;
   base_fd = 1;
   XFC = 0;
+  XRC = 0;
 }
 
 filesystem::~filesystem()
@@ -179,6 +182,26 @@ filesystem::CacheCleanup(void* p)
                       "MB out-max-size=%.02f MB nominal-max-size=%.02f MB",
                       totalsize_before / 1000000., totalsize_after / 1000000.0,
                       totalsize_clean / 1000000.0, me->max_wb_in_memory_size / 1000000.0);
+
+    if (me->XRC) {
+      // give back what the write cache took from the shared budget
+      me->XRC->Trim();
+      FuseReadCache::Stats rstats = me->XRC->GetStats();
+      uint64_t naccess = rstats.mHits + rstats.mMisses;
+      eos_static_notice("read cache size=%.02f MB pages=%llu inodes=%llu "
+                        "hit-rate=%.02f%% hits=%llu misses=%llu prefetched=%llu "
+                        "fetches=%llu evicted=%llu invalidated=%llu",
+                        rstats.mSize / 1000000.0,
+                        (unsigned long long) rstats.mPages,
+                        (unsigned long long) rstats.mInodes,
+                        naccess ? 100.0 * rstats.mHits / naccess : 0.0,
+                        (unsigned long long) rstats.mHits,
+                        (unsigned long long) rstats.mMisses,
+                        (unsigned long long) rstats.mPrefetched,
+                        (unsigned long long) rstats.mFetches,
+                        (unsigned long long) rstats.mEvicted,
+                        (unsigned long long) rstats.mInvalidated);
+    }
   }
 
   return 0;
@@ -304,6 +327,21 @@ filesystem::log_settings()
                       getenv("EOS_FUSE_CACHE_PAGE_SIZE") : "(default 262144)";
   s += efpcs;
   log("WARNING", s.c_str());
+  s = "read-cache             := ";
+  s += XRC ? "1" : "0";
+  log("WARNING", s.c_str());
+
+  if (XRC) {
+    s = "read-cache-page-size   := ";
+    XrdOucString rcps;
+    rcps += (int) XRC->GetPageSize();
+    s += rcps.c_str();
+    log("WARNING", s.c_str());
+  }
+
+  s = "binary-dirlist         := ";
+  s += binary_dirlist ? "true" : "false";
+  log("WARNING", s.c_str());
   s = "big-writes             := ";
   std::string bw = getenv("EOS_FUSE_BIGWRITES") ? getenv("EOS_FUSE_BIGWRITES") :
                    "0";
@@ -929,6 +967,8 @@ filesystem::add_fd2file(LayoutWrapper* raw_file,
                        "=> fdesc=%d", fabst.get(), path, (int) isROfd, (int) fd);
     }
 
+    fabst->SetInode(inode);
+
     if (isROfd) {
       fabst->SetRawFileRO(raw_file);  // sets numopenRO to 1
     } else {
@@ -1724,6 +1764,12 @@ filesystem::stat(const char* path, struct stat* buf, uid_t uid, gid_t gid,
       buf->st_mode &= (~S_ISVTX); // clear the vxt bit
       buf->st_mode &= (~S_ISUID); // clear suid
       buf->st_mode &= (~S_ISGID); // clear sgid
+
+      if (XRC && S_ISREG(buf->st_mode)) {
+        // drop the cached pages if the file changed
+        XRC->Validate(buf->st_ino, buf->st_size, buf->MTIMESPEC);
+      }
+
       errno = 0;
     }
   }
@@ -2318,6 +2364,16 @@ filesystem::inodirlist(unsigned long long dirinode,
   char* value = 0;
   int doinodirlist = -1;
   std::string request = path;
+
+  if (binary_dirlist) {
+    // ask for the binary listing with inline stat information
+    size_t p_pos = request.find("mgm.path=");
+
+    if (p_pos != std::string::npos) {
+      request.insert(p_pos, "mgm.fuse.binary=1&");
+    }
+  }
+
   size_t a_pos = request.find("mgm.path=/");
 
   // we have to replace '&' in path names with '#AND#'
@@ -2348,6 +2404,21 @@ filesystem::inodirlist(unsigned long long dirinode,
     return errno;
   }
 
+  if (binary_dirlist) {
+    std::vector<struct stat> statvec;
+    COMMONTIMING("READBINSTREAM", &inodirtiming);
+    retc = inodirlist_binary(file, dirinode, dlist, stats ? &statvec : 0);
+    delete file;
+    COMMONTIMING("PARSEBINSTREAM", &inodirtiming);
+
+    if (!retc && stats) {
+      dirlist_stats(statvec, stats, nstats);
+    }
+
+    COMMONTIMING("END", &inodirtiming);
+    return retc;
+  }
+
   // Start to read
   int npages = 1;
   off_t offset = 0;
@@ -2668,18 +2739,7 @@ filesystem::inodirlist(unsigned long long dirinode,
   COMMONTIMING("PARSESTSTREAM2", &inodirtiming);
 
   if (stats) {
-    *stats = (struct fuse_entry_param*) malloc(sizeof(struct fuse_entry_param) *
-             statvec.size());
-    *nstats = statvec.size();
-
-    for (auto i = 0; i < (int) statvec.size(); i++) {
-      struct fuse_entry_param& e = (*stats)[i];
-      memset(&e, 0, sizeof(struct fuse_entry_param));
-      e.attr = statvec[i];
-      e.attr_timeout = 0;
-      e.entry_timeout = 0;
-      e.ino = e.attr.st_ino;
-    }
+    dirlist_stats(statvec, stats, nstats);
   }
 
   COMMONTIMING("END", &inodirtiming);
@@ -2687,6 +2747,183 @@ filesystem::inodirlist(unsigned long long dirinode,
   return doinodirlist;
 }
 
+//------------------------------------------------------------------------------
+// Read a binary directory listing, the records are parsed page by page while
+// the reply is read
+//------------------------------------------------------------------------------
+int
+filesystem::inodirlist_binary(XrdCl::File* file,
+                              unsigned long long dirinode,
+                              dirlist& dlist,
+                              std::vector<struct stat>* statvec)
+{
+  std::vector<char> page(PAGESIZE);
+  std::string pending; // unparsed bytes, at most one record after a page
+  bool header = false;
+  off_t offset = 0;
+  uint32_t nbytes = 0;
+  const char* name;
+  uint32_t namelen;
+  uint64_t inode;
+  uint64_t fields[eos::common::InodeDirList::kStatFields];
+  bool hasstat;
+
+  do {
+    XrdCl::XRootDStatus status = file->Read(offset, PAGESIZE, page.data(),
+                                            nbytes);
+
+    if (!status.IsOK()) {
+      eos_static_err("error=status is NOT ok : %s", status.ToString().c_str());
+      errno = status.code == XrdCl::errAuthFailed ? EPERM : EFAULT;
+      return errno;
+    }
+
+    offset += nbytes;
+    pending.append(page.data(), nbytes);
+    size_t pos = 0;
+
+    if (!header) {
+      // "inodirlist_binary: retc=<retc> "
+      size_t end = pending.find(' ');
+
+      if (end != std::string::npos) {
+        end = pending.find(' ', end + 1);
+      }
+
+      if (end == std::string::npos) {
+        if (nbytes == PAGESIZE) {
+          continue;
+        }
+
+        eos_static_err("got an error(1).");
+        errno = EFAULT;
+        return errno;
+      }
+
+      char tag[128];
+      int retc = 0;
+      int items = sscanf(pending.substr(0, end).c_str(), "%127s retc=%d", tag,
+                         &retc);
+
+      if ((items != 2) || strcmp(tag, eos::common::InodeDirList::Tag())) {
+        eos_static_err("got an error(1).");
+        errno = EFAULT;
+        return errno;
+      }
+
+      if (retc) {
+        errno = EFAULT;
+        return errno;
+      }
+
+      header = true;
+      pos = end + 1;
+    }
+
+    size_t len;
+
+    while ((len = eos::common::InodeDirList::Parse(pending.data() + pos,
+                  pending.length() - pos, name, namelen, inode, fields,
+                  hasstat))) {
+      std::string sname(name, namelen);
+      pos += len;
+
+      if (!encode_pathname && !checkpathname(sname.c_str())) {
+        eos_static_err("unsupported name %s : not stored in the FsCache",
+                       sname.c_str());
+        continue;
+      }
+
+      if (hide_special_files &&
+          (!sname.compare(0, strlen(EOS_COMMON_PATH_VERSION_FILE_PREFIX),
+                          EOS_COMMON_PATH_VERSION_FILE_PREFIX) ||
+           !sname.compare(0, strlen(EOS_COMMON_PATH_ATOMIC_FILE_PREFIX),
+                          EOS_COMMON_PATH_ATOMIC_FILE_PREFIX) ||
+           !sname.compare(0, strlen(EOS_COMMON_PATH_BACKUP_FILE_PREFIX),
+                          EOS_COMMON_PATH_BACKUP_FILE_PREFIX))) {
+        continue;
+      }
+
+      store_child_p2i(dirinode, inode, sname.c_str());
+      dlist.push_back(inode);
+
+      if (statvec) {
+        struct stat buf;
+        memset(&buf, 0, sizeof(struct stat));
+
+        if (hasstat) {
+          buf.ATIMESPEC.tv_nsec = fields[0];
+          buf.ATIMESPEC.tv_sec = fields[1];
+          buf.st_blksize = fields[2];
+          buf.st_blocks = fields[3];
+          buf.CTIMESPEC.tv_nsec = fields[4];
+          buf.CTIMESPEC.tv_sec = fields[5];
+          buf.st_dev = fields[6];
+          buf.st_gid = fields[7];
+          buf.st_ino = fields[8];
+          buf.st_mode = fields[9];
+          buf.MTIMESPEC.tv_nsec = fields[10];
+          buf.MTIMESPEC.tv_sec = fields[11];
+          buf.st_nlink = fields[12];
+          buf.st_rdev = fields[13];
+          buf.st_size = fields[14];
+          buf.st_uid = fields[15];
+
+          if (S_ISREG(buf.st_mode) && fuse_exec) {
+            buf.st_mode |= (S_IXUSR | S_IXGRP | S_IXOTH);
+          }
+
+          buf.st_mode &= (~S_ISVTX); // clear the vxt bit
+          buf.st_mode &= (~S_ISUID); // clear suid
+          buf.st_mode &= (~S_ISGID); // clear sgid
+          buf.st_mode |= mode_overlay;
+        }
+
+        // entries are added in the order of dlist
+        statvec->push_back(buf);
+      }
+    }
+
+    pending.erase(0, pos);
+  } while (nbytes == PAGESIZE);
+
+  if (!header || pending.length()) {
+    eos_static_err("got an error(2).");
+    errno = EFAULT;
+    return errno;
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Convert the stat information of a directory listing into fuse entries
+//------------------------------------------------------------------------------
+void
+filesystem::dirlist_stats(const std::vector<struct stat>& statvec,
+                          struct fuse_entry_param** stats,
+                          size_t* nstats)
+{
+  *stats = (struct fuse_entry_param*) malloc(sizeof(struct fuse_entry_param) *
+           statvec.size());
+  *nstats = statvec.size();
+
+  for (auto i = 0; i < (int) statvec.size(); i++) {
+    struct fuse_entry_param& e = (*stats)[i];
+    memset(&e, 0, sizeof(struct fuse_entry_param));
+    e.attr = statvec[i];
+    e.attr_timeout = 0;
+    e.entry_timeout = 0;
+    e.ino = e.attr.st_ino;
+
+    if (XRC && e.attr.st_ino && S_ISREG(e.attr.st_mode)) {
+      // the listing stats are served to the kernel like the ones of stat,
+      // drop the cached pages if the file changed
+      XRC->Validate(e.attr.st_ino, e.attr.st_size, e.attr.MTIMESPEC);
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 // Get directory entries
 //------------------------------------------------------------------------------
@@ -3611,6 +3848,11 @@ filesystem::flush(int fd, uid_t uid, gid_t gid, pid_t pid)
     }
 
     XFC->ForceAllWrites(fabst.get(), wait_async);
+
+    if (XRC) {
+      XRC->Invalidate(fabst->GetInode());
+    }
+
     eos::common::ConcurrentQueue<error_type> err_queue = fabst->GetErrorQueue();
     error_type error;
 
@@ -3672,6 +3914,10 @@ filesystem::truncate(int fildes, off_t offset)
   ts[0] = ts[1];
   fabst->SetUtimes(ts);
 
+  if (XRC) {
+    XRC->Invalidate(fabst->GetInode());
+  }
+
   if (XFC && fuse_cache_write) {
     fabst->mMutexRW.WriteLock();
     XFC->ForceAllWrites(fabst.get());
@@ -3772,6 +4018,12 @@ filesystem::pread(int fildes,
   }
 
   LayoutWrapper* file = isRW ? fabst->GetRawFileRW() : fabst->GetRawFileRO();
+  // Files written through this client are not read through the page cache
+  bool use_read_cache = (XRC && !isRW && fabst->GetInode() &&
+                         !fabst->GetRawFileRW());
+  FuseReadCache::fetch_t fetch = [file, this](char* b, off_t o, size_t l) {
+    return (ssize_t) file->Read(o, b, l, do_rdahead);
+  };
 
   if (XFC && fuse_cache_write) {
     ret = file->ReadCache(offset, static_cast<char*>(buf), nbyte,
@@ -3791,6 +4043,10 @@ filesystem::pread(int fildes,
           ret = file->Read(offset, static_cast<char*>(buf), nbyte,
                            false);
           fabst->mMutexRW.UnLock();
+        } else if (use_read_cache) {
+          origin = "read-cache";
+          ret = XRC->Read(fabst->GetInode(), static_cast<char*>(buf), offset,
+                          nbyte, fetch);
         } else {
           ret = file->Read(offset, static_cast<char*>(buf), nbyte,
                            do_rdahead);
@@ -3801,6 +4057,10 @@ filesystem::pread(int fildes,
     } else {
       origin = "cache";
     }
+  } else if (use_read_cache) {
+    origin = "read-cache";
+    ret = XRC->Read(fabst->GetInode(), static_cast<char*>(buf), offset, nbyte,
+                    fetch);
   } else {
     ret = file->Read(offset, static_cast<char*>(buf), nbyte,
                      isRW ? false : do_rdahead);
@@ -3854,6 +4114,10 @@ filesystem::pwrite(int fildes, const void* buf, size_t nbyte, off_t offset)
     return ret;
   }
 
+  if (XRC) {
+    XRC->Invalidate(fabst->GetInode());
+  }
+
   if (XFC && fuse_cache_write) {
     // store in cache
     fabst->GetRawFileRW()->WriteCache(offset, static_cast<const char*>(buf), nbyte,
@@ -3978,6 +4242,10 @@ filesystem::unlink(const char* path, uid_t uid, gid_t gid, pid_t pid,
 // drop evt. the in-memory cache
   LayoutWrapper::CacheRemove(inode);
 
+  if (XRC && inode) {
+    XRC->Invalidate(inode);
+  }
+
   if (!eos::common::error_retc_map(status.errNo)) {
     errno = 0;
   }
@@ -4662,6 +4930,15 @@ filesystem::init(int argc, char* argv[], void* userdata,
     show_eos_attributes = false;
   }
 
+  // list directories in the binary format if the server supports it
+  binary_dirlist = (features && features->count("eos.inodirlist") &&
+                    ((*features)["eos.inodirlist"] == "binary"));
+
+  if (getenv("EOS_FUSE_BINARY_DIRLIST") &&
+      (!strcmp(getenv("EOS_FUSE_BINARY_DIRLIST"), "0"))) {
+    binary_dirlist = false;
+  }
+
   if (features && !features->count("eos.lazyopen")) {
     // disable lazy open, no server side support
     lazy_open_ro = false;
@@ -4705,6 +4982,20 @@ filesystem::init(int argc, char* argv[], void* userdata,
                                            10));
   }
 
+// Initialise the read cache, it shares the budget of the write cache
+  if (getenv("EOS_FUSE_READ_CACHE") &&
+      (!strcmp(getenv("EOS_FUSE_READ_CACHE"), "1"))) {
+    size_t rcsize = getenv("EOS_FUSE_CACHE_SIZE") ?
+                    strtoull(getenv("EOS_FUSE_CACHE_SIZE"), 0, 10) : 30000000;
+    size_t rcpagesize = getenv("EOS_FUSE_READ_CACHE_PAGE_SIZE") ?
+                        strtoull(getenv("EOS_FUSE_READ_CACHE_PAGE_SIZE"), 0, 10) :
+                        128 * 1024;
+    size_t rcprefetch = getenv("EOS_FUSE_READ_CACHE_PREFETCH") ?
+                        strtoull(getenv("EOS_FUSE_READ_CACHE_PREFETCH"), 0, 10) :
+                        16;
+    XRC = new FuseReadCache(rcsize, rcpagesize, rcprefetch, XFC);
+  }
+
 // set the path of the proc fs (default is "/proc/"
   gProcCacheShardSize = AuthIdManager::proccachenbins;
   gProcCacheV.resize(gProcCacheShardSize);
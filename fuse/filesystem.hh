@@ -61,6 +61,7 @@
 #include "fst/layout/ReedSLayout.hh"
 /*----------------------------------------------------------------------------*/
 #include "FuseCache/FuseWriteCache.hh"
+#include "FuseCache/FuseReadCache.hh"
 #include "FuseCache/FileAbstraction.hh"
 #include "FuseCache/LayoutWrapper.hh"
 /*----------------------------------------------------------------------------*/
@@ -755,6 +756,28 @@ public:
                  struct fuse_entry_param** stats,
                  size_t* nstats);
 
+//----------------------------------------------------------------------------
+//! Read a binary directory listing from an open inodirlist request
+//!
+//! @param file open request
+//! @param dirinode inode of the directory
+//! @param dlist receives the inodes of the entries
+//! @param statvec receives the stat information of the entries, can be 0
+//!
+//! @return 0 on success, otherwise errno
+//----------------------------------------------------------------------------
+  int inodirlist_binary(XrdCl::File* file,
+                        unsigned long long dirinode,
+                        dirlist& dlist,
+                        std::vector<struct stat>* statvec);
+
+//----------------------------------------------------------------------------
+//! Convert the stat information of a directory listing into fuse entries
+//----------------------------------------------------------------------------
+  void dirlist_stats(const std::vector<struct stat>& statvec,
+                     struct fuse_entry_param** stats,
+                     size_t* nstats);
+
 //----------------------------------------------------------------------------
 //! Do user mapping
 //----------------------------------------------------------------------------
@@ -970,6 +993,7 @@ private:
   int creator_cap_lifetime; ///< time period where files are considered owned locally e.g. remote modifications are not reflected locally
   int file_write_back_cache_size; ///< max temporary write-back cache per file size in bytes
   bool encode_pathname; ///< indicated if filename should be encoded
+  bool binary_dirlist; ///< indicates if directories are listed in the binary format
   bool hide_special_files; ///< indicate if we show atomic entries, version, backup files etc.
   bool show_eos_attributes; ///< show all sys.* and emulated user.eos attributes when listing xattributes
   mode_t mode_overlay; ///< mask which is or'ed into the retrieved mode
@@ -1157,6 +1181,7 @@ private:
 
 
   FuseWriteCache* XFC;
+  FuseReadCache* XRC;
 
   int
   mylstat(const char* __restrict name, struct stat* __restrict __buf, pid_t pid);
@@ -129,11 +129,12 @@ ConverterJob::DoIt ()
 		     attrmap, false, true);
 
       // get the checksum string if defined
+      eos::Buffer fmdchecksum = fmd->getChecksum();
       for (unsigned int i = 0;
         i < eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId()); i++)
       {
         char hb[3];
-        sprintf(hb, "%02x", (unsigned char) (fmd->getChecksum().getDataPadded(i)));
+        sprintf(hb, "%02x", (unsigned char) (fmdchecksum.getDataPadded(i)));
         sourceChecksum += hb;
       }
 
@@ -271,11 +272,12 @@ ConverterJob::DoIt ()
       fmd = gOFS->eosFileService->getFileMD(mFid);
 
       // get the checksum string if defined
+      eos::Buffer fmdchecksum = fmd->getChecksum();
       for (unsigned int i = 0;
         i < eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId()); i++)
       {
         char hb[3];
-        sprintf(hb, "%02x", (unsigned char) (fmd->getChecksum().getDataPadded(i)));
+        sprintf(hb, "%02x", (unsigned char) (fmdchecksum.getDataPadded(i)));
         sourceAfterChecksum += hb;
       }
     }
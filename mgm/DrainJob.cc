@@ -354,11 +354,7 @@ retry:
     eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex);
     try
     {
-      eos::IFsView::FileList filelist =
-        gOFS->eosFsView->getFileList(mFsId);
-      eos::IFsView::FileIterator it;
-
-      totalfiles = filelist.size();
+      totalfiles = gOFS->eosFsView->getNumFilesOnFs(mFsId);
       if (fs->GetConfigStatus() == eos::common::FileSystem::kDrain)
       {
         //----------------------------------------------------------------------
@@ -535,9 +531,7 @@ retry:
       last_filesleft = filesleft;
       try
       {
-        eos::IFsView::FileList filelist =
-          gOFS->eosFsView->getFileList(mFsId);
-        filesleft = filelist.size();
+        filesleft = gOFS->eosFsView->getNumFilesOnFs(mFsId);
       }
       catch (eos::MDException &e)
       {
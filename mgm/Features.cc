@@ -32,7 +32,8 @@ EOSMGMNAMESPACE_BEGIN
 const std::map< const std::string, const std::string> Features::sMap =
 {
   { "eos.encodepath", "curl" },
-  { "eos.lazyopen",   "true" } 
+  { "eos.lazyopen",   "true" },
+  { "eos.inodirlist", "binary" }
 };
 
 EOSMGMNAMESPACE_END
@@ -365,18 +365,18 @@ Fsck::Check (void)
           {
             eos::common::RWMutexReadLock nslock(gOFS->eosViewRWMutex);
 	    std::shared_ptr<eos::IFileMD> fmd;
-            eos::IFsView::FileList filelist = gOFS->eosFsView->getFileList(fsid);
-            eos::IFsView::FileIterator it;
-            for (it = filelist.begin(); it != filelist.end(); ++it)
+            for (auto it = gOFS->eosFsView->getFileListCursor(fsid);
+                 it->valid(); it->next())
             {
-              fmd = gOFS->eosFileService->getFileMD(*it);
+              eos::IFileMD::id_t fid = it->getElement();
+              fmd = gOFS->eosFileService->getFileMD(fid);
 
               if (fmd)
               {
                 XrdSysMutexHelper lock(eMutex);
                 eFsUnavail[fsid]++;
-                eFsMap["rep_offline"][fsid].insert(*it);
-                eMap["rep_offline"].insert(*it);
+                eFsMap["rep_offline"][fsid].insert(fid);
+                eMap["rep_offline"].insert(fid);
                 eCount["rep_offline"]++;
               }
             }
@@ -400,11 +400,11 @@ Fsck::Check (void)
       {
         eos::common::RWMutexReadLock nslock(gOFS->eosViewRWMutex);
 	std::shared_ptr<eos::IFileMD> fmd;
-        const eos::IFsView::FileList& filelist = gOFS->eosFsView->getNoReplicasFileList();
-
-        for (auto it = filelist.begin(); it != filelist.end(); ++it)
+        for (auto it = gOFS->eosFsView->getNoReplicasFileListCursor();
+             it->valid(); it->next())
         {
-          fmd = gOFS->eosFileService->getFileMD(*it);
+          eos::IFileMD::id_t fid = it->getElement();
+          fmd = gOFS->eosFileService->getFileMD(fid);
           std::string path = gOFS->eosView->getUri(fmd.get());
           XrdOucString fullpath = path.c_str();
 
@@ -417,7 +417,7 @@ Fsck::Check (void)
           if (fmd && (!fmd->isLink()))
           {
             XrdSysMutexHelper lock(eMutex);
-            eMap["zero_replica"].insert(*it);
+            eMap["zero_replica"].insert(fid);
             eCount["zero_replica"]++;
           }
         }
@@ -558,16 +558,16 @@ Fsck::Check (void)
       {
         try
         {
-          const eos::IFsView::FileList& filelist =  gOFS->eosFsView->getFileList(nfsid);
+          uint64_t nfiles = gOFS->eosFsView->getNumFilesOnFs(nfsid);
 
-          if (filelist.size())
+          if (nfiles)
           {
             // Check if this exists in the gFsView
             if (!FsView::gFsView.mIdView.count(nfsid))
             {
               XrdSysMutexHelper lock(eMutex);
-              eFsDark[nfsid] += filelist.size();
-              Log(false, "shadow fsid=%lu shadow_entries=%llu ", nfsid, filelist.size());
+              eFsDark[nfsid] += nfiles;
+              Log(false, "shadow fsid=%lu shadow_entries=%llu ", nfsid, nfiles);
             }
           }
         }
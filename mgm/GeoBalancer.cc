@@ -452,7 +452,7 @@ GeoBalancer::chooseFidFromGeotag (const std::string &geotag)
   int rndIndex;
   eos::common::RWMutexReadLock vlock(FsView::gFsView.ViewMutex);
   eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex);
-  eos::IFsView::FileList filelist;
+  uint64_t nfiles = 0;
   std::vector<eos::common::FileSystem::fsid_t> &validFs = mGeotagFs[geotag];
 
   eos::common::FileSystem::fsid_t fsid;
@@ -460,9 +460,9 @@ GeoBalancer::chooseFidFromGeotag (const std::string &geotag)
   {
     rndIndex = getRandom(validFs.size() - 1);
     fsid = validFs[rndIndex];
-    filelist = gOFS->eosFsView->getFileList(fsid);
+    nfiles = gOFS->eosFsView->getNumFilesOnFs(fsid);
 
-    if (filelist.size() > 0)
+    if (nfiles > 0)
       break;
 
     validFs.erase(validFs.begin() + rndIndex);
@@ -475,20 +475,17 @@ GeoBalancer::chooseFidFromGeotag (const std::string &geotag)
     fillGeotagsByAvg();
   }
 
-  if (filelist.size() == 0)
+  if (nfiles == 0)
     return -1;
 
-  int attempts = 10;
-  eos::IFsView::FileIterator fid_it;
+  // try up to 10 random files not already being transferred
+  std::vector<eos::IFileMD::id_t> candidates =
+    gOFS->eosFsView->getRandomFiles(fsid, 10);
 
-  while (attempts-- > 0)
+  for (auto fid : candidates)
   {
-    rndIndex = getRandom(filelist.size() - 1);
-    fid_it = filelist.begin();
-    std::advance(fid_it, rndIndex);
-
-    if (mTransfers.count(*fid_it) == 0)
-      return *fid_it;
+    if (mTransfers.count(fid) == 0)
+      return fid;
   }
 
   return -1;
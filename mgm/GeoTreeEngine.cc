@@ -48,6 +48,8 @@ GeoTreeEngine gGeoTreeEngine;
 const size_t GeoTreeEngine::gGeoBufferSize = sizeof(FastPlacementTree) + FastPlacementTree::sGetMaxDataMemSize(); // we assume that all the trees have the same max size, we should take the max of all the sizes otherwise
 __thread void* GeoTreeEngine::tlGeoBuffer = NULL;
 pthread_key_t GeoTreeEngine::gPthreadKey;
+__thread void* GeoTreeEngine::tlGeoBatchBuffer = NULL;
+pthread_key_t GeoTreeEngine::gPthreadBatchKey;
 __thread const FsGroup* GeoTreeEngine::tlCurrentGroup = NULL;
 
 const int
@@ -205,17 +207,10 @@ bool GeoTreeEngine::insertFsIntoGroup(FileSystem *fs ,
 #ifdef EOS_GEOTREEENGINE_USE_INSTRUMENTED_MUTEX
 #ifdef EOS_INSTRUMENTED_RWMUTEX
       char buffer[64],buffer2[64];
-      sprintf(buffer,"GTE %s doublebuffer",group->mName.c_str());
-      sprintf(buffer2,"%s doublebuffer",group->mName.c_str());
-      mapEntry->doubleBufferMutex.SetDebugName(buffer2);
-      int retcode = eos::common::RWMutex::AddOrderRule(buffer,std::vector<eos::common::RWMutex*>(
-	      { &pAddRmFsMutex,&pTreeMapMutex,&mapEntry->doubleBufferMutex}));
-      eos_info("creating RWMutex rule order %p, retcode is %d",&mapEntry->doubleBufferMutex, retcode);
-
       sprintf(buffer,"GTE %s slowtree",group->mName.c_str());
       sprintf(buffer2,"%s slowtree",group->mName.c_str());
       mapEntry->slowTreeMutex.SetDebugName(buffer2);
-      retcode = eos::common::RWMutex::AddOrderRule(buffer,std::vector<eos::common::RWMutex*>(
+      int retcode = eos::common::RWMutex::AddOrderRule(buffer,std::vector<eos::common::RWMutex*>(
 	      { &pAddRmFsMutex,&pTreeMapMutex,&mapEntry->slowTreeMutex}));
       eos_info("creating RWMutex rule order %p, retcode is %d",&mapEntry->slowTreeMutex, retcode);
 #endif
@@ -787,7 +782,6 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
 {
   assert(nNewReplicas);
   assert(newReplicas);
-  std::vector<SchedTME*> entries;
 
   // find the entry in the map
   tlCurrentGroup = group;
@@ -803,8 +797,9 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
     AtomicInc(entry->fastStructLockWaitersCount);
   }
 
-  // readlock the original fast structure
-  entry->doubleBufferMutex.LockRead();
+  // enter the read-side section of the original fast structure
+  SchedulingEpoch::tToken epochToken = entry->fastStructEpoch.ReadLock();
+  FastStructSched *fg = SchedulingEpoch::Dereference(entry->foregroundFastStruct);
 
   // locate the existing replicas and the excluded fs in the tree
   vector<SchedTreeBase::tFastTreeIdx> newReplicasIdx(nNewReplicas),*existingReplicasIdx=NULL,*excludeFsIdx=NULL,*forceBrIdx=NULL;
@@ -817,7 +812,7 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
     for(auto it = existingReplicas->begin(); it != existingReplicas->end(); ++it , ++count)
     {
       const SchedTreeBase::tFastTreeIdx *idx = static_cast<const SchedTreeBase::tFastTreeIdx*>(0);
-      if(!entry->foregroundFastStruct->fs2TreeIdx->get(*it,idx) && !(*fsidsgeotags)[count].empty())
+      if(!fg->fs2TreeIdx->get(*it,idx) && !(*fsidsgeotags)[count].empty())
       {
 	// the fs is not in that group.
 	// this could happen because the former file scheduler
@@ -825,8 +820,8 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
 	// with the new geoscheduler, it should not happen
 
 	// in that case, we try to match a filesystem having the same geotag
-	SchedTreeBase::tFastTreeIdx idx = entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode((*fsidsgeotags)[count].c_str());
-	if(idx && (*entry->foregroundFastStruct->treeInfo)[idx].nodeType == SchedTreeBase::TreeNodeInfo::fs)
+	SchedTreeBase::tFastTreeIdx idx = fg->tag2NodeIdx->getClosestFastTreeNode((*fsidsgeotags)[count].c_str());
+	if(idx && (*fg->treeInfo)[idx].nodeType == SchedTreeBase::TreeNodeInfo::fs)
 	{
 	  if((std::find(existingReplicasIdx->begin(),existingReplicasIdx->end(),idx) == existingReplicasIdx->end()))
 	  existingReplicasIdx->push_back(idx);
@@ -849,7 +844,7 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
     for(auto it = excludeFs->begin(); it != excludeFs->end(); ++it)
     {
       const SchedTreeBase::tFastTreeIdx *idx;
-      if(!entry->foregroundFastStruct->fs2TreeIdx->get(*it,idx))
+      if(!fg->fs2TreeIdx->get(*it,idx))
       {
 	// the excluded fs might belong to another group
 	// so it's not an error condition
@@ -869,7 +864,7 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
     for(auto it = excludeGeoTags->begin(); it != excludeGeoTags->end(); ++it)
     {
       SchedTreeBase::tFastTreeIdx idx;
-      idx=entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
+      idx=fg->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
       excludeFsIdx->push_back(idx);
     }
   }
@@ -880,7 +875,7 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
     for(auto it = forceGeoTags->begin(); it != forceGeoTags->end(); ++it)
     {
       SchedTreeBase::tFastTreeIdx idx;
-      idx=entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
+      idx=fg->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
       forceBrIdx->push_back(idx);
     }
   }
@@ -888,7 +883,7 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
   SchedTreeBase::tFastTreeIdx startFromNode=0;
   if(!startFromGeoTag.empty())
   {
-    startFromNode=entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(startFromGeoTag.c_str());
+    startFromNode=fg->tag2NodeIdx->getClosestFastTreeNode(startFromGeoTag.c_str());
   }
 
   // actually do the job
@@ -897,15 +892,15 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
   {
     case regularRO:
     case regularRW:
-    success = placeNewReplicas(entry,nNewReplicas,&newReplicasIdx,entry->foregroundFastStruct->placementTree,
+    success = placeNewReplicas(entry,nNewReplicas,&newReplicasIdx,fg->placementTree,
 	existingReplicasIdx,bookingSize,startFromNode,nCollocatedReplicas,excludeFsIdx,forceBrIdx,pSkipSaturatedPlct);
     break;
     case draining:
-    success = placeNewReplicas(entry,nNewReplicas,&newReplicasIdx,entry->foregroundFastStruct->drnPlacementTree,
+    success = placeNewReplicas(entry,nNewReplicas,&newReplicasIdx,fg->drnPlacementTree,
 	existingReplicasIdx,bookingSize,startFromNode,nCollocatedReplicas,excludeFsIdx,forceBrIdx,pSkipSaturatedDrnPlct);
     break;
     case balancing:
-    success = placeNewReplicas(entry,nNewReplicas,&newReplicasIdx,entry->foregroundFastStruct->blcPlacementTree,
+    success = placeNewReplicas(entry,nNewReplicas,&newReplicasIdx,fg->blcPlacementTree,
 	existingReplicasIdx,bookingSize,startFromNode,nCollocatedReplicas,excludeFsIdx,forceBrIdx,pSkipSaturatedBlcPlct);
     break;
     default:
@@ -919,27 +914,256 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
   for(auto it = newReplicasIdx.begin(); it != newReplicasIdx.end(); ++it)
   {
     const SchedTreeBase::tFastTreeIdx *idx=NULL;
-    const unsigned int fsid = (*entry->foregroundFastStruct->treeInfo)[*it].fsId;
-    entry->foregroundFastStruct->fs2TreeIdx->get(fsid,idx);
-    const char netSpeedClass = (*entry->foregroundFastStruct->treeInfo)[*idx].netSpeedClass;
+    const unsigned int fsid = (*fg->treeInfo)[*it].fsId;
+    fg->fs2TreeIdx->get(fsid,idx);
+    const char netSpeedClass = (*fg->treeInfo)[*idx].netSpeedClass;
     newReplicas->push_back(fsid);
     // apply the penalties
-    if(entry->foregroundFastStruct->placementTree->pNodes[*idx].fsData.dlScore>0)
-    applyDlScorePenalty(entry,*idx,pPenaltySched.pPlctDlScorePenalty[netSpeedClass]);
-    if(entry->foregroundFastStruct->placementTree->pNodes[*idx].fsData.ulScore>0)
-    applyUlScorePenalty(entry,*idx,pPenaltySched.pPlctUlScorePenalty[netSpeedClass]);
+    if(fg->placementTree->pNodes[*idx].fsData.dlScore>0)
+    fg->applyDlScorePenalty(*idx,pPenaltySched.pPlctDlScorePenalty[netSpeedClass],false);
+    if(fg->placementTree->pNodes[*idx].fsData.ulScore>0)
+    fg->applyUlScorePenalty(*idx,pPenaltySched.pPlctUlScorePenalty[netSpeedClass],false);
+  }
+
+  // find the proxys and firewall entry points if needed
+  if(!placeProxies(newReplicasIdx, fg, inode, dataProxys, firewallEntryPoint, clientGeoTag))
+  {
+    success = false;
+    goto cleanup;
+  }
+
+  // unlock, cleanup
+  cleanup:
+  if(!success) newReplicas->clear();
+  entry->fastStructEpoch.ReadUnlock(epochToken);
+  AtomicDec(entry->fastStructLockWaitersCount);
+  if(existingReplicasIdx) delete existingReplicasIdx;
+  if(excludeFsIdx) delete excludeFsIdx;
+  if(forceBrIdx) delete forceBrIdx;
+
+  return success;
+}
+
+bool GeoTreeEngine::placeNewReplicasOneGroupBatch( FsGroup* group, const size_t &nFiles,
+    const size_t &nNewReplicas,
+    vector<vector<FileSystem::fsid_t> > *newReplicas,
+    SchedType type,
+    size_t *generation,
+    unsigned long long bookingSize,
+    const std::string &startFromGeoTag,
+    const size_t &nCollocatedReplicas,
+    vector<FileSystem::fsid_t> *excludeFs,
+    vector<string> *excludeGeoTags)
+{
+  assert(nFiles);
+  assert(nNewReplicas);
+  assert(newReplicas);
+
+  // find the entry in the map
+  tlCurrentGroup = group;
+  SchedTME *entry;
+  {
+    RWMutexReadLock lock(this->pTreeMapMutex);
+    if(!pGroup2SchedTME.count(group))
+    {
+      eos_err("could not find the requested placement group in the map");
+      return false;
+    }
+    entry = pGroup2SchedTME[group];
+    AtomicInc(entry->fastStructLockWaitersCount);
+  }
+
+  // the generation is read before the snapshot so that it can only be older than the snapshot
+  if(generation) *generation = AtomicGet(entry->fastStructGeneration);
+
+  // enter the read-side section of the original fast structure
+  SchedulingEpoch::tToken epochToken = entry->fastStructEpoch.ReadLock();
+  FastStructSched *fg = SchedulingEpoch::Dereference(entry->foregroundFastStruct);
+
+  // locate the excluded fs and branches in the tree
+  vector<SchedTreeBase::tFastTreeIdx> excludeFsIdx;
+  if(excludeFs)
+  {
+    for(auto it = excludeFs->begin(); it != excludeFs->end(); ++it)
+    {
+      const SchedTreeBase::tFastTreeIdx *idx;
+      // the excluded fs might belong to another group
+      if(fg->fs2TreeIdx->get(*it,idx))
+      excludeFsIdx.push_back(*idx);
+    }
+  }
+  if(excludeGeoTags)
+  {
+    for(auto it = excludeGeoTags->begin(); it != excludeGeoTags->end(); ++it)
+    excludeFsIdx.push_back(fg->tag2NodeIdx->getClosestFastTreeNode(it->c_str()));
+  }
+
+  SchedTreeBase::tFastTreeIdx startFromNode=0;
+  if(!startFromGeoTag.empty())
+  {
+    startFromNode=fg->tag2NodeIdx->getClosestFastTreeNode(startFromGeoTag.c_str());
+  }
+
+  // actually do the job
+  vector<vector<SchedTreeBase::tFastTreeIdx> > newReplicasIdx;
+  newReplicasIdx.reserve(nFiles);
+  switch(type)
+  {
+    case regularRO:
+    case regularRW:
+    placeNewReplicasBatch(entry,nFiles,nNewReplicas,&newReplicasIdx,fg->placementTree,
+	bookingSize,startFromNode,nCollocatedReplicas,&excludeFsIdx,pSkipSaturatedPlct);
+    break;
+    case draining:
+    placeNewReplicasBatch(entry,nFiles,nNewReplicas,&newReplicasIdx,fg->drnPlacementTree,
+	bookingSize,startFromNode,nCollocatedReplicas,&excludeFsIdx,pSkipSaturatedDrnPlct);
+    break;
+    case balancing:
+    placeNewReplicasBatch(entry,nFiles,nNewReplicas,&newReplicasIdx,fg->blcPlacementTree,
+	bookingSize,startFromNode,nCollocatedReplicas,&excludeFsIdx,pSkipSaturatedBlcPlct);
+    break;
+    default:
+    ;
+  }
+
+  // fill the resulting vector, the penalties are applied to the shared
+  // structures when the placements are used, see applyPlacementPenaltiesOneGroup
+  newReplicas->resize(0);
+  for(auto fit = newReplicasIdx.begin(); fit != newReplicasIdx.end(); ++fit)
+  {
+    newReplicas->push_back(vector<FileSystem::fsid_t>());
+    for(auto it = fit->begin(); it != fit->end(); ++it)
+    newReplicas->back().push_back((*fg->treeInfo)[*it].fsId);
+  }
+
+  // unlock, cleanup
+  entry->fastStructEpoch.ReadUnlock(epochToken);
+  AtomicDec(entry->fastStructLockWaitersCount);
+
+  return !newReplicas->empty();
+}
+
+bool GeoTreeEngine::isPlacementCurrent( FsGroup* group, size_t generation)
+{
+  RWMutexReadLock lock(this->pTreeMapMutex);
+  if(!pGroup2SchedTME.count(group))
+  return false;
+  return AtomicGet(pGroup2SchedTME[group]->fastStructGeneration) == generation;
+}
+
+void GeoTreeEngine::applyPlacementPenaltiesOneGroup( FsGroup* group,
+    const vector<FileSystem::fsid_t> &replicas)
+{
+  // find the entry in the map
+  tlCurrentGroup = group;
+  SchedTME *entry;
+  {
+    RWMutexReadLock lock(this->pTreeMapMutex);
+    if(!pGroup2SchedTME.count(group))
+    {
+      eos_err("could not find the requested placement group in the map");
+      return;
+    }
+    entry = pGroup2SchedTME[group];
+    AtomicInc(entry->fastStructLockWaitersCount);
+  }
+
+  // enter the read-side section of the original fast structure
+  SchedulingEpoch::tToken epochToken = entry->fastStructEpoch.ReadLock();
+  FastStructSched *fg = SchedulingEpoch::Dereference(entry->foregroundFastStruct);
+
+  // update the fastTree UlScore and DlScore by applying the penalties
+  // the way placeNewReplicasOneGroup does
+  for(auto it = replicas.begin(); it != replicas.end(); ++it)
+  {
+    const SchedTreeBase::tFastTreeIdx *idx;
+    // the fs might have left the group since it was placed
+    if(!fg->fs2TreeIdx->get(*it,idx))
+    continue;
+    const char netSpeedClass = (*fg->treeInfo)[*idx].netSpeedClass;
+    if(fg->placementTree->pNodes[*idx].fsData.dlScore>0)
+    fg->applyDlScorePenalty(*idx,pPenaltySched.pPlctDlScorePenalty[netSpeedClass],false);
+    if(fg->placementTree->pNodes[*idx].fsData.ulScore>0)
+    fg->applyUlScorePenalty(*idx,pPenaltySched.pPlctUlScorePenalty[netSpeedClass],false);
+  }
+
+  // unlock, cleanup
+  entry->fastStructEpoch.ReadUnlock(epochToken);
+  AtomicDec(entry->fastStructLockWaitersCount);
+}
+
+bool GeoTreeEngine::placeProxiesOneGroup( FsGroup* group,
+    const vector<FileSystem::fsid_t> &replicas,
+    ino64_t inode,
+    std::vector<std::string> *dataProxys,
+    std::vector<std::string> *firewallEntryPoint,
+    const std::string &clientGeoTag)
+{
+  if(!dataProxys && !firewallEntryPoint)
+  return true;
+
+  // find the entry in the map
+  tlCurrentGroup = group;
+  SchedTME *entry;
+  {
+    RWMutexReadLock lock(this->pTreeMapMutex);
+    if(!pGroup2SchedTME.count(group))
+    {
+      eos_err("could not find the requested placement group in the map");
+      return false;
+    }
+    entry = pGroup2SchedTME[group];
+    AtomicInc(entry->fastStructLockWaitersCount);
   }
 
+  // enter the read-side section of the original fast structure
+  SchedulingEpoch::tToken epochToken = entry->fastStructEpoch.ReadLock();
+  FastStructSched *fg = SchedulingEpoch::Dereference(entry->foregroundFastStruct);
+
+  bool success = true;
+  vector<SchedTreeBase::tFastTreeIdx> replicasIdx;
+  for(auto it = replicas.begin(); it != replicas.end(); ++it)
+  {
+    const SchedTreeBase::tFastTreeIdx *idx;
+    if(!fg->fs2TreeIdx->get(*it,idx))
+    {
+      // the fs left the group since it was placed
+      eos_debug("could not find fs %lu in the fast tree",(unsigned long)*it);
+      success = false;
+      break;
+    }
+    replicasIdx.push_back(*idx);
+  }
+
+  if(success)
+  success = placeProxies(replicasIdx, fg, inode, dataProxys, firewallEntryPoint, clientGeoTag);
+
+  // unlock, cleanup
+  entry->fastStructEpoch.ReadUnlock(epochToken);
+  AtomicDec(entry->fastStructLockWaitersCount);
+
+  return success;
+}
+
+bool GeoTreeEngine::placeProxies(const std::vector<SchedTreeBase::tFastTreeIdx> &newReplicasIdx,
+    FastStructSched *fg,
+    ino64_t inode,
+    std::vector<std::string> *dataProxys,
+    std::vector<std::string> *firewallEntryPoint,
+    const std::string &clientGeoTag)
+{
+  // a read-side section is supposed to be entered on the fast structures fg comes from
+  std::vector<FastStructSched*> entries;
+
   if(dataProxys || firewallEntryPoint )
-    entries.assign(newReplicasIdx.size(),entry);
+    entries.assign(newReplicasIdx.size(),fg);
 
   // find proxy for filesticky scheduling
   if(dataProxys)
   {
     if(!findProxy(newReplicasIdx, entries, inode,dataProxys,NULL,pProxyCloseToFs?"":clientGeoTag,filesticky))
     {
-      success = false;
-      goto cleanup;
+      return false;
     }
   }
 
@@ -952,9 +1176,9 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
     for(size_t i=0; i<newReplicasIdx.size(); i++ )
     {
       if( clientGeoTag.empty() ||
-          accessReqFwEP((*entries[i]->foregroundFastStruct->treeInfo)[newReplicasIdx[i]].fullGeotag , clientGeoTag ))
+          accessReqFwEP((*entries[i]->treeInfo)[newReplicasIdx[i]].fullGeotag , clientGeoTag ))
       {
-        firewallProxyGroups[i]=accessGetProxygroup( (*entries[i]->foregroundFastStruct->treeInfo)[newReplicasIdx[i]].fullGeotag);
+        firewallProxyGroups[i]=accessGetProxygroup( (*entries[i]->treeInfo)[newReplicasIdx[i]].fullGeotag);
       }
     }
 
@@ -963,8 +1187,7 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
       *firewallEntryPoint=*dataProxys;
     if(!findProxy(newReplicasIdx, entries, inode, firewallEntryPoint,&firewallProxyGroups,pProxyCloseToFs?"":clientGeoTag,any))
     {
-      success = false;
-      goto cleanup;
+      return false;
     }
   }
 
@@ -977,21 +1200,11 @@ bool GeoTreeEngine::placeNewReplicasOneGroup( FsGroup* group, const size_t &nNew
       *dataProxys=*firewallEntryPoint;
     if(!findProxy(newReplicasIdx, entries, inode, dataProxys,NULL,pProxyCloseToFs?"":clientGeoTag,regular))
     {
-      success = false;
-      goto cleanup;
+      return false;
     }
   }
 
-  // unlock, cleanup
-  cleanup:
-  if(!success) newReplicas->clear();
-  entry->doubleBufferMutex.UnLockRead();
-  AtomicDec(entry->fastStructLockWaitersCount);
-  if(existingReplicasIdx) delete existingReplicasIdx;
-  if(excludeFsIdx) delete excludeFsIdx;
-  if(forceBrIdx) delete forceBrIdx;
-
-  return success;
+  return true;
 }
 
 // would be better as defined locally in find Proxy
@@ -1006,7 +1219,7 @@ struct TreeInfoFsIdComparator
 };
 
 bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fsIdxs,
-    std::vector<SchedTME *> entries,
+    std::vector<FastStructSched *> entries,
     ino64_t inode,
     std::vector<std::string> *dataProxys,
     std::vector<std::string> *proxyGroups,
@@ -1018,6 +1231,8 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
 
   const std::string *fsproxygroup = 0;
   DataProxyTME *pxyentry = NULL;
+  FastStructProxy *pxyfg = NULL;
+  SchedulingEpoch::tToken pxyToken = 0;
   FastGatewayAccessTree *tree=NULL;
 
   std::string sgeotag;
@@ -1025,7 +1240,7 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
   {
     const std::string *geotag=NULL;
     // get the proxygroup
-    // WARNING: entries[i]->doubleBufferMutex should be locked by the caller of findProxy
+    // WARNING: entries[i] should be in a read-side section entered by the caller of findProxy
 
     if(!(*dataProxys)[i].empty() && (*dataProxys)[i]!="<none>")
     {
@@ -1050,17 +1265,18 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
         {
           auto entry = (*TMEs.begin());
           // we don't want to lock the pxyentry which is already locked
+          SchedulingEpoch::tToken token = 0;
           if(entry!=pxyentry)
           {
             AtomicInc(entry->fastStructLockWaitersCount);
-            entry->doubleBufferMutex.LockRead();
+            token = entry->fastStructEpoch.ReadLock();
           }
           // if they don't, take their geotag as a staring point
           sgeotag = (*TMEs.begin())->host2SlowTreeNode[(*dataProxys)[i]]->pNodeInfo.fullGeotag;
           geotag = &sgeotag;
           if(entry!=pxyentry)
           {
-            entry->doubleBufferMutex.UnLockRead();
+            entry->fastStructEpoch.ReadUnlock(token);
             AtomicDec(entry->fastStructLockWaitersCount);
           }
         }
@@ -1070,7 +1286,7 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
     if(proxyGroups)
     fsproxygroup = &((*proxyGroups)[i]);
     else
-    fsproxygroup = & (*entries[i]->foregroundFastStruct->treeInfo)[fsIdxs[i]].proxygroup;
+    fsproxygroup = & (*entries[i]->treeInfo)[fsIdxs[i]].proxygroup;
 
     if(fsproxygroup->empty() || (*fsproxygroup)=="<none>")    // no proxygroup, nothing to do, there will be an entry with an empty string)
     {
@@ -1079,7 +1295,7 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
     }
     // if we don't have a proxy to match, if a client geotag is given then use it else use the file system client
     bool trimlastlevel = geotag || (!geotag && clientgeotag.empty());
-    if(!geotag) geotag = (clientgeotag.empty()?&((*(entries[i]->foregroundFastStruct->treeInfo))[fsIdxs[i]].fullGeotag):&clientgeotag);
+    if(!geotag) geotag = (clientgeotag.empty()?&((*(entries[i]->treeInfo))[fsIdxs[i]].fullGeotag):&clientgeotag);
     // the deepest intermediate node is a numeric id for both scheduling and GW trees and they are unrelated
     // we don't want to keep this to project the fst location on the gw tree as it would not make sense
 
@@ -1094,13 +1310,14 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
     }
     pxyentry = pPxyGrp2DpTME[*fsproxygroup];
     AtomicInc(pxyentry->fastStructLockWaitersCount);
-    // readlock the original fast structure
-    pxyentry->doubleBufferMutex.LockRead();
+    // enter the read-side section of the original fast structure
+    pxyToken = pxyentry->fastStructEpoch.ReadLock();
+    pxyfg = SchedulingEpoch::Dereference(pxyentry->foregroundFastStruct);
     // copy the fasttree
-    if(pxyentry->foregroundFastStruct->proxyAccessTree->copyToBuffer((char*)tlGeoBuffer,gGeoBufferSize))
+    if(pxyfg->proxyAccessTree->copyToBuffer((char*)tlGeoBuffer,gGeoBufferSize))
     {
       eos_crit("could not make a working copy of the fast tree for proxygroup %s",fsproxygroup->c_str());
-      pxyentry->doubleBufferMutex.UnLockRead();
+      pxyentry->fastStructEpoch.ReadUnlock(pxyToken);
       AtomicDec(pxyentry->fastStructLockWaitersCount);
       return false;
     }
@@ -1108,7 +1325,7 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
 
     // get the closest node from the filesystem
     SchedTreeBase::tFastTreeIdx idx;
-    idx=pxyentry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(
+    idx=pxyfg->tag2NodeIdx->getClosestFastTreeNode(
         trimlastlevel?std::string(*geotag,0,geotag->rfind("::")).c_str():geotag->c_str() );
     bool schedsuccess=false;
     if( proxyschedtype==filesticky )
@@ -1117,17 +1334,17 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
       // this is to do the caching of the file only on one proxy
       // serving a same file from two proxies is not optimal but it is not mendatory neither
 
-      if( (*entries[i]->foregroundFastStruct->treeInfo)[fsIdxs[i]].fileStickyProxyDepth<0 )
+      if( (*entries[i]->treeInfo)[fsIdxs[i]].fileStickyProxyDepth<0 )
       schedsuccess = true;
       // first find the best proxy
       else
       {
         // then consider all the possible proxy in the same proxygroup
         // within the subtree starting at the best proxy and going uproot by
-        // (*pxyentry->foregroundFastStruct->treeInfo)[idx].fileStickyProxyDepth
+        // (*pxyfg->treeInfo)[idx].fileStickyProxyDepth
 
         // allocate a vectors to get the proxies
-        auto s=pxyentry->foregroundFastStruct->treeInfo->size();
+        auto s=pxyfg->treeInfo->size();
         std::vector<SchedTreeBase::tFastTreeIdx> proxiesIdxs(s),upRootLevels(s),upRootLevelsIdxs(s);
         SchedTreeBase::tFastTreeIdx upRootLevelsCount=0;
         SchedTreeBase::tFastTreeIdx np=0;
@@ -1145,8 +1362,8 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
               ss << " all proxys are:";
               for(auto it=proxiesIdxs.begin();it!=proxiesIdxs.end();it++)
               {
-                ss << (*pxyentry->foregroundFastStruct->treeInfo)[*it].hostport;
-                ss << "(" << (*pxyentry->foregroundFastStruct->treeInfo)[*it].fullGeotag <<")";
+                ss << (*pxyfg->treeInfo)[*it].hostport;
+                ss << "(" << (*pxyfg->treeInfo)[*it].fullGeotag <<")";
                 if(it!=proxiesIdxs.end()-1) ss << ",";
               }
               ss << " upRootLevels are:";
@@ -1169,7 +1386,7 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
             int uprlev = 0;
             while(
                 uprlev<upRootLevelsCount &&
-                upRootLevels[uprlev]<=(*entries[i]->foregroundFastStruct->treeInfo)[fsIdxs[i]].fileStickyProxyDepth
+                upRootLevels[uprlev]<=(*entries[i]->treeInfo)[fsIdxs[i]].fileStickyProxyDepth
             ) uprlev++;
 
             if(uprlev==0)
@@ -1185,26 +1402,26 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
               else
               proxiesIdxs.resize(np);
               // sort the proxies by fsid
-              TreeInfoFsIdComparator cmp(pxyentry->foregroundFastStruct->treeInfo);
+              TreeInfoFsIdComparator cmp(pxyfg->treeInfo);
               std::sort(proxiesIdxs.begin(),proxiesIdxs.end(),cmp);
               // take the proxy
               idx=proxiesIdxs[inode%proxiesIdxs.size()];
               // if it succeeds, feel the corresponding element of the return vector
-              (*dataProxys)[i]=(*pxyentry->foregroundFastStruct->treeInfo)[idx].hostport;
+              (*dataProxys)[i]=(*pxyfg->treeInfo)[idx].hostport;
               if(eos::common::Logging::gLogMask & LOG_MASK(LOG_DEBUG))
               {
                 stringstream ss;
-                ss << "file sticky proxy scheduling fs:" << (*entries[i]->foregroundFastStruct->treeInfo)[fsIdxs[i]].fsId;
-                ss << " | fileStickyProxyDepth:"<<(int)(*entries[i]->foregroundFastStruct->treeInfo)[fsIdxs[i]].fileStickyProxyDepth;
+                ss << "file sticky proxy scheduling fs:" << (*entries[i]->treeInfo)[fsIdxs[i]].fsId;
+                ss << " | fileStickyProxyDepth:"<<(int)(*entries[i]->treeInfo)[fsIdxs[i]].fileStickyProxyDepth;
                 ss << " | possible proxys are:";
                 for(auto it=proxiesIdxs.begin();it!=proxiesIdxs.end();it++)
                 {
-                  ss << (*pxyentry->foregroundFastStruct->treeInfo)[*it].hostport;
-                  ss << "(" << (*pxyentry->foregroundFastStruct->treeInfo)[*it].fullGeotag <<")";
+                  ss << (*pxyfg->treeInfo)[*it].hostport;
+                  ss << "(" << (*pxyfg->treeInfo)[*it].fullGeotag <<")";
                   if(it!=proxiesIdxs.end()-1) ss << ",";
                 }
                 ss << " | inode:" << inode;
-                ss << " | selected host is:"<<(*pxyentry->foregroundFastStruct->treeInfo)[idx].hostport;
+                ss << " | selected host is:"<<(*pxyfg->treeInfo)[idx].hostport;
                 eos_debug("%s",ss.str().c_str());
               }
             }
@@ -1215,18 +1432,18 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
     else
     {
       if( proxyschedtype==any
-          || ( (*entries[i]->foregroundFastStruct->treeInfo)[fsIdxs[i]].fileStickyProxyDepth<0 && proxyschedtype==regular) )
+          || ( (*entries[i]->treeInfo)[fsIdxs[i]].fileStickyProxyDepth<0 && proxyschedtype==regular) )
       {
         // get the proxy
         if(!(schedsuccess=tree->findFreeSlot(idx, idx, true /*allow uproot if necessary*/, false, true /*skipSaturated*/)))
         {
-          (*dataProxys)[i]=(*pxyentry->foregroundFastStruct->treeInfo)[idx].hostport;
+          (*dataProxys)[i]=(*pxyfg->treeInfo)[idx].hostport;
         }
         else
         {
           if((schedsuccess=tree->findFreeSlot(idx, idx, true /*allow uproot if necessary*/, false, false /*skipSaturated*/)))
           // if it succeeds, feel the corresponding element of the return vector
-          (*dataProxys)[i]=(*pxyentry->foregroundFastStruct->treeInfo)[idx].hostport;
+          (*dataProxys)[i]=(*pxyfg->treeInfo)[idx].hostport;
         }
       }
       else
@@ -1240,13 +1457,13 @@ bool GeoTreeEngine::findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fs
       std::stringstream ss;
       ss<<"tree is as follow\n"<<(*tree);
       eos_err(ss.str().c_str());
-      pxyentry->doubleBufferMutex.UnLockRead();
+      pxyentry->fastStructEpoch.ReadUnlock(pxyToken);
       AtomicDec(pxyentry->fastStructLockWaitersCount);
       return false;
     }
 
     // unlock it for each new fs
-    pxyentry->doubleBufferMutex.UnLockRead();
+    pxyentry->fastStructEpoch.ReadUnlock(pxyToken);
     AtomicDec(pxyentry->fastStructLockWaitersCount);
   }
 
@@ -1292,8 +1509,9 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
     AtomicInc(entry->fastStructLockWaitersCount);
   }
 
-  // readlock the original fast structure
-  entry->doubleBufferMutex.LockRead();
+  // enter the read-side section of the original fast structure
+  SchedulingEpoch::tToken epochToken = entry->fastStructEpoch.ReadLock();
+  FastStructSched *fg = SchedulingEpoch::Dereference(entry->foregroundFastStruct);
 
   // locate the existing replicas and the excluded fs in the tree
   vector<SchedTreeBase::tFastTreeIdx> accessedReplicasIdx(nAccessReplicas),*existingReplicasIdx=NULL,*excludeFsIdx=NULL,*forceBrIdx=NULL;
@@ -1305,7 +1523,7 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
     for(auto it = existingReplicas->begin(); it != existingReplicas->end(); ++it)
     {
       const SchedTreeBase::tFastTreeIdx *idx;
-      if(!entry->foregroundFastStruct->fs2TreeIdx->get(*it,idx))
+      if(!fg->fs2TreeIdx->get(*it,idx))
       {
 	eos_warning("could not place preexisting replica on the fast tree");
 	continue;
@@ -1320,7 +1538,7 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
     for(auto it = excludeFs->begin(); it != excludeFs->end(); ++it)
     {
       const SchedTreeBase::tFastTreeIdx *idx;
-      if(!entry->foregroundFastStruct->fs2TreeIdx->get(*it,idx))
+      if(!fg->fs2TreeIdx->get(*it,idx))
       {
 	eos_warning("could not place excluded fs on the fast tree");
 	continue;
@@ -1338,7 +1556,7 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
     for(auto it = excludeGeoTags->begin(); it != excludeGeoTags->end(); ++it)
     {
       SchedTreeBase::tFastTreeIdx idx;
-      idx=entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
+      idx=fg->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
       excludeFsIdx->push_back(idx);
     }
   }
@@ -1349,13 +1567,13 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
     for(auto it = forceGeoTags->begin(); it != forceGeoTags->end(); ++it)
     {
       SchedTreeBase::tFastTreeIdx idx;
-      idx=entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
+      idx=fg->tag2NodeIdx->getClosestFastTreeNode(it->c_str());
       forceBrIdx->push_back(idx);
     }
   }
 
   // find the closest tree node to the accesser
-  SchedTreeBase::tFastTreeIdx accesserNode = entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(accesserGeotag.c_str());;
+  SchedTreeBase::tFastTreeIdx accesserNode = fg->tag2NodeIdx->getClosestFastTreeNode(accesserGeotag.c_str());;
 
   // actually do the job
   unsigned char success = 0;
@@ -1363,19 +1581,19 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
   {
     case regularRO:
     success = accessReplicas(entry,nAccessReplicas,&accessedReplicasIdx,accesserNode,existingReplicasIdx,
-	entry->foregroundFastStruct->rOAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedAccess);
+	fg->rOAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedAccess);
     break;
     case regularRW:
     success = accessReplicas(entry,nAccessReplicas,&accessedReplicasIdx,accesserNode,existingReplicasIdx,
-	entry->foregroundFastStruct->rWAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedAccess);
+	fg->rWAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedAccess);
     break;
     case draining:
     success = accessReplicas(entry,nAccessReplicas,&accessedReplicasIdx,accesserNode,existingReplicasIdx,
-	entry->foregroundFastStruct->drnAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedDrnAccess);
+	fg->drnAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedDrnAccess);
     break;
     case balancing:
     success = accessReplicas(entry,nAccessReplicas,&accessedReplicasIdx,accesserNode,existingReplicasIdx,
-	entry->foregroundFastStruct->blcAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedBlcAccess);
+	fg->blcAccessTree,excludeFsIdx,forceBrIdx,pSkipSaturatedBlcAccess);
     break;
     default:
     ;
@@ -1388,25 +1606,25 @@ bool GeoTreeEngine::accessReplicasOneGroup(FsGroup* group, const size_t &nAccess
   for(auto it = accessedReplicasIdx.begin(); it != accessedReplicasIdx.end(); ++it)
   {
     const SchedTreeBase::tFastTreeIdx *idx=NULL;
-    const unsigned int fsid = (*entry->foregroundFastStruct->treeInfo)[*it].fsId;
-    if(!entry->foregroundFastStruct->fs2TreeIdx->get(fsid,idx))
+    const unsigned int fsid = (*fg->treeInfo)[*it].fsId;
+    if(!fg->fs2TreeIdx->get(fsid,idx))
     {
       eos_crit("inconsistency : cannot retrieve index of selected fs though it should be in the tree");
       success = false;
       goto cleanup;
     }
-    const char netSpeedClass = (*entry->foregroundFastStruct->treeInfo)[*idx].netSpeedClass;
+    const char netSpeedClass = (*fg->treeInfo)[*idx].netSpeedClass;
     accessedReplicas->push_back(fsid);
     // apply the penalties
-    if(entry->foregroundFastStruct->placementTree->pNodes[*idx].fsData.dlScore>=pPenaltySched.pAccessDlScorePenalty[netSpeedClass])
-    applyDlScorePenalty(entry,*idx,pPenaltySched.pAccessDlScorePenalty[netSpeedClass]);
-    if(entry->foregroundFastStruct->placementTree->pNodes[*idx].fsData.ulScore>=pPenaltySched.pAccessUlScorePenalty[netSpeedClass])
-    applyUlScorePenalty(entry,*idx,pPenaltySched.pAccessUlScorePenalty[netSpeedClass]);
+    if(fg->placementTree->pNodes[*idx].fsData.dlScore>=pPenaltySched.pAccessDlScorePenalty[netSpeedClass])
+    fg->applyDlScorePenalty(*idx,pPenaltySched.pAccessDlScorePenalty[netSpeedClass],false);
+    if(fg->placementTree->pNodes[*idx].fsData.ulScore>=pPenaltySched.pAccessUlScorePenalty[netSpeedClass])
+    fg->applyUlScorePenalty(*idx,pPenaltySched.pAccessUlScorePenalty[netSpeedClass],false);
   }
 
   // unlock, cleanup
   cleanup:
-  entry->doubleBufferMutex.UnLockRead();
+  entry->fastStructEpoch.ReadUnlock(epochToken);
   AtomicDec(entry->fastStructLockWaitersCount);
   if(existingReplicasIdx) delete existingReplicasIdx;
   if(excludeFsIdx) delete excludeFsIdx;
@@ -1456,12 +1674,15 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
   std::vector<eos::common::FileSystem::fsid_t>::iterator it;
   std::vector<SchedTreeBase::tFastTreeIdx> ERIdx;
   ERIdx.reserve(existingReplicas->size());
-  std::vector<SchedTME*> entries;
+  std::vector<FastStructSched*> entries;
   entries.reserve(existingReplicas->size());
 
   // maps tree maps entries (i.e. scheduling groups) to fsids containing a replica being available and the corresponding fastTreeIndex
   map<SchedTME*,vector< pair<FileSystem::fsid_t,SchedTreeBase::tFastTreeIdx> > > entry2FsId;
+  // maps tree maps entries to their read-side section and to the foreground fast structures seen when entering it
+  map<SchedTME*,pair<SchedulingEpoch::tToken,FastStructSched*> > entry2Fg;
   SchedTME *entry=NULL;
+  FastStructSched *fg=NULL;
   {
     // lock the scheduling group -> trees map so that the a map entry cannot be delete while processing it
     RWMutexReadLock lock(this->pTreeMapMutex);
@@ -1476,29 +1697,26 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
       }
       entry = mentry->second;
 
-      // lock the double buffering to make sure all the fast trees are not modified
-      if(!entry2FsId.count(entry))
+      // enter the read-side section to make sure the fast trees we use are not modified
+      if(!entry2Fg.count(entry))
       {
-	// if the entry is already there, it was locked already
-	entry->doubleBufferMutex.LockRead();
+	// if the entry is already there, the section was entered already
+	SchedulingEpoch::tToken token = entry->fastStructEpoch.ReadLock();
+	entry2Fg[entry] = make_pair(token,SchedulingEpoch::Dereference(entry->foregroundFastStruct));
 	// to prevent the destruction of the entry
 	AtomicInc(entry->fastStructLockWaitersCount);
       }
+      fg = entry2Fg[entry].second;
 
       const SchedTreeBase::tFastTreeIdx *idx;
-      if(!entry->foregroundFastStruct->fs2TreeIdx->get(*exrepIt,idx) )
+      if(!fg->fs2TreeIdx->get(*exrepIt,idx) )
       {
 	eos_warning("cannot find fs in the scheduling group in the 2nd pass");
-	if(!entry2FsId.count(entry))
-	{
-	  entry->doubleBufferMutex.UnLockRead();
-	  AtomicDec(entry->fastStructLockWaitersCount);
-	}
 	continue;
       }
       // take the fastindex of each existing replica
       ERIdx.push_back(*idx);
-      entries.push_back(entry);
+      entries.push_back(fg);
 
       // check if the fs is available
       bool isValid = false;
@@ -1507,16 +1725,16 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
         switch(type)
         {
           case regularRO:
-          isValid = entry->foregroundFastStruct->rOAccessTree->pBranchComp.isValidSlot(&entry->foregroundFastStruct->rOAccessTree->pNodes[*idx].fsData,&freeSlot);
+          isValid = fg->rOAccessTree->pBranchComp.isValidSlot(&fg->rOAccessTree->pNodes[*idx].fsData,&freeSlot);
           break;
           case regularRW:
-          isValid = entry->foregroundFastStruct->rWAccessTree->pBranchComp.isValidSlot(&entry->foregroundFastStruct->rWAccessTree->pNodes[*idx].fsData,&freeSlot);
+          isValid = fg->rWAccessTree->pBranchComp.isValidSlot(&fg->rWAccessTree->pNodes[*idx].fsData,&freeSlot);
           break;
           case draining:
-          isValid = entry->foregroundFastStruct->drnAccessTree->pBranchComp.isValidSlot(&entry->foregroundFastStruct->drnAccessTree->pNodes[*idx].fsData,&freeSlot);
+          isValid = fg->drnAccessTree->pBranchComp.isValidSlot(&fg->drnAccessTree->pNodes[*idx].fsData,&freeSlot);
           break;
           case balancing:
-          isValid = entry->foregroundFastStruct->blcAccessTree->pBranchComp.isValidSlot(&entry->foregroundFastStruct->blcAccessTree->pNodes[*idx].fsData,&freeSlot);
+          isValid = fg->blcAccessTree->pBranchComp.isValidSlot(&fg->blcAccessTree->pNodes[*idx].fsData,&freeSlot);
           break;
           default:
           break;
@@ -1563,6 +1781,8 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
       vector<SchedTreeBase::tFastTreeIdx> accessedReplicasIdx(1);
       for(auto entryIt = entry2FsId.begin(); entryIt != entry2FsId.end(); entryIt ++)
       {
+        fg = entry2Fg[entryIt->first].second;
+
         if(eos::common::Logging::gLogMask & LOG_MASK(LOG_DEBUG))
         {
           char buffer[1024];
@@ -1575,7 +1795,7 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
           buffer[0]=0;
           buf = buffer;
           for(auto it = entryIt->second.begin(); it!= entryIt->second.end(); ++it)
-          buf += sprintf(buf,"%s  ",(*entryIt->first->foregroundFastStruct->treeInfo)[it->second].fullGeotag.c_str());
+          buf += sprintf(buf,"%s  ",(*fg->treeInfo)[it->second].fullGeotag.c_str());
           eos_debug("existing replicas geotags in geotree -> %s", buffer);
         }
 
@@ -1586,7 +1806,7 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
         entry = entryIt->first;
 
         // find the closest tree node to the accesser
-        accesserNode = entry->foregroundFastStruct->tag2NodeIdx->getClosestFastTreeNode(accesserGeotag.c_str());;
+        accesserNode = fg->tag2NodeIdx->getClosestFastTreeNode(accesserGeotag.c_str());;
 
         // fill a vector with the indices of the replicas
         vector<SchedTreeBase::tFastTreeIdx> existingReplicasIdx(entryIt->second.size());
@@ -1600,26 +1820,26 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
         {
           case regularRO:
           retCode = accessReplicas(entryIt->first,1,&accessedReplicasIdx,accesserNode,&existingReplicasIdx,
-              entry->foregroundFastStruct->rOAccessTree,NULL,NULL,pSkipSaturatedAccess);
+              fg->rOAccessTree,NULL,NULL,pSkipSaturatedAccess);
           break;
           case regularRW:
           retCode = accessReplicas(entryIt->first,1,&accessedReplicasIdx,accesserNode,&existingReplicasIdx,
-              entry->foregroundFastStruct->rWAccessTree,NULL,NULL,pSkipSaturatedAccess);
+              fg->rWAccessTree,NULL,NULL,pSkipSaturatedAccess);
           break;
           case draining:
           retCode = accessReplicas(entryIt->first,1,&accessedReplicasIdx,accesserNode,&existingReplicasIdx,
-              entry->foregroundFastStruct->drnAccessTree,NULL,NULL,pSkipSaturatedDrnAccess);
+              fg->drnAccessTree,NULL,NULL,pSkipSaturatedDrnAccess);
           break;
           case balancing:
           retCode = accessReplicas(entryIt->first,1,&accessedReplicasIdx,accesserNode,&existingReplicasIdx,
-              entry->foregroundFastStruct->blcAccessTree,NULL,NULL,pSkipSaturatedBlcAccess);
+              fg->blcAccessTree,NULL,NULL,pSkipSaturatedBlcAccess);
           break;
           default:
           break;
         }
         if(!retCode) goto cleanup;
 
-        const string &fsGeotag = (*entryIt->first->foregroundFastStruct->treeInfo)[*accessedReplicasIdx.begin()].fullGeotag;
+        const string &fsGeotag = (*fg->treeInfo)[*accessedReplicasIdx.begin()].fullGeotag;
         unsigned geoScore = 0;
         size_t kmax = min(accesserGeotag.length(),fsGeotag.length());
         for(size_t k=0; k<kmax; k++)
@@ -1637,7 +1857,7 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
         }
 
         geoScore2Fs[geoScore].push_back(
-            (*entryIt->first->foregroundFastStruct->treeInfo)[*accessedReplicasIdx.begin()].fsId);
+            (*fg->treeInfo)[*accessedReplicasIdx.begin()].fsId);
       }
 
       // randomly choose a fs among the highest scored ones
@@ -1671,7 +1891,7 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
       buf += sprintf(buf,"%lu  ",(unsigned long)(*it));
 
       eos_debug("existing replicas fs id's -> %s", buffer);
-      eos_debug("accesser closest node to %s index -> %d  /  %s",accesserGeotag.c_str(), (int)accesserNode,(*entry->foregroundFastStruct->treeInfo)[accesserNode].fullGeotag.c_str());
+      eos_debug("accesser closest node to %s index -> %d  /  %s",accesserGeotag.c_str(), (int)accesserNode,(*fg->treeInfo)[accesserNode].fullGeotag.c_str());
       eos_debug("selected FsId -> %d / idx %d", (int)selectedFsId,(int)fsIndex);
     }
   }
@@ -1693,21 +1913,21 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
       //////////
       // apply the penalties
       //////////
-      if(!pFs2SchedTME.count(fs))
+      if(!pFs2SchedTME.count(fs) || !entry2Fg.count(pFs2SchedTME[fs]))
         continue;
-      entry = pFs2SchedTME[fs];
+      fg = entry2Fg[pFs2SchedTME[fs]].second;
       const SchedTreeBase::tFastTreeIdx *idx;
-      if(entry->foregroundFastStruct->fs2TreeIdx->get(fs,idx))
+      if(fg->fs2TreeIdx->get(fs,idx))
       {
-        const char netSpeedClass = (*entry->foregroundFastStruct->treeInfo)[*idx].netSpeedClass;
+        const char netSpeedClass = (*fg->treeInfo)[*idx].netSpeedClass;
         // every available box will push data
-        if(entry->foregroundFastStruct->placementTree->pNodes[*idx].fsData.ulScore>=pPenaltySched.pAccessUlScorePenalty[netSpeedClass])
-        applyUlScorePenalty(entry,*idx,pPenaltySched.pAccessUlScorePenalty[netSpeedClass]);
+        if(fg->placementTree->pNodes[*idx].fsData.ulScore>=pPenaltySched.pAccessUlScorePenalty[netSpeedClass])
+        fg->applyUlScorePenalty(*idx,pPenaltySched.pAccessUlScorePenalty[netSpeedClass],false);
         // every available box will have to pull data if it's a RW access (or if it's a gateway)
         if( (type==regularRW) || (j==fsIndex && nAccessReplicas>1) )
         {
-          if(entry->foregroundFastStruct->placementTree->pNodes[*idx].fsData.dlScore>=pPenaltySched.pAccessDlScorePenalty[netSpeedClass])
-          applyDlScorePenalty(entry,*idx,pPenaltySched.pAccessDlScorePenalty[netSpeedClass]);
+          if(fg->placementTree->pNodes[*idx].fsData.dlScore>=pPenaltySched.pAccessDlScorePenalty[netSpeedClass])
+          fg->applyDlScorePenalty(*idx,pPenaltySched.pAccessDlScorePenalty[netSpeedClass],false);
         }
       }
       else
@@ -1735,9 +1955,9 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
     for(size_t i=0; i<ERIdx.size(); i++ )
     {
       if( accesserGeotag.empty() ||
-          accessReqFwEP((*entries[i]->foregroundFastStruct->treeInfo)[ERIdx[i]].fullGeotag , accesserGeotag ))
+          accessReqFwEP((*entries[i]->treeInfo)[ERIdx[i]].fullGeotag , accesserGeotag ))
       {
-        firewallProxyGroups[i]=accessGetProxygroup( (*entries[i]->foregroundFastStruct->treeInfo)[ERIdx[i]].fullGeotag);
+        firewallProxyGroups[i]=accessGetProxygroup( (*entries[i]->treeInfo)[ERIdx[i]].fullGeotag);
       }
     }
 
@@ -1766,9 +1986,9 @@ int GeoTreeEngine::accessHeadReplicaMultipleGroup(const size_t &nAccessReplicas,
 
   // cleanup and exit
   cleanup:
-  for(auto cit = entry2FsId.begin(); cit != entry2FsId.end(); cit++ )
+  for(auto cit = entry2Fg.begin(); cit != entry2Fg.end(); cit++ )
   {
-    cit->first->doubleBufferMutex.UnLockRead();
+    cit->first->fastStructEpoch.ReadUnlock(cit->second.first);
     AtomicDec(cit->first->fastStructLockWaitersCount);
   }
   return returnCode;
@@ -2598,7 +2818,7 @@ bool GeoTreeEngine::updateTreeInfo(const map<string,int> &updatesFs, const map<s
 
     // update only the fast structures because even if a fast structure rebuild is needed from the slow tree
     // its information and state is updated from the fast structures
-    entry->doubleBufferMutex.LockRead();
+    SchedulingEpoch::tToken token = entry->fastStructEpoch.ReadLock();
     const SchedTreeBase::tFastTreeIdx *idx=NULL;
     SlowTreeNode *node=NULL;
     if( !entry->backgroundFastStruct->fs2TreeIdx->get(fsid,idx) )
@@ -2607,7 +2827,7 @@ bool GeoTreeEngine::updateTreeInfo(const map<string,int> &updatesFs, const map<s
       if(nodeit == entry->fs2SlowTreeNode.end())
       {
         eos_crit("Inconsistency : cannot locate an fs %lu supposed to be in the fast structures",(unsigned long)fsid);
-        entry->doubleBufferMutex.UnLockRead();
+        entry->fastStructEpoch.ReadUnlock(token);
         AtomicDec(entry->fastStructLockWaitersCount);
         return false;
       }
@@ -2622,7 +2842,7 @@ bool GeoTreeEngine::updateTreeInfo(const map<string,int> &updatesFs, const map<s
     if(idx) entry->fastStructModified = true;
     if(node) entry->slowTreeModified = true;
     // if we update the slowtree, then a fast tree generation is already pending
-    entry->doubleBufferMutex.UnLockRead();
+    entry->fastStructEpoch.ReadUnlock(token);
     AtomicDec(entry->fastStructLockWaitersCount);
   }
   // => PROXYGROUPS
@@ -2667,7 +2887,7 @@ bool GeoTreeEngine::updateTreeInfo(const map<string,int> &updatesFs, const map<s
 
       // update only the fast structures because even if a fast structure rebuild is needed from the slow tree
       // its information and state is updated from the fast structures
-      entry->doubleBufferMutex.LockRead();
+      SchedulingEpoch::tToken token = entry->fastStructEpoch.ReadLock();
       const SchedTreeBase::tFastTreeIdx *idx=NULL;
       SlowTreeNode *node=NULL;
       if( !entry->backgroundFastStruct->host2TreeIdx->get(host.c_str(),idx) )
@@ -2676,7 +2896,7 @@ bool GeoTreeEngine::updateTreeInfo(const map<string,int> &updatesFs, const map<s
         if(nodeit == entry->host2SlowTreeNode.end())
         {
           eos_crit("Inconsistency : cannot locate an host: %s supposed to be in the fast structures",host.c_str());
-          entry->doubleBufferMutex.UnLockRead();
+          entry->fastStructEpoch.ReadUnlock(token);
           AtomicDec(entry->fastStructLockWaitersCount);
           return false;
         }
@@ -2691,7 +2911,7 @@ bool GeoTreeEngine::updateTreeInfo(const map<string,int> &updatesFs, const map<s
       if(idx) entry->fastStructModified = true;
       if(node) entry->slowTreeModified = true;
       // if we update the slowtree, then a fast tree generation is already pending
-      entry->doubleBufferMutex.UnLockRead();
+      entry->fastStructEpoch.ReadUnlock(token);
       AtomicDec(entry->fastStructLockWaitersCount);
     }
   }
@@ -3242,7 +3462,6 @@ bool GeoTreeEngine::markPendingBranchDisablings(const std::string &group, const
 {
   for(auto git = pGroup2SchedTME.begin(); git != pGroup2SchedTME.end(); git++)
   {
-    RWMutexReadLock lock(git->second->doubleBufferMutex);
     if(group=="*" || git->first->mName==group)
     {
       git->second->slowTreeModified = true;
@@ -4085,11 +4304,11 @@ void GeoTreeEngine::tlFree( void *arg)
   delete[] (char*)arg;
 }
 
-char* GeoTreeEngine::tlAlloc( size_t size)
+char* GeoTreeEngine::tlAlloc( size_t size, pthread_key_t key)
 {
   eos_static_debug("allocating thread specific geobuffer");
   char *buf = new char[size];
-  if(pthread_setspecific(gPthreadKey, buf))
+  if(pthread_setspecific(key, buf))
     eos_static_crit("error registering thread-local buffer located at %p for cleaning up : memory will be leaked when thread is terminated",buf);
   return buf;
 }
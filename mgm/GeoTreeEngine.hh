@@ -31,6 +31,7 @@
 /*----------------------------------------------------------------------------*/
 #include "mgm/FsView.hh"
 #include "mgm/geotree/SchedulingSlowTree.hh"
+#include "mgm/geotree/SchedulingEpoch.hh"
 #include "common/Timing.hh"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucString.hh"
@@ -43,6 +44,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <algorithm>
 
 /*----------------------------------------------------------------------------*/
 /**
@@ -116,6 +118,8 @@
  *
  * If any change was made to the SlowTree (add/remove fs/proxy, geotag change), GeoTreeEngine::FastStructSched/GeotreeEngine::FastStructProxy are then regenerated fom the SlowTree.
  * Once the whole refresh is done pointers to foreground and background structures are swapped.
+ * The swap is an epoch based publication (see SchedulingEpoch): scheduling operations never wait for the updater,
+ * they keep working on the structure they started with while the updater waits for them before reusing it as the background.
  *
  *
  * ### Penalty subsystem
@@ -675,11 +679,14 @@ class GeoTreeEngine : public eos::common::LogId
     FastStruct *foregroundFastStruct;
     // the pointed object is accessed in read /write only by the thread update
     FastStruct *backgroundFastStruct;
-    // the two previous pointers are swapped once an update is done. To do so, we need a mutex and a counter (for deletion)
-    // every access to *mForegroundFastStruct for reading should be protected by a LockRead to mDoubleBufferMutex
-    // when swapping mForegroundFastStruct and mBackgroundFastStruct is needed a LockWrite is taken to mDoubleBufferMutex
-    eos::common::RWMutex doubleBufferMutex;
+    // the two previous pointers are swapped once an update is done. To do so, we need an epoch and a counter (for deletion)
+    // every access to *foregroundFastStruct for reading should be done in a read-side section of fastStructEpoch
+    // and the pointer should be loaded once with SchedulingEpoch::Dereference at the beginning of the section
+    // the swap publishes the new foreground and waits for the readers of the former one, readers are never blocked
+    SchedulingEpoch fastStructEpoch;
     size_t fastStructLockWaitersCount;
+    // incremented after each swap, to tell if a result computed on the foreground is still current
+    size_t fastStructGeneration;
     bool fastStructModified;
 
     TreeMapEntry(const std::string &groupName="") :
@@ -687,11 +694,11 @@ class GeoTreeEngine : public eos::common::LogId
     foregroundFastStruct(fastStructures),
     backgroundFastStruct(fastStructures+1),
     fastStructLockWaitersCount(0),
+    fastStructGeneration(0),
     fastStructModified(false)
     {
       slowTree = new SlowTree(groupName);
       slowTreeMutex.SetBlocking(true);
-      doubleBufferMutex.SetBlocking(true);
     }
 
     ~TreeMapEntry()
@@ -701,8 +708,12 @@ class GeoTreeEngine : public eos::common::LogId
 
     void swapFastStructBuffers()
     {
-      eos::common::RWMutexWriteLock lock(doubleBufferMutex);
-      std::swap(foregroundFastStruct,backgroundFastStruct);
+      FastStruct *previous = foregroundFastStruct;
+      SchedulingEpoch::Publish(foregroundFastStruct,backgroundFastStruct);
+      backgroundFastStruct = previous;
+      AtomicInc(fastStructGeneration);
+      // the former foreground can only be modified once its last readers are done
+      fastStructEpoch.Synchronize();
     }
 
     void updateBGFastStructuresConfigParam(
@@ -884,7 +895,7 @@ class GeoTreeEngine : public eos::common::LogId
     // clear the penalties
     std::fill(entry->backgroundFastStruct->penalties->begin(), entry->backgroundFastStruct->penalties->end(), Penalties());
 
-    // swap the buffers (this is the only bit where the fast structures is not accessible for a placement/access operation)
+    // swap the buffers (placement/access operations keep running on the former foreground until they are done)
     entry->swapFastStructBuffers();
 
     return true;
@@ -937,7 +948,7 @@ class GeoTreeEngine : public eos::common::LogId
     // clear the penalties
     std::fill(entry->backgroundFastStruct->penalties->begin(), entry->backgroundFastStruct->penalties->end(), Penalties());
 
-    // swap the buffers (this is the only bit where the fast structures is not accessible for a placement/access operation)
+    // swap the buffers (placement/access operations keep running on the former foreground until they are done)
     entry->swapFastStructBuffers();
 
     return true;
@@ -1104,6 +1115,9 @@ protected:
   /// Thread local buffer to hold a working copy of a fast structure
   static __thread void* tlGeoBuffer;
   static pthread_key_t gPthreadKey;
+  /// Thread local buffer to hold the prepared copy of a fast structure during a batch placement
+  static __thread void* tlGeoBatchBuffer;
+  static pthread_key_t gPthreadBatchKey;
   /// Current scheduling group for the current thread
   static __thread const FsGroup* tlCurrentGroup;
   //
@@ -1230,7 +1244,7 @@ protected:
 
   /// thread-local buffer management
   static void tlFree( void *arg);
-  static char* tlAlloc( size_t size);
+  static char* tlAlloc( size_t size, pthread_key_t key=gPthreadKey);
 
   inline void applyDlScorePenalty(SchedTME *entry, const SchedTreeBase::tFastTreeIdx &idx, const char &penalty, bool background=false)
   {
@@ -1321,6 +1335,35 @@ protected:
     }
   }
 
+  template<class T> bool excludeAndBook(T *tree,
+      std::vector<SchedTreeBase::tFastTreeIdx> *excludedNodes,
+      unsigned long long bookingSize)
+  {
+    // works on a working copy of a fast tree, returns true if the tree needs to be updated
+    bool updateNeeded = false;
+
+    if(excludedNodes)
+    {
+      // mark the excluded branches as unavailable and sort the branches (no deep, or we would lose the unavailable marks)
+      for(auto it = excludedNodes->begin(); it != excludedNodes->end(); ++it)
+      {
+	tree->pNodes[*it].fsData.mStatus = tree->pNodes[*it].fsData.mStatus & ~SchedTreeBase::Available;
+      }
+      if(!excludedNodes->empty())
+      updateNeeded = true;
+    }
+
+    if(bookingSize)
+    {
+      // we prebook the space on all the possible nodes before the selection
+      // reminder : this is just a working copy of the tree and will affect only the current placement
+      tree->bookSpace(bookingSize);
+      updateNeeded = true;
+    }
+
+    return updateNeeded;
+  }
+
   template<class T> bool placeNewReplicas(SchedTME* entry, const size_t &nNewReplicas,
 
       std::vector<SchedTreeBase::tFastTreeIdx> *newReplicas,
@@ -1395,32 +1438,8 @@ protected:
       updateNeeded = true;
     }
 
-    if(excludedNodes)
-    {
-      // mark the excluded branches as unavailable and sort the branches (no deep, or we would lose the unavailable marks)
-      for(auto it = excludedNodes->begin(); it != excludedNodes->end(); ++it)
-      {
-	tree->pNodes[*it].fsData.mStatus = tree->pNodes[*it].fsData.mStatus & ~SchedTreeBase::Available;
-      }
-      if(!excludedNodes->empty())
-      updateNeeded = true;
-    }
-
-    if(bookingSize)
-    {
-      for(auto it = tree->pFs2Idx->begin(); it != tree->pFs2Idx->end(); it++ )
-      {
-	// we prebook the space on all the possible nodes before the selection
-	// reminder : this is just a working copy of the tree and will affect only the current placement
-	const SchedTreeBase::tFastTreeIdx &idx = (*it).second;
-	float &freeSpace = tree->pNodes[idx].fsData.totalSpace;
-	if(freeSpace>bookingSize)// if there is enough space , prebook it
-	freeSpace -= bookingSize;
-	else// if there is not enough space, make the node unavailable
-	tree->pNodes[idx].fsData.mStatus = tree->pNodes[idx].fsData.mStatus & ~SchedTreeBase::Available;
-      }
-      updateNeeded = true;
-    }
+    if(excludeAndBook(tree,excludedNodes,bookingSize))
+    updateNeeded = true;
 
     // do the placement
     if(eos::common::Logging::gLogMask & LOG_MASK(LOG_DEBUG))
@@ -1457,6 +1476,78 @@ protected:
     return true;
   }
 
+  template<class T> size_t placeNewReplicasBatch(SchedTME* entry, const size_t &nFiles,
+      const size_t &nNewReplicas,
+      std::vector<std::vector<SchedTreeBase::tFastTreeIdx> > *newReplicas,
+      T *placementTree,
+      unsigned long long bookingSize=0,
+      const SchedTreeBase::tFastTreeIdx &startFromNode=0,
+      const size_t &nCollocatedReplicas=0,
+      std::vector<SchedTreeBase::tFastTreeIdx> *excludedNodes=NULL,
+      bool skipSaturated=false)
+  {
+    // a read-side section is supposed to be entered on the fast structures
+
+    // make one prepared copy of the required fast tree for the whole batch
+    // it holds the exclusions, the booking and the penalties of the files already placed
+    if(!tlGeoBatchBuffer) tlGeoBatchBuffer = tlAlloc(gGeoBufferSize,gPthreadBatchKey);
+    if(!tlGeoBuffer) tlGeoBuffer = tlAlloc(gGeoBufferSize);
+
+    if(placementTree->copyToBuffer((char*)tlGeoBatchBuffer,gGeoBufferSize))
+    {
+      eos_crit("could not make a working copy of the fast tree");
+      return 0;
+    }
+    T *prepared = (T*)tlGeoBatchBuffer;
+
+    if(excludeAndBook(prepared,excludedNodes,bookingSize))
+    prepared->updateTree();
+
+    size_t nAdjustCollocatedReplicas = std::min(nCollocatedReplicas,nNewReplicas);
+    newReplicas->resize(0);
+
+    for(size_t f = 0; f < nFiles; f++)
+    {
+      // every file starts from the prepared copy with all its slots free
+      if(prepared->copyToBuffer((char*)tlGeoBuffer,gGeoBufferSize))
+      {
+	eos_crit("could not make a working copy of the fast tree");
+	break;
+      }
+      T *tree = (T*)tlGeoBuffer;
+      std::vector<SchedTreeBase::tFastTreeIdx> replicas;
+      replicas.reserve(nNewReplicas);
+
+      for(size_t k = 0; k < nNewReplicas; k++)
+      {
+	SchedTreeBase::tFastTreeIdx idx;
+	SchedTreeBase::tFastTreeIdx startidx = (k<nNewReplicas-nAdjustCollocatedReplicas)?0:startFromNode;
+	if(!tree->findFreeSlot(idx, startidx, true /*allow uproot if necessary*/, true, skipSaturated))
+	{
+	  if( (!skipSaturated) || !tree->findFreeSlot(idx, startidx, true /*allow uproot if necessary*/, true, false) )
+	  {
+	    eos_debug("could not find a new slot for a replica in the fast tree after placing %lu files of the batch",newReplicas->size());
+	    return newReplicas->size();
+	  }
+	}
+	replicas.push_back(idx);
+      }
+
+      // penalize the selected fs in the prepared copy so that the next files of the batch
+      // are spread according to the remaining weights
+      for(auto it = replicas.begin(); it != replicas.end(); ++it)
+      {
+	const char netSpeedClass = (*prepared->pTreeInfo)[*it].netSpeedClass;
+	prepared->applyScorePenalty(*it,pPenaltySched.pPlctDlScorePenalty[netSpeedClass],
+	    pPenaltySched.pPlctUlScorePenalty[netSpeedClass]);
+      }
+
+      newReplicas->push_back(replicas);
+    }
+
+    return newReplicas->size();
+  }
+
   template<class T> unsigned char accessReplicas(SchedTME* entry, const size_t &nNewReplicas,
       std::vector<SchedTreeBase::tFastTreeIdx> *accessedReplicas,
       SchedTreeBase::tFastTreeIdx accesserNode,
@@ -1653,12 +1744,19 @@ protected:
     any         // do the regular scheduling for all the filesystems
   } tProxySchedType;
   bool findProxy(const std::vector<SchedTreeBase::tFastTreeIdx> &fsidxs,
-                 std::vector<SchedTME *> entries,
+                 std::vector<FastStructSched *> entries,
                  ino64_t inode,
                  std::vector<std::string> *proxies,
                  std::vector<std::string> *proxyGroups=NULL,
                  const std::string &clientgeotag="",
                  tProxySchedType proxyschedtype=regular);
+  // schedule the data proxys and firewall entry points of placed replicas
+  bool placeProxies(const std::vector<SchedTreeBase::tFastTreeIdx> &newReplicasIdx,
+                    FastStructSched *fg,
+                    ino64_t inode,
+                    std::vector<std::string> *dataProxys,
+                    std::vector<std::string> *firewallEntryPoint,
+                    const std::string &clientGeoTag);
   bool markPendingBranchDisablings(const std::string &group, const std::string&optype, const std::string&geotag);
   bool applyBranchDisablings(const SchedTME& entry);
   bool applyBranchDisablings(const ProxyTMEBase& entry);
@@ -1717,6 +1815,7 @@ public:
       it->reserve(100);
     // create the thread local key to handle allocation/destruction of thread local geobuffers
     pthread_key_create(&gPthreadKey, GeoTreeEngine::tlFree);
+    pthread_key_create(&gPthreadBatchKey, GeoTreeEngine::tlFree);
     // initialize pauser semaphore
     if(sem_init(&gUpdaterPauseSem, 0, 1)) { throw "sem_init() failed";}
 #ifdef EOS_GEOTREEENGINE_USE_INSTRUMENTED_MUTEX
@@ -1864,6 +1963,103 @@ public:
       std::vector<std::string> *excludeGeoTags=NULL,
       std::vector<std::string> *forceGeoTags=NULL);
 
+  // ---------------------------------------------------------------------------
+  //! Place the replicas of several new files in one scheduling group at once.
+  //! All the files are placed on the same snapshot of the fast structures with
+  //! a single working copy of the placement tree. Each file placed lowers the
+  //! scores of its fs in that copy so the batch is spread according to the
+  //! weights. The shared structures are left untouched, the penalties of each
+  //! placement are applied when it is used, see applyPlacementPenaltiesOneGroup.
+  //! No data proxy or firewall entry point is scheduled,
+  //! see placeProxiesOneGroup for that.
+  // @param group
+  //   the group to place the replicas in
+  // @param nFiles
+  //   the number of files to place
+  // @param nNewReplicas
+  //   the number of replicas to place for each file
+  // @param newReplicas
+  //   vector to which one vector of fsids is appended per placed file
+  //   the fsids are in decreasing priority order
+  // @param type
+  //   type of placement to be performed: regularRO, regularRW, balancing or draining
+  // @param generation
+  //   if non NULL, receives the generation of the snapshot used,
+  //   see isPlacementCurrent
+  // @param bookingSize
+  //   the space to be booked on the fs for each file
+  // @param startFromGeoTag
+  //   try to place the files under this geotag
+  // @param nCollocatedReplicas
+  //   among the nNewReplicas, nCollocatedReplicas are placed as close as possible to startFromGeoTag
+  // @param excludeFs
+  //   fsids of files to exclude from the placement operation
+  // @param excludeGeoTags
+  //   geotags of branches to exclude from the placement operation
+  // @return
+  //   true if at least one file could be placed, false else
+  //   newReplicas can hold less than nFiles entries if the group fills up
+  // ---------------------------------------------------------------------------
+  bool placeNewReplicasOneGroupBatch( FsGroup* group, const size_t &nFiles,
+      const size_t &nNewReplicas,
+      std::vector<std::vector<eos::common::FileSystem::fsid_t> > *newReplicas,
+      SchedType type,
+      size_t *generation=NULL,
+      unsigned long long bookingSize=0,
+      const std::string &startFromGeoTag="",
+      const size_t &nCollocatedReplicas=0,
+      std::vector<eos::common::FileSystem::fsid_t> *excludeFs=NULL,
+      std::vector<std::string> *excludeGeoTags=NULL);
+
+  // ---------------------------------------------------------------------------
+  //! Check if the fast structures of a group are still the ones a batch
+  //! placement was computed on
+  // @param group
+  //   the group the placement was made in
+  // @param generation
+  //   the generation returned by placeNewReplicasOneGroupBatch
+  // @return
+  //   true if the group has not been refreshed since, false else
+  // ---------------------------------------------------------------------------
+  bool isPlacementCurrent( FsGroup* group, size_t generation);
+
+  // ---------------------------------------------------------------------------
+  //! Apply the placement penalties for replicas placed by
+  //! placeNewReplicasOneGroupBatch when the placement is used, the way
+  //! placeNewReplicasOneGroup does when it places them
+  // @param group
+  //   the group the replicas are placed in
+  // @param replicas
+  //   fsids of the placed replicas
+  // ---------------------------------------------------------------------------
+  void applyPlacementPenaltiesOneGroup( FsGroup* group,
+      const std::vector<eos::common::FileSystem::fsid_t> &replicas);
+
+  // ---------------------------------------------------------------------------
+  //! Schedule the data proxys and firewall entry points for replicas already
+  //! placed in one scheduling group, the way placeNewReplicasOneGroup does
+  // @param group
+  //   the group the replicas are placed in
+  // @param replicas
+  //   fsids of the placed replicas
+  // @param inode
+  //   inode of the file, used for filesticky proxy scheduling
+  // @param dataProxys
+  //   if this pointer is non NULL, one proxy is returned for each filesystem
+  // @param firewallEntryPoints
+  //   if this pointer is non NULL, one firewall entry point is returned for each filesystem
+  // @param clientGeoTag
+  //   try to place the proxys close to the client
+  // @return
+  //   true if the success false else
+  // ---------------------------------------------------------------------------
+  bool placeProxiesOneGroup( FsGroup* group,
+      const std::vector<eos::common::FileSystem::fsid_t> &replicas,
+      ino64_t inode,
+      std::vector<std::string> *dataProxys,
+      std::vector<std::string> *firewallEntryPoints,
+      const std::string &clientGeoTag="");
+
   // ---------------------------------------------------------------------------
   //! Access several replicas in one scheduling group.
   // @param group
@@ -445,13 +445,14 @@ GroupBalancer::chooseFidFromGroup (FsGroup *group)
   int rndIndex;
   eos::common::RWMutexReadLock vlock(FsView::gFsView.ViewMutex);
   eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex);
-  eos::IFsView::FileList filelist;
+  uint64_t nfiles = 0;
   std::vector<int> validFsIndexes(group->size());
 
   for (size_t i = 0; i < group->size(); i++)
     validFsIndexes[i] = (int) i;
 
   eos::mgm::BaseView::const_iterator fs_it;
+  eos::common::FileSystem::fsid_t fsid = 0;
 
   while (validFsIndexes.size() > 0)
   {
@@ -463,29 +464,27 @@ GroupBalancer::chooseFidFromGroup (FsGroup *group)
     if (FsView::gFsView.mIdView[*fs_it]->GetActiveStatus() ==
         eos::common::FileSystem::kOnline)
     {
-      filelist = gOFS->eosFsView->getFileList(*fs_it);
+      fsid = *fs_it;
+      nfiles = gOFS->eosFsView->getNumFilesOnFs(fsid);
 
-      if (filelist.size() > 0)
+      if (nfiles > 0)
         break;
     }
 
     validFsIndexes.erase(validFsIndexes.begin() + rndIndex);
   }
 
-  if (filelist.size() == 0)
+  if (nfiles == 0)
     return -1;
 
-  int attempts = 10;
-  eos::IFsView::FileIterator fid_it;
+  // try up to 10 random files not already being transferred
+  std::vector<eos::IFileMD::id_t> candidates =
+    gOFS->eosFsView->getRandomFiles(fsid, 10);
 
-  while (attempts-- > 0)
+  for (auto fid : candidates)
   {
-    rndIndex = getRandom(filelist.size() - 1);
-    fid_it = filelist.begin();
-    std::advance(fid_it, rndIndex);
-
-    if (mTransfers.count(*fid_it) == 0)
-      return *fid_it;
+    if (mTransfers.count(fid) == 0)
+      return fid;
   }
 
   return -1;
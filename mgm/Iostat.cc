@@ -258,36 +258,40 @@ Iostat::Receive(void)
 
       XrdOucEnv ioreport(body.c_str());
       eos::common::Report* report = new eos::common::Report(ioreport);
-      Add("bytes_read", report->uid, report->gid, report->rb, report->ots,
-          report->cts);
-      Add("bytes_written", report->uid, report->gid, report->wb, report->ots,
-          report->cts);
-      Add("read_calls", report->uid, report->gid, report->nrc, report->ots,
-          report->cts);
-      Add("readv_calls", report->uid, report->gid, report->rv_op, report->ots,
-          report->cts);
-      Add("write_calls", report->uid, report->gid, report->nwc, report->ots,
-          report->cts);
-      Add("fwd_seeks", report->uid, report->gid, report->nfwds, report->ots,
-          report->cts);
-      Add("bwd_seeks", report->uid, report->gid, report->nbwds, report->ots,
-          report->cts);
-      Add("xl_fwd_seeks", report->uid, report->gid, report->nxlfwds, report->ots,
-          report->cts);
-      Add("xl_bwd_seeks", report->uid, report->gid, report->nxlbwds, report->ots,
-          report->cts);
-      Add("bytes_fwd_seek", report->uid, report->gid, report->sfwdb, report->ots,
-          report->cts);
-      Add("bytes_bwd_wseek", report->uid, report->gid, report->sbwdb, report->ots,
-          report->cts);
-      Add("bytes_xl_fwd_seek", report->uid, report->gid, report->sxlfwdb, report->ots,
-          report->cts);
-      Add("bytes_xl_bwd_wseek", report->uid, report->gid, report->sxlbwdb,
-          report->ots, report->cts);
-      Add("disk_time_read", report->uid, report->gid, (unsigned long long) report->rt,
-          report->ots, report->cts);
-      Add("disk_time_write", report->uid, report->gid,
-          (unsigned long long) report->wt, report->ots, report->cts);
+      {
+        // one lock for all the counters of the report
+        XrdSysMutexHelper mLock(Mutex);
+        AddLocked("bytes_read", report->uid, report->gid, report->rb, report->ots,
+                  report->cts);
+        AddLocked("bytes_written", report->uid, report->gid, report->wb, report->ots,
+                  report->cts);
+        AddLocked("read_calls", report->uid, report->gid, report->nrc, report->ots,
+                  report->cts);
+        AddLocked("readv_calls", report->uid, report->gid, report->rv_op, report->ots,
+                  report->cts);
+        AddLocked("write_calls", report->uid, report->gid, report->nwc, report->ots,
+                  report->cts);
+        AddLocked("fwd_seeks", report->uid, report->gid, report->nfwds, report->ots,
+                  report->cts);
+        AddLocked("bwd_seeks", report->uid, report->gid, report->nbwds, report->ots,
+                  report->cts);
+        AddLocked("xl_fwd_seeks", report->uid, report->gid, report->nxlfwds, report->ots,
+                  report->cts);
+        AddLocked("xl_bwd_seeks", report->uid, report->gid, report->nxlbwds, report->ots,
+                  report->cts);
+        AddLocked("bytes_fwd_seek", report->uid, report->gid, report->sfwdb, report->ots,
+                  report->cts);
+        AddLocked("bytes_bwd_wseek", report->uid, report->gid, report->sbwdb, report->ots,
+                  report->cts);
+        AddLocked("bytes_xl_fwd_seek", report->uid, report->gid, report->sxlfwdb, report->ots,
+                  report->cts);
+        AddLocked("bytes_xl_bwd_wseek", report->uid, report->gid, report->sxlbwdb,
+                  report->ots, report->cts);
+        AddLocked("disk_time_read", report->uid, report->gid, (unsigned long long) report->rt,
+                  report->ots, report->cts);
+        AddLocked("disk_time_write", report->uid, report->gid,
+                  (unsigned long long) report->wt, report->ots, report->cts);
+      }
       // do the UDP broadcasting here
       {
         XrdSysMutexHelper mLock(BroadcastMutex);
@@ -344,11 +344,18 @@ public:
   Add (const char* tag, uid_t uid, gid_t gid, unsigned long val, time_t starttime, time_t stoptime)
   {
     Mutex.Lock ();
+    AddLocked (tag, uid, gid, val, starttime, stoptime);
+    Mutex.UnLock ();
+  }
+
+  // the caller has to hold Mutex - used to account a whole report at once
+  void
+  AddLocked (const char* tag, uid_t uid, gid_t gid, unsigned long val, time_t starttime, time_t stoptime)
+  {
     IostatUid[tag][uid] += val;
     IostatGid[tag][gid] += val;
     IostatAvgUid[tag][uid].Add (val, starttime, stoptime);
     IostatAvgGid[tag][gid].Add (val, starttime, stoptime);
-    Mutex.UnLock ();
   }
 
   unsigned long long
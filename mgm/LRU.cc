@@ -411,6 +411,7 @@ LRU::AgeExpire (const char* dir,
       cmd = gOFS->eosView->getContainer(dir);
       std::shared_ptr<eos::IFileMD> fmd;
       std::set<std::string> fnames = cmd->getNameFiles();
+      cmd->prefetchFiles();
 
       for (auto fit = fnames.begin(); fit != fnames.end(); ++fit)
       {
@@ -701,6 +702,7 @@ LRU::ConvertMatch (const char* dir,
       cmd = gOFS->eosView->getContainer(dir);
       std::shared_ptr<eos::IFileMD> fmd;
       std::set<std::string> fnames = cmd->getNameFiles();
+      cmd->prefetchFiles();
 
       for (auto fit = fnames.begin(); fit != fnames.end(); ++fit)
       {
@@ -1608,10 +1608,18 @@ Master::MasterRO2Slave()
       Access::gStallGlobal = true;
     }
   }
+  // The background accounting may be waiting for the namespace lock, it is
+  // destroyed once the lock is released
+  std::unique_ptr<eos::IFileMDChangeListener> old_accounting;
   {
     // Convert the namespace
     eos::common::RWMutexWriteLock nsLock(gOFS->eosViewRWMutex);
 
+    // Detach the background accounting from the namespace
+    if (gOFS->eosContainerAccounting) {
+      gOFS->eosContainerAccounting->setNamespaceLock(0);
+    }
+
     // Take the whole namespace down
     try {
       if (gOFS->eosFsView) {
@@ -1621,7 +1629,7 @@ Master::MasterRO2Slave()
       }
 
       if (gOFS->eosContainerAccounting) {
-        delete gOFS->eosContainerAccounting;
+        old_accounting.reset(gOFS->eosContainerAccounting);
         gOFS->eosContainerAccounting = 0;
       }
 
@@ -1647,6 +1655,7 @@ Master::MasterRO2Slave()
       return false;
     }
   }
+  old_accounting.reset();
 
   // Reload the configuration to get the proper quota nodes
   if (gOFS->MgmConfigAutoLoad.length()) {
@@ -1841,6 +1850,12 @@ Master::BootNamespace()
     ns_preset = true;
   }
 
+  if (getenv("EOS_NS_BOOT_THREADS")) {
+    fileSettings["boot_threads"] = getenv("EOS_NS_BOOT_THREADS");
+    eos_alert("msg=\"namespace parallel boot\" threads=%s",
+              getenv("EOS_NS_BOOT_THREADS"));
+  }
+
   if (ns_preset) {
     eos_alert("msg=\"namespace size optimization\" nfiles=%s ndirs=%s",
               getenv("EOS_NS_DIR_SIZE"), getenv("EOS_NS_FILE_SIZE"));
@@ -1911,6 +1926,7 @@ Master::BootNamespace()
 
     if (gOFS->eosContainerAccounting) {
       gOFS->eosFileService->addChangeListener(gOFS->eosContainerAccounting);
+      gOFS->eosContainerAccounting->setNamespaceLock(&fNsLock);
     }
 
     gOFS->eosFileService->setQuotaStats(gOFS->eosView->getQuotaStats());
@@ -2295,6 +2311,9 @@ bool
 Master::RebootSlaveNamespace()
 {
   fRunningState = Run::State::kIsTransition;
+  // The background accounting may be waiting for the namespace lock, it is
+  // destroyed once the lock is released
+  std::unique_ptr<eos::IFileMDChangeListener> old_accounting;
   {
     {
       XrdSysMutexHelper lock(gOFS->InitializationMutex);
@@ -2303,6 +2322,11 @@ Master::RebootSlaveNamespace()
     // now convert the namespace
     eos::common::RWMutexWriteLock nsLock(gOFS->eosViewRWMutex);
 
+    // Detach the background accounting from the namespace
+    if (gOFS->eosContainerAccounting) {
+      gOFS->eosContainerAccounting->setNamespaceLock(0);
+    }
+
     // Take the whole namespace down
     try {
       if (gOFS->eosFsView) {
@@ -2312,7 +2336,7 @@ Master::RebootSlaveNamespace()
       }
 
       if (gOFS->eosContainerAccounting) {
-        delete gOFS->eosContainerAccounting;
+        old_accounting.reset(gOFS->eosContainerAccounting);
         gOFS->eosContainerAccounting = 0;
       }
 
@@ -2347,6 +2371,7 @@ Master::RebootSlaveNamespace()
       gOFS->Initialized = gOFS->kBooted;
     }
   }
+  old_accounting.reset();
   {
     XrdSysMutexHelper lock(gOFS->InitializationMutex);
 
@@ -422,6 +422,7 @@ ProcCommand::open(const char* inpath,
   stdErr = "";
   retc = 0;
   mResultStream = "";
+  mBinaryStream.clear();
   mOffset = 0;
   mLen = 0;
   mDoSort = true;
@@ -610,11 +611,18 @@ ProcCommand::read(XrdSfsFileOffset mOffset, char* buff, XrdSfsXferSize blen)
     return 0;
   } else {
     // memory based results go here ...
+    const char* stream = mBinaryStream.length() ? mBinaryStream.data() :
+                         mResultStream.c_str();
+
+    if ((size_t) mOffset >= mLen) {
+      return 0;
+    }
+
     if (((unsigned int) blen <= (mLen - mOffset))) {
-      memcpy(buff, mResultStream.c_str() + mOffset, blen);
+      memcpy(buff, stream + mOffset, blen);
       return blen;
     } else {
-      memcpy(buff, mResultStream.c_str() + mOffset, (mLen - mOffset));
+      memcpy(buff, stream + mOffset, (mLen - mOffset));
       return (mLen - mOffset);
     }
   }
@@ -677,6 +685,13 @@ ProcCommand::MakeResult()
 {
   mResultStream = "";
 
+  if (mBinaryStream.length()) {
+    // binary results are sent as they are
+    mLen = mBinaryStream.length();
+    mOffset = 0;
+    return;
+  }
+
   if (!fstdout) {
     if (mDoSort) {
       eos::common::StringConversion::SortLines(stdOut);
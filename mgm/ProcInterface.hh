@@ -199,6 +199,7 @@ public:
   int FileInfo(const char* path);
   int FileJSON(uint64_t id, Json::Value* json);
   int Fuse();
+  int FuseBinary(const char* dirpath, bool statentries);
   int Ls();
   int Map();
   int Member();
@@ -291,6 +292,7 @@ private:
   XrdOucString stdJson; ///< JSON output returned by proc command
   int retc; ///< return code from the proc command
   XrdOucString mResultStream; ///< string containing the assembled stream
+  std::string mBinaryStream; ///< binary stream, used instead of mResultStream if not empty
   XrdOucEnv* pOpaque; ///< pointer to the opaque information object
   const char* ininfo; ///< original opaque info string
   bool mDoSort; ///< sort flag (true = sorting)
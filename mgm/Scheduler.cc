@@ -26,12 +26,15 @@
 #include "mgm/Quota.hh"
 #include "GeoTreeEngine.hh"
 /*----------------------------------------------------------------------------*/
+#include <sstream>
 /*----------------------------------------------------------------------------*/
 EOSMGMNAMESPACE_BEGIN
 
 /*----------------------------------------------------------------------------*/
 XrdSysMutex Scheduler::pMapMutex;
 std::map<std::string, FsGroup*> Scheduler::schedulingGroup;
+XrdSysMutex Scheduler::pBatchMutex;
+std::map<std::string, Scheduler::PlacementBatch> Scheduler::placementBatches;
 
 
 /* ------------------------------------------------------------------------- */
@@ -163,22 +166,33 @@ Scheduler::FilePlacement(PlacementArguments* args)
 
 
 
-    bool placeRes = gGeoTreeEngine.placeNewReplicasOneGroup(
-                      group, nfilesystems,
-                      args->selected_filesystems,
-                      args->inode,
-                      args->dataproxys,
-                      args->firewallentpts,
-                      GeoTreeEngine::regularRW,
-                      args->alreadyused_filesystems,// file systems to avoid are assumed to already host a replica
-                      &fsidsgeotags,
-                      args->bookingsize,
-                      args->plctTrgGeotag ? *args->plctTrgGeotag : "",
-                      args->vid->geolocation,
-                      ncollocatedfs,
-                      NULL,
-                      NULL,
-                      NULL);
+    bool placeRes = false;
+
+    // new files with nothing to avoid can share a placement batch, if the
+    // batch can't be placed in the group the file is placed on its own
+    if (args->batch && PlacementBatchSize() &&
+        args->alreadyused_filesystems->empty() && (args->schedtype == regular)) {
+      placeRes = PlaceFromBatch(group, nfilesystems, ncollocatedfs, args);
+    }
+
+    if (!placeRes) {
+      placeRes = gGeoTreeEngine.placeNewReplicasOneGroup(
+                   group, nfilesystems,
+                   args->selected_filesystems,
+                   args->inode,
+                   args->dataproxys,
+                   args->firewallentpts,
+                   GeoTreeEngine::regularRW,
+                   args->alreadyused_filesystems,// file systems to avoid are assumed to already host a replica
+                   &fsidsgeotags,
+                   args->bookingsize,
+                   args->plctTrgGeotag ? *args->plctTrgGeotag : "",
+                   args->vid->geolocation,
+                   ncollocatedfs,
+                   NULL,
+                   NULL,
+                   NULL);
+    }
 
     if (eos::common::Logging::gLogMask & LOG_MASK(LOG_DEBUG)) {
       char buffer[1024];
@@ -226,6 +240,100 @@ Scheduler::FilePlacement(PlacementArguments* args)
   return ENOSPC;
           }
 
+//------------------------------------------------------------------------------
+// Number of files placed at once for the batchable placement requests
+//------------------------------------------------------------------------------
+size_t
+Scheduler::PlacementBatchSize()
+{
+  static size_t batchSize = getenv("EOS_MGM_PLACEMENT_BATCH") ?
+                            strtoul(getenv("EOS_MGM_PLACEMENT_BATCH"), 0, 10) : 0;
+  return batchSize;
+}
+
+//------------------------------------------------------------------------------
+// Place a file in a group taking the next placement of the matching batch
+//------------------------------------------------------------------------------
+bool
+Scheduler::PlaceFromBatch(FsGroup* group, unsigned int nfilesystems,
+                          unsigned int ncollocatedfs, PlacementArguments* args)
+{
+  // round the booking up to a power of two so that files of similar sizes
+  // share a batch, booking more is on the safe side
+  unsigned long long booking = 0;
+
+  if (args->bookingsize) {
+    booking = 1;
+
+    while (booking < args->bookingsize) {
+      booking <<= 1;
+    }
+  }
+
+  std::string targetgeotag = args->plctTrgGeotag ? *args->plctTrgGeotag : "";
+  std::ostringstream key;
+  key << group->mName << "|" << nfilesystems << "|" << ncollocatedfs << "|"
+      << booking << "|" << targetgeotag;
+  std::vector<eos::common::FileSystem::fsid_t> placement;
+  {
+    XrdSysMutexHelper scope_lock(pBatchMutex);
+    auto it = placementBatches.find(key.str());
+
+    if (it != placementBatches.end()) {
+      if (!it->second.placements.empty() &&
+          gGeoTreeEngine.isPlacementCurrent(group, it->second.generation)) {
+        placement = it->second.placements.front();
+        it->second.placements.pop_front();
+      } else {
+        placementBatches.erase(it);
+      }
+    }
+  }
+
+  if (placement.empty()) {
+    std::vector<std::vector<eos::common::FileSystem::fsid_t> > placements;
+    size_t generation = 0;
+
+    if (!gGeoTreeEngine.placeNewReplicasOneGroupBatch(group, PlacementBatchSize(),
+        nfilesystems, &placements, GeoTreeEngine::regularRW, &generation,
+        booking, targetgeotag, ncollocatedfs)) {
+      return false;
+    }
+
+    placement = placements.front();
+    XrdSysMutexHelper scope_lock(pBatchMutex);
+    PlacementBatch& batch = placementBatches[key.str()];
+
+    // Another thread may have refilled the batch meanwhile, the placements
+    // are appended to it if they were made on the same structures. A batch
+    // made on older structures is replaced, ours is dropped if it's older.
+    if (batch.placements.empty() ||
+        ((batch.generation != generation) &&
+         !gGeoTreeEngine.isPlacementCurrent(group, batch.generation))) {
+      batch.generation = generation;
+      batch.placements.clear();
+    }
+
+    if (batch.generation == generation) {
+      batch.placements.insert(batch.placements.end(), placements.begin() + 1,
+                              placements.end());
+    }
+  }
+
+  // The penalties are applied when the placement is handed out so that the
+  // unused placements of a batch don't weigh on the shared structures
+  gGeoTreeEngine.applyPlacementPenaltiesOneGroup(group, placement);
+  *args->selected_filesystems = placement;
+
+  if (!gGeoTreeEngine.placeProxiesOneGroup(group, placement, args->inode,
+      args->dataproxys, args->firewallentpts, args->vid->geolocation)) {
+    args->selected_filesystems->clear();
+    return false;
+  }
+
+  return true;
+}
+
           // we are off the wire
 
           // the weight is given mainly by the disk performance and the network load has a weaker impact (sqrt)
@@ -31,6 +31,7 @@
 #include "mgm/Namespace.hh"
 #include "mgm/FsView.hh"
 /*----------------------------------------------------------------------------*/
+#include <deque>
 /*----------------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------------*/
@@ -96,6 +97,8 @@ public:
     std::vector<std::string>* dataproxys;
     //! if non NULL, schedule a firewall entry point for each fs
     std::vector<std::string>* firewallentpts;
+    //! the placement can be taken from a batch placed ahead for similar files
+    bool batch;
 
     PlacementArguments() :
       spacename(0),
@@ -113,7 +116,8 @@ public:
       alreadyused_filesystems(0),
       selected_filesystems(0),
       dataproxys(0),
-      firewallentpts(0)
+      firewallentpts(0),
+      batch(false)
     {}
 
     bool isValid() const
@@ -225,6 +229,40 @@ protected:
   //! Points to the current scheduling group where to start scheduling =>
   //! std::string = <grouptag>|<uid>:<gid>
   static std::map<std::string, FsGroup*> schedulingGroup;
+
+  //! Placements computed in one go for files with the same placement request
+  struct PlacementBatch {
+    //! generation of the group fast structures the batch was placed on
+    size_t generation;
+    //! placements left in the batch
+    std::deque<std::vector<eos::common::FileSystem::fsid_t> > placements;
+  };
+
+  static XrdSysMutex pBatchMutex; //< protect the following map
+
+  //! Batches of placements =>
+  //! std::string = <group>|<nfs>|<ncollocated>|<booking>|<target geotag>
+  static std::map<std::string, PlacementBatch> placementBatches;
+
+  //----------------------------------------------------------------------------
+  //! Number of files placed at once for the batchable placement requests,
+  //! given by EOS_MGM_PLACEMENT_BATCH, 0 to disable the batches
+  //----------------------------------------------------------------------------
+  static size_t PlacementBatchSize();
+
+  //----------------------------------------------------------------------------
+  //! Place a file in a group taking the next placement of the matching batch,
+  //! placing a new batch if there is none left or the group was refreshed
+  //!
+  //! @param group the group to place the file in
+  //! @param nfilesystems number of replicas to place
+  //! @param ncollocatedfs number of collocated replicas
+  //! @param args the placement arguments
+  //!
+  //! @return true if the file could be placed, false otherwise
+  //----------------------------------------------------------------------------
+  static bool PlaceFromBatch(FsGroup* group, unsigned int nfilesystems,
+                             unsigned int ncollocatedfs, PlacementArguments* args);
 };
 
 EOSMGMNAMESPACE_END
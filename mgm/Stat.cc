@@ -34,16 +34,215 @@
 /*----------------------------------------------------------------------------*/
 
 EOSMGMNAMESPACE_BEGIN
+
+namespace
+{
+//------------------------------------------------------------------------------
+//! Shards of the calling thread, one per Stat object. On thread exit they are
+//! flagged as detached and released by the next Fold once drained.
+//------------------------------------------------------------------------------
+struct StatShardHolder
+{
+  StatShardHolder (): mLastInstance(0), mLast(0) { }
+
+  ~StatShardHolder ()
+  {
+    std::map<uint64_t, std::shared_ptr<StatShard> >::iterator it;
+    for (it = mShards.begin(); it != mShards.end(); ++it)
+    {
+      it->second->mDetached.store(true, std::memory_order_release);
+    }
+  }
+
+  std::map<uint64_t, std::shared_ptr<StatShard> > mShards;
+  uint64_t mLastInstance;
+  StatShard* mLast;
+};
+
+thread_local StatShardHolder tlStatShards;
+std::atomic<uint64_t> sStatInstances(0);
+
+//------------------------------------------------------------------------------
+//! FNV-1a hash of a tag name
+//------------------------------------------------------------------------------
+uint64_t
+TagHash (const char* tag)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (; *tag; ++tag)
+  {
+    hash ^= (unsigned char) *tag;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+}
+
+/*----------------------------------------------------------------------------*/
+Stat::Stat () : mInstance(++sStatInstances), mNumTags(0)
+{
+  for (int i = 0; i < sTagTableSize; i++)
+  {
+    mTagTable[i].store(0, std::memory_order_relaxed);
+  }
+  for (int i = 0; i < sMaxTags; i++)
+  {
+    mTagById[i].store(0, std::memory_order_relaxed);
+    mHistoById[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+Stat::~Stat ()
+{
+  for (int i = 0; i < sMaxTags; i++)
+  {
+    delete mTagById[i].load(std::memory_order_relaxed);
+    delete mHistoById[i].load(std::memory_order_relaxed);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+int
+Stat::GetTagId (const char* tag)
+{
+  uint64_t hash = TagHash(tag);
+  size_t pos = hash % sTagTableSize;
+
+  // lock-free lookup, tags are never removed
+  for (int probe = 0; probe < sTagTableSize; probe++)
+  {
+    StatTag* entry = mTagTable[pos].load(std::memory_order_acquire);
+    if (!entry)
+      break;
+    if ((entry->mHash == hash) && (entry->mName == tag))
+      return entry->mId;
+    pos = (pos + 1) % sTagTableSize;
+  }
+
+  XrdSysMutexHelper lock(mTagMutex);
+  pos = hash % sTagTableSize;
+
+  for (int probe = 0; probe < sTagTableSize; probe++)
+  {
+    StatTag* entry = mTagTable[pos].load(std::memory_order_relaxed);
+    if (!entry)
+      break;
+    if ((entry->mHash == hash) && (entry->mName == tag))
+      return entry->mId;
+    pos = (pos + 1) % sTagTableSize;
+  }
+
+  if (mNumTags >= sMaxTags)
+    return -1;
+
+  StatTag* entry = new StatTag();
+  entry->mName = tag;
+  entry->mHash = hash;
+  entry->mId = mNumTags++;
+  mTagById[entry->mId].store(entry, std::memory_order_release);
+  mTagTable[pos].store(entry, std::memory_order_release);
+  return entry->mId;
+}
+
+/*----------------------------------------------------------------------------*/
+StatShard*
+Stat::GetShard ()
+{
+  StatShardHolder& holder = tlStatShards;
+
+  if (holder.mLastInstance == mInstance)
+    return holder.mLast;
+
+  std::shared_ptr<StatShard>& shard = holder.mShards[mInstance];
+
+  if (!shard)
+  {
+    shard.reset(new StatShard());
+    XrdSysMutexHelper lock(mShardMutex);
+    mShards.push_back(shard);
+  }
+
+  holder.mLastInstance = mInstance;
+  holder.mLast = shard.get();
+  return holder.mLast;
+}
+
+/*----------------------------------------------------------------------------*/
+StatHisto*
+Stat::GetHisto (int tagid)
+{
+  StatHisto* histo = mHistoById[tagid].load(std::memory_order_acquire);
+
+  if (!histo)
+  {
+    XrdSysMutexHelper lock(mTagMutex);
+    histo = mHistoById[tagid].load(std::memory_order_relaxed);
+
+    if (!histo)
+    {
+      histo = new StatHisto();
+      mHistoById[tagid].store(histo, std::memory_order_release);
+    }
+  }
+
+  return histo;
+}
+
 /*----------------------------------------------------------------------------*/
 void
-Stat::Add (const char* tag, uid_t uid, gid_t gid, unsigned long val)
+Stat::AddLocked (const char* tag, uid_t uid, gid_t gid, unsigned long val)
 {
-  Mutex.Lock();
   StatsUid[tag][uid] += val;
   StatsGid[tag][gid] += val;
   StatAvgUid[tag][uid].Add(val);
   StatAvgGid[tag][gid].Add(val);
-  Mutex.UnLock();
+}
+
+/*----------------------------------------------------------------------------*/
+void
+Stat::AddExecLocked (const char* tag, float exectime)
+{
+  std::deque<float>& execs = StatExec[tag];
+  execs.push_back(exectime);
+  // we average over 100 entries
+  if (execs.size() > 100)
+  {
+    execs.pop_front();
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+void
+Stat::Add (const char* tag, uid_t uid, gid_t gid, unsigned long val)
+{
+  int tagid = GetTagId(tag);
+
+  if (tagid < 0)
+  {
+    XrdSysMutexHelper lock(Mutex);
+    AddLocked(tag, uid, gid, val);
+    return;
+  }
+
+  Add(tagid, uid, gid, val);
+}
+
+/*----------------------------------------------------------------------------*/
+void
+Stat::Add (int tagid, uid_t uid, gid_t gid, unsigned long val)
+{
+  if (tagid < 0)
+    return;
+
+  StatShard* shard = GetShard();
+  StatShard::Key key;
+  key.mTagId = tagid;
+  key.mTime = (uint32_t) time(0);
+  key.mUid = uid;
+  key.mGid = gid;
+  XrdSysMutexHelper lock(shard->mMutex);
+  shard->mCounters[key] += val;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -60,14 +259,97 @@ Stat::AddExt (const char* tag, uid_t uid, gid_t gid, unsigned long nsample, cons
 void
 Stat::AddExec (const char* tag, float exectime)
 {
-  Mutex.Lock();
-  StatExec[tag].push_back(exectime);
-  // we average over 100 entries
-  if (StatExec[tag].size() > 100)
+  int tagid = GetTagId(tag);
+
+  if (tagid < 0)
   {
-    StatExec[tag].pop_front();
+    XrdSysMutexHelper lock(Mutex);
+    AddExecLocked(tag, exectime);
+    return;
+  }
+
+  AddExec(tagid, exectime);
+}
+
+/*----------------------------------------------------------------------------*/
+void
+Stat::AddExec (int tagid, float exectime)
+{
+  if (tagid < 0)
+    return;
+
+  GetHisto(tagid)->Insert(exectime);
+  StatShard* shard = GetShard();
+  XrdSysMutexHelper lock(shard->mMutex);
+  StatShard::ExecRing& ring = shard->mExec[tagid];
+  ring.mVal[ring.mCount++ % StatShard::ExecRing::sSize] = exectime;
+}
+
+/*----------------------------------------------------------------------------*/
+void
+Stat::Fold ()
+{
+  XrdSysMutexHelper lock(Mutex);
+  FoldLocked();
+}
+
+/*----------------------------------------------------------------------------*/
+void
+Stat::FoldLocked ()
+{
+  int64_t now = time(0);
+  std::vector< std::shared_ptr<StatShard> > shards;
+  {
+    // collect the shards and drop the ones of exited threads
+    XrdSysMutexHelper lock(mShardMutex);
+    std::vector< std::shared_ptr<StatShard> >::iterator it = mShards.begin();
+
+    while (it != mShards.end())
+    {
+      shards.push_back(*it);
+      if ((*it)->mDetached.load(std::memory_order_acquire))
+        it = mShards.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  for (size_t i = 0; i < shards.size(); i++)
+  {
+    StatShard::counter_map_t counters;
+    StatShard::exec_map_t execs;
+    {
+      XrdSysMutexHelper lock(shards[i]->mMutex);
+      counters.swap(shards[i]->mCounters);
+      execs.swap(shards[i]->mExec);
+    }
+
+    StatShard::counter_map_t::const_iterator cit;
+    for (cit = counters.begin(); cit != counters.end(); ++cit)
+    {
+      const char* tag = mTagById[cit->first.mTagId].load(std::memory_order_acquire)->mName.c_str();
+      StatsUid[tag][cit->first.mUid] += cit->second;
+      StatsGid[tag][cit->first.mGid] += cit->second;
+      StatAvgUid[tag][cit->first.mUid].AddAt(cit->second, cit->first.mTime, now);
+      StatAvgGid[tag][cit->first.mGid].AddAt(cit->second, cit->first.mTime, now);
+    }
+
+    StatShard::exec_map_t::const_iterator eit;
+    for (eit = execs.begin(); eit != execs.end(); ++eit)
+    {
+      const char* tag = mTagById[eit->first].load(std::memory_order_acquire)->mName.c_str();
+      const StatShard::ExecRing& ring = eit->second;
+      uint32_t first = 0;
+
+      if (ring.mCount > StatShard::ExecRing::sSize)
+        first = ring.mCount - StatShard::ExecRing::sSize;
+
+      for (uint32_t n = first; n < ring.mCount; n++)
+      {
+        AddExecLocked(tag, ring.mVal[n % StatShard::ExecRing::sSize]);
+      }
+    }
   }
-  Mutex.UnLock();
 }
 
 /*----------------------------------------------------------------------------*/
@@ -548,6 +830,7 @@ void
 Stat::Clear ()
 {
   Mutex.Lock();
+  FoldLocked();
   google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, unsigned long long> >::iterator ittag;
   for (ittag = StatsUid.begin(); ittag != StatsUid.end(); ittag++)
   {
@@ -561,14 +844,54 @@ Stat::Clear ()
     StatAvgGid[ittag->first].resize(1000);
     StatExec[ittag->first].resize(1000);
   }
+  for (int i = 0; i < sMaxTags; i++)
+  {
+    StatHisto* histo = mHistoById[i].load(std::memory_order_acquire);
+    if (histo)
+      histo->Reset();
+  }
   Mutex.UnLock();
 }
 
+/*----------------------------------------------------------------------------*/
+void
+Stat::PrintOutLatency (XrdOucString &out)
+{
+  static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+  std::map<std::string, StatHisto*> histos;
+
+  for (int i = 0; i < sMaxTags; i++)
+  {
+    StatHisto* histo = mHistoById[i].load(std::memory_order_acquire);
+    if (histo)
+      histos[mTagById[i].load(std::memory_order_acquire)->mName] = histo;
+  }
+
+  char outline[1024];
+  std::map<std::string, StatHisto*>::iterator it;
+
+  for (it = histos.begin(); it != histos.end(); ++it)
+  {
+    for (int w = 0; w < StatHisto::sWindows; w++)
+    {
+      double values[4];
+      double max = 0;
+      uint64_t n = it->second->GetWindow(w, quantiles, values, 4, max);
+      snprintf(outline, sizeof(outline), "uid=all gid=all cmd=%s:exec window=%ds "
+               "n=%llu p50=%.03f p90=%.03f p99=%.03f p99.9=%.03f max=%.03f\n",
+               it->first.c_str(), StatHisto::WindowSeconds(w), (unsigned long long) n,
+               values[0], values[1], values[2], values[3], max);
+      out += outline;
+    }
+  }
+}
+
 /*----------------------------------------------------------------------------*/
 void
 Stat::PrintOutTotal (XrdOucString &out, bool details, bool monitoring, bool numerical)
 {
   Mutex.Lock();
+  FoldLocked();
   std::vector<std::string> tags, tags_ext;
   std::vector<std::string>::iterator it;
 
@@ -645,6 +968,10 @@ Stat::PrintOutTotal (XrdOucString &out, bool details, bool monitoring, bool nume
     }
     out += outline;
   }
+  if (monitoring)
+  {
+    PrintOutLatency(out);
+  }
   for (it = tags_ext.begin(); it != tags_ext.end(); ++it)
   {
 
@@ -1188,6 +1515,14 @@ Stat::Circulate ()
     // --------------------------------------------
 
     Mutex.Lock();
+    FoldLocked();
+
+    for (int i = 0; i < sMaxTags; i++)
+    {
+      StatHisto* histo = mHistoById[i].load(std::memory_order_acquire);
+      if (histo)
+        histo->StampZero();
+    }
 
     google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, StatAvg> >::iterator tit;
     google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, StatExt> >::iterator tit_ext;
@@ -37,6 +37,9 @@
 #include <map>
 #include <string>
 #include <deque>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
 #include <math.h>
 
 EOSMGMNAMESPACE_BEGIN
@@ -59,6 +62,24 @@ public:
 
   ~StatAvg () { };
 
+  //! Add a value sampled at time_val which might be some seconds in the past,
+  //! bins which have already been recycled are skipped
+  void
+  AddAt (unsigned long val, int64_t time_val, int64_t now)
+  {
+    if (time_val >= now) {
+      Add(val);
+      return;
+    }
+
+    int64_t age = now - time_val;
+
+    if (age < 3599) avg3600[time_val % 3600] += val;
+    if (age < 299) avg300[time_val % 300] += val;
+    if (age < 59) avg60[time_val % 60] += val;
+    if (age < 4) avg5[time_val % 5] += val;
+  }
+
   void
   Add (unsigned long val)
   {
@@ -445,6 +466,180 @@ public:
 
 };
 
+//------------------------------------------------------------------------------
+//! Log-linear (HDR style) histogram of execution times in microseconds with
+//! 16 sub-buckets per power of two (~6% precision) up to ~71 minutes. Each of
+//! the 5s/60s/300s/3600s windows is made of 6 rotating slots of 1/5 of the
+//! window, the slot following the current one is zeroed by StampZero. The
+//! memory is fixed (~44 kB) and inserting is lock- and allocation-free.
+//------------------------------------------------------------------------------
+class StatHisto
+{
+public:
+  static const int sSubBits = 4;
+  static const int sSub = 1 << sSubBits;
+  static const int sMaxExp = 31;
+  static const int sBuckets = sSub + (sMaxExp - sSubBits + 1) * sSub;
+  static const int sWindows = 4;
+  static const int sSlots = 6;
+
+  struct Slot
+  {
+    std::atomic<uint32_t> mCount[sBuckets];
+    std::atomic<uint32_t> mMax;
+  };
+
+  StatHisto ()
+  {
+    Reset();
+    for (int w = 0; w < sWindows; w++)
+      mCleared[w] = -1;
+  }
+
+  ~StatHisto () { };
+
+  static int
+  WindowSeconds (int window)
+  {
+    static const int seconds[sWindows] = {5, 60, 300, 3600};
+    return seconds[window];
+  }
+
+  static int
+  Bucket (uint64_t us)
+  {
+    if (us < (uint64_t) sSub)
+      return (int) us;
+
+    if (us >> (sMaxExp + 1))
+      us = (1ull << (sMaxExp + 1)) - 1;
+
+    int exp = 63 - __builtin_clzll(us);
+    int sub = (us >> (exp - sSubBits)) & (sSub - 1);
+    return sSub + (exp - sSubBits) * sSub + sub;
+  }
+
+  //! value in the middle of a bucket in microseconds
+  static double
+  BucketValue (int bucket)
+  {
+    if (bucket < sSub)
+      return bucket;
+
+    int exp = (bucket - sSub) / sSub + sSubBits;
+    int sub = (bucket - sSub) % sSub;
+    double width = (double) (1ull << (exp - sSubBits));
+    return (sSub + sub) * width + width / 2;
+  }
+
+  void
+  Insert (float exectime_ms)
+  {
+    uint64_t us = (exectime_ms > 0) ? (uint64_t) (exectime_ms * 1000.0) : 0;
+    int bucket = Bucket(us);
+    uint32_t max = (us > 0xffffffffull) ? 0xffffffff : (uint32_t) us;
+    int64_t now = time(0);
+
+    for (int w = 0; w < sWindows; w++)
+    {
+      int64_t len = WindowSeconds(w) / 5;
+      Slot& slot = mSlots[w][(now / len) % sSlots];
+      slot.mCount[bucket].fetch_add(1, std::memory_order_relaxed);
+      uint32_t old = slot.mMax.load(std::memory_order_relaxed);
+
+      while ((old < max) &&
+             !slot.mMax.compare_exchange_weak(old, max, std::memory_order_relaxed));
+    }
+  }
+
+  //! zero the slot following the current one in every window - not thread
+  //! safe against itself, called periodically by one thread
+  void
+  StampZero ()
+  {
+    int64_t now = time(0);
+
+    for (int w = 0; w < sWindows; w++)
+    {
+      int64_t next = now / (WindowSeconds(w) / 5) + 1;
+
+      if (mCleared[w] != next)
+      {
+        ClearSlot(mSlots[w][next % sSlots]);
+        mCleared[w] = next;
+      }
+    }
+  }
+
+  void
+  Reset ()
+  {
+    for (int w = 0; w < sWindows; w++)
+      for (int i = 0; i < sSlots; i++)
+        ClearSlot(mSlots[w][i]);
+  }
+
+  //! number of samples, quantiles and maximum (in ms) of a window
+  uint64_t
+  GetWindow (int window, const double* quantiles, double* values, int nquantiles, double &max_ms)
+  {
+    uint64_t counts[sBuckets];
+    uint64_t n = 0;
+    uint32_t max = 0;
+    memset(counts, 0, sizeof(counts));
+
+    for (int i = 0; i < sSlots; i++)
+    {
+      Slot& slot = mSlots[window][i];
+      for (int b = 0; b < sBuckets; b++)
+      {
+        uint32_t c = slot.mCount[b].load(std::memory_order_relaxed);
+        counts[b] += c;
+        n += c;
+      }
+      max = std::max(max, slot.mMax.load(std::memory_order_relaxed));
+    }
+
+    max_ms = max / 1000.0;
+
+    for (int q = 0; q < nquantiles; q++)
+    {
+      uint64_t rank = (uint64_t) ceil(quantiles[q] * n);
+      uint64_t sum = 0;
+      values[q] = 0;
+
+      if (!n)
+        continue;
+
+      if (!rank)
+        rank = 1;
+
+      for (int b = 0; b < sBuckets; b++)
+      {
+        sum += counts[b];
+        if (sum >= rank)
+        {
+          values[q] = std::min(BucketValue(b) / 1000.0, max_ms);
+          break;
+        }
+      }
+    }
+
+    return n;
+  }
+
+private:
+  static void
+  ClearSlot (Slot& slot)
+  {
+    for (int b = 0; b < sBuckets; b++)
+      slot.mCount[b].store(0, std::memory_order_relaxed);
+    slot.mMax.store(0, std::memory_order_relaxed);
+  }
+
+  Slot mSlots[sWindows][sSlots];
+  int64_t mCleared[sWindows]; ///< last slot epoch zeroed per window
+};
 
 #define EXEC_TIMING_BEGIN(__ID__)               \
   struct timeval start__ID__;                   \
@@ -454,11 +649,70 @@ public:
 
 #define EXEC_TIMING_END(__ID__)                                         \
   gettimeofday(&stop__ID__, &tz__ID__);                                 \
-  gOFS->MgmStats.AddExec(__ID__, ((stop__ID__.tv_sec-start__ID__.tv_sec)*1000.0) + ((stop__ID__.tv_usec-start__ID__.tv_usec)/1000.0) );
+  {                                                                     \
+    static const int tagid__ID__ = gOFS->MgmStats.GetTagId(__ID__);     \
+    gOFS->MgmStats.AddExec(tagid__ID__, ((stop__ID__.tv_sec-start__ID__.tv_sec)*1000.0) + ((stop__ID__.tv_usec-start__ID__.tv_usec)/1000.0) ); \
+  }
+
+//------------------------------------------------------------------------------
+//! Per-thread accumulator of the values given to Stat::Add/AddExec. Values are
+//! summed per (tag, uid, gid, second) so the work done by Stat::Fold depends on
+//! the number of distinct keys and not on the rate. The mutex is only shared
+//! between the owner thread and Stat::Fold, so it is practically never
+//! contended.
+//------------------------------------------------------------------------------
+struct StatShard
+{
+  struct Key
+  {
+    uint32_t mTagId;
+    uint32_t mTime;
+    uid_t mUid;
+    gid_t mGid;
+
+    bool operator== (const Key& other) const
+    {
+      return ((mTagId == other.mTagId) && (mTime == other.mTime) &&
+              (mUid == other.mUid) && (mGid == other.mGid));
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator() (const Key& key) const
+    {
+      uint64_t h = ((uint64_t) key.mTagId << 32) ^ key.mTime;
+      h ^= (((uint64_t) key.mUid << 32) | key.mGid) * 0x9e3779b97f4a7c15ull;
+      return h ^ (h >> 29);
+    }
+  };
+
+  //! The last execution times of a tag, at most as many as Stat keeps
+  struct ExecRing
+  {
+    static const uint32_t sSize = 100;
+    float mVal[sSize];
+    uint32_t mCount;
+
+    ExecRing (): mCount(0) { }
+  };
+
+  typedef std::unordered_map<Key, unsigned long long, KeyHash> counter_map_t;
+  typedef std::unordered_map<uint32_t, ExecRing> exec_map_t;
+
+  StatShard (): mDetached(false) { }
+
+  XrdSysMutex mMutex;
+  counter_map_t mCounters;
+  exec_map_t mExec;
+  std::atomic<bool> mDetached; ///< owner thread exited
+};
 
 class Stat
 {
 public:
+  //! Protects the maps below - readers have to take it, the values given to
+  //! Add/AddExec are only folded into the maps while holding it
   XrdSysMutex Mutex;
 
   // first is name of value, then the map
@@ -470,12 +724,30 @@ public:
   google::sparse_hash_map<std::string, google::sparse_hash_map<gid_t, StatExt> > StatExtGid;
   google::sparse_hash_map<std::string, std::deque<float> > StatExec;
 
+  Stat ();
+
+  ~Stat ();
+
+  // get the id of a tag, registering it on first use - returns -1 if the tag
+  // table is full
+  int GetTagId (const char* tag);
+
   void Add (const char* tag, uid_t uid, gid_t gid, unsigned long val);
 
+  // add with the id of a tag - hot callers keep the id of GetTagId in a
+  // static, a failed registration (-1) drops the value
+  void Add (int tagid, uid_t uid, gid_t gid, unsigned long val);
+
   void AddExt (const char* tag, uid_t uid, gid_t gid, unsigned long nsample, const double &avgv, const double &minv, const double &maxv);
 
   void AddExec (const char* tag, float exectime);
 
+  void AddExec (int tagid, float exectime);
+
+  // fold the values pending in the per-thread shards into the maps - it is
+  // done by Circulate every 512 ms and before printing
+  void Fold ();
+
   unsigned long long GetTotal (const char* tag);
 
   // warning: you have to lock the mutex if directly used
@@ -516,7 +788,35 @@ public:
 
   void PrintOutTotal (XrdOucString &out, bool details = false, bool monitoring = false, bool numerical = false);
 
+  // print the execution time quantiles of all tags in monitoring format
+  void PrintOutLatency (XrdOucString &out);
+
   void Circulate ();
+
+private:
+  static const int sMaxTags = 2048;
+  static const int sTagTableSize = 4096;
+
+  struct StatTag {
+    std::string mName;
+    uint64_t mHash;
+    int mId;
+  };
+
+  StatShard* GetShard ();
+  StatHisto* GetHisto (int tagid);
+  void FoldLocked ();
+  void AddLocked (const char* tag, uid_t uid, gid_t gid, unsigned long val);
+  void AddExecLocked (const char* tag, float exectime);
+
+  uint64_t mInstance; ///< unique id used to find the thread's shard
+  std::atomic<StatTag*> mTagTable[sTagTableSize]; ///< open addressing by name
+  std::atomic<StatTag*> mTagById[sMaxTags];
+  std::atomic<StatHisto*> mHistoById[sMaxTags]; ///< created on first AddExec
+  int mNumTags; ///< protected by mTagMutex
+  XrdSysMutex mTagMutex;
+  std::vector< std::shared_ptr<StatShard> > mShards; ///< under mShardMutex
+  XrdSysMutex mShardMutex;
 };
 
 EOSMGMNAMESPACE_END
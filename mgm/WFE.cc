@@ -773,11 +773,12 @@ WFE::Job::DoIt()
             cfmd->getMTime(mtime);
             std::string checksum;
             size_t cxlen = eos::common::LayoutId::GetChecksumLen(cfmd->getLayoutId());
+            eos::Buffer fmdchecksum = cfmd->getChecksum();
 
             for (unsigned int i = 0; i < cxlen; i++) {
               char hb[3];
               sprintf(hb, "%02x", (i < cxlen) ? (unsigned char)(
-                        cfmd->getChecksum().getDataPadded(i)) : 0);
+                        fmdchecksum.getDataPadded(i)) : 0);
               checksum += hb;
             }
 
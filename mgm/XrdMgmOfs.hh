@@ -511,6 +511,14 @@ public:
             bool follow = true,
             std::string* uri = 0);
 
+  // ---------------------------------------------------------------------------
+  // fill stat information from file or container metadata as returned by
+  // _stat, the caller has to hold a lock on eosViewRWMutex
+  // ---------------------------------------------------------------------------
+  void _stat_file(eos::IFileMD* fmd, struct stat* buf);
+
+  void _stat_container(eos::IContainerMD* cmd, struct stat* buf);
+
 
   // ---------------------------------------------------------------------------
   // stat file to retrieve mode
@@ -191,11 +191,12 @@ XrdMgmOfs::chksum (XrdSfsFileSystem::csFunc Func,
   // copy the checksum buffer
   const char *hv = "0123456789abcdef";
   size_t j = strlen(buff);
+  eos::Buffer fmdchecksum = fmd->getChecksum();
   for (size_t i = 0; i < eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId()); i++)
   {
 
-    buff[j++] = hv[(fmd->getChecksum().getDataPadded(i) >> 4) & 0x0f];
-    buff[j++] = hv[ fmd->getChecksum().getDataPadded(i) & 0x0f];
+    buff[j++] = hv[(fmdchecksum.getDataPadded(i) >> 4) & 0x0f];
+    buff[j++] = hv[ fmdchecksum.getDataPadded(i) & 0x0f];
   }
   if (j == 0)
   {
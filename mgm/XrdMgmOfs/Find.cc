@@ -294,6 +294,8 @@ XrdMgmOfs::_find (const char *path,
 	  std::shared_ptr<eos::IFileMD> fmd;
 	  std::string link;
 	  std::set<std::string> fnames = cmd->getNameFiles();
+	  // fetch the file metadata in bulk rather than one by one
+	  cmd->prefetchFiles();
 
           for (auto fit = fnames.begin(); fit != fnames.end(); ++fit)
           {
@@ -528,6 +528,11 @@ XrdMgmOfs::_rename(const char* old_name,
             eosView->updateContainerStore(rdir.get());
           } else {
             // Remove from one container to another one
+            if (gOFS->eosContainerAccounting) {
+              // The moved tree size has to include the queued changes
+              gOFS->eosContainerAccounting->flushPendingUpdates();
+            }
+
             unsigned long long tree_size = rdir->getTreeSize();
             {
               // update the source directory - remove the directory
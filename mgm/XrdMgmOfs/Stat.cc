@@ -132,7 +132,8 @@ XrdMgmOfs::_stat(const char* path,
 {
   static const char* epname = "_stat";
   EXEC_TIMING_BEGIN("Stat");
-  gOFS->MgmStats.Add("Stat", vid.uid, vid.gid, 1);
+  static const int sStatTag = gOFS->MgmStats.GetTagId("Stat");
+  gOFS->MgmStats.Add(sStatTag, vid.uid, vid.gid, 1);
   // ---------------------------------------------------------------------------
   // try if that is a file
   errno = 0;
@@ -165,62 +166,7 @@ XrdMgmOfs::_stat(const char* path,
   }
 
   if (fmd) {
-    memset(buf, 0, sizeof(struct stat));
-    buf->st_dev = 0xcaff;
-    buf->st_ino = eos::common::FileId::FidToInode(fmd->getId());
-
-    if (fmd->isLink()) {
-      buf->st_mode = S_IFLNK;
-    } else {
-      buf->st_mode = S_IFREG;
-    }
-
-    uint16_t flags = fmd->getFlags();
-
-    if (fmd->isLink()) {
-      buf->st_mode |= (S_IRWXU | S_IRWXG | S_IRWXO);
-      buf->st_nlink = 1;
-    } else {
-      if (!flags) {
-        buf->st_mode |= (S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR);
-      } else {
-        buf->st_mode |= flags;
-      }
-
-      buf->st_nlink = fmd->getNumLocation();
-    }
-
-    buf->st_uid = fmd->getCUid();
-    buf->st_gid = fmd->getCGid();
-    buf->st_rdev = 0; /* device type (if inode device) */
-    buf->st_size = fmd->getSize();
-    buf->st_blksize = 512;
-    buf->st_blocks = Quota::MapSizeCB(fmd.get()) / 512; // including layout factor
-    eos::IFileMD::ctime_t atime;
-    // adding also nanosecond to stat struct
-    fmd->getCTime(atime);
-#ifdef __APPLE__
-    buf->st_ctimespec.tv_sec = atime.tv_sec;
-    buf->st_ctimespec.tv_nsec = atime.tv_nsec;
-#else
-    buf->st_ctime = atime.tv_sec;
-    buf->st_ctim.tv_sec = atime.tv_sec;
-    buf->st_ctim.tv_nsec = atime.tv_nsec;
-#endif
-    fmd->getMTime(atime);
-#ifdef __APPLE__
-    buf->st_mtimespec.tv_sec = atime.tv_sec;
-    buf->st_mtimespec.tv_nsec = atime.tv_nsec;
-    buf->st_atimespec.tv_sec = atime.tv_sec;
-    buf->st_atimespec.tv_nsec = atime.tv_nsec;
-#else
-    buf->st_mtime = atime.tv_sec;
-    buf->st_mtim.tv_sec = atime.tv_sec;
-    buf->st_mtim.tv_nsec = atime.tv_nsec;
-    buf->st_atime = atime.tv_sec;
-    buf->st_atim.tv_sec = atime.tv_sec;
-    buf->st_atim.tv_nsec = atime.tv_nsec;
-#endif
+    _stat_file(fmd.get(), buf);
 
     if (etag) {
       // if there is a checksum we use the checksum, otherwise we return inode+mtime
@@ -238,11 +184,12 @@ XrdMgmOfs::_stat(const char* path,
         } else {
           *etag = "";
         }
+        eos::Buffer fmdchecksum = fmd->getChecksum();
 
         for (unsigned int i = 0; i < cxlen; i++) {
           char hb[3];
           sprintf(hb, "%02x", (i < cxlen) ? (unsigned char)(
-                    fmd->getChecksum().getDataPadded(i)) : 0);
+                    fmdchecksum.getDataPadded(i)) : 0);
           *etag += hb;
         }
 
@@ -273,54 +220,12 @@ XrdMgmOfs::_stat(const char* path,
       *uri = gOFS->eosView->getUri(cmd.get());
     }
 
-    memset(buf, 0, sizeof(struct stat));
-    buf->st_dev = 0xcaff;
-    buf->st_ino = cmd->getId();
-    buf->st_mode = cmd->getMode();
-
-    if (cmd->attributesBegin() != cmd->attributesEnd()) {
-      buf->st_mode |= S_ISVTX;
+    if (gOFS->eosContainerAccounting) {
+      // Propagate the queued tree size changes
+      gOFS->eosContainerAccounting->flushPendingUpdates();
     }
 
-    buf->st_nlink = 1;
-    buf->st_uid = cmd->getCUid();
-    buf->st_gid = cmd->getCGid();
-    buf->st_rdev = 0; /* device type (if inode device) */
-    buf->st_size = cmd->getTreeSize();
-    buf->st_blksize = cmd->getNumContainers() + cmd->getNumFiles();
-    buf->st_blocks = 0;
-    eos::IContainerMD::ctime_t ctime;
-    eos::IContainerMD::ctime_t mtime;
-    eos::IContainerMD::ctime_t tmtime;
-    cmd->getCTime(ctime);
-    cmd->getMTime(mtime);
-
-    if (gOFS->eosSyncTimeAccounting) {
-      cmd->getTMTime(tmtime);
-    } else
-      // if there is no sync time accounting we just use the normal modification time
-    {
-      tmtime = mtime;
-    }
-
-#ifdef __APPLE__
-    buf->st_atimespec.tv_sec = tmtime.tv_sec;
-    buf->st_mtimespec.tv_sec = mtime.tv_sec;
-    buf->st_ctimespec.tv_sec = ctime.tv_sec;
-    buf->st_atimespec.tv_nsec = tmtime.tv_nsec;
-    buf->st_mtimespec.tv_nsec = mtime.tv_nsec;
-    buf->st_ctimespec.tv_nsec = ctime.tv_nsec;
-#else
-    buf->st_atime = tmtime.tv_sec;
-    buf->st_mtime = mtime.tv_sec;
-    buf->st_ctime = ctime.tv_sec;
-    buf->st_atim.tv_sec = tmtime.tv_sec;
-    buf->st_mtim.tv_sec = mtime.tv_sec;
-    buf->st_ctim.tv_sec = ctime.tv_sec;
-    buf->st_atim.tv_nsec = tmtime.tv_nsec;
-    buf->st_mtim.tv_nsec = mtime.tv_nsec;
-    buf->st_ctim.tv_nsec = ctime.tv_nsec;
-#endif
+    _stat_container(cmd.get(), buf);
 
     if (etag) {
       // use inode + mtime
@@ -340,6 +245,126 @@ XrdMgmOfs::_stat(const char* path,
   }
 }
 
+//------------------------------------------------------------------------------
+// Fill stat information from file metadata
+//------------------------------------------------------------------------------
+void
+XrdMgmOfs::_stat_file(eos::IFileMD* fmd, struct stat* buf)
+{
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_dev = 0xcaff;
+  buf->st_ino = eos::common::FileId::FidToInode(fmd->getId());
+
+  if (fmd->isLink()) {
+    buf->st_mode = S_IFLNK;
+  } else {
+    buf->st_mode = S_IFREG;
+  }
+
+  uint16_t flags = fmd->getFlags();
+
+  if (fmd->isLink()) {
+    buf->st_mode |= (S_IRWXU | S_IRWXG | S_IRWXO);
+    buf->st_nlink = 1;
+  } else {
+    if (!flags) {
+      buf->st_mode |= (S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR);
+    } else {
+      buf->st_mode |= flags;
+    }
+
+    buf->st_nlink = fmd->getNumLocation();
+  }
+
+  buf->st_uid = fmd->getCUid();
+  buf->st_gid = fmd->getCGid();
+  buf->st_rdev = 0; /* device type (if inode device) */
+  buf->st_size = fmd->getSize();
+  buf->st_blksize = 512;
+  buf->st_blocks = Quota::MapSizeCB(fmd) / 512; // including layout factor
+  eos::IFileMD::ctime_t atime;
+  // adding also nanosecond to stat struct
+  fmd->getCTime(atime);
+#ifdef __APPLE__
+  buf->st_ctimespec.tv_sec = atime.tv_sec;
+  buf->st_ctimespec.tv_nsec = atime.tv_nsec;
+#else
+  buf->st_ctime = atime.tv_sec;
+  buf->st_ctim.tv_sec = atime.tv_sec;
+  buf->st_ctim.tv_nsec = atime.tv_nsec;
+#endif
+  fmd->getMTime(atime);
+#ifdef __APPLE__
+  buf->st_mtimespec.tv_sec = atime.tv_sec;
+  buf->st_mtimespec.tv_nsec = atime.tv_nsec;
+  buf->st_atimespec.tv_sec = atime.tv_sec;
+  buf->st_atimespec.tv_nsec = atime.tv_nsec;
+#else
+  buf->st_mtime = atime.tv_sec;
+  buf->st_mtim.tv_sec = atime.tv_sec;
+  buf->st_mtim.tv_nsec = atime.tv_nsec;
+  buf->st_atime = atime.tv_sec;
+  buf->st_atim.tv_sec = atime.tv_sec;
+  buf->st_atim.tv_nsec = atime.tv_nsec;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Fill stat information from container metadata
+//------------------------------------------------------------------------------
+void
+XrdMgmOfs::_stat_container(eos::IContainerMD* cmd, struct stat* buf)
+{
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_dev = 0xcaff;
+  buf->st_ino = cmd->getId();
+  buf->st_mode = cmd->getMode();
+
+  if (cmd->attributesBegin() != cmd->attributesEnd()) {
+    buf->st_mode |= S_ISVTX;
+  }
+
+  buf->st_nlink = 1;
+  buf->st_uid = cmd->getCUid();
+  buf->st_gid = cmd->getCGid();
+  buf->st_rdev = 0; /* device type (if inode device) */
+  buf->st_size = cmd->getTreeSize();
+  buf->st_blksize = cmd->getNumContainers() + cmd->getNumFiles();
+  buf->st_blocks = 0;
+  eos::IContainerMD::ctime_t ctime;
+  eos::IContainerMD::ctime_t mtime;
+  eos::IContainerMD::ctime_t tmtime;
+  cmd->getCTime(ctime);
+  cmd->getMTime(mtime);
+
+  if (gOFS->eosSyncTimeAccounting) {
+    cmd->getTMTime(tmtime);
+  } else
+    // if there is no sync time accounting we just use the normal modification time
+  {
+    tmtime = mtime;
+  }
+
+#ifdef __APPLE__
+  buf->st_atimespec.tv_sec = tmtime.tv_sec;
+  buf->st_mtimespec.tv_sec = mtime.tv_sec;
+  buf->st_ctimespec.tv_sec = ctime.tv_sec;
+  buf->st_atimespec.tv_nsec = tmtime.tv_nsec;
+  buf->st_mtimespec.tv_nsec = mtime.tv_nsec;
+  buf->st_ctimespec.tv_nsec = ctime.tv_nsec;
+#else
+  buf->st_atime = tmtime.tv_sec;
+  buf->st_mtime = mtime.tv_sec;
+  buf->st_ctime = ctime.tv_sec;
+  buf->st_atim.tv_sec = tmtime.tv_sec;
+  buf->st_mtim.tv_sec = mtime.tv_sec;
+  buf->st_ctim.tv_sec = ctime.tv_sec;
+  buf->st_atim.tv_nsec = tmtime.tv_nsec;
+  buf->st_mtim.tv_nsec = mtime.tv_nsec;
+  buf->st_ctim.tv_nsec = ctime.tv_nsec;
+#endif
+}
+
 //------------------------------------------------------------------------------
 // Stat following links (not existing in EOS - behaves like stat)
 //------------------------------------------------------------------------------
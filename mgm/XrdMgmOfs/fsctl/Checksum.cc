@@ -44,10 +44,11 @@
   {
     fmd = gOFS->eosView->getFile(spath.c_str());
     size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId());
+    eos::Buffer fmdchecksum = fmd->getChecksum();
     for (unsigned int i = 0; i < SHA_DIGEST_LENGTH; i++)
     {
       char hb[3];
-      sprintf(hb, "%02x", (i < cxlen) ? (unsigned char) (fmd->getChecksum().getDataPadded(i)) : 0);
+      sprintf(hb, "%02x", (i < cxlen) ? (unsigned char) (fmdchecksum.getDataPadded(i)) : 0);
       checksum += hb;
     }
   }
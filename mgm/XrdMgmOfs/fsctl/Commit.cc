@@ -271,9 +271,10 @@
 
             bool cxError = false;
             size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId());
+            eos::Buffer fmdchecksum = fmd->getChecksum();
 
             for (size_t i = 0; i < cxlen; i++) {
-              if (fmd->getChecksum().getDataPadded(i) != checksumbuffer.getDataPadded(i)) {
+              if (fmdchecksum.getDataPadded(i) != checksumbuffer.getDataPadded(i)) {
                 cxError = true;
               }
             }
@@ -318,9 +319,10 @@
           if (verifychecksum) {
             bool cxError = false;
             size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId());
+            eos::Buffer fmdchecksum = fmd->getChecksum();
 
             for (size_t i = 0; i < cxlen; i++) {
-              if (fmd->getChecksum().getDataPadded(i) != checksumbuffer.getDataPadded(i)) {
+              if (fmdchecksum.getDataPadded(i) != checksumbuffer.getDataPadded(i)) {
                 cxError = true;
               }
             }
@@ -406,8 +408,10 @@
 
         if (commitchecksum) {
           if (!isUpdate) {
+            eos::Buffer fmdchecksum = fmd->getChecksum();
+
             for (int i = 0; i < SHA_DIGEST_LENGTH; i++) {
-              if (fmd->getChecksum().getDataPadded(i) != checksumbuffer.getDataPadded(i)) {
+              if (fmdchecksum.getDataPadded(i) != checksumbuffer.getDataPadded(i)) {
                 eos_thread_debug("checksum difference forces mtime");
                 isUpdate = true;
               }
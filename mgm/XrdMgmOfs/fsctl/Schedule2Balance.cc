@@ -55,6 +55,8 @@
   static std::map<std::string, size_t> sGroupCycle;
   static XrdSysMutex sGroupCycleMutex;
   static time_t sScheduledFidCleanupTime = 0;
+  // number of random source files tried per request
+  static const size_t sBalanceCandidates = 64;
 
   if (alogid)
   {
@@ -185,25 +187,48 @@
 
     source_fs->SnapShotFileSystem(source_snapshot);
     eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex);
-    eos::IFsView::FileList source_filelist = gOFS->eosFsView->getFileList(
-          source_fsid);
-    eos::IFsView::FileList target_filelist = gOFS->eosFsView->getFileList(
-          target_fsid);
-    unsigned long long nfids = (unsigned long long) source_filelist.size();
+    unsigned long long nfids = gOFS->eosFsView->getNumFilesOnFs(source_fsid);
     eos_thread_debug("group=%s cycle=%lu source_fsid=%u target_fsid=%u n_source_fids=%llu",
                      target_snapshot.mGroup.c_str(), gposition, source_fsid, target_fsid, nfids);
-    unsigned long long rpos = (unsigned long long)((0.999999 * random() * nfids) /
-                              RAND_MAX);
-    eos::IFsView::FileIterator fit = source_filelist.begin();
-    std::advance(fit, rpos);
+    // try a random sample of the source files first, the cost does not depend
+    // on the number of files on the source. If none of them can be moved we
+    // walk all the source files in place.
+    std::vector<eos::IFileMD::id_t> candidates =
+      gOFS->eosFsView->getRandomFiles(source_fsid, sBalanceCandidates);
+    std::vector<eos::IFileMD::id_t>::const_iterator sit = candidates.begin();
+    eos::IFsView::FileListCursor fit;
+    eos::IFileMD::id_t fid = 0;
+    auto next_candidate = [&]() -> bool {
+      if (sit != candidates.end()) {
+        fid = *sit++;
+        return true;
+      }
 
-    while (fit != source_filelist.end()) {
-      // check that the target does not have this file
-      eos::IFileMD::id_t fid = *fit;
+      if (!fit) {
+        if (candidates.size() >= nfids) {
+          // the sample contained all the files of the source
+          return false;
+        }
 
-      if (target_filelist.count(fid)) {
+        eos_thread_debug("msg=\"no candidate in the random sample, walking the "
+                         "source\" source_fsid=%u", source_fsid);
+        fit = gOFS->eosFsView->getFileListCursor(source_fsid);
+      } else {
+        fit->next();
+      }
+
+      if (!fit->valid()) {
+        return false;
+      }
+
+      fid = fit->getElement();
+      return true;
+    };
+
+    while (next_candidate()) {
+      // check that the target does not have this file
+      if (gOFS->eosFsView->hasFileId(fid, target_fsid)) {
         // iterate to the next file, we have this file already
-        fit++;
         eos_static_debug("skip fid=%ld - existing on target", fid);
         continue;
       } else {
@@ -232,7 +257,6 @@
         if ((ScheduledToBalanceFid.count(fid) &&
              ((ScheduledToBalanceFid[fid] > (now))))) {
           // iterate to the next file, we have scheduled this file during the last hour or anyway it is empty
-          fit++;
           eos_static_debug("skip fid=%ld - scheduled during last hour", fid);
           continue;
         } else {
@@ -243,6 +267,7 @@
           uid_t uid = 0;
           gid_t gid = 0;
           std::string fullpath = "";
+          XrdOucString xs_cgi = "";
 
           try {
             fmd = gOFS->eosFileService->getFileMD(fid);
@@ -258,6 +283,26 @@
             size = fmd->getSize();
             uid = fmd->getCUid();
             gid = fmd->getCGid();
+
+            // Plain and replica files are copied as a whole, the FST verifies
+            // the copy against the checksum of the namespace
+            if (((eos::common::LayoutId::GetLayoutType(lid) ==
+                  eos::common::LayoutId::kPlain) ||
+                 (eos::common::LayoutId::GetLayoutType(lid) ==
+                  eos::common::LayoutId::kReplica)) &&
+                (eos::common::LayoutId::GetChecksum(lid) != eos::common::LayoutId::kNone)) {
+              size_t cxlen = eos::common::LayoutId::GetChecksumLen(lid);
+              eos::Buffer fmdchecksum = fmd->getChecksum();
+              xs_cgi = "&tx.checksum=";
+              xs_cgi += eos::common::LayoutId::GetChecksumString(lid);
+              xs_cgi += "&tx.checksum.value=";
+
+              for (unsigned int i = 0; i < cxlen; i++) {
+                char hb[3];
+                sprintf(hb, "%02x", (unsigned char)(fmdchecksum.getDataPadded(i)));
+                xs_cgi += hb;
+              }
+            }
           } catch (eos::MDException& e) {
             fmd.reset();
           }
@@ -393,6 +438,7 @@
                 target_cap += hexfid;
                 fullcapability += source_cap;
                 fullcapability += target_cap;
+                fullcapability += xs_cgi;
                 XrdOucString response = "submitted";
                 error.setErrInfo(response.length() + 1, response.c_str());
 
@@ -433,12 +479,10 @@
                 return SFS_DATA;
               }
             } else {
-              fit++;
               eos_static_debug("skip fid=%ld - zero sized file", fid);
               continue;
             }
           } else {
-            fit++;
             eos_static_debug("skip fid=%ld - cannot get fmd record", fid);
             continue;
           }
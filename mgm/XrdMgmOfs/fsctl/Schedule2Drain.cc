@@ -224,24 +224,21 @@
     // Lock namespace view here to avoid deadlock with the Commit.cc code on
     // the ScheduledToDrainFidMutex
     eos::common::RWMutexReadLock nsLock(gOFS->eosViewRWMutex);
-    eos::IFsView::FileList source_filelist = gOFS->eosFsView->getFileList(
-          source_fsid);
-    eos::IFsView::FileList target_filelist = gOFS->eosFsView->getFileList(
-          target_fsid);
-    unsigned long long nfids = (unsigned long long) source_filelist.size();
+    unsigned long long nfids = gOFS->eosFsView->getNumFilesOnFs(source_fsid);
     eos_thread_debug("group=%s cycle=%lu source_fsid=%u target_fsid=%u n_source_fids=%llu",
                      target_snapshot.mGroup.c_str(), gposition, source_fsid, target_fsid, nfids);
-    // give the oldest file first
-    eos::IFsView::FileIterator fit = source_filelist.begin();
+    // walk the source files in place, without copying the file lists
+    eos::IFsView::FileListCursor fit = gOFS->eosFsView->getFileListCursor(
+                                         source_fsid);
 
-    while (fit != source_filelist.end()) {
-      eos_thread_debug("checking fid %llx", *fit);
+    while (fit->valid()) {
       // check that the target does not have this file
-      eos::IFileMD::id_t fid = *fit;
+      eos::IFileMD::id_t fid = fit->getElement();
+      eos_thread_debug("checking fid %llx", fid);
 
-      if (target_filelist.count(fid)) {
+      if (gOFS->eosFsView->hasFileId(fid, target_fsid)) {
         // iterate to the next file, we have this file already
-        fit++;
+        fit->next();
         continue;
       } else {
         // check that this file has not been scheduled during the 1h period
@@ -268,7 +265,7 @@
 
         if ((ScheduledToDrainFid.count(fid) && ((ScheduledToDrainFid[fid] > (now))))) {
           // iterate to the next file, we have scheduled this file during the last hour or anyway it is empty
-          fit++;
+          fit->next();
           eos_thread_debug("file %llx has already been scheduled at %lu", fid,
                            ScheduledToDrainFid[fid]);
           continue;
@@ -286,12 +283,12 @@
             fullpath = savepath.c_str();
             fmd = gOFS->eosFileService->getFileMD(fid);
           } catch (eos::MDException& e) {
-            fit++;
+            fit->next();
             continue;
           }
 
           if (!fmd) {
-            fit++;
+            fit->next();
             continue;
           }
 
@@ -301,6 +298,28 @@
           unsigned long long size = fmd->getSize();
           uid_t uid = fmd->getCUid();
           gid_t gid = fmd->getCGid();
+          // Plain and replica files are copied as a whole, the FST verifies
+          // the copy against the checksum of the namespace
+          XrdOucString xs_cgi = "";
+
+          if (((eos::common::LayoutId::GetLayoutType(lid) ==
+                eos::common::LayoutId::kPlain) ||
+               (eos::common::LayoutId::GetLayoutType(lid) ==
+                eos::common::LayoutId::kReplica)) &&
+              (eos::common::LayoutId::GetChecksum(lid) != eos::common::LayoutId::kNone)) {
+            size_t cxlen = eos::common::LayoutId::GetChecksumLen(lid);
+            eos::Buffer fmdchecksum = fmd->getChecksum();
+            xs_cgi = "&tx.checksum=";
+            xs_cgi += eos::common::LayoutId::GetChecksumString(lid);
+            xs_cgi += "&tx.checksum.value=";
+
+            for (unsigned int i = 0; i < cxlen; i++) {
+              char hb[3];
+              sprintf(hb, "%02x", (unsigned char)(fmdchecksum.getDataPadded(i)));
+              xs_cgi += hb;
+            }
+          }
+
           eos::IFileMD::LocationVector::const_iterator lociter;
           eos::IFileMD::LocationVector loc_vect = fmd->getLocations();
 
@@ -383,7 +402,7 @@
                                fid, retc);
                 ScheduledToDrainFid[fid] = time(NULL) + 60;
                 // try with next file
-                fit++;
+                fit->next();
                 continue;
               } else if (Quota::FileAccess(&acsargs)) {
                 // inaccessible files we retry after 60 seconds
@@ -391,7 +410,7 @@
                                retc);
                 ScheduledToDrainFid[fid] = time(NULL) + 60;
                 // try with next file
-                fit++;
+                fit->next();
                 continue;
               }
             } else {
@@ -406,7 +425,7 @@
               replica_source_fs = FsView::gFsView.mIdView[locationfs[fsindex]];
 
               if (!replica_source_fs) {
-                fit++;
+                fit->next();
                 continue;
               }
 
@@ -538,6 +557,7 @@
                 target_cap += hexfid;
                 fullcapability += source_cap;
                 fullcapability += target_cap;
+                fullcapability += xs_cgi;
               }
 
               if (source_capabilityenv) {
@@ -548,7 +568,7 @@
                 delete target_capabilityenv;
               }
             } else {
-              fit++;
+              fit->next();
               continue;
             }
           }
@@ -569,7 +589,7 @@
               }
 
               // try to find another one to hand out
-              fit++;
+              fit->next();
               continue;
             } else {
               if (fullpath.find(EOS_COMMON_PATH_ATOMIC_FILE_PREFIX) != std::string::npos) {
@@ -585,7 +605,7 @@
                 }
 
                 // try to find another one to hand out
-                fit++;
+                fit->next();
                 continue;
               }
 
@@ -192,12 +192,13 @@
           response += "value=";
           char hb[4];
           size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId());
+          eos::Buffer fmdchecksum = fmd->getChecksum();
 
           for (unsigned int i = 0; i < cxlen; i++) {
             if ((i + 1) == cxlen) {
-              sprintf(hb, "%02x ", (unsigned char)(fmd->getChecksum().getDataPadded(i)));
+              sprintf(hb, "%02x ", (unsigned char)(fmdchecksum.getDataPadded(i)));
             } else {
-              sprintf(hb, "%02x_", (unsigned char)(fmd->getChecksum().getDataPadded(i)));
+              sprintf(hb, "%02x_", (unsigned char)(fmdchecksum.getDataPadded(i)));
             }
 
             response += hb;
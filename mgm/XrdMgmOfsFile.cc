@@ -395,7 +395,8 @@ XrdMgmOfsFile::open(const char* inpath,
                   " the requested permissions for that operation (1)", path);
     }
 
-    gOFS->MgmStats.Add("OpenProc", vid.uid, vid.gid, 1);
+    static const int sOpenProcTag = gOFS->MgmStats.GetTagId("OpenProc");
+    gOFS->MgmStats.Add(sOpenProcTag, vid.uid, vid.gid, 1);
 
     if (!ProcInterface::Authorize(path, info, vid, client)) {
       return Emsg(epname, error, EPERM, "execute proc command - you don't have "
@@ -407,7 +408,8 @@ XrdMgmOfsFile::open(const char* inpath,
     }
   }
 
-  gOFS->MgmStats.Add("Open", vid.uid, vid.gid, 1);
+  static const int sOpenTag = gOFS->MgmStats.GetTagId("Open");
+  gOFS->MgmStats.Add(sOpenTag, vid.uid, vid.gid, 1);
   eos_debug("authorize start");
 
   if (open_flag & O_CREAT) {
@@ -776,7 +778,8 @@ XrdMgmOfsFile::open(const char* inpath,
           }
         }
 
-        gOFS->MgmStats.Add("OpenWrite", vid.uid, vid.gid, 1);
+        static const int sOpenWriteTag = gOFS->MgmStats.GetTagId("OpenWrite");
+        gOFS->MgmStats.Add(sOpenWriteTag, vid.uid, vid.gid, 1);
       }
     }
 
@@ -891,7 +894,8 @@ XrdMgmOfsFile::open(const char* inpath,
     if (isSharedFile) {
       gOFS->MgmStats.Add("OpenShared", vid.uid, vid.gid, 1);
     } else {
-      gOFS->MgmStats.Add("OpenRead", vid.uid, vid.gid, 1);
+      static const int sOpenReadTag = gOFS->MgmStats.GetTagId("OpenRead");
+      gOFS->MgmStats.Add(sOpenReadTag, vid.uid, vid.gid, 1);
     }
   }
 
@@ -1151,6 +1155,8 @@ XrdMgmOfsFile::open(const char* inpath,
     // if any of the two fails, the scheduling operation fails
     Scheduler::PlacementArguments plctargs;
     plctargs.alreadyused_filesystems = &selectedfs;
+    // new files (including the conversion targets) can share placement batches
+    plctargs.batch = true;
     plctargs.bookingsize = bookingsize;
     plctargs.dataproxys = &proxys;
     plctargs.firewallentpts = &firewalleps;
@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+// @file SchedulingEpoch.hh
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#ifndef __EOSMGM_SCHEDULINGEPOCH__H__
+#define __EOSMGM_SCHEDULINGEPOCH__H__
+
+#include "mgm/Namespace.hh"
+#include <atomic>
+#include <mutex>
+#include <sched.h>
+
+EOSMGMNAMESPACE_BEGIN
+
+/*----------------------------------------------------------------------------*/
+/**
+ * @brief Epoch based publication of a pointer (RCU style).
+ *
+ * Readers bracket their use of the published object with ReadLock/ReadUnlock.
+ * This costs an atomic increment and decrement of a counter and never waits,
+ * whatever the updater is doing.
+ *
+ * The updater publishes a new object with Publish and then calls Synchronize
+ * which returns once every reader which could still see the previous object
+ * has left. The previous object can then be modified or reused.
+ *
+ * Readers count themselves in one of two sets of counters chosen by the parity
+ * of the epoch they entered in. Synchronize moves the epoch forward twice and
+ * waits after each move for the set which is not used by new readers anymore
+ * to drain. A reader that loaded the previous object has incremented its
+ * counter before the publication, so it is waited for by one of the two steps,
+ * while a stream of new readers can not delay the updater indefinitely.
+ * The counters are striped across cache lines by thread to keep the readers
+ * of a same object from contending with each other.
+ */
+/*----------------------------------------------------------------------------*/
+class SchedulingEpoch
+{
+public:
+  //! Token identifying the counter incremented by a reader
+  typedef unsigned tToken;
+  //! Number of counter stripes per epoch parity
+  static const unsigned sStripes = 16;
+
+  SchedulingEpoch() : pEpoch(0)
+  {
+    for (unsigned i = 0; i < 2 * sStripes; i++) {
+      pCounters[i].count = 0;
+    }
+  }
+
+  /**
+   * Enter a read-side section
+   *
+   * @return token to give to ReadUnlock
+   */
+  inline tToken ReadLock()
+  {
+    tToken token = (pEpoch.load() & 1) * sStripes + getStripe();
+    pCounters[token].count.fetch_add(1);
+    return token;
+  }
+
+  /**
+   * Leave a read-side section
+   *
+   * @param token token returned by the matching ReadLock
+   */
+  inline void ReadUnlock(const tToken& token)
+  {
+    pCounters[token].count.fetch_sub(1);
+  }
+
+  /**
+   * Wait until every read-side section which could have seen a pointer
+   * replaced before the call is over
+   */
+  void Synchronize()
+  {
+    std::lock_guard<std::mutex> lock(pSyncMutex);
+
+    for (int step = 0; step < 2; step++) {
+      unsigned parity = pEpoch.fetch_add(1) & 1;
+
+      for (unsigned i = parity * sStripes; i < (parity + 1) * sStripes; i++) {
+        for (size_t spin = 0; pCounters[i].count.load(); spin++) {
+          if (spin > 64) {
+            sched_yield();
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Load a pointer published with Publish, to be called in a read-side section
+   */
+  template<typename T> static inline T* Dereference(T* const& ptr)
+  {
+    return __atomic_load_n(&ptr, __ATOMIC_SEQ_CST);
+  }
+
+  /**
+   * Publish a new value of a pointer read with Dereference
+   */
+  template<typename T> static inline void Publish(T*& ptr, T* value)
+  {
+    __atomic_store_n(&ptr, value, __ATOMIC_SEQ_CST);
+  }
+
+private:
+  struct Counter {
+    std::atomic<size_t> count;
+    char padding[64 - sizeof(std::atomic<size_t>)];
+  };
+
+  static inline unsigned getStripe()
+  {
+    static std::atomic<unsigned> nextStripe(0);
+    static __thread unsigned stripe = 0;
+    static __thread bool assigned = false;
+
+    if (!assigned) {
+      stripe = nextStripe.fetch_add(1) % sStripes;
+      assigned = true;
+    }
+
+    return stripe;
+  }
+
+  std::atomic<unsigned> pEpoch;
+  Counter pCounters[2 * sStripes];
+  //! serializes the updaters
+  std::mutex pSyncMutex;
+};
+
+EOSMGMNAMESPACE_END
+
+#endif /* __EOSMGM_SCHEDULINGEPOCH__H__ */
@@ -1569,6 +1569,38 @@ public:
     updateBranch(pNodes[node].treeData.fatherIdx);
   }
 
+  inline void
+  applyScorePenalty(const tFastTreeIdx &node, const char &dlPenalty, const char &ulPenalty)
+  {
+    // lower the scores of a leaf (not below zero) and update its ancestors
+    // the way updateTree does so that the next placements on this tree see the penalty
+    char &dlScore = pNodes[node].fsData.dlScore;
+    char &ulScore = pNodes[node].fsData.ulScore;
+    dlScore = (dlScore > dlPenalty) ? dlScore - dlPenalty : 0;
+    ulScore = (ulScore > ulPenalty) ? ulScore - ulPenalty : 0;
+
+    for(tFastTreeIdx n = node; ; n = pNodes[n].treeData.fatherIdx)
+    {
+      if(pNodes[n].treeData.childrenCount)
+      {
+        sortBranchesAtNode(n,false);
+        aggregateFsData(n);
+        aggregateFileData(n);
+      }
+
+      pNodes[n].fileData.maxUlScore = pNodes[n].fsData.ulScore;
+      pNodes[n].fileData.maxDlScore = pNodes[n].fsData.dlScore;
+      pNodes[n].fileData.avgUlScore = pNodes[n].fsData.ulScore;
+      pNodes[n].fileData.avgDlScore = pNodes[n].fsData.dlScore;
+
+      if(pNodes[n].treeData.fatherIdx == n)
+      break;
+    }
+
+    __EOSMGM_TREECOMMON_CHK3__
+    checkConsistency(0, true);
+  }
+
   inline void
   updateTree(const tFastTreeIdx &node=0)
   {
@@ -2311,6 +2343,20 @@ public:
     // need to call update after calling this function
     pNodes[node].fsData.mStatus &= ~Disabled;
   }
+  inline void bookSpace(const unsigned long long &size)
+  {
+    // need to call update after calling this function
+    // prebook the space on all the fs, the ones without enough space become unavailable
+    for(auto it = pFs2Idx->begin(); it != pFs2Idx->end(); it++ )
+    {
+      const tFastTreeIdx &idx = (*it).second;
+      float &freeSpace = pNodes[idx].fsData.totalSpace;
+      if(freeSpace>size)
+      freeSpace -= size;
+      else
+      pNodes[idx].fsData.mStatus = pNodes[idx].fsData.mStatus & ~Available;
+    }
+  }
 };
 
 template<typename T1,typename T2,typename T3, typename T4,typename T5, typename T6> inline size_t
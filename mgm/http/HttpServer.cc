@@ -34,6 +34,7 @@
 #include "XrdSys/XrdSysDNS.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
 /*----------------------------------------------------------------------------*/
+#include <cstring>
 #include <sstream>
 
 /*----------------------------------------------------------------------------*/
@@ -55,29 +56,13 @@ HttpServer::Handler(void* cls,
                     size_t* uploadDataSize,
                     void** ptr)
 {
-  std::map<std::string, std::string> headers;
-  bool go = false;
-
-  do {
-    // --------------------------------------------------------
-    // wait that the namespace is booted
-    // --------------------------------------------------------
-    {
-      {
-        XrdSysMutexHelper(gOFS->InitializationMutex);
-
-        if ((gOFS->Initialized == gOFS->kBooted) ||
-            (gOFS->Initialized == gOFS->kCompacting)) {
-          go = true;
-        }
-      }
+  if (IsDispatching()) {
+    return DispatchHandler(connection, url, method, uploadData, uploadDataSize,
+                           ptr);
+  }
 
-      if (!go) {
-        XrdSysTimer sleeper;
-        sleeper.Wait(100);
-      }
-    }
-  } while (!go);
+  std::map<std::string, std::string> headers;
+  WaitBooted();
 
   // If this is the first call, create an appropriate protocol handler based
   // on the headers and store it in *ptr. We should only return MHD_YES here
@@ -86,41 +71,11 @@ HttpServer::Handler(void* cls,
     // Get the headers
     MHD_get_connection_values(connection, MHD_HEADER_KIND,
                               &HttpServer::BuildHeaderMap, (void*) &headers);
-    char buf[INET6_ADDRSTRLEN];
-    // Retrieve Client IP
-    const MHD_ConnectionInfo* info = MHD_get_connection_info(connection,
-                                     MHD_CONNECTION_INFO_CLIENT_ADDRESS);
-
-    if (info && info->client_addr) {
-      headers["client-real-ip"] = inet_ntop(info->client_addr->sa_family,
-                                            info->client_addr->sa_data + 2, buf, INET6_ADDRSTRLEN);
-      char* haddr[1];
-      char* hname[1];
-
-      if ((XrdSysDNS::getAddrName(const_cast<char*>
-                                  (headers["client-real-ip"].c_str()),
-                                  1,
-                                  haddr,
-                                  hname)) > 0) {
-        headers["client-real-host"] = const_cast<char*>(hname[0]);
-        free(hname[0]);
-        free(haddr[0]);
-      }
-    }
-
-    // Authenticate the client
-    eos::common::Mapping::VirtualIdentity* vid = Authenticate(headers);
-    eos_static_info("request=%s client-real-ip=%s client-real-host=%s vid.uid=%s vid.gid=%s vid.host=%s vid.tident=%s\n",
-                    method, headers["client-real-ip"].c_str(), headers["client-real-host"].c_str(),
-                    vid->uid_string.c_str(), vid->gid_string.c_str(), vid->host.c_str(),
-                    vid->tident.c_str());
-    eos::common::ProtocolHandler* handler;
-    ProtocolHandlerFactory factory = ProtocolHandlerFactory();
-    handler = factory.CreateProtocolHandler(method, headers, vid);
+    GetClientAddress(connection, headers);
+    eos::common::ProtocolHandler* handler = CreateProtocolHandler(method,
+                                            headers);
 
     if (!handler) {
-      eos_static_err("msg=\"no matching protocol for request method %s\"",
-                     method);
       return MHD_NO;
     }
 
@@ -175,12 +130,370 @@ HttpServer::Handler(void* cls,
     return MHD_YES;
   }
 
-  eos::common::HttpResponse* response = protocolHandler->GetResponse();
+  *ptr = 0;
+  return QueueHandlerResponse(connection, protocolHandler);
+}
+
+/*----------------------------------------------------------------------------*/
+int
+HttpServer::DispatchHandler(struct MHD_Connection* connection,
+                            const char* url,
+                            const char* method,
+                            const char* uploadData,
+                            size_t* uploadDataSize,
+                            void** ptr)
+{
+  // Nothing in here may block: the event loop serves all the connections.
+  // The request is collected (headers, body) like in the threaded modes,
+  // then the connection is suspended while a worker authenticates the client
+  // and executes the request. Once resumed, we are called again and queue
+  // the response.
+  DispatchedRequest* request = static_cast<DispatchedRequest*>(*ptr);
+
+  if (!request) {
+    request = new DispatchedRequest(method, url);
+    MHD_get_connection_values(connection, MHD_HEADER_KIND,
+                              &HttpServer::BuildHeaderMap,
+                              (void*) &request->mHeaders);
+    GetClientAddress(connection, request->mHeaders);
+    *ptr = request;
+
+    // PUT has to run through to avoid the generation of 100-CONTINUE before a redirect
+    if (strcmp(method, "PUT")) {
+      return MHD_YES;
+    }
+  }
+
+  if (*uploadDataSize != 0) {
+    if (!request->mDone) {
+      request->mBody.append(uploadData, *uploadDataSize);
+    }
+
+    *uploadDataSize = 0;
+    return MHD_YES;
+  }
+
+  if (!request->mDone) {
+    MHD_get_connection_values(connection, MHD_GET_ARGUMENT_KIND,
+                              &HttpServer::BuildQueryString,
+                              (void*) &request->mQuery);
+    MHD_get_connection_values(connection, MHD_COOKIE_KIND,
+                              &HttpServer::BuildHeaderMap,
+                              (void*) &request->mCookies);
+
+    auto job = [this, request]() {
+      ExecuteRequest(request);
+    };
+
+    if (!Dispatch(connection, method, job)) {
+      // the connection was suspended and resumed, we are called again
+      eos_static_warning("msg=\"http request queue full\" method=%s class=%s",
+                         method, eos::common::HttpWorkerPool::ClassName(
+                           eos::common::HttpWorkerPool::Classify(method)));
+      request->mError = HttpError("too many requests, try again later",
+                                  eos::common::HttpResponse::SERVICE_UNAVAILABLE);
+      request->mDone = true;
+    }
+
+    return MHD_YES;
+  }
+
+  // The request has been executed by a worker or rejected
+  int ret = MHD_NO;
+
+  if (request->mError) {
+    ret = QueueResponse(connection, request->mError);
+  } else if (request->mHandler) {
+    eos::common::HttpResponse* response = request->mHandler->GetResponse();
+
+    if (response && response->mStreamBody) {
+      // The body is produced by the workers as well, piece by piece
+      DispatchedStream* stream = new DispatchedStream(this, connection,
+          request->mMethod, request->mHandler);
+      ret = QueueStream(connection, response,
+                        &HttpServer::DispatchedStreamCallback, (void*) stream,
+                        &HttpServer::DispatchedStreamFree);
+    } else {
+      ret = QueueHandlerResponse(connection, request->mHandler);
+    }
+
+    request->mHandler = 0;
+  }
+
+  delete request;
+  *ptr = 0;
+  return ret;
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpServer::ExecuteRequest(DispatchedRequest* request)
+{
+  WaitBooted();
+  request->mHandler = CreateProtocolHandler(request->mMethod.c_str(),
+                      request->mHeaders);
+
+  if (request->mHandler) {
+    eos::common::ProtocolHandler* protocolHandler = request->mHandler;
+
+    if (request->mBody.length()) {
+      protocolHandler->AddToBody(request->mBody.c_str(), request->mBody.length());
+      request->mBody.clear();
+    }
+
+    size_t bodySize = protocolHandler->GetBody().size();
+    eos::common::HttpRequest httpRequest(request->mHeaders,
+                                         request->mMethod, request->mUrl,
+                                         request->mQuery,
+                                         protocolHandler->GetBody(), &bodySize,
+                                         request->mCookies);
+    eos_static_debug("\n\n%s\n%s\n", httpRequest.ToString().c_str(),
+                     httpRequest.GetBody().c_str());
+    protocolHandler->HandleRequest(&httpRequest);
+  }
+
+  request->mDone = true;
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpServer::WaitBooted()
+{
+  bool go = false;
+
+  do {
+    // --------------------------------------------------------
+    // wait that the namespace is booted
+    // --------------------------------------------------------
+    {
+      {
+        XrdSysMutexHelper(gOFS->InitializationMutex);
+
+        if ((gOFS->Initialized == gOFS->kBooted) ||
+            (gOFS->Initialized == gOFS->kCompacting)) {
+          go = true;
+        }
+      }
+
+      if (!go) {
+        XrdSysTimer sleeper;
+        sleeper.Wait(100);
+      }
+    }
+  } while (!go);
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpServer::GetClientAddress(struct MHD_Connection* connection,
+                             std::map<std::string, std::string>& headers)
+{
+  char buf[INET6_ADDRSTRLEN];
+  // Retrieve Client IP
+  const MHD_ConnectionInfo* info = MHD_get_connection_info(connection,
+                                   MHD_CONNECTION_INFO_CLIENT_ADDRESS);
+
+  if (info && info->client_addr) {
+    headers["client-real-ip"] = inet_ntop(info->client_addr->sa_family,
+                                          info->client_addr->sa_data + 2, buf, INET6_ADDRSTRLEN);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+eos::common::ProtocolHandler*
+HttpServer::CreateProtocolHandler(const char* method,
+                                  std::map<std::string, std::string>& headers)
+{
+  if (headers.count("client-real-ip")) {
+    char* haddr[1];
+    char* hname[1];
+
+    if ((XrdSysDNS::getAddrName(const_cast<char*>
+                                (headers["client-real-ip"].c_str()),
+                                1,
+                                haddr,
+                                hname)) > 0) {
+      headers["client-real-host"] = const_cast<char*>(hname[0]);
+      free(hname[0]);
+      free(haddr[0]);
+    }
+  }
+
+  // Authenticate the client
+  eos::common::Mapping::VirtualIdentity* vid = Authenticate(headers);
+  eos_static_info("request=%s client-real-ip=%s client-real-host=%s vid.uid=%s vid.gid=%s vid.host=%s vid.tident=%s\n",
+                  method, headers["client-real-ip"].c_str(), headers["client-real-host"].c_str(),
+                  vid->uid_string.c_str(), vid->gid_string.c_str(), vid->host.c_str(),
+                  vid->tident.c_str());
+  eos::common::ProtocolHandler* handler;
+  ProtocolHandlerFactory factory = ProtocolHandlerFactory();
+  handler = factory.CreateProtocolHandler(method, headers, vid);
+
+  if (!handler) {
+    eos_static_err("msg=\"no matching protocol for request method %s\"",
+                   method);
+  }
+
+  return handler;
+}
+
+/*----------------------------------------------------------------------------*/
+int
+HttpServer::QueueHandlerResponse(struct MHD_Connection* connection,
+                                 eos::common::ProtocolHandler* handler)
+{
+  eos::common::HttpResponse* response = handler->GetResponse();
+
+  if (!response || !response->mStreamBody) {
+    int ret = QueueResponse(connection, response);
+    delete handler;
+    return ret;
+  }
+
+  // The body is produced while it is sent, libmicrohttpd owns the handler
+  // until the response is destroyed
+  return QueueStream(connection, response, &HttpServer::StreamCallback,
+                     (void*) handler, &HttpServer::StreamFree);
+}
+
+/*----------------------------------------------------------------------------*/
+int
+HttpServer::QueueStream(struct MHD_Connection* connection,
+                        eos::common::HttpResponse* response,
+                        MHD_ContentReaderCallback callback,
+                        void* cls,
+                        MHD_ContentReaderFreeCallback freeCallback)
+{
+  struct MHD_Response* mhdResponse = MHD_create_response_from_callback(
+                                       MHD_SIZE_UNKNOWN, 64 * 1024,
+                                       callback, cls, freeCallback);
+
+  if (!mhdResponse) {
+    eos_static_crit("msg=\"response creation failed\"");
+    freeCallback(cls);
+    return MHD_NO;
+  }
+
+  std::map<std::string, std::string> headers = response->GetHeaders();
+
+  for (auto it = headers.begin(); it != headers.end(); it++) {
+    MHD_add_response_header(mhdResponse, it->first.c_str(), it->second.c_str());
+  }
+
+  int ret = MHD_queue_response(connection, response->GetResponseCode(),
+                               mhdResponse);
+  eos_static_debug("msg=\"MHD_queue_response\" retc=%d streamed", ret);
+  MHD_destroy_response(mhdResponse);
+  return ret;
+}
+
+/*----------------------------------------------------------------------------*/
+ssize_t
+HttpServer::StreamCallback(void* cls, uint64_t pos, char* buf, size_t max)
+{
+  eos::common::ProtocolHandler* handler =
+    static_cast<eos::common::ProtocolHandler*>(cls);
+  ssize_t nread = handler->GetResponse()->ReadBody(pos, buf, max);
 
+  if (nread < 0) {
+    return MHD_CONTENT_READER_END_WITH_ERROR;
+  }
+
+  return nread ? nread : MHD_CONTENT_READER_END_OF_STREAM;
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpServer::StreamFree(void* cls)
+{
+  delete static_cast<eos::common::ProtocolHandler*>(cls);
+}
+
+/*----------------------------------------------------------------------------*/
+ssize_t
+HttpServer::DispatchedStreamCallback(void* cls, uint64_t pos, char* buf,
+                                     size_t max)
+{
+  DispatchedStream* stream = static_cast<DispatchedStream*>(cls);
+
+  if (stream->mChunkOffset >= stream->mChunk.length()) {
+    if (stream->mError) {
+      return MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+
+    if (stream->mEnd) {
+      return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    // Producing the next piece may stat entries under the namespace lock,
+    // a worker does it and we are called again once the connection is resumed
+    auto job = [stream]() {
+      FillStream(stream);
+    };
+
+    if (!stream->mServer->Dispatch(stream->mConnection,
+                                   stream->mMethod.c_str(), job)) {
+      eos_static_warning("msg=\"http request queue full, aborting streamed "
+                         "response\" method=%s", stream->mMethod.c_str());
+      return MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+
+    return 0;
+  }
+
+  size_t length = stream->mChunk.length() - stream->mChunkOffset;
+
+  if (length > max) {
+    length = max;
+  }
+
+  memcpy(buf, stream->mChunk.c_str() + stream->mChunkOffset, length);
+  stream->mChunkOffset += length;
+  return length;
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpServer::FillStream(DispatchedStream* stream)
+{
+  static const size_t sChunkSize = 64 * 1024;
+  eos::common::HttpResponse* response = stream->mHandler->GetResponse();
+  char buf[4096];
+  stream->mChunk.clear();
+  stream->mChunkOffset = 0;
+
+  while (stream->mChunk.length() < sChunkSize) {
+    ssize_t nread = response->ReadBody(stream->mPos, buf, sizeof(buf));
+
+    if (nread < 0) {
+      stream->mError = true;
+      break;
+    }
+
+    if (!nread) {
+      stream->mEnd = true;
+      break;
+    }
+
+    stream->mChunk.append(buf, nread);
+    stream->mPos += nread;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+void
+HttpServer::DispatchedStreamFree(void* cls)
+{
+  delete static_cast<DispatchedStream*>(cls);
+}
+
+/*----------------------------------------------------------------------------*/
+int
+HttpServer::QueueResponse(struct MHD_Connection* connection,
+                          eos::common::HttpResponse* response)
+{
   if (!response) {
     eos_static_crit("msg=\"response creation failed\"");
-    delete protocolHandler;
-    *ptr = 0;
     return MHD_NO;
   }
 
@@ -193,7 +506,7 @@ HttpServer::Handler(void* cls,
 
   if (mhdResponse) {
     // Add all the response header tags
-    headers = response->GetHeaders();
+    std::map<std::string, std::string> headers = response->GetHeaders();
 
     for (auto it = headers.begin(); it != headers.end(); it++) {
       MHD_add_response_header(mhdResponse, it->first.c_str(), it->second.c_str());
@@ -204,13 +517,9 @@ HttpServer::Handler(void* cls,
                                  mhdResponse);
     eos_static_debug("msg=\"MHD_queue_response\" retc=%d", ret);
     MHD_destroy_response(mhdResponse);
-    delete protocolHandler;
-    *ptr = 0;
     return ret;
   } else {
     eos_static_crit("msg=\"response creation failed\"");
-    delete protocolHandler;
-    *ptr = 0;
     return MHD_NO;
   }
 }
@@ -248,6 +557,15 @@ HttpServer::CompleteHandler(void*                              cls,
 
   eos_static_info("msg=\"http connection disconnect\" reason=\"Request %s\" ",
                   scode.c_str());
+#ifdef EOS_MICRO_HTTPD
+
+  // a dispatched request which did not get to queue its response
+  if (IsDispatching() && *con_cls) {
+    delete static_cast<DispatchedRequest*>(*con_cls);
+    *con_cls = 0;
+  }
+
+#endif
 }
 
 /*----------------------------------------------------------------------------*/
@@ -34,6 +34,7 @@
 #include "mgm/Namespace.hh"
 #include "common/http/HttpServer.hh"
 #include "common/Mapping.hh"
+#include "common/http/ProtocolHandler.hh"
 /*----------------------------------------------------------------------------*/
 #include "XrdSys/XrdSysPthread.hh"
 /*----------------------------------------------------------------------------*/
@@ -51,12 +52,69 @@ private:
   struct timespec mGridMapFileLastModTime; //!< last modification time of the
                                            //!< gridmap file
 
+  /**
+   * State of a request executed by the worker pool, stored in the connection
+   * pointer of libmicrohttpd instead of the protocol handler
+   */
+  struct DispatchedRequest {
+    std::string mMethod;                           //!< request verb
+    std::string mUrl;                              //!< request url
+    std::string mQuery;                            //!< query string
+    std::string mBody;                             //!< request body
+    std::map<std::string, std::string> mHeaders;   //!< request headers
+    std::map<std::string, std::string> mCookies;   //!< request cookies
+    eos::common::ProtocolHandler*      mHandler;   //!< handler built by a worker
+    eos::common::HttpResponse*         mError;     //!< response if not executed
+    bool                               mDone;      //!< request was executed
+
+    DispatchedRequest (const char* method, const char* url) :
+      mMethod(method), mUrl(url), mHandler(0), mError(0), mDone(false) {}
+
+    ~DispatchedRequest ()
+    {
+      delete mHandler;
+      delete mError;
+    }
+  };
+
+  /**
+   * State of a streamed response in 'dispatch' mode. The pieces of the body
+   * are produced by the worker pool while the connection is suspended, the
+   * event loop only copies them out. The worker and the event loop never
+   * access it at the same time.
+   */
+  struct DispatchedStream {
+    HttpServer*                   mServer;      //!< server owning the pool
+    struct MHD_Connection*        mConnection;  //!< connection of the request
+    std::string                   mMethod;      //!< request verb
+    eos::common::ProtocolHandler* mHandler;     //!< handler owning the response
+    std::string                   mChunk;       //!< piece produced by a worker
+    size_t                        mChunkOffset; //!< bytes of mChunk sent
+    uint64_t                      mPos;         //!< bytes of the body produced
+    bool                          mEnd;         //!< body is complete
+    bool                          mError;       //!< body failed
+
+    DispatchedStream (HttpServer* server, struct MHD_Connection* connection,
+                      const std::string& method,
+                      eos::common::ProtocolHandler* handler) :
+      mServer(server), mConnection(connection), mMethod(method),
+      mHandler(handler), mChunkOffset(0), mPos(0), mEnd(false), mError(false) {}
+
+    ~DispatchedStream ()
+    {
+      delete mHandler;
+    }
+  };
+
 public:
   /**
    * Constructor
    */
   HttpServer (int port = 8000) :
-    eos::common::HttpServer(port), mGridMapFileLastModTime{0} {}
+    eos::common::HttpServer(port), mGridMapFileLastModTime{0}
+  {
+    mDispatchSupported = true;
+  }
 
   /**
    * Destructor
@@ -91,7 +149,123 @@ public:
 		   void                             **con_cls,
 		   enum MHD_RequestTerminationCode    toe);
 
-  
+private:
+  /**
+   * HTTP object handler function in 'dispatch' mode. The event loop only
+   * collects the request, the namespace work is done by the worker pool.
+   *
+   * @return see implementation
+   */
+  int
+  DispatchHandler (struct MHD_Connection *connection,
+                   const char            *url,
+                   const char            *method,
+                   const char            *upload_data,
+                   size_t                *upload_data_size,
+                   void                 **ptr);
+
+  /**
+   * Execute a dispatched request, called by a thread of the worker pool
+   */
+  void
+  ExecuteRequest (DispatchedRequest *request);
+
+  /**
+   * Add the client address of a connection to the request headers
+   */
+  static void
+  GetClientAddress (struct MHD_Connection              *connection,
+                    std::map<std::string, std::string> &headers);
+
+  /**
+   * Authenticate the client and create the matching protocol handler
+   *
+   * @return the protocol handler or 0 if no protocol matches
+   */
+  eos::common::ProtocolHandler*
+  CreateProtocolHandler (const char                         *method,
+                         std::map<std::string, std::string> &headers);
+
+  /**
+   * Queue a response on a connection
+   *
+   * @return see MHD_queue_response
+   */
+  static int
+  QueueResponse (struct MHD_Connection     *connection,
+                 eos::common::HttpResponse *response);
+
+  /**
+   * Queue the response of a protocol handler on a connection, the handler is
+   * deleted here or, for streamed responses, when the response is destroyed
+   *
+   * @return see MHD_queue_response
+   */
+  static int
+  QueueHandlerResponse (struct MHD_Connection        *connection,
+                        eos::common::ProtocolHandler *handler);
+
+  /**
+   * Content reader of streamed responses
+   *
+   * @param cls  the protocol handler owning the response
+   *
+   * @return see MHD_ContentReaderCallback
+   */
+  static ssize_t
+  StreamCallback (void *cls, uint64_t pos, char *buf, size_t max);
+
+  /**
+   * Delete the protocol handler of a streamed response
+   */
+  static void
+  StreamFree (void *cls);
+
+  /**
+   * Queue a streamed response on a connection, the free callback is called
+   * with cls if the response can't be created
+   *
+   * @return see MHD_queue_response
+   */
+  static int
+  QueueStream (struct MHD_Connection            *connection,
+               eos::common::HttpResponse        *response,
+               MHD_ContentReaderCallback         callback,
+               void                             *cls,
+               MHD_ContentReaderFreeCallback     freeCallback);
+
+  /**
+   * Content reader of streamed responses in 'dispatch' mode. When the last
+   * piece has been sent, the next one is requested from the worker pool and
+   * the connection is suspended until it is ready.
+   *
+   * @param cls  the DispatchedStream of the response
+   *
+   * @return see MHD_ContentReaderCallback
+   */
+  static ssize_t
+  DispatchedStreamCallback (void *cls, uint64_t pos, char *buf, size_t max);
+
+  /**
+   * Produce the next piece of a streamed body, called by a thread of the
+   * worker pool
+   */
+  static void
+  FillStream (DispatchedStream *stream);
+
+  /**
+   * Delete the state of a streamed response in 'dispatch' mode
+   */
+  static void
+  DispatchedStreamFree (void *cls);
+
+  /**
+   * Wait until the namespace is booted
+   */
+  static void
+  WaitBooted ();
+
+public:
 
 #endif
 
@@ -399,10 +399,11 @@ S3Store::ListBucket (const std::string &bucket, const std::string &query)
         result += Timing::UnixTimstamp_to_ISO8601(mtime.tv_sec);
         result += "</LastModified>";
         result += "<ETag>";
+        eos::Buffer fmdchecksum = fmd->getChecksum();
         for (unsigned int i = 0; i < LayoutId::GetChecksumLen(fmd->getLayoutId()); i++)
         {
           char hb[3];
-          sprintf(hb, "%02x", (unsigned char) (fmd->getChecksum().getDataPtr()[i]));
+          sprintf(hb, "%02x", (unsigned char) (fmdchecksum.getDataPtr()[i]));
           result += hb;
         }
         result += "</ETag>";
@@ -34,6 +34,8 @@
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucErrInfo.hh"
 /*----------------------------------------------------------------------------*/
+#include <cstring>
+#include <iterator>
 /*----------------------------------------------------------------------------*/
 
 EOSMGMNAMESPACE_BEGIN
@@ -181,6 +183,7 @@ PropFindResponse::BuildResponse(eos::common::HttpRequest* request)
     if (!listrc) {
       const char* val;
 
+      // only the names are kept, they are stat'ed when serialized
       while ((val = directory.nextEntry())) {
         XrdOucString entryname = val;
 
@@ -194,12 +197,37 @@ PropFindResponse::BuildResponse(eos::common::HttpRequest* request)
           continue;
         }
 
+        mEntries.push_back(val);
+      }
+
+      mUrl = request->GetUrl();
+      mHrefUrl = request->GetUrl(true);
+
+      if (mEntries.size() > sStreamBatch) {
+        // Send the document head with the directory itself right away, the
+        // entries follow batch by batch from ReadBody
+        mChunk = "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+                 "<d:multistatus xmlns:d=\"DAV:\" ";
+        mChunk += eos::common::OwnCloud::OwnCloudNs();
+        mChunk += "=\"";
+        mChunk += eos::common::OwnCloud::OwnCloudNsUrl();
+        mChunk += "\">";
+
+        if (responseNode) {
+          rapidxml::print(std::back_inserter(mChunk), *responseNode,
+                          rapidxml::print_no_indenting);
+        }
+
+        mXMLResponseDocument.clear();
+        mStreamBody = true;
+        SetResponseCode(HttpResponse::MULTI_STATUS);
+        AddHeader("Content-Type", "application/xml; charset=utf-8");
+        return this;
+      }
+
+      for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
         // one response node for each file...
-        eos::common::Path path((request->GetUrl() + std::string("/") + std::string(
-                                  val)).c_str());
-        eos::common::Path refpath((request->GetUrl(true) + std::string("/") +
-                                   std::string(val)).c_str());
-        responseNode = BuildResponseNode(path.GetPath(), refpath.GetPath());
+        responseNode = BuildEntryNode(*it);
 
         if (responseNode) {
           multistatusNode->append_node(responseNode);
@@ -209,6 +237,8 @@ PropFindResponse::BuildResponse(eos::common::HttpRequest* request)
           SetResponseCode(HttpResponse::OK);
         }
       }
+
+      mEntries.clear();
     } else {
       eos_static_warning("msg=\"error opening directory\"");
       SetResponseCode(HttpResponse::BAD_REQUEST);
@@ -235,6 +265,77 @@ PropFindResponse::BuildResponse(eos::common::HttpRequest* request)
   return this;
 }
 
+/*----------------------------------------------------------------------------*/
+ssize_t
+PropFindResponse::ReadBody(uint64_t pos, char* buf, size_t max)
+{
+  while (mChunkOffset >= mChunk.length()) {
+    if (!NextChunk()) {
+      return 0;
+    }
+  }
+
+  size_t length = mChunk.length() - mChunkOffset;
+
+  if (length > max) {
+    length = max;
+  }
+
+  memcpy(buf, mChunk.c_str() + mChunkOffset, length);
+  mChunkOffset += length;
+  return length;
+}
+
+/*----------------------------------------------------------------------------*/
+bool
+PropFindResponse::NextChunk()
+{
+  mChunk.clear();
+  mChunkOffset = 0;
+
+  if (mNextEntry >= mEntries.size()) {
+    if (mStreamDone) {
+      return false;
+    }
+
+    mChunk = "</d:multistatus>";
+    mStreamDone = true;
+    std::vector<std::string>().swap(mEntries);
+    return true;
+  }
+
+  size_t last = mNextEntry + sStreamBatch;
+
+  if (last > mEntries.size()) {
+    last = mEntries.size();
+  }
+
+  for (; mNextEntry < last; mNextEntry++) {
+    // entries removed since the listing fail to stat and are left out
+    rapidxml::xml_node<>* responseNode = BuildEntryNode(mEntries[mNextEntry]);
+
+    if (responseNode) {
+      rapidxml::print(std::back_inserter(mChunk), *responseNode,
+                      rapidxml::print_no_indenting);
+    }
+
+    std::string().swap(mEntries[mNextEntry]);
+  }
+
+  // the nodes of the batch are not needed anymore
+  mXMLResponseDocument.clear();
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+rapidxml::xml_node<>*
+PropFindResponse::BuildEntryNode(const std::string& name)
+{
+  eos::common::Path path((mUrl + std::string("/") + name).c_str());
+  eos::common::Path refpath((mHrefUrl + std::string("/") + name).c_str());
+  return BuildResponseNode(path.GetPath(), refpath.GetPath());
+}
+
 /*----------------------------------------------------------------------------*/
 void
 PropFindResponse::ParseRequestPropertyTypes(rapidxml::xml_node<>* node)
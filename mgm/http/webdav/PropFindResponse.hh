@@ -40,6 +40,9 @@
 #include "mgm/http/rapidxml/rapidxml.hpp"
 #include "mgm/http/rapidxml/rapidxml_print.hpp"
 /*----------------------------------------------------------------------------*/
+#include <string>
+#include <vector>
+/*----------------------------------------------------------------------------*/
 
 EOSMGMNAMESPACE_BEGIN;
 
@@ -78,9 +81,20 @@ public:
     ALLPROP_MARKER = 0xf000
   };
 
+  //! Directory entries serialized per batch of a streamed response, smaller
+  //! directories are answered in one piece with a Content-Length
+  static const size_t sStreamBatch = 128;
+
 protected:
   int mRequestPropertyTypes; //!< properties that were requested
   eos::common::Mapping::VirtualIdentity *mVirtualIdentity; //!< virtual identity for this client
+  std::string mUrl;                  //!< path of the requested directory
+  std::string mHrefUrl;              //!< url of the requested directory
+  std::vector<std::string> mEntries; //!< names of the directory entries
+  size_t mNextEntry;                 //!< next entry to serialize
+  std::string mChunk;                //!< serialized batch being sent
+  size_t mChunkOffset;               //!< bytes of mChunk already sent
+  bool mStreamDone;                  //!< closing tag is in mChunk
 
 public:
 
@@ -92,7 +106,7 @@ public:
   PropFindResponse (eos::common::HttpRequest *request,
                     eos::common::Mapping::VirtualIdentity *vid) :
   WebDAVResponse (request), mRequestPropertyTypes (NONE),
-  mVirtualIdentity (vid)
+  mVirtualIdentity (vid), mNextEntry (0), mChunkOffset (0), mStreamDone (false)
   {
     static bool initialized = false;
     if (!initialized)
@@ -127,6 +141,35 @@ public:
   HttpResponse*
   BuildResponse (eos::common::HttpRequest *request);
 
+  /**
+   * Produce the next piece of a streamed Depth:1 response. The directory
+   * entries are stat'ed and serialized in batches of sStreamBatch when the
+   * previous batch has been sent, so neither the namespace lock nor the
+   * memory of the whole document are held while the client reads.
+   *
+   * @return number of bytes filled, 0 at the end of the document
+   */
+  virtual ssize_t
+  ReadBody (uint64_t pos, char *buf, size_t max);
+
+  /**
+   * Serialize the next batch of directory entries into mChunk
+   *
+   * @return false if the document is complete
+   */
+  bool
+  NextChunk ();
+
+  /**
+   * Build the <response/> node of an entry of the requested directory
+   *
+   * @param name  the name of the entry
+   *
+   * @return the node or 0 if the entry can't be stat'ed
+   */
+  rapidxml::xml_node<>*
+  BuildEntryNode (const std::string &name);
+
   /**
    * Check the request XML to find out which properties were requested and
    * will therefore need to be returned.
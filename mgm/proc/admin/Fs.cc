@@ -118,8 +118,18 @@ ProcCommand::Fs ()
        XrdOucString df = pOpaque->Get("mgm.dumpmd.fid");
        XrdOucString ds = pOpaque->Get("mgm.dumpmd.size");
        XrdOucString dt = pOpaque->Get("mgm.dumpmd.storetime");
+       XrdOucString format = pOpaque->Get("mgm.dumpmd.format");
        size_t entries = 0;
-       retc = proc_fs_dumpmd(fsidst, option, dp, df, ds, stdOut, stdErr, tident, *pVid, entries);
+
+       if (format == "proto")
+       {
+         // binary dump read by the FST resync, served from mBinaryStream
+         retc = proc_fs_dumpmd_proto(fsidst, mBinaryStream, entries);
+       }
+       else
+       {
+         retc = proc_fs_dumpmd(fsidst, option, dp, df, ds, stdOut, stdErr, tident, *pVid, entries);
+       }
 
        if (!retc)
        {
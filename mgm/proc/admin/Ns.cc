@@ -26,6 +26,7 @@
 #include "mgm/XrdMgmOfs.hh"
 #include "mgm/Quota.hh"
 #include "common/LinuxMemConsumption.hh"
+#include "namespace/interface/IChLogFileMDSvc.hh"
 
 /*----------------------------------------------------------------------------*/
 
@@ -159,7 +160,8 @@ ProcCommand::Ns()
 
 #endif
 
-  if ((mSubCmd != "mutex") && (mSubCmd != "compact")) {
+  if ((mSubCmd != "mutex") && (mSubCmd != "compact") &&
+      (mSubCmd != "memory")) {
     XrdOucString option = pOpaque->Get("mgm.option");
     bool details = false;
     bool monitoring = false;
@@ -182,6 +184,27 @@ ProcCommand::Ns()
     unsigned long long d = (unsigned long long)
                            gOFS->eosDirectoryService->getNumContainers();
     eos::common::FileId::fileid_t fid_now = gOFS->eosFileService->getFirstFreeId();
+    // statistic for the metadata caches, empty if the namespace has none
+    std::map<std::string, uint64_t> fcache;
+    std::map<std::string, uint64_t> dcache;
+    gOFS->eosFileService->getCacheStats(fcache);
+    gOFS->eosDirectoryService->getCacheStats(dcache);
+    // statistic of the write-behind flushers, empty if writing through
+    std::map<std::string, uint64_t> fflush;
+    std::map<std::string, uint64_t> dflush;
+    gOFS->eosFileService->getFlusherStats(fflush);
+    gOFS->eosDirectoryService->getFlusherStats(dflush);
+    // statistic of the subtree accounting, empty if it is synchronous
+    std::map<std::string, uint64_t> acc;
+
+    if (gOFS->eosContainerAccounting) {
+      gOFS->eosContainerAccounting->getStats(acc);
+    }
+
+    if (acc.count("interval") && !acc["interval"]) {
+      acc.clear();
+    }
+
     eos::common::FileId::fileid_t cid_now =
       gOFS->eosDirectoryService->getFirstFreeId();
     char files[1024];
@@ -308,6 +331,62 @@ ProcCommand::Ns()
       stdOut += "ALL      current container id             ";
       stdOut += currentcidstring;
       stdOut += "\n";
+
+      if (!fcache.empty() || !dcache.empty()) {
+        char sline[1024];
+        stdOut += "# ------------------------------------------------------------------------------------\n";
+        snprintf(sline, sizeof(sline) - 1, "ALL      File cache                       "
+                 "size=%llu hits=%llu misses=%llu evictions=%llu\n",
+                 (unsigned long long) fcache["size"],
+                 (unsigned long long) fcache["hits"],
+                 (unsigned long long) fcache["misses"],
+                 (unsigned long long) fcache["evictions"]);
+        stdOut += sline;
+        snprintf(sline, sizeof(sline) - 1, "ALL      Container cache                  "
+                 "size=%llu hits=%llu misses=%llu evictions=%llu\n",
+                 (unsigned long long) dcache["size"],
+                 (unsigned long long) dcache["hits"],
+                 (unsigned long long) dcache["misses"],
+                 (unsigned long long) dcache["evictions"]);
+        stdOut += sline;
+      }
+
+      if (!fflush.empty() || !dflush.empty()) {
+        char sline[1024];
+        stdOut += "# ------------------------------------------------------------------------------------\n";
+        snprintf(sline, sizeof(sline) - 1, "ALL      File flusher                     "
+                 "queued=%llu sent=%llu batches=%llu errors=%llu pending=%llu\n",
+                 (unsigned long long) fflush["queued"],
+                 (unsigned long long) fflush["sent"],
+                 (unsigned long long) fflush["batches"],
+                 (unsigned long long) fflush["errors"],
+                 (unsigned long long) fflush["pending"]);
+        stdOut += sline;
+        snprintf(sline, sizeof(sline) - 1, "ALL      Container flusher                "
+                 "queued=%llu sent=%llu batches=%llu errors=%llu pending=%llu\n",
+                 (unsigned long long) dflush["queued"],
+                 (unsigned long long) dflush["sent"],
+                 (unsigned long long) dflush["batches"],
+                 (unsigned long long) dflush["errors"],
+                 (unsigned long long) dflush["pending"]);
+        stdOut += sline;
+      }
+
+      if (!acc.empty()) {
+        char sline[1024];
+        stdOut += "# ------------------------------------------------------------------------------------\n";
+        snprintf(sline, sizeof(sline) - 1, "ALL      Tree size accounting             "
+                 "interval=%llums cycles=%llu queued=%llu applied=%llu "
+                 "coalesced=%llu last-coalesced=%llu\n",
+                 (unsigned long long) acc["interval"],
+                 (unsigned long long) acc["cycles"],
+                 (unsigned long long) acc["queued"],
+                 (unsigned long long) acc["applied"],
+                 (unsigned long long) acc["coalesced"],
+                 (unsigned long long) acc["last_coalesced"]);
+        stdOut += sline;
+      }
+
       stdOut += "# ------------------------------------------------------------------------------------\n";
       stdOut += "ALL      memory virtual                   ";
       stdOut += eos::common::StringConversion::GetReadableSizeString(sizestring,
@@ -358,6 +437,70 @@ ProcCommand::Ns()
       stdOut += " ns.generated.cid=";
       stdOut += (int)(cid_now - gOFS->BootContainerId);
       stdOut += "\n";
+
+      if (!fcache.empty() || !dcache.empty()) {
+        char sline[1024];
+        snprintf(sline, sizeof(sline) - 1, "uid=all gid=all "
+                 "ns.cache.files.size=%llu ns.cache.files.hits=%llu "
+                 "ns.cache.files.misses=%llu ns.cache.files.evictions=%llu\n",
+                 (unsigned long long) fcache["size"],
+                 (unsigned long long) fcache["hits"],
+                 (unsigned long long) fcache["misses"],
+                 (unsigned long long) fcache["evictions"]);
+        stdOut += sline;
+        snprintf(sline, sizeof(sline) - 1, "uid=all gid=all "
+                 "ns.cache.containers.size=%llu ns.cache.containers.hits=%llu "
+                 "ns.cache.containers.misses=%llu "
+                 "ns.cache.containers.evictions=%llu\n",
+                 (unsigned long long) dcache["size"],
+                 (unsigned long long) dcache["hits"],
+                 (unsigned long long) dcache["misses"],
+                 (unsigned long long) dcache["evictions"]);
+        stdOut += sline;
+      }
+
+      if (!fflush.empty() || !dflush.empty()) {
+        char sline[1024];
+        snprintf(sline, sizeof(sline) - 1, "uid=all gid=all "
+                 "ns.flusher.files.queued=%llu ns.flusher.files.sent=%llu "
+                 "ns.flusher.files.batches=%llu ns.flusher.files.errors=%llu "
+                 "ns.flusher.files.pending=%llu\n",
+                 (unsigned long long) fflush["queued"],
+                 (unsigned long long) fflush["sent"],
+                 (unsigned long long) fflush["batches"],
+                 (unsigned long long) fflush["errors"],
+                 (unsigned long long) fflush["pending"]);
+        stdOut += sline;
+        snprintf(sline, sizeof(sline) - 1, "uid=all gid=all "
+                 "ns.flusher.containers.queued=%llu "
+                 "ns.flusher.containers.sent=%llu "
+                 "ns.flusher.containers.batches=%llu "
+                 "ns.flusher.containers.errors=%llu "
+                 "ns.flusher.containers.pending=%llu\n",
+                 (unsigned long long) dflush["queued"],
+                 (unsigned long long) dflush["sent"],
+                 (unsigned long long) dflush["batches"],
+                 (unsigned long long) dflush["errors"],
+                 (unsigned long long) dflush["pending"]);
+        stdOut += sline;
+      }
+
+      if (!acc.empty()) {
+        char sline[1024];
+        snprintf(sline, sizeof(sline) - 1, "uid=all gid=all "
+                 "ns.accounting.interval=%llu ns.accounting.cycles=%llu "
+                 "ns.accounting.queued=%llu ns.accounting.applied=%llu "
+                 "ns.accounting.coalesced=%llu "
+                 "ns.accounting.last_coalesced=%llu\n",
+                 (unsigned long long) acc["interval"],
+                 (unsigned long long) acc["cycles"],
+                 (unsigned long long) acc["queued"],
+                 (unsigned long long) acc["applied"],
+                 (unsigned long long) acc["coalesced"],
+                 (unsigned long long) acc["last_coalesced"]);
+        stdOut += sline;
+      }
+
       stdOut += "uid=all gid=all ns.total.files.changelog.size=";
       stdOut += eos::common::StringConversion::GetSizeString(clfsize,
                 (unsigned long long) statf.st_size);
@@ -494,6 +637,77 @@ ProcCommand::Ns()
     }
   }
 
+  if (mSubCmd == "memory") {
+    XrdOucString option = pOpaque->Get("mgm.option");
+    bool monitoring = (option.find("m") != STR_NPOS);
+    eos::IChLogFileMDSvc* eos_chlog_filesvc =
+      dynamic_cast<eos::IChLogFileMDSvc*>(gOFS->eosFileService);
+
+    if (!eos_chlog_filesvc) {
+      retc = EOPNOTSUPP;
+      stdErr = "error: ns does not support memory accounting";
+      mDoSort = false;
+      return SFS_OK;
+    }
+
+    std::map<std::string, uint64_t> stats;
+    {
+      eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex);
+      eos_chlog_filesvc->getMemoryStats(stats);
+    }
+    uint64_t nfiles = stats["files"];
+    uint64_t compact = stats["filemd_bytes"];
+    uint64_t legacy = stats["filemd_legacy_bytes"];
+    uint64_t idmap = stats["idmap_bytes"];
+    XrdOucString sizestring;
+
+    if (monitoring) {
+      char line[1024];
+      snprintf(line, sizeof(line), "uid=all gid=all ns.memory.files=%llu "
+               "ns.memory.filemd=%llu ns.memory.filemd.legacy=%llu "
+               "ns.memory.filemd.avg=%.01f ns.memory.idmap=%llu\n",
+               (unsigned long long) nfiles, (unsigned long long) compact,
+               (unsigned long long) legacy,
+               nfiles ? (1.0 * compact / nfiles) : 0.0,
+               (unsigned long long) idmap);
+      stdOut += line;
+    } else {
+      char avg[64];
+      char saved[64];
+      snprintf(avg, sizeof(avg), "%.01f B", nfiles ? (1.0 * compact / nfiles) : 0.0);
+      snprintf(saved, sizeof(saved), "%.01f %%",
+               legacy ? (100.0 - 100.0 * compact / legacy) : 0.0);
+      stdOut += "# ------------------------------------------------------------------------------------\n";
+      stdOut += "# Namespace Memory\n";
+      stdOut += "# ------------------------------------------------------------------------------------\n";
+      stdOut += "ALL      Files                            ";
+      stdOut += eos::common::StringConversion::GetSizeString(sizestring,
+                (unsigned long long) nfiles);
+      stdOut += "\n";
+      stdOut += "ALL      File metadata                    ";
+      stdOut += eos::common::StringConversion::GetReadableSizeString(sizestring,
+                (unsigned long long) compact, "B");
+      stdOut += "\n";
+      stdOut += "ALL      avg. File metadata               ";
+      stdOut += avg;
+      stdOut += "\n";
+      stdOut += "ALL      File metadata (legacy layout)    ";
+      stdOut += eos::common::StringConversion::GetReadableSizeString(sizestring,
+                (unsigned long long) legacy, "B");
+      stdOut += "\n";
+      stdOut += "ALL      saved by compact layout          ";
+      stdOut += saved;
+      stdOut += "\n";
+      stdOut += "ALL      File id map                      ";
+      stdOut += eos::common::StringConversion::GetReadableSizeString(sizestring,
+                (unsigned long long) idmap, "B");
+      stdOut += "\n";
+      stdOut += "# ------------------------------------------------------------------------------------\n";
+    }
+
+    mDoSort = false;
+  }
+
   if (mSubCmd == "compact") {
     if (pVid->uid == 0) {
       XrdOucString action = pOpaque->Get("mgm.ns.compact");
@@ -26,9 +26,11 @@
 #include "common/LayoutId.hh"
 #include "common/StringConversion.hh"
 #include "common/Path.hh"
+#include "common/DumpMd.hh"
 #include "mgm/ProcInterface.hh"
 #include "mgm/XrdMgmOfs.hh"
 #include "mgm/FsView.hh"
+#include "fst/FmdBase.pb.h"
 
 EOSMGMNAMESPACE_BEGIN
 
@@ -169,6 +171,141 @@ proc_fs_dumpmd(std::string& fsidst, XrdOucString& option, XrdOucString& dp,
   return retc;
 }
 
+//------------------------------------------------------------------------------
+// Convert a file to the record of the binary metadata dump
+//------------------------------------------------------------------------------
+static void
+DumpMdRecord(eos::IFileMD* fmd, eos::fst::FmdBase& record)
+{
+  eos::IFileMD::ctime_t ctime;
+  eos::IFileMD::ctime_t mtime;
+  fmd->getCTime(ctime);
+  fmd->getMTime(mtime);
+  record.Clear();
+  record.set_fid(fmd->getId());
+  record.set_cid(fmd->getContainerId());
+  record.set_ctime(ctime.tv_sec);
+  record.set_ctime_ns(ctime.tv_nsec);
+  record.set_mtime(mtime.tv_sec);
+  record.set_mtime_ns(mtime.tv_nsec);
+  record.set_mgmsize(fmd->getSize());
+  record.set_lid(fmd->getLayoutId());
+  record.set_uid(fmd->getCUid());
+  record.set_gid(fmd->getCGid());
+  // same representation as the text dump: hex checksum or 'none'
+  std::string checksum;
+  char hx[3];
+  eos::Buffer fmdchecksum = fmd->getChecksum();
+
+  for (size_t i = 0; i < fmdchecksum.getSize(); i++) {
+    snprintf(hx, sizeof(hx), "%02x",
+             (unsigned char) fmdchecksum.getDataPadded(i));
+    checksum += hx;
+  }
+
+  record.set_mgmchecksum(checksum.length() ? checksum : "none");
+  std::string locations;
+  char loc[16];
+  eos::IFileMD::LocationVector lvec = fmd->getLocations();
+
+  for (auto it = lvec.begin(); it != lvec.end(); ++it) {
+    snprintf(loc, sizeof(loc), "%u,", *it);
+    locations += loc;
+  }
+
+  lvec = fmd->getUnlinkedLocations();
+
+  for (auto it = lvec.begin(); it != lvec.end(); ++it) {
+    snprintf(loc, sizeof(loc), "!%u,", *it);
+    locations += loc;
+  }
+
+  record.set_locations(locations);
+}
+
+//------------------------------------------------------------------------------
+// Dump metadata information in binary format
+//------------------------------------------------------------------------------
+int
+proc_fs_dumpmd_proto(std::string& fsidst, std::string& out, size_t& entries)
+{
+  char header[64];
+  int retc = 0;
+  entries = 0;
+  out.clear();
+
+  if (!fsidst.length()) {
+    retc = EINVAL;
+  } else {
+    int fsid = atoi(fsidst.c_str());
+    eos::fst::FmdBase record;
+    std::string srecord;
+    snprintf(header, sizeof(header), "%s retc=0 ", eos::common::DumpMd::Tag());
+    out = header;
+    // The ids are collected at once, the records are built in batches and
+    // the namespace lock is released in between so that a large filesystem
+    // doesn't stall the writers for the whole dump
+    static const size_t sBatchSize = 10000;
+    std::vector<eos::IFileMD::id_t> fids;
+
+    try {
+      eos::common::RWMutexReadLock nslock(gOFS->eosViewRWMutex);
+      // Files which have yet to be unlinked are part of the dump as well
+      const eos::IFsView::FileList* lists[2] = {
+        &gOFS->eosFsView->getFileList(fsid),
+        &gOFS->eosFsView->getUnlinkedFileList(fsid)
+      };
+      fids.reserve(lists[0]->size() + lists[1]->size());
+
+      for (size_t l = 0; l < 2; l++) {
+        fids.insert(fids.end(), lists[l]->begin(), lists[l]->end());
+      }
+    } catch (eos::MDException& e) {
+      retc = e.getErrno() ? e.getErrno() : EIO;
+      eos_static_err("msg=\"exception\" ec=%d emsg=\"%s\"", e.getErrno(),
+                     e.getMessage().str().c_str());
+    }
+
+    for (size_t i = 0; !retc && (i < fids.size()); i += sBatchSize) {
+      eos::common::RWMutexReadLock nslock(gOFS->eosViewRWMutex);
+      size_t last = std::min(fids.size(), i + sBatchSize);
+
+      for (size_t n = i; n < last; n++) {
+        std::shared_ptr<eos::IFileMD> fmd;
+
+        try {
+          fmd = gOFS->eosFileService->getFileMD(fids[n]);
+        } catch (eos::MDException&) {
+          // deleted since the ids were collected
+          continue;
+        }
+
+        // the file may have been dropped from the filesystem meanwhile
+        if (!fmd || (!fmd->hasLocation(fsid) && !fmd->hasUnlinkedLocation(fsid))) {
+          continue;
+        }
+
+        entries++;
+        DumpMdRecord(fmd.get(), record);
+        record.SerializeToString(&srecord);
+        eos::common::DumpMd::Append(out, srecord);
+      }
+    }
+
+    if (!retc) {
+      eos::common::DumpMd::Append(out, std::string());
+    }
+  }
+
+  if (retc) {
+    snprintf(header, sizeof(header), "%s retc=%d ", eos::common::DumpMd::Tag(),
+             retc);
+    out = header;
+  }
+
+  return retc;
+}
+
 //------------------------------------------------------------------------------
 // Configure filesystem
 //------------------------------------------------------------------------------
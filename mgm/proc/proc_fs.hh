@@ -41,6 +41,14 @@ int proc_fs_dumpmd(std::string& fsidst, XrdOucString& option, XrdOucString& dp,
                    eos::common::Mapping::VirtualIdentity& vid_in,
                    size_t& entries);
 
+//------------------------------------------------------------------------------
+//! Dump the metadata held on a filesystem in the binary format read by the
+//! FST resync, see common/DumpMd.hh. The namespace lock is released between
+//! batches of records.
+//------------------------------------------------------------------------------
+int proc_fs_dumpmd_proto(std::string& fsidst, std::string& out,
+                         size_t& entries);
+
 //------------------------------------------------------------------------------
 //! Dump metada held on filesystem
 //------------------------------------------------------------------------------
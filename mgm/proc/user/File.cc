@@ -1812,11 +1812,12 @@ ProcCommand::File()
           stdOut += "&";
           stdOut += "mgm.checksum=";
           size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId());
+          eos::Buffer fmdchecksum = fmd->getChecksum();
 
           for (unsigned int i = 0; i < SHA_DIGEST_LENGTH; i++) {
             char hb[3];
             sprintf(hb, "%02x", (i < cxlen) ?
-                    ((unsigned char)(fmd->getChecksum().getDataPadded(i))) : 0);
+                    ((unsigned char)(fmdchecksum.getDataPadded(i))) : 0);
             stdOut += hb;
           }
 
@@ -262,11 +262,12 @@ ProcCommand::FileInfo(const char* path)
             stdOut += eos::common::LayoutId::GetChecksumString(fmd_copy->getLayoutId());
             stdOut += "\n";
             stdOut += "xs:     ";
+            eos::Buffer fmdchecksum = fmd_copy->getChecksum();
 
             for (unsigned int i = 0;
                  i < eos::common::LayoutId::GetChecksumLen(fmd_copy->getLayoutId()); i++) {
               char hb[3];
-              sprintf(hb, "%02x", (unsigned char)(fmd_copy->getChecksum().getDataPadded(i)));
+              sprintf(hb, "%02x", (unsigned char)(fmdchecksum.getDataPadded(i)));
               stdOut += hb;
             }
 
@@ -276,11 +277,12 @@ ProcCommand::FileInfo(const char* path)
             stdOut += eos::common::LayoutId::GetChecksumString(fmd_copy->getLayoutId());
             stdOut += " ";
             stdOut += "xs=";
+            eos::Buffer fmdchecksum = fmd_copy->getChecksum();
 
             for (unsigned int i = 0;
                  i < eos::common::LayoutId::GetChecksumLen(fmd_copy->getLayoutId()); i++) {
               char hb[3];
-              sprintf(hb, "%02x", (unsigned char)(fmd_copy->getChecksum().getDataPadded(i)));
+              sprintf(hb, "%02x", (unsigned char)(fmdchecksum.getDataPadded(i)));
               stdOut += hb;
             }
 
@@ -310,11 +312,12 @@ ProcCommand::FileInfo(const char* path)
             snprintf(setag, sizeof(setag) - 1, "%llu:",
                      (unsigned long long)eos::common::FileId::FidToInode(fmd_copy->getId()));
             etag = setag;
+            eos::Buffer fmdchecksum = fmd_copy->getChecksum();
 
             for (unsigned int i = 0; i < cxlen; i++) {
               char hb[3];
               sprintf(hb, "%02x", (i < cxlen) ? (unsigned char)(
-                        fmd_copy->getChecksum().getDataPadded(i)) : 0);
+                        fmdchecksum.getDataPadded(i)) : 0);
               etag += hb;
             }
           } else {
@@ -381,10 +384,11 @@ ProcCommand::FileInfo(const char* path)
             stdOut += eos::common::LayoutId::GetChecksumString(fmd_copy->getLayoutId());
             stdOut += "    XS: ";
             size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd_copy->getLayoutId());
+            eos::Buffer fmdchecksum = fmd_copy->getChecksum();
 
             for (unsigned int i = 0; i < cxlen; i++) {
               char hb[3];
-              sprintf(hb, "%02x ", (unsigned char)(fmd_copy->getChecksum().getDataPadded(i)));
+              sprintf(hb, "%02x ", (unsigned char)(fmdchecksum.getDataPadded(i)));
               stdOut += hb;
             }
 
@@ -464,9 +468,10 @@ ProcCommand::FileInfo(const char* path)
             size_t cxlen = eos::common::LayoutId::GetChecksumLen(fmd_copy->getLayoutId());
 
             if (cxlen) {
+              eos::Buffer fmdchecksum = fmd_copy->getChecksum();
               for (unsigned int i = 0; i < cxlen; i++) {
                 char hb[3];
-                sprintf(hb, "%02x", (unsigned char)(fmd_copy->getChecksum().getDataPadded(i)));
+                sprintf(hb, "%02x", (unsigned char)(fmdchecksum.getDataPadded(i)));
                 stdOut += hb;
               }
             } else {
@@ -728,6 +733,12 @@ ProcCommand::DirInfo(const char* path)
     } else {
       size_t num_containers = dmd->getNumContainers();
       size_t num_files = dmd->getNumFiles();
+
+      if (gOFS->eosContainerAccounting) {
+        // Propagate the queued tree size changes
+        gOFS->eosContainerAccounting->flushPendingUpdates();
+      }
+
       std::shared_ptr<eos::IContainerMD> dmd_copy(dmd->clone());
       dmd.reset();
       gOFS->eosViewRWMutex.UnLockRead();
@@ -1055,11 +1066,12 @@ ProcCommand::FileJSON(uint64_t fid, Json::Value* ret_json)
     json["checksumtype"] = eos::common::LayoutId::GetChecksumString(
                              fmd_copy->getLayoutId());
     std::string cks;
+    eos::Buffer fmdchecksum = fmd_copy->getChecksum();
 
     for (unsigned int i = 0;
          i < eos::common::LayoutId::GetChecksumLen(fmd_copy->getLayoutId()); i++) {
       char hb[3];
-      sprintf(hb, "%02x", (unsigned char)(fmd_copy->getChecksum().getDataPadded(i)));
+      sprintf(hb, "%02x", (unsigned char)(fmdchecksum.getDataPadded(i)));
       cks += hb;
     }
 
@@ -1077,7 +1089,7 @@ ProcCommand::FileJSON(uint64_t fid, Json::Value* ret_json)
       for (unsigned int i = 0; i < cxlen; i++) {
         char hb[3];
         sprintf(hb, "%02x", (i < cxlen) ? (unsigned char)
-                (fmd_copy->getChecksum().getDataPadded(i)) : 0);
+                (fmdchecksum.getDataPadded(i)) : 0);
         etag += hb;
       }
     } else {
@@ -1131,6 +1143,12 @@ ProcCommand::DirJSON(uint64_t fid, Json::Value* ret_json)
 
   try {
     gOFS->eosViewRWMutex.LockRead();
+
+    if (gOFS->eosContainerAccounting) {
+      // Propagate the queued tree size changes
+      gOFS->eosContainerAccounting->flushPendingUpdates();
+    }
+
     std::shared_ptr<eos::IContainerMD> cmd =
       gOFS->eosDirectoryService->getContainerMD(fid);
     fullpath = gOFS->eosView->getUri(cmd.get());
@@ -1158,6 +1176,7 @@ ProcCommand::DirJSON(uint64_t fid, Json::Value* ret_json)
 
     if (!ret_json) {
       std::set<std::string> files_name = cmd->getNameFiles();
+      cmd->prefetchFiles();
 
       for (auto it = files_name.begin(); it != files_name.end(); ++it) {
         std::shared_ptr<IFileMD> fmd = cmd->findFile(*it);
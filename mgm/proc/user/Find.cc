@@ -698,10 +698,11 @@ ProcCommand::Find ()
                         if (printchecksum)
                         {
                           if (!printcounter)fprintf(fstdout, " checksum=");
+                          eos::Buffer fmdchecksum = fmd->getChecksum();
                           for (unsigned int i = 0; i < eos::common::LayoutId::GetChecksumLen(fmd->getLayoutId()); i++)
                           {
                             if (!printcounter)
-                              fprintf(fstdout, "%02x", (unsigned char) (fmd->getChecksum().getDataPadded(i)));
+                              fprintf(fstdout, "%02x", (unsigned char) (fmdchecksum.getDataPadded(i)));
                           }
                         }
 
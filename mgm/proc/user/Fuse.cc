@@ -26,7 +26,10 @@
 #include "mgm/XrdMgmOfs.hh"
 #include "mgm/XrdMgmOfsDirectory.hh"
 #include "mgm/Access.hh"
+#include "mgm/Acl.hh"
 #include "mgm/Macros.hh"
+#include "common/FileId.hh"
+#include "common/InodeDirList.hh"
 /*----------------------------------------------------------------------------*/
 
 EOSMGMNAMESPACE_BEGIN
@@ -48,6 +51,11 @@ ProcCommand::Fuse ()
   PROC_BOUNCE_NOT_ALLOWED;
 
   spath = path;
+
+  if (pOpaque->Get("mgm.fuse.binary") && spath.length())
+  {
+    return FuseBinary(path, statentries);
+  }
   
   if(encodepath)
     mResultStream = "inodirlist_pathencode: retc=";
@@ -255,4 +263,154 @@ ProcCommand::Fuse ()
   return SFS_OK;
 }
 
+//------------------------------------------------------------------------------
+// Convert stat information into the fields of a binary listing record
+//------------------------------------------------------------------------------
+static void
+StatToFields (const struct stat& buf, uint64_t* fields)
+{
+  fields[0] = buf.st_atim.tv_nsec;
+  fields[1] = buf.st_atim.tv_sec;
+  fields[2] = buf.st_blksize;
+  fields[3] = buf.st_blocks;
+  fields[4] = buf.st_ctim.tv_nsec;
+  fields[5] = buf.st_ctim.tv_sec;
+  fields[6] = buf.st_dev;
+  fields[7] = buf.st_gid;
+  fields[8] = buf.st_ino;
+  fields[9] = buf.st_mode;
+  fields[10] = buf.st_mtim.tv_nsec;
+  fields[11] = buf.st_mtim.tv_sec;
+  fields[12] = buf.st_nlink;
+  fields[13] = buf.st_rdev;
+  fields[14] = buf.st_size;
+  fields[15] = buf.st_uid;
+}
+
+//------------------------------------------------------------------------------
+// Binary directory listing with inline stat information for the FUSE client.
+// The children are taken from the container under a single namespace lock,
+// without resolving the path of every entry.
+//------------------------------------------------------------------------------
+int
+ProcCommand::FuseBinary (const char* dirpath, bool statentries)
+{
+  eos::common::Path cPath(dirpath);
+  std::string& reply = mBinaryStream;
+  bool permok = false;
+  int rc = 0;
+  size_t nentries = 0;
+
+  gOFS->MgmStats.Add("OpenDir", pVid->uid, pVid->gid, 1);
+
+  if (statentries && gOFS->eosContainerAccounting)
+  {
+    // Propagate the queued tree size changes
+    gOFS->eosContainerAccounting->flushPendingUpdates();
+  }
+
+  char header[256];
+  snprintf(header, sizeof(header), "%s retc=0 ",
+           eos::common::InodeDirList::Tag());
+  reply = header;
+
+  {
+    eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex);
+    try
+    {
+      std::shared_ptr<eos::IContainerMD> dh =
+        gOFS->eosView->getContainer(cPath.GetPath());
+      permok = dh->access(pVid->uid, pVid->gid, R_OK | X_OK);
+
+      if (!permok)
+      {
+        // browse permission by ACL
+        eos::IContainerMD::XAttrMap attrmap;
+        Acl acl(cPath.GetPath(), *mError, *pVid, attrmap, false);
+        permok = (acl.HasAcl() && acl.CanBrowse());
+      }
+
+      if (permok)
+      {
+        struct stat buf;
+        uint64_t fields[eos::common::InodeDirList::kStatFields];
+        std::set<std::string> names = dh->getNameFiles();
+        nentries = names.size() + dh->getNumContainers();
+        // records with stat information take about 160 bytes
+        reply.reserve(reply.length() +
+                      (nentries + 2) * (statentries ? 160 : 32));
+        eos::common::InodeDirList::Append(reply, ".", 1, dh->getId(), 0);
+        eos::common::InodeDirList::Append(reply, "..", 2, dh->getParentId(), 0);
+        // fetch the file metadata in bulk rather than one by one
+        dh->prefetchFiles();
+
+        for (auto it = names.begin(); it != names.end(); ++it)
+        {
+          std::shared_ptr<eos::IFileMD> fmd = dh->findFile(*it);
+
+          if (!fmd)
+          {
+            continue;
+          }
+
+          if (statentries)
+          {
+            gOFS->_stat_file(fmd.get(), &buf);
+            StatToFields(buf, fields);
+          }
+
+          eos::common::InodeDirList::Append(reply, it->c_str(), it->length(),
+                                            eos::common::FileId::FidToInode(fmd->getId()),
+                                            statentries ? fields : 0);
+        }
+
+        names = dh->getNameContainers();
+
+        for (auto it = names.begin(); it != names.end(); ++it)
+        {
+          std::shared_ptr<eos::IContainerMD> cmd = dh->findContainer(*it);
+
+          if (!cmd)
+          {
+            continue;
+          }
+
+          if (statentries)
+          {
+            gOFS->_stat_container(cmd.get(), &buf);
+            StatToFields(buf, fields);
+          }
+
+          eos::common::InodeDirList::Append(reply, it->c_str(), it->length(),
+                                            cmd->getId(),
+                                            statentries ? fields : 0);
+        }
+      }
+      else
+      {
+        rc = EPERM;
+      }
+    }
+    catch (eos::MDException &e)
+    {
+      rc = e.getErrno();
+      eos_debug("msg=\"exception\" ec=%d emsg=\"%s\"\n",
+                e.getErrno(), e.getMessage().str().c_str());
+    }
+  }
+
+  gOFS->MgmStats.Add("OpenDir-Entry", pVid->uid, pVid->gid, nentries);
+
+  if (rc)
+  {
+    snprintf(header, sizeof(header), "%s retc=%d ",
+             eos::common::InodeDirList::Tag(), rc);
+    reply = header;
+  }
+
+  mLen = mBinaryStream.length();
+  mOffset = 0;
+  return SFS_OK;
+}
+
 EOSMGMNAMESPACE_END
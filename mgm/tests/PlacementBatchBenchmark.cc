@@ -0,0 +1,246 @@
+//------------------------------------------------------------------------------
+// File: PlacementBatchBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Throughput of the placement of new files in a scheduling group one
+//!        by one, the way placeNewReplicasOneGroup does, compared to batches
+//!        placed on one prepared copy of the tree the way
+//!        placeNewReplicasOneGroupBatch does
+//------------------------------------------------------------------------------
+
+#include "mgm/geotree/SchedulingSlowTree.hh"
+#include "common/Logging.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace eos::mgm;
+
+static const size_t sBufferSize = sizeof(FastPlacementTree) +
+                                  FastPlacementTree::sGetMaxDataMemSize();
+static const unsigned long long sBookingSize = 1024 * 1024 * 1024ll;
+static const char sPenalty = 10;
+
+//------------------------------------------------------------------------------
+//! Fast structures of a scheduling group
+//------------------------------------------------------------------------------
+struct Group {
+  SlowTree slowTree;
+  FastPlacementTree placementTree;
+  FastROAccessTree rOAccessTree;
+  FastRWAccessTree rWAccessTree;
+  FastBalancingPlacementTree blcPlacementTree;
+  FastBalancingAccessTree blcAccessTree;
+  FastDrainingPlacementTree drnPlacementTree;
+  FastDrainingAccessTree drnAccessTree;
+  SchedTreeBase::FastTreeInfo treeInfo;
+  Fs2TreeIdxMap fs2TreeIdx;
+  GeoTag2NodeIdxMap tag2NodeIdx;
+};
+
+//------------------------------------------------------------------------------
+// Populate the group with nfs filesystems of various loads spread over sites,
+// racks and hosts
+//------------------------------------------------------------------------------
+static bool Populate(Group& group, size_t nfs)
+{
+  group.slowTree.setName("bench");
+
+  for (size_t i = 0; i < nfs; ++i) {
+    std::ostringstream geotag, host;
+    geotag << "site" << i % 2 << "::rack" << (i / 2) % 4;
+    host << "host" << i / 4 << ".cern.ch";
+    SchedTreeBase::TreeNodeInfo info;
+    info.geotag = geotag.str();
+    info.host = host.str();
+    info.fsId = i + 1;
+    SchedTreeBase::TreeNodeStateFloat state;
+    state.mStatus = (SchedTreeBase::tStatus)(SchedTreeBase::Available |
+                    SchedTreeBase::Writable | SchedTreeBase::Readable);
+    state.dlScore = 40 + rand() % 60;
+    state.ulScore = 40 + rand() % 60;
+    state.fillRatio = rand() % 80;
+    state.totalSpace = 2e12;
+
+    if (!group.slowTree.insert(&info, &state)) {
+      return false;
+    }
+  }
+
+  size_t nodes = group.slowTree.getNodeCount();
+  group.placementTree.selfAllocate(nodes);
+  group.rOAccessTree.selfAllocate(nodes);
+  group.rWAccessTree.selfAllocate(nodes);
+  group.blcPlacementTree.selfAllocate(nodes);
+  group.blcAccessTree.selfAllocate(nodes);
+  group.drnPlacementTree.selfAllocate(nodes);
+  group.drnAccessTree.selfAllocate(nodes);
+  return group.slowTree.buildFastStrcturesSched(&group.placementTree,
+         &group.rOAccessTree, &group.rWAccessTree, &group.blcPlacementTree,
+         &group.blcAccessTree, &group.drnPlacementTree, &group.drnAccessTree,
+         &group.treeInfo, &group.fs2TreeIdx, &group.tag2NodeIdx);
+}
+
+//------------------------------------------------------------------------------
+// Place nrep replicas of one file on a working copy of tree, return false if
+// no slot could be found
+//------------------------------------------------------------------------------
+static bool PlaceOne(const FastPlacementTree* tree, char* buffer, size_t nrep,
+                     std::vector<SchedTreeBase::tFastTreeIdx>& replicas)
+{
+  replicas.clear();
+
+  if (tree->copyToBuffer(buffer, sBufferSize)) {
+    return false;
+  }
+
+  FastPlacementTree* work = (FastPlacementTree*) buffer;
+
+  for (size_t k = 0; k < nrep; ++k) {
+    SchedTreeBase::tFastTreeIdx idx;
+
+    if (!work->findFreeSlot(idx, 0, true, true)) {
+      return false;
+    }
+
+    replicas.push_back(idx);
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Place nfiles files in batches of batch files, a batch of 1 places the files
+// one by one, return the rate in files/s and count the replicas per node
+//------------------------------------------------------------------------------
+static double Run(const Group& group, size_t nfiles, size_t batch, size_t nrep,
+                  std::vector<size_t>& load)
+{
+  std::vector<char> prepared(sBufferSize), work(sBufferSize);
+  std::vector<SchedTreeBase::tFastTreeIdx> replicas;
+  FastPlacementTree* tree = (FastPlacementTree*) prepared.data();
+  size_t placed = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  while (placed < nfiles) {
+    // the copy, the booking and the sorting are done once per batch
+    if (group.placementTree.copyToBuffer(prepared.data(), sBufferSize)) {
+      return 0;
+    }
+
+    tree->bookSpace(sBookingSize);
+    tree->updateTree();
+
+    for (size_t f = 0; (f < batch) && (placed < nfiles); ++f, ++placed) {
+      if (!PlaceOne(tree, work.data(), nrep, replicas)) {
+        return 0;
+      }
+
+      for (auto idx : replicas) {
+        load[idx]++;
+
+        // the next files of the batch are spread according to the weights left
+        if (batch > 1) {
+          tree->applyScorePenalty(idx, sPenalty, sPenalty);
+        }
+      }
+    }
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  return nfiles / std::chrono::duration<double>(stop - start).count();
+}
+
+//------------------------------------------------------------------------------
+// Ratio of the maximum to the average number of replicas per fs
+//------------------------------------------------------------------------------
+static double Imbalance(const std::vector<size_t>& load, size_t nfs)
+{
+  size_t total = 0, max = 0;
+
+  for (auto n : load) {
+    total += n;
+    max = std::max(max, n);
+  }
+
+  return total ? (double) max * nfs / total : 0;
+}
+
+int main(int argc, char** argv)
+{
+  size_t nfiles = 100000;
+  size_t nfs = 192;
+  size_t nrep = 2;
+
+  if (argc > 1) {
+    nfiles = strtoull(argv[1], 0, 10);
+  }
+
+  if (argc > 2) {
+    nrep = strtoull(argv[2], 0, 10);
+  }
+
+  if (!nfiles || !nrep) {
+    std::cerr << "Usage: eos-placement-batch-bench [<files> [<replicas>]]"
+              << std::endl;
+    return 1;
+  }
+
+  eos::common::Logging::Init();
+  eos::common::Logging::SetUnit("PlacementBatchBenchmark");
+  eos::common::Logging::SetLogPriority(LOG_WARNING);
+  srand(0);
+  Group group;
+
+  if (!Populate(group, nfs)) {
+    std::cerr << "error: failed to build the scheduling group" << std::endl;
+    return 1;
+  }
+
+  fprintf(stdout, "# files=%zu fs=%zu replicas=%zu\n", nfiles, nfs, nrep);
+  fprintf(stdout, "%-8s %16s %8s %10s\n", "batch", "files/s", "speedup",
+          "max/avg");
+  double single = 0;
+
+  for (size_t batch = 1; batch <= 1024; batch *= 4) {
+    std::vector<size_t> load(group.placementTree.getNodeCount(), 0);
+    double rate = Run(group, nfiles, batch, nrep, load);
+
+    if (!rate) {
+      std::cerr << "error: placement failed" << std::endl;
+      return 1;
+    }
+
+    if (batch == 1) {
+      single = rate;
+    }
+
+    fprintf(stdout, "%-8zu %16.0f %8.2f %10.2f\n", batch, rate, rate / single,
+            Imbalance(load, nfs));
+  }
+
+  return 0;
+}
@@ -0,0 +1,352 @@
+//------------------------------------------------------------------------------
+// File: SchedulingBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Latency of the placement on a scheduling group while its fast
+//!        structures are refreshed in the background, comparing the double
+//!        buffer protected by a writer-preferring RWMutex to the epoch scheme
+//------------------------------------------------------------------------------
+
+#include "mgm/geotree/SchedulingSlowTree.hh"
+#include "mgm/geotree/SchedulingEpoch.hh"
+#include "common/Logging.hh"
+#include "common/RWMutex.hh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace eos::mgm;
+
+//------------------------------------------------------------------------------
+//! One copy of the fast structures of a scheduling group
+//------------------------------------------------------------------------------
+struct Snapshot {
+  FastPlacementTree placementTree;
+  FastROAccessTree rOAccessTree;
+  FastRWAccessTree rWAccessTree;
+  FastBalancingPlacementTree blcPlacementTree;
+  FastBalancingAccessTree blcAccessTree;
+  FastDrainingPlacementTree drnPlacementTree;
+  FastDrainingAccessTree drnAccessTree;
+  SchedTreeBase::FastTreeInfo treeInfo;
+  Fs2TreeIdxMap fs2TreeIdx;
+  GeoTag2NodeIdxMap tag2NodeIdx;
+
+  bool Build(SlowTree& st)
+  {
+    return st.buildFastStrcturesSched(&placementTree, &rOAccessTree,
+                                      &rWAccessTree, &blcPlacementTree,
+                                      &blcAccessTree, &drnPlacementTree,
+                                      &drnAccessTree, &treeInfo, &fs2TreeIdx,
+                                      &tag2NodeIdx);
+  }
+
+  void Allocate(size_t nodes)
+  {
+    placementTree.selfAllocate(nodes);
+    rOAccessTree.selfAllocate(nodes);
+    rWAccessTree.selfAllocate(nodes);
+    blcPlacementTree.selfAllocate(nodes);
+    blcAccessTree.selfAllocate(nodes);
+    drnPlacementTree.selfAllocate(nodes);
+    drnAccessTree.selfAllocate(nodes);
+  }
+};
+
+//------------------------------------------------------------------------------
+//! Scheduling group with a foreground and a background snapshot
+//------------------------------------------------------------------------------
+struct Group {
+  SlowTree slowTree;
+  std::vector<SchedTreeBase::TreeNodeInfo> infos;
+  Snapshot buffers[2];
+  Snapshot* foreground;
+  Snapshot* background;
+  eos::common::RWMutex doubleBufferMutex;
+  SchedulingEpoch epoch;
+};
+
+static const size_t sBufferSize = sizeof(FastPlacementTree) +
+                                  FastPlacementTree::sGetMaxDataMemSize();
+
+//------------------------------------------------------------------------------
+// Populate the group with nfs filesystems spread over sites, racks and hosts
+//------------------------------------------------------------------------------
+static bool Populate(Group& group, size_t nfs)
+{
+  group.slowTree.setName("bench");
+
+  for (size_t i = 0; i < nfs; ++i) {
+    std::ostringstream geotag, host;
+    geotag << "site" << i % 2 << "::rack" << (i / 2) % 4;
+    host << "host" << i / 4 << ".cern.ch";
+    SchedTreeBase::TreeNodeInfo info;
+    info.geotag = geotag.str();
+    info.host = host.str();
+    info.fsId = i + 1;
+    SchedTreeBase::TreeNodeStateFloat state;
+    state.mStatus = (SchedTreeBase::tStatus)(SchedTreeBase::Available |
+                    SchedTreeBase::Writable | SchedTreeBase::Readable);
+    state.dlScore = 100;
+    state.ulScore = 100;
+    state.fillRatio = 50;
+    state.totalSpace = 2e12;
+
+    if (!group.slowTree.insert(&info, &state)) {
+      return false;
+    }
+
+    group.infos.push_back(info);
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    group.buffers[i].Allocate(group.slowTree.getNodeCount());
+
+    if (!group.buffers[i].Build(group.slowTree)) {
+      return false;
+    }
+  }
+
+  group.foreground = &group.buffers[0];
+  group.background = &group.buffers[1];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Refresh the states of the filesystems and rebuild the background snapshot
+//------------------------------------------------------------------------------
+static void Refresh(Group& group, unsigned& seed)
+{
+  for (auto& info : group.infos) {
+    SchedTreeBase::TreeNodeStateFloat state;
+    state.mStatus = (SchedTreeBase::tStatus)(SchedTreeBase::Available |
+                    SchedTreeBase::Writable | SchedTreeBase::Readable);
+    state.dlScore = 40 + rand_r(&seed) % 60;
+    state.ulScore = 40 + rand_r(&seed) % 60;
+    state.fillRatio = rand_r(&seed) % 80;
+    state.totalSpace = 2e12;
+    group.slowTree.insert(&info, &state, true, true);
+  }
+
+  group.background->Build(group.slowTree);
+}
+
+//------------------------------------------------------------------------------
+// Place nrep replicas on the given snapshot the way placeNewReplicasOneGroup
+// does, return false if no slot could be found
+//------------------------------------------------------------------------------
+static bool Place(const Snapshot* snapshot, char* buffer, size_t nrep)
+{
+  if (snapshot->placementTree.copyToBuffer(buffer, sBufferSize)) {
+    return false;
+  }
+
+  FastPlacementTree* tree = (FastPlacementTree*) buffer;
+
+  for (size_t i = 0; i < nrep; ++i) {
+    SchedTreeBase::tFastTreeIdx idx;
+
+    if (!tree->findFreeSlot(idx, 0, true, true)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//! Latency distribution of one run
+//------------------------------------------------------------------------------
+struct Result {
+  double rate;
+  double p50;
+  double p99;
+  double p999;
+  double max;
+  size_t failed;
+  size_t swaps;
+};
+
+//------------------------------------------------------------------------------
+// Run nthreads placing threads for the given duration while the group is
+// refreshed every period
+//------------------------------------------------------------------------------
+static Result Run(Group& group, bool useEpoch, size_t nthreads, size_t nrep,
+                  std::chrono::milliseconds duration,
+                  std::chrono::milliseconds period)
+{
+  std::atomic<bool> done(false);
+  std::atomic<size_t> failed(0);
+  size_t swaps = 0;
+  std::vector<std::vector<double> > latencies(nthreads);
+  std::vector<std::thread> workers;
+  std::thread updater([&]() {
+    unsigned seed = 0;
+
+    while (!done) {
+      std::this_thread::sleep_for(period);
+      Refresh(group, seed);
+
+      if (useEpoch) {
+        SchedulingEpoch::Publish(group.foreground, group.background);
+        group.background = (group.background == &group.buffers[0]) ?
+                           &group.buffers[1] : &group.buffers[0];
+        group.epoch.Synchronize();
+      } else {
+        group.doubleBufferMutex.LockWrite();
+        std::swap(group.foreground, group.background);
+        group.doubleBufferMutex.UnLockWrite();
+      }
+
+      swaps++;
+    }
+  });
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    workers.emplace_back([&, i]() {
+      std::vector<char> buffer(sBufferSize);
+      std::vector<double>& lat = latencies[i];
+      lat.reserve(1 << 20);
+
+      while (!done) {
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok;
+
+        if (useEpoch) {
+          SchedulingEpoch::tToken token = group.epoch.ReadLock();
+          ok = Place(SchedulingEpoch::Dereference(group.foreground), buffer.data(),
+                     nrep);
+          group.epoch.ReadUnlock(token);
+        } else {
+          group.doubleBufferMutex.LockRead();
+          ok = Place(group.foreground, buffer.data(), nrep);
+          group.doubleBufferMutex.UnLockRead();
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+        lat.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+
+        if (!ok) {
+          failed++;
+        }
+      }
+    });
+  }
+
+  std::this_thread::sleep_for(duration);
+  done = true;
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  updater.join();
+  std::vector<double> all;
+
+  for (auto& lat : latencies) {
+    all.insert(all.end(), lat.begin(), lat.end());
+  }
+
+  std::sort(all.begin(), all.end());
+  Result res;
+  res.rate = all.size() / std::chrono::duration<double>(stop - start).count();
+  res.p50 = all.empty() ? 0 : all[all.size() * 50 / 100];
+  res.p99 = all.empty() ? 0 : all[all.size() * 99 / 100];
+  res.p999 = all.empty() ? 0 : all[all.size() * 999 / 1000];
+  res.max = all.empty() ? 0 : all.back();
+  res.failed = failed;
+  res.swaps = swaps;
+  return res;
+}
+
+static void Print(const char* mode, size_t nthreads, const Result& res)
+{
+  fprintf(stdout, "%-8s %-8zu %14.0f %10.2f %10.2f %10.2f %10.2f %8zu %8zu\n",
+          mode, nthreads, res.rate, res.p50, res.p99, res.p999, res.max,
+          res.swaps, res.failed);
+}
+
+int main(int argc, char** argv)
+{
+  size_t maxthreads = 32;
+  size_t seconds = 2;
+  size_t periodms = 10;
+  size_t nfs = 192;
+  size_t nrep = 2;
+
+  if (argc > 1) {
+    maxthreads = strtoull(argv[1], 0, 10);
+  }
+
+  if (argc > 2) {
+    seconds = strtoull(argv[2], 0, 10);
+  }
+
+  if (argc > 3) {
+    periodms = strtoull(argv[3], 0, 10);
+  }
+
+  if (!maxthreads || !seconds || !periodms) {
+    std::cerr << "Usage: eos-scheduling-bench [<max-threads> [<seconds> "
+              "[<refresh-period-ms>]]]" << std::endl;
+    return 1;
+  }
+
+  eos::common::Logging::Init();
+  eos::common::Logging::SetUnit("SchedulingBenchmark");
+  eos::common::Logging::SetLogPriority(LOG_WARNING);
+  Group group;
+  group.doubleBufferMutex.SetBlocking(true);
+
+  if (!Populate(group, nfs)) {
+    std::cerr << "error: failed to build the scheduling group" << std::endl;
+    return 1;
+  }
+
+  fprintf(stdout, "# fs=%zu replicas=%zu duration=%zus refresh=%zums "
+          "hw-threads=%u\n", nfs, nrep, seconds, periodms,
+          std::thread::hardware_concurrency());
+  fprintf(stdout, "%-8s %-8s %14s %10s %10s %10s %10s %8s %8s\n", "mode",
+          "threads", "ops/s", "p50(us)", "p99(us)", "p99.9(us)", "max(us)",
+          "swaps", "failed");
+
+  for (size_t nthreads = 1; nthreads <= maxthreads; nthreads *= 2) {
+    Result locked = Run(group, false, nthreads, nrep,
+                        std::chrono::seconds(seconds),
+                        std::chrono::milliseconds(periodms));
+    Result epoch = Run(group, true, nthreads, nrep,
+                       std::chrono::seconds(seconds),
+                       std::chrono::milliseconds(periodms));
+    Print("rwmutex", nthreads, locked);
+    Print("epoch", nthreads, epoch);
+  }
+
+  return 0;
+}
@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+// File: StatBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Scalability of Stat::Add/AddExec with the number of threads compared
+//!        to the previous implementation serializing on one global mutex
+//------------------------------------------------------------------------------
+
+#include "mgm/Stat.hh"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+//! Stat::Add and Stat::AddExec as they used to be
+//------------------------------------------------------------------------------
+class LockedStat
+{
+public:
+  void Add(const char* tag, uid_t uid, gid_t gid, unsigned long val)
+  {
+    Mutex.Lock();
+    StatsUid[tag][uid] += val;
+    StatsGid[tag][gid] += val;
+    StatAvgUid[tag][uid].Add(val);
+    StatAvgGid[tag][gid].Add(val);
+    Mutex.UnLock();
+  }
+
+  void AddExec(const char* tag, float exectime)
+  {
+    Mutex.Lock();
+    StatExec[tag].push_back(exectime);
+
+    if (StatExec[tag].size() > 100) {
+      StatExec[tag].pop_front();
+    }
+
+    Mutex.UnLock();
+  }
+
+  XrdSysMutex Mutex;
+  google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, unsigned long long> >
+  StatsUid;
+  google::sparse_hash_map<std::string, google::sparse_hash_map<gid_t, unsigned long long> >
+  StatsGid;
+  google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, eos::mgm::StatAvg> >
+  StatAvgUid;
+  google::sparse_hash_map<std::string, google::sparse_hash_map<gid_t, eos::mgm::StatAvg> >
+  StatAvgGid;
+  google::sparse_hash_map<std::string, std::deque<float> > StatExec;
+};
+
+static const char* sTags[] = {"OpenRead", "OpenWrite", "Stat", "Commit"};
+
+//------------------------------------------------------------------------------
+// Run nthreads threads doing nops Add + AddExec each, return the total rate
+//------------------------------------------------------------------------------
+template <typename StatType>
+double Run(StatType& stats, size_t nthreads, size_t nops)
+{
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    workers.emplace_back([&stats, i, nops]() {
+      for (size_t n = 0; n < nops; ++n) {
+        const char* tag = sTags[n % 4];
+        stats.Add(tag, i % 16, i % 4, 1);
+        stats.AddExec(tag, 0.1);
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(stop - start).count();
+  return (nthreads * nops) / seconds;
+}
+
+int main(int argc, char** argv)
+{
+  size_t nops = 1000000;
+
+  if (argc > 1) {
+    nops = strtoull(argv[1], 0, 10);
+  }
+
+  if (!nops) {
+    std::cerr << "Usage: eos-stat-bench [<ops-per-thread>]" << std::endl;
+    return 1;
+  }
+
+  fprintf(stdout, "# ops/thread=%zu hw-threads=%u\n", nops,
+          std::thread::hardware_concurrency());
+  fprintf(stdout, "%-8s %16s %16s %8s\n", "threads", "locked(ops/s)",
+          "sharded(ops/s)", "speedup");
+
+  for (size_t nthreads = 1; nthreads <= 64; nthreads *= 2) {
+    LockedStat locked;
+    eos::mgm::Stat sharded;
+    std::atomic<bool> done(false);
+    // fold concurrently the way Stat::Circulate does
+    std::thread folder([&sharded, &done]() {
+      while (!done) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(512));
+        sharded.Fold();
+      }
+    });
+    double locked_rate = Run(locked, nthreads, nops);
+    double sharded_rate = Run(sharded, nthreads, nops);
+    done = true;
+    folder.join();
+    sharded.Fold();
+    unsigned long long total = 0;
+
+    for (int i = 0; i < 4; ++i) {
+      total += sharded.GetTotal(sTags[i]);
+    }
+
+    if (total != nthreads * nops) {
+      fprintf(stderr, "error: lost updates - counted %llu instead of %zu\n",
+              total, nthreads * nops);
+      return 1;
+    }
+
+    fprintf(stdout, "%-8zu %16.0f %16.0f %8.2f\n", nthreads, locked_rate,
+            sharded_rate, sharded_rate / locked_rate);
+  }
+
+  return 0;
+}
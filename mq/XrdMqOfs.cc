@@ -92,16 +92,6 @@ STRINGSTORE(const char* __charptr__)
   }
 }
 
-XrdMqOfsOutMutex::XrdMqOfsOutMutex()
-{
-  gMqFS->QueueOutMutex.Lock();
-}
-
-XrdMqOfsOutMutex::~XrdMqOfsOutMutex()
-{
-  gMqFS->QueueOutMutex.UnLock();
-}
-
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -121,13 +111,12 @@ XrdMqOfs::XrdMqOfs(XrdSysError* ep)
   MaxMessageBacklog  = MQOFSMAXMESSAGEBACKLOG;
   MaxQueueBacklog    = MQOFSMAXQUEUEBACKLOG;
   RejectQueueBacklog = MQOFSREJECTQUEUEBACKLOG;
+  QueuedMessages = 0;
+  CoalescedMessages = 0;
+  CoalesceWindow = MQOFSCOALESCEWINDOW;
   (void) signal(SIGINT, xrdmqofs_shutdown);
   HostName = 0;
   HostPref = 0;
-  fprintf(stderr, "Addr::QueueOutMutex        0x%llx\n",
-          (unsigned long long) &gMqFS->QueueOutMutex);
-  fprintf(stderr, "Addr::MessageMutex         0x%llx\n",
-          (unsigned long long) &gMqFS->MessagesMutex);
 }
 
 /******************************************************************************/
@@ -274,9 +263,10 @@ XrdMqOfs::stat(const char*                queuename,
   ZTRACE(stat, "stat by buf: " << queuename);
   std::string squeue = queuename;
   {
-    XrdMqOfsOutMutex qm;
+    XrdMqOfsQueueShard& shard = gMqFS->GetShard(squeue);
+    XrdSysMutexHelper lock(shard);
 
-    if ((!gMqFS->QueueOut.count(squeue)) || (!(Out = gMqFS->QueueOut[squeue]))) {
+    if ((!shard.QueueOut.count(squeue)) || (!(Out = shard.QueueOut[squeue]))) {
       return gMqFS->Emsg(epname, error, EINVAL, "check queue - no such queue");
     }
 
@@ -297,7 +287,6 @@ XrdMqOfs::stat(const char*                queuename,
     XrdSmartOucEnv* env = new XrdSmartOucEnv(amg.GetMessageBuffer());
     XrdMqOfsMatches matches(gMqFS->QueueAdvisory.c_str(), env, tident,
                             XrdMqMessageHeader::kQueryMessage, queuename);
-    XrdMqOfsOutMutex qm;
 
     if (!gMqFS->Deliver(matches)) {
       delete env;
@@ -360,9 +349,10 @@ XrdMqOfsFile::open(const char*                queuename,
   tident = error.getErrUser();
   MAYREDIRECT;
   ZTRACE(open, "Connecting Queue: " << queuename);
-  XrdMqOfsOutMutex qm;
   QueueName = queuename;
   std::string squeue = queuename;
+  XrdMqOfsQueueShard& shard = gMqFS->GetShard(squeue);
+  XrdSysMutexHelper lock(shard);
 
   //  printf("%s %s %s\n",QueueName.c_str(),gMqFS->QueuePrefix.c_str(),opaque);
   // check if this queue is accepted by the broker
@@ -372,7 +362,7 @@ XrdMqOfsFile::open(const char*                queuename,
                        "connect queue - the broker does not serve the requested queue");
   }
 
-  if (gMqFS->QueueOut.count(squeue)) {
+  if (shard.QueueOut.count(squeue)) {
     fprintf(stderr, "EBUSY: Queue %s is busy\n", QueueName.c_str());
     // this is already open by 'someone'
     return gMqFS->Emsg(epname, error, EBUSY, "connect queue - already connected",
@@ -403,7 +393,7 @@ XrdMqOfsFile::open(const char*                queuename,
   Out->AdvisoryQuery  = advisoryquery;
   Out->AdvisoryFlushBackLog = advisoryflushbacklog;
   Out->BrokenByFlush = false;
-  gMqFS->QueueOut.insert(std::pair<std::string, XrdMqMessageOut*>(squeue, Out));
+  shard.QueueOut.insert(std::pair<std::string, XrdMqMessageOut*>(squeue, Out));
   ZTRACE(open, "Connected Queue: " << queuename);
   IsOpen = true;
   return SFS_OK;
@@ -421,15 +411,16 @@ XrdMqOfsFile::close()
   ZTRACE(close, "Disconnecting Queue: " << QueueName.c_str());
   std::string squeue = QueueName.c_str();
   {
-    XrdMqOfsOutMutex qm;
+    XrdMqOfsQueueShard& shard = gMqFS->GetShard(squeue);
+    XrdSysMutexHelper lock(shard);
 
-    if ((gMqFS->QueueOut.count(squeue)) && (Out = gMqFS->QueueOut[squeue])) {
+    if ((shard.QueueOut.count(squeue)) && (Out = shard.QueueOut[squeue])) {
       // hmm this could create a dead lock
       //      Out->DeletionSem.Wait();
       Out->Lock();
       // we have to take away all pending messages
       Out->RetrieveMessages();
-      gMqFS->QueueOut.erase(squeue);
+      shard.QueueOut.erase(squeue);
       delete Out;
     }
 
@@ -450,7 +441,6 @@ XrdMqOfsFile::close()
     XrdSmartOucEnv* env = new XrdSmartOucEnv(amg.GetMessageBuffer());
     XrdMqOfsMatches matches(gMqFS->QueueAdvisory.c_str(), env, tident,
                             XrdMqMessageHeader::kStatusMessage, QueueName.c_str());
-    XrdMqOfsOutMutex qm;
 
     if (!gMqFS->Deliver(matches)) {
       delete env;
@@ -527,7 +517,6 @@ XrdMqOfsFile::stat(struct stat* buf)
       XrdSmartOucEnv* env = new XrdSmartOucEnv(amg.GetMessageBuffer());
       XrdMqOfsMatches matches(gMqFS->QueueAdvisory.c_str(), env, tident,
                               XrdMqMessageHeader::kQueryMessage, QueueName.c_str());
-      XrdMqOfsOutMutex qm;
 
       if (!gMqFS->Deliver(matches)) {
         delete env;
@@ -660,6 +649,12 @@ int XrdMqOfs::Configure(XrdSysError& Eroute)
           }
         }
 
+        if (!strcmp("coalescewindow", var)) {
+          if ((val = Config.GetWord())) {
+            sscanf(val, "%lld", &CoalesceWindow);
+          }
+        }
+
         if (!strcmp("trace", var)) {
           if ((val = Config.GetWord())) {
             XrdOucString tracelevel = val;
@@ -708,6 +703,9 @@ int XrdMqOfs::Configure(XrdSysError& Eroute)
   BrokerId += QueuePrefix;
   Eroute.Say("=====> mq.queue: ", QueuePrefix.c_str());
   Eroute.Say("=====> mq.brokerid: ", BrokerId.c_str());
+  XrdOucString coalescewindow = "";
+  coalescewindow += (int) CoalesceWindow;
+  Eroute.Say("=====> mq.coalescewindow: ", coalescewindow.c_str());
   return rc;
 }
 
@@ -770,9 +768,11 @@ XrdMqOfs::Statistics()
       rc = write(fd, line, strlen(line));
       sprintf(line, "mq.total                  %lld\n", NoMessages);
       rc = write(fd, line, strlen(line));
-      sprintf(line, "mq.queued                 %d\n", (int)Messages.size());
+      sprintf(line, "mq.queued                 %lld\n", AtomicGet(QueuedMessages));
+      rc = write(fd, line, strlen(line));
+      sprintf(line, "mq.coalesced              %lld\n", CoalescedMessages);
       rc = write(fd, line, strlen(line));
-      sprintf(line, "mq.nqueues                %d\n", (int)QueueOut.size());
+      sprintf(line, "mq.nqueues                %d\n", (int)NumQueues());
       rc = write(fd, line, strlen(line));
       sprintf(line, "mq.backloghits            %lld\n", QueueBacklogHits);
       rc = write(fd, line, strlen(line));
@@ -817,8 +817,9 @@ XrdMqOfs::Statistics()
     ZTRACE(getstats, "Discarded Monitoring Messages : " <<
            DiscardedMonitoringMessages);
     ZTRACE(getstats, "No        Messages            : " << NoMessages);
-    ZTRACE(getstats, "Queue     Messages            : " << Messages.size());
-    ZTRACE(getstats, "#Queues                       : " << QueueOut.size());
+    ZTRACE(getstats, "Queue     Messages            : " << QueuedMessages);
+    ZTRACE(getstats, "Coalesced Messages            : " << CoalescedMessages);
+    ZTRACE(getstats, "#Queues                       : " << NumQueues());
     ZTRACE(getstats, "Deferred  Messages (backlog)  : " << BacklogDeferred);
     ZTRACE(getstats, "Backlog   Messages Hits       : " << QueueBacklogHits);
     char rates[4096];
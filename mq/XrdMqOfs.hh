@@ -41,6 +41,7 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <functional>
 
 #include <utime.h>
 #include <pwd.h>
@@ -53,6 +54,7 @@
 #include "XrdOuc/XrdOucTrace.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdSec/XrdSecEntity.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdSys/XrdSysSemWait.hh"
@@ -66,6 +68,13 @@
 #define MQOFSMAXQUEUEBACKLOG 50000
 #define MQOFSREJECTQUEUEBACKLOG 100000
 
+// number of independently locked partitions of the output queue map
+#define MQOFSQUEUESHARDS 64
+
+// window in ms during which a queued shared hash update is replaced by a newer
+// one of the same subject
+#define MQOFSCOALESCEWINDOW 1000
+
 #define MAYREDIRECT {                                       \
     int port=0;                                               \
     XrdOucString host="";                                     \
@@ -81,13 +90,16 @@ class XrdSmartOucEnv : public XrdOucEnv {
 private:
   int nref;
 public:
-  XrdSysMutex procmutex;
-  
-  int  Refs() { return nref; }
-  void DecRefs() { nref--;}
-  void AddRefs(int nrefs) { ;nref += nrefs;}
+  std::string CoalesceKey;                  // -> sender/subject of a coalescable shared hash update, empty otherwise
+  std::vector<std::string> CoalesceFields;  // -> sorted keys set by the update
+  long long ArrivalTime;                    // -> broker arrival time in ms
+
+  int  Refs() { return AtomicGet(nref); }
+  int  DecRefs() { return AtomicDec(nref) - 1;}
+  void AddRefs(int nrefs) { AtomicAdd(nref, nrefs);}
   XrdSmartOucEnv(const char *vardata=0, int vardlen=0) : XrdOucEnv(vardata,vardlen) {
     nref = 0;
+    ArrivalTime = 0;
   }
 
   virtual ~XrdSmartOucEnv() {}
@@ -122,16 +134,23 @@ public:
   XrdOucString QueueName;
   XrdSysSemWait DeletionSem; 
   XrdSysSemWait MessageSem; 
-  std::deque<XrdSmartOucEnv*> MessageQueue;
-  XrdMqMessageOut(const char* queuename){MessageBuffer="";AdvisoryStatus=false; AdvisoryQuery=false; AdvisoryFlushBackLog=false; BrokenByFlush=false; nQueued=0;QueueName=queuename;MessageQueue.clear();};
+  std::deque<XrdSmartOucEnv*> MessageQueue;   // -> a 0 entry is an update replaced by a newer one
+  unsigned long long nPushed;                 // -> messages appended to MessageQueue so far
+  unsigned long long nPopped;                 // -> messages removed from the front of MessageQueue so far
+  std::map<std::string, std::pair<unsigned long long, XrdSmartOucEnv*> > PendingUpdates; // -> coalesce key => (position, message) of the last queued update
+  XrdMqMessageOut(const char* queuename){MessageBuffer="";AdvisoryStatus=false; AdvisoryQuery=false; AdvisoryFlushBackLog=false; BrokenByFlush=false; nQueued=0;nPushed=0;nPopped=0;QueueName=queuename;MessageQueue.clear();};
   std::string MessageBuffer;
+  bool Push(XrdSmartOucEnv* message, long long window); // -> returns true if a queued update was replaced
   size_t RetrieveMessages();
   virtual ~XrdMqMessageOut(){
     RetrieveMessages();
   };
 };
 
-
+class XrdMqOfsQueueShard : public XrdSysMutex {
+public:
+  std::map<std::string, XrdMqMessageOut*> QueueOut;  // -> outputs connected whose name hashes to this shard
+};
 
 class XrdMqOfsFile : public XrdSfsFile
 {
@@ -184,12 +203,6 @@ private:
 };
 
 
-class XrdMqOfsOutMutex {
-public:
-  XrdMqOfsOutMutex();
-  ~XrdMqOfsOutMutex();
-};
-
 class XrdMqOfs : public XrdSfsFileSystem
 {
 public:
@@ -225,14 +238,20 @@ public:
   XrdOucString     QueueAdvisory;      // -> "<queueprefix>/*" for advisory message matches
   XrdOucString     BrokerId;           // -> manger id + queue name as path
 
-  std::map<std::string, XrdMqMessageOut*> QueueOut;  // -> hash of all output's connected
-  XrdSysMutex                 QueueOutMutex;  // -> mutex protecting the output hash
+  XrdMqOfsQueueShard QueueOutShards[MQOFSQUEUESHARDS]; // -> all output's connected, each shard with its own mutex
 
-  bool             Deliver(XrdMqOfsMatches &Match); // -> delivers a message into matching output queues
+  XrdMqOfsQueueShard& GetShard(const std::string& queuename) {
+    return QueueOutShards[std::hash<std::string>()(queuename) % MQOFSQUEUESHARDS];
+  }
+
+  size_t           NumQueues();                     // -> number of outputs connected
 
-  std::map<std::string, XrdSmartOucEnv*> Messages;  // -> hash with all messages
+  bool             Deliver(XrdMqOfsMatches &Match); // -> delivers a message into matching output queues
+  void             DeliverToQueues(XrdMqOfsMatches &Match, std::vector<XrdMqMessageOut*> &Outs); // -> appends a message to the given queues of one shard
+  void             ReleaseMessage(XrdSmartOucEnv* message); // -> drops a reference, deletes the message with the last one
 
-  XrdSysMutex                 MessagesMutex;  // -> mutex protecting the message hash
+  long long        QueuedMessages;                  // -> messages referenced by at least one output queue
+  long long        CoalesceWindow;                  // -> window in ms for coalescing shared hash updates, 0 disables it
   int              stat(const char               *Name,
                         struct stat              *buf,
                         XrdOucErrInfo            &error,
@@ -272,6 +291,7 @@ public:
   long long    MaxMessageBacklog;
   long long    MaxQueueBacklog;
   long long    RejectQueueBacklog; 
+  long long    CoalescedMessages;
   void         Statistics();
   XrdOucString StatisticsFile;
   char         *ConfigFN;
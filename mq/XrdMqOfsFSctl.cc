@@ -28,15 +28,98 @@
 #include "mq/XrdMqOfsTrace.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 
+#include <algorithm>
+
 #define XRDMQOFS_FSCTLPATHLEN 1024
 
 extern XrdOucTrace gMqOfsTrace;
 extern XrdMqOfs*   gMqFS;
 
+// shared hash update messages as encoded by XrdMqSharedHash
+#define XRDMQOFS_SHAREDHASH_UPDATE  "mqsh.cmd=update"
+#define XRDMQOFS_SHAREDHASH_SUBJECT "mqsh.subject"
+#define XRDMQOFS_SHAREDHASH_TYPE    "mqsh.type"
+#define XRDMQOFS_SHAREDHASH_PAIRS   "mqsh.pairs"
+
 /////////////////////////////////////////////////////////////////////////////
 // Helper Classes & Functions
 /////////////////////////////////////////////////////////////////////////////
 
+//------------------------------------------------------------------------------
+// Fill the coalescing key and the updated keys of a plain shared hash update
+// "mqsh.pairs=|<key1>~<value1>%<changeid1>|<key2>~<value2>%<changeid2>..."
+// monitoring message, other messages are never coalesced
+//------------------------------------------------------------------------------
+static void
+ParseSharedHashUpdate(XrdSmartOucEnv* env, const char* sender)
+{
+  const char* body = env->Get(XMQBODY);
+  const char* subject = env->Get(XRDMQOFS_SHAREDHASH_SUBJECT);
+  const char* type = env->Get(XRDMQOFS_SHAREDHASH_TYPE);
+  const char* pairs = env->Get(XRDMQOFS_SHAREDHASH_PAIRS);
+
+  if (!env->Get(XMQMONITOR) || !body || strcmp(body, XRDMQOFS_SHAREDHASH_UPDATE) ||
+      !subject || !type || !pairs) {
+    return;
+  }
+
+  std::vector<std::string> fields;
+  const char* key = 0;
+  int nkeys = 0;
+  int ncids = 0;
+
+  for (const char* p = pairs; *p; p++) {
+    if (*p == '|') {
+      key = p + 1;
+      nkeys++;
+    } else if (*p == '~') {
+      if (!key) {
+        // the receivers reject this message, let them do it
+        return;
+      }
+
+      fields.push_back(std::string(key, p - key));
+      key = 0;
+    } else if (*p == '%') {
+      ncids++;
+    }
+  }
+
+  if (fields.empty() || (nkeys != (int) fields.size()) ||
+      (ncids != (int) fields.size())) {
+    return;
+  }
+
+  std::sort(fields.begin(), fields.end());
+  fields.erase(std::unique(fields.begin(), fields.end()), fields.end());
+  env->CoalesceFields.swap(fields);
+  env->CoalesceKey = sender;
+  env->CoalesceKey += "\n";
+  env->CoalesceKey += subject;
+  env->CoalesceKey += "\n";
+  env->CoalesceKey += type;
+}
+
+size_t
+XrdMqOfs::NumQueues() {
+  size_t n = 0;
+  for (int i = 0; i < MQOFSQUEUESHARDS; i++) {
+    XrdSysMutexHelper lock(QueueOutShards[i]);
+    n += QueueOutShards[i].QueueOut.size();
+  }
+  return n;
+}
+
+void
+XrdMqOfs::ReleaseMessage(XrdSmartOucEnv* message) {
+  if (message->DecRefs() <= 0) {
+    // nobody references this message anymore
+    AtomicDec(QueuedMessages);
+    AtomicInc(FanOutMessages);
+    delete message;
+  }
+}
+
 bool
 XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
   EPNAME("AddToMatch");
@@ -45,65 +128,81 @@ XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
   
   std::string sendername = Matches.sendername.c_str();
 
-  // here we store all the queues where we need to deliver this message
-  std::vector<XrdMqMessageOut*> MatchedOutputQueues;
-
-  Matches.message->procmutex.Lock();
+  // keep the message alive while delivering - receivers in already served
+  // shards might retrieve and release it in the mean while
+  Matches.message->AddRefs(1);
 
   if ( ((Matches.messagetype) == XrdMqMessageHeader::kStatusMessage) || ((Matches.messagetype) == XrdMqMessageHeader::kQueryMessage) ) {
     //////////////////////////////////////////////////////////////////////////////////////
     // if we have a status message we have to do a complete loop
     //////////////////////////////////////////////////////////////////////////////////////
     
-    std::map<std::string, XrdMqMessageOut*>::const_iterator QueueOutIt;
-    for (QueueOutIt = QueueOut.begin(); QueueOutIt != QueueOut.end(); QueueOutIt++ ) {
-      XrdMqMessageOut* Out = QueueOutIt->second;
+    for (int i = 0; i < MQOFSQUEUESHARDS; i++) {
+      XrdMqOfsQueueShard& Shard = QueueOutShards[i];
+      // here we store all the queues of this shard where we need to deliver this message
+      std::vector<XrdMqMessageOut*> MatchedOutputQueues;
+      XrdSysMutexHelper lock(Shard);
+
+      std::map<std::string, XrdMqMessageOut*>::const_iterator QueueOutIt;
+      for (QueueOutIt = Shard.QueueOut.begin(); QueueOutIt != Shard.QueueOut.end(); QueueOutIt++ ) {
+        XrdMqMessageOut* Out = QueueOutIt->second;
       
-      // if this would be a loop back message we continue
-      if (sendername == QueueOutIt->first) {
-        // avoid feedback to the same queue
-        continue;
-      }
+        // if this would be a loop back message we continue
+        if (sendername == QueueOutIt->first) {
+          // avoid feedback to the same queue
+          continue;
+        }
       
-      // if this queue does not take advisory status messages we continue
-      if ( ( Matches.messagetype == XrdMqMessageHeader::kStatusMessage) && (!Out->AdvisoryStatus) )
-        continue;
+        // if this queue does not take advisory status messages we continue
+        if ( ( Matches.messagetype == XrdMqMessageHeader::kStatusMessage) && (!Out->AdvisoryStatus) )
+          continue;
 
-      // if this queue does not take advisory query messages we continue
-      if ( ( Matches.messagetype == XrdMqMessageHeader::kQueryMessage)  && (!Out->AdvisoryQuery) )
-        continue;
+        // if this queue does not take advisory query messages we continue
+        if ( ( Matches.messagetype == XrdMqMessageHeader::kQueryMessage)  && (!Out->AdvisoryQuery) )
+          continue;
       
 
-      else {
-        ZTRACE(fsctl,"Adding Advisory Message to Queuename: "<< Out->QueueName.c_str());
-        MatchedOutputQueues.push_back(Out);
+        else {
+          ZTRACE(fsctl,"Adding Advisory Message to Queuename: "<< Out->QueueName.c_str());
+          MatchedOutputQueues.push_back(Out);
+        }
       }
+
+      DeliverToQueues(Matches, MatchedOutputQueues);
     }
   } else {
     //////////////////////////////////////////////////////////////////////////////////////
     // if we have a wildcard match we have to do a complete loop
     //////////////////////////////////////////////////////////////////////////////////////
     if ( ( Matches.queuename.find("*") != STR_NPOS) ) {
-      std::map<std::string, XrdMqMessageOut*>::const_iterator QueueOutIt;
-      for (QueueOutIt = QueueOut.begin(); QueueOutIt != QueueOut.end(); QueueOutIt++ ) {
-        XrdMqMessageOut* Out = QueueOutIt->second;
+      XrdOucString nowildcard = Matches.queuename;
+      nowildcard.replace("*","");
+
+      for (int i = 0; i < MQOFSQUEUESHARDS; i++) {
+        XrdMqOfsQueueShard& Shard = QueueOutShards[i];
+        std::vector<XrdMqMessageOut*> MatchedOutputQueues;
+        XrdSysMutexHelper lock(Shard);
+
+        std::map<std::string, XrdMqMessageOut*>::const_iterator QueueOutIt;
+        for (QueueOutIt = Shard.QueueOut.begin(); QueueOutIt != Shard.QueueOut.end(); QueueOutIt++ ) {
+          XrdMqMessageOut* Out = QueueOutIt->second;
         
-        //      fprintf(stderr,"%s <=> %s\n", sendername.c_str(), QueueOutIt->first.c_str());
-        // if this would be a loop back message we continue
-        if (sendername == QueueOutIt->first) {
-          // avoid feedback to the same queue
-          continue;
-        }
+          // if this would be a loop back message we continue
+          if (sendername == QueueOutIt->first) {
+            // avoid feedback to the same queue
+            continue;
+          }
         
-        XrdOucString Key = QueueOutIt->first.c_str();
-        XrdOucString nowildcard = Matches.queuename;
-        nowildcard.replace("*","");
-        int nmatch = Key.matches(Matches.queuename.c_str(),'*');
-        if (nmatch == nowildcard.length()) {
-          // this is a match
-          ZTRACE(fsctl,"Adding Wildcard matched Message to Queuename: "<< Out->QueueName.c_str());
-          MatchedOutputQueues.push_back(Out);
+          XrdOucString Key = QueueOutIt->first.c_str();
+          int nmatch = Key.matches(Matches.queuename.c_str(),'*');
+          if (nmatch == nowildcard.length()) {
+            // this is a match
+            ZTRACE(fsctl,"Adding Wildcard matched Message to Queuename: "<< Out->QueueName.c_str());
+            MatchedOutputQueues.push_back(Out);
+          }
         }
+
+        DeliverToQueues(Matches, MatchedOutputQueues);
       }
     } else {
       //////////////////////////////////////////////////////////////////////////////////////
@@ -111,22 +210,39 @@ XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
       //////////////////////////////////////////////////////////////////////////////////////
 
       std::string queuename = Matches.queuename.c_str();
+      XrdMqOfsQueueShard& Shard = GetShard(queuename);
+      std::vector<XrdMqMessageOut*> MatchedOutputQueues;
+      XrdSysMutexHelper lock(Shard);
 
-      XrdMqMessageOut* Out = 0;
-      if (QueueOut.count(queuename))
-        Out = QueueOut[queuename];
-      if (Out) {
+      std::map<std::string, XrdMqMessageOut*>::const_iterator QueueOutIt = Shard.QueueOut.find(queuename);
+      if ((QueueOutIt != Shard.QueueOut.end()) && QueueOutIt->second) {
+        XrdMqMessageOut* Out = QueueOutIt->second;
         ZTRACE(fsctl,"Adding full matched Message to Queuename: "<< Out->QueueName.c_str());
         MatchedOutputQueues.push_back(Out);
       }
+
+      DeliverToQueues(Matches, MatchedOutputQueues);
     }
   }
 
+  if (Matches.matches>0) {
+    // the message belongs to the output queues now
+    ReleaseMessage(Matches.message);
+    return true;
+  } else {
+    // the message still belongs to the caller
+    Matches.message->DecRefs();
+    return false;
+  }
+}
+
+void
+XrdMqOfs::DeliverToQueues(XrdMqOfsMatches &Matches, std::vector<XrdMqMessageOut*> &MatchedOutputQueues) {
+  EPNAME("AddToMatch");
+
+  const char* tident = Matches.tident;
+
   if (MatchedOutputQueues.size()) {
-    // this is a match
-    Matches.backlog = false;
-    Matches.backlogrejected = false;
-    
     // lock all matched queues at once
     for (unsigned int i=0; i< MatchedOutputQueues.size(); i++) {
       XrdMqMessageOut* Out = MatchedOutputQueues[i];    
@@ -150,7 +266,7 @@ XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
 
         Matches.backlogqueues += Out->QueueName;
         Matches.backlogqueues += ":";
-        gMqFS->QueueBacklogHits++;
+        AtomicInc(gMqFS->QueueBacklogHits);
 	if (!Out->BrokenByFlush)
 	  TRACES("warning: queue " << Out->QueueName << " exceeds backlog of " << MaxQueueBacklog  << " message!");
       }
@@ -167,7 +283,7 @@ XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
 	}
         Matches.backlogqueues += Out->QueueName;
         Matches.backlogqueues += ":";
-        gMqFS->BacklogDeferred++;
+        AtomicInc(gMqFS->BacklogDeferred);
 	if (!Out->BrokenByFlush)
 	  TRACES("error: queue " << Out->QueueName << " exceeds max. accepted backlog of " << RejectQueueBacklog << " message!");
       } else {
@@ -175,19 +291,16 @@ XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
 	  // we deliver only to not broken clients, they have to reconnect to get out of this situation
 	  Matches.matches++;
 	  if (Matches.matches == 1) {
-	    // add to the message hash 
-	    gMqFS->MessagesMutex.Lock();
-	    std::string messageid = Matches.message->Get(XMQHEADER);
-	    gMqFS->Messages.insert(std::pair<std::string, XrdSmartOucEnv*> (messageid,Matches.message));
-	    gMqFS->MessagesMutex.UnLock();
+	    // account the message as pending
+	    AtomicInc(gMqFS->QueuedMessages);
 	  }
 
 	  ZTRACE(fsctl,"Adding Message to Queuename: "<< Out->QueueName.c_str());
-	  //      fprintf(stderr, "%s adding message %llu\n", Out->QueueName.c_str(), (unsigned long long)Matches.message);
-	  Out->MessageQueue.push_back((Matches.message));
+	  // the same message object is shared by all receivers
 	  Matches.message->AddRefs(1);
-	  
-	  Out->nQueued++;
+	  if (Out->Push(Matches.message, CoalesceWindow)) {
+	    AtomicInc(gMqFS->CoalescedMessages);
+	  }
 	}
         //      Out->MessageSem.Post();
       }
@@ -201,44 +314,67 @@ XrdMqOfs::Deliver(XrdMqOfsMatches &Matches) {
       Out->UnLock();
     }
   }
+}
 
-  Matches.message->procmutex.UnLock();
-  
-  if (Matches.matches>0) {
-    return true;
-  } else {
-    return false;
+//------------------------------------------------------------------------------
+// Append a message - a queued update of the same sender and subject which
+// arrived less than window ms before and sets no other key is replaced, the
+// new values win anyway. This has to be called with the queue locked.
+//------------------------------------------------------------------------------
+bool
+XrdMqMessageOut::Push(XrdSmartOucEnv* message, long long window) {
+  bool coalesced = false;
+
+  if (window && message->CoalesceKey.length()) {
+    std::pair<unsigned long long, XrdSmartOucEnv*>& pending = PendingUpdates[message->CoalesceKey];
+    XrdSmartOucEnv* previous = pending.second;
+
+    if (previous && (pending.first >= nPopped) &&
+        (MessageQueue[pending.first - nPopped] == previous) &&
+        ((message->ArrivalTime - previous->ArrivalTime) <= window) &&
+        std::includes(message->CoalesceFields.begin(), message->CoalesceFields.end(),
+                      previous->CoalesceFields.begin(), previous->CoalesceFields.end())) {
+      MessageQueue[pending.first - nPopped] = 0;
+      nQueued--;
+      gMqFS->ReleaseMessage(previous);
+      coalesced = true;
+    }
+
+    pending.first = nPushed;
+    pending.second = message;
   }
+
+  MessageQueue.push_back(message);
+  nPushed++;
+  nQueued++;
+  return coalesced;
 }
                                                   
 size_t
 XrdMqMessageOut::RetrieveMessages() {
   XrdSmartOucEnv* message;
+  long long delivered = 0;
   while (MessageQueue.size()) {
     message = MessageQueue.front();
     MessageQueue.pop_front();
-    message->procmutex.Lock();
-    //    fprintf(stderr,"%llu %s Message %llu nref: %d\n", (unsigned long long) &MessageQueue, QueueName.c_str(), (unsigned long long) message, message->Refs());
+    nPopped++;
 
-    int len;
-    MessageBuffer += message->Env(len);
-    gMqFS->MessagesMutex.Lock();
-    gMqFS->DeliveredMessages++;
-    message->DecRefs();
-    if (message->Refs()<=0) {
-      // we can delete this message from the queue!
-      XrdOucString msg = message->Get(XMQHEADER);
-      gMqFS->Messages.erase(msg.c_str());
-      message->procmutex.UnLock();
-      //      fprintf(stderr,"%s delete %llu \n", QueueName.c_str(), (unsigned long long) message);
-      delete message;
-      gMqFS->FanOutMessages++;
-    } else {
-      message->procmutex.UnLock();
+    if (!message) {
+      // replaced by a newer update
+      continue;
     }
+
+    int len;
+    const char* buffer = message->Env(len);
+    MessageBuffer.append(buffer, len);
+    delivered++;
     nQueued--;
-    gMqFS->MessagesMutex.UnLock();
+    gMqFS->ReleaseMessage(message);
   }
+
+  // nothing is pending anymore
+  PendingUpdates.clear();
+  AtomicAdd(gMqFS->DeliveredMessages, delivered);
   return MessageBuffer.length();
 }
 
@@ -263,9 +399,8 @@ XrdMqOfs::FSctl(const int               cmd,
   }
 
   // check for backlog
-  if ((long long)Messages.size() > MaxMessageBacklog ) {
-    // this is not absolutely threadsafe .... better would lock
-    BacklogDeferred++;
+  if (AtomicGet(QueuedMessages) > MaxMessageBacklog ) {
+    AtomicInc(BacklogDeferred);
     gMqFS->Emsg(epname, error, ENOMEM, "accept message - too many pending messages", "");
     return SFS_ERROR;
   }
@@ -296,17 +431,10 @@ XrdMqOfs::FSctl(const int               cmd,
   ZTRACE(fsctl,opaque.c_str());
 
 
-  XrdSmartOucEnv* env = new XrdSmartOucEnv(opaque.c_str());
-
-  if (!env) {
-    gMqFS->Emsg(epname, error, ENOMEM, "allocate memory", "");
-    return SFS_ERROR;
-  }
   // look into the header
   XrdMqMessageHeader mh;
   if (!mh.Decode(opaque.c_str())) {
     gMqFS->Emsg(epname, error, EINVAL, "decode message header", "");
-    delete env;
     return SFS_ERROR;
   }
   // add the broker ID
@@ -318,23 +446,33 @@ XrdMqOfs::FSctl(const int               cmd,
   // encode the new values
   mh.Encode();
   
-  // replace the old header with the new one .... that's ugly :-(
-  int envlen;
-  XrdOucString envstring = env->Env(envlen);
+  // replace the old header with the new one in the env string (which starts
+  // with '&') and parse it only once - the resulting message is shared by all
+  // the receivers
+  XrdOucString envstring = opaque;
+  if (!envstring.beginswith("&")) {
+    envstring.insert("&",0);
+  }
   int p1 = envstring.find(XMQHEADER);
   int p2 = envstring.find("&",p1+1);
   envstring.erase(p1,p2-1);
   envstring.insert(mh.GetHeaderBuffer(),p1);
 
-  delete env;
-  env = new XrdSmartOucEnv(envstring.c_str());
+  XrdSmartOucEnv* env = new XrdSmartOucEnv(envstring.c_str());
 
-  XrdMqOfsMatches matches(mh.kReceiverQueue.c_str(), env, tident, mh.kType, mh.kSenderId.c_str());
-  {
-    XrdMqOfsOutMutex qm;
-    Deliver(matches);
+  if (!env) {
+    gMqFS->Emsg(epname, error, ENOMEM, "allocate memory", "");
+    return SFS_ERROR;
+  }
+
+  env->ArrivalTime = (mh.kBrokerTime_sec * 1000ll) + (mh.kBrokerTime_nsec / 1000000);
+  if (CoalesceWindow) {
+    ParseSharedHashUpdate(env, mh.kSenderId.c_str());
   }
 
+  XrdMqOfsMatches matches(mh.kReceiverQueue.c_str(), env, tident, mh.kType, mh.kSenderId.c_str());
+  Deliver(matches);
+
   if (matches.backlogrejected) {
     XrdOucString backlogmessage = "queue message on all receivers - maximum backlog exceeded on queues: ";
     backlogmessage += matches.backlogqueues;
@@ -344,7 +482,7 @@ XrdMqOfs::FSctl(const int               cmd,
       backlogmessage += "...";
     }
     TRACES(backlogmessage.c_str());
-    if (!matches.message->Refs())
+    if (!matches.matches)
       delete env;
     return SFS_ERROR;
   }
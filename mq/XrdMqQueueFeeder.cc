@@ -35,9 +35,11 @@ int main (int argc, char* argv[]) {
   long long feeded =0;
   long long sleeper = 0;
   long long size = 10;
+  long long subjects = 0;
 
-  if ( (argc < 2) || (argc > 5) ) {
-    fprintf(stderr, "usage: QueueFeeder <brokerurl>/<queue> [n feed] [sleep in mus after feed] [message size]\n");
+  if ( (argc < 2) || (argc > 6) ) {
+    fprintf(stderr, "usage: QueueFeeder <brokerurl>/<queue> [n feed] [sleep in mus after feed] [message size] [n hash subjects]\n");
+    fprintf(stderr, "       with n hash subjects > 0 the messages are shared hash updates cycling over the subjects\n");
     exit(-1);
   }
 
@@ -53,6 +55,10 @@ int main (int argc, char* argv[]) {
     size = strtoll(argv[4],0,10);
   }
 
+  if (argc >= 6) {
+    subjects = strtoll(argv[5],0,10);
+  }
+
   XrdOucString broker = argv[1];
   if (!broker.beginswith("root://")) {
     fprintf(stderr,"error: <borkerurl> has to be like root://host[:port]/<queue>\n");
@@ -93,7 +99,24 @@ int main (int argc, char* argv[]) {
     message.NewId();
     message.kMessageHeader.kDescription="Hello Dumper";
     message.kMessageHeader.kDescription += (int)feeded;
-    message.SetBody(body.c_str());
+
+    if (subjects > 0) {
+      // heartbeat like update of one filesystem hash as sent by XrdMqSharedHash
+      char pairs[256];
+      snprintf(pairs, sizeof(pairs), "|stat.heartbeat~%lld%%%lld|stat.payload~",
+               feeded, feeded);
+      XrdOucString update = "mqsh.cmd=update&mqsh.subject=/eos/bench/fs";
+      update += (int)(feeded % subjects);
+      update += "&mqsh.type=hash&mqsh.pairs=";
+      update += pairs;
+      update += body;
+      update += "%";
+      update += (int)feeded;
+      message.SetBody(update.c_str());
+      message.MarkAsMonitor();
+    } else {
+      message.SetBody(body.c_str());
+    }
     feeded ++;
 
     if (!(mqc << message)) {
@@ -39,6 +39,7 @@ bool XrdMqSharedObjectManager::sBroadcast = true;
 unsigned long long XrdMqSharedHash::sSetCounter = 0;
 unsigned long long XrdMqSharedHash::sSetNLCounter = 0;
 unsigned long long XrdMqSharedHash::sGetCounter = 0;
+unsigned long long XrdMqSharedHash::sVersionCounter = 0;
 
 __thread XrdMqSharedObjectChangeNotifier::Subscriber*
 XrdMqSharedObjectChangeNotifier::tlSubscriber = NULL;
@@ -69,7 +70,7 @@ XrdMqSharedObjectChangeNotifier::tlSubscriber = NULL;
 // Constructor
 //------------------------------------------------------------------------------
 XrdMqSharedHashEntry::XrdMqSharedHashEntry():
-  mKey(""), mValue(""), mChangeId(0)
+  mKey(""), mValue(""), mLongLong(0), mDouble(0), mChangeId(0)
 {
   mMtime.tv_sec = 0;
   mMtime.tv_usec = 0;
@@ -84,6 +85,7 @@ XrdMqSharedHashEntry::XrdMqSharedHashEntry(const char* key, const char* value):
   gettimeofday(&mMtime, 0);
   mKey = (key ? key : "");
   mValue = (value ? value : "");
+  ParseValue();
 }
 
 //------------------------------------------------------------------------------
@@ -96,6 +98,8 @@ XrdMqSharedHashEntry::operator=(const XrdMqSharedHashEntry& other)
     mChangeId = other.mChangeId;
     mKey = other.mKey;
     mValue = other.mValue;
+    mLongLong = other.mLongLong;
+    mDouble = other.mDouble;
     mMtime.tv_sec = other.mMtime.tv_sec;
     mMtime.tv_usec = other.mMtime.tv_usec;
   }
@@ -111,6 +115,30 @@ XrdMqSharedHashEntry::XrdMqSharedHashEntry(const XrdMqSharedHashEntry& other)
   *this = other;
 }
 
+//------------------------------------------------------------------------------
+// Parse the string value into its numeric representations, the same way the
+// getters of the hash used to do it on every call
+//------------------------------------------------------------------------------
+void
+XrdMqSharedHashEntry::ParseValue()
+{
+  mLongLong = 0;
+  mDouble = 0;
+
+  if (mValue.empty()) {
+    return;
+  }
+
+  errno = 0;
+  long long ll = strtoll(mValue.c_str(), 0, 10);
+
+  if (!errno) {
+    mLongLong = ll;
+  }
+
+  mDouble = atof(mValue.c_str());
+}
+
 //------------------------------------------------------------------------------
 // Get age in milliseconds
 //------------------------------------------------------------------------------
@@ -158,7 +186,7 @@ XrdMqSharedHash::XrdMqSharedHash(const char* subject, const char* bcast_queue,
   mType("hash"), mSOM(som),
   mBroadcastQueue((bcast_queue ? bcast_queue : "")),
   mSubject((subject ? subject : "")),
-  mIsTransaction(false)
+  mIsTransaction(false), mVersion(AtomicInc(sVersionCounter) + 1)
 {}
 
 //------------------------------------------------------------------------------
@@ -235,15 +263,12 @@ XrdMqSharedHash::GetKeys()
 long long
 XrdMqSharedHash::GetLongLong(const char* key)
 {
-  std::string get = Get(key);
-
-  if (get.length()) {
-    errno = 0;
-    long long ret = strtoll(get.c_str(), 0, 10);
+  AtomicInc(sGetCounter);
+  XrdMqRWMutexReadLock rd_lock(mStoreMutex);
+  auto it = mStore.find(key);
 
-    if (!errno) {
-      return ret;
-    }
+  if (it != mStore.end()) {
+    return it->second.GetLongLong();
   }
 
   return 0;
@@ -255,10 +280,12 @@ XrdMqSharedHash::GetLongLong(const char* key)
 double
 XrdMqSharedHash::GetDouble(const char* key)
 {
-  std::string get = Get(key);
+  AtomicInc(sGetCounter);
+  XrdMqRWMutexReadLock rd_lock(mStoreMutex);
+  auto it = mStore.find(key);
 
-  if (get.length()) {
-    return atof(get.c_str());
+  if (it != mStore.end()) {
+    return it->second.GetDouble();
   }
 
   return 0;
@@ -595,6 +622,7 @@ XrdMqSharedHash::Delete(const std::string& key, bool broadcast)
 
   if (mStore.count(key)) {
     mStore.erase(key);
+    BumpVersion();
     deleted = true;
 
     if (XrdMqSharedObjectManager::sBroadcast && broadcast) {
@@ -655,6 +683,7 @@ XrdMqSharedHash::Clear(bool broadcast)
   }
 
   mStore.clear();
+  BumpVersion();
 }
 
 //-------------------------------------------------------------------------------
@@ -665,11 +694,17 @@ XrdMqSharedHash::SetImpl(const char* key, const char* value, bool broadcast)
 {
   std::string skey = key;
   mStoreMutex.LockWrite();
+  auto it = mStore.find(skey);
 
-  if (mStore.count(skey) == 0) {
+  if (it == mStore.end()) {
     mStore.insert(std::make_pair(skey, XrdMqSharedHashEntry(key, value)));
+    BumpVersion();
+  } else if (it->second.HasValue(value)) {
+    // Same value published again, only refresh its age
+    it->second.Touch();
   } else {
-    mStore[skey] = XrdMqSharedHashEntry(key, value);
+    it->second = XrdMqSharedHashEntry(key, value);
+    BumpVersion();
   }
 
   mStoreMutex.UnLockWrite();
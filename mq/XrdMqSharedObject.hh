@@ -100,6 +100,46 @@ public:
     return mValue.c_str();
   }
 
+  //----------------------------------------------------------------------------
+  //! Get value as long long, parsed once when the value is set
+  //!
+  //! @return value as returned by strtoll or 0 if not a number
+  //----------------------------------------------------------------------------
+  inline long long GetLongLong() const
+  {
+    return mLongLong;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get value as double, parsed once when the value is set
+  //!
+  //! @return value as returned by atof
+  //----------------------------------------------------------------------------
+  inline double GetDouble() const
+  {
+    return mDouble;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Check if the entry holds the given value
+  //!
+  //! @param value value to compare with
+  //!
+  //! @return true if identical, otherwise false
+  //----------------------------------------------------------------------------
+  inline bool HasValue(const char* value) const
+  {
+    return (mValue == value);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Mark the entry as modified now without changing its value
+  //----------------------------------------------------------------------------
+  inline void Touch()
+  {
+    gettimeofday(&mMtime, 0);
+  }
+
   //----------------------------------------------------------------------------
   //! Set key
   //!
@@ -158,8 +198,15 @@ public:
 private:
   std::string mKey; ///< Entry key value
   std::string mValue; ///< Entry value
+  long long mLongLong; ///< Entry value as long long
+  double mDouble; ///< Entry value as double
   unsigned long long mChangeId; ///< Entry change id i.e. epoch
   struct timeval mMtime; ///< Last modification time of current entry
+
+  //----------------------------------------------------------------------------
+  //! Parse the string value into its numeric representations
+  //----------------------------------------------------------------------------
+  void ParseValue();
 };
 
 
@@ -173,6 +220,7 @@ public:
   static unsigned long long sSetCounter; ///< Counter for set operations
   static unsigned long long sSetNLCounter; ///< Counter for set no-lock operations
   static unsigned long long sGetCounter; ///< Counter for get operations
+  static unsigned long long sVersionCounter; ///< Source of the hash versions
 
   //----------------------------------------------------------------------------
   //! Constructor
@@ -196,6 +244,18 @@ public:
   //----------------------------------------------------------------------------
   unsigned int GetSize();
 
+  //----------------------------------------------------------------------------
+  //! Get the version of the hash contents. It changes whenever a key is
+  //! added, deleted or set to a different value and is unique among all the
+  //! hashes, so it can be used to validate anything derived from the contents.
+  //!
+  //! @return version of the contents
+  //----------------------------------------------------------------------------
+  inline unsigned long long GetVersion()
+  {
+    return AtomicGet(mVersion);
+  }
+
   //----------------------------------------------------------------------------
   //! Get age in milliseconds for a certain key
   //!
@@ -321,20 +381,20 @@ public:
   //============================================================================
 
   //----------------------------------------------------------------------------
-  //! Get key value as long long
+  //! Get key value as long long - the value is not parsed again
   //!
   //! @param key key to look for
   //!
-  //! @return value corresponding to the key
+  //! @return value corresponding to the key or 0 if it doesn't exist
   //----------------------------------------------------------------------------
   long long GetLongLong(const char* key);
 
   //----------------------------------------------------------------------------
-  //! Get key value as double
+  //! Get key value as double - the value is not parsed again
   //!
   //! @param key key to look for
   //!
-  //! @return value corresponding to the key
+  //! @return value corresponding to the key or 0 if it doesn't exist
   //----------------------------------------------------------------------------
   double GetDouble(const char* key);
 
@@ -418,6 +478,16 @@ private:
   XrdSysMutex mTransactMutex; ///< Mutex protecting the set of transactions
   std::set<std::string> mTransactions; ///< Set of transactions
   XrdMqRWMutex mStoreMutex; ///< RW Mutex protecting the mStore object
+  unsigned long long mVersion; ///< Version of the contents
+
+  //----------------------------------------------------------------------------
+  //! Assign a new version to the contents - must be called with the
+  //! mStoreMutex write-locked
+  //----------------------------------------------------------------------------
+  inline void BumpVersion()
+  {
+    mVersion = AtomicInc(sVersionCounter) + 1;
+  }
 
   //----------------------------------------------------------------------------
   //! Construct broadcast env header
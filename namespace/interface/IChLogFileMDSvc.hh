@@ -134,6 +134,15 @@ public:
   //! Resize container service map
   //------------------------------------------------------------------------
   virtual void resize() = 0;
+
+  //------------------------------------------------------------------------
+  //! Get memory accounting information about the file metadata held in
+  //! memory
+  //!
+  //! @param stats map filled with "files", "filemd_bytes",
+  //!        "filemd_legacy_bytes" and "idmap_bytes"
+  //------------------------------------------------------------------------
+  virtual void getMemoryStats(std::map<std::string, uint64_t>& stats) = 0;
 };
 
 EOSNSNAMESPACE_END
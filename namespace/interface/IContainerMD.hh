@@ -110,6 +110,12 @@ public:
   //----------------------------------------------------------------------------
   virtual std::shared_ptr<IFileMD> findFile(const std::string& name) = 0;
 
+  //----------------------------------------------------------------------------
+  //! Load the metadata of all the files of the container ahead of iterating
+  //! over them with findFile. The default does nothing.
+  //----------------------------------------------------------------------------
+  virtual void prefetchFiles() {}
+
   //----------------------------------------------------------------------------
   //! Get number of files
   //----------------------------------------------------------------------------
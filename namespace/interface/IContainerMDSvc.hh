@@ -108,6 +108,23 @@ public:
   //------------------------------------------------------------------------
   virtual uint64_t getNumContainers() = 0;
 
+  //------------------------------------------------------------------------
+  //! Get statistics of the metadata object cache. Services without a cache
+  //! leave the map untouched.
+  //!
+  //! @param stats map filled with "size", "hits", "misses" and "evictions"
+  //------------------------------------------------------------------------
+  virtual void getCacheStats(std::map<std::string, uint64_t>& stats) {}
+
+  //------------------------------------------------------------------------
+  //! Get statistics of the write-behind flusher. Services writing through
+  //! leave the map untouched.
+  //!
+  //! @param stats map filled with "queued", "sent", "batches", "errors" and
+  //!        "pending"
+  //------------------------------------------------------------------------
+  virtual void getFlusherStats(std::map<std::string, uint64_t>& stats) {}
+
   //------------------------------------------------------------------------
   //! Add file listener that will be notified about all of the changes in
   //! the store
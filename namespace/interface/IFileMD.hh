@@ -124,7 +124,7 @@ public:
   //----------------------------------------------------------------------------
   //! Get checksum
   //----------------------------------------------------------------------------
-  virtual const Buffer& getChecksum() const = 0;
+  virtual Buffer getChecksum() const = 0;
 
   //----------------------------------------------------------------------------
   //! Compare checksums
@@ -29,12 +29,14 @@
 #include "namespace/MDException.hh"
 #include <map>
 #include <string>
+#include <vector>
 
 EOSNSNAMESPACE_BEGIN
 
 //! Forward declaration
 class IContainerMDSvc;
 class IQuotaStats;
+class LockHandler;
 
 //------------------------------------------------------------------------------
 //! Interface for a listener that is notified about all of the
@@ -82,6 +84,24 @@ public:
   virtual bool fileMDCheck(IFileMD* obj) = 0;
   virtual void AddTree(IContainerMD* obj , int64_t dsize) = 0;
   virtual void RemoveTree(IContainerMD* obj , int64_t dsize) = 0;
+
+  //---------------------------------------------------------------------------
+  //! Apply the updates a listener has queued to be done in the background.
+  //! The caller must hold the namespace lock, at least in read mode.
+  //---------------------------------------------------------------------------
+  virtual void flushPendingUpdates() {}
+
+  //---------------------------------------------------------------------------
+  //! Set the namespace lock taken in read mode by a listener applying
+  //! updates in the background
+  //---------------------------------------------------------------------------
+  virtual void setNamespaceLock(LockHandler* ns_lock) {}
+
+  //---------------------------------------------------------------------------
+  //! Get statistics of a listener. Listeners without any leave the map
+  //! untouched.
+  //---------------------------------------------------------------------------
+  virtual void getStats(std::map<std::string, uint64_t>& stats) {}
 };
 
 //------------------------------------------------------------------------------
@@ -128,6 +148,13 @@ public:
   //------------------------------------------------------------------------
   virtual std::shared_ptr<IFileMD> getFileMD(IFileMD::id_t id) = 0;
 
+  //------------------------------------------------------------------------
+  //! Load the metadata of the given files ahead of a series of getFileMD
+  //! calls. Services with a remote backend fetch them in bulk, the default
+  //! does nothing.
+  //------------------------------------------------------------------------
+  virtual void prefetchFileMD(const std::vector<IFileMD::id_t>& ids) {}
+
   //------------------------------------------------------------------------
   //! Create new file metadata object with an assigned id, the user has
   //! to fill all the remaining fields
@@ -150,6 +177,23 @@ public:
   //------------------------------------------------------------------------
   virtual uint64_t getNumFiles() = 0;
 
+  //------------------------------------------------------------------------
+  //! Get statistics of the metadata object cache. Services without a cache
+  //! leave the map untouched.
+  //!
+  //! @param stats map filled with "size", "hits", "misses" and "evictions"
+  //------------------------------------------------------------------------
+  virtual void getCacheStats(std::map<std::string, uint64_t>& stats) {}
+
+  //------------------------------------------------------------------------
+  //! Get statistics of the write-behind flusher. Services writing through
+  //! leave the map untouched.
+  //!
+  //! @param stats map filled with "queued", "sent", "batches", "errors" and
+  //!        "pending"
+  //------------------------------------------------------------------------
+  virtual void getFlusherStats(std::map<std::string, uint64_t>& stats) {}
+
   //------------------------------------------------------------------------
   //! Add file listener that will be notified about all of the changes in
   //! the store
@@ -28,10 +28,41 @@
 #include "namespace/MDException.hh"
 #include "namespace/interface/IFileMDSvc.hh"
 #include <google/dense_hash_set>
+#include <memory>
 #include <set>
+#include <vector>
 
 EOSNSNAMESPACE_BEGIN
 
+//------------------------------------------------------------------------------
+//! Cursor over a collection owned by the namespace, no copy of the
+//! collection is made
+//------------------------------------------------------------------------------
+template<typename T>
+class ICollectionIterator
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  virtual ~ICollectionIterator() {};
+
+  //----------------------------------------------------------------------------
+  //! Check if the cursor points to an element
+  //----------------------------------------------------------------------------
+  virtual bool valid() = 0;
+
+  //----------------------------------------------------------------------------
+  //! Move to the next element
+  //----------------------------------------------------------------------------
+  virtual void next() = 0;
+
+  //----------------------------------------------------------------------------
+  //! Get the current element
+  //----------------------------------------------------------------------------
+  virtual T getElement() = 0;
+};
+
 //------------------------------------------------------------------------------
 //! File System view abtract class
 //------------------------------------------------------------------------------
@@ -50,6 +81,7 @@ public:
   // typedef std::set<IFileMD::id_t> FileList;
   typedef google::dense_hash_set<IFileMD::id_t> FileList;
   typedef FileList::iterator FileIterator;
+  typedef std::shared_ptr<ICollectionIterator<IFileMD::id_t>> FileListCursor;
 
   //----------------------------------------------------------------------------
   //! Destructor
@@ -95,6 +127,53 @@ public:
   //----------------------------------------------------------------------------
   virtual FileList getNoReplicasFileList() = 0;
 
+  //----------------------------------------------------------------------------
+  //! Get a cursor over the files on a file system without copying the list.
+  //! The caller must keep replica changes out while using it i.e. hold the
+  //! namespace view lock.
+  //!
+  //! @param location file system id
+  //!
+  //! @return cursor, not valid if there are no files on the file system
+  //----------------------------------------------------------------------------
+  virtual FileListCursor getFileListCursor(IFileMD::location_t location) = 0;
+
+  //----------------------------------------------------------------------------
+  //! Get a cursor over the files without replicas, same rules as above
+  //----------------------------------------------------------------------------
+  virtual FileListCursor getNoReplicasFileListCursor() = 0;
+
+  //----------------------------------------------------------------------------
+  //! Get number of files on a file system
+  //!
+  //! @param location file system id
+  //!
+  //! @return number of files, 0 if the file system is unknown
+  //----------------------------------------------------------------------------
+  virtual uint64_t getNumFilesOnFs(IFileMD::location_t location) = 0;
+
+  //----------------------------------------------------------------------------
+  //! Check if a file has a replica on a file system
+  //!
+  //! @param fid file id
+  //! @param location file system id
+  //!
+  //! @return true if the file is on the file system, otherwise false
+  //----------------------------------------------------------------------------
+  virtual bool hasFileId(IFileMD::id_t fid, IFileMD::location_t location) = 0;
+
+  //----------------------------------------------------------------------------
+  //! Get a random sample of distinct files on a file system, the cost depends
+  //! on the sample size and not on the number of files on the file system
+  //!
+  //! @param location file system id
+  //! @param num_files size of the sample, all the files if there are fewer
+  //!
+  //! @return file ids in random order
+  //----------------------------------------------------------------------------
+  virtual std::vector<IFileMD::id_t>
+  getRandomFiles(IFileMD::location_t location, size_t num_files) = 0;
+
   //----------------------------------------------------------------------------
   //! Get number of file systems
   //----------------------------------------------------------------------------
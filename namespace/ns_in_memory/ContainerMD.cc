@@ -94,7 +94,7 @@ ContainerMD& ContainerMD::operator= (const ContainerMD& other)
   pACLId    = other.pACLId;
   pXAttrs   = other.pXAttrs;
   pFlags    = other.pFlags;
-  pTreeSize = other.pTreeSize;
+  pTreeSize = other.pTreeSize.load();
   // Note: pFiles and pSubContainers are not copied here
   return *this;
 }
@@ -161,6 +161,20 @@ ContainerMD::addFile(IFileMD* file)
   file->getFileMDSvc()->notifyListeners(&e);
 }
 
+//------------------------------------------------------------------------------
+// Add file without notifying the listeners
+//------------------------------------------------------------------------------
+bool
+ContainerMD::addFileNoNotify(IFileMD* file)
+{
+  if (!pFiles.insert(std::make_pair(file->getName(), file->getId())).second) {
+    return false;
+  }
+
+  file->setContainerId(pId);
+  return true;
+}
+
 //------------------------------------------------------------------------------
 // Remove file
 //------------------------------------------------------------------------------
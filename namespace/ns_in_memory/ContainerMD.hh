@@ -29,6 +29,7 @@
 #include "namespace/interface/IFileMD.hh"
 #include <stdint.h>
 #include <unistd.h>
+#include <atomic>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -114,6 +115,15 @@ class ContainerMD: public IContainerMD
   //----------------------------------------------------------------------------
   virtual void addFile(IFileMD* file);
 
+  //----------------------------------------------------------------------------
+  //! Add file without notifying the file listeners about the size change,
+  //! used by the parallel boot which replays the events afterwards
+  //!
+  //! @return false if a file with the same name exists already, in which
+  //!         case nothing is changed
+  //----------------------------------------------------------------------------
+  bool addFileNoNotify(IFileMD* file);
+
   //----------------------------------------------------------------------------
   //! Remove file
   //----------------------------------------------------------------------------
@@ -293,8 +303,7 @@ class ContainerMD: public IContainerMD
   //----------------------------------------------------------------------------
   uint64_t addTreeSize(uint64_t addsize)
   {
-    pTreeSize += addsize;
-    return pTreeSize;
+    return pTreeSize.fetch_add(addsize) + addsize;
   }
 
   //----------------------------------------------------------------------------
@@ -302,8 +311,7 @@ class ContainerMD: public IContainerMD
   //----------------------------------------------------------------------------
   uint64_t removeTreeSize(uint64_t removesize)
   {
-    pTreeSize -= removesize;
-    return pTreeSize;
+    return pTreeSize.fetch_sub(removesize) - removesize;
   }
 
   //----------------------------------------------------------------------------
@@ -509,7 +517,7 @@ class ContainerMD: public IContainerMD
   // Non-presistent data members
   mtime_t      pMTime;
   tmtime_t     pTMTime;
-  uint64_t     pTreeSize;
+  std::atomic<uint64_t> pTreeSize; ///< Updated by the accounting thread
 
   IFileMDSvc* pFileSvc; ///< File metadata service
   IContainerMDSvc* pContSvc; ///< Container metadata service
@@ -26,9 +26,93 @@
 #include "namespace/interface/IFileMDSvc.hh"
 #include <sstream>
 
+namespace
+{
+//------------------------------------------------------------------------------
+//! Data members of the FileMD layout used before the compact representation,
+//! kept only to be able to report how much memory the latter saves
+//------------------------------------------------------------------------------
+struct LegacyFileMDLayout
+{
+  void*                       vptr;
+  eos::IFileMD::id_t          id;
+  eos::IFileMD::ctime_t       ctime;
+  eos::IFileMD::ctime_t       mtime;
+  uint64_t                    size;
+  eos::IContainerMD::id_t     containerId;
+  uid_t                       cuid;
+  gid_t                       cgid;
+  eos::IFileMD::layoutId_t    layoutId;
+  uint16_t                    flags;
+  std::string                 name;
+  std::string                 linkName;
+  eos::IFileMD::LocationVector location;
+  eos::IFileMD::LocationVector unlinkedLocation;
+  eos::Buffer                 checksum;
+  eos::IFileMD::XAttrMap      xattrs;
+  eos::IFileMDSvc*            fileMDSvc;
+};
+
+//------------------------------------------------------------------------------
+// Size of the glibc malloc chunk serving a request of the given size
+//------------------------------------------------------------------------------
+uint64_t mallocChunkSize(uint64_t size)
+{
+  if (!size)
+    return 0;
+
+  uint64_t chunk = (size + 8 + 15) & ~15ull;
+  return (chunk < 32) ? 32 : chunk;
+}
+
+//------------------------------------------------------------------------------
+// Heap bytes of a std::string of the given length (SSO up to 15 chars)
+//------------------------------------------------------------------------------
+uint64_t stringHeapSize(size_t length)
+{
+  return (length > 15) ? mallocChunkSize(length + 1) : 0;
+}
+
+//------------------------------------------------------------------------------
+// Heap bytes of a std::vector<uint32_t> filled by push_back
+//------------------------------------------------------------------------------
+uint64_t locationVectorHeapSize(size_t count)
+{
+  size_t capacity = 1;
+
+  if (!count)
+    return 0;
+
+  while (capacity < count)
+    capacity <<= 1;
+
+  return mallocChunkSize(capacity * sizeof(eos::IFileMD::location_t));
+}
+
+//------------------------------------------------------------------------------
+// Heap bytes of the nodes of an extended attributes map
+//------------------------------------------------------------------------------
+uint64_t xattrNodesHeapSize(const eos::IFileMD::XAttrMap& xattrs)
+{
+  uint64_t total = 0;
+  eos::IFileMD::XAttrMap::const_iterator it;
+
+  for (it = xattrs.begin(); it != xattrs.end(); ++it)
+  {
+    total += mallocChunkSize(32 + sizeof(*it));
+    total += stringHeapSize(it->first.length());
+    total += stringHeapSize(it->second.length());
+  }
+
+  return total;
+}
+}
+
 namespace eos
 {
 
+FileMD::XAttrMap FileMD::sNoXAttrs;
+
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
@@ -37,12 +121,12 @@ FileMD::FileMD(id_t id, IFileMDSvc* fileMDSvc):
   pId(id),
   pSize(0),
   pContainerId(0),
+  pFileMDSvc(fileMDSvc),
   pCUid(0),
   pCGid(0),
   pLayoutId(0),
   pFlags(0),
-  pChecksum(0),
-  pFileMDSvc(fileMDSvc)
+  pChecksumLen(0)
 {
   pCTime.tv_sec = pCTime.tv_nsec = 0;
   pMTime.tv_sec = pMTime.tv_nsec = 0;
@@ -60,7 +144,8 @@ FileMD::clone() const
 //------------------------------------------------------------------------------
 // Copy constructor
 //------------------------------------------------------------------------------
-FileMD::FileMD(const FileMD& other)
+FileMD::FileMD(const FileMD& other):
+  IFileMD()
 {
   *this = other;
 }
@@ -79,16 +164,60 @@ FileMD::operator = (const FileMD& other)
   pCGid        = other.pCGid;
   pLayoutId    = other.pLayoutId;
   pFlags       = other.pFlags;
-  pLinkName    = other.pLinkName;
   pLocation    = other.pLocation;
   pUnlinkedLocation = other.pUnlinkedLocation;
   pCTime       = other.pCTime;
   pMTime       = other.pMTime;
-  pChecksum    = other.pChecksum;
+  pChecksumLen = other.pChecksumLen;
+  memcpy(pChecksum, other.pChecksum, sizeof(pChecksum));
   pFileMDSvc   = 0;
   return *this;
 }
 
+//------------------------------------------------------------------------------
+// Get checksum
+//------------------------------------------------------------------------------
+Buffer
+FileMD::getChecksum() const
+{
+  Buffer checksum(sChecksumSlotSize);
+  checksum.putData(pChecksum, pChecksumLen);
+  return checksum;
+}
+
+//------------------------------------------------------------------------------
+// Set checksum
+//------------------------------------------------------------------------------
+void
+FileMD::setChecksum(const void* checksum, uint8_t size)
+{
+  if (size > sChecksumSlotSize)
+  {
+    MDException e(EINVAL);
+    e.getMessage() << "Checksum of " << (int)size << " bytes does not fit in "
+                   << "the " << (int)sChecksumSlotSize << " bytes slot";
+    throw e;
+  }
+
+  memcpy(pChecksum, checksum, size);
+  pChecksumLen = size;
+}
+
+//------------------------------------------------------------------------------
+// Clear checksum
+//------------------------------------------------------------------------------
+void
+FileMD::clearChecksum(uint8_t size)
+{
+  size_t end = pChecksumLen + size;
+
+  if (end > sChecksumSlotSize)
+    end = sChecksumSlotSize;
+
+  memset(pChecksum + pChecksumLen, 0, end - pChecksumLen);
+  pChecksumLen = end;
+}
+
 //------------------------------------------------------------------------------
 // Add location
 //------------------------------------------------------------------------------
@@ -122,7 +251,7 @@ void FileMD::replaceLocation(unsigned int index, location_t newlocation)
 //------------------------------------------------------------------------------
 void FileMD::removeLocation(location_t location)
 {
-  std::vector<location_t>::iterator it;
+  location_t* it;
 
   for (it = pUnlinkedLocation.begin(); it < pUnlinkedLocation.end(); ++it)
   {
@@ -143,14 +272,13 @@ void FileMD::removeLocation(location_t location)
 //------------------------------------------------------------------------------
 void FileMD::removeAllLocations()
 {
-  std::vector<location_t>::reverse_iterator it;
-
-  while ((it = pUnlinkedLocation.rbegin()) != pUnlinkedLocation.rend())
+  while (!pUnlinkedLocation.empty())
   {
+    location_t loc = pUnlinkedLocation[pUnlinkedLocation.size() - 1];
     pUnlinkedLocation.pop_back();
     IFileMDChangeListener::Event e(this,
                                    IFileMDChangeListener::LocationRemoved,
-                                   *it);
+                                   loc);
     pFileMDSvc->notifyListeners(&e);
   }
 }
@@ -160,7 +288,7 @@ void FileMD::removeAllLocations()
 //------------------------------------------------------------------------------
 void FileMD::unlinkLocation(location_t location)
 {
-  std::vector<location_t>::iterator it;
+  location_t* it;
 
   for (it = pLocation.begin() ; it < pLocation.end(); it++)
   {
@@ -182,11 +310,9 @@ void FileMD::unlinkLocation(location_t location)
 //------------------------------------------------------------------------------
 void FileMD::unlinkAllLocations()
 {
-  std::vector<location_t>::reverse_iterator it;
-
-  while ((it = pLocation.rbegin()) != pLocation.rend())
+  while (!pLocation.empty())
   {
-    location_t loc = *it;
+    location_t loc = pLocation[pLocation.size() - 1];
     pUnlinkedLocation.push_back(loc);
     pLocation.pop_back();
     IFileMDChangeListener::Event e(this,
@@ -203,7 +329,7 @@ void FileMD::getEnv(std::string& env, bool escapeAnd)
 {
   env = "";
   std::ostringstream o;
-  std::string saveName = pName;
+  std::string saveName = pName.getName();
 
   if (escapeAnd)
   {
@@ -228,7 +354,7 @@ void FileMD::getEnv(std::string& env, bool escapeAnd)
   o << "&lid=" << pLayoutId;
   env += o.str();
   env += "&location=";
-  LocationVector::iterator it;
+  const location_t* it;
   char locs[16];
 
   for (it = pLocation.begin(); it != pLocation.end(); ++it)
@@ -246,14 +372,11 @@ void FileMD::getEnv(std::string& env, bool escapeAnd)
   }
 
   env += "&checksum=";
-  uint8_t size = pChecksum.getSize();
-
-  for (uint8_t i = 0; i < size; i++)
+  for (uint8_t i = 0; i < pChecksumLen; i++)
   {
     char hx[3];
     hx[0] = 0;
-    snprintf(hx, sizeof(hx), "%02x",
-             *((unsigned char*)(pChecksum.getDataPtr() + i)));
+    snprintf(hx, sizeof(hx), "%02x", (unsigned char)pChecksum[i]);
     env += hx;
   }
 }
@@ -281,12 +404,13 @@ void FileMD::serialize(Buffer& buffer)
   buffer.putData(&pContainerId, sizeof(pContainerId));
 
   // Symbolic links are serialized as <name>//<link>
-  std::string nameAndLink = pName;
+  std::string nameAndLink = pName.getName();
+  const char* link = pName.getLinkPtr();
 
-  if (pLinkName.length())
+  if (*link)
   {
     nameAndLink += "//";
-    nameAndLink += pLinkName;
+    nameAndLink += link;
   }
 
   uint16_t len = nameAndLink.length() + 1;
@@ -294,7 +418,7 @@ void FileMD::serialize(Buffer& buffer)
   buffer.putData(nameAndLink.c_str(), len);
   len = pLocation.size();
   buffer.putData(&len, sizeof(len));
-  LocationVector::iterator it;
+  const location_t* it;
 
   for (it = pLocation.begin(); it != pLocation.end(); ++it)
   {
@@ -314,18 +438,17 @@ void FileMD::serialize(Buffer& buffer)
   buffer.putData(&pCUid,      sizeof(pCUid));
   buffer.putData(&pCGid,      sizeof(pCGid));
   buffer.putData(&pLayoutId, sizeof(pLayoutId));
-  uint8_t size = pChecksum.getSize();
-  buffer.putData(&size, sizeof(size));
-  buffer.putData(pChecksum.getDataPtr(), size);
+  buffer.putData(&pChecksumLen, sizeof(pChecksumLen));
+  buffer.putData(pChecksum, pChecksumLen);
 
   // May store xattr
-  if (pXAttrs.size())
+  if (pXAttrs && pXAttrs->size())
   {
-    uint16_t len = pXAttrs.size();
+    uint16_t len = pXAttrs->size();
     buffer.putData( &len, sizeof( len ) );
     XAttrMap::iterator it;
 
-    for( it = pXAttrs.begin(); it != pXAttrs.end(); ++it )
+    for( it = pXAttrs->begin(); it != pXAttrs->end(); ++it )
     {
       uint16_t strLen = it->first.length()+1;
       buffer.putData( &strLen, sizeof( strLen ) );
@@ -357,18 +480,20 @@ void FileMD::deserialize(const Buffer& buffer)
   offset = buffer.grabData(offset, &len, 2);
   char strBuffer[len];
   offset = buffer.grabData(offset, strBuffer, len);
-  pName = strBuffer;
 
   // Possibly extract symbolic link
-  size_t link_pos = pName.find("//");
+  char* link_pos = strstr(strBuffer, "//");
 
-  if (link_pos != std::string::npos)
+  if (link_pos)
   {
-    pLinkName = pName.substr(link_pos+2);
-    pName.erase(link_pos);
+    *link_pos = 0;
+    pName.set(strBuffer, link_pos + 2);
   }
+  else
+    pName.set(strBuffer, "");
 
   offset = buffer.grabData(offset, &len, 2);
+  pLocation.reserve(len);
 
   for (uint16_t i = 0; i < len; ++i)
   {
@@ -378,6 +503,7 @@ void FileMD::deserialize(const Buffer& buffer)
   }
 
   offset = buffer.grabData(offset, &len, 2);
+  pUnlinkedLocation.reserve(len);
 
   for (uint16_t i = 0; i < len; ++i)
   {
@@ -391,8 +517,11 @@ void FileMD::deserialize(const Buffer& buffer)
   offset = buffer.grabData(offset, &pLayoutId, sizeof(pLayoutId));
   uint8_t size = 0;
   offset = buffer.grabData(offset, &size, sizeof(size));
-  pChecksum.resize(size);
-  offset = buffer.grabData(offset, pChecksum.getDataPtr(), size);
+
+  // Anything beyond the slot can not be a valid checksum, keep the prefix
+  pChecksumLen = (size > sChecksumSlotSize) ? sChecksumSlotSize : size;
+  offset = buffer.grabData(offset, pChecksum, pChecksumLen);
+  offset += size - pChecksumLen;
 
   if ((buffer.size() - offset) >= 4)
   {
@@ -410,7 +539,7 @@ void FileMD::deserialize(const Buffer& buffer)
       offset = buffer.grabData( offset, &len2, sizeof( len2 ) );
       char strBuffer2[len2];
       offset = buffer.grabData( offset, strBuffer2, len2 );
-      pXAttrs.insert( std::make_pair <char*, char*>( strBuffer1, strBuffer2 ) );
+      setAttribute(strBuffer1, strBuffer2);
     }
   }
 }
@@ -421,7 +550,7 @@ void FileMD::deserialize(const Buffer& buffer)
 IFileMD::LocationVector
 FileMD::getLocations() const
 {
-  return pLocation;
+  return pLocation.toVector();
 }
 
 //------------------------------------------------------------------------------
@@ -430,7 +559,46 @@ FileMD::getLocations() const
 IFileMD::LocationVector
 FileMD::getUnlinkedLocations() const
 {
-  return pUnlinkedLocation;
+  return pUnlinkedLocation.toVector();
+}
+
+//------------------------------------------------------------------------------
+// Get the number of bytes used by this object
+//------------------------------------------------------------------------------
+uint64_t
+FileMD::getMemorySize() const
+{
+  uint64_t total = mallocChunkSize(sizeof(FileMD));
+  total += mallocChunkSize(pName.getHeapSize());
+  total += mallocChunkSize(pLocation.getHeapSize());
+  total += mallocChunkSize(pUnlinkedLocation.getHeapSize());
+
+  if (pXAttrs)
+  {
+    total += mallocChunkSize(sizeof(XAttrMap));
+    total += xattrNodesHeapSize(*pXAttrs);
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+// Estimate the number of bytes used with the previous layout
+//------------------------------------------------------------------------------
+uint64_t
+FileMD::getLegacyMemorySize() const
+{
+  uint64_t total = mallocChunkSize(sizeof(LegacyFileMDLayout));
+  total += stringHeapSize(strlen(pName.getName()));
+  total += stringHeapSize(strlen(pName.getLinkPtr()));
+  total += locationVectorHeapSize(pLocation.size());
+  total += locationVectorHeapSize(pUnlinkedLocation.size());
+  total += mallocChunkSize(pChecksumLen);
+
+  if (pXAttrs)
+    total += xattrNodesHeapSize(*pXAttrs);
+
+  return total;
 }
 
 //------------------------------------------------------------------------------
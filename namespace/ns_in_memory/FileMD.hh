@@ -26,8 +26,11 @@
 
 #include "namespace/interface/IFileMD.hh"
 #include "namespace/interface/IFileMDSvc.hh"
+#include "namespace/utils/InlineVector.hh"
+#include "namespace/utils/CompactName.hh"
 #include <stdint.h>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 #include <sys/time.h>
@@ -40,10 +43,22 @@ class IContainerMD;
 
 //------------------------------------------------------------------------------
 //! Class holding the metadata information concerning a single file
+//!
+//! The object is laid out to keep the per-file memory footprint low: name and
+//! link share one small-string buffer, up to two (unlinked) locations are
+//! stored inline, the checksum lives in a fixed-size slot large enough for
+//! any checksum type a layout id can describe and the extended attributes map
+//! is only allocated when the first attribute is set.
 //------------------------------------------------------------------------------
 class FileMD: public IFileMD
 {
  public:
+  //----------------------------------------------------------------------------
+  //! Size of the checksum slot - the longest checksum (SHA1) a layout id can
+  //! describe
+  //----------------------------------------------------------------------------
+  static const uint8_t sChecksumSlotSize = 20;
+
   //----------------------------------------------------------------------------
   //! Constructor
   //----------------------------------------------------------------------------
@@ -174,11 +189,11 @@ class FileMD: public IFileMD
 
   //----------------------------------------------------------------------------
   //! Get checksum
+  //!
+  //! The returned buffer is a copy of the checksum slot, callers looking at
+  //! several bytes should get it once
   //----------------------------------------------------------------------------
-  const Buffer& getChecksum() const
-  {
-    return pChecksum;
-  }
+  Buffer getChecksum() const;
 
   //----------------------------------------------------------------------------
   //! Compare checksums
@@ -187,7 +202,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   bool checksumMatch(const void* checksum) const
   {
-    return !memcmp(checksum, pChecksum.getDataPtr(), pChecksum.getSize());
+    return !memcmp(checksum, pChecksum, pChecksumLen);
   }
 
   //----------------------------------------------------------------------------
@@ -195,38 +210,28 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   void setChecksum(const Buffer& checksum)
   {
-    pChecksum = checksum;
+    setChecksum(checksum.getDataPtr(), checksum.getSize());
   }
 
   //----------------------------------------------------------------------------
-  //! Clear checksum
+  //! Clear checksum - appends size zero bytes to the current checksum
   //----------------------------------------------------------------------------
-  void clearChecksum(uint8_t size = 20)
-  {
-    char zero = 0;
-
-    for (uint8_t i = 0; i < size; i++)
-      pChecksum.putData(&zero, 1);
-  }
+  void clearChecksum(uint8_t size = 20);
 
   //----------------------------------------------------------------------------
   //! Set checksum
   //!
   //! @param checksum address of a memory location string the checksum
-  //! @param size     size of the checksum in bytes
+  //! @param size     size of the checksum in bytes, at most sChecksumSlotSize
   //----------------------------------------------------------------------------
-  void setChecksum(const void* checksum, uint8_t size)
-  {
-    pChecksum.clear();
-    pChecksum.putData(checksum, size);
-  }
+  void setChecksum(const void* checksum, uint8_t size);
 
   //----------------------------------------------------------------------------
   //! Get name
   //----------------------------------------------------------------------------
   const std::string getName() const
   {
-    return pName;
+    return pName.getName();
   }
 
   //----------------------------------------------------------------------------
@@ -234,7 +239,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   void setName(const std::string& name)
   {
-    pName = name;
+    pName.setName(name);
   }
 
   //----------------------------------------------------------------------------
@@ -301,7 +306,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   bool hasUnlinkedLocation(location_t location)
   {
-    for (unsigned int i = 0; i < pUnlinkedLocation.size(); i++)
+    for (size_t i = 0; i < pUnlinkedLocation.size(); i++)
     {
       if (pUnlinkedLocation[i] == location)
         return true;
@@ -331,7 +336,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   bool hasLocation(location_t location)
   {
-    for (unsigned int i = 0; i < pLocation.size(); i++)
+    for (size_t i = 0; i < pLocation.size(); i++)
     {
       if (pLocation[i] == location)
         return true;
@@ -467,7 +472,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   std::string getLink() const
   {
-    return pLinkName;
+    return pName.getLinkPtr();
   }
 
   //----------------------------------------------------------------------------
@@ -475,7 +480,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   void setLink(std::string link_name)
   {
-    pLinkName = link_name;
+    pName.setLink(link_name);
   }
 
   //----------------------------------------------------------------------------
@@ -483,7 +488,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   bool isLink() const
   {
-    return pLinkName.length() ? true:false;
+    return *pName.getLinkPtr() ? true:false;
   }
 
   //----------------------------------------------------------------------------
@@ -491,7 +496,10 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   void setAttribute (const std::string &name, const std::string &value)
   {
-    pXAttrs[name] = value;
+    if (!pXAttrs)
+      pXAttrs.reset(new XAttrMap());
+
+    (*pXAttrs)[name] = value;
   }
 
   //----------------------------------------------------------------------------
@@ -499,10 +507,16 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   void removeAttribute (const std::string &name)
   {
-    XAttrMap::iterator it = pXAttrs.find(name);
+    if (!pXAttrs)
+      return;
+
+    XAttrMap::iterator it = pXAttrs->find(name);
+
+    if (it != pXAttrs->end())
+      pXAttrs->erase(it);
 
-    if (it != pXAttrs.end())
-      pXAttrs.erase(it);
+    if (pXAttrs->empty())
+      pXAttrs.reset();
   }
 
   //----------------------------------------------------------------------------
@@ -510,7 +524,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   bool hasAttribute (const std::string &name) const
   {
-    return pXAttrs.find(name) != pXAttrs.end();
+    return pXAttrs && (pXAttrs->find(name) != pXAttrs->end());
   }
 
   //----------------------------------------------------------------------------
@@ -518,7 +532,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   size_t numAttributes () const
   {
-    return pXAttrs.size();
+    return pXAttrs ? pXAttrs->size() : 0;
   }
 
   //----------------------------------------------------------------------------
@@ -526,15 +540,17 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   std::string getAttribute (const std::string &name) const
   {
-    XAttrMap::const_iterator it = pXAttrs.find(name);
-
-    if (it == pXAttrs.end())
+    if (pXAttrs)
     {
-      MDException e(ENOENT);
-      e.getMessage() << "Attribute: " << name << " not found";
-      throw e;
+      XAttrMap::const_iterator it = pXAttrs->find(name);
+
+      if (it != pXAttrs->end())
+        return it->second;
     }
-    return it->second;
+
+    MDException e(ENOENT);
+    e.getMessage() << "Attribute: " << name << " not found";
+    throw e;
   }
 
   //----------------------------------------------------------------------------
@@ -542,7 +558,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   XAttrMap::iterator attributesBegin()
   {
-    return pXAttrs.begin();
+    return pXAttrs ? pXAttrs->begin() : sNoXAttrs.begin();
   }
 
   //----------------------------------------------------------------------------
@@ -550,10 +566,24 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   XAttrMap::iterator attributesEnd()
   {
-    return pXAttrs.end();
+    return pXAttrs ? pXAttrs->end() : sNoXAttrs.end();
   }
 
+  //----------------------------------------------------------------------------
+  //! Get the number of bytes used by this object including the heap
+  //! allocations it owns
+  //----------------------------------------------------------------------------
+  uint64_t getMemorySize() const;
+
+  //----------------------------------------------------------------------------
+  //! Estimate the number of bytes the same metadata used to take with the
+  //! previous std::string/std::vector/Buffer based layout
+  //----------------------------------------------------------------------------
+  uint64_t getLegacyMemorySize() const;
+
  protected:
+  typedef InlineVector<location_t, 2> LocationArray;
+
   //----------------------------------------------------------------------------
   // Data members
   //----------------------------------------------------------------------------
@@ -562,17 +592,19 @@ class FileMD: public IFileMD
   ctime_t             pMTime;
   uint64_t            pSize;
   IContainerMD::id_t  pContainerId;
+  IFileMDSvc*         pFileMDSvc;
+  std::unique_ptr<XAttrMap> pXAttrs; ///< allocated on first use
+  LocationArray       pLocation;
+  LocationArray       pUnlinkedLocation;
+  CompactName         pName;         ///< name and symbolic link
   uid_t               pCUid;
   gid_t               pCGid;
   layoutId_t          pLayoutId;
   uint16_t            pFlags;
-  std::string         pName;
-  std::string         pLinkName;
-  LocationVector      pLocation;
-  LocationVector      pUnlinkedLocation;
-  Buffer              pChecksum;
-  XAttrMap            pXAttrs;
-  IFileMDSvc*         pFileMDSvc;
+  uint8_t             pChecksumLen;
+  char                pChecksum[sChecksumSlotSize];
+
+  static XAttrMap     sNoXAttrs; ///< always empty, for attribute iterators
 };
 
 EOSNSNAMESPACE_END
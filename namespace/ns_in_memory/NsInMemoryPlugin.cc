@@ -18,6 +18,7 @@
 
 /*----------------------------------------------------------------------------*/
 #include <iostream>
+#include <cstdlib>
 /*----------------------------------------------------------------------------*/
 #include "namespace/interface/IContainerMDSvc.hh"
 #include "namespace/ns_in_memory/NsInMemoryPlugin.hh"
@@ -212,7 +213,14 @@ NsInMemoryPlugin::CreateContAcc(PF_PlatformServices* services)
   if (!pContMDSvc)
     return 0;
 
-  return static_cast<void*>(new ContainerAccounting(pContMDSvc));
+  // Interval in ms between two propagations of the tree size changes, the
+  // ancestors are updated synchronously by default
+  int32_t interval = 0;
+
+  if (getenv("EOS_NS_ACCOUNTING_INTERVAL"))
+    interval = atoi(getenv("EOS_NS_ACCOUNTING_INTERVAL"));
+
+  return static_cast<void*>(new ContainerAccounting(pContMDSvc, interval));
 }
 
 //------------------------------------------------------------------------------
@@ -18,15 +18,51 @@
 
 #include "namespace/ns_in_memory/accounting/ContainerAccounting.hh"
 #include <iostream>
+#include <chrono>
 
 EOSNSNAMESPACE_BEGIN
 
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
-ContainerAccounting::ContainerAccounting(IContainerMDSvc* svc) :
-    pContainerMDSvc(svc)
+ContainerAccounting::ContainerAccounting(IContainerMDSvc* svc,
+                                         int32_t update_interval) :
+    pContainerMDSvc(svc), pUpdateInterval(update_interval), pPending(nullptr),
+    pNsLock(nullptr), pStop(false), pNumCycles(0), pNumQueued(0),
+    pNumApplied(0), pNumCoalesced(0), pLastCoalesced(0)
 {
+  if (pUpdateInterval < 0)
+    pUpdateInterval = 0;
+
+  if (pUpdateInterval)
+    pThread = std::thread(&ContainerAccounting::PropagateThread, this);
+}
+
+//----------------------------------------------------------------------------
+// Destructor
+//----------------------------------------------------------------------------
+ContainerAccounting::~ContainerAccounting()
+{
+  if (pThread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(pThreadMutex);
+      pStop = true;
+    }
+
+    pThreadCond.notify_one();
+    pThread.join();
+  }
+
+  // The containers may already be gone, just free the queued updates
+  PendingUpdate* update = pPending.exchange(nullptr);
+
+  while (update)
+  {
+    PendingUpdate* next = update->mNext;
+    delete update;
+    update = next;
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -69,12 +105,72 @@ void ContainerAccounting::fileMDChanged(IFileMDChangeListener::Event* e)
 //------------------------------------------------------------------------------
 void ContainerAccounting::Account(IFileMD* obj , int64_t dsize)
 {
-  size_t deepness = 0;
-
   if (!obj)
     return;
 
-  ContainerMD::id_t iId = obj->getContainerId();
+  Propagate(obj->getContainerId(), dsize);
+}
+
+//------------------------------------------------------------------------------
+// Add tree
+//------------------------------------------------------------------------------
+void ContainerAccounting::AddTree( IContainerMD* obj , int64_t dsize )
+{
+  if (!obj) {
+    return;
+  }
+
+  // The subtree is about to move, the queued updates have to be propagated
+  // along the current ancestors and this one too
+  if (pUpdateInterval)
+    ApplyPending();
+
+  UpdateAncestors(obj->getId(), dsize);
+}
+
+//------------------------------------------------------------------------------
+//! Remove tree
+//------------------------------------------------------------------------------
+void ContainerAccounting::RemoveTree( IContainerMD* obj , int64_t dsize )
+{
+  AddTree(obj, -dsize);
+}
+
+//------------------------------------------------------------------------------
+// Update the tree size of a container and its ancestors or queue the update
+//------------------------------------------------------------------------------
+void ContainerAccounting::Propagate(IContainerMD::id_t id, int64_t dsize)
+{
+  // Files are created empty, nothing to propagate
+  if (!dsize)
+    return;
+
+  if (pUpdateInterval)
+  {
+    PendingUpdate* update = new PendingUpdate();
+    update->mId = id;
+    update->mDelta = dsize;
+    update->mNext = pPending.load(std::memory_order_relaxed);
+
+    while (!pPending.compare_exchange_weak(update->mNext, update,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {}
+
+    pNumQueued++;
+    return;
+  }
+
+  UpdateAncestors(id, dsize);
+}
+
+//------------------------------------------------------------------------------
+// Update the tree size of a container and all of its ancestors
+//------------------------------------------------------------------------------
+void ContainerAccounting::UpdateAncestors(IContainerMD::id_t id, int64_t dsize)
+{
+  size_t deepness = 0;
+  IContainerMD::id_t iId = id;
+  std::lock_guard<std::mutex> lock(pMutex);
 
   while ((iId > 1) && (deepness < 255))
   {
@@ -98,42 +194,162 @@ void ContainerAccounting::Account(IFileMD* obj , int64_t dsize)
 }
 
 //------------------------------------------------------------------------------
-// Add tree
+// Apply all the queued updates
 //------------------------------------------------------------------------------
-void ContainerAccounting::AddTree( IContainerMD* obj , int64_t dsize )
+void ContainerAccounting::ApplyPending()
 {
-  size_t deepness = 0;
+  if (!pPending.load(std::memory_order_relaxed))
+    return;
 
-  if (!obj) {
+  std::lock_guard<std::mutex> lock(pMutex);
+  PendingUpdate* update = pPending.exchange(nullptr, std::memory_order_acquire);
+
+  if (!update)
     return;
+
+  // Sum up the changes per container where the propagation starts
+  std::map<IContainerMD::id_t, std::pair<int64_t, uint64_t>> starts;
+
+  while (update)
+  {
+    std::pair<int64_t, uint64_t>& start = starts[update->mId];
+    start.first += update->mDelta;
+    start.second++;
+    PendingUpdate* next = update->mNext;
+    delete update;
+    update = next;
   }
 
-  ContainerMD::id_t iId = obj->getId();
+  // Sum up the changes per ancestor, looking up every container only once
+  std::map<IContainerMD::id_t, std::shared_ptr<IContainerMD>> conts;
+  std::map<IContainerMD::id_t, int64_t> deltas;
+  uint64_t unbatched = 0;
 
-  while ( (iId > 1 ) && (deepness < 255) )
+  for (auto it = starts.begin(); it != starts.end(); ++it)
   {
-    std::shared_ptr<IContainerMD> iCont;
-    try
+    size_t deepness = 0;
+    IContainerMD::id_t iId = it->first;
+
+    while ((iId > 1) && (deepness < 255))
     {
-      iCont = pContainerMDSvc->getContainerMD(iId);
+      auto cit = conts.find(iId);
+
+      if (cit == conts.end())
+      {
+        std::shared_ptr<IContainerMD> iCont;
+
+        try
+        {
+          iCont = pContainerMDSvc->getContainerMD(iId);
+        }
+        catch (MDException& e)
+        {
+        }
+
+        cit = conts.insert(std::make_pair(iId, iCont)).first;
+      }
+
+      if (!cit->second)
+        break;
+
+      deltas[iId] += it->second.first;
+      unbatched += it->second.second;
+      iId = cit->second->getParentId();
+      deepness++;
     }
-    catch( MDException &e ) {}
+  }
 
-    if (!iCont)
-      return;
+  uint64_t applied = 0;
 
-    iCont->addTreeSize(dsize);
-    iId = iCont->getParentId();
-    deepness++;
+  for (auto it = deltas.begin(); it != deltas.end(); ++it)
+  {
+    if (it->second)
+    {
+      conts[it->first]->addTreeSize(it->second);
+      applied++;
+    }
   }
+
+  pNumCycles++;
+  pNumApplied += applied;
+  pNumCoalesced += unbatched - applied;
+  pLastCoalesced = unbatched - applied;
 }
 
 //------------------------------------------------------------------------------
-//! Remove tree
+// Propagate the queued updates now
 //------------------------------------------------------------------------------
-void ContainerAccounting::RemoveTree( IContainerMD* obj , int64_t dsize )
+void ContainerAccounting::flushPendingUpdates()
 {
-  AddTree(obj, -dsize);
+  ApplyPending();
+}
+
+//------------------------------------------------------------------------------
+// Set the namespace lock
+//------------------------------------------------------------------------------
+void ContainerAccounting::setNamespaceLock(LockHandler* ns_lock)
+{
+  std::lock_guard<std::mutex> lock(pThreadMutex);
+
+  // The namespace goes away, never propagate again
+  if (pNsLock && !ns_lock)
+    pStop = true;
+
+  pNsLock = ns_lock;
+}
+
+//------------------------------------------------------------------------------
+// Get the accounting statistics
+//------------------------------------------------------------------------------
+void ContainerAccounting::getStats(std::map<std::string, uint64_t>& stats)
+{
+  stats["interval"] = pUpdateInterval;
+  stats["cycles"] = pNumCycles;
+  stats["queued"] = pNumQueued;
+  stats["applied"] = pNumApplied;
+  stats["coalesced"] = pNumCoalesced;
+  stats["last_coalesced"] = pLastCoalesced;
+}
+
+//------------------------------------------------------------------------------
+// Background thread propagating the queued updates
+//------------------------------------------------------------------------------
+void ContainerAccounting::PropagateThread()
+{
+  std::unique_lock<std::mutex> lock(pThreadMutex);
+
+  while (!pStop)
+  {
+    pThreadCond.wait_for(lock, std::chrono::milliseconds(pUpdateInterval));
+
+    if (pStop)
+      break;
+
+    if (!pPending.load())
+      continue;
+
+    LockHandler* ns_lock = pNsLock;
+
+    if (ns_lock)
+    {
+      // Don't hold the thread mutex while waiting, the owner of the namespace
+      // lock may want to detach us
+      lock.unlock();
+      ns_lock->readLock();
+      lock.lock();
+
+      if (pStop || (pNsLock != ns_lock))
+      {
+        ns_lock->unLock();
+        continue;
+      }
+    }
+
+    ApplyPending();
+
+    if (ns_lock)
+      ns_lock->unLock();
+  }
 }
 
 EOSNSNAMESPACE_END
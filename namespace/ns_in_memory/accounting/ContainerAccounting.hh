@@ -30,14 +30,26 @@
 #include "namespace/ns_in_memory/FileMD.hh"
 #include "namespace/MDException.hh"
 #include "namespace/Namespace.hh"
+#include "namespace/utils/Locking.hh"
 #include <utility>
 #include <list>
 #include <deque>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 
 EOSNSNAMESPACE_BEGIN
 
 //------------------------------------------------------------------------------
 //! Container subtree accounting listener
+//!
+//! With an update interval the size changes are only queued by the writers
+//! and a background thread propagates them every interval. Changes of the
+//! same container are summed up and every ancestor is updated once per cycle,
+//! so the tree size of a container lags behind by at most one interval
+//! unless flushPendingUpdates is called.
 //------------------------------------------------------------------------------
 class ContainerAccounting : public IFileMDChangeListener
 {
@@ -45,13 +57,17 @@ class ContainerAccounting : public IFileMDChangeListener
 
   //----------------------------------------------------------------------------
   //! Constructor
+  //!
+  //! @param svc container MD service
+  //! @param update_interval interval in milliseconds between two propagations
+  //!        of the queued updates, 0 updates the ancestors synchronously
   //----------------------------------------------------------------------------
-  ContainerAccounting(IContainerMDSvc* svc);
+  ContainerAccounting(IContainerMDSvc* svc, int32_t update_interval = 0);
 
   //----------------------------------------------------------------------------
-  //! Destructor
+  //! Destructor - the updates still queued are dropped
   //----------------------------------------------------------------------------
-  virtual ~ContainerAccounting() {}
+  virtual ~ContainerAccounting();
 
   //----------------------------------------------------------------------------
   //! Notify me about the changes in the main view
@@ -83,9 +99,76 @@ class ContainerAccounting : public IFileMDChangeListener
   //----------------------------------------------------------------------------
   void RemoveTree( IContainerMD* obj , int64_t dsize );
 
+  //----------------------------------------------------------------------------
+  //! Propagate the queued updates now, the caller must hold the namespace
+  //! lock at least in read mode
+  //----------------------------------------------------------------------------
+  virtual void flushPendingUpdates();
+
+  //----------------------------------------------------------------------------
+  //! Set the namespace lock taken in read mode by the background thread.
+  //! Resetting it to null detaches the thread from the namespace for good: the
+  //! caller has to hold the namespace lock in write mode and destroy this
+  //! object only after releasing it, as the thread may be waiting for it.
+  //----------------------------------------------------------------------------
+  virtual void setNamespaceLock(LockHandler* ns_lock);
+
+  //----------------------------------------------------------------------------
+  //! Get the accounting statistics: interval (ms), cycles, queued, applied,
+  //! coalesced and last_coalesced (during the last cycle)
+  //----------------------------------------------------------------------------
+  virtual void getStats(std::map<std::string, uint64_t>& stats);
+
  private:
 
+  //! Size change to propagate from a container up to the root
+  struct PendingUpdate {
+    IContainerMD::id_t mId; ///< first container to update
+    int64_t mDelta; ///< size change
+    PendingUpdate* mNext;
+  };
+
   IContainerMDSvc* pContainerMDSvc; ///< container MD service
+  std::mutex pMutex; ///< serializes the updates of the ancestors' tree size
+  int32_t pUpdateInterval; ///< propagation interval in ms, 0 if synchronous
+  std::atomic<PendingUpdate*> pPending; ///< lock-free stack of queued updates
+  LockHandler* pNsLock; ///< namespace lock, protected by pThreadMutex
+  std::thread pThread; ///< background propagation thread
+  std::mutex pThreadMutex; ///< held by the thread while propagating
+  std::condition_variable pThreadCond; ///< condition used to stop the thread
+  bool pStop; ///< thread stop flag, protected by pThreadMutex
+  std::atomic<uint64_t> pNumCycles; ///< propagation cycles done
+  std::atomic<uint64_t> pNumQueued; ///< updates queued
+  std::atomic<uint64_t> pNumApplied; ///< tree size updates applied
+  std::atomic<uint64_t> pNumCoalesced; ///< tree size updates saved
+  std::atomic<uint64_t> pLastCoalesced; ///< updates saved in the last cycle
+
+  //----------------------------------------------------------------------------
+  //! Update the tree size of a container and all of its ancestors or queue
+  //! the update if propagating in the background
+  //!
+  //! @param id first container to update
+  //! @param dsize size change
+  //----------------------------------------------------------------------------
+  void Propagate(IContainerMD::id_t id, int64_t dsize);
+
+  //----------------------------------------------------------------------------
+  //! Update the tree size of a container and all of its ancestors now
+  //!
+  //! @param id first container to update
+  //! @param dsize size change
+  //----------------------------------------------------------------------------
+  void UpdateAncestors(IContainerMD::id_t id, int64_t dsize);
+
+  //----------------------------------------------------------------------------
+  //! Apply all the queued updates, every ancestor is updated once
+  //----------------------------------------------------------------------------
+  void ApplyPending();
+
+  //----------------------------------------------------------------------------
+  //! Background thread propagating the queued updates every interval
+  //----------------------------------------------------------------------------
+  void PropagateThread();
 
   //----------------------------------------------------------------------------
   //! Account a file in the respective container
@@ -22,7 +22,10 @@
 //------------------------------------------------------------------------------
 
 #include "namespace/ns_in_memory/accounting/FileSystemView.hh"
+#include <algorithm>
 #include <iostream>
+#include <random>
+#include <unordered_set>
 
 EOSNSNAMESPACE_BEGIN
 
@@ -192,6 +195,95 @@ FileSystemView::FileList FileSystemView::getUnlinkedFileList(
   return pUnlinkedFiles[location];
 }
 
+//----------------------------------------------------------------------------
+// Get a cursor over the files on a file system
+//----------------------------------------------------------------------------
+IFsView::FileListCursor
+FileSystemView::getFileListCursor(IFileMD::location_t location)
+{
+  if (pFiles.size() <= location) {
+    return std::make_shared<FileListIterator>(nullptr);
+  }
+
+  return std::make_shared<FileListIterator>(&pFiles[location]);
+}
+
+//----------------------------------------------------------------------------
+// Get number of files on a file system
+//----------------------------------------------------------------------------
+uint64_t
+FileSystemView::getNumFilesOnFs(IFileMD::location_t location)
+{
+  if (pFiles.size() <= location) {
+    return 0;
+  }
+
+  return pFiles[location].size();
+}
+
+//----------------------------------------------------------------------------
+// Check if a file has a replica on a file system
+//----------------------------------------------------------------------------
+bool
+FileSystemView::hasFileId(IFileMD::id_t fid, IFileMD::location_t location)
+{
+  if (pFiles.size() <= location) {
+    return false;
+  }
+
+  return (pFiles[location].count(fid) != 0);
+}
+
+//----------------------------------------------------------------------------
+// Get a random sample of distinct files on a file system. Random buckets of
+// the hash table are probed, moving forward past the empty ones, so that the
+// cost is independent of the number of files.
+//----------------------------------------------------------------------------
+std::vector<IFileMD::id_t>
+FileSystemView::getRandomFiles(IFileMD::location_t location, size_t num_files)
+{
+  static thread_local std::mt19937_64 gen(std::random_device {}());
+  std::vector<IFileMD::id_t> sample;
+  if ((pFiles.size() <= location) || !num_files) {
+    return sample;
+  }
+
+  const FileList& files = pFiles[location];
+
+  // For large samples rejection of duplicates gets expensive, just shuffle
+  if (2 * num_files >= files.size()) {
+    sample.assign(files.begin(), files.end());
+    std::shuffle(sample.begin(), sample.end(), gen);
+
+    if (sample.size() > num_files) {
+      sample.resize(num_files);
+    }
+
+    return sample;
+  }
+
+  size_t nbuckets = files.bucket_count();
+  std::uniform_int_distribution<size_t> dist(0, nbuckets - 1);
+  std::unordered_set<IFileMD::id_t> chosen;
+  sample.reserve(num_files);
+
+  while (sample.size() < num_files) {
+    size_t bucket = dist(gen);
+
+    while (!files.bucket_size(bucket)) {
+      bucket = (bucket + 1) % nbuckets;
+    }
+
+    IFileMD::id_t fid = *files.begin(bucket);
+
+    if (chosen.insert(fid).second) {
+      sample.push_back(fid);
+    }
+  }
+
+  return sample;
+}
+
 //------------------------------------------------------------------------------
 // Clear unlinked files for filesystem
 //------------------------------------------------------------------------------
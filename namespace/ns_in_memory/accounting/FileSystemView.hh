@@ -31,6 +31,44 @@
 
 EOSNSNAMESPACE_BEGIN
 
+//------------------------------------------------------------------------------
+//! Cursor iterating directly over a file list of the view
+//------------------------------------------------------------------------------
+class FileListIterator: public ICollectionIterator<IFileMD::id_t>
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param list file list to iterate over, can be null for no files
+  //----------------------------------------------------------------------------
+  FileListIterator(const IFsView::FileList* list): pList(list)
+  {
+    if (pList) {
+      pIt = pList->begin();
+    }
+  }
+
+  bool valid()
+  {
+    return (pList && (pIt != pList->end()));
+  }
+
+  void next()
+  {
+    ++pIt;
+  }
+
+  IFileMD::id_t getElement()
+  {
+    return *pIt;
+  }
+
+private:
+  const IFsView::FileList* pList;
+  IFsView::FileList::const_iterator pIt;
+};
+
 //------------------------------------------------------------------------------
 // File System view implementation of a in-memeory namespace
 //------------------------------------------------------------------------------
@@ -93,6 +131,36 @@ public:
   //----------------------------------------------------------------------------
   bool clearUnlinkedFileList(IFileMD::location_t location);
 
+  //----------------------------------------------------------------------------
+  //! Get a cursor over the files on a file system without copying the list.
+  //! The caller must keep replica changes out while using it.
+  //----------------------------------------------------------------------------
+  FileListCursor getFileListCursor(IFileMD::location_t location);
+
+  //----------------------------------------------------------------------------
+  //! Get a cursor over the files without replicas
+  //----------------------------------------------------------------------------
+  FileListCursor getNoReplicasFileListCursor()
+  {
+    return std::make_shared<FileListIterator>(&pNoReplicas);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get number of files on a file system
+  //----------------------------------------------------------------------------
+  uint64_t getNumFilesOnFs(IFileMD::location_t location);
+
+  //----------------------------------------------------------------------------
+  //! Check if a file has a replica on a file system
+  //----------------------------------------------------------------------------
+  bool hasFileId(IFileMD::id_t fid, IFileMD::location_t location);
+
+  //----------------------------------------------------------------------------
+  //! Get a random sample of distinct files on a file system
+  //----------------------------------------------------------------------------
+  std::vector<IFileMD::id_t>
+  getRandomFiles(IFileMD::location_t location, size_t num_files);
+
   //----------------------------------------------------------------------------
   //! Get number of file systems
   //----------------------------------------------------------------------------
@@ -105,6 +105,12 @@ public:
   {
     pContSvc->getSlaveLock()->writeLock();
     ChangeLogContainerMDSvc::IdMap* idMap = &pContSvc->pIdMap;
+
+    // Propagate the queued tree size changes before the hierarchy changes
+    if (pContainerAccounting) {
+      pContainerAccounting->flushPendingUpdates();
+    }
+
     //----------------------------------------------------------------------
     // Handle deletions
     //----------------------------------------------------------------------
@@ -812,6 +818,11 @@ void ChangeLogContainerMDSvc::removeContainer(IContainerMD::id_t containerId)
     throw e;
   }
 
+  // The queued tree size changes can't be propagated without the container
+  if (pContainerAccounting) {
+    pContainerAccounting->flushPendingUpdates();
+  }
+
   // Store the file in the changelog and notify the listener
   eos::Buffer buffer;
   buffer.putData(&containerId, sizeof(IContainerMD::id_t));
@@ -32,6 +32,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
+#include <sys/mman.h>
 #ifdef __linux__
 #include <sys/inotify.h>
 #endif
@@ -43,6 +44,8 @@
 #include <iomanip>
 #include <stdio.h>
 #include <fcntl.h>
+#include <atomic>
+#include <thread>
 
 #define CHANGELOG_MAGIC 0x45434847
 #define RECORD_MAGIC    0x4552
@@ -78,6 +81,69 @@ static uint32_t checkHeader(int fd, const std::string& name)
   return flags;
 }
 
+//----------------------------------------------------------------------------
+// Check the record located at the given offset of a memory mapped log -
+// returns the full length of the record (header, data and trailing
+// checksum) or 0 if there is no valid record at this position
+//----------------------------------------------------------------------------
+static uint64_t checkMappedRecord(const char* map, uint64_t offset,
+                                  uint64_t end)
+{
+  if (offset + 24 > end) {
+    return 0;
+  }
+
+  const char* hdr = map + offset;
+  uint16_t magic;
+  uint16_t size;
+  uint32_t chkSum1;
+  uint32_t chkSum2;
+  memcpy(&magic, hdr, 2);
+  memcpy(&size, hdr + 2, 2);
+  memcpy(&chkSum1, hdr + 4, 4);
+
+  if (magic != RECORD_MAGIC || offset + 24 + size > end) {
+    return 0;
+  }
+
+  memcpy(&chkSum2, hdr + 20 + size, 4);
+
+  if (chkSum1 != chkSum2) {
+    return 0;
+  }
+
+  uint32_t crc = DataHelper::computeCRC32((void*)(hdr + 8), 8);
+  crc = DataHelper::updateCRC32(crc, (void*)(hdr + 16), 4); // opts
+  crc = DataHelper::updateCRC32(crc, (void*)(hdr + 20), size);
+
+  if (crc != chkSum1) {
+    return 0;
+  }
+
+  return 24 + size;
+}
+
+//----------------------------------------------------------------------------
+// Find the first record boundary at or after the given offset of a memory
+// mapped log. A position is accepted if it holds a valid record followed
+// either by the end of the file or by another valid record - returns end
+// if no such position exists.
+//----------------------------------------------------------------------------
+static uint64_t findMappedBoundary(const char* map, uint64_t offset,
+                                   uint64_t end)
+{
+  for (; offset + 24 <= end; offset += 4) {
+    uint64_t len = checkMappedRecord(map, offset, end);
+
+    if (len && ((offset + len == end) ||
+                checkMappedRecord(map, offset + len, end))) {
+      return offset;
+    }
+  }
+
+  return end;
+}
+
 //---------------------------------------------------------------------------
 // Open the log file
 //----------------------------------------------------------------------------
@@ -613,6 +679,151 @@ uint64_t ChangeLogFile::scanAllRecordsAtOffset(ILogRecordScanner* scanner,
   return offset;
 }
 
+//----------------------------------------------------------------------------
+// Scan all the records in parallel using a memory map of the file
+//----------------------------------------------------------------------------
+uint64_t ChangeLogFile::scanAllRecordsParallel(
+  std::vector<ILogRecordScanner*>& scanners, uint64_t startOffset)
+{
+  if (!pIsOpen) {
+    MDException ex(EFAULT);
+    ex.getMessage() << "ParallelScan: Changelog file is not open";
+    throw ex;
+  }
+
+  if (scanners.empty()) {
+    MDException ex(EINVAL);
+    ex.getMessage() << "ParallelScan: No scanners given";
+    throw ex;
+  }
+
+  off_t end = ::lseek(pFd, 0, SEEK_END);
+
+  if (end == -1) {
+    MDException ex(EFAULT);
+    ex.getMessage() << "ParallelScan: Unable to find the end of the log file: ";
+    ex.getMessage() << strerror(errno);
+    throw ex;
+  }
+
+  if ((uint64_t)end <= startOffset) {
+    return startOffset;
+  }
+
+  void* map = mmap(0, end, PROT_READ, MAP_SHARED, pFd, 0);
+
+  if (map == MAP_FAILED) {
+    MDException ex(errno);
+    ex.getMessage() << "ParallelScan: Unable to map the log file: ";
+    ex.getMessage() << strerror(errno);
+    throw ex;
+  }
+
+  (void) madvise(map, end, MADV_SEQUENTIAL);
+  const char* data = (const char*) map;
+  time_t start_time = time(0);
+  std::string fname = pFileName;
+  fname.erase(0, pFileName.rfind("/") + 1);
+  //--------------------------------------------------------------------------
+  // Find the segment boundaries - each thread resynchronizes on the first
+  // valid record after its nominal start offset. Records are always 4-byte
+  // aligned.
+  //--------------------------------------------------------------------------
+  size_t nseg = scanners.size();
+  uint64_t span = end - startOffset;
+  std::vector<uint64_t> bounds(nseg + 1);
+  std::vector<std::thread> workers;
+  bounds[0] = startOffset;
+  bounds[nseg] = end;
+
+  for (size_t i = 1; i < nseg; ++i) {
+    workers.push_back(std::thread([ &, i]() {
+      uint64_t offset = startOffset + (span / nseg) * i;
+      offset -= (offset - startOffset) % 4;
+      bounds[i] = findMappedBoundary(data, offset, end);
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  workers.clear();
+
+  for (size_t i = nseg - 1; i > 0; --i) {
+    if (bounds[i] > bounds[i + 1]) {
+      bounds[i] = bounds[i + 1];
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Scan the segments - every segment has to end exactly where the next one
+  // starts, otherwise one of the boundaries was a false positive
+  //--------------------------------------------------------------------------
+  std::atomic<bool> failed(false);
+  std::vector<uint64_t> failedOffset(nseg, 0);
+
+  for (size_t i = 0; i < nseg; ++i) {
+    workers.push_back(std::thread([ &, i]() {
+      Buffer record;
+      uint64_t offset = bounds[i];
+
+      try {
+        while (offset < bounds[i + 1]) {
+          if (failed) {
+            return;
+          }
+
+          uint64_t len = checkMappedRecord(data, offset, end);
+
+          if (!len) {
+            break;
+          }
+
+          record.resize(len - 24);
+
+          if (len > 24) {
+            memcpy(record.getDataPtr(), data + offset + 20, len - 24);
+          }
+
+          scanners[i]->processRecord(offset, data[offset + 16], record);
+          offset += len;
+        }
+      } catch (MDException& e) {}
+
+      if (offset != bounds[i + 1]) {
+        failedOffset[i] = offset;
+        failed = true;
+      }
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  munmap(map, end);
+
+  if (failed) {
+    for (size_t i = 0; i < nseg; ++i) {
+      if (failedOffset[i]) {
+        char msg[4096];
+        snprintf(msg, 4096, "error: parallel scan stopped at offset %llx\n",
+                 (long long)failedOffset[i]);
+        addWarningMessage(msg);
+        MDException ex(EIO);
+        ex.getMessage() << "ParallelScan: Unable to scan the record at offset 0x";
+        ex.getMessage() << std::setbase(16) << failedOffset[i];
+        throw ex;
+      }
+    }
+  }
+
+  fprintf(stderr, "ALERT    [ %-64s ] finished in %ds using %u threads\n",
+          fname.c_str(), (int)(time(0) - start_time), (unsigned int)nseg);
+  return end;
+}
+
 //----------------------------------------------------------------------------
 // Follow a file
 //----------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #define EOS_NS_CHANGE_LOG_FILE_HH
 
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include <ctime>
 #include <pthread.h>
@@ -208,6 +209,26 @@ public:
                                   uint64_t           startOffset,
                                   bool               autorepair = false);
 
+  //------------------------------------------------------------------------
+  //! Scan all the records in the changelog file using a read-only memory
+  //! map and one thread per scanner. The file is split into record-aligned
+  //! segments of similar size, scanners[i] receives the records of the i-th
+  //! segment in increasing offset order, so the caller can merge the results
+  //! in scanner order to get the last-writer-wins view of the log. Scanners
+  //! are not expected to stop early.
+  //!
+  //! If any segment contains an invalid record the whole scan is abandoned
+  //! and an exception is thrown - the caller should then discard the
+  //! partial results and fall back to the sequential scan which handles
+  //! broken records.
+  //!
+  //! @param scanners    one scanner per segment
+  //! @param startOffset offset to start at
+  //! @return offset of the record following the last scanned record
+  //------------------------------------------------------------------------
+  uint64_t scanAllRecordsParallel(std::vector<ILogRecordScanner*>& scanners,
+                                  uint64_t startOffset);
+
   //------------------------------------------------------------------------
   //! Follow the new records in a file starting at a given offset and
   //! ignore incomplete records at the end
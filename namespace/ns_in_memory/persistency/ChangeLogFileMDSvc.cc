@@ -29,11 +29,14 @@
 #include "namespace/utils/Locking.hh"
 #include "namespace/utils/ThreadUtils.hh"
 #include "namespace/ns_in_memory/FileMD.hh"
+#include "namespace/ns_in_memory/ContainerMD.hh"
 #include "namespace/ns_in_memory/persistency/ChangeLogContainerMDSvc.hh"
 
 #include <algorithm>
 #include <utility>
 #include <set>
+#include <chrono>
+#include <thread>
 
 //------------------------------------------------------------------------------
 // Follower
@@ -694,7 +697,11 @@ void ChangeLogFileMDSvc::initialize()
   bool logIsCompacted = (pChangeLog->getUserFlags() & LOG_FLAG_COMPACTED);
   pFollowStart = pChangeLog->getFirstOffset();
 
-  if (!pSlaveMode || logIsCompacted) {
+  // The parallel boot is only used in master mode, the slave needs to stop
+  // at the compaction mark
+  bool loaded = (!pSlaveMode && (pBootThreads > 1) && initializeParallel());
+
+  if (!loaded && (!pSlaveMode || logIsCompacted)) {
     FileMDScanner scanner(pIdMap, pSlaveMode);
     pFollowStart = pChangeLog->scanAllRecords(&scanner);
     pFirstFreeId = scanner.getLargestId() + 1;
@@ -751,6 +758,185 @@ void ChangeLogFileMDSvc::initialize()
   }
 }
 
+//------------------------------------------------------------------------------
+// Load the change log in parallel
+//------------------------------------------------------------------------------
+bool ChangeLogFileMDSvc::initializeParallel()
+{
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point t0 = Clock::now();
+  // Scan the log segments in parallel - each scanner keeps the latest
+  // record per file id within its segment
+  std::vector<std::unique_ptr<FileMDSegmentScanner>> segments;
+  std::vector<ILogRecordScanner*> scanners;
+
+  for (uint32_t i = 0; i < pBootThreads; ++i) {
+    segments.emplace_back(new FileMDSegmentScanner());
+    scanners.push_back(segments.back().get());
+  }
+
+  try {
+    pFollowStart = pChangeLog->scanAllRecordsParallel(scanners,
+                   pChangeLog->getFirstOffset());
+  } catch (MDException& e) {
+    fprintf(stderr, "ALERT    [ %-64s ] parallel scan failed, falling back to "
+            "sequential scan: %s\n", "boot", e.getMessage().str().c_str());
+    return false;
+  }
+
+  Clock::time_point t1 = Clock::now();
+  // Merge the segments in log order - the last writer wins
+  uint64_t largestId = 0;
+
+  for (auto& segment : segments) {
+    SegmentMap& records = segment->getRecords();
+
+    for (SegmentMap::iterator itR = records.begin(); itR != records.end();
+         ++itR) {
+      if (!itR->second.buffer) {
+        IdMap::iterator it = pIdMap.find(itR->first);
+
+        if (it != pIdMap.end()) {
+          delete it->second.buffer;
+          pIdMap.erase(it);
+        }
+
+        continue;
+      }
+
+      DataInfo& d = pIdMap[itR->first];
+      delete d.buffer;
+      d.logOffset = itR->second.logOffset;
+      d.buffer = itR->second.buffer;
+      itR->second.buffer = 0;
+    }
+
+    largestId = std::max(largestId, segment->getLargestId());
+    segment.reset();
+  }
+
+  pFirstFreeId = largestId + 1;
+  Clock::time_point t2 = Clock::now();
+  // Unpack the serialized buffers and shard the files by container id so
+  // that every container is only modified by one thread
+  std::vector<IdMap::value_type*> entries;
+  entries.reserve(pIdMap.size());
+
+  for (IdMap::iterator it = pIdMap.begin(); it != pIdMap.end(); ++it) {
+    entries.push_back(&(*it));
+  }
+
+  uint32_t nthreads = pBootThreads;
+  std::vector<std::vector<std::vector<IFileMD*>>> shards(nthreads,
+      std::vector<std::vector<IFileMD*>>(nthreads));
+  std::vector<std::thread> workers;
+
+  for (uint32_t t = 0; t < nthreads; ++t) {
+    workers.push_back(std::thread([&, t]() {
+      size_t begin = entries.size() * t / nthreads;
+      size_t end = entries.size() * (t + 1) / nthreads;
+
+      for (size_t i = begin; i < end; ++i) {
+        DataInfo& d = entries[i]->second;
+        std::shared_ptr<IFileMD> file = std::make_shared<FileMD>(0, this);
+        file->deserialize(*d.buffer);
+        d.ptr = file;
+        delete d.buffer;
+        d.buffer = 0;
+
+        if (file->getContainerId()) {
+          shards[t][file->getContainerId() % nthreads].push_back(file.get());
+        }
+      }
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  workers.clear();
+  Clock::time_point t3 = Clock::now();
+  // Attach the files to their containers, one shard per thread. The
+  // fileMDRead listeners only look at the file replicas so they are notified
+  // from this thread in the meantime.
+  std::vector<std::vector<IFileMD*>> attached(nthreads);
+  std::vector<std::vector<IFileMD*>> orphans(nthreads);
+  std::vector<std::vector<IFileMD*>> conflicts(nthreads);
+
+  for (uint32_t s = 0; s < nthreads; ++s) {
+    workers.push_back(std::thread([&, s]() {
+      for (uint32_t t = 0; t < nthreads; ++t) {
+        for (IFileMD* file : shards[t][s]) {
+          std::shared_ptr<IContainerMD> cont;
+
+          try {
+            cont = pContSvc->getContainerMD(file->getContainerId());
+          } catch (MDException& e) {}
+
+          if (!cont) {
+            orphans[s].push_back(file);
+          } else if (static_cast<ContainerMD*>(cont.get())->addFileNoNotify(file)) {
+            attached[s].push_back(file);
+          } else {
+            conflicts[s].push_back(file);
+          }
+        }
+
+        std::vector<IFileMD*>().swap(shards[t][s]);
+      }
+    }));
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    for (ListenerList::iterator it = pListeners.begin(); it != pListeners.end();
+         ++it) {
+      (*it)->fileMDRead(entries[i]->second.ptr.get());
+    }
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  Clock::time_point t4 = Clock::now();
+  // Replay the size change events of the attached files and handle the
+  // broken ones sequentially
+  uint64_t nattached = 0;
+  uint64_t nbroken = 0;
+
+  for (uint32_t s = 0; s < nthreads; ++s) {
+    for (IFileMD* file : attached[s]) {
+      IFileMDChangeListener::Event e(file, IFileMDChangeListener::SizeChange,
+                                     0, 0, file->getSize());
+      notifyListeners(&e);
+    }
+
+    nattached += attached[s].size();
+    nbroken += orphans[s].size() + conflicts[s].size();
+
+    for (IFileMD* file : orphans[s]) {
+      attachBroken("orphans", file);
+    }
+
+    for (IFileMD* file : conflicts[s]) {
+      attachBroken("name_conflicts", file);
+    }
+  }
+
+  Clock::time_point t5 = Clock::now();
+  auto secs = [](Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+  };
+  fprintf(stderr, "ALERT    [ %-64s ] threads=%u files=%llu attached=%llu "
+          "broken=%llu scan=%.02fs merge=%.02fs unpack=%.02fs attach=%.02fs "
+          "notify=%.02fs total=%.02fs\n", "boot", nthreads,
+          (unsigned long long)pIdMap.size(), (unsigned long long)nattached,
+          (unsigned long long)nbroken, secs(t0, t1), secs(t1, t2),
+          secs(t2, t3), secs(t3, t4), secs(t4, t5), secs(t0, t5));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 // Make a transition from slave to master
 //------------------------------------------------------------------------------
@@ -872,6 +1058,12 @@ void ChangeLogFileMDSvc::configure(
   if (it != config.end()) {
     pResSize = strtoull(it->second.c_str(), 0, 10);
   }
+
+  it = config.find("boot_threads");
+
+  if (it != config.end()) {
+    pBootThreads = strtoul(it->second.c_str(), 0, 10);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -1069,6 +1261,50 @@ bool ChangeLogFileMDSvc::FileMDScanner::processRecord(uint64_t      offset,
   return true;
 }
 
+//------------------------------------------------------------------------------
+// Segment scanner destructor - free the records not merged into the id map
+//------------------------------------------------------------------------------
+ChangeLogFileMDSvc::FileMDSegmentScanner::~FileMDSegmentScanner()
+{
+  for (SegmentMap::iterator it = pRecords.begin(); it != pRecords.end(); ++it) {
+    delete it->second.buffer;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Process the records of one segment of the parallel scan
+//------------------------------------------------------------------------------
+bool ChangeLogFileMDSvc::FileMDSegmentScanner::processRecord(uint64_t offset,
+    char          type,
+    const Buffer& buffer)
+{
+  if (type != UPDATE_RECORD_MAGIC && type != DELETE_RECORD_MAGIC) {
+    return true;
+  }
+
+  IFileMD::id_t id;
+  buffer.grabData(0, &id, sizeof(IFileMD::id_t));
+  SegmentRecord& r = pRecords[id];
+  r.logOffset = offset;
+
+  if (type == UPDATE_RECORD_MAGIC) {
+    if (!r.buffer) {
+      r.buffer = new Buffer();
+    }
+
+    (*r.buffer) = buffer;
+  } else {
+    delete r.buffer;
+    r.buffer = 0;
+  }
+
+  if (pLargestId < id) {
+    pLargestId = id;
+  }
+
+  return true;
+}
+
 //------------------------------------------------------------------------------
 // Prepare for online compacting.
 //------------------------------------------------------------------------------
@@ -1325,6 +1561,34 @@ ChangeLogFileMDSvc::setContMDService(IContainerMDSvc* cont_svc)
   pContSvc = dynamic_cast<eos::ChangeLogContainerMDSvc*>(cont_svc);
 }
 
+//------------------------------------------------------------------------------
+// Get memory accounting information about the file metadata
+//------------------------------------------------------------------------------
+void
+ChangeLogFileMDSvc::getMemoryStats(std::map<std::string, uint64_t>& stats)
+{
+  uint64_t files = 0;
+  uint64_t compact = 0;
+  uint64_t legacy = 0;
+
+  for (auto it = pIdMap.begin(); it != pIdMap.end(); ++it)
+  {
+    FileMD* file = dynamic_cast<FileMD*>(it->second.ptr.get());
+
+    if (!file)
+      continue;
+
+    ++files;
+    compact += file->getMemorySize();
+    legacy += file->getLegacyMemorySize();
+  }
+
+  stats["files"] = files;
+  stats["filemd_bytes"] = compact;
+  stats["filemd_legacy_bytes"] = legacy;
+  stats["idmap_bytes"] = pIdMap.bucket_count() * sizeof(IdMap::value_type);
+}
+
 //------------------------------------------------------------------------------
 // Set the QuotaStats object for the follower
 //------------------------------------------------------------------------------
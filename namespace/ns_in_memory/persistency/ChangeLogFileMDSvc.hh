@@ -55,7 +55,8 @@ public:
   ChangeLogFileMDSvc():
     pFirstFreeId(1), pChangeLog(0), pSlaveLock(0),
     pSlaveMode(false), pSlaveStarted(false), pSlavePoll(1000),
-    pFollowStart(0), pContSvc(0), pQuotaStats(0), pAutoRepair(0), pResSize(1000000)
+    pFollowStart(0), pContSvc(0), pQuotaStats(0), pAutoRepair(0), pResSize(1000000),
+    pBootThreads(0)
   {
     pIdMap.set_deleted_key(0);
     pIdMap.set_empty_key(std::numeric_limits<IFileMD::id_t>::max());
@@ -303,6 +304,11 @@ public:
     pIdMap.resize(0);
   }
 
+  //----------------------------------------------------------------------------
+  //! Get memory accounting information about the file metadata
+  //----------------------------------------------------------------------------
+  void getMemoryStats(std::map<std::string, uint64_t>& stats);
+
 private:
   //----------------------------------------------------------------------------
   // Placeholder for the record info
@@ -345,6 +351,54 @@ private:
     bool      pSlaveMode;
   };
 
+  //----------------------------------------------------------------------------
+  // Record found by the parallel scan, a null buffer marks a deletion
+  //----------------------------------------------------------------------------
+  struct SegmentRecord {
+    SegmentRecord(): logOffset(0), buffer(0) {}
+    uint64_t logOffset;
+    Buffer*  buffer;
+  };
+
+  typedef google::dense_hash_map<IFileMD::id_t, SegmentRecord> SegmentMap;
+
+  //----------------------------------------------------------------------------
+  // Changelog record scanner for one segment of the parallel scan, it keeps
+  // the latest record of every file id seen in its segment
+  //----------------------------------------------------------------------------
+  class FileMDSegmentScanner: public ILogRecordScanner
+  {
+  public:
+    FileMDSegmentScanner(): pLargestId(0)
+    {
+      pRecords.set_deleted_key(0);
+      pRecords.set_empty_key(std::numeric_limits<IFileMD::id_t>::max());
+    }
+    virtual ~FileMDSegmentScanner();
+    virtual bool processRecord(uint64_t offset, char type,
+                               const Buffer& buffer);
+    SegmentMap& getRecords()
+    {
+      return pRecords;
+    }
+    uint64_t getLargestId() const
+    {
+      return pLargestId;
+    }
+  private:
+    SegmentMap pRecords;
+    uint64_t   pLargestId;
+  };
+
+  //----------------------------------------------------------------------------
+  // Load the change log using the parallel scan and attach the files to
+  // their containers using a pool of pBootThreads threads
+  //
+  // @return false if the log could not be scanned in parallel, the id map is
+  //         left empty in this case
+  //----------------------------------------------------------------------------
+  bool initializeParallel();
+
   //----------------------------------------------------------------------------
   // Attach a broken file to lost+found
   //----------------------------------------------------------------------------
@@ -369,6 +423,7 @@ private:
   IQuotaStats*       pQuotaStats;
   bool               pAutoRepair;
   uint64_t           pResSize;
+  uint32_t           pBootThreads; ///< 0 or 1 means sequential boot
 };
 
 EOSNSNAMESPACE_END
@@ -38,9 +38,11 @@ class ChangeLogFileMDSvcTest: public CppUnit::TestCase
   public:
     CPPUNIT_TEST_SUITE( ChangeLogFileMDSvcTest );
     CPPUNIT_TEST( reloadTest );
+    CPPUNIT_TEST( compactFileMDTest );
     CPPUNIT_TEST_SUITE_END();
 
     void reloadTest();
+    void compactFileMDTest();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ChangeLogFileMDSvcTest );
@@ -115,3 +117,94 @@ void ChangeLogFileMDSvcTest::reloadTest()
   delete fileSvc;
   unlink( fileName.c_str() );
 }
+
+//------------------------------------------------------------------------------
+// Check that the compact file metadata survives a reload
+//------------------------------------------------------------------------------
+void ChangeLogFileMDSvcTest::compactFileMDTest()
+{
+  eos::ChangeLogContainerMDSvc *contSvc = new eos::ChangeLogContainerMDSvc;
+  eos::ChangeLogFileMDSvc      *fileSvc = new eos::ChangeLogFileMDSvc;
+  fileSvc->setContMDService( contSvc );
+
+  std::map<std::string, std::string> config;
+  std::string fileName = getTempName( "/tmp", "eosns" );
+  config["changelog_path"] = fileName;
+  fileSvc->configure( config );
+  CPPUNIT_ASSERT_NO_THROW( fileSvc->initialize() );
+
+  std::string longName( "a_file_name_too_long_to_be_stored_inline" );
+  std::string longLink( "/eos/some/directory/deep/down/the/tree/target" );
+  char checksum[20];
+
+  for( int i = 0; i < 20; ++i )
+    checksum[i] = i + 1;
+
+  std::shared_ptr<eos::IFileMD> file1 = fileSvc->createFile();
+  std::shared_ptr<eos::IFileMD> file2 = fileSvc->createFile();
+  std::shared_ptr<eos::IFileMD> file3 = fileSvc->createFile();
+  file1->setName( "f1" );
+  file1->addLocation( 1 );
+  file1->setChecksum( checksum, 4 );
+  file2->setName( longName );
+  file2->setLink( longLink );
+  file3->setName( "f3" );
+  file3->setLink( "l3" );
+  file3->setChecksum( checksum, 20 );
+  file3->setAttribute( "user.key", "value" );
+
+  for( eos::IFileMD::location_t loc = 1; loc <= 5; ++loc )
+    file3->addLocation( loc );
+
+  file3->unlinkLocation( 2 );
+  file3->unlinkLocation( 4 );
+  CPPUNIT_ASSERT_THROW( file1->setChecksum( checksum, 21 ), eos::MDException );
+
+  eos::IFileMD::id_t id1 = file1->getId();
+  eos::IFileMD::id_t id2 = file2->getId();
+  eos::IFileMD::id_t id3 = file3->getId();
+  fileSvc->updateStore( file1.get() );
+  fileSvc->updateStore( file2.get() );
+  fileSvc->updateStore( file3.get() );
+
+  std::map<std::string, uint64_t> stats;
+  fileSvc->getMemoryStats( stats );
+  CPPUNIT_ASSERT( stats["files"] == 3 );
+  CPPUNIT_ASSERT( stats["filemd_bytes"] < stats["filemd_legacy_bytes"] );
+  fileSvc->finalize();
+
+  CPPUNIT_ASSERT_NO_THROW( fileSvc->initialize() );
+  std::shared_ptr<eos::IFileMD> fileRec1 = fileSvc->getFileMD( id1 );
+  std::shared_ptr<eos::IFileMD> fileRec2 = fileSvc->getFileMD( id2 );
+  std::shared_ptr<eos::IFileMD> fileRec3 = fileSvc->getFileMD( id3 );
+
+  CPPUNIT_ASSERT( fileRec1->getName() == "f1" );
+  CPPUNIT_ASSERT( !fileRec1->isLink() );
+  CPPUNIT_ASSERT( fileRec1->getNumLocation() == 1 );
+  CPPUNIT_ASSERT( fileRec1->getChecksum().getSize() == 4 );
+  CPPUNIT_ASSERT( fileRec1->checksumMatch( checksum ) );
+  CPPUNIT_ASSERT( fileRec1->numAttributes() == 0 );
+
+  CPPUNIT_ASSERT( fileRec2->getName() == longName );
+  CPPUNIT_ASSERT( fileRec2->getLink() == longLink );
+  CPPUNIT_ASSERT( fileRec2->getNumLocation() == 0 );
+  CPPUNIT_ASSERT( fileRec2->getChecksum().getSize() == 0 );
+
+  CPPUNIT_ASSERT( fileRec3->getName() == "f3" );
+  CPPUNIT_ASSERT( fileRec3->getLink() == "l3" );
+  CPPUNIT_ASSERT( fileRec3->getChecksum().getSize() == 20 );
+  CPPUNIT_ASSERT( fileRec3->checksumMatch( checksum ) );
+  CPPUNIT_ASSERT( fileRec3->getAttribute( "user.key" ) == "value" );
+
+  eos::IFileMD::LocationVector locs = fileRec3->getLocations();
+  eos::IFileMD::LocationVector unlinked = fileRec3->getUnlinkedLocations();
+  CPPUNIT_ASSERT( locs.size() == 3 );
+  CPPUNIT_ASSERT( locs[0] == 1 && locs[1] == 3 && locs[2] == 5 );
+  CPPUNIT_ASSERT( unlinked.size() == 2 );
+  CPPUNIT_ASSERT( unlinked[0] == 2 && unlinked[1] == 4 );
+
+  fileSvc->finalize();
+
+  delete fileSvc;
+  unlink( fileName.c_str() );
+}
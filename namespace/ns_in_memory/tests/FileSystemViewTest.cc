@@ -28,6 +28,7 @@
 #include <sstream>
 #include <cstdlib>
 #include <ctime>
+#include <set>
 
 #include "namespace/utils/TestHelpers.hh"
 #include "namespace/ns_in_memory/views/HierarchicalView.hh"
@@ -80,6 +81,44 @@ size_t countUnlinked( eos::FileSystemView *fs )
   return unlinked;
 }
 
+//------------------------------------------------------------------------------
+// Check the cursors, membership and sampling against the file lists
+//------------------------------------------------------------------------------
+void checkFileListAccess( eos::FileSystemView *fs )
+{
+  for( size_t i = 0; i < fs->getNumFileSystems() + 2; ++i )
+  {
+    eos::IFsView::FileList list;
+    if( i < fs->getNumFileSystems() )
+      list = fs->getFileList( i );
+    CPPUNIT_ASSERT( fs->getNumFilesOnFs( i ) == list.size() );
+
+    size_t count = 0;
+    for( auto it = fs->getFileListCursor( i ); it->valid(); it->next() )
+    {
+      CPPUNIT_ASSERT( list.count( it->getElement() ) );
+      CPPUNIT_ASSERT( fs->hasFileId( it->getElement(), i ) );
+      ++count;
+    }
+    CPPUNIT_ASSERT( count == list.size() );
+
+    for( size_t n : {(size_t)1, (size_t)10, list.size() + 1} )
+    {
+      std::vector<eos::IFileMD::id_t> sample = fs->getRandomFiles( i, n );
+      std::set<eos::IFileMD::id_t> distinct( sample.begin(), sample.end() );
+      CPPUNIT_ASSERT( sample.size() == std::min( n, list.size() ) );
+      CPPUNIT_ASSERT( distinct.size() == sample.size() );
+      for( auto fid : sample )
+        CPPUNIT_ASSERT( list.count( fid ) );
+    }
+  }
+
+  size_t noreplicas = 0;
+  for( auto it = fs->getNoReplicasFileListCursor(); it->valid(); it->next() )
+    ++noreplicas;
+  CPPUNIT_ASSERT( noreplicas == fs->getNoReplicasFileList().size() );
+}
+
 //------------------------------------------------------------------------------
 // Concrete implementation tests
 //------------------------------------------------------------------------------
@@ -159,6 +198,7 @@ void FileSystemViewTest::fileSystemViewTest()
     CPPUNIT_ASSERT( numUnlinked == 0 );
 
     CPPUNIT_ASSERT( fsView->getNoReplicasFileList().size() == 500 );
+    checkFileListAccess( fsView );
 
     //--------------------------------------------------------------------------
     // Unlinke replicas
@@ -196,6 +236,7 @@ void FileSystemViewTest::fileSystemViewTest()
 
     numUnlinked = countUnlinked( fsView );
     CPPUNIT_ASSERT( numUnlinked == 2800 );
+    checkFileListAccess( fsView );
 
     //--------------------------------------------------------------------------
     // Restart
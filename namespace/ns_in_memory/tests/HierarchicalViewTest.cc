@@ -35,6 +35,7 @@
 #include "namespace/interface/IContainerMD.hh"
 #include "namespace/ns_in_memory/views/HierarchicalView.hh"
 #include "namespace/ns_in_memory/accounting/QuotaStats.hh"
+#include "namespace/ns_in_memory/accounting/ContainerAccounting.hh"
 #include "namespace/ns_in_memory/persistency/ChangeLogContainerMDSvc.hh"
 #include "namespace/ns_in_memory/persistency/ChangeLogFileMDSvc.hh"
 
@@ -50,12 +51,16 @@ class HierarchicalViewTest: public CppUnit::TestCase
     CPPUNIT_TEST(quotaTest);
     CPPUNIT_TEST(lostContainerTest);
     CPPUNIT_TEST(onlineCompactingTest);
+    CPPUNIT_TEST(parallelBootTest);
+    CPPUNIT_TEST(treeSizeTest);
     CPPUNIT_TEST_SUITE_END();
 
     void reloadTest();
     void quotaTest();
     void lostContainerTest();
     void onlineCompactingTest();
+    void parallelBootTest();
+    void treeSizeTest();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(HierarchicalViewTest);
@@ -839,3 +844,192 @@ void HierarchicalViewTest::onlineCompactingTest()
   unlink(fileNameContMD.c_str());
   unlink(newFileLogName.c_str());
 }
+
+//------------------------------------------------------------------------------
+// Parallel boot test
+//------------------------------------------------------------------------------
+void HierarchicalViewTest::parallelBootTest()
+{
+  std::shared_ptr<eos::IContainerMDSvc> contSvc =
+    std::shared_ptr<eos::IContainerMDSvc>(new eos::ChangeLogContainerMDSvc());
+  std::shared_ptr<eos::IFileMDSvc> fileSvc =
+    std::shared_ptr<eos::IFileMDSvc>(new eos::ChangeLogFileMDSvc());
+  std::shared_ptr<eos::IView> view =
+    std::shared_ptr<eos::IView>(new eos::HierarchicalView());
+  fileSvc->setContMDService(contSvc.get());
+  contSvc->setFileMDService(fileSvc.get());
+  std::map<std::string, std::string> fileSettings;
+  std::map<std::string, std::string> contSettings;
+  std::map<std::string, std::string> settings;
+  std::string fileNameFileMD = getTempName("/tmp", "eosns");
+  std::string fileNameContMD = getTempName("/tmp", "eosns");
+  contSettings["changelog_path"] = fileNameContMD;
+  fileSettings["changelog_path"] = fileNameFileMD;
+  fileSvc->configure(fileSettings);
+  contSvc->configure(contSettings);
+  view->setContainerMDSvc(contSvc.get());
+  view->setFileMDSvc(fileSvc.get());
+  view->configure(settings);
+  CPPUNIT_ASSERT_NO_THROW(view->initialize());
+  //----------------------------------------------------------------------------
+  // Create, update, move and remove files so that the log contains several
+  // records per file id spread over the whole file
+  //----------------------------------------------------------------------------
+  std::map<std::string, uint64_t> expected;
+
+  for (int d = 0; d < 10; ++d) {
+    std::ostringstream dir;
+    dir << "/test/dir" << d << "/";
+    view->createContainer(dir.str(), true);
+
+    for (int i = 0; i < 500; ++i) {
+      std::ostringstream p;
+      p << dir.str() << "file" << i;
+      std::shared_ptr<eos::IFileMD> file = view->createFile(p.str());
+      file->setSize(i + 1);
+      view->updateFileStore(file.get());
+      expected[p.str()] = i + 1;
+    }
+  }
+
+  for (int d = 0; d < 10; ++d) {
+    for (int i = 0; i < 500; i += 7) {
+      std::ostringstream p;
+      p << "/test/dir" << d << "/file" << i;
+      std::shared_ptr<eos::IFileMD> file = view->getFile(p.str());
+
+      if (i % 2) {
+        view->removeFile(file.get());
+        expected.erase(p.str());
+      } else {
+        file->setSize(2 * i + 1);
+        view->updateFileStore(file.get());
+        expected[p.str()] = 2 * i + 1;
+      }
+    }
+  }
+
+  std::shared_ptr<eos::IFileMD> moved = view->getFile("/test/dir0/file1");
+  std::shared_ptr<eos::IContainerMD> src = view->getContainer("/test/dir0");
+  std::shared_ptr<eos::IContainerMD> dst = view->getContainer("/test/dir9");
+  src->removeFile(moved->getName());
+  moved->setName("moved");
+  dst->addFile(moved.get());
+  view->updateFileStore(moved.get());
+  expected.erase("/test/dir0/file1");
+  expected["/test/dir9/moved"] = 2;
+  view->finalize();
+  //----------------------------------------------------------------------------
+  // Reboot with a pool of threads and compare
+  //----------------------------------------------------------------------------
+  fileSettings["boot_threads"] = "4";
+  fileSvc->configure(fileSettings);
+  CPPUNIT_ASSERT_NO_THROW(view->initialize());
+  CPPUNIT_ASSERT(fileSvc->getNumFiles() == expected.size());
+
+  for (auto it = expected.begin(); it != expected.end(); ++it) {
+    std::shared_ptr<eos::IFileMD> file;
+    CPPUNIT_ASSERT_NO_THROW(file = view->getFile(it->first));
+    CPPUNIT_ASSERT(file->getSize() == it->second);
+  }
+
+  CPPUNIT_ASSERT(view->getContainer("/test/dir0")->getNumFiles() == 463);
+  CPPUNIT_ASSERT(view->getContainer("/test/dir9")->getNumFiles() == 465);
+  view->finalize();
+  unlink(fileNameFileMD.c_str());
+  unlink(fileNameContMD.c_str());
+}
+
+//------------------------------------------------------------------------------
+// Deferred tree size accounting test
+//------------------------------------------------------------------------------
+void HierarchicalViewTest::treeSizeTest()
+{
+  std::shared_ptr<eos::IContainerMDSvc> contSvc =
+    std::shared_ptr<eos::IContainerMDSvc>(new eos::ChangeLogContainerMDSvc());
+  std::shared_ptr<eos::IFileMDSvc> fileSvc =
+    std::shared_ptr<eos::IFileMDSvc>(new eos::ChangeLogFileMDSvc());
+  std::shared_ptr<eos::IView> view =
+    std::shared_ptr<eos::IView>(new eos::HierarchicalView());
+  fileSvc->setContMDService(contSvc.get());
+  contSvc->setFileMDService(fileSvc.get());
+  std::map<std::string, std::string> fileSettings;
+  std::map<std::string, std::string> contSettings;
+  std::map<std::string, std::string> settings;
+  std::string fileNameFileMD = getTempName("/tmp", "eosns");
+  std::string fileNameContMD = getTempName("/tmp", "eosns");
+  contSettings["changelog_path"] = fileNameContMD;
+  fileSettings["changelog_path"] = fileNameFileMD;
+  fileSvc->configure(fileSettings);
+  contSvc->configure(contSettings);
+  view->setContainerMDSvc(contSvc.get());
+  view->setFileMDSvc(fileSvc.get());
+  view->configure(settings);
+  CPPUNIT_ASSERT_NO_THROW(view->initialize());
+  //----------------------------------------------------------------------------
+  // Updates queued for an hour are only visible after a flush
+  //----------------------------------------------------------------------------
+  std::unique_ptr<eos::ContainerAccounting> accounting(
+    new eos::ContainerAccounting(contSvc.get(), 3600 * 1000));
+  fileSvc->addChangeListener(accounting.get());
+  contSvc->setContainerAccounting(accounting.get());
+  view->createContainer("/test/a/b", true);
+  view->createContainer("/test/a/c", true);
+
+  for (int i = 0; i < 100; ++i) {
+    std::ostringstream b, c;
+    b << "/test/a/b/file" << i;
+    c << "/test/a/c/file" << i;
+    view->createFile(b.str())->setSize(10);
+    view->createFile(c.str())->setSize(20);
+  }
+
+  std::shared_ptr<eos::IFileMD> file = view->getFile("/test/a/b/file0");
+  file->setSize(5);
+  CPPUNIT_ASSERT(view->getContainer("/test")->getTreeSize() == 0);
+  accounting->flushPendingUpdates();
+  CPPUNIT_ASSERT(view->getContainer("/test/a/b")->getTreeSize() == 995);
+  CPPUNIT_ASSERT(view->getContainer("/test/a/c")->getTreeSize() == 2000);
+  CPPUNIT_ASSERT(view->getContainer("/test/a")->getTreeSize() == 2995);
+  CPPUNIT_ASSERT(view->getContainer("/test")->getTreeSize() == 2995);
+  std::map<std::string, uint64_t> stats;
+  accounting->getStats(stats);
+  CPPUNIT_ASSERT(stats["queued"] == 201);
+  // 201 updates of 3 containers each against one update per container
+  CPPUNIT_ASSERT(stats["applied"] == 4);
+  CPPUNIT_ASSERT(stats["coalesced"] == 201 * 3 - 4);
+  //----------------------------------------------------------------------------
+  // Removing a container propagates the changes queued for it first
+  //----------------------------------------------------------------------------
+  for (int i = 0; i < 100; ++i) {
+    std::ostringstream c;
+    c << "/test/a/c/file" << i;
+    file = view->getFile(c.str());
+    file->setSize(0);
+    view->removeFile(file.get());
+  }
+
+  view->removeContainer("/test/a/c");
+  CPPUNIT_ASSERT(view->getContainer("/test")->getTreeSize() == 995);
+  //----------------------------------------------------------------------------
+  // With a short interval the background thread propagates the updates
+  //----------------------------------------------------------------------------
+  accounting->flushPendingUpdates();
+  std::unique_ptr<eos::ContainerAccounting> background(
+    new eos::ContainerAccounting(contSvc.get(), 10));
+  fileSvc->addChangeListener(background.get());
+  contSvc->setContainerAccounting(background.get());
+  // The first listener queues this one too, but is never flushed again
+  view->createFile("/test/a/b/late")->setSize(5);
+
+  for (int i = 0; (i < 500) &&
+       (view->getContainer("/test")->getTreeSize() != 1000); ++i) {
+    usleep(10000);
+  }
+
+  CPPUNIT_ASSERT(view->getContainer("/test")->getTreeSize() == 1000);
+  contSvc->setContainerAccounting(0);
+  view->finalize();
+  unlink(fileNameFileMD.c_str());
+  unlink(fileNameContMD.c_str());
+}
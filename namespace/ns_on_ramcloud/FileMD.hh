@@ -126,7 +126,7 @@ class FileMD: public IFileMD
   //----------------------------------------------------------------------------
   //! Get checksum
   //----------------------------------------------------------------------------
-  inline const Buffer& getChecksum() const
+  inline Buffer getChecksum() const
   {
     return pChecksum;
   }
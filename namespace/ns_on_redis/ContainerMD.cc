@@ -241,6 +241,22 @@ ContainerMD::findFile(const std::string& name)
   return file;
 }
 
+//------------------------------------------------------------------------------
+// Prefetch the files of the container
+//------------------------------------------------------------------------------
+void
+ContainerMD::prefetchFiles()
+{
+  std::vector<IFileMD::id_t> ids;
+  ids.reserve(mFilesMap.size());
+
+  for (auto && elem : mFilesMap) {
+    ids.push_back(elem.second);
+  }
+
+  pFileSvc->prefetchFileMD(ids);
+}
+
 //------------------------------------------------------------------------------
 // Add file
 //------------------------------------------------------------------------------
@@ -114,6 +114,11 @@ public:
   //----------------------------------------------------------------------------
   std::shared_ptr<IFileMD> findFile(const std::string& name);
 
+  //----------------------------------------------------------------------------
+  //! Load the metadata of all the files of the container in bulk
+  //----------------------------------------------------------------------------
+  void prefetchFiles();
+
   //----------------------------------------------------------------------------
   //! Get number of files
   //----------------------------------------------------------------------------
@@ -150,7 +150,7 @@ public:
   //----------------------------------------------------------------------------
   //! Get checksum
   //----------------------------------------------------------------------------
-  inline const Buffer&
+  inline Buffer
   getChecksum() const
   {
     return pChecksum;
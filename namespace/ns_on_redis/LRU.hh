@@ -19,19 +19,22 @@
 //------------------------------------------------------------------------------
 //! @author Elvin-Alin Sindrilaru <esindril@cern.ch>
 //! @brief LRU cache for namespace objects making sure we never evict an entry
-//!        which is still referenced in other parts of the program.
+//!        which is still referenced in other parts of the program. The cache
+//!        is split in shards, each with its own lock and CLOCK eviction.
 //------------------------------------------------------------------------------
 
 #ifndef __EOS_NS_REDIS_LRU_HH__
 #define __EOS_NS_REDIS_LRU_HH__
 
-#include "common/RWMutex.hh"
 #include "namespace/Namespace.hh"
+#include "namespace/utils/Locking.hh"
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <list>
-#include <map>
 #include <memory>
-#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 EOSNSNAMESPACE_BEGIN
 
@@ -62,6 +65,13 @@ struct hasGetId {
 
 //------------------------------------------------------------------------------
 //! LRU cache for namespace entries
+//!
+//! Entries are distributed by id hash over independent shards so that lookups
+//! of different entries don't serialize on one lock. Lookups only take the
+//! shard lock in read mode and mark the entry as referenced. Eviction uses
+//! the CLOCK approximation of LRU: the hand sweeps the shard and evicts the
+//! first entries neither referenced since the last sweep nor held anywhere
+//! else in the program.
 //------------------------------------------------------------------------------
 template <typename IdT, typename EntryT>
 class LRU {
@@ -70,8 +80,10 @@ public:
   //! Constructor
   //!
   //! @param maxSize maximum number of entries in the cache
+  //! @param num_shards number of shards, by default one per sMinShardSize
+  //!        entries up to sMaxShards
   //----------------------------------------------------------------------------
-  LRU(std::uint64_t maxSize);
+  LRU(std::uint64_t maxSize, std::uint32_t num_shards = 0);
 
   //----------------------------------------------------------------------------
   //! Destructor
@@ -115,25 +127,36 @@ public:
   //!
   //! @return cache size
   //----------------------------------------------------------------------------
-  inline std::uint64_t
-  size() const
-  {
-    eos::common::RWMutexWriteLock lock_w(mMutex);
-    return mMap.size();
-  }
+  std::uint64_t size() const;
 
   //----------------------------------------------------------------------------
   //! Set max size
   //!
   //! @param max_size new maximum number of entries
   //----------------------------------------------------------------------------
-  inline void
-  set_max_size(const std::uint64_t max_size)
+  void set_max_size(const std::uint64_t max_size);
+
+  //----------------------------------------------------------------------------
+  //! Counters
+  //----------------------------------------------------------------------------
+  std::uint64_t getNumHits() const;
+  std::uint64_t getNumMisses() const;
+  std::uint64_t getNumEvictions() const;
+
+  //----------------------------------------------------------------------------
+  //! Get number of shards
+  //----------------------------------------------------------------------------
+  inline std::uint32_t
+  getNumShards() const
   {
-    eos::common::RWMutexWriteLock lock_w(mMutex);
-    mMaxSize = max_size;
+    return mShards.size();
   }
 
+  //! Minimum number of entries per shard when sharding automatically
+  static constexpr std::uint64_t sMinShardSize = 4096;
+  //! Maximum number of shards when sharding automatically
+  static constexpr std::uint32_t sMaxShards = 64;
+
 private:
   //! Percentage at which the cache purging stops
   static constexpr double sPurgeStopRatio = 0.9;
@@ -144,30 +167,81 @@ private:
   LRU(LRU&& other) = delete;
   LRU& operator=(LRU&& other) = delete;
 
-  using ListT = std::list<std::shared_ptr<EntryT>>;
-  typename std::list<std::shared_ptr<EntryT>>::iterator ListIterT;
-  using MapT = std::map<IdT, decltype(ListIterT)>;
-  MapT mMap;   ///< Internal map pointing to obj in list
-  ListT mList; ///< Internal list of objects where new/used objects are at the
-               ///< end of the list
-  // TODO: in C++17 use std::shared_mutex
-  //! Mutext to protect access to the map and list which is set to blocking
-  // mutable eos::common::RWMutex mMutex;
-  mutable eos::common::RWMutex mMutex;
-  std::uint64_t mMaxSize; ///< Maximum number of entries
+  //! Cached object together with its reference bit
+  struct Node {
+    Node(IdT id, std::shared_ptr<EntryT>&& obj):
+      mId(id), mObj(std::move(obj)), mRef(false) {}
+
+    IdT mId;
+    std::shared_ptr<EntryT> mObj;
+    std::atomic<bool> mRef; ///< Set on access, cleared by the clock hand
+  };
+
+  using ListT = std::list<Node>;
+  using MapT = std::unordered_map<IdT, typename ListT::iterator>;
+
+  //! Independent part of the cache
+  struct Shard {
+    Shard(): mMaxSize(0), mHits(0), mMisses(0), mEvictions(0)
+    {
+      mHand = mList.end();
+    }
+
+    //--------------------------------------------------------------------------
+    //! Evict entries until the shard is below the purge stop ratio or no more
+    //! entries can be evicted. Must be called with the write lock held.
+    //--------------------------------------------------------------------------
+    void purge();
+
+    mutable SharedMutex mMutex; ///< Protects the map, list and hand
+    MapT mMap;   ///< Map pointing to the objects in the list
+    ListT mList; ///< Circular list of objects swept by the clock hand
+    typename ListT::iterator mHand; ///< Next object considered for eviction
+    std::uint64_t mMaxSize; ///< Maximum number of entries in the shard
+    std::atomic<std::uint64_t> mHits; ///< Lookups finding the entry
+    std::atomic<std::uint64_t> mMisses; ///< Lookups not finding the entry
+    std::atomic<std::uint64_t> mEvictions; ///< Entries evicted
+  };
+
+  //----------------------------------------------------------------------------
+  //! Get the shard responsible for the given id. Ids are mostly sequential so
+  //! they are spread with a multiplicative hash.
+  //----------------------------------------------------------------------------
+  inline Shard&
+  getShard(IdT id) const
+  {
+    std::uint64_t hash = std::hash<IdT>()(id);
+    return *mShards[((hash * 0x9E3779B97F4A7C15ULL) >> 32) % mShards.size()];
+  }
+
+  std::vector<std::unique_ptr<Shard>> mShards; ///< Shards of the cache
 };
 
-// Definition of class static member
+// Definition of class static members
 template <typename IdT, typename EntryT>
 constexpr double LRU<IdT, EntryT>::sPurgeStopRatio;
+template <typename IdT, typename EntryT>
+constexpr std::uint64_t LRU<IdT, EntryT>::sMinShardSize;
+template <typename IdT, typename EntryT>
+constexpr std::uint32_t LRU<IdT, EntryT>::sMaxShards;
 
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
 template <typename IdT, typename EntryT>
-LRU<IdT, EntryT>::LRU(std::uint64_t max_size) : mMutex(), mMaxSize(max_size)
+LRU<IdT, EntryT>::LRU(std::uint64_t max_size, std::uint32_t num_shards)
 {
-  mMutex.SetBlocking(true);
+  if (num_shards == 0) {
+    std::uint64_t auto_shards = max_size / sMinShardSize;
+    num_shards = (auto_shards > sMaxShards ? sMaxShards :
+                  (auto_shards ? auto_shards : 1));
+  }
+
+  for (std::uint32_t i = 0; i < num_shards; ++i) {
+    mShards.emplace_back(new Shard());
+  }
+
+  set_max_size(max_size);
 }
 
 //------------------------------------------------------------------------------
@@ -176,9 +250,12 @@ LRU<IdT, EntryT>::LRU(std::uint64_t max_size) : mMutex(), mMaxSize(max_size)
 template <typename IdT, typename EntryT>
 LRU<IdT, EntryT>::~LRU()
 {
-  eos::common::RWMutexWriteLock lock_w(mMutex);
-  mMap.clear();
-  mList.clear();
+  for (auto && shard : mShards) {
+    SharedMutexWriteLock lock_w(shard->mMutex);
+    shard->mMap.clear();
+    shard->mList.clear();
+    shard->mHand = shard->mList.end();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -188,17 +265,23 @@ template <typename IdT, typename EntryT>
 std::shared_ptr<EntryT>
 LRU<IdT, EntryT>::get(IdT id)
 {
-  eos::common::RWMutexWriteLock lock_w(mMutex);
-  auto iter_map = mMap.find(id);
+  Shard& shard = getShard(id);
+  SharedMutexReadLock lock_r(shard.mMutex);
+  auto iter_map = shard.mMap.find(id);
 
-  if (iter_map == mMap.end())
+  if (iter_map == shard.mMap.end()) {
+    shard.mMisses.fetch_add(1, std::memory_order_relaxed);
     return nullptr;
+  }
+
+  shard.mHits.fetch_add(1, std::memory_order_relaxed);
 
-  // Move object to the end of the list i.e. recently accessed
-  auto iter_new = mList.insert(mList.end(), *iter_map->second);
-  mList.erase(iter_map->second);
-  mMap[id] = iter_new;
-  return *iter_new;
+  // Mark as recently accessed, avoid dirtying the cache line if already set
+  if (!iter_map->second->mRef.load(std::memory_order_relaxed)) {
+    iter_map->second->mRef.store(true, std::memory_order_relaxed);
+  }
+
+  return iter_map->second->mObj;
 }
 
 //------------------------------------------------------------------------------
@@ -208,32 +291,24 @@ template <typename IdT, typename EntryT>
 typename std::enable_if<hasGetId<EntryT>::value, std::shared_ptr<EntryT>>::type
 LRU<IdT, EntryT>::put(IdT id, std::shared_ptr<EntryT> obj)
 {
-  eos::common::RWMutexWriteLock lock_w(mMutex);
-  auto iter_map = mMap.find(id);
-
-  if (iter_map != mMap.end())
-    return *(iter_map->second);
-
-  // Check if map full and purge some entries is necessary 10% of max size
-  if (mMap.size() >= mMaxSize) {
-    auto iter = mList.begin();
-
-    while ((iter != mList.end()) &&
-           (mMap.size() > sPurgeStopRatio * mMaxSize)) {
-      // If object is referenced also by someone else then skip it
-      if (iter->use_count() > 1) {
-        ++iter;
-        continue;
-      }
-
-      mMap.erase((*iter)->getId());
-      iter = mList.erase(iter);
-    }
+  Shard& shard = getShard(id);
+  SharedMutexWriteLock lock_w(shard.mMutex);
+  auto iter_map = shard.mMap.find(id);
+
+  if (iter_map != shard.mMap.end()) {
+    return iter_map->second->mObj;
+  }
+
+  // Check if shard full and purge some entries if necessary i.e. 10% of max
+  if (shard.mMap.size() >= shard.mMaxSize) {
+    shard.purge();
   }
 
-  auto iter = mList.insert(mList.end(), obj);
-  mMap.emplace(id, iter);
-  return *iter;
+  // Insert just behind the hand so that the new object is the last one to be
+  // considered for eviction
+  auto iter = shard.mList.emplace(shard.mHand, id, std::move(obj));
+  shard.mMap.emplace(id, iter);
+  return iter->mObj;
 }
 
 //------------------------------------------------------------------------------
@@ -243,17 +318,125 @@ template <typename IdT, typename EntryT>
 bool
 LRU<IdT, EntryT>::remove(IdT id)
 {
-  eos::common::RWMutexWriteLock lock_w(mMutex);
-  auto iter_map = mMap.find(id);
+  Shard& shard = getShard(id);
+  SharedMutexWriteLock lock_w(shard.mMutex);
+  auto iter_map = shard.mMap.find(id);
 
-  if (iter_map == mMap.end())
+  if (iter_map == shard.mMap.end()) {
     return false;
+  }
+
+  if (iter_map->second == shard.mHand) {
+    ++shard.mHand;
+  }
 
-  (void)mList.erase(iter_map->second);
-  mMap.erase(iter_map);
+  (void) shard.mList.erase(iter_map->second);
+  shard.mMap.erase(iter_map);
   return true;
 }
 
+//------------------------------------------------------------------------------
+// Get cache size
+//------------------------------------------------------------------------------
+template <typename IdT, typename EntryT>
+std::uint64_t
+LRU<IdT, EntryT>::size() const
+{
+  std::uint64_t total = 0;
+
+  for (auto && shard : mShards) {
+    SharedMutexReadLock lock_r(shard->mMutex);
+    total += shard->mMap.size();
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+// Set max size
+//------------------------------------------------------------------------------
+template <typename IdT, typename EntryT>
+void
+LRU<IdT, EntryT>::set_max_size(const std::uint64_t max_size)
+{
+  std::uint64_t shard_max = (max_size + mShards.size() - 1) / mShards.size();
+
+  for (auto && shard : mShards) {
+    SharedMutexWriteLock lock_w(shard->mMutex);
+    shard->mMaxSize = shard_max;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Counters
+//------------------------------------------------------------------------------
+template <typename IdT, typename EntryT>
+std::uint64_t
+LRU<IdT, EntryT>::getNumHits() const
+{
+  std::uint64_t total = 0;
+
+  for (auto && shard : mShards) {
+    total += shard->mHits.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+template <typename IdT, typename EntryT>
+std::uint64_t
+LRU<IdT, EntryT>::getNumMisses() const
+{
+  std::uint64_t total = 0;
+
+  for (auto && shard : mShards) {
+    total += shard->mMisses.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+template <typename IdT, typename EntryT>
+std::uint64_t
+LRU<IdT, EntryT>::getNumEvictions() const
+{
+  std::uint64_t total = 0;
+
+  for (auto && shard : mShards) {
+    total += shard->mEvictions.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+// Purge shard
+//------------------------------------------------------------------------------
+template <typename IdT, typename EntryT>
+void
+LRU<IdT, EntryT>::Shard::purge()
+{
+  // Two full sweeps: the first one may only clear the reference bits
+  std::uint64_t steps = 2 * mList.size();
+
+  while ((steps-- > 0) && (mMap.size() > sPurgeStopRatio * mMaxSize)) {
+    if (mHand == mList.end()) {
+      mHand = mList.begin();
+    }
+
+    // Skip objects accessed since the last sweep or referenced elsewhere
+    if (mHand->mRef.exchange(false, std::memory_order_relaxed) ||
+        (mHand->mObj.use_count() > 1)) {
+      ++mHand;
+      continue;
+    }
+
+    mMap.erase(mHand->mId);
+    mHand = mList.erase(mHand);
+    mEvictions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
 EOSNSNAMESPACE_END
 
 #endif // __EOS_NS_REDIS_LRU_HH__
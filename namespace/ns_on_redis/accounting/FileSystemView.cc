@@ -19,7 +19,9 @@
 #include "namespace/ns_on_redis/accounting/FileSystemView.hh"
 #include "namespace/ns_on_redis/Constants.hh"
 #include "namespace/ns_on_redis/FileMD.hh"
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 
 EOSNSNAMESPACE_BEGIN
 
@@ -312,6 +314,111 @@ FileSystemView::clearUnlinkedFileList(IFileMD::location_t location)
   return pRedox->del(key);
 }
 
+//------------------------------------------------------------------------------
+// Get a cursor over the files on a file system
+//------------------------------------------------------------------------------
+IFsView::FileListCursor
+FileSystemView::getFileListCursor(IFileMD::location_t location)
+{
+  std::string key = std::to_string(location) + fsview::sFilesSuffix;
+  return std::make_shared<FileListScanIterator>(*pRedox, key);
+}
+
+//------------------------------------------------------------------------------
+// Get a cursor over the files without replicas
+//------------------------------------------------------------------------------
+IFsView::FileListCursor
+FileSystemView::getNoReplicasFileListCursor()
+{
+  return std::make_shared<FileListScanIterator>(*pRedox,
+         fsview::sNoReplicaPrefix);
+}
+
+//------------------------------------------------------------------------------
+// Get number of files on a file system
+//------------------------------------------------------------------------------
+uint64_t
+FileSystemView::getNumFilesOnFs(IFileMD::location_t location)
+{
+  std::string key = std::to_string(location) + fsview::sFilesSuffix;
+  redox::RedoxSet fs_set(*pRedox, key);
+
+  try {
+    return (uint64_t) fs_set.scard();
+  } catch (std::runtime_error& e) {
+    return 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Check if a file has a replica on a file system
+//------------------------------------------------------------------------------
+bool
+FileSystemView::hasFileId(IFileMD::id_t fid, IFileMD::location_t location)
+{
+  std::string key = std::to_string(location) + fsview::sFilesSuffix;
+  redox::RedoxSet fs_set(*pRedox, key);
+
+  try {
+    return fs_set.sismember(fid);
+  } catch (std::runtime_error& e) {
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get a random sample of distinct files on a file system
+//------------------------------------------------------------------------------
+std::vector<IFileMD::id_t>
+FileSystemView::getRandomFiles(IFileMD::location_t location, size_t num_files)
+{
+  std::vector<IFileMD::id_t> sample;
+
+  if (!num_files) {
+    return sample;
+  }
+
+  std::string key = std::to_string(location) + fsview::sFilesSuffix;
+  std::vector<std::string> reply;
+  bool done = false;
+  std::mutex mutex;
+  std::condition_variable cond_var;
+
+  try {
+    // A positive count makes SRANDMEMBER return distinct members
+    pRedox->command<std::vector<std::string>>(
+      {"SRANDMEMBER", key, std::to_string(num_files)},
+    [&](redox::Command<std::vector<std::string>>& c) {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      if (c.ok()) {
+        reply = c.reply();
+      }
+
+      done = true;
+      cond_var.notify_one();
+    });
+  } catch (std::runtime_error& redis_err) {
+    return sample;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!done) {
+      cond_var.wait(lock);
+    }
+  }
+
+  sample.reserve(reply.size());
+
+  for (const auto& elem : reply) {
+    sample.push_back(std::stoull(elem));
+  }
+
+  return sample;
+}
+
 //------------------------------------------------------------------------------
 // Get number of file systems
 //------------------------------------------------------------------------------
@@ -349,4 +456,49 @@ FileSystemView::initialize(const std::map<std::string, std::string>& config)
   pFsIdsSet.setClient(*pRedox);
 }
 
+//------------------------------------------------------------------------------
+// FileListScanIterator constructor
+//------------------------------------------------------------------------------
+FileListScanIterator::FileListScanIterator(redox::Redox& redox,
+    const std::string& key, long long count):
+  pSet(redox, key), pCount(count), pCursor(0), pDone(false), pPos(0)
+{
+  fetch();
+}
+
+//------------------------------------------------------------------------------
+// Move to the next file id
+//------------------------------------------------------------------------------
+void
+FileListScanIterator::next()
+{
+  if (++pPos >= pBatch.size()) {
+    fetch();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Fetch batches until a non-empty one or the end of the scan
+//------------------------------------------------------------------------------
+void
+FileListScanIterator::fetch()
+{
+  pBatch.clear();
+  pPos = 0;
+  std::pair<long long, std::vector<std::string>> reply;
+
+  while (pBatch.empty() && !pDone) {
+    try {
+      reply = pSet.sscan(pCursor, pCount);
+    } catch (std::runtime_error& e) {
+      pDone = true;
+      break;
+    }
+
+    pCursor = reply.first;
+    pBatch = std::move(reply.second);
+    pDone = (pCursor == 0);
+  }
+}
+
 EOSNSNAMESPACE_END
@@ -32,6 +32,49 @@
 
 EOSNSNAMESPACE_BEGIN
 
+//------------------------------------------------------------------------------
+//! Cursor over a Redis set of file ids, fetching the ids in batches with SSCAN.
+//! Like SSCAN it can return an id more than once if the set is modified.
+//------------------------------------------------------------------------------
+class FileListScanIterator: public ICollectionIterator<IFileMD::id_t>
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param redox redox client
+  //! @param key key of the set
+  //! @param count number of ids fetched per round trip
+  //----------------------------------------------------------------------------
+  FileListScanIterator(redox::Redox& redox, const std::string& key,
+                       long long count = 10000);
+
+  bool valid()
+  {
+    return (pPos < pBatch.size());
+  }
+
+  void next();
+
+  IFileMD::id_t getElement()
+  {
+    return std::stoull(pBatch[pPos]);
+  }
+
+private:
+  //----------------------------------------------------------------------------
+  //! Fetch batches until a non-empty one or the end of the scan
+  //----------------------------------------------------------------------------
+  void fetch();
+
+  redox::RedoxSet pSet; ///< Set iterated over
+  long long pCount; ///< Ids fetched per round trip
+  long long pCursor; ///< SSCAN cursor of the next batch
+  bool pDone; ///< Scan over
+  std::vector<std::string> pBatch; ///< Current batch of ids
+  size_t pPos; ///< Position in the current batch
+};
+
 //------------------------------------------------------------------------------
 //! FileSystemView implementation on top of Redis
 //!
@@ -118,6 +161,51 @@ public:
   //----------------------------------------------------------------------------
   bool clearUnlinkedFileList(IFileMD::location_t location);
 
+  //----------------------------------------------------------------------------
+  //! Get a cursor over the files on a file system, scanning the set in Redis
+  //! in batches instead of loading it at once
+  //!
+  //! @param location filesystem identifier
+  //!
+  //! @return cursor over the file ids
+  //----------------------------------------------------------------------------
+  IFsView::FileListCursor getFileListCursor(IFileMD::location_t location);
+
+  //----------------------------------------------------------------------------
+  //! Get a cursor over the files without replicas
+  //----------------------------------------------------------------------------
+  IFsView::FileListCursor getNoReplicasFileListCursor();
+
+  //----------------------------------------------------------------------------
+  //! Get number of files on a file system
+  //!
+  //! @param location filesystem identifier
+  //!
+  //! @return number of files
+  //----------------------------------------------------------------------------
+  uint64_t getNumFilesOnFs(IFileMD::location_t location);
+
+  //----------------------------------------------------------------------------
+  //! Check if a file has a replica on a file system
+  //!
+  //! @param fid file id
+  //! @param location filesystem identifier
+  //!
+  //! @return true if the file is on the file system, otherwise false
+  //----------------------------------------------------------------------------
+  bool hasFileId(IFileMD::id_t fid, IFileMD::location_t location);
+
+  //----------------------------------------------------------------------------
+  //! Get a random sample of distinct files on a file system using SRANDMEMBER
+  //!
+  //! @param location filesystem identifier
+  //! @param num_files size of the sample
+  //!
+  //! @return file ids
+  //----------------------------------------------------------------------------
+  std::vector<IFileMD::id_t>
+  getRandomFiles(IFileMD::location_t location, size_t num_files);
+
   //----------------------------------------------------------------------------
   //! Get number of file systems
   //!
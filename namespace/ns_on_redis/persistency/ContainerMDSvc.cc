@@ -27,13 +27,16 @@
 EOSNSNAMESPACE_BEGIN
 
 std::uint64_t ContainerMDSvc::sNumContBuckets = 128 * 1024;
+std::size_t ContainerMDSvc::sWriteBatch = 1024;
+std::chrono::milliseconds ContainerMDSvc::sWriteDelay(10);
 
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
 ContainerMDSvc::ContainerMDSvc()
   : pQuotaStats(nullptr), pFileSvc(nullptr), pRedox(nullptr), pRedisHost(""),
-    pRedisPort(0), mContainerCache(static_cast<uint64_t>(10e6))
+    pRedisPort(0), mFlusher(sWriteBatch, sWriteDelay),
+    mContainerCache(static_cast<uint64_t>(10e6))
 {
 }
 
@@ -69,6 +72,17 @@ ContainerMDSvc::initialize()
                    << "metadata service";
     throw e;
   }
+
+  mFlusher.start(pRedox);
+}
+
+//------------------------------------------------------------------------------
+// Finalize the container service
+//------------------------------------------------------------------------------
+void
+ContainerMDSvc::finalize()
+{
+  mFlusher.stop();
 }
 
 //----------------------------------------------------------------------------
@@ -84,17 +98,22 @@ ContainerMDSvc::getContainerMD(IContainerMD::id_t id)
     return cont;
   }
 
-  // If not in cache, then get it from the KV store
+  // If not in cache, then check the updates not yet flushed and eventually
+  // get it from the KV store
   std::string blob;
+  std::string sid = stringify(id);
+  std::string bucket_key = getBucketKey(id);
 
-  try {
-    std::string sid = stringify(id);
-    redox::RedoxHash bucket_map(*pRedox, getBucketKey(id));
-    blob = bucket_map.hget(sid);
-  } catch (std::runtime_error& redis_err) {
-    MDException e(ENOENT);
-    e.getMessage() << "Container #" << id << " not found";
-    throw e;
+  if (mFlusher.lookup(bucket_key, sid, blob) ==
+      MetadataFlusher::Pending::None) {
+    try {
+      redox::RedoxHash bucket_map(*pRedox, bucket_key);
+      blob = bucket_map.hget(sid);
+    } catch (std::runtime_error& redis_err) {
+      MDException e(ENOENT);
+      e.getMessage() << "Container #" << id << " not found";
+      throw e;
+    }
   }
 
   if (blob.empty()) {
@@ -139,17 +158,8 @@ ContainerMDSvc::updateStore(IContainerMD* obj)
 {
   eos::Buffer ebuff;
   dynamic_cast<ContainerMD*>(obj)->serialize(ebuff);
-  std::string buffer(ebuff.getDataPtr(), ebuff.getSize());
-
-  try {
-    std::string sid = stringify(obj->getId());
-    redox::RedoxHash bucket_map(*pRedox, getBucketKey(obj->getId()));
-    bucket_map.hset(sid, buffer);
-  } catch (std::runtime_error& redis_err) {
-    MDException e(ENOENT);
-    e.getMessage() << "File #" << obj->getId() << " failed to contact backend";
-    throw e;
-  }
+  mFlusher.hset(getBucketKey(obj->getId()), stringify(obj->getId()),
+                std::string(ebuff.getDataPtr(), ebuff.getSize()));
 }
 
 //----------------------------------------------------------------------------
@@ -166,16 +176,7 @@ ContainerMDSvc::removeContainer(IContainerMD* obj)
     throw e;
   }
 
-  try {
-    std::string sid = stringify(obj->getId());
-    redox::RedoxHash bucket_map(*pRedox, getBucketKey(obj->getId()));
-    bucket_map.hdel(sid);
-  } catch (std::runtime_error& redis_err) {
-    MDException e(ENOENT);
-    e.getMessage() << "Container #" << obj->getId() << " not found. "
-                   << "The object was not created in this store!";
-    throw e;
-  }
+  mFlusher.hdel(getBucketKey(obj->getId()), stringify(obj->getId()));
 
   // If this was the root container i.e. id=1 then drop the meta map
   if (obj->getId() == 1) {
@@ -261,6 +262,8 @@ ContainerMDSvc::getLostFoundContainer(const std::string& name)
 uint64_t
 ContainerMDSvc::getNumContainers()
 {
+  // Count also the containers not yet flushed
+  mFlusher.flush();
   std::atomic<std::uint32_t> num_requests{0};
   std::atomic<std::uint64_t> num_conts{0};
   std::string bucket_key("");
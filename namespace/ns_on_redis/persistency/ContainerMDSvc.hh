@@ -29,6 +29,7 @@
 #include "namespace/ns_on_redis/Constants.hh"
 #include "namespace/ns_on_redis/LRU.hh"
 #include "namespace/ns_on_redis/accounting/QuotaStats.hh"
+#include "namespace/ns_on_redis/persistency/MetadataFlusher.hh"
 #include <list>
 #include <map>
 
@@ -71,9 +72,9 @@ public:
   virtual void configure(const std::map<std::string, std::string>& config);
 
   //----------------------------------------------------------------------------
-  //! Finalize the container service
+  //! Finalize the container service - flushes all pending updates
   //----------------------------------------------------------------------------
-  virtual void finalize() {};
+  virtual void finalize();
 
   //----------------------------------------------------------------------------
   //! Get the container metadata information for the given container ID
@@ -102,6 +103,25 @@ public:
   //----------------------------------------------------------------------------
   virtual uint64_t getNumContainers();
 
+  //----------------------------------------------------------------------------
+  //! Get statistics of the container cache
+  //----------------------------------------------------------------------------
+  virtual void getCacheStats(std::map<std::string, uint64_t>& stats)
+  {
+    stats["size"] = mContainerCache.size();
+    stats["hits"] = mContainerCache.getNumHits();
+    stats["misses"] = mContainerCache.getNumMisses();
+    stats["evictions"] = mContainerCache.getNumEvictions();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get statistics of the write-behind flusher
+  //----------------------------------------------------------------------------
+  virtual void getFlusherStats(std::map<std::string, uint64_t>& stats)
+  {
+    mFlusher.getStats(stats);
+  }
+
   //----------------------------------------------------------------------------
   //! Add file listener that will be notified about all of the changes in
   //! the store
@@ -179,12 +199,17 @@ private:
   std::string getBucketKey(IContainerMD::id_t id) const;
 
   static std::uint64_t sNumContBuckets; ///< Number of buckets power of 2
+  //! Maximum number of container updates sent to the backend in one batch
+  static std::size_t sWriteBatch;
+  //! Maximum time a container update waits before being sent to the backend
+  static std::chrono::milliseconds sWriteDelay;
   ListenerList pListeners;  ///< List of listeners to be notified
   IQuotaStats* pQuotaStats; ///< Quota view
   IFileMDSvc* pFileSvc;     ///< File metadata service
   redox::Redox* pRedox;     ///< Redis client
   std::string pRedisHost;   ///< Redis instance host
   uint32_t pRedisPort;      ///< Redis instance port
+  MetadataFlusher mFlusher; ///< Write-behind pipeline for container updates
   LRU<IContainerMD::id_t, IContainerMD> mContainerCache;
   // TODO: decide on how to ensure container consistency in case of a crash
   redox::RedoxSet pCheckConts; ///< Set of container idsd to be checked
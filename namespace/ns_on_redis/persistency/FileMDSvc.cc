@@ -23,11 +23,16 @@
 #include "namespace/ns_on_redis/accounting/QuotaStats.hh"
 #include "namespace/ns_on_redis/persistency/ContainerMDSvc.hh"
 #include "namespace/utils/StringConvertion.hh"
+#include <algorithm>
+#include <atomic>
 
 EOSNSNAMESPACE_BEGIN
 
 std::uint64_t FileMDSvc::sNumFileBuckets(1024 * 1024);
 std::chrono::seconds FileMDSvc::sFlushInterval(5);
+std::size_t FileMDSvc::sWriteBatch(1024);
+std::chrono::milliseconds FileMDSvc::sWriteDelay(10);
+std::size_t FileMDSvc::sPrefetchBatch(4096);
 
 //------------------------------------------------------------------------------
 // Constructor
@@ -35,7 +40,8 @@ std::chrono::seconds FileMDSvc::sFlushInterval(5);
 FileMDSvc::FileMDSvc()
   : pQuotaStats(nullptr), pContSvc(nullptr), mFlushTimestamp(std::time(nullptr)),
     pRedisPort(0), pRedisHost(""), pRedox(nullptr), mMetaMap(),
-    mDirtyFidBackend(), mFlushFidSet(), mFileCache(10e6) {}
+    mDirtyFidBackend(), mFlushFidSet(), mFlushFidMutex(),
+    mFlusher(sWriteBatch, sWriteDelay), mFileCache(10e6) {}
 
 //------------------------------------------------------------------------------
 // Configure the file service
@@ -72,6 +78,28 @@ FileMDSvc::initialize()
   mMetaMap.setClient(*pRedox);
   mDirtyFidBackend.setKey(constants::sSetCheckFiles);
   mDirtyFidBackend.setClient(*pRedox);
+  // Files whose update reached the backend can be dropped from the dirty set
+  mFlusher.start(pRedox, [this](const std::vector<MetadataFlusher::Entry>&
+  entries) {
+    std::lock_guard<std::mutex> lock(mFlushFidMutex);
+
+    for (auto && elem : entries) {
+      mFlushFidSet.insert(elem.second);
+    }
+  });
+}
+
+//------------------------------------------------------------------------------
+// Finalize the file service
+//------------------------------------------------------------------------------
+void
+FileMDSvc::finalize()
+{
+  mFlusher.stop();
+
+  if (pRedox != nullptr) {
+    flushDirtySet(true);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -87,17 +115,22 @@ FileMDSvc::getFileMD(IFileMD::id_t id)
     return file;
   }
 
-  // If not in cache, then get info from KV store
+  // If not in cache, then check the updates not yet flushed and eventually
+  // get info from KV store
   std::string blob;
+  std::string sid = stringify(id);
+  std::string bucket_key = getBucketKey(id);
+  MetadataFlusher::Pending pending = mFlusher.lookup(bucket_key, sid, blob);
 
-  try {
-    std::string sid = stringify(id);
-    redox::RedoxHash bucket_map(*pRedox, getBucketKey(id));
-    blob = bucket_map.hget(sid);
-  } catch (std::runtime_error& redis_err) {
-    MDException e(ENOENT);
-    e.getMessage() << "File #" << id << " not found";
-    throw e;
+  if (pending == MetadataFlusher::Pending::None) {
+    try {
+      redox::RedoxHash bucket_map(*pRedox, bucket_key);
+      blob = bucket_map.hget(sid);
+    } catch (std::runtime_error& redis_err) {
+      MDException e(ENOENT);
+      e.getMessage() << "File #" << id << " not found";
+      throw e;
+    }
   }
 
   if (blob.empty()) {
@@ -106,7 +139,85 @@ FileMDSvc::getFileMD(IFileMD::id_t id)
     throw e;
   }
 
-  file = std::make_shared<FileMD>(0, this);
+  return loadFileMD(blob);
+}
+
+//------------------------------------------------------------------------------
+// Prefetch the metadata of the given files into the cache
+//------------------------------------------------------------------------------
+void
+FileMDSvc::prefetchFileMD(const std::vector<IFileMD::id_t>& ids)
+{
+  std::vector<IFileMD::id_t> to_fetch;
+
+  for (auto id : ids) {
+    if (mFileCache.get(id) == nullptr) {
+      to_fetch.push_back(id);
+    }
+  }
+
+  std::vector<std::string> blobs;
+  std::atomic<std::size_t> num_requests(0);
+  std::mutex mutex;
+  std::condition_variable cond_var;
+
+  for (std::size_t start = 0; start < to_fetch.size(); start += sPrefetchBatch) {
+    std::size_t stop = std::min(start + sPrefetchBatch, to_fetch.size());
+    blobs.assign(stop - start, std::string());
+
+    // Queue all the requests of the round before waiting for any reply
+    for (std::size_t i = start; i < stop; ++i) {
+      std::string sid = stringify(to_fetch[i]);
+      std::string bucket_key = getBucketKey(to_fetch[i]);
+      std::string& blob = blobs[i - start];
+
+      if (mFlusher.lookup(bucket_key, sid, blob) !=
+          MetadataFlusher::Pending::None) {
+        continue;
+      }
+
+      ++num_requests;
+
+      try {
+        pRedox->command<std::string>({"HGET", bucket_key, sid},
+        [&blob, &num_requests, &mutex, &cond_var](redox::Command<std::string>& c) {
+          if (c.ok()) {
+            blob = c.reply();
+          }
+
+          if (--num_requests == 0u) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond_var.notify_one();
+          }
+        });
+      } catch (std::runtime_error& redis_err) {
+        --num_requests;
+      }
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      while (num_requests != 0u) {
+        cond_var.wait(lock);
+      }
+    }
+
+    for (auto && blob : blobs) {
+      if (!blob.empty()) {
+        (void) loadFileMD(blob);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build a file object from its serialized representation
+//------------------------------------------------------------------------------
+std::shared_ptr<IFileMD>
+FileMDSvc::loadFileMD(const std::string& blob)
+{
+  std::shared_ptr<IFileMD> file = std::make_shared<FileMD>(0, this);
   eos::Buffer ebuff;
   ebuff.putData(blob.c_str(), blob.length());
   file.get()->deserialize(ebuff);
@@ -140,20 +251,16 @@ FileMDSvc::updateStore(IFileMD* obj)
 {
   eos::Buffer ebuff;
   obj->serialize(ebuff);
-  std::string buffer(ebuff.getDataPtr(), ebuff.getSize());
-
-  try {
-    std::string sid = stringify(obj->getId());
-    redox::RedoxHash bucket_map(*pRedox, getBucketKey(obj->getId()));
-    bucket_map.hset(sid, buffer);
-  } catch (std::runtime_error& redis_err) {
-    MDException e(ENOENT);
-    e.getMessage() << "File #" << obj->getId() << " failed to contact backend";
-    throw e;
+  std::string sid = stringify(obj->getId());
+  {
+    // Not consistent anymore until the new version reaches the backend
+    std::lock_guard<std::mutex> lock(mFlushFidMutex);
+    (void) mFlushFidSet.erase(sid);
   }
-
+  mFlusher.hset(getBucketKey(obj->getId()), sid,
+                std::string(ebuff.getDataPtr(), ebuff.getSize()));
   // Flush fids in bunches to avoid too many round trips to the backend
-  flushDirtySet(obj->getId());
+  flushDirtySet();
 }
 
 //------------------------------------------------------------------------------
@@ -162,23 +269,18 @@ FileMDSvc::updateStore(IFileMD* obj)
 void
 FileMDSvc::removeFile(IFileMD* obj)
 {
-  try {
-    std::string sid = stringify(obj->getId());
-    redox::RedoxHash bucket_map(*pRedox, getBucketKey(obj->getId()));
-    bucket_map.hdel(sid);
-  } catch (std::runtime_error& redis_err) {
-    MDException e(ENOENT);
-    e.getMessage() << "File #" << obj->getId() << " not found. ";
-    e.getMessage() << "The object was not created in this store!";
-    throw e;
+  std::string sid = stringify(obj->getId());
+  {
+    std::lock_guard<std::mutex> lock(mFlushFidMutex);
+    (void) mFlushFidSet.erase(sid);
   }
-
+  mFlusher.hdel(getBucketKey(obj->getId()), sid);
   IFileMDChangeListener::Event e(obj, IFileMDChangeListener::Deleted);
   notifyListeners(&e);
   // Wait for any async notification before deleting the object
   (void) dynamic_cast<FileMD*>(obj)->waitAsyncReplies();
   mFileCache.remove(obj->getId());
-  flushDirtySet(obj->getId(), true);
+  flushDirtySet();
 }
 
 //------------------------------------------------------------------------------
@@ -187,6 +289,8 @@ FileMDSvc::removeFile(IFileMD* obj)
 uint64_t
 FileMDSvc::getNumFiles()
 {
+  // Count also the files not yet flushed
+  mFlusher.flush();
   std::atomic<std::uint32_t> num_requests(0);
   std::atomic<std::uint64_t> num_files(0);
   std::string bucket_key("");
@@ -377,6 +481,7 @@ FileMDSvc::addToDirtySet(IFileMD* file)
   // Remove from the set of fid to be flushed and update the backend only if
   // wasn't in the set - optimize the number of RTT to backend.
   IFileMD::id_t fid = file->getId();
+  std::lock_guard<std::mutex> lock(mFlushFidMutex);
 
   if (mFlushFidSet.erase(stringify(fid)) == 0) {
     try {
@@ -396,16 +501,23 @@ FileMDSvc::addToDirtySet(IFileMD* file)
 // the backend set accordingly.
 //------------------------------------------------------------------------------
 void
-FileMDSvc::flushDirtySet(IFileMD::id_t id, bool force)
+FileMDSvc::flushDirtySet(bool force)
 {
-  (void) mFlushFidSet.insert(stringify(id));
   std::time_t now = std::time(nullptr);
   std::chrono::seconds duration(now - mFlushTimestamp);
 
   if (force || (duration >= sFlushInterval)) {
     mFlushTimestamp = now;
-    std::vector<std::string> to_del(mFlushFidSet.begin(), mFlushFidSet.end());
-    mFlushFidSet.clear();
+    std::vector<std::string> to_del;
+    {
+      std::lock_guard<std::mutex> lock(mFlushFidMutex);
+      to_del.assign(mFlushFidSet.begin(), mFlushFidSet.end());
+      mFlushFidSet.clear();
+    }
+
+    if (to_del.empty()) {
+      return;
+    }
 
     try {
       mDirtyFidBackend.srem(to_del);
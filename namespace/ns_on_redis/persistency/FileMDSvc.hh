@@ -27,9 +27,12 @@
 #include "namespace/interface/IFileMDSvc.hh"
 #include "namespace/ns_on_redis/LRU.hh"
 #include "namespace/ns_on_redis/RedisClient.hh"
+#include "namespace/ns_on_redis/persistency/MetadataFlusher.hh"
 #include <condition_variable>
 #include <list>
 #include <mutex>
+#include <set>
+#include <vector>
 
 //! Forward declarations
 namespace redox
@@ -70,9 +73,9 @@ public:
   virtual void configure(const std::map<std::string, std::string>& config);
 
   //----------------------------------------------------------------------------
-  //! Finalize the file service
+  //! Finalize the file service - flushes all pending updates
   //----------------------------------------------------------------------------
-  virtual void finalize() {};
+  virtual void finalize();
 
   //----------------------------------------------------------------------------
   //! Get the file metadata information for the given file ID
@@ -81,6 +84,23 @@ public:
   //----------------------------------------------------------------------------
   virtual std::shared_ptr<IFileMD> getFileMD(IFileMD::id_t id);
 
+  //----------------------------------------------------------------------------
+  //! Load the metadata of the given files into the cache. The files missing
+  //! from the cache are requested in pipelined rounds of at most
+  //! sPrefetchBatch requests instead of one round trip per file.
+  //!
+  //! @param ids file ids, unknown ids are skipped
+  //----------------------------------------------------------------------------
+  virtual void prefetchFileMD(const std::vector<IFileMD::id_t>& ids);
+
+  //----------------------------------------------------------------------------
+  //! Get the write-behind flusher e.g. for its statistics
+  //----------------------------------------------------------------------------
+  const MetadataFlusher& getFlusher() const
+  {
+    return mFlusher;
+  }
+
   //----------------------------------------------------------------------------
   //! Create new file metadata object with an assigned id
   //----------------------------------------------------------------------------
@@ -88,7 +108,8 @@ public:
 
   //----------------------------------------------------------------------------
   //! Update the file metadata in the backing store after the FileMD object
-  //! has been changed
+  //! has been changed. The update is queued to the write-behind flusher,
+  //! repeated updates of the same file within a batch are coalesced.
   //----------------------------------------------------------------------------
   virtual void updateStore(IFileMD* obj);
 
@@ -102,6 +123,25 @@ public:
   //----------------------------------------------------------------------------
   virtual uint64_t getNumFiles();
 
+  //----------------------------------------------------------------------------
+  //! Get statistics of the file cache
+  //----------------------------------------------------------------------------
+  virtual void getCacheStats(std::map<std::string, uint64_t>& stats)
+  {
+    stats["size"] = mFileCache.size();
+    stats["hits"] = mFileCache.getNumHits();
+    stats["misses"] = mFileCache.getNumMisses();
+    stats["evictions"] = mFileCache.getNumEvictions();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get statistics of the write-behind flusher
+  //----------------------------------------------------------------------------
+  virtual void getFlusherStats(std::map<std::string, uint64_t>& stats)
+  {
+    mFlusher.getStats(stats);
+  }
+
   //----------------------------------------------------------------------------
   //! Add file listener that will be notified about all of the changes in
   //! the store
@@ -155,6 +195,22 @@ private:
   static std::uint64_t sNumFileBuckets; ///< Number of buckets power of 2
   //! Interval for backend flush of consistent file ids
   static std::chrono::seconds sFlushInterval;
+  //! Maximum number of file updates sent to the backend in one batch
+  static std::size_t sWriteBatch;
+  //! Maximum time a file update waits before being sent to the backend
+  static std::chrono::milliseconds sWriteDelay;
+  //! Maximum number of requests in flight while prefetching
+  static std::size_t sPrefetchBatch;
+
+  //----------------------------------------------------------------------------
+  //! Build a file object from its serialized representation and put it in
+  //! the cache
+  //!
+  //! @param blob serialized file metadata
+  //!
+  //! @return cached file object
+  //----------------------------------------------------------------------------
+  std::shared_ptr<IFileMD> loadFileMD(const std::string& blob);
 
   //----------------------------------------------------------------------------
   //! Check file object consistency
@@ -192,10 +248,9 @@ private:
   //! Remove all accumulated objects from the local "dirty" set and mark them
   //! in the backend set accordingly.
   //!
-  //! @param id file id
   //! @param force if true then force flush
   //----------------------------------------------------------------------------
-  void flushDirtySet(IFileMD::id_t id, bool force = false);
+  void flushDirtySet(bool force = false);
 
   ListenerList pListeners; ///< List of listeners to notify of changes
   IQuotaStats* pQuotaStats; ///< Quota view
@@ -206,7 +261,10 @@ private:
   redox::Redox* pRedox; ///< Redox client object
   redox::RedoxHash mMetaMap ; ///< Map holding metainfo about the namespace
   redox::RedoxSet mDirtyFidBackend; ///< Set of "dirty" files
-  std::set<std::string> mFlushFidSet; ///< Modified fids which are consistent
+  //! Modified fids which are consistent i.e. stored in the backend
+  std::set<std::string> mFlushFidSet;
+  std::mutex mFlushFidMutex; ///< Protects mFlushFidSet against the flusher
+  MetadataFlusher mFlusher; ///< Write-behind pipeline for file updates
   LRU<IFileMD::id_t, IFileMD> mFileCache; ///< Local cache of file objects
 };
 
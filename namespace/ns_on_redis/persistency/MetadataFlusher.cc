@@ -0,0 +1,352 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "namespace/ns_on_redis/persistency/MetadataFlusher.hh"
+#include "namespace/ns_on_redis/RedisClient.hh"
+#include "namespace/MDException.hh"
+#include "common/Logging.hh"
+
+EOSNSNAMESPACE_BEGIN
+
+//! Number of batches which can be pending before the producers are blocked
+static const std::size_t sMaxPendingBatches = 16;
+//! Time to wait before retrying after a batch with failed entries
+static const std::chrono::milliseconds sRetryDelay(1000);
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+MetadataFlusher::MetadataFlusher(std::size_t max_batch,
+                                 std::chrono::milliseconds max_delay)
+  : mMaxBatch(max_batch ? max_batch : 1), mMaxDelay(max_delay),
+    mRedox(nullptr), mCallback(), mPending(), mInFlight(), mOldest(),
+    mStop(false), mNumQueued(0), mNumSent(0), mNumBatches(0), mNumErrors(0)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+MetadataFlusher::~MetadataFlusher()
+{
+  try {
+    stop();
+  } catch (MDException& e) {
+    eos_static_err("%s", e.getMessage().str().c_str());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Start the background flusher
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::start(redox::Redox* rdx, FlushedCallback callback)
+{
+  if (mThread.joinable()) {
+    return;
+  }
+
+  mRedox = rdx;
+  mCallback = callback;
+  mStop = false;
+  mThread = std::thread(&MetadataFlusher::flusherLoop, this);
+}
+
+//------------------------------------------------------------------------------
+// Flush pending entries and stop the background flusher
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::stop()
+{
+  if (mThread.joinable()) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCvWork.notify_one();
+    mThread.join();
+  }
+
+  if (mRedox != nullptr) {
+    flushPending();
+  }
+
+  std::uint64_t lost = getNumPending();
+
+  if (lost) {
+    eos_static_err("msg=\"dropping entries never stored in the KV-backend\" "
+                   "num=%llu", (unsigned long long) lost);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queue setting a hash field
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::hset(const std::string& key, const std::string& field,
+                      std::string&& value)
+{
+  enqueue(key, field, Mutation{false, std::move(value)});
+}
+
+//------------------------------------------------------------------------------
+// Queue deleting a hash field
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::hdel(const std::string& key, const std::string& field)
+{
+  enqueue(key, field, Mutation{true, std::string()});
+}
+
+//------------------------------------------------------------------------------
+// Queue a mutation
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::enqueue(const std::string& key, const std::string& field,
+                         Mutation&& mutation)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  // Don't let the producers run away from a slow backend
+  while (mThread.joinable() && !mStop &&
+         (mPending.size() >= sMaxPendingBatches * mMaxBatch)) {
+    mCvWork.notify_one();
+    mCvDone.wait(lock);
+  }
+
+  if (mPending.empty()) {
+    mOldest = std::chrono::steady_clock::now();
+  }
+
+  mPending[Entry(key, field)] = std::move(mutation);
+  ++mNumQueued;
+
+  if (mPending.size() == mMaxBatch) {
+    mCvWork.notify_one();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Look up a field among the entries not yet acknowledged
+//------------------------------------------------------------------------------
+MetadataFlusher::Pending
+MetadataFlusher::lookup(const std::string& key, const std::string& field,
+                        std::string& value)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  Entry entry(key, field);
+
+  for (MutationMap* map : {&mPending, &mInFlight}) {
+    auto it = map->find(entry);
+
+    if (it != map->end()) {
+      if (it->second.mDelete) {
+        return Pending::Deleted;
+      }
+
+      value = it->second.mValue;
+      return Pending::Value;
+    }
+  }
+
+  return Pending::None;
+}
+
+//------------------------------------------------------------------------------
+// Get the number of entries waiting to be sent
+//------------------------------------------------------------------------------
+std::uint64_t
+MetadataFlusher::getNumPending()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  return mPending.size();
+}
+
+//------------------------------------------------------------------------------
+// Get the counters
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::getStats(std::map<std::string, std::uint64_t>& stats)
+{
+  stats["queued"] = mNumQueued;
+  stats["sent"] = mNumSent;
+  stats["batches"] = mNumBatches;
+  stats["errors"] = mNumErrors;
+  stats["pending"] = getNumPending();
+}
+
+//------------------------------------------------------------------------------
+// Send all entries queued so far and wait for the acknowledgement
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::flush()
+{
+  flushPending();
+}
+
+//------------------------------------------------------------------------------
+// Background loop
+//------------------------------------------------------------------------------
+void
+MetadataFlusher::flusherLoop()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (!mStop) {
+    if (mPending.empty()) {
+      mCvWork.wait(lock);
+      continue;
+    }
+
+    auto deadline = mOldest + mMaxDelay;
+
+    if ((mPending.size() < mMaxBatch) &&
+        (std::chrono::steady_clock::now() < deadline)) {
+      mCvWork.wait_until(lock, deadline);
+      continue;
+    }
+
+    lock.unlock();
+    std::size_t failed = 0;
+
+    try {
+      failed = flushPending();
+    } catch (MDException& e) {
+      eos_static_err("%s", e.getMessage().str().c_str());
+    }
+
+    lock.lock();
+
+    // Give the backend some time before sending the failed entries again
+    if (failed && !mStop) {
+      mCvWork.wait_for(lock, sRetryDelay);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Send all pending entries in one pipelined round
+//------------------------------------------------------------------------------
+std::size_t
+MetadataFlusher::flushPending()
+{
+  if (mRedox == nullptr) {
+    MDException e(EINVAL);
+    e.getMessage() << "Metadata flusher has no backend client";
+    throw e;
+  }
+
+  std::unique_lock<std::mutex> flush_lock(mFlushMutex);
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mPending.empty()) {
+      return 0;
+    }
+
+    mInFlight.swap(mPending);
+  }
+  mCvDone.notify_all();
+
+  // The commands are queued back to back on the client connection and the
+  // replies are collected asynchronously, i.e. one round trip per batch.
+  // mInFlight is only modified by the holder of mFlushMutex so it can be
+  // read here without mMutex.
+  std::size_t num = mInFlight.size();
+  std::vector<char> stored(num, 0);
+  std::atomic<std::size_t> remaining(num);
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  auto done = [&]() {
+    if (--remaining == 0u) {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond_var.notify_one();
+    }
+  };
+  std::size_t i = 0;
+
+  for (auto && elem : mInFlight) {
+    std::vector<std::string> cmd;
+
+    if (elem.second.mDelete) {
+      cmd = {"HDEL", elem.first.first, elem.first.second};
+    } else {
+      cmd = {"HSET", elem.first.first, elem.first.second, elem.second.mValue};
+    }
+
+    try {
+      mRedox->command<int>(cmd, [&stored, &done, i](redox::Command<int>& c) {
+        stored[i] = c.ok();
+        done();
+      });
+    } catch (std::runtime_error& redis_err) {
+      done();
+    }
+
+    ++i;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (remaining != 0u) {
+      cond_var.wait(lock);
+    }
+  }
+
+  std::vector<Entry> acked;
+  std::size_t failed = 0;
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    bool was_empty = mPending.empty();
+    i = 0;
+
+    for (auto && elem : mInFlight) {
+      if (!stored[i++]) {
+        // Queue the failed entry again unless it was modified meanwhile
+        ++failed;
+        mPending.emplace(elem.first, std::move(elem.second));
+      } else if (mPending.find(elem.first) == mPending.end()) {
+        acked.push_back(elem.first);
+      }
+    }
+
+    if (was_empty && !mPending.empty()) {
+      mOldest = std::chrono::steady_clock::now();
+    }
+
+    mInFlight.clear();
+  }
+  mNumSent += num;
+  mNumErrors += failed;
+  ++mNumBatches;
+  mCvDone.notify_all();
+
+  if (failed) {
+    eos_static_err("msg=\"failed to store entries in the KV-backend, queued "
+                   "for retry\" failed=%llu sent=%llu",
+                   (unsigned long long) failed, (unsigned long long) num);
+  }
+
+  if (mCallback && !acked.empty()) {
+    mCallback(acked);
+  }
+
+  return failed;
+}
+
+EOSNSNAMESPACE_END
@@ -0,0 +1,206 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Write-behind pipeline for the metadata hashes stored in Redis
+//------------------------------------------------------------------------------
+
+#ifndef __EOS_NS_REDIS_METADATA_FLUSHER_HH__
+#define __EOS_NS_REDIS_METADATA_FLUSHER_HH__
+
+#include "namespace/Namespace.hh"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Forward declarations
+namespace redox
+{
+class Redox;
+}
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Collects HSET/HDEL mutations of hash fields and sends them to Redis in
+//! pipelined batches from a background thread. Repeated mutations of the same
+//! field are coalesced, only the last one is sent. A batch goes out once it
+//! reaches the maximum batch size or once its oldest entry has waited for the
+//! maximum delay, whichever comes first. Entries Redis failed to store are
+//! kept queued and sent again with the next batch.
+//------------------------------------------------------------------------------
+class MetadataFlusher
+{
+public:
+  //! Key and field of a hash entry
+  typedef std::pair<std::string, std::string> Entry;
+  //! Called after each batch with the entries stored successfully and not
+  //! modified again in the meantime
+  typedef std::function<void(const std::vector<Entry>&)> FlushedCallback;
+
+  //! Result of looking up an entry which may not be in Redis yet
+  enum class Pending { None, Value, Deleted };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param max_batch maximum number of entries sent in one batch
+  //! @param max_delay maximum time an entry waits before being sent
+  //----------------------------------------------------------------------------
+  MetadataFlusher(std::size_t max_batch = 1024,
+                  std::chrono::milliseconds max_delay =
+                    std::chrono::milliseconds(10));
+
+  //----------------------------------------------------------------------------
+  //! Destructor - flushes all pending entries
+  //----------------------------------------------------------------------------
+  ~MetadataFlusher();
+
+  //----------------------------------------------------------------------------
+  //! Start the background flusher
+  //!
+  //! @param rdx Redis client
+  //! @param callback called after every batch, can be empty
+  //----------------------------------------------------------------------------
+  void start(redox::Redox* rdx, FlushedCallback callback = nullptr);
+
+  //----------------------------------------------------------------------------
+  //! Flush all pending entries and stop the background flusher
+  //----------------------------------------------------------------------------
+  void stop();
+
+  //----------------------------------------------------------------------------
+  //! Queue setting a hash field
+  //----------------------------------------------------------------------------
+  void hset(const std::string& key, const std::string& field,
+            std::string&& value);
+
+  //----------------------------------------------------------------------------
+  //! Queue deleting a hash field
+  //----------------------------------------------------------------------------
+  void hdel(const std::string& key, const std::string& field);
+
+  //----------------------------------------------------------------------------
+  //! Look up a hash field among the entries not yet acknowledged by Redis
+  //!
+  //! @param key hash key
+  //! @param field hash field
+  //! @param value set to the pending value if the return value is Value
+  //!
+  //! @return Value or Deleted if the field has a pending mutation, otherwise
+  //!         None and the backend holds the current value
+  //----------------------------------------------------------------------------
+  Pending lookup(const std::string& key, const std::string& field,
+                 std::string& value);
+
+  //----------------------------------------------------------------------------
+  //! Send all the entries queued so far and wait for the acknowledgement.
+  //! The entries which failed stay queued for the next batch.
+  //----------------------------------------------------------------------------
+  void flush();
+
+  //----------------------------------------------------------------------------
+  //! Counters
+  //----------------------------------------------------------------------------
+  std::uint64_t getNumQueued() const
+  {
+    return mNumQueued;
+  }
+
+  std::uint64_t getNumSent() const
+  {
+    return mNumSent;
+  }
+
+  std::uint64_t getNumBatches() const
+  {
+    return mNumBatches;
+  }
+
+  std::uint64_t getNumErrors() const
+  {
+    return mNumErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the number of entries waiting to be sent, including the failed ones
+  //----------------------------------------------------------------------------
+  std::uint64_t getNumPending();
+
+  //----------------------------------------------------------------------------
+  //! Get the counters as "queued", "sent", "batches", "errors" and "pending"
+  //----------------------------------------------------------------------------
+  void getStats(std::map<std::string, std::uint64_t>& stats);
+
+private:
+  //! Pending mutation of a hash field
+  struct Mutation {
+    bool mDelete;
+    std::string mValue;
+  };
+
+  typedef std::map<Entry, Mutation> MutationMap;
+
+  //----------------------------------------------------------------------------
+  //! Queue a mutation, blocks while too many entries are pending
+  //----------------------------------------------------------------------------
+  void enqueue(const std::string& key, const std::string& field,
+               Mutation&& mutation);
+
+  //----------------------------------------------------------------------------
+  //! Background loop
+  //----------------------------------------------------------------------------
+  void flusherLoop();
+
+  //----------------------------------------------------------------------------
+  //! Take all pending entries and send them in one pipelined round. Batches
+  //! are serialized so that mutations of a field reach Redis in order.
+  //!
+  //! @return number of entries which failed and were queued again
+  //----------------------------------------------------------------------------
+  std::size_t flushPending();
+
+  std::size_t mMaxBatch; ///< Batch size triggering a flush
+  std::chrono::milliseconds mMaxDelay; ///< Maximum delay of an entry
+  redox::Redox* mRedox; ///< Redis client
+  FlushedCallback mCallback; ///< Notification of stored entries
+  std::mutex mMutex; ///< Protects the maps below and mStop
+  std::condition_variable mCvWork; ///< Wakes up the flusher
+  std::condition_variable mCvDone; ///< Signals the end of a batch
+  MutationMap mPending; ///< Entries waiting for the next batch
+  MutationMap mInFlight; ///< Entries sent and not yet acknowledged
+  std::chrono::steady_clock::time_point mOldest; ///< Age of mPending
+  bool mStop; ///< Flag to stop the flusher thread
+  std::mutex mFlushMutex; ///< Serializes the batches
+  std::thread mThread; ///< Flusher thread
+  std::atomic<std::uint64_t> mNumQueued; ///< Mutations queued
+  std::atomic<std::uint64_t> mNumSent; ///< Mutations sent after coalescing
+  std::atomic<std::uint64_t> mNumBatches; ///< Batches sent
+  std::atomic<std::uint64_t> mNumErrors; ///< Failed attempts to store a mutation
+};
+
+EOSNSNAMESPACE_END
+
+#endif // __EOS_NS_REDIS_METADATA_FLUSHER_HH__
@@ -27,6 +27,7 @@
 #include "namespace/ns_on_redis/persistency/FileMDSvc.hh"
 #include "namespace/ns_on_redis/views/HierarchicalView.hh"
 #include <iostream>
+#include <set>
 #include <string>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -211,6 +212,44 @@ RunReader(void* tconf)
   return nullptr;
 }
 
+//------------------------------------------------------------------------------
+// List all the level_2 containers looking up every file, optionally after
+// prefetching the files of each container. Returns the number of files seen.
+//------------------------------------------------------------------------------
+static size_t
+ListContainers(eos::IView* view, size_t n_i, size_t n_j, size_t n_k,
+               bool prefetch)
+{
+  size_t num_files = 0;
+
+  for (size_t i = 0; i < n_i; i++) {
+    for (size_t j = 0; j < n_j; j++) {
+      for (size_t k = 0; k < n_k; k++) {
+        char s_container_path[1024];
+        snprintf(static_cast<char*>(s_container_path), sizeof(s_container_path) - 1,
+                 "/eos/nsbench/level_0_%08u/level_1_%08u/level_2_%08u/",
+                 static_cast<unsigned int>(i), static_cast<unsigned int>(j),
+                 static_cast<unsigned int>(k));
+        std::shared_ptr<eos::IContainerMD> cont =
+          view->getContainer(static_cast<char*>(s_container_path));
+        std::set<std::string> fnames = cont->getNameFiles();
+
+        if (prefetch) {
+          cont->prefetchFiles();
+        }
+
+        for (auto && fname : fnames) {
+          if (cont->findFile(fname)) {
+            ++num_files;
+          }
+        }
+      }
+    }
+  }
+
+  return num_files;
+}
+
 //------------------------------------------------------------------------------
 // Main function
 //----------------------------------------------------------------------------
@@ -342,12 +381,44 @@ main(int argc, char** argv)
     tm.Print();
     double rate = (n_files * n_i * n_j * n_k) / tm.RealTime() * 1000.0;
     PrintStatus(view, &st[0], &st[1], &mem[0], &mem[1], rate);
+    const eos::MetadataFlusher& flusher =
+      static_cast<eos::FileMDSvc*>(view->getFileMDSvc())->getFlusher();
+    fprintf(stderr, "ALL      flusher queued/sent/batches/errors %llu/%llu/%llu"
+            "/%llu\n", (unsigned long long) flusher.getNumQueued(),
+            (unsigned long long) flusher.getNumSent(),
+            (unsigned long long) flusher.getNumBatches(),
+            (unsigned long long) flusher.getNumErrors());
     closeNamespace(view);
   } catch (eos::MDException& e) {
     std::cerr << "[!] Error: " << e.getMessage().str() << std::endl;
     return 2;
   }
 
+  // List the containers with a cold cache, first looking up the files one by
+  // one and then prefetching the files of each container in bulk
+  for (bool prefetch : {false, true}) {
+    try {
+      std::cerr << "# *********************************************************"
+                << std::endl;
+      std::cerr << "[i] Listing benchmark " << (prefetch ? "with" : "without")
+                << " prefetch ..." << std::endl;
+      std::cerr << "# *********************************************************"
+                << std::endl;
+      eos::IView* view = bootNamespace(config);
+      eos::common::Timing tm("listing");
+      COMMONTIMING("list-start", &tm);
+      size_t num_files = ListContainers(view, n_i, n_j, n_k, prefetch);
+      COMMONTIMING("list-stop", &tm);
+      tm.Print();
+      fprintf(stderr, "ALL      listed files %zu rate %.02f\n", num_files,
+              num_files / tm.RealTime() * 1000.0);
+      closeNamespace(view);
+    } catch (eos::MDException& e) {
+      std::cerr << "[!] Error: " << e.getMessage().str() << std::endl;
+      return 2;
+    }
+  }
+
   eos::IView* view = nullptr;
   // Run a parallel consumer thread benchmark without locking
   {
@@ -0,0 +1,210 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Multi-threaded get/put throughput of the sharded namespace LRU
+//!        compared to the previous implementation using one global lock
+//------------------------------------------------------------------------------
+
+#include "common/RWMutex.hh"
+#include "namespace/ns_on_redis/LRU.hh"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+//! Cached object
+//------------------------------------------------------------------------------
+struct Entry {
+  explicit Entry(std::uint64_t id) : mId(id) {}
+
+  std::uint64_t
+  getId() const
+  {
+    return mId;
+  }
+
+  std::uint64_t mId;
+};
+
+//------------------------------------------------------------------------------
+//! The LRU as it used to be: one write lock for every operation
+//------------------------------------------------------------------------------
+class LockedLRU
+{
+public:
+  explicit LockedLRU(std::uint64_t max_size) : mMaxSize(max_size)
+  {
+    mMutex.SetBlocking(true);
+  }
+
+  std::shared_ptr<Entry> get(std::uint64_t id)
+  {
+    eos::common::RWMutexWriteLock lock_w(mMutex);
+    auto iter_map = mMap.find(id);
+
+    if (iter_map == mMap.end()) {
+      return nullptr;
+    }
+
+    auto iter_new = mList.insert(mList.end(), *iter_map->second);
+    mList.erase(iter_map->second);
+    mMap[id] = iter_new;
+    return *iter_new;
+  }
+
+  std::shared_ptr<Entry> put(std::uint64_t id, std::shared_ptr<Entry> obj)
+  {
+    eos::common::RWMutexWriteLock lock_w(mMutex);
+    auto iter_map = mMap.find(id);
+
+    if (iter_map != mMap.end()) {
+      return *(iter_map->second);
+    }
+
+    if (mMap.size() >= mMaxSize) {
+      auto iter = mList.begin();
+
+      while ((iter != mList.end()) && (mMap.size() > 0.9 * mMaxSize)) {
+        if (iter->use_count() > 1) {
+          ++iter;
+          continue;
+        }
+
+        mMap.erase((*iter)->getId());
+        iter = mList.erase(iter);
+      }
+    }
+
+    auto iter = mList.insert(mList.end(), obj);
+    mMap.emplace(id, iter);
+    return *iter;
+  }
+
+private:
+  typedef std::list<std::shared_ptr<Entry>> ListT;
+  std::map<std::uint64_t, ListT::iterator> mMap;
+  ListT mList;
+  eos::common::RWMutex mMutex;
+  std::uint64_t mMaxSize;
+};
+
+//------------------------------------------------------------------------------
+// Run nthreads threads doing nops lookups each, inserting the entry on a miss
+// like the metadata services do. Return the total rate and the hit ratio.
+//------------------------------------------------------------------------------
+template <typename CacheT>
+double Run(CacheT& cache, size_t nthreads, size_t nops, std::uint64_t key_space,
+           double& hit_ratio)
+{
+  std::vector<std::thread> workers;
+  std::vector<size_t> hits(nthreads, 0);
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    workers.emplace_back([&cache, &hits, i, nops, key_space]() {
+      std::mt19937_64 gen(i);
+      // Skewed access: most lookups go to a hot quarter of the key space
+      std::uniform_int_distribution<std::uint64_t> hot(0, key_space / 4);
+      std::uniform_int_distribution<std::uint64_t> all(0, key_space);
+      size_t nhits = 0;
+
+      for (size_t n = 0; n < nops; ++n) {
+        std::uint64_t id = (n % 4) ? hot(gen) : all(gen);
+
+        if (cache.get(id)) {
+          ++nhits;
+        } else {
+          (void) cache.put(id, std::make_shared<Entry>(id));
+        }
+      }
+
+      hits[i] = nhits;
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(stop - start).count();
+  size_t total_hits = 0;
+
+  for (auto nhits : hits) {
+    total_hits += nhits;
+  }
+
+  hit_ratio = 1.0 * total_hits / (nthreads * nops);
+  return (nthreads * nops) / seconds;
+}
+
+int main(int argc, char** argv)
+{
+  size_t nops = 1000000;
+  std::uint64_t cache_size = 1000000;
+
+  if (argc > 1) {
+    nops = strtoull(argv[1], 0, 10);
+  }
+
+  if (argc > 2) {
+    cache_size = strtoull(argv[2], 0, 10);
+  }
+
+  if (!nops || !cache_size) {
+    std::cerr << "Usage: eos-ns-lru-bench [<ops-per-thread> [<cache-size>]]"
+              << std::endl;
+    return 1;
+  }
+
+  std::uint64_t key_space = 2 * cache_size;
+  fprintf(stdout, "# ops/thread=%zu cache-size=%llu key-space=%llu "
+          "hw-threads=%u\n", nops, (unsigned long long) cache_size,
+          (unsigned long long) key_space, std::thread::hardware_concurrency());
+  fprintf(stdout, "%-8s %16s %8s %16s %8s %8s\n", "threads", "locked(ops/s)",
+          "hit", "sharded(ops/s)", "hit", "speedup");
+
+  for (size_t nthreads = 1; nthreads <= 64; nthreads *= 2) {
+    LockedLRU locked(cache_size);
+    eos::LRU<std::uint64_t, Entry> sharded(cache_size);
+    double locked_hit = 0;
+    double sharded_hit = 0;
+    double locked_rate = Run(locked, nthreads, nops, key_space, locked_hit);
+    double sharded_rate = Run(sharded, nthreads, nops, key_space, sharded_hit);
+
+    if (sharded.size() > cache_size) {
+      fprintf(stderr, "error: sharded cache holds %llu entries, more than "
+              "%llu\n", (unsigned long long) sharded.size(),
+              (unsigned long long) cache_size);
+      return 1;
+    }
+
+    fprintf(stdout, "%-8zu %16.0f %8.3f %16.0f %8.3f %8.2f\n", nthreads,
+            locked_rate, locked_hit, sharded_rate, sharded_hit,
+            sharded_rate / locked_rate);
+  }
+
+  return 0;
+}
@@ -26,6 +26,8 @@
 #include "namespace/utils/TestHelpers.hh"
 #include <cppunit/extensions/HelperMacros.h>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 //------------------------------------------------------------------------------
 // Declaration
@@ -35,10 +37,12 @@ public:
   CPPUNIT_TEST_SUITE(OtherTests);
   CPPUNIT_TEST(pathSplitterTest);
   CPPUNIT_TEST(lruTest);
+  CPPUNIT_TEST(lruShardedTest);
   CPPUNIT_TEST_SUITE_END();
 
   void pathSplitterTest();
   void lruTest();
+  void lruShardedTest();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OtherTests);
@@ -150,3 +154,61 @@ OtherTests::lruTest()
   // Obect 102 should have been evicted from the cache
   CPPUNIT_ASSERT(!cache.get(100));
 }
+
+//------------------------------------------------------------------------------
+// Test sharded LRU counters and concurrent access
+//------------------------------------------------------------------------------
+void
+OtherTests::lruShardedTest()
+{
+  struct Entry {
+    explicit Entry(std::uint64_t id) : id_(id) {}
+
+    std::uint64_t
+    getId() const
+    {
+      return id_;
+    }
+
+    std::uint64_t id_;
+  };
+
+  std::uint64_t max_size = 1000;
+  std::uint32_t num_shards = 8;
+  eos::LRU<std::uint64_t, Entry> cache{max_size, num_shards};
+  CPPUNIT_ASSERT_EQUAL(num_shards, cache.getNumShards());
+  CPPUNIT_ASSERT(!cache.get(1));
+  CPPUNIT_ASSERT(cache.put(1, std::make_shared<Entry>(1)));
+  CPPUNIT_ASSERT(cache.get(1));
+  CPPUNIT_ASSERT_EQUAL((std::uint64_t)1, cache.getNumHits());
+  CPPUNIT_ASSERT_EQUAL((std::uint64_t)1, cache.getNumMisses());
+  CPPUNIT_ASSERT(cache.remove(1));
+  CPPUNIT_ASSERT(!cache.remove(1));
+  // Several threads putting and getting overlapping ranges of ids
+  std::vector<std::thread> workers;
+
+  for (std::uint64_t t = 0; t < 4; ++t) {
+    workers.emplace_back([&cache, t]() {
+      for (std::uint64_t id = t * 500; id < t * 500 + 2000; ++id) {
+        std::shared_ptr<Entry> elem = cache.put(id, std::make_shared<Entry>(id));
+
+        if (!elem || (elem->getId() != id)) {
+          throw std::runtime_error("wrong entry returned by put");
+        }
+
+        elem = cache.get(id - t * 250);
+
+        if (elem && (elem->getId() != id - t * 250)) {
+          throw std::runtime_error("wrong entry returned by get");
+        }
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  CPPUNIT_ASSERT(cache.size() <= max_size);
+  CPPUNIT_ASSERT(cache.getNumEvictions() >= 3500 - max_size);
+}
@@ -0,0 +1,191 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Name and symbolic link target of a file packed into 16 bytes
+//------------------------------------------------------------------------------
+
+#ifndef EOS_NS_COMPACT_NAME_HH
+#define EOS_NS_COMPACT_NAME_HH
+
+#include "namespace/Namespace.hh"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <string>
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Pair of strings (name, link) stored as "name\0link\0". If the whole thing
+//! fits in 15 bytes it is kept inline, otherwise in a single exactly sized
+//! heap block. The last byte of the object tells which one is used.
+//------------------------------------------------------------------------------
+class CompactName
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //----------------------------------------------------------------------------
+  CompactName()
+  {
+    memset(mInline, 0, sizeof(mInline));
+  }
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~CompactName()
+  {
+    release();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Copy constructor
+  //----------------------------------------------------------------------------
+  CompactName(const CompactName& other)
+  {
+    memset(mInline, 0, sizeof(mInline));
+    set(other.getName(), other.getLinkPtr());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Assignment operator
+  //----------------------------------------------------------------------------
+  CompactName& operator = (const CompactName& other)
+  {
+    if (this != &other) {
+      set(other.getName(), other.getLinkPtr());
+    }
+
+    return *this;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get name
+  //----------------------------------------------------------------------------
+  const char* getName() const
+  {
+    return isHeap() ? mHeap.mPtr : mInline;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get link, empty string if not a link
+  //----------------------------------------------------------------------------
+  const char* getLinkPtr() const
+  {
+    const char* name = getName();
+    return name + strlen(name) + 1;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Set the name, the link is preserved
+  //----------------------------------------------------------------------------
+  void setName(const std::string& name)
+  {
+    std::string link = getLinkPtr();
+    set(name.c_str(), link.c_str());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Set the link, the name is preserved
+  //----------------------------------------------------------------------------
+  void setLink(const std::string& link)
+  {
+    std::string name = getName();
+    set(name.c_str(), link.c_str());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Set both name and link
+  //----------------------------------------------------------------------------
+  void set(const char* name, const char* link)
+  {
+    size_t nameLen = strlen(name);
+    size_t linkLen = strlen(link);
+    size_t total = nameLen + linkLen + 2;
+    char* dst = mInline;
+    char* heap = 0;
+
+    if (total >= sizeof(mInline)) {
+      heap = static_cast<char*>(malloc(total));
+
+      if (!heap) {
+        throw std::bad_alloc();
+      }
+
+      dst = heap;
+    }
+
+    // Build the new content before releasing the old one since name and link
+    // might point into it
+    char tmp[sizeof(mInline)];
+
+    if (!heap) {
+      dst = tmp;
+    }
+
+    memcpy(dst, name, nameLen + 1);
+    memcpy(dst + nameLen + 1, link, linkLen + 1);
+    release();
+
+    if (heap) {
+      mHeap.mPtr = heap;
+      mHeap.mSize = total;
+      mInline[sizeof(mInline) - 1] = 1;
+    } else {
+      memset(mInline, 0, sizeof(mInline));
+      memcpy(mInline, tmp, total);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Number of bytes allocated on the heap
+  //----------------------------------------------------------------------------
+  size_t getHeapSize() const
+  {
+    return isHeap() ? mHeap.mSize : 0;
+  }
+
+private:
+  bool isHeap() const
+  {
+    return mInline[sizeof(mInline) - 1] != 0;
+  }
+
+  void release()
+  {
+    if (isHeap()) {
+      free(mHeap.mPtr);
+      memset(mInline, 0, sizeof(mInline));
+    }
+  }
+
+  union {
+    char mInline[16];
+    struct {
+      char*    mPtr;
+      uint32_t mSize;
+    } mHeap;
+  };
+};
+
+EOSNSNAMESPACE_END
+
+#endif // EOS_NS_COMPACT_NAME_HH
@@ -0,0 +1,277 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Vector of trivially copyable elements keeping the first N elements
+//!        inline and spilling to the heap only when it grows beyond that
+//------------------------------------------------------------------------------
+
+#ifndef EOS_NS_INLINE_VECTOR_HH
+#define EOS_NS_INLINE_VECTOR_HH
+
+#include "namespace/Namespace.hh"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <vector>
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Small vector of POD elements. The inline buffer shares its storage with the
+//! heap pointer so for N * sizeof(T) <= 8 the whole object takes 16 bytes.
+//------------------------------------------------------------------------------
+template <typename T, uint16_t N>
+class InlineVector
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //----------------------------------------------------------------------------
+  InlineVector(): mSize(0), mCapacity(N) {}
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~InlineVector()
+  {
+    if (isHeap()) {
+      free(mStorage.mHeap);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Copy constructor
+  //----------------------------------------------------------------------------
+  InlineVector(const InlineVector& other): mSize(0), mCapacity(N)
+  {
+    assign(other.data(), other.size());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Assignment operator
+  //----------------------------------------------------------------------------
+  InlineVector& operator = (const InlineVector& other)
+  {
+    if (this != &other) {
+      assign(other.data(), other.size());
+    }
+
+    return *this;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Assignment from a std::vector
+  //----------------------------------------------------------------------------
+  InlineVector& operator = (const std::vector<T>& other)
+  {
+    assign(other.data(), other.size());
+    return *this;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Conversion to a std::vector
+  //----------------------------------------------------------------------------
+  std::vector<T> toVector() const
+  {
+    return std::vector<T>(begin(), end());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Replace the contents with the given elements
+  //----------------------------------------------------------------------------
+  void assign(const T* elements, size_t count)
+  {
+    mSize = 0;
+    reserve(count);
+
+    if (count) {
+      memcpy(data(), elements, count * sizeof(T));
+    }
+
+    mSize = count;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Make sure that there is space for at least count elements
+  //----------------------------------------------------------------------------
+  void reserve(size_t count)
+  {
+    if (count <= mCapacity) {
+      return;
+    }
+
+    if (count > 0xffff) {
+      throw std::bad_alloc();
+    }
+
+    size_t capacity = mCapacity * 2;
+
+    if (capacity < count) {
+      capacity = count;
+    }
+
+    if (capacity > 0xffff) {
+      capacity = 0xffff;
+    }
+
+    T* heap = static_cast<T*>(malloc(capacity * sizeof(T)));
+
+    if (!heap) {
+      throw std::bad_alloc();
+    }
+
+    if (mSize) {
+      memcpy(heap, data(), mSize * sizeof(T));
+    }
+
+    if (isHeap()) {
+      free(mStorage.mHeap);
+    }
+
+    mStorage.mHeap = heap;
+    mCapacity = capacity;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Append an element
+  //----------------------------------------------------------------------------
+  void push_back(const T& element)
+  {
+    reserve(mSize + 1);
+    data()[mSize++] = element;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove the last element
+  //----------------------------------------------------------------------------
+  void pop_back()
+  {
+    if (mSize) {
+      --mSize;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove the element pointed by the iterator, preserving the order
+  //----------------------------------------------------------------------------
+  T* erase(T* it)
+  {
+    T* last = end();
+
+    if (it + 1 < last) {
+      memmove(it, it + 1, (last - it - 1) * sizeof(T));
+    }
+
+    --mSize;
+    return it;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove all the elements, the heap buffer is released
+  //----------------------------------------------------------------------------
+  void clear()
+  {
+    if (isHeap()) {
+      free(mStorage.mHeap);
+      mCapacity = N;
+    }
+
+    mSize = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Accessors
+  //----------------------------------------------------------------------------
+  size_t size() const
+  {
+    return mSize;
+  }
+
+  bool empty() const
+  {
+    return mSize == 0;
+  }
+
+  T* data()
+  {
+    return isHeap() ? mStorage.mHeap : mStorage.mInline;
+  }
+
+  const T* data() const
+  {
+    return isHeap() ? mStorage.mHeap : mStorage.mInline;
+  }
+
+  T* begin()
+  {
+    return data();
+  }
+
+  T* end()
+  {
+    return data() + mSize;
+  }
+
+  const T* begin() const
+  {
+    return data();
+  }
+
+  const T* end() const
+  {
+    return data() + mSize;
+  }
+
+  T& operator[](size_t index)
+  {
+    return data()[index];
+  }
+
+  const T& operator[](size_t index) const
+  {
+    return data()[index];
+  }
+
+  //----------------------------------------------------------------------------
+  //! Number of bytes allocated on the heap
+  //----------------------------------------------------------------------------
+  size_t getHeapSize() const
+  {
+    return isHeap() ? mCapacity * sizeof(T) : 0;
+  }
+
+private:
+  bool isHeap() const
+  {
+    return mCapacity > N;
+  }
+
+  union Storage {
+    T  mInline[N];
+    T* mHeap;
+  } mStorage;
+
+  uint16_t mSize;
+  uint16_t mCapacity;
+};
+
+EOSNSNAMESPACE_END
+
+#endif // EOS_NS_INLINE_VECTOR_HH
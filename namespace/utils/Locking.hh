@@ -23,6 +23,8 @@
 #ifndef EOS_NS_LOCKING_HH
 #define EOS_NS_LOCKING_HH
 
+#include <pthread.h>
+
 namespace eos
 {
   class LockHandler
@@ -48,6 +50,89 @@ namespace eos
       //------------------------------------------------------------------------
       virtual void unLock() = 0;
   };
+
+  //----------------------------------------------------------------------------
+  //! Reader/writer mutex protecting the internal maps of the namespace
+  //! services. The interface mirrors eos::common::RWMutex.
+  //----------------------------------------------------------------------------
+  class SharedMutex
+  {
+    public:
+      SharedMutex()
+      {
+        pthread_rwlock_init( &pLock, 0 );
+      }
+
+      ~SharedMutex()
+      {
+        pthread_rwlock_destroy( &pLock );
+      }
+
+      void LockRead()
+      {
+        pthread_rwlock_rdlock( &pLock );
+      }
+
+      void UnLockRead()
+      {
+        pthread_rwlock_unlock( &pLock );
+      }
+
+      void LockWrite()
+      {
+        pthread_rwlock_wrlock( &pLock );
+      }
+
+      void UnLockWrite()
+      {
+        pthread_rwlock_unlock( &pLock );
+      }
+
+    private:
+      SharedMutex( const SharedMutex & );
+      SharedMutex &operator = ( const SharedMutex & );
+      pthread_rwlock_t pLock;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Scoped read lock on a SharedMutex
+  //----------------------------------------------------------------------------
+  class SharedMutexReadLock
+  {
+    public:
+      SharedMutexReadLock( SharedMutex &mutex ): pMutex( mutex )
+      {
+        pMutex.LockRead();
+      }
+
+      ~SharedMutexReadLock()
+      {
+        pMutex.UnLockRead();
+      }
+
+    private:
+      SharedMutex &pMutex;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Scoped write lock on a SharedMutex
+  //----------------------------------------------------------------------------
+  class SharedMutexWriteLock
+  {
+    public:
+      SharedMutexWriteLock( SharedMutex &mutex ): pMutex( mutex )
+      {
+        pMutex.LockWrite();
+      }
+
+      ~SharedMutexWriteLock()
+      {
+        pMutex.UnLockWrite();
+      }
+
+    private:
+      SharedMutex &pMutex;
+  };
 }
 
 #endif // EOS_NS_LOCKING_HH
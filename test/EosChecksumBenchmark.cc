@@ -30,17 +30,45 @@
 #include "common/Timing.hh"
 #include "common/StringConversion.hh"
 #include "fst/checksum/ChecksumPlugins.hh"
+#include "fst/checksum/adler32.h"
+#include "fst/checksum/crc32c.h"
 /*-----------------------------------------------------------------------------*/
 #include <XrdPosix/XrdPosixXrootd.hh>
 #include <XrdClient/XrdClient.hh>
 #include <XrdOuc/XrdOucString.hh>
 /*-----------------------------------------------------------------------------*/
+#include <zlib.h>
+/*-----------------------------------------------------------------------------*/
 
 XrdPosixXrootd posixXrootd;
 
 // 1GB mem buffer
 #define MEMORYBUFFERSIZE 256ll*1024ll*1024ll 
 
+typedef uint32_t (*ChecksumImpl)(uint32_t, const void*, size_t);
+
+static uint32_t zlibCrc32(uint32_t crc, const void* data, size_t length) {
+  return crc32(crc, (const Bytef*) data, length);
+}
+
+//------------------------------------------------------------------------------
+// Benchmark a low level checksum implementation over the buffer in blocks
+//------------------------------------------------------------------------------
+static void benchmarkImpl(const char* algorithm, const char* impl,
+                          ChecksumImpl func, uint32_t init,
+                          const char* buffer, unsigned long long blocksize) {
+  eos::common::Timing tm("Checksumming");
+  COMMONTIMING("START",&tm);
+  uint32_t value = init;
+  for (unsigned long long j = 0; j < MEMORYBUFFERSIZE/blocksize; j++) {
+    value = func(value, buffer + j * blocksize, blocksize);
+  }
+  COMMONTIMING("STOP",&tm);
+  XrdOucString sizestring;
+  eos::common::StringConversion::GetReadableSizeString(sizestring, blocksize, "B");
+  eos_static_info("checksum( %-7s %-12s ) = %08x realtime=%.02f [ms] blocksize=%s rate=%.02f [GB/s]", algorithm, impl, value, tm.RealTime(), sizestring.c_str(), MEMORYBUFFERSIZE/tm.RealTime()/1000.0/1000.0);
+}
+
 int main (int argc, char* argv[]) {
   eos::common::Mapping::VirtualIdentity_t vid;
   eos::common::Mapping::Root(vid);
@@ -125,11 +153,34 @@ int main (int argc, char* argv[]) {
 	    COMMONTIMING("STOP",&tm);
 	    XrdOucString sizestring;
 	    eos::common::StringConversion::GetReadableSizeString(sizestring,blocksize[bs], "B");
-	    eos_static_info("checksum( %-10s ) = %s realtime=%.02f [ms] blocksize=%s rate=%.02f", checksumnames[i].c_str(), checksum->GetHexChecksum(), tm.RealTime(), sizestring.c_str(), MEMORYBUFFERSIZE/tm.RealTime()/1000.0);
+	    eos_static_info("checksum( %-10s ) = %s realtime=%.02f [ms] blocksize=%s rate=%.02f [MB/s]", checksumnames[i].c_str(), checksum->GetHexChecksum(), tm.RealTime(), sizestring.c_str(), MEMORYBUFFERSIZE/tm.RealTime()/1000.0);
 	    delete checksum;
 	  }
 	}
       }
+
+      // compare the implementations available on this CPU
+      checksum::adler32(1, buffer, 0);
+      checksum::crc32c(checksum::crc32cInit(), buffer, 0);
+      eos_static_info("selected implementations adler32=%s crc32c=%s", checksum::adler32Name(), checksum::crc32cName());
+      bool hasAvx2 = checksum::adler32HasAvx2();
+      __builtin_cpu_init();
+      bool hasPclmul = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul");
+
+      for (size_t bs = 0; bs < blocksize.size(); bs++) {
+	benchmarkImpl("adler32", "zlib", checksum::adler32Zlib, 1, buffer, blocksize[bs]);
+	if (hasAvx2) {
+	  benchmarkImpl("adler32", "avx2", checksum::adler32Avx2, 1, buffer, blocksize[bs]);
+	}
+	benchmarkImpl("crc32", "zlib", zlibCrc32, 0, buffer, blocksize[bs]);
+	benchmarkImpl("crc32c", "slicing-by-8", checksum::crc32cSlicingBy8, checksum::crc32cInit(), buffer, blocksize[bs]);
+	if (__builtin_cpu_supports("sse4.2")) {
+	  benchmarkImpl("crc32c", "hw64", checksum::crc32cHardware64, checksum::crc32cInit(), buffer, blocksize[bs]);
+	}
+	if (hasPclmul) {
+	  benchmarkImpl("crc32c", "hw64-pclmul", checksum::crc32cHardware64Pclmul, checksum::crc32cInit(), buffer, blocksize[bs]);
+	}
+      }
       exit(0);
     }
   }
@@ -0,0 +1,354 @@
+// ----------------------------------------------------------------------
+// File: EosHttpGetBenchmark.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Throughput and CPU usage of HTTP GET downloads served like the FST
+//!        HTTP server does it, through a reader callback copying the data
+//!        into 4 MB pages, compared to responses created from the file
+//!        descriptor which libmicrohttpd sends with sendfile
+//!
+//! The server runs in the benchmark process with the threading model of the
+//! FST (one thread per connection), the clients are forked so that the CPU
+//! of the server can be measured on its own. Every client downloads the file
+//! entirely or a single range of it and checks the number of bytes received.
+//------------------------------------------------------------------------------
+
+/*----------------------------------------------------------------------------*/
+#include <microhttpd.h>
+/*----------------------------------------------------------------------------*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+/*----------------------------------------------------------------------------*/
+
+//! Source file served by the fixture
+static int gFd = -1;
+static off_t gSize = 0;
+static bool gZeroCopy = false;
+
+//! Range served if the length is not 0
+static off_t gRangeOffset = 0;
+static off_t gRangeLength = 0;
+
+//! Result of one run
+struct Measurement {
+  double mSeconds;
+  double mCpu;
+  int mFailed;
+};
+
+//------------------------------------------------------------------------------
+// User and system CPU time in seconds of the process
+//------------------------------------------------------------------------------
+static double
+CpuSeconds()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+//------------------------------------------------------------------------------
+// Reader callback copying the file through user space like the FST does
+//------------------------------------------------------------------------------
+static ssize_t
+FileReaderCallback(void* cls, uint64_t pos, char* buf, size_t max)
+{
+  off_t offset = gRangeLength ? gRangeOffset + (off_t) pos : (off_t) pos;
+  ssize_t nread = pread(gFd, buf, max, offset);
+
+  if (nread <= 0) {
+    return MHD_CONTENT_READER_END_WITH_ERROR;
+  }
+
+  return nread;
+}
+
+//------------------------------------------------------------------------------
+// Request handler of the fixture
+//------------------------------------------------------------------------------
+static int
+Handler(void* cls, struct MHD_Connection* connection, const char* url,
+        const char* method, const char* version, const char* uploadData,
+        size_t* uploadDataSize, void** ptr)
+{
+  static int dummy;
+
+  // headers only on the first call like the FST
+  if (*ptr != &dummy) {
+    *ptr = &dummy;
+    return MHD_YES;
+  }
+
+  off_t length = gRangeLength ? gRangeLength : gSize;
+  struct MHD_Response* response = 0;
+
+  if (gZeroCopy) {
+    int fd = dup(gFd);
+
+    if (fd < 0) {
+      return MHD_NO;
+    }
+
+#if MHD_VERSION >= 0x00094600
+    response = MHD_create_response_from_fd_at_offset64(length, fd,
+               gRangeLength ? gRangeOffset : 0);
+#else
+    response = MHD_create_response_from_fd_at_offset(length, fd,
+               gRangeLength ? gRangeOffset : 0);
+#endif
+
+    if (!response) {
+      close(fd);
+    }
+  } else {
+    response = MHD_create_response_from_callback(length, 4 * 1024 * 1024,
+               &FileReaderCallback, 0, 0);
+  }
+
+  if (!response) {
+    return MHD_NO;
+  }
+
+  int code = MHD_HTTP_OK;
+
+  if (gRangeLength) {
+    char range[256];
+    snprintf(range, sizeof(range), "bytes %llu-%llu/%llu",
+             (unsigned long long) gRangeOffset,
+             (unsigned long long)(gRangeOffset + gRangeLength - 1),
+             (unsigned long long) gSize);
+    MHD_add_response_header(response, "Content-Range", range);
+    code = MHD_HTTP_PARTIAL_CONTENT;
+  }
+
+  int ret = MHD_queue_response(connection, code, response);
+  MHD_destroy_response(response);
+  return ret;
+}
+
+//------------------------------------------------------------------------------
+// Download the file once, returns 0 if the expected body was received
+//------------------------------------------------------------------------------
+static int
+Download(int port, off_t expected)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if ((sock < 0) || connect(sock, (struct sockaddr*) &addr, sizeof(addr))) {
+    if (sock >= 0) {
+      close(sock);
+    }
+
+    return -1;
+  }
+
+  std::string request = "GET /eoshttpbench HTTP/1.1\r\nHost: localhost\r\n"
+                        "Connection: close\r\n\r\n";
+
+  if (write(sock, request.c_str(), request.length()) !=
+      (ssize_t) request.length()) {
+    close(sock);
+    return -1;
+  }
+
+  std::vector<char> buffer(1024 * 1024);
+  std::string header;
+  off_t body = 0;
+  bool inbody = false;
+  ssize_t nread;
+
+  while ((nread = read(sock, buffer.data(), buffer.size())) > 0) {
+    if (inbody) {
+      body += nread;
+      continue;
+    }
+
+    header.append(buffer.data(), nread);
+    size_t pos = header.find("\r\n\r\n");
+
+    if (pos != std::string::npos) {
+      inbody = true;
+      body = header.length() - pos - 4;
+    }
+  }
+
+  close(sock);
+  return (body == expected) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+// Run ndownloads with nclients forked clients and measure time and server CPU
+//------------------------------------------------------------------------------
+static Measurement
+Measure(int port, int ndownloads, int nclients, bool zerocopy)
+{
+  gZeroCopy = zerocopy;
+  off_t expected = gRangeLength ? gRangeLength : gSize;
+  std::vector<pid_t> pids;
+  double cpu = CpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < nclients; i++) {
+    pid_t pid = fork();
+
+    if (pid == 0) {
+      int failed = 0;
+
+      for (int n = i; n < ndownloads; n += nclients) {
+        if (Download(port, expected)) {
+          failed++;
+        }
+      }
+
+      _exit(failed > 255 ? 255 : failed);
+    }
+
+    if (pid > 0) {
+      pids.push_back(pid);
+    }
+  }
+
+  Measurement m;
+  m.mFailed = 0;
+
+  for (auto pid : pids) {
+    int status = 0;
+
+    if ((waitpid(pid, &status, 0) < 0) || !WIFEXITED(status)) {
+      m.mFailed++;
+    } else {
+      m.mFailed += WEXITSTATUS(status);
+    }
+  }
+
+  m.mSeconds = std::chrono::duration<double>
+               (std::chrono::steady_clock::now() - start).count();
+  m.mCpu = CpuSeconds() - cpu;
+  return m;
+}
+
+static void
+Print(const char* name, const Measurement& m, double bytes)
+{
+  fprintf(stdout, "%-12s %10.2f %12.1f %10.2f %12.2f %8d\n", name, m.mSeconds,
+          bytes / m.mSeconds / 1e6, m.mCpu, m.mCpu / (bytes / 1e9), m.mFailed);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "Usage: eoshttpgetbench <local-dir> [<downloads>] "
+            "[<MB-per-file>] [<clients>] [<range-offset-MB> <range-length-MB>] "
+            "[<port>]\n");
+    return 1;
+  }
+
+  std::string dir = argv[1];
+  int ndownloads = (argc > 2 ? atoi(argv[2]) : 64);
+  gSize = (argc > 3 ? strtoull(argv[3], 0, 10) : 256) * 1024 * 1024;
+  int nclients = (argc > 4 ? atoi(argv[4]) : 8);
+  gRangeOffset = (argc > 6 ? strtoull(argv[5], 0, 10) : 0) * 1024 * 1024;
+  gRangeLength = (argc > 6 ? strtoull(argv[6], 0, 10) : 0) * 1024 * 1024;
+  int port = (argc > 7 ? atoi(argv[7]) : 21098);
+
+  if ((ndownloads <= 0) || (nclients <= 0) || (gSize <= 0) ||
+      (gRangeOffset + gRangeLength > gSize)) {
+    fprintf(stderr, "error: invalid arguments\n");
+    return 1;
+  }
+
+  std::string path = dir + "/eoshttpbench.src";
+  gFd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
+
+  if (gFd < 0) {
+    fprintf(stderr, "error: failed to create %s\n", path.c_str());
+    return 1;
+  }
+
+  std::vector<char> buffer(4 * 1024 * 1024);
+
+  for (size_t i = 0; i < buffer.size(); i++) {
+    buffer[i] = (char)(i * 7 + i / 4093);
+  }
+
+  for (off_t offset = 0; offset < gSize; offset += buffer.size()) {
+    size_t length = (gSize - offset < (off_t) buffer.size()) ?
+                    (gSize - offset) : buffer.size();
+
+    if (pwrite(gFd, buffer.data(), length, offset) != (ssize_t) length) {
+      fprintf(stderr, "error: failed to write %s\n", path.c_str());
+      close(gFd);
+      unlink(path.c_str());
+      return 1;
+    }
+  }
+
+  struct MHD_Daemon* daemon = MHD_start_daemon(
+                                MHD_USE_THREAD_PER_CONNECTION, port, 0, 0,
+                                &Handler, 0,
+                                MHD_OPTION_CONNECTION_LIMIT, nclients + 16,
+                                MHD_OPTION_END);
+
+  if (!daemon) {
+    fprintf(stderr, "error: failed to start the http server on port %d\n",
+            port);
+    close(gFd);
+    unlink(path.c_str());
+    return 1;
+  }
+
+  double bytes = (double)(gRangeLength ? gRangeLength : gSize) * ndownloads;
+  fprintf(stdout, "# downloads=%d size=%lld MB clients=%d range=%lld+%lld MB "
+          "dir=%s\n", ndownloads, (long long)(gSize / (1024 * 1024)), nclients,
+          (long long)(gRangeOffset / (1024 * 1024)),
+          (long long)(gRangeLength / (1024 * 1024)), dir.c_str());
+  fprintf(stdout, "%-12s %10s %12s %10s %12s %8s\n", "method", "time[s]",
+          "rate[MB/s]", "cpu[s]", "cpu[s/GB]", "failed");
+  // warm the page cache, both methods read the same cached data
+  Measure(port, nclients, nclients, true);
+  Measurement callback = Measure(port, ndownloads, nclients, false);
+  Print("callback", callback, bytes);
+  Measurement sendfile = Measure(port, ndownloads, nclients, true);
+  Print("sendfile", sendfile, bytes);
+  MHD_stop_daemon(daemon);
+  close(gFd);
+  unlink(path.c_str());
+  return 0;
+}
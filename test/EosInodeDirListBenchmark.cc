@@ -0,0 +1,379 @@
+// ----------------------------------------------------------------------
+// File: EosInodeDirListBenchmark.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Listing of large directories of the in-memory namespace the way the
+//!        MGM answers the FUSE inodirlist command
+//!
+//! - path: the text listing, every entry is resolved from the root by path
+//!         under its own lock to get the inode and once more for the stat
+//! - id: the binary listing, the children are taken from the container under
+//!       a single lock
+//! - decode: parsing of the binary listing as done by the FUSE client
+//------------------------------------------------------------------------------
+
+/*----------------------------------------------------------------------------*/
+#include "namespace/ns_in_memory/views/HierarchicalView.hh"
+#include "namespace/ns_in_memory/persistency/ChangeLogContainerMDSvc.hh"
+#include "namespace/ns_in_memory/persistency/ChangeLogFileMDSvc.hh"
+#include "common/FileId.hh"
+#include "common/InodeDirList.hh"
+#include "common/RWMutex.hh"
+#include "common/StringConversion.hh"
+/*----------------------------------------------------------------------------*/
+#include "XrdOuc/XrdOucString.hh"
+/*----------------------------------------------------------------------------*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+/*----------------------------------------------------------------------------*/
+
+eos::common::RWMutex nslock;
+
+//------------------------------------------------------------------------------
+// File size mapping function
+//------------------------------------------------------------------------------
+static uint64_t
+mapSize(const eos::IFileMD* file)
+{
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Boot the namespace
+//------------------------------------------------------------------------------
+static eos::IView*
+bootNamespace(const std::string& dirLog, const std::string& fileLog)
+{
+  eos::IContainerMDSvc* contSvc = new eos::ChangeLogContainerMDSvc();
+  eos::IFileMDSvc* fileSvc = new eos::ChangeLogFileMDSvc();
+  eos::IView* view = new eos::HierarchicalView();
+  std::map<std::string, std::string> fileSettings;
+  std::map<std::string, std::string> contSettings;
+  std::map<std::string, std::string> settings;
+  contSettings["changelog_path"] = dirLog;
+  fileSettings["changelog_path"] = fileLog;
+  fileSvc->configure(fileSettings);
+  contSvc->configure(contSettings);
+  contSvc->setFileMDService(fileSvc);
+  fileSvc->setContMDService(contSvc);
+  ((eos::ChangeLogFileMDSvc*)fileSvc)->setContMDService((
+        eos::ChangeLogContainerMDSvc*)contSvc);
+  view->setContainerMDSvc(contSvc);
+  view->setFileMDSvc(fileSvc);
+  view->configure(settings);
+  view->getQuotaStats()->registerSizeMapper(mapSize);
+  view->initialize();
+  return view;
+}
+
+//------------------------------------------------------------------------------
+// Close the namespace
+//------------------------------------------------------------------------------
+static void
+closeNamespace(eos::IView* view)
+{
+  eos::IContainerMDSvc* contSvc = view->getContainerMDSvc();
+  eos::IFileMDSvc* fileSvc = view->getFileMDSvc();
+  view->finalize();
+  delete view;
+  delete contSvc;
+  delete fileSvc;
+}
+
+//------------------------------------------------------------------------------
+// Stat fields of a file, as filled by the MGM
+//------------------------------------------------------------------------------
+static void
+fileFields(eos::IFileMD* fmd, uint64_t* fields)
+{
+  eos::IFileMD::ctime_t ctime;
+  eos::IFileMD::ctime_t mtime;
+  fmd->getCTime(ctime);
+  fmd->getMTime(mtime);
+  fields[0] = mtime.tv_nsec;
+  fields[1] = mtime.tv_sec;
+  fields[2] = 512;
+  fields[3] = fmd->getSize() / 512;
+  fields[4] = ctime.tv_nsec;
+  fields[5] = ctime.tv_sec;
+  fields[6] = 0xcaff;
+  fields[7] = fmd->getCGid();
+  fields[8] = eos::common::FileId::FidToInode(fmd->getId());
+  fields[9] = S_IFREG | (fmd->getFlags() ? fmd->getFlags() : 0644);
+  fields[10] = mtime.tv_nsec;
+  fields[11] = mtime.tv_sec;
+  fields[12] = fmd->getNumLocation();
+  fields[13] = 0;
+  fields[14] = fmd->getSize();
+  fields[15] = fmd->getCUid();
+}
+
+//------------------------------------------------------------------------------
+// Stat fields of a container, as filled by the MGM
+//------------------------------------------------------------------------------
+static void
+containerFields(eos::IContainerMD* cmd, uint64_t* fields)
+{
+  eos::IContainerMD::ctime_t ctime;
+  eos::IContainerMD::ctime_t mtime;
+  cmd->getCTime(ctime);
+  cmd->getMTime(mtime);
+  fields[0] = mtime.tv_nsec;
+  fields[1] = mtime.tv_sec;
+  fields[2] = cmd->getNumContainers() + cmd->getNumFiles();
+  fields[3] = 0;
+  fields[4] = ctime.tv_nsec;
+  fields[5] = ctime.tv_sec;
+  fields[6] = 0xcaff;
+  fields[7] = cmd->getCGid();
+  fields[8] = cmd->getId();
+  fields[9] = cmd->getMode();
+  fields[10] = mtime.tv_nsec;
+  fields[11] = mtime.tv_sec;
+  fields[12] = 1;
+  fields[13] = 0;
+  fields[14] = cmd->getTreeSize();
+  fields[15] = cmd->getCUid();
+}
+
+//------------------------------------------------------------------------------
+// Text listing resolving every entry by path
+//------------------------------------------------------------------------------
+static size_t
+listByPath(eos::IView* view, const std::string& dir, std::string& out)
+{
+  std::set<std::string> names;
+  {
+    eos::common::RWMutexReadLock lock(nslock);
+    std::shared_ptr<eos::IContainerMD> cont = view->getContainer(dir);
+    names = cont->getNameFiles();
+    std::set<std::string> dnames = cont->getNameContainers();
+    names.insert(dnames.begin(), dnames.end());
+  }
+  XrdOucString result = "inodirlist: retc=0 ";
+
+  for (auto it = names.begin(); it != names.end(); ++it) {
+    std::string path = dir + "/" + *it;
+    std::shared_ptr<eos::IFileMD> fmd;
+    std::shared_ptr<eos::IContainerMD> cmd;
+    unsigned long long inode = 0;
+    uint64_t fields[eos::common::InodeDirList::kStatFields];
+
+    try {
+      eos::common::RWMutexReadLock lock(nslock);
+      fmd = view->getFile(path);
+      inode = fmd->getId() << 28;
+    } catch (eos::MDException& e) {}
+
+    if (!fmd) {
+      try {
+        eos::common::RWMutexReadLock lock(nslock);
+        cmd = view->getContainer(path);
+        inode = cmd->getId();
+      } catch (eos::MDException& e) {}
+    }
+
+    {
+      // the stat resolves the path once more
+      eos::common::RWMutexReadLock lock(nslock);
+
+      try {
+        fileFields(view->getFile(path).get(), fields);
+      } catch (eos::MDException& e) {
+        containerFields(view->getContainer(path).get(), fields);
+      }
+    }
+
+    char cbuf[1024];
+    char* ss = cbuf;
+    *(ss++) = '{';
+
+    for (size_t i = 0; i < eos::common::InodeDirList::kStatFields; i++) {
+      ss = eos::common::StringConversion::FastUnsignedToAsciiHex(fields[i], ss);
+      *(ss++) = (i + 1 < eos::common::InodeDirList::kStatFields) ? ',' : '}';
+    }
+
+    *(ss++) = ' ';
+    *(ss++) = 0;
+    char inodestr[64];
+    snprintf(inodestr, sizeof(inodestr), " %llu ", inode);
+    result += it->c_str();
+    result += inodestr;
+    result += cbuf;
+  }
+
+  out = result.c_str();
+  return names.size();
+}
+
+//------------------------------------------------------------------------------
+// Binary listing from the children of the container
+//------------------------------------------------------------------------------
+static size_t
+listById(eos::IView* view, const std::string& dir, std::string& out)
+{
+  uint64_t fields[eos::common::InodeDirList::kStatFields];
+  eos::common::RWMutexReadLock lock(nslock);
+  std::shared_ptr<eos::IContainerMD> cont = view->getContainer(dir);
+  std::set<std::string> names = cont->getNameFiles();
+  size_t nentries = names.size() + cont->getNumContainers();
+  out = "inodirlist_binary: retc=0 ";
+  out.reserve(out.length() + (nentries + 2) * 160);
+  eos::common::InodeDirList::Append(out, ".", 1, cont->getId(), 0);
+  eos::common::InodeDirList::Append(out, "..", 2, cont->getParentId(), 0);
+
+  for (auto it = names.begin(); it != names.end(); ++it) {
+    std::shared_ptr<eos::IFileMD> fmd = cont->findFile(*it);
+    fileFields(fmd.get(), fields);
+    eos::common::InodeDirList::Append(out, it->c_str(), it->length(),
+                                      eos::common::FileId::FidToInode(fmd->getId()), fields);
+  }
+
+  names = cont->getNameContainers();
+
+  for (auto it = names.begin(); it != names.end(); ++it) {
+    std::shared_ptr<eos::IContainerMD> cmd = cont->findContainer(*it);
+    containerFields(cmd.get(), fields);
+    eos::common::InodeDirList::Append(out, it->c_str(), it->length(),
+                                      cmd->getId(), fields);
+  }
+
+  return nentries;
+}
+
+//------------------------------------------------------------------------------
+// Parse a binary listing
+//------------------------------------------------------------------------------
+static size_t
+decode(const std::string& reply)
+{
+  size_t pos = reply.find(' ', reply.find(' ') + 1) + 1;
+  size_t nentries = 0;
+  size_t len;
+  const char* name;
+  uint32_t namelen;
+  uint64_t inode;
+  uint64_t fields[eos::common::InodeDirList::kStatFields];
+  bool hasstat;
+
+  while ((len = eos::common::InodeDirList::Parse(reply.data() + pos,
+                reply.length() - pos, name, namelen, inode, fields,
+                hasstat))) {
+    pos += len;
+    nentries++;
+  }
+
+  return (pos == reply.length()) ? nentries - 2 : 0;
+}
+
+static void
+print(size_t entries, const char* method, double seconds, size_t listed,
+      size_t bytes)
+{
+  fprintf(stdout, "%10zu %-8s %10.3f %14.0f %14zu %10s\n", entries, method,
+          seconds, listed / seconds, bytes, (listed == entries) ? "ok" : "error");
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage:" << std::endl;
+    std::cerr << "  eosinodirlistbench directory.log file.log [<entries> ...]"
+              << std::endl;
+    std::cerr << "  - lists directories of 1000, 100000 and 1000000 entries by "
+              "default, one in hundred is a directory" << std::endl;
+    return 1;
+  }
+
+  std::vector<size_t> sizes;
+
+  for (int i = 3; i < argc; i++) {
+    sizes.push_back(strtoull(argv[i], 0, 10));
+  }
+
+  if (sizes.empty()) {
+    sizes = {1000, 100000, 1000000};
+  }
+
+  unlink(argv[1]);
+  unlink(argv[2]);
+
+  try {
+    eos::IView* view = bootNamespace(argv[1], argv[2]);
+    fprintf(stdout, "%10s %-8s %10s %14s %14s %10s\n", "entries", "method",
+            "time[s]", "entries/s", "reply[bytes]", "result");
+
+    for (auto size : sizes) {
+      char dir[256];
+      snprintf(dir, sizeof(dir), "/eos/dirlist/%zu", size);
+      std::shared_ptr<eos::IContainerMD> cont = view->createContainer(dir, true);
+
+      for (size_t n = 0; n < size; n++) {
+        char name[1024];
+        snprintf(name, sizeof(name), "%s/entry.%08zu", dir, n);
+
+        if (n % 100 == 99) {
+          view->createContainer(name, false);
+        } else {
+          std::shared_ptr<eos::IFileMD> fmd = view->createFile(name, 0, 0);
+          fmd->addLocation(1);
+          fmd->addLocation(2);
+          fmd->setSize(n);
+          view->updateFileStore(fmd.get());
+        }
+      }
+
+      std::string reply;
+      auto start = std::chrono::steady_clock::now();
+      size_t listed = listByPath(view, dir, reply);
+      double seconds = std::chrono::duration<double>
+                       (std::chrono::steady_clock::now() - start).count();
+      print(size, "path", seconds, listed, reply.length());
+      start = std::chrono::steady_clock::now();
+      listed = listById(view, dir, reply);
+      seconds = std::chrono::duration<double>
+                (std::chrono::steady_clock::now() - start).count();
+      print(size, "id", seconds, listed, reply.length());
+      start = std::chrono::steady_clock::now();
+      listed = decode(reply);
+      seconds = std::chrono::duration<double>
+                (std::chrono::steady_clock::now() - start).count();
+      print(size, "decode", seconds, listed, reply.length());
+    }
+
+    closeNamespace(view);
+  } catch (eos::MDException& e) {
+    std::cerr << "[!] Error: " << e.getMessage().str() << std::endl;
+    return 2;
+  }
+
+  unlink(argv[1]);
+  unlink(argv[2]);
+  return 0;
+}
@@ -0,0 +1,277 @@
+// ----------------------------------------------------------------------
+// File: EosRainParityBenchmark.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Parity encoding throughput of the RAIN layouts: the previous
+//!        pairwise XOR of RAID-DP and the jerasure schedule of Reed-Solomon
+//!        compared to the fused schedules with every available XOR kernel
+//------------------------------------------------------------------------------
+
+/*----------------------------------------------------------------------------*/
+#include "fst/layout/ParityKernels.hh"
+/*----------------------------------------------------------------------------*/
+extern "C" {
+#include "jerasure.h"
+#include "cauchy.h"
+}
+/*----------------------------------------------------------------------------*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+/*----------------------------------------------------------------------------*/
+
+using eos::fst::XorSchedule;
+
+typedef long v2do __attribute__((vector_size(16)));
+
+//------------------------------------------------------------------------------
+// Previous RAID-DP block XOR: one pass over both inputs per pair of blocks
+//------------------------------------------------------------------------------
+static void
+LegacyXOR(char* pBlock1, char* pBlock2, char* pResult, size_t totalBytes)
+{
+  v2do* idx1 = (v2do*) pBlock1;
+  v2do* idx2 = (v2do*) pBlock2;
+  v2do* xor_res = (v2do*) pResult;
+  size_t noPices = totalBytes / sizeof(v2do);
+
+  for (size_t i = 0; i < noPices; idx1++, idx2++, xor_res++, i++) {
+    *xor_res = *idx1 ^ *idx2;
+  }
+
+  for (size_t i = noPices * sizeof(v2do); i < totalBytes; i++) {
+    pResult[i] = pBlock1[i] ^ pBlock2[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+// Previous RaidDpLayout::ComputeParity
+//------------------------------------------------------------------------------
+static void
+LegacyRaidDp(std::vector<char*>& blocks, unsigned int nb_data, size_t width)
+{
+  unsigned int nb_total_files = nb_data + 2;
+  unsigned int nb_total_blocks = nb_data * nb_total_files;
+  int index_pblock;
+  int current_block;
+
+  for (unsigned int i = 0; i < nb_data; i++) {
+    index_pblock = (i + 1) * nb_data + 2 * i;
+    current_block = i * (nb_data + 2);
+    LegacyXOR(blocks[current_block], blocks[current_block + 1],
+              blocks[index_pblock], width);
+    current_block += 2;
+
+    while (current_block < index_pblock) {
+      LegacyXOR(blocks[index_pblock], blocks[current_block],
+                blocks[index_pblock], width);
+      current_block++;
+    }
+  }
+
+  unsigned int aux_block;
+  unsigned int next_block;
+  unsigned int index_dpblock;
+  unsigned int jump_blocks = nb_total_files + 1;
+  std::vector<unsigned int> used_blocks;
+
+  for (unsigned int i = 0; i < nb_data; i++) {
+    used_blocks.push_back((i + 1) * (nb_data + 1) + i);
+  }
+
+  for (unsigned int i = 0; i < nb_data; i++) {
+    index_dpblock = (i + 1) * (nb_data + 1) + i;
+    next_block = i + jump_blocks;
+    LegacyXOR(blocks[i], blocks[next_block], blocks[index_dpblock], width);
+    used_blocks.push_back(i);
+    used_blocks.push_back(next_block);
+
+    for (unsigned int j = 0; j < nb_data - 2; j++) {
+      aux_block = next_block + jump_blocks;
+
+      if ((aux_block < nb_total_blocks) &&
+          (std::find(used_blocks.begin(), used_blocks.end(),
+                     aux_block) == used_blocks.end())) {
+        next_block = aux_block;
+      } else {
+        next_block++;
+
+        while (std::find(used_blocks.begin(), used_blocks.end(),
+                         next_block) != used_blocks.end()) {
+          next_block++;
+        }
+      }
+
+      LegacyXOR(blocks[index_dpblock], blocks[next_block],
+                blocks[index_dpblock], width);
+      used_blocks.push_back(next_block);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Allocate and fill nblocks blocks of the given size
+//------------------------------------------------------------------------------
+static std::vector<char*>
+AllocBlocks(unsigned int nblocks, size_t size)
+{
+  std::mt19937 gen(nblocks);
+  std::vector<char*> blocks(nblocks);
+
+  for (auto& block : blocks) {
+    if (posix_memalign((void**) &block, 64, size)) {
+      fprintf(stderr, "error: failed to allocate blocks\n");
+      exit(1);
+    }
+
+    for (size_t i = 0; i < size; i++) {
+      block[i] = (char) gen();
+    }
+  }
+
+  return blocks;
+}
+
+static void
+FreeBlocks(std::vector<char*>& blocks)
+{
+  for (auto block : blocks) {
+    free(block);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Run the encoding enough times to process about total bytes of data and
+// return the throughput in GB/s of data encoded
+//------------------------------------------------------------------------------
+static double
+Measure(const std::function<void()>& encode, size_t group_bytes, size_t total)
+{
+  size_t rounds = std::max<size_t>(1, total / group_bytes);
+  encode(); // warm-up
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < rounds; i++) {
+    encode();
+  }
+
+  double seconds = std::chrono::duration<double>
+                   (std::chrono::steady_clock::now() - start).count();
+  return (1.0 * rounds * group_bytes) / seconds / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t total = 4ull * 1024 * 1024 * 1024;
+  size_t width = 1024 * 1024;
+
+  if (argc > 1) {
+    total = strtoull(argv[1], 0, 10) * 1024 * 1024;
+  }
+
+  if (argc > 2) {
+    width = strtoull(argv[2], 0, 10) * 1024;
+  }
+
+  if (!total || !width || (width % (8 * 1024))) {
+    fprintf(stderr, "Usage: eosrainparitybench [<MB-per-test> "
+            "[<KB-block-size, multiple of 8>]]\n");
+    return 1;
+  }
+
+  std::vector<std::string> kernels = eos::fst::GetXorKernels();
+  fprintf(stdout, "# block-size=%zu bytes, data per test=%zu MB, "
+          "default kernel=%s\n", width, total / (1024 * 1024),
+          eos::fst::GetXorKernel());
+  fprintf(stdout, "%-8s %-8s %12s", "layout", "geometry", "legacy");
+
+  for (auto& kernel : kernels) {
+    fprintf(stdout, " %12s", kernel.c_str());
+  }
+
+  fprintf(stdout, "   (GB/s)\n");
+
+  // RAID-DP: nb_data x (nb_data + 2) blocks, nb_data * nb_data hold data
+  for (unsigned int nb_data : {4u, 6u, 8u}) {
+    std::vector<char*> blocks = AllocBlocks(nb_data * (nb_data + 2), width);
+    size_t data_bytes = nb_data * nb_data * width;
+    char geometry[32];
+    snprintf(geometry, sizeof(geometry), "%u+2", nb_data);
+    fprintf(stdout, "%-8s %-8s %12.2f", "raiddp", geometry,
+            Measure([&]() {
+      LegacyRaidDp(blocks, nb_data, width);
+    }, data_bytes, total));
+    XorSchedule schedule = XorSchedule::RaidDp(nb_data, width);
+
+    for (auto& kernel : kernels) {
+      eos::fst::SetXorKernel(kernel);
+      fprintf(stdout, " %12.2f", Measure([&]() {
+        schedule.Execute(blocks, width);
+      }, data_bytes, total));
+    }
+
+    fprintf(stdout, "\n");
+    FreeBlocks(blocks);
+  }
+
+  // Reed-Solomon: Cauchy bit-matrix code with w = 8 as used by ReedSLayout
+  const int w = 8;
+
+  for (auto km : std::vector<std::pair<int, int>> {{4, 2}, {10, 3}, {12, 4}}) {
+    int k = km.first;
+    int m = km.second;
+    size_t packet_size = width / (w * sizeof(int));
+    std::vector<char*> blocks = AllocBlocks(k + m, width);
+    int* matrix = cauchy_good_general_coding_matrix(k, m, w);
+    int* bitmatrix = jerasure_matrix_to_bitmatrix(k, m, w, matrix);
+    int** jschedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+    char geometry[32];
+    snprintf(geometry, sizeof(geometry), "%d+%d", k, m);
+    fprintf(stdout, "%-8s %-8s %12.2f", "reeds", geometry,
+            Measure([&]() {
+      jerasure_schedule_encode(k, m, w, jschedule, blocks.data(),
+                               blocks.data() + k, width, packet_size);
+    }, k * width, total));
+    XorSchedule schedule = XorSchedule::Bitmatrix(k, m, w, bitmatrix,
+                           packet_size);
+
+    for (auto& kernel : kernels) {
+      eos::fst::SetXorKernel(kernel);
+      fprintf(stdout, " %12.2f", Measure([&]() {
+        schedule.Execute(blocks, width);
+      }, k * width, total));
+    }
+
+    fprintf(stdout, "\n");
+    jerasure_free_schedule(jschedule);
+    free(bitmatrix);
+    free(matrix);
+    FreeBlocks(blocks);
+  }
+
+  return 0;
+}
@@ -0,0 +1,251 @@
+// ----------------------------------------------------------------------
+// File: EosTransferBenchmark.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Throughput and CPU usage of many concurrent transfers executed by
+//!        the in-process TransferExecutor compared to forking one eoscp per
+//!        transfer as the FST transfer queues did before
+//!
+//! The directory is either local, the executor then uses file:// urls, or a
+//! root://host:port//path/ url of a running xrootd server. Only the CPU of the
+//! benchmark process and of its children is measured, the server is the same
+//! for both methods.
+//------------------------------------------------------------------------------
+
+/*----------------------------------------------------------------------------*/
+#include "fst/txqueue/TransferExecutor.hh"
+/*----------------------------------------------------------------------------*/
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClFileSystem.hh"
+/*----------------------------------------------------------------------------*/
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+/*----------------------------------------------------------------------------*/
+
+using eos::fst::TransferExecutor;
+
+//! Result of one run
+struct Measurement {
+  double mSeconds;
+  double mCpu;
+  int mFailed;
+};
+
+//------------------------------------------------------------------------------
+// User and system CPU time in seconds of the process or of its children
+//------------------------------------------------------------------------------
+static double
+CpuSeconds(int who)
+{
+  struct rusage usage;
+  getrusage(who, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+//------------------------------------------------------------------------------
+// Run ntx copies with nparallel worker threads and measure time and CPU
+//------------------------------------------------------------------------------
+static Measurement
+Measure(const std::function<int(int)>& copy, int ntx, int nparallel, int who)
+{
+  std::atomic<int> next(0);
+  std::atomic<int> failed(0);
+  std::vector<std::thread> workers;
+  double cpu = CpuSeconds(who);
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < nparallel; i++) {
+    workers.push_back(std::thread([&]() {
+      int n;
+
+      while ((n = next++) < ntx) {
+        if (copy(n)) {
+          failed++;
+        }
+      }
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  Measurement m;
+  m.mSeconds = std::chrono::duration<double>
+               (std::chrono::steady_clock::now() - start).count();
+  m.mCpu = CpuSeconds(who) - cpu;
+  m.mFailed = failed;
+  return m;
+}
+
+//------------------------------------------------------------------------------
+// Write the source file
+//------------------------------------------------------------------------------
+static bool
+CreateSource(const std::string& url, size_t size)
+{
+  XrdCl::File file;
+  std::vector<char> buffer(4 * 1024 * 1024);
+
+  for (size_t i = 0; i < buffer.size(); i++) {
+    buffer[i] = (char)(i * 7 + i / 4093);
+  }
+
+  if (!file.Open(url, XrdCl::OpenFlags::Delete | XrdCl::OpenFlags::Update,
+                 XrdCl::Access::UR | XrdCl::Access::UW).IsOK()) {
+    return false;
+  }
+
+  for (size_t offset = 0; offset < size; offset += buffer.size()) {
+    uint32_t length = (uint32_t)((size - offset < buffer.size()) ?
+                                 (size - offset) : buffer.size());
+
+    if (!file.Write(offset, length, buffer.data()).IsOK()) {
+      return false;
+    }
+  }
+
+  return file.Close().IsOK();
+}
+
+static void
+Print(const char* name, const Measurement& m, size_t bytes)
+{
+  fprintf(stdout, "%-12s %10.2f %12.1f %10.2f %12.2f %8d\n", name, m.mSeconds,
+          bytes / m.mSeconds / 1e6, m.mCpu, m.mCpu / (bytes / 1e9), m.mFailed);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "Usage: eostxbench <local-dir>|<root://host:port//dir/> "
+            "[<transfers>] [<MB-per-file>] [<parallel>] [<buffers>] "
+            "[<KB-buffer-size>] [<eoscp-path>]\n");
+    return 1;
+  }
+
+  std::string dir = argv[1];
+  int ntx = (argc > 2 ? atoi(argv[2]) : 32);
+  size_t size = (argc > 3 ? strtoull(argv[3], 0, 10) : 256) * 1024 * 1024;
+  int nparallel = (argc > 4 ? atoi(argv[4]) : 8);
+  uint32_t nbuffers = (argc > 5 ? atoi(argv[5]) :
+                       TransferExecutor::sDefaultBuffers);
+  uint32_t buffersize = (argc > 6 ? atoi(argv[6]) * 1024 :
+                         TransferExecutor::sDefaultBufferSize);
+  std::string eoscp = (argc > 7 ? argv[7] : "eoscp");
+
+  if ((ntx <= 0) || (nparallel <= 0) || !nbuffers || !buffersize) {
+    fprintf(stderr, "error: invalid arguments\n");
+    return 1;
+  }
+
+  if (dir[dir.length() - 1] != '/') {
+    dir += '/';
+  }
+
+  // eoscp takes local paths, XrdCl needs file:// urls for them
+  bool local = (dir.compare(0, 7, "root://") != 0);
+
+  if (local && (dir[0] != '/')) {
+    fprintf(stderr, "error: the local directory has to be an absolute path\n");
+    return 1;
+  }
+
+  std::string urlprefix = (local ? "file://localhost" + dir : dir);
+  std::string src = "eostxbench.src";
+  std::vector<std::string> dsts;
+
+  for (int i = 0; i < ntx; i++) {
+    dsts.push_back("eostxbench.dst." + std::to_string(i));
+  }
+
+  if (!CreateSource(urlprefix + src, size)) {
+    fprintf(stderr, "error: failed to create %s%s\n", urlprefix.c_str(),
+            src.c_str());
+    return 1;
+  }
+
+  fprintf(stdout, "# transfers=%d size=%zu MB parallel=%d buffers=%u x %u KB "
+          "dir=%s\n", ntx, size / (1024 * 1024), nparallel, nbuffers,
+          buffersize / 1024, dir.c_str());
+  fprintf(stdout, "%-12s %10s %12s %10s %12s %8s\n", "method", "time[s]",
+          "rate[MB/s]", "cpu[s]", "cpu[s/GB]", "failed");
+  Measurement inprocess = Measure([&](int n) {
+    TransferExecutor executor(urlprefix + src, urlprefix + dsts[n], 0,
+                              nbuffers, buffersize);
+    executor.SetChecksum("adler");
+    return executor.Run();
+  }, ntx, nparallel, RUSAGE_SELF);
+  Print("in-process", inprocess, size * ntx);
+  Measurement forked = Measure([&](int n) {
+    std::string from = (local ? dir : urlprefix) + src;
+    std::string to = (local ? dir : urlprefix) + dsts[n];
+    pid_t pid = fork();
+
+    if (pid == 0) {
+      execlp(eoscp.c_str(), eoscp.c_str(), "-n", "-s", "-X", "adler",
+             from.c_str(), to.c_str(), (char*) 0);
+      _exit(127);
+    }
+
+    int status = 0;
+
+    if ((pid < 0) || (waitpid(pid, &status, 0) < 0)) {
+      return -1;
+    }
+
+    return (WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+  }, ntx, nparallel, RUSAGE_CHILDREN);
+  Print("eoscp", forked, size * ntx);
+  std::vector<std::string> names = dsts;
+  names.push_back(src);
+
+  if (local) {
+    for (auto& name : names) {
+      unlink((dir + name).c_str());
+    }
+  } else {
+    XrdCl::URL url(urlprefix);
+    XrdCl::FileSystem fs(url);
+    std::string path = url.GetPath();
+
+    if (path.empty() || (path[0] != '/')) {
+      path = "/" + path;
+    }
+
+    for (auto& name : names) {
+      fs.Rm(path + name);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,273 @@
+// ----------------------------------------------------------------------
+// File: EosFuseReadCacheBenchmark.cc
+// ----------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2017 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Read patterns of the FUSE client with and without the read page
+//!        cache, against files held in memory with a fixed latency per remote
+//!        read standing for the round trip to the FST
+//!
+//! - header: every thread reads the first and the last 64 KB of random files
+//!           in small pieces, like ROOT opening files or loaders mapping the
+//!           same shared libraries
+//! - sequential: every thread reads whole files in 128 KB requests, the
+//!               largest request size of the kernel
+//! - random: 4 KB reads anywhere in the files, with little reuse
+//!
+//! Every byte returned is checked against the content of the file.
+//------------------------------------------------------------------------------
+
+/*----------------------------------------------------------------------------*/
+#include "fuse/FuseCache/FuseReadCache.hh"
+/*----------------------------------------------------------------------------*/
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+/*----------------------------------------------------------------------------*/
+
+//! Content and latency of the remote files
+static std::vector<std::string> gFiles;
+static unsigned int gLatencyUs = 500;
+
+//! Remote reads of a run
+static std::atomic<uint64_t> gFetches(0);
+static std::atomic<uint64_t> gFetchedBytes(0);
+
+//! Result of one run
+struct Measurement {
+  double mSeconds;
+  uint64_t mBytes;
+  uint64_t mErrors;
+};
+
+//------------------------------------------------------------------------------
+// Remote read of a file
+//------------------------------------------------------------------------------
+static ssize_t
+RemoteRead(size_t file, char* buf, off_t off, size_t len)
+{
+  const std::string& data = gFiles[file];
+  gFetches++;
+  usleep(gLatencyUs);
+
+  if ((size_t) off >= data.size()) {
+    return 0;
+  }
+
+  size_t nread = std::min(len, data.size() - off);
+  memcpy(buf, data.data() + off, nread);
+  gFetchedBytes += nread;
+  return nread;
+}
+
+//------------------------------------------------------------------------------
+// Read through the cache or directly and check the data
+//------------------------------------------------------------------------------
+static bool
+Read(FuseReadCache* cache, size_t file, char* buf, off_t off, size_t len,
+     uint64_t& bytes)
+{
+  ssize_t nread;
+
+  if (cache) {
+    nread = cache->Read(file + 1, buf, off, len,
+    [file](char* b, off_t o, size_t l) {
+      return RemoteRead(file, b, o, l);
+    });
+  } else {
+    nread = RemoteRead(file, buf, off, len);
+  }
+
+  const std::string& data = gFiles[file];
+  size_t expected = ((size_t) off >= data.size()) ? 0 :
+                    std::min(len, data.size() - off);
+
+  if ((nread != (ssize_t) expected) ||
+      memcmp(buf, data.data() + off, expected)) {
+    return false;
+  }
+
+  bytes += nread;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Run a read pattern with nthreads threads
+//------------------------------------------------------------------------------
+static Measurement
+Measure(int nthreads,
+        const std::function<void(int, uint64_t&, uint64_t&)>& pattern)
+{
+  std::atomic<uint64_t> bytes(0);
+  std::atomic<uint64_t> errors(0);
+  std::vector<std::thread> threads;
+  gFetches = 0;
+  gFetchedBytes = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < nthreads; i++) {
+    threads.push_back(std::thread([&, i]() {
+      uint64_t b = 0;
+      uint64_t e = 0;
+      pattern(i, b, e);
+      bytes += b;
+      errors += e;
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Measurement m;
+  m.mSeconds = std::chrono::duration<double>
+               (std::chrono::steady_clock::now() - start).count();
+  m.mBytes = bytes;
+  m.mErrors = errors;
+  return m;
+}
+
+static void
+Print(const char* pattern, const char* method, const Measurement& m,
+      FuseReadCache* cache)
+{
+  double hitrate = 0;
+
+  if (cache) {
+    FuseReadCache::Stats stats = cache->GetStats();
+    uint64_t naccess = stats.mHits + stats.mMisses;
+    hitrate = naccess ? 100.0 * stats.mHits / naccess : 0;
+  }
+
+  fprintf(stdout, "%-12s %-8s %10.3f %12.1f %10llu %12.1f %8.1f %8llu\n",
+          pattern, method, m.mSeconds, m.mBytes / m.mSeconds / 1e6,
+          (unsigned long long) gFetches, gFetchedBytes / 1e6, hitrate,
+          (unsigned long long) m.mErrors);
+}
+
+int main(int argc, char* argv[])
+{
+  int nfiles = (argc > 1 ? atoi(argv[1]) : 64);
+  size_t size = (argc > 2 ? strtoull(argv[2], 0, 10) : 16) * 1024 * 1024;
+  int nthreads = (argc > 3 ? atoi(argv[3]) : 16);
+  int nreads = (argc > 4 ? atoi(argv[4]) : 256);
+  gLatencyUs = (argc > 5 ? atoi(argv[5]) : 500);
+  size_t cachesize = (argc > 6 ? strtoull(argv[6], 0, 10) : 256) * 1024 * 1024;
+  size_t pagesize = (argc > 7 ? strtoull(argv[7], 0, 10) : 128) * 1024;
+
+  if ((argc > 1) && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+    fprintf(stderr, "Usage: eosfusereadcachebench [<files>] [<MB-per-file>] "
+            "[<threads>] [<reads-per-thread>] [<latency-us>] [<cache-MB>] "
+            "[<KB-page-size>]\n");
+    return 1;
+  }
+
+  if ((nfiles <= 0) || (size < 256 * 1024) || (nthreads <= 0) ||
+      (nreads <= 0) || !pagesize) {
+    fprintf(stderr, "error: invalid arguments\n");
+    return 1;
+  }
+
+  // files of slightly different sizes, so that the last page is short
+  for (int i = 0; i < nfiles; i++) {
+    std::string data(size - i * 513, 0);
+
+    for (size_t j = 0; j < data.size(); j++) {
+      data[j] = (char)(j * 7 + j / 4093 + i);
+    }
+
+    gFiles.push_back(data);
+  }
+
+  std::function<void(int, uint64_t&, uint64_t&)> header, sequential, random;
+  FuseReadCache* cache = 0;
+  header = [&](int id, uint64_t & bytes, uint64_t & errors) {
+    std::mt19937 gen(id);
+    std::vector<char> buf(64 * 1024);
+
+    for (int n = 0; n < nreads; n++) {
+      size_t file = gen() % nfiles;
+      size_t fsize = gFiles[file].size();
+
+      for (off_t off = 0; off < 64 * 1024; off += 16 * 1024) {
+        if (!Read(cache, file, buf.data(), off, 16 * 1024, bytes)) {
+          errors++;
+        }
+      }
+
+      if (!Read(cache, file, buf.data(), fsize - 64 * 1024, 64 * 1024, bytes)) {
+        errors++;
+      }
+    }
+  };
+  sequential = [&](int id, uint64_t & bytes, uint64_t & errors) {
+    std::vector<char> buf(128 * 1024);
+
+    for (int file = id; file < nfiles; file += nthreads) {
+      for (off_t off = 0; off < (off_t) gFiles[file].size(); off += buf.size()) {
+        if (!Read(cache, file, buf.data(), off, buf.size(), bytes)) {
+          errors++;
+        }
+      }
+    }
+  };
+  random = [&](int id, uint64_t & bytes, uint64_t & errors) {
+    std::mt19937 gen(id);
+    std::vector<char> buf(4096);
+
+    for (int n = 0; n < nreads; n++) {
+      size_t file = gen() % nfiles;
+      off_t off = (gen() % (gFiles[file].size() / 4096)) * 4096;
+
+      if (!Read(cache, file, buf.data(), off, buf.size(), bytes)) {
+        errors++;
+      }
+    }
+  };
+  fprintf(stdout, "# files=%d size=%zu MB threads=%d reads=%d latency=%u us "
+          "cache=%zu MB page=%zu KB\n", nfiles, size / (1024 * 1024), nthreads,
+          nreads, gLatencyUs, cachesize / (1024 * 1024), pagesize / 1024);
+  fprintf(stdout, "%-12s %-8s %10s %12s %10s %12s %8s %8s\n", "pattern",
+          "method", "time[s]", "rate[MB/s]", "fetches", "fetched[MB]",
+          "hit[%]", "errors");
+  const char* names[] = {"header", "sequential", "random"};
+  std::function<void(int, uint64_t&, uint64_t&)>* patterns[] = {
+    &header, &sequential, &random
+  };
+
+  for (int i = 0; i < 3; i++) {
+    cache = 0;
+    Print(names[i], "direct", Measure(nthreads, *patterns[i]), cache);
+    cache = new FuseReadCache(cachesize, pagesize);
+    Print(names[i], "cache", Measure(nthreads, *patterns[i]), cache);
+    delete cache;
+  }
+
+  return 0;
+}